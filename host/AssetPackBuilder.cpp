@@ -0,0 +1,319 @@
+#include "AssetPackBuilder.h"
+#include "core/PanelFrame.h"
+#include <ArduinoJson.h>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+/**
+ * One character of a BDF font, before scaling
+ */
+struct BdfGlyph {
+    int width = 0;
+    int height = 0;
+    int xOffset = 0;
+    int yOffset = 0;            // BDF: bottom row relative to the baseline, up is positive
+    int advance = 0;
+    std::vector<uint8_t> rows;  // (width + 7) / 8 bytes per row
+};
+
+static void putU32(std::vector<uint8_t>& out, size_t at, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out[at + i] = (value >> (8 * i)) & 0xff;
+    }
+}
+
+static bool readFile(const std::string& path, std::string& contents) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+    std::ostringstream buffer;
+    buffer << file.rdbuf();
+    contents = buffer.str();
+    return true;
+}
+
+bool AssetPackBuilder::addSource(AssetSource source) {
+    if (source.name.empty() || source.name.size() >= AssetPack::NAME_SIZE) {
+        fprintf(stderr, "asset name '%s' must be 1 to %u characters\n", source.name.c_str(),
+                static_cast<unsigned>(AssetPack::NAME_SIZE - 1));
+        return false;
+    }
+    for (const AssetSource& existing : sources) {
+        if (existing.name == source.name) {
+            fprintf(stderr, "asset '%s' is defined twice\n", source.name.c_str());
+            return false;
+        }
+    }
+    sources.push_back(std::move(source));
+    return true;
+}
+
+bool AssetPackBuilder::addFont(const std::string& name, const std::string& bdf, int scale) {
+    if (scale < 1) {
+        fprintf(stderr, "font %s: scale must be at least 1\n", name.c_str());
+        return false;
+    }
+
+    std::map<int, BdfGlyph> glyphs;
+    int ascent = -1;
+    int descent = -1;
+    int boxHeight = 0;
+    int boxBottom = 0;
+    BdfGlyph glyph;
+    int encoding = -1;
+    int bitmapRows = -1;        // Rows still to read, or -1 outside BITMAP
+
+    std::istringstream lines(bdf);
+    std::string line;
+    while (std::getline(lines, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        std::istringstream words(line);
+        std::string keyword;
+        words >> keyword;
+
+        if (bitmapRows > 0) {
+            size_t stride = (glyph.width + 7) / 8;
+            for (size_t i = 0; i < stride; i++) {
+                std::string hex = keyword.substr(i * 2, 2);
+                glyph.rows.push_back(hex.size() == 2 ? static_cast<uint8_t>(strtoul(hex.c_str(), nullptr, 16)) : 0);
+            }
+            bitmapRows--;
+        } else if (keyword == "FONT_ASCENT") {
+            words >> ascent;
+        } else if (keyword == "FONT_DESCENT") {
+            words >> descent;
+        } else if (keyword == "FONTBOUNDINGBOX") {
+            int boxWidth;
+            int boxLeft;
+            words >> boxWidth >> boxHeight >> boxLeft >> boxBottom;
+        } else if (keyword == "STARTCHAR") {
+            glyph = BdfGlyph();
+            encoding = -1;
+        } else if (keyword == "ENCODING") {
+            words >> encoding;
+        } else if (keyword == "DWIDTH") {
+            words >> glyph.advance;
+        } else if (keyword == "BBX") {
+            words >> glyph.width >> glyph.height >> glyph.xOffset >> glyph.yOffset;
+        } else if (keyword == "BITMAP") {
+            bitmapRows = glyph.height;
+        } else if (keyword == "ENDCHAR") {
+            if (bitmapRows > 0) {
+                fprintf(stderr, "font %s: character %d is missing bitmap rows\n", name.c_str(), encoding);
+                return false;
+            }
+            // Fonts cover one byte; anything else is left out
+            if (encoding >= 0 && encoding <= 0xff) glyphs[encoding] = glyph;
+            bitmapRows = -1;
+        }
+    }
+
+    if (glyphs.empty()) {
+        fprintf(stderr, "font %s: no characters\n", name.c_str());
+        return false;
+    }
+    if (ascent < 0 || descent < 0) {
+        ascent = boxHeight + boxBottom;
+        descent = -boxBottom;
+    }
+
+    int first = glyphs.begin()->first;
+    int glyphCount = glyphs.rbegin()->first - first + 1;
+    size_t recordsEnd = AssetPack::FONT_HEADER_SIZE + glyphCount * AssetPack::GLYPH_SIZE;
+    if (glyphCount > 0xff) {
+        fprintf(stderr, "font %s: characters %d to %d are more than 255\n", name.c_str(), first,
+                glyphs.rbegin()->first);
+        return false;
+    }
+
+    AssetSource source;
+    source.name = name;
+    source.type = AssetType::FONT;
+    source.width = 0;
+    source.height = static_cast<uint16_t>((ascent + descent) * scale);
+    source.param = static_cast<uint16_t>(ascent * scale);
+    source.data.assign(recordsEnd, 0);
+    source.data[0] = static_cast<uint8_t>(first);
+    source.data[1] = static_cast<uint8_t>(glyphCount);
+
+    for (const auto& entry : glyphs) {
+        const BdfGlyph& from = entry.second;
+        int width = from.width * scale;
+        int height = from.height * scale;
+        int xOffset = from.xOffset * scale;
+        int yOffset = -(from.yOffset + from.height) * scale;
+        int advance = from.advance * scale;
+        if (width > 0xff || height > 0xff || advance > 0xff || advance <= 0 || xOffset < -128 || xOffset > 127 ||
+            yOffset < -128 || yOffset > 127) {
+            fprintf(stderr, "font %s: character %d does not fit at scale %d\n", name.c_str(), entry.first, scale);
+            return false;
+        }
+
+        size_t record = AssetPack::FONT_HEADER_SIZE + (entry.first - first) * AssetPack::GLYPH_SIZE;
+        putU32(source.data, record, static_cast<uint32_t>(source.data.size()));
+        source.data[record + 4] = static_cast<uint8_t>(width);
+        source.data[record + 5] = static_cast<uint8_t>(height);
+        source.data[record + 6] = static_cast<uint8_t>(static_cast<int8_t>(xOffset));
+        source.data[record + 7] = static_cast<uint8_t>(static_cast<int8_t>(yOffset));
+        source.data[record + 8] = static_cast<uint8_t>(advance);
+        if (advance > source.width) source.width = static_cast<uint16_t>(advance);
+
+        // Each source pixel becomes a scale x scale block
+        size_t fromStride = (from.width + 7) / 8;
+        size_t stride = (width + 7) / 8;
+        for (int row = 0; row < height; row++) {
+            const uint8_t* bits = from.rows.data() + (row / scale) * fromStride;
+            std::vector<uint8_t> out(stride, 0);
+            for (int column = 0; column < width; column++) {
+                int fromColumn = column / scale;
+                if (bits[fromColumn / 8] & (0x80 >> (fromColumn % 8))) {
+                    out[column / 8] |= 0x80 >> (column % 8);
+                }
+            }
+            source.data.insert(source.data.end(), out.begin(), out.end());
+        }
+    }
+    return addSource(std::move(source));
+}
+
+bool AssetPackBuilder::addIcon(const std::string& name, int width, int height, const std::vector<uint8_t>& pixels,
+                               uint16_t key) {
+    if (width <= 0 || height <= 0 || width > 0xffff || height > 0xffff ||
+        pixels.size() != static_cast<size_t>(width) * height) {
+        fprintf(stderr, "icon %s: bad size\n", name.c_str());
+        return false;
+    }
+
+    AssetSource source;
+    source.name = name;
+    source.type = AssetType::ICON;
+    source.width = static_cast<uint16_t>(width);
+    source.height = static_cast<uint16_t>(height);
+    source.param = key;
+    PanelFrame::packBits(pixels.data(), pixels.size(), source.data);
+    return addSource(std::move(source));
+}
+
+bool AssetPackBuilder::addBackground(const std::string& name, int width, int height,
+                                     const std::vector<uint8_t>& pixels) {
+    if (width <= 0 || height <= 0 || width > 0xffff || height > 0xffff ||
+        pixels.size() != static_cast<size_t>(width) * height) {
+        fprintf(stderr, "background %s: bad size\n", name.c_str());
+        return false;
+    }
+
+    AssetSource source;
+    source.name = name;
+    source.type = AssetType::BACKGROUND;
+    source.width = static_cast<uint16_t>(width);
+    source.height = static_cast<uint16_t>(height);
+    source.param = 0;
+    source.data = pixels;
+    return addSource(std::move(source));
+}
+
+bool AssetPackBuilder::readPgm(const std::string& path, int& width, int& height, std::vector<uint8_t>& pixels) {
+    std::string contents;
+    if (!readFile(path, contents)) {
+        fprintf(stderr, "%s not found\n", path.c_str());
+        return false;
+    }
+
+    // Header: P5, width, height and maxval, with optional comments
+    std::vector<long> fields;
+    std::string magic = contents.substr(0, 2);
+    size_t at = 2;
+    while (fields.size() < 3 && at < contents.size()) {
+        char c = contents[at];
+        if (c == '#') {
+            at = contents.find('\n', at);
+            if (at == std::string::npos) break;
+        } else if (isdigit(static_cast<unsigned char>(c))) {
+            size_t end = at;
+            while (end < contents.size() && isdigit(static_cast<unsigned char>(contents[end]))) end++;
+            fields.push_back(strtol(contents.c_str() + at, nullptr, 10));
+            at = end;
+            continue;
+        }
+        at++;
+    }
+    at++;  // Single whitespace before the pixels
+
+    if (magic != "P5" || fields.size() != 3 || fields[2] != 255 || fields[0] <= 0 || fields[1] <= 0) {
+        fprintf(stderr, "%s: only 8-bit binary PGM (P5) is supported\n", path.c_str());
+        return false;
+    }
+    width = static_cast<int>(fields[0]);
+    height = static_cast<int>(fields[1]);
+    size_t bytes = static_cast<size_t>(width) * height;
+    if (at > contents.size() || contents.size() - at < bytes) {
+        fprintf(stderr, "%s: truncated\n", path.c_str());
+        return false;
+    }
+    pixels.assign(contents.begin() + at, contents.begin() + at + bytes);
+    return true;
+}
+
+bool AssetPackBuilder::addManifest(const std::string& path) {
+    std::string contents;
+    if (!readFile(path, contents)) {
+        fprintf(stderr, "asset manifest %s not found\n", path.c_str());
+        return false;
+    }
+    JsonDocument doc;
+    DeserializationError error = deserializeJson(doc, contents.c_str());
+    if (error) {
+        fprintf(stderr, "asset manifest %s: %s\n", path.c_str(), error.c_str());
+        return false;
+    }
+
+    size_t slash = path.rfind('/');
+    std::string base = slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+
+    for (JsonObject font : doc["Fonts"].as<JsonArray>()) {
+        std::string bdf;
+        if (!readFile(base + (font["Bdf"] | ""), bdf)) {
+            fprintf(stderr, "font %s: %s not found\n", (font["Name"] | ""), (font["Bdf"] | ""));
+            return false;
+        }
+        if (!addFont(font["Name"] | "", bdf, font["Scale"] | 1)) return false;
+    }
+
+    for (JsonObject icon : doc["Icons"].as<JsonArray>()) {
+        int width;
+        int height;
+        std::vector<uint8_t> pixels;
+        if (!readPgm(base + (icon["Pgm"] | ""), width, height, pixels)) return false;
+        uint16_t key = icon["Key"].is<int>() ? static_cast<uint16_t>(icon["Key"].as<int>() & 0xff) : AssetPack::NO_KEY;
+        if (!addIcon(icon["Name"] | "", width, height, pixels, key)) return false;
+    }
+
+    for (JsonObject background : doc["Backgrounds"].as<JsonArray>()) {
+        int width;
+        int height;
+        std::vector<uint8_t> pixels;
+        if (!readPgm(base + (background["Pgm"] | ""), width, height, pixels)) return false;
+        if (!addBackground(background["Name"] | "", width, height, pixels)) return false;
+    }
+    return true;
+}
+
+bool AssetPackBuilder::build(std::vector<uint8_t>& pack) const {
+    return AssetPack::encode(sources, pack);
+}
+
+bool AssetPackBuilder::write(const std::string& path) const {
+    std::vector<uint8_t> pack;
+    if (!build(pack)) return false;
+
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file) {
+        fprintf(stderr, "cannot write %s\n", path.c_str());
+        return false;
+    }
+    bool ok = fwrite(pack.data(), 1, pack.size(), file) == pack.size();
+    return fclose(file) == 0 && ok;
+}
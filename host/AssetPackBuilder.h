@@ -0,0 +1,44 @@
+#ifndef ASSET_PACK_BUILDER_H
+#define ASSET_PACK_BUILDER_H
+
+#include "core/AssetPack.h"
+#include <string>
+#include <vector>
+
+/**
+ * Host tool that turns source artwork into an asset pack (AssetPack) for
+ * the assets flash partition.
+ *
+ * Fonts come from BDF files, which are already rasterized for one size;
+ * a scale factor enlarges a small bitmap font to another size without
+ * any smoothing, so every size in the pack is a separate, ready-to-blit
+ * asset. Icons and backgrounds come from binary PGM (P5) images.
+ *
+ * The manifest is a JSON object with any of:
+ *   "Fonts": [{"Name": "clock-28", "Bdf": "clock.bdf", "Scale": 4}]
+ *   "Icons": [{"Name": "sync-fail", "Pgm": "sync-fail.pgm", "Key": 255}]
+ *   "Backgrounds": [{"Name": "frame", "Pgm": "frame.pgm"}]
+ * with paths relative to the manifest. Icons without a Key are opaque.
+ */
+class AssetPackBuilder {
+public:
+    bool addFont(const std::string& name, const std::string& bdf, int scale = 1);
+    bool addIcon(const std::string& name, int width, int height, const std::vector<uint8_t>& pixels,
+                 uint16_t key = AssetPack::NO_KEY);
+    bool addBackground(const std::string& name, int width, int height, const std::vector<uint8_t>& pixels);
+    bool addManifest(const std::string& path);
+
+    bool build(std::vector<uint8_t>& pack) const;
+    bool write(const std::string& path) const;
+
+    size_t getCount() const { return sources.size(); }
+
+    static bool readPgm(const std::string& path, int& width, int& height, std::vector<uint8_t>& pixels);
+
+private:
+    std::vector<AssetSource> sources;
+
+    bool addSource(AssetSource source);
+};
+
+#endif
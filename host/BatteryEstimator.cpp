@@ -0,0 +1,97 @@
+#include "BatteryEstimator.h"
+#include <ArduinoJson.h>
+#include <fstream>
+#include <sstream>
+
+bool PowerProfile::loadProfile(const char* path, PowerProfile& profile) {
+    std::ifstream file(path);
+    if (!file) {
+        fprintf(stderr, "power profile %s not found\n", path);
+        return false;
+    }
+    std::ostringstream contents;
+    contents << file.rdbuf();
+
+    JsonDocument doc;
+    DeserializationError error = deserializeJson(doc, contents.str().c_str());
+    if (error) {
+        fprintf(stderr, "power profile %s: %s\n", path, error.c_str());
+        return false;
+    }
+
+    profile.batteryMah = doc["BatteryMah"] | profile.batteryMah;
+    profile.usableFraction = doc["UsableFraction"] | profile.usableFraction;
+    profile.sleepUa = doc["SleepUa"] | profile.sleepUa;
+    profile.activeMa = doc["ActiveMa"] | profile.activeMa;
+    profile.radioMa = doc["RadioMa"] | profile.radioMa;
+    profile.panelMa = doc["PanelMa"] | profile.panelMa;
+    return true;
+}
+
+BatteryEstimate BatteryEstimator::estimate(const std::vector<WakeReport>& reports, const PowerProfile& profile) {
+    BatteryEstimate result;
+
+    double sleepSeconds = 0.0;
+    double awakeSeconds = 0.0;
+    double radioSeconds = 0.0;
+    double panelSeconds = 0.0;
+    double fullRefreshes = 0.0;
+    double fullRefreshes3Bit = 0.0;
+    double partialRefreshes = 0.0;
+    double blockedPartials = 0.0;
+    double httpRequests = 0.0;
+    for (const WakeReport& report : reports) {
+        sleepSeconds += report.sleepMicros / 1e6;
+        awakeSeconds += report.awakeMicros / 1e6;
+        radioSeconds += report.radioOnMicros / 1e6;
+        panelSeconds += report.panel.refreshMs / 1e3;
+        fullRefreshes += report.panel.fullRefreshes;
+        fullRefreshes3Bit += report.panel.fullRefreshes3Bit;
+        partialRefreshes += report.panel.partialRefreshes;
+        blockedPartials += report.panel.blockedPartials;
+        httpRequests += report.httpRequests;
+    }
+
+    double totalSeconds = sleepSeconds + awakeSeconds;
+    if (totalSeconds <= 0.0) return result;
+
+    result.days = totalSeconds / 86400.0;
+    result.wakesPerDay = reports.size() / result.days;
+    result.fullRefreshesPerDay = fullRefreshes / result.days;
+    result.fullRefreshes3BitPerDay = fullRefreshes3Bit / result.days;
+    result.partialRefreshesPerDay = partialRefreshes / result.days;
+    result.blockedPartialsPerDay = blockedPartials / result.days;
+    result.awakeSecondsPerDay = awakeSeconds / result.days;
+    result.radioSecondsPerDay = radioSeconds / result.days;
+    result.panelSecondsPerDay = panelSeconds / result.days;
+    result.httpRequestsPerDay = httpRequests / result.days;
+
+    // Charge per phase averaged over the whole timeline
+    result.sleepMa = profile.sleepUa / 1000.0 * sleepSeconds / totalSeconds;
+    result.activeMa = profile.activeMa * awakeSeconds / totalSeconds;
+    result.radioMa = profile.radioMa * radioSeconds / totalSeconds;
+    result.panelMa = profile.panelMa * panelSeconds / totalSeconds;
+    result.averageMa = result.sleepMa + result.activeMa + result.radioMa + result.panelMa;
+
+    if (result.averageMa > 0.0) {
+        result.lifeDays = profile.batteryMah * profile.usableFraction / result.averageMa / 24.0;
+    }
+    return result;
+}
+
+void BatteryEstimator::print(FILE* out, const BatteryEstimate& estimate, const PowerProfile& profile) {
+    fprintf(out, "battery estimate over %.2f simulated days (%.0f mAh, %.0f%% usable)\n",
+            estimate.days, profile.batteryMah, profile.usableFraction * 100.0f);
+    fprintf(out, "  wakes/day            %8.1f\n", estimate.wakesPerDay);
+    fprintf(out, "  full refreshes/day   %8.1f  (3-bit %.1f)\n",
+            estimate.fullRefreshesPerDay, estimate.fullRefreshes3BitPerDay);
+    fprintf(out, "  partial updates/day  %8.1f  (promoted to full %.1f)\n",
+            estimate.partialRefreshesPerDay, estimate.blockedPartialsPerDay);
+    fprintf(out, "  http requests/day    %8.1f\n", estimate.httpRequestsPerDay);
+    fprintf(out, "  awake s/day          %8.1f\n", estimate.awakeSecondsPerDay);
+    fprintf(out, "  radio-on s/day       %8.1f\n", estimate.radioSecondsPerDay);
+    fprintf(out, "  panel s/day          %8.1f\n", estimate.panelSecondsPerDay);
+    fprintf(out, "  average current      %8.3f mA  (sleep %.3f, cpu %.3f, radio %.3f, panel %.3f)\n",
+            estimate.averageMa, estimate.sleepMa, estimate.activeMa, estimate.radioMa, estimate.panelMa);
+    fprintf(out, "  projected life       %8.1f days\n", estimate.lifeDays);
+}
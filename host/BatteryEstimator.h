@@ -0,0 +1,64 @@
+#ifndef BATTERY_ESTIMATOR_H
+#define BATTERY_ESTIMATOR_H
+
+#include "HostRunner.h"
+#include <cstdio>
+#include <vector>
+
+/**
+ * Current drawn in each phase of a wake cycle.
+ *
+ * Defaults are datasheet-level figures for an Inkplate 10 on its 3000 mAh
+ * cell; load measured numbers with loadProfile() for real estimates.
+ * Radio and panel currents are drawn on top of the active CPU current.
+ */
+struct PowerProfile {
+    float batteryMah = 3000.0f;
+    float usableFraction = 0.8f;    // Capacity left above the brown-out voltage
+    float sleepUa = 18.0f;          // Deep sleep, RTC timer running
+    float activeMa = 45.0f;         // CPU awake at 240 MHz
+    float radioMa = 110.0f;         // WiFi association and traffic
+    float panelMa = 80.0f;          // Panel driving during a refresh
+
+    // JSON object with any of: BatteryMah, UsableFraction, SleepUa,
+    // ActiveMa, RadioMa, PanelMa. Missing keys keep their defaults.
+    static bool loadProfile(const char* path, PowerProfile& profile);
+};
+
+/**
+ * Per-day figures and projected battery life for a run of wake reports
+ */
+struct BatteryEstimate {
+    double days = 0.0;              // Simulated time covered
+    double wakesPerDay = 0.0;
+    double fullRefreshesPerDay = 0.0;
+    double fullRefreshes3BitPerDay = 0.0;
+    double partialRefreshesPerDay = 0.0;
+    double blockedPartialsPerDay = 0.0;
+    double awakeSecondsPerDay = 0.0;
+    double radioSecondsPerDay = 0.0;
+    double panelSecondsPerDay = 0.0;
+    double httpRequestsPerDay = 0.0;
+
+    // Average current split by phase (mA)
+    double sleepMa = 0.0;
+    double activeMa = 0.0;
+    double radioMa = 0.0;
+    double panelMa = 0.0;
+    double averageMa = 0.0;
+
+    double lifeDays = 0.0;
+};
+
+/**
+ * Turns HostRunner wake reports into a battery estimate. The reports come
+ * from the real firmware scheduling, so interval changes in config.json
+ * show up exactly as the device would act on them.
+ */
+class BatteryEstimator {
+public:
+    static BatteryEstimate estimate(const std::vector<WakeReport>& reports, const PowerProfile& profile);
+    static void print(FILE* out, const BatteryEstimate& estimate, const PowerProfile& profile);
+};
+
+#endif
@@ -0,0 +1,119 @@
+#include "FleetServer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+/**
+ * Counters at the start of the shared block
+ */
+struct FleetServer::Totals {
+    uint64_t requests;
+    uint64_t responseBytes;
+    uint32_t latencies[LATENCY_BUCKETS + 1];        // Last bucket: a minute or more
+};
+
+static size_t slotsFor(uint64_t spanMs) {
+    return static_cast<size_t>((spanMs + FleetServer::SLOT_MS - 1) / FleetServer::SLOT_MS);
+}
+
+size_t FleetServer::memorySize(uint64_t spanMs) {
+    return sizeof(Totals) + slotsFor(spanMs) * 3 * sizeof(uint32_t);
+}
+
+FleetServer::FleetServer(void* memory, uint64_t startEpochMs, uint64_t spanMs, const FleetServerModel& model)
+    : model(model), startEpochMs(startEpochMs), slotCount(slotsFor(spanMs)) {
+    memset(memory, 0, memorySize(spanMs));
+    totals = static_cast<Totals*>(memory);
+    workMs = reinterpret_cast<uint32_t*>(totals + 1);
+    bytes = workMs + slotCount;
+    arrivals = bytes + slotCount;
+    if (this->model.workers == 0) this->model.workers = 1;
+}
+
+uint64_t FleetServer::book(uint32_t* used, uint64_t capacity, uint64_t fromMs, uint64_t amount) {
+    size_t slot = static_cast<size_t>(fromMs / SLOT_MS);
+    while (slot < slotCount) {
+        uint64_t available = capacity > used[slot] ? capacity - used[slot] : 0;
+        uint64_t take = std::min(available, amount);
+        used[slot] += static_cast<uint32_t>(take);
+        amount -= take;
+        if (amount == 0) {
+            // Done once this slot's bookings are, at full capacity
+            return slot * static_cast<uint64_t>(SLOT_MS) + (used[slot] * SLOT_MS + capacity - 1) / capacity;
+        }
+        slot++;
+    }
+    // Past the span: the rest at full capacity
+    uint64_t from = std::max<uint64_t>(fromMs, slotCount * static_cast<uint64_t>(SLOT_MS));
+    return from + (amount * SLOT_MS + capacity - 1) / capacity;
+}
+
+uint32_t FleetServer::request(uint64_t epochMs, size_t responseBytes) {
+    uint64_t byteCapacity = static_cast<uint64_t>(model.bandwidthKbps) * SLOT_MS / 8;
+    uint64_t transferMs = byteCapacity > 0 ? (responseBytes * SLOT_MS + byteCapacity - 1) / byteCapacity : 0;
+
+    uint64_t latency = model.rttMs + model.serviceMs + transferMs;
+    if (epochMs >= startEpochMs && epochMs - startEpochMs < slotCount * static_cast<uint64_t>(SLOT_MS)) {
+        uint64_t arrive = epochMs - startEpochMs + model.rttMs / 2;
+        arrivals[(epochMs - startEpochMs) / SLOT_MS]++;
+
+        uint64_t served = book(workMs, static_cast<uint64_t>(model.workers) * SLOT_MS, arrive, model.serviceMs);
+        served = std::max(served, arrive + model.serviceMs);
+        uint64_t sent = served;
+        if (byteCapacity > 0 && responseBytes > 0) {
+            sent = std::max(book(bytes, byteCapacity, served, responseBytes), served + transferMs);
+        }
+        latency = sent + (model.rttMs - model.rttMs / 2) - (epochMs - startEpochMs);
+    }
+
+    totals->requests++;
+    totals->responseBytes += responseBytes;
+    totals->latencies[std::min<uint64_t>(latency / LATENCY_BUCKET_MS, LATENCY_BUCKETS)]++;
+    return static_cast<uint32_t>(std::min<uint64_t>(latency, UINT32_MAX));
+}
+
+uint64_t FleetServer::getRequests() const {
+    return totals->requests;
+}
+
+uint64_t FleetServer::getResponseBytes() const {
+    return totals->responseBytes;
+}
+
+double FleetServer::getMeanRequestsPerSecond() const {
+    uint64_t inSpan = 0;
+    for (size_t slot = 0; slot < slotCount; slot++) inSpan += arrivals[slot];
+    return slotCount > 0 ? inSpan * 1000.0 / (slotCount * static_cast<double>(SLOT_MS)) : 0.0;
+}
+
+uint32_t FleetServer::getPeakRequestsPerSecond() const {
+    const size_t slotsPerSecond = 1000 / SLOT_MS;
+    uint32_t peak = 0;
+    for (size_t second = 0; second < slotCount; second += slotsPerSecond) {
+        uint32_t count = 0;
+        for (size_t slot = second; slot < std::min(slotCount, second + slotsPerSecond); slot++) {
+            count += arrivals[slot];
+        }
+        peak = std::max(peak, count);
+    }
+    return peak;
+}
+
+uint32_t FleetServer::latencyPercentile(double percent) const {
+    if (totals->requests == 0) return 0;
+    uint64_t rank = static_cast<uint64_t>(std::ceil(percent / 100.0 * totals->requests));
+    rank = std::max<uint64_t>(rank, 1);
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket <= LATENCY_BUCKETS; bucket++) {
+        seen += totals->latencies[bucket];
+        if (seen >= rank) return static_cast<uint32_t>(bucket * LATENCY_BUCKET_MS);
+    }
+    return static_cast<uint32_t>(LATENCY_BUCKETS * LATENCY_BUCKET_MS);
+}
+
+double FleetServer::percentile(std::vector<double> values, double percent) {
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    size_t rank = static_cast<size_t>(std::ceil(percent / 100.0 * values.size()));
+    return values[std::min(values.size(), std::max<size_t>(rank, 1)) - 1];
+}
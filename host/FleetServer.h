@@ -0,0 +1,71 @@
+#ifndef FLEET_SERVER_H
+#define FLEET_SERVER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Capacity of the stand-in image server
+ */
+struct FleetServerModel {
+    uint32_t workers = 4;               // Requests processed in parallel
+    uint32_t serviceMs = 40;            // Server time per request
+    uint32_t bandwidthKbps = 20000;     // Uplink shared by all response bodies (0 = unlimited)
+    uint32_t rttMs = 20;                // Network round trip added to every request
+};
+
+/**
+ * Load model of one server shared by a simulated fleet.
+ *
+ * Time is cut into SLOT_MS slots, each with workers x SLOT_MS of server
+ * time and SLOT_MS worth of uplink bytes. A request takes its service time
+ * from the first slots that still have some, then its body's bytes the same
+ * way; when it is done depends on what earlier requests already booked. This
+ * is a fluid approximation of a queue, but it does not care in which order
+ * requests are booked. That lets wakes of different devices that overlap in
+ * simulated time run one after another.
+ *
+ * All state lives in a caller-provided block (memorySize()), so forked
+ * wakes can book into memory shared with the parent.
+ */
+class FleetServer {
+public:
+    static const uint32_t SLOT_MS = 100;
+    static const uint32_t LATENCY_BUCKET_MS = 10;
+    static const size_t LATENCY_BUCKETS = 6000;     // Up to a minute
+
+    static size_t memorySize(uint64_t spanMs);
+
+    // Clears memory. Requests outside [startEpochMs, startEpochMs + spanMs) see an idle server.
+    FleetServer(void* memory, uint64_t startEpochMs, uint64_t spanMs, const FleetServerModel& model);
+
+    // A request arriving at epochMs whose response body has responseBytes: its latency in ms
+    uint32_t request(uint64_t epochMs, size_t responseBytes);
+
+    uint64_t getRequests() const;
+    uint64_t getResponseBytes() const;
+    double getMeanRequestsPerSecond() const;
+    uint32_t getPeakRequestsPerSecond() const;
+    // Over all requests so far, in ms rounded down to LATENCY_BUCKET_MS
+    uint32_t latencyPercentile(double percent) const;
+
+    // Nearest-rank percentile of values (0 if empty)
+    static double percentile(std::vector<double> values, double percent);
+
+private:
+    struct Totals;
+
+    FleetServerModel model;
+    uint64_t startEpochMs;
+    size_t slotCount;
+    Totals* totals;
+    uint32_t* workMs;                   // Server time booked per slot (all workers)
+    uint32_t* bytes;                    // Uplink bytes booked per slot
+    uint32_t* arrivals;                 // Requests arriving per slot
+
+    // Book amount from slot first on; returns when the last of it is done (ms since start)
+    uint64_t book(uint32_t* used, uint64_t capacity, uint64_t fromMs, uint64_t amount);
+};
+
+#endif
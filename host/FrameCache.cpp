@@ -0,0 +1,298 @@
+#include "FrameCache.h"
+#include <algorithm>
+
+// Pure black or white: what a 1-bit partial update can draw or replace
+static bool isBlackOrWhite(uint8_t level) {
+    return level == 0 || level == 7;
+}
+
+static void alignRect(PanelFrameRect& rect, int left, int right, int top, int bottom, int panelWidth) {
+    // Byte boundaries in 1-bit rows also fall on byte boundaries in 3-bit rows
+    left &= ~7;
+    right = std::min((right + 8) & ~7, panelWidth);
+    rect = PanelFrameRect();
+    rect.x = static_cast<uint16_t>(left);
+    rect.y = static_cast<uint16_t>(top);
+    rect.width = static_cast<uint16_t>(right - left);
+    rect.height = static_cast<uint16_t>(bottom - top + 1);
+}
+
+static bool overlaps(const PanelFrameRect& a, const PanelFrameRect& b) {
+    return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+}
+
+static PanelFrameRect unite(const PanelFrameRect& a, const PanelFrameRect& b) {
+    PanelFrameRect rect = PanelFrameRect();
+    rect.x = std::min(a.x, b.x);
+    rect.y = std::min(a.y, b.y);
+    rect.width = static_cast<uint16_t>(std::max(a.x + a.width, b.x + b.width) - rect.x);
+    rect.height = static_cast<uint16_t>(std::max(a.y + a.height, b.y + b.height) - rect.y);
+    return rect;
+}
+
+// Merge overlapping rects; fall back to their union when there are too many
+static void mergeRects(std::vector<PanelFrameRect>& rects) {
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (size_t i = 0; i < rects.size() && !merged; i++) {
+            for (size_t j = i + 1; j < rects.size(); j++) {
+                if (overlaps(rects[i], rects[j])) {
+                    rects[i] = unite(rects[i], rects[j]);
+                    rects.erase(rects.begin() + j);
+                    merged = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    if (rects.size() > PanelFrame::MAX_RECTS) {
+        PanelFrameRect all = rects[0];
+        for (const PanelFrameRect& rect : rects) all = unite(all, rect);
+        rects.assign(1, all);
+    }
+}
+
+FrameCache::FrameCache(uint32_t firstId, size_t history)
+    : nextId(firstId == 0 ? 1 : firstId), historySize(history == 0 ? 1 : history) {}
+
+uint64_t FrameCache::hash(const void* data, size_t size, uint64_t seed) {
+    // FNV-1a
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint64_t value = seed;
+    for (size_t i = 0; i < size; i++) {
+        value ^= bytes[i];
+        value *= 1099511628211ULL;
+    }
+    return value;
+}
+
+const RenderedFrame* FrameCache::find(uint64_t configHash, uint64_t dataVersion) const {
+    auto entry = configs.find(configHash);
+    if (entry == configs.end()) return nullptr;
+    for (const auto& version : entry->second.versions) {
+        if (version.first == dataVersion) return version.second.get();
+    }
+    return nullptr;
+}
+
+const RenderedFrame* FrameCache::findById(uint64_t configHash, uint32_t id) const {
+    auto entry = configs.find(configHash);
+    if (entry == configs.end() || id == 0) return nullptr;
+    for (const auto& frame : entry->second.history) {
+        if (frame->id == id) return frame.get();
+    }
+    return nullptr;
+}
+
+const RenderedFrame* FrameCache::latest(uint64_t configHash) const {
+    auto entry = configs.find(configHash);
+    if (entry == configs.end() || entry->second.history.empty()) return nullptr;
+    return entry->second.history.back().get();
+}
+
+const RenderedFrame& FrameCache::store(uint64_t configHash, uint64_t dataVersion, int width, int height,
+                                       std::vector<uint8_t> levels, std::vector<FrameRegion> regions) {
+    renders++;
+    ConfigFrames& entry = configs[configHash];
+    uint64_t imageHash = hash(levels.data(), levels.size(), hash(&width, sizeof(width), hash(&height, sizeof(height))));
+
+    // The same image as a frame devices may already show keeps its id
+    std::shared_ptr<RenderedFrame> frame;
+    for (size_t i = 0; i < entry.history.size(); i++) {
+        const RenderedFrame& existing = *entry.history[i];
+        if (existing.imageHash == imageHash && existing.width == width && existing.height == height &&
+            existing.levels == levels) {
+            frame = entry.history[i];
+            entry.history.erase(entry.history.begin() + i);
+            reused++;
+            break;
+        }
+    }
+
+    if (!frame) {
+        frame = std::make_shared<RenderedFrame>();
+        frame->id = nextId++;
+        if (nextId == 0) nextId = 1;
+        frame->imageHash = imageHash;
+        frame->width = width;
+        frame->height = height;
+        frame->levels = std::move(levels);
+    }
+    frame->dataVersion = dataVersion;
+    frame->regions = std::move(regions);
+    entry.history.push_back(frame);
+
+    if (entry.history.size() > historySize) {
+        entry.history.erase(entry.history.begin(), entry.history.end() - historySize);
+    }
+
+    // Versions of evicted frames go too; the rest are capped oldest first
+    auto& versions = entry.versions;
+    versions.erase(std::remove_if(versions.begin(), versions.end(),
+                                  [&](const std::pair<uint64_t, std::shared_ptr<RenderedFrame>>& version) {
+                                      return version.first == dataVersion ||
+                                             std::find(entry.history.begin(), entry.history.end(),
+                                                       version.second) == entry.history.end();
+                                  }),
+                   versions.end());
+    versions.emplace_back(dataVersion, frame);
+    if (versions.size() > historySize * 4) {
+        versions.erase(versions.begin(), versions.end() - historySize * 4);
+    }
+    return *frame;
+}
+
+int FrameCache::answer(uint64_t configHash, const RenderedFrame& frame, uint32_t since, uint8_t fullMode,
+                       std::vector<uint8_t>& body) const {
+    body.clear();
+    if (since != 0 && since == frame.id) return 304;
+
+    const RenderedFrame* base = findById(configHash, since);
+    if (base && encodeDelta(frame, *base, body)) return 200;
+
+    encodeFull(frame, fullMode, body);
+    return 200;
+}
+
+void FrameCache::pack(const RenderedFrame& frame, uint8_t mode, std::vector<uint8_t>& out) {
+    out.assign(PanelFrame::bufferSize(mode, frame.width, frame.height), 0);
+    size_t pixels = static_cast<size_t>(frame.width) * frame.height;
+
+    if (mode == 0) {
+        // 1 = black, leftmost pixel in the low bit
+        for (size_t i = 0; i < pixels; i++) {
+            if (frame.levels[i] < 4) out[i / 8] |= static_cast<uint8_t>(1 << (i % 8));
+        }
+    } else {
+        for (size_t i = 0; i < pixels; i++) {
+            out[i / 2] |= static_cast<uint8_t>((frame.levels[i] & 0x07) << (i % 2 == 0 ? 4 : 0));
+        }
+    }
+}
+
+std::vector<PanelFrameRect> FrameCache::contentRects(const RenderedFrame& frame) {
+    // Bands of rows with something on them, split at white gaps
+    static const int MIN_GAP_ROWS = 8;
+    std::vector<PanelFrameRect> rects;
+    int top = -1;
+    int bottom = -1;
+    int left = frame.width;
+    int right = -1;
+
+    for (int y = 0; y <= frame.height; y++) {
+        int rowLeft = frame.width;
+        int rowRight = -1;
+        if (y < frame.height) {
+            const uint8_t* row = frame.levels.data() + static_cast<size_t>(y) * frame.width;
+            for (int x = 0; x < frame.width; x++) {
+                if (row[x] != 7) {
+                    rowLeft = std::min(rowLeft, x);
+                    rowRight = x;
+                }
+            }
+        }
+
+        if (rowRight >= 0) {
+            if (top < 0) top = y;
+            bottom = y;
+            left = std::min(left, rowLeft);
+            right = std::max(right, rowRight);
+        } else if (top >= 0 && (y - bottom >= MIN_GAP_ROWS || y == frame.height)) {
+            PanelFrameRect rect;
+            alignRect(rect, left, right, top, bottom, frame.width);
+            rects.push_back(rect);
+            top = -1;
+            left = frame.width;
+            right = -1;
+        }
+    }
+
+    mergeRects(rects);
+    return rects;
+}
+
+std::vector<PanelFrameRect> FrameCache::changedRects(const RenderedFrame& frame, const RenderedFrame& base) {
+    // Bounding box of the changes inside each region; the last box collects the rest
+    struct Box {
+        int left;
+        int right;
+        int top;
+        int bottom;
+    };
+    std::vector<Box> boxes(frame.regions.size() + 1, Box{frame.width, -1, frame.height, -1});
+
+    for (int y = 0; y < frame.height; y++) {
+        size_t rowStart = static_cast<size_t>(y) * frame.width;
+        for (int x = 0; x < frame.width; x++) {
+            if (frame.levels[rowStart + x] == base.levels[rowStart + x]) continue;
+
+            size_t owner = frame.regions.size();
+            for (size_t r = 0; r < frame.regions.size(); r++) {
+                const FrameRegion& region = frame.regions[r];
+                if (x >= region.x && x < region.x + region.width && y >= region.y && y < region.y + region.height) {
+                    owner = r;
+                    break;
+                }
+            }
+            Box& box = boxes[owner];
+            box.left = std::min(box.left, x);
+            box.right = std::max(box.right, x);
+            box.top = std::min(box.top, y);
+            box.bottom = std::max(box.bottom, y);
+        }
+    }
+
+    std::vector<PanelFrameRect> rects;
+    for (const Box& box : boxes) {
+        if (box.right < 0) continue;
+        PanelFrameRect rect;
+        alignRect(rect, box.left, box.right, box.top, box.bottom, frame.width);
+        rects.push_back(rect);
+    }
+    mergeRects(rects);
+    return rects;
+}
+
+bool FrameCache::encodeFull(const RenderedFrame& frame, uint8_t mode, std::vector<uint8_t>& out) {
+    std::vector<uint8_t> image;
+    pack(frame, mode, image);
+
+    PanelFrameHeader header = {};
+    header.mode = mode;
+    header.width = static_cast<uint16_t>(frame.width);
+    header.height = static_cast<uint16_t>(frame.height);
+    header.frameId = frame.id;
+    return PanelFrame::encode(header, contentRects(frame), image.data(), nullptr, out);
+}
+
+bool FrameCache::encodeDelta(const RenderedFrame& frame, const RenderedFrame& base, std::vector<uint8_t>& out) {
+    if (frame.width != base.width || frame.height != base.height) return false;
+
+    // A partial update only drives pixels between black and white
+    size_t pixels = static_cast<size_t>(frame.width) * frame.height;
+    for (size_t i = 0; i < pixels; i++) {
+        if (frame.levels[i] != base.levels[i] && (!isBlackOrWhite(frame.levels[i]) || !isBlackOrWhite(base.levels[i]))) {
+            return false;
+        }
+    }
+
+    std::vector<PanelFrameRect> rects = changedRects(frame, base);
+    size_t area = 0;
+    for (const PanelFrameRect& rect : rects) area += static_cast<size_t>(rect.width) * rect.height;
+    if (area * 100 > pixels * MAX_DELTA_PERCENT) return false;
+
+    std::vector<uint8_t> image;
+    std::vector<uint8_t> previous;
+    pack(frame, 0, image);
+    pack(base, 0, previous);
+
+    PanelFrameHeader header = {};
+    header.mode = 0;
+    header.width = static_cast<uint16_t>(frame.width);
+    header.height = static_cast<uint16_t>(frame.height);
+    header.frameId = frame.id;
+    header.baseId = base.id;
+    return PanelFrame::encode(header, rects, image.data(), previous.data(), out);
+}
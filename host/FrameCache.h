@@ -0,0 +1,95 @@
+#ifndef FRAME_CACHE_H
+#define FRAME_CACHE_H
+
+#include "core/PanelFrame.h"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/**
+ * Screen area of one layout region, as reported by the render
+ */
+struct FrameRegion {
+    int x;
+    int y;
+    int width;
+    int height;
+};
+
+/**
+ * One composed screen: the panel's gray levels (0 = black, 7 = white),
+ * one byte per pixel, and the regions the layout drew into
+ */
+struct RenderedFrame {
+    uint32_t id = 0;
+    uint64_t dataVersion = 0;
+    uint64_t imageHash = 0;
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> levels;
+    std::vector<FrameRegion> regions;
+};
+
+/**
+ * Render cache of the frame server, keyed by config hash and data version.
+ *
+ * Each config keeps its last few distinct frames. A render whose image
+ * matches the newest frame keeps that frame's id, so devices that already
+ * show it get "not modified" rather than a refresh. A device reporting an
+ * older frame still in the history gets a delta: per layout region, the
+ * bounding box of the pixels that changed, so regions whose data did not
+ * change are neither sent nor redrawn. Everything else gets a full frame.
+ *
+ * Frame ids continue from firstId, which the server seeds from the clock
+ * so a restarted server does not reuse ids devices still hold.
+ */
+class FrameCache {
+public:
+    // Deltas covering more of the panel than this are sent as full frames
+    static const int MAX_DELTA_PERCENT = 50;
+
+    explicit FrameCache(uint32_t firstId = 1, size_t history = 8);
+
+    // Rendered frame for this config and data, or nullptr
+    const RenderedFrame* find(uint64_t configHash, uint64_t dataVersion) const;
+    const RenderedFrame* findById(uint64_t configHash, uint32_t id) const;
+    const RenderedFrame* latest(uint64_t configHash) const;
+
+    // Add a render; returns the cached frame (an existing one if the image is unchanged)
+    const RenderedFrame& store(uint64_t configHash, uint64_t dataVersion, int width, int height,
+                               std::vector<uint8_t> levels, std::vector<FrameRegion> regions);
+
+    // PanelFrame for a device showing frame since (0: none); 304 if it already shows it
+    int answer(uint64_t configHash, const RenderedFrame& frame, uint32_t since, uint8_t fullMode,
+               std::vector<uint8_t>& body) const;
+
+    size_t getConfigCount() const { return configs.size(); }
+    uint32_t getRenders() const { return renders; }
+    uint32_t getReused() const { return reused; }
+
+    // Made public for testing
+    static bool encodeFull(const RenderedFrame& frame, uint8_t mode, std::vector<uint8_t>& out);
+    static bool encodeDelta(const RenderedFrame& frame, const RenderedFrame& base, std::vector<uint8_t>& out);
+    static std::vector<PanelFrameRect> contentRects(const RenderedFrame& frame);
+    static std::vector<PanelFrameRect> changedRects(const RenderedFrame& frame, const RenderedFrame& base);
+    static void pack(const RenderedFrame& frame, uint8_t mode, std::vector<uint8_t>& out);
+    static uint64_t hash(const void* data, size_t size, uint64_t seed = 14695981039346656037ULL);
+
+private:
+    struct ConfigFrames {
+        std::vector<std::shared_ptr<RenderedFrame>> history;    // Oldest first
+        // Data versions seen, oldest first; several can share one frame
+        std::vector<std::pair<uint64_t, std::shared_ptr<RenderedFrame>>> versions;
+    };
+
+    std::map<uint64_t, ConfigFrames> configs;
+    uint32_t nextId;
+    size_t historySize;
+    uint32_t renders = 0;
+    uint32_t reused = 0;
+};
+
+#endif
@@ -0,0 +1,285 @@
+#include "HostFleet.h"
+#include "HostClock.h"
+#include "HostSleep.h"
+#include "HTTPClient.h"
+#include "SPIFFS.h"
+#include "WiFi.h"
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <queue>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Firmware entry points (src/main.cpp)
+void setup();
+void loop();
+
+/**
+ * Memory shared between the parent and the wake it forked
+ */
+struct HostFleet::SharedWake {
+    static const size_t RTC_MEMORY_SIZE = 8192;  // ESP32 RTC slow memory
+
+    WakeReport report;
+    size_t rtcSize;
+    uint8_t rtcMemory[RTC_MEMORY_SIZE];
+};
+
+/**
+ * Sends requests for the image server through the fleet's load model and
+ * leaves every other host at its fixed latency
+ */
+class FleetTransport : public HostTransport {
+public:
+    FleetTransport(HostTransport& inner, FleetServer& server, const std::string& serverHost)
+        : inner(inner), server(server), serverHost(serverHost) {}
+
+    HostResponse handle(const HostRequest& request) override {
+        HostResponse response = inner.handle(request);
+        if (serverHost.empty() || request.host == serverHost) {
+            response.latencyMs = server.request(HostClock::epochMicros() / 1000ULL, response.body.size());
+        }
+        return response;
+    }
+
+private:
+    HostTransport& inner;
+    FleetServer& server;
+    std::string serverHost;
+};
+
+// Child-side state reachable from the deep sleep handler
+static HostFleet::SharedWake* activeWake = nullptr;
+
+static void onFleetSleep() {
+    HostFleet::SharedWake* shared = activeWake;
+    HostRunner::fillReport(shared->report);
+    shared->report.slept = true;
+
+    size_t rtcSize = std::min(HostSleep::rtcMemorySize(), sizeof(shared->rtcMemory));
+    if (shared->report.rtcRetained && rtcSize > 0) {
+        memcpy(shared->rtcMemory, HostSleep::rtcMemory(), rtcSize);
+        shared->rtcSize = rtcSize;
+    } else {
+        shared->rtcSize = 0;
+    }
+
+    Serial.flush();
+    fflush(stdout);
+    _exit(0);
+}
+
+void HostFleet::runWake(SharedWake* shared, FleetServer& server, const std::string& stateDir,
+                        uint32_t device, uint32_t index, uint64_t epochMicros, bool synced) {
+    activeWake = shared;
+
+    HostClock::setVirtual(true);
+    HostClock::setMicros(0);
+    HostClock::setBootEpochMicros(epochMicros);
+    HostClock::setWallClockSynced(synced);
+
+    HostSleep::reset();
+    HostSleep::setWakeupCause(index == 0 ? ESP_SLEEP_WAKEUP_UNDEFINED : ESP_SLEEP_WAKEUP_TIMER);
+    HostSleep::setDeepSleepHandler(onFleetSleep);
+    if (shared->rtcSize > 0 && shared->rtcSize == HostSleep::rtcMemorySize()) {
+        memcpy(HostSleep::rtcMemory(), shared->rtcMemory, shared->rtcSize);
+    }
+
+    SPIFFS.mountDirectory(stateDir.c_str());
+    // One card directory cannot serve every unit; the slots stay empty
+    HostRunner::insertCard(std::string());
+
+    FixtureTransport* fixtures = new FixtureTransport(options.run.fixturesDir);
+    fixtures->setLatencyMs(options.run.httpLatencyMs);
+    FleetTransport* fleet = new FleetTransport(*fixtures, server, options.serverHost);
+    // Faults and link conditions differ per device and wake but repeat with the seed
+    uint32_t seed = options.seed * 2654435761u ^ device * 40503u ^ index;
+    NetworkConditionTransport* link = new NetworkConditionTransport(*fleet, options.run.network, seed);
+    HTTPClient::setTransport(new FaultInjectingTransport(*link, options.faults, seed));
+    WiFi.setConnectDelayMs(options.run.wifiConnectDelayMs);
+
+    Serial.setOutput(options.run.log ? stdout : nullptr);
+
+    setup();
+    while (HostClock::micros() < options.run.maxAwakeMs * 1000ULL) {
+        loop();
+    }
+
+    // The firmware stayed awake past the watchdog
+    HostRunner::fillReport(shared->report);
+    shared->report.slept = false;
+    fflush(stdout);
+    _exit(3);
+}
+
+bool HostFleet::run() {
+    devices.clear();
+    wakeAwakeSeconds.clear();
+    if (options.devices == 0) return false;
+
+    std::string stateRoot = options.run.stateDir;
+    if (stateRoot.empty()) {
+        char directory[] = "/tmp/inkplate_fleet_XXXXXX";
+        if (!mkdtemp(directory)) {
+            fprintf(stderr, "fleet: cannot create state directory\n");
+            return false;
+        }
+        stateRoot = directory;
+    } else {
+        mkdir(stateRoot.c_str(), 0755);
+    }
+
+    std::vector<std::string> stateDirs;
+    for (uint32_t i = 0; i < options.devices; i++) {
+        char name[32];
+        snprintf(name, sizeof(name), "/device_%04u", i);
+        HostRunOptions seeded = options.run;
+        seeded.stateDir = stateRoot + name;
+        if (!HostRunner::prepareStateDir(seeded)) return false;
+        stateDirs.push_back(seeded.stateDir);
+    }
+    fprintf(stderr, "fleet: %u devices, SPIFFS state in %s\n", options.devices, stateRoot.c_str());
+
+    // Long enough for the last power-on plus the run, and a wake past the end
+    uint64_t startMicros = options.run.startEpochSeconds * 1000000ULL;
+    uint64_t runMicros = options.days * 86400ULL * 1000000ULL;
+    uint64_t spanMs = (options.spreadSeconds + options.days * 86400ULL + 3600ULL) * 1000ULL;
+    size_t serverBytes = FleetServer::memorySize(spanMs);
+
+    void* wakeMemory = mmap(nullptr, sizeof(SharedWake), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    void* serverMemory = mmap(nullptr, serverBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (wakeMemory == MAP_FAILED || serverMemory == MAP_FAILED) {
+        perror("fleet: mmap");
+        return false;
+    }
+    SharedWake* shared = static_cast<SharedWake*>(wakeMemory);
+    FleetServer server(serverMemory, startMicros / 1000ULL, spanMs, options.server);
+
+    // Seeded power-on times (xorshift64*)
+    uint64_t state = options.seed ? options.seed : 1;
+    auto nextRandom = [&state]() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 2685821657736338717ULL;
+    };
+
+    struct DeviceState {
+        uint64_t wallMicros;
+        bool synced;
+        std::vector<uint8_t> rtc;
+    };
+    std::vector<DeviceState> states(options.devices);
+    typedef std::pair<uint64_t, uint32_t> Pending;
+    std::priority_queue<Pending, std::vector<Pending>, std::greater<Pending>> pending;
+
+    for (uint32_t i = 0; i < options.devices; i++) {
+        FleetDevice device;
+        device.index = i;
+        uint64_t spreadMicros = options.spreadSeconds * 1000000ULL;
+        device.powerOnEpochMicros = startMicros + (spreadMicros > 0 ? nextRandom() % spreadMicros : 0);
+        devices.push_back(device);
+        states[i].wallMicros = device.powerOnEpochMicros;
+        states[i].synced = false;
+        pending.push(Pending(device.powerOnEpochMicros, i));
+    }
+
+    bool ok = true;
+    while (!pending.empty()) {
+        uint32_t i = pending.top().second;
+        pending.pop();
+        FleetDevice& device = devices[i];
+        DeviceState& deviceState = states[i];
+
+        shared->report = WakeReport();
+        shared->report.index = device.wakes;
+        shared->report.startEpochMicros = deviceState.wallMicros;
+        shared->rtcSize = std::min(deviceState.rtc.size(), sizeof(shared->rtcMemory));
+        if (shared->rtcSize > 0) memcpy(shared->rtcMemory, deviceState.rtc.data(), shared->rtcSize);
+
+        fflush(stdout);
+        fflush(stderr);
+        pid_t child = fork();
+        if (child < 0) {
+            perror("fleet: fork");
+            ok = false;
+            break;
+        }
+        if (child == 0) {
+            runWake(shared, server, stateDirs[i], i, device.wakes, deviceState.wallMicros, deviceState.synced);
+        }
+
+        int status = 0;
+        waitpid(child, &status, 0);
+        const WakeReport& report = shared->report;
+        device.wakes++;
+        device.awakeMicros += report.awakeMicros;
+        device.radioOnMicros += report.radioOnMicros;
+        device.httpRequests += report.httpRequests;
+        wakeAwakeSeconds.push_back(report.awakeMicros / 1e6);
+
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || !report.slept || report.sleepMicros == 0) {
+            fprintf(stderr, "fleet: device %u wake %u ended without a timed deep sleep (status %d)\n",
+                    i, device.wakes - 1, status);
+            device.failed = true;
+            device.simulatedMicros = deviceState.wallMicros + report.awakeMicros - device.powerOnEpochMicros;
+            ok = false;
+            continue;
+        }
+
+        deviceState.rtc.assign(shared->rtcMemory, shared->rtcMemory + shared->rtcSize);
+        deviceState.synced = report.wallClockSynced;
+        deviceState.wallMicros += report.awakeMicros + report.sleepMicros;
+        device.simulatedMicros = deviceState.wallMicros - device.powerOnEpochMicros;
+        if (device.simulatedMicros < runMicros) {
+            pending.push(Pending(deviceState.wallMicros, i));
+        }
+    }
+
+    if (options.printDevices) {
+        for (const FleetDevice& device : devices) printDevice(stdout, device);
+    }
+    printSummary(stdout, server);
+
+    munmap(wakeMemory, sizeof(SharedWake));
+    munmap(serverMemory, serverBytes);
+    return ok;
+}
+
+void HostFleet::printDevice(FILE* out, const FleetDevice& device) const {
+    double days = device.simulatedMicros / 86400e6;
+    fprintf(out, "device %-4u on +%6.0fs  wakes %4u  awake %7.1fs  radio %7.1fs (%6.1fs/day)  http %5u%s\n",
+            device.index, (device.powerOnEpochMicros - options.run.startEpochSeconds * 1000000ULL) / 1e6,
+            device.wakes, device.awakeMicros / 1e6, device.radioOnMicros / 1e6,
+            days > 0 ? device.radioOnMicros / 1e6 / days : 0.0, device.httpRequests,
+            device.failed ? "  FAILED" : "");
+}
+
+void HostFleet::printSummary(FILE* out, const FleetServer& server) const {
+    std::vector<double> radioPerDay;
+    uint32_t wakes = 0;
+    uint32_t failed = 0;
+    for (const FleetDevice& device : devices) {
+        double days = device.simulatedMicros / 86400e6;
+        if (days > 0) radioPerDay.push_back(device.radioOnMicros / 1e6 / days);
+        wakes += device.wakes;
+        if (device.failed) failed++;
+    }
+
+    fprintf(out, "fleet: %zu devices over %llu days, %u wakes, %u devices failed\n",
+            devices.size(), static_cast<unsigned long long>(options.days), wakes, failed);
+    fprintf(out, "  radio-on per device-day  p50 %7.1fs  p90 %7.1fs  p99 %7.1fs  max %7.1fs\n",
+            FleetServer::percentile(radioPerDay, 50), FleetServer::percentile(radioPerDay, 90),
+            FleetServer::percentile(radioPerDay, 99), FleetServer::percentile(radioPerDay, 100));
+    fprintf(out, "  awake per wake           p50 %7.1fs  p90 %7.1fs  p99 %7.1fs  max %7.1fs\n",
+            FleetServer::percentile(wakeAwakeSeconds, 50), FleetServer::percentile(wakeAwakeSeconds, 90),
+            FleetServer::percentile(wakeAwakeSeconds, 99), FleetServer::percentile(wakeAwakeSeconds, 100));
+    fprintf(out, "  server: %llu requests, %.3f/s mean, %u/s peak, %.1f MB sent, "
+                 "latency p50 %ums p90 %ums p99 %ums\n",
+            static_cast<unsigned long long>(server.getRequests()), server.getMeanRequestsPerSecond(),
+            server.getPeakRequestsPerSecond(), server.getResponseBytes() / 1e6,
+            server.latencyPercentile(50), server.latencyPercentile(90), server.latencyPercentile(99));
+}
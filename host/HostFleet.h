@@ -0,0 +1,82 @@
+#ifndef HOST_FLEET_H
+#define HOST_FLEET_H
+
+#include "FleetServer.h"
+#include "HostRunner.h"
+#include "HostTransport.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/**
+ * Options for a fleet run. run supplies the data, config and fixture
+ * directories, start time, WiFi timing, the latency of hosts other than
+ * the image server and logging; stateDir (default: a temp dir) gets one
+ * SPIFFS copy per device.
+ */
+struct HostFleetOptions {
+    HostRunOptions run;
+    uint32_t devices = 50;
+    uint64_t days = 1;
+    uint32_t spreadSeconds = 3600;      // Power-on times spread over this
+    std::string serverHost;             // Host behind the load model (empty: every request)
+    FleetServerModel server;
+    FaultInjectingTransport::Rates faults;
+    uint32_t seed = 1;
+    bool printDevices = false;          // One line per device on stdout
+};
+
+/**
+ * What one simulated device did over the run
+ */
+struct FleetDevice {
+    uint32_t index = 0;
+    uint64_t powerOnEpochMicros = 0;
+    uint64_t simulatedMicros = 0;       // Power-on to the end of its last wake or sleep
+    uint32_t wakes = 0;
+    uint64_t awakeMicros = 0;
+    uint64_t radioOnMicros = 0;
+    uint32_t httpRequests = 0;
+    bool failed = false;                // A wake crashed, hung or armed no timer
+};
+
+/**
+ * Many units of the firmware against one image server.
+ *
+ * Each device has its own SPIFFS copy and RTC memory and runs its wake
+ * cycles like HostRunner, each wake a forked child on the virtual clock.
+ * Wakes of all devices run in order of their simulated start time, and
+ * every request to the image server books time on one shared FleetServer,
+ * so devices that wake together queue behind each other. The latency they
+ * see moves their virtual clock: radio-on and awake time grow with server
+ * load just as they would in the field. Power-on times are spread at
+ * random (seeded) to model a fleet that is not in lockstep; set the spread
+ * to 0 for everyone coming back after a power cut.
+ */
+class HostFleet {
+public:
+    explicit HostFleet(const HostFleetOptions& options) : options(options) {}
+
+    // Returns false if the setup failed or any device failed
+    bool run();
+
+    const std::vector<FleetDevice>& getDevices() const { return devices; }
+    const std::vector<double>& getWakeAwakeSeconds() const { return wakeAwakeSeconds; }
+
+    void printDevice(FILE* out, const FleetDevice& device) const;
+    void printSummary(FILE* out, const FleetServer& server) const;
+
+    // Memory shared by the parent and the current wake (HostFleet.cpp)
+    struct SharedWake;
+
+private:
+    HostFleetOptions options;
+    std::vector<FleetDevice> devices;
+    std::vector<double> wakeAwakeSeconds;
+
+    // Child side; never returns
+    void runWake(SharedWake* shared, FleetServer& server, const std::string& stateDir,
+                 uint32_t device, uint32_t index, uint64_t epochMicros, bool synced);
+};
+
+#endif
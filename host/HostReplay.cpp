@@ -0,0 +1,194 @@
+#include "HostReplay.h"
+#include "HostClock.h"
+#include "HostSleep.h"
+#include "HostTransport.h"
+#include "HTTPClient.h"
+#include "SD.h"
+#include "SPIFFS.h"
+#include "TraceReplay.h"
+#include "WiFi.h"
+#include <algorithm>
+#include <ctime>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Firmware entry points (src/main.cpp)
+void setup();
+void loop();
+
+/**
+ * Memory shared between the parent and the replaying child
+ */
+struct HostReplay::SharedRun {
+    ReplayRun run;
+};
+
+// Child-side state reachable from the deep sleep handler
+static HostReplay::SharedRun* activeRun = nullptr;
+static TraceReplay* activeReplay = nullptr;
+static uint64_t cpuStartMicros = 0;
+
+static uint64_t cpuMicros() {
+    struct timespec now;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000ULL + static_cast<uint64_t>(now.tv_nsec) / 1000ULL;
+}
+
+static void finishRun(bool slept) {
+    ReplayRun& run = activeRun->run;
+    run.cpuMicros = cpuMicros() - cpuStartMicros;
+    HostRunner::fillReport(run.report);
+    run.report.slept = slept;
+    TraceTransport* transport = activeReplay->getTransport();
+    run.httpReplayed = transport ? transport->getReplayed() : 0;
+    run.divergences = activeReplay->getDivergences();
+}
+
+static void onReplaySleep() {
+    finishRun(true);
+    Serial.flush();
+    fflush(stdout);
+    _exit(0);
+}
+
+static const char* wakeCauseName(uint8_t cause) {
+    switch (cause) {
+        case ESP_SLEEP_WAKEUP_EXT0: return "button";
+        case ESP_SLEEP_WAKEUP_TIMER: return "timer";
+        case ESP_SLEEP_WAKEUP_UNDEFINED: return "power-on";
+        default: return "other";
+    }
+}
+
+void HostReplay::runOnce(SharedRun* shared) {
+    activeRun = shared;
+
+    HostClock::setVirtual(true);
+    HostClock::setMicros(0);
+    HostSleep::reset();
+    HostSleep::setDeepSleepHandler(onReplaySleep);
+
+    // Load the state but keep writes in this child, so repetitions match
+    SPIFFS.mountDirectory(options.run.stateDir.c_str());
+    SPIFFS.unmountDirectory();
+    HostRunner::insertCard(options.run.sdDir);
+    SD.unmountDirectory();
+
+    FixtureTransport* fixtures = new FixtureTransport(options.run.fixturesDir);
+    fixtures->setLatencyMs(options.run.httpLatencyMs);
+    WiFi.setConnectDelayMs(options.run.wifiConnectDelayMs);
+
+    activeReplay->install(fixtures, options.run.startEpochSeconds * 1000000ULL);
+    HTTPClient::setTransport(activeReplay->getTransport());
+    Serial.setOutput(options.run.log ? stdout : nullptr);
+
+    cpuStartMicros = cpuMicros();
+    setup();
+    while (HostClock::micros() < options.run.maxAwakeMs * 1000ULL) {
+        activeReplay->poll();
+        loop();
+    }
+
+    // The firmware stayed awake past the watchdog
+    finishRun(false);
+    fflush(stdout);
+    _exit(3);
+}
+
+bool HostReplay::run() {
+    runs.clear();
+    TraceReplay replay;
+    if (!replay.load(options.tracePath)) return false;
+    recordedAwakeMs = replay.recordedAwakeMs();
+    recordedSleepMs = replay.recordedSleepMs();
+
+    const TraceHeader& header = replay.getHeader();
+    fprintf(stdout, "replay: %s, %s wake, RTC %s at boot%s\n", options.tracePath.c_str(),
+            wakeCauseName(header.wakeCause), header.clockValid ? "set" : "not set",
+            header.truncated ? ", trace truncated" : "");
+    fprintf(stdout, "  inputs: %zu http, %zu wifi, %zu sntp, %zu battery, %zu button\n",
+            replay.count(TraceEventType::HTTP), replay.count(TraceEventType::WIFI),
+            replay.count(TraceEventType::TIME_SYNC), replay.count(TraceEventType::BATTERY),
+            replay.count(TraceEventType::BUTTON));
+
+    if (!HostRunner::prepareStateDir(options.run)) return false;
+    fprintf(stderr, "replay: SPIFFS state in %s\n", options.run.stateDir.c_str());
+
+    void* memory = mmap(nullptr, sizeof(SharedRun), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        perror("replay: mmap");
+        return false;
+    }
+    SharedRun* shared = static_cast<SharedRun*>(memory);
+    activeReplay = &replay;
+    bool ok = true;
+
+    for (uint32_t index = 0; index < std::max<uint32_t>(options.repeat, 1); index++) {
+        shared->run = ReplayRun();
+        shared->run.report.index = index;
+
+        fflush(stdout);
+        fflush(stderr);
+        pid_t child = fork();
+        if (child < 0) {
+            perror("replay: fork");
+            ok = false;
+            break;
+        }
+        if (child == 0) {
+            runOnce(shared);
+        }
+
+        int status = 0;
+        waitpid(child, &status, 0);
+        runs.push_back(shared->run);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || !shared->run.report.slept) {
+            fprintf(stderr, "replay: run %u ended without deep sleep (status %d)\n", index, status);
+            ok = false;
+            break;
+        }
+    }
+
+    activeReplay = nullptr;
+    munmap(memory, sizeof(SharedRun));
+    printSummary(stdout);
+
+    // Every repetition saw the same inputs, so it must have done the same work
+    for (const ReplayRun& run : runs) {
+        const WakeReport& first = runs.front().report;
+        if (run.report.awakeMicros != first.awakeMicros || run.report.sleepMicros != first.sleepMicros ||
+            run.report.httpRequests != first.httpRequests ||
+            run.report.panel.fullRefreshes != first.panel.fullRefreshes ||
+            run.report.panel.partialRefreshes != first.panel.partialRefreshes) {
+            fprintf(stderr, "replay: run %u differs from run 0\n", run.report.index);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+void HostReplay::printSummary(FILE* out) const {
+    if (runs.empty()) return;
+    const ReplayRun& first = runs.front();
+
+    if (recordedAwakeMs > 0) {
+        fprintf(out, "  recorded: awake %7.2fs  sleep %8.1fs\n", recordedAwakeMs / 1e3, recordedSleepMs / 1e3);
+    } else {
+        fprintf(out, "  recorded: no deep sleep in the trace\n");
+    }
+    fprintf(out, "  replayed: awake %7.2fs  sleep %8.1fs  full %u partial %u  http %u (%u from trace)  "
+                 "divergences %u\n",
+            first.report.awakeMicros / 1e6, first.report.sleepMicros / 1e6,
+            first.report.panel.fullRefreshes, first.report.panel.partialRefreshes,
+            first.report.httpRequests, first.httpReplayed, first.divergences);
+
+    std::vector<uint64_t> cpu;
+    for (const ReplayRun& run : runs) {
+        cpu.push_back(run.cpuMicros);
+    }
+    std::sort(cpu.begin(), cpu.end());
+    fprintf(out, "  host cpu: min %.2f ms  median %.2f ms  max %.2f ms over %zu run%s\n",
+            cpu.front() / 1e3, cpu[cpu.size() / 2] / 1e3, cpu.back() / 1e3,
+            cpu.size(), cpu.size() == 1 ? "" : "s");
+}
@@ -0,0 +1,63 @@
+#ifndef HOST_REPLAY_H
+#define HOST_REPLAY_H
+
+#include "HostRunner.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/**
+ * Options for replaying a recorded wake. run supplies the data, state,
+ * config and fixture directories and logging; its wake count, days and
+ * timing settings are replaced by the trace.
+ */
+struct HostReplayOptions {
+    HostRunOptions run;
+    std::string tracePath;
+    uint32_t repeat = 1;                // Replays of the same wake, for timing
+};
+
+/**
+ * One replay of the traced wake
+ */
+struct ReplayRun {
+    WakeReport report;
+    uint64_t cpuMicros = 0;             // Host CPU time from setup() to deep sleep
+    uint32_t httpReplayed = 0;
+    uint32_t divergences = 0;           // See TraceReplay::getDivergences()
+};
+
+/**
+ * Replays one wake recorded on a device (/trace.bin, see InputTrace).
+ *
+ * Each repetition is a forked child that boots with the recorded wake
+ * cause and RTC time and runs setup()/loop() until deep sleep, with every
+ * external input served from the trace. SPIFFS writes stay in the child,
+ * so every repetition starts from the same state and must end the same
+ * way; the host CPU time per repetition makes the wake a benchmark.
+ */
+class HostReplay {
+public:
+    explicit HostReplay(const HostReplayOptions& options) : options(options) {}
+
+    // Returns false if the trace is unreadable, a replay did not sleep or
+    // repetitions disagreed
+    bool run();
+
+    const std::vector<ReplayRun>& getRuns() const { return runs; }
+    void printSummary(FILE* out) const;
+
+    // Memory shared by the parent and the replaying child (HostReplay.cpp)
+    struct SharedRun;
+
+private:
+    HostReplayOptions options;
+    std::vector<ReplayRun> runs;
+    uint32_t recordedAwakeMs = 0;
+    uint32_t recordedSleepMs = 0;
+
+    // Child side; never returns
+    void runOnce(SharedRun* shared);
+};
+
+#endif
@@ -0,0 +1,265 @@
+#include "HostRunner.h"
+#include "HostClock.h"
+#include "HostSleep.h"
+#include "HostTransport.h"
+#include "HTTPClient.h"
+#include "SD.h"
+#include "SPIFFS.h"
+#include "TelemetrySink.h"
+#include "WiFi.h"
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Firmware entry points (src/main.cpp)
+void setup();
+void loop();
+
+/**
+ * Memory shared between the parent and the wake it forked
+ */
+struct HostRunner::SharedWake {
+    static const size_t RTC_MEMORY_SIZE = 8192;  // ESP32 RTC slow memory
+
+    WakeReport report;
+    size_t rtcSize;                              // 0 until a wake kept RTC memory
+    uint8_t rtcMemory[RTC_MEMORY_SIZE];
+};
+
+// Child-side state reachable from the deep sleep handler
+static HostRunner::SharedWake* activeWake = nullptr;
+static FixtureTransport* activeTransport = nullptr;
+
+void HostRunner::fillReport(WakeReport& report) {
+    report.awakeMicros = HostClock::micros();
+    report.sleepMicros = HostSleep::isTimerWakeupEnabled() ? HostSleep::getTimerWakeupUs() : 0;
+    report.wallClockSynced = HostClock::isWallClockSynced();
+    report.rtcRetained = HostSleep::rtcMemoryRetained();
+    report.ext0Armed = HostSleep::isExt0WakeupEnabled();
+    report.httpRequests = HTTPClient::getRequestCount();
+    report.wifiConnects = static_cast<uint32_t>(WiFi.getConnectCount());
+    report.radioOnMicros = WiFi.getRadioOnMicros();
+    report.rtcBytes = HostSleep::rtcMemorySize();
+    if (Inkplate* panel = Inkplate::primary()) {
+        report.panel = panel->getStats();
+    }
+}
+
+static void onDeepSleep() {
+    HostRunner::SharedWake* shared = activeWake;
+    HostRunner::fillReport(shared->report);
+    shared->report.slept = true;
+
+    // Powered-down RTC slow memory comes back as garbage; model it as lost
+    size_t rtcSize = std::min(HostSleep::rtcMemorySize(), sizeof(shared->rtcMemory));
+    if (shared->report.rtcRetained && rtcSize > 0) {
+        memcpy(shared->rtcMemory, HostSleep::rtcMemory(), rtcSize);
+        shared->rtcSize = rtcSize;
+    } else {
+        shared->rtcSize = 0;
+    }
+
+    Serial.flush();
+    fflush(stdout);
+    _exit(0);
+}
+
+void HostRunner::runWake(SharedWake* shared, uint32_t index, uint64_t epochMicros, bool synced) {
+    activeWake = shared;
+
+    HostClock::setVirtual(true);
+    HostClock::setMicros(0);
+    HostClock::setBootEpochMicros(epochMicros);
+    HostClock::setWallClockSynced(synced);
+
+    HostSleep::reset();
+    HostSleep::setWakeupCause(index == 0 ? ESP_SLEEP_WAKEUP_UNDEFINED : ESP_SLEEP_WAKEUP_TIMER);
+    HostSleep::setDeepSleepHandler(onDeepSleep);
+    if (shared->rtcSize > 0 && shared->rtcSize == HostSleep::rtcMemorySize()) {
+        memcpy(HostSleep::rtcMemory(), shared->rtcMemory, shared->rtcSize);
+    }
+
+    SPIFFS.mountDirectory(options.stateDir.c_str());
+    insertCard(options.sdDir);
+
+    activeTransport = new FixtureTransport(options.fixturesDir);
+    activeTransport->setLatencyMs(options.httpLatencyMs);
+    HostTransport* link = new NetworkConditionTransport(*activeTransport, options.network,
+                                                        options.networkSeed * 2654435761u ^ index);
+    if (options.telemetry) {
+        HTTPClient::setTransport(new TelemetrySink(*link, stdout));
+    } else {
+        HTTPClient::setTransport(link);
+    }
+    WiFi.setConnectDelayMs(options.wifiConnectDelayMs);
+
+    Serial.setOutput(options.log ? stdout : nullptr);
+
+    Inkplate* panel = Inkplate::primary();
+    if (panel && !options.captureDir.empty()) {
+        char directory[512];
+        snprintf(directory, sizeof(directory), "%s/wake_%05u", options.captureDir.c_str(), index);
+        mkdir(options.captureDir.c_str(), 0755);
+        mkdir(directory, 0755);
+        panel->setFrameCapture(directory, options.captureFormat);
+    }
+
+    setup();
+    while (HostClock::micros() < options.maxAwakeMs * 1000ULL) {
+        loop();
+    }
+
+    // The firmware stayed awake past the watchdog
+    fillReport(shared->report);
+    shared->report.slept = false;
+    fflush(stdout);
+    _exit(3);
+}
+
+void HostRunner::insertCard(const std::string& sdDir) {
+    SD.setCardPresent(!sdDir.empty());
+    if (!sdDir.empty()) {
+        mkdir(sdDir.c_str(), 0755);
+        SD.mountDirectory(sdDir.c_str());
+    }
+}
+
+bool HostRunner::prepareStateDir(HostRunOptions& options) {
+    if (options.stateDir.empty()) {
+        char directory[] = "/tmp/inkplate_host_XXXXXX";
+        if (!mkdtemp(directory)) {
+            fprintf(stderr, "host: cannot create state directory\n");
+            return false;
+        }
+        options.stateDir = directory;
+    } else {
+        mkdir(options.stateDir.c_str(), 0755);
+    }
+
+    // Seed the working copy so the firmware never writes into dataDir
+    fs::FS seed;
+    if (!options.dataDir.empty() && !seed.mountDirectory(options.dataDir.c_str())) {
+        fprintf(stderr, "host: data directory %s not found, starting with empty SPIFFS\n",
+                options.dataDir.c_str());
+    }
+    seed.unmountDirectory();
+
+    if (!options.configFile.empty()) {
+        std::ifstream config(options.configFile, std::ios::binary);
+        if (!config) {
+            fprintf(stderr, "host: config file %s not found\n", options.configFile.c_str());
+            return false;
+        }
+        std::ostringstream contents;
+        contents << config.rdbuf();
+        seed.writeFile("/config.json", contents.str());
+    }
+    return seed.exportDirectory(options.stateDir.c_str());
+}
+
+bool HostRunner::run() {
+    reports.clear();
+    if (!prepareStateDir(options)) return false;
+    fprintf(stderr, "host: SPIFFS state in %s\n", options.stateDir.c_str());
+
+    void* memory = mmap(nullptr, sizeof(SharedWake), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        perror("host: mmap");
+        return false;
+    }
+    SharedWake* shared = static_cast<SharedWake*>(memory);
+    shared->rtcSize = 0;
+
+    uint64_t startMicros = options.startEpochSeconds * 1000000ULL;
+    uint64_t endMicros = startMicros + options.days * 86400ULL * 1000000ULL;
+    uint64_t wallMicros = startMicros;
+    bool synced = false;  // Power-on: the RTC has never been set
+    bool ok = true;
+
+    for (uint32_t index = 0; options.days > 0 ? wallMicros < endMicros : index < options.wakes; index++) {
+        shared->report = WakeReport();
+        shared->report.index = index;
+        shared->report.startEpochMicros = wallMicros;
+
+        fflush(stdout);
+        fflush(stderr);
+        pid_t child = fork();
+        if (child < 0) {
+            perror("host: fork");
+            ok = false;
+            break;
+        }
+        if (child == 0) {
+            runWake(shared, index, wallMicros, synced);
+        }
+
+        int status = 0;
+        waitpid(child, &status, 0);
+        WakeReport report = shared->report;
+        reports.push_back(report);
+        if (options.printWakes) {
+            printReport(stdout, report);
+        }
+
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || !report.slept) {
+            fprintf(stderr, "host: wake %u ended without deep sleep (status %d)\n", index, status);
+            ok = false;
+            break;
+        }
+        if (report.sleepMicros == 0) {
+            fprintf(stderr, "host: wake %u armed no timer wakeup; stopping\n", index);
+            break;
+        }
+
+        // The RTC timer keeps counting through deep sleep
+        synced = report.wallClockSynced;
+        wallMicros += report.awakeMicros + report.sleepMicros;
+    }
+
+    munmap(memory, sizeof(SharedWake));
+    printSummary(stdout);
+    return ok;
+}
+
+void HostRunner::printReport(FILE* out, const WakeReport& report) const {
+    time_t start = static_cast<time_t>(report.startEpochMicros / 1000000ULL);
+    struct tm utc;
+    gmtime_r(&start, &utc);
+    char when[32];
+    strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", &utc);
+
+    fprintf(out, "wake %-5u %s UTC  awake %7.1fs  sleep %8.1fs  full %u partial %u  panel %5llums %7.1fmJ  "
+                 "http %u  radio %5.1fs  rtc %s\n",
+            report.index, when,
+            report.awakeMicros / 1e6, report.sleepMicros / 1e6,
+            report.panel.fullRefreshes, report.panel.partialRefreshes,
+            static_cast<unsigned long long>(report.panel.refreshMs), report.panel.energyMj,
+            report.httpRequests, report.radioOnMicros / 1e6,
+            report.rtcBytes == 0 ? "-" : (report.rtcRetained ? "kept" : "lost"));
+}
+
+void HostRunner::printSummary(FILE* out) const {
+    uint64_t awake = 0;
+    uint64_t asleep = 0;
+    uint64_t radio = 0;
+    uint64_t refreshes = 0;
+    uint64_t requests = 0;
+    for (const WakeReport& report : reports) {
+        awake += report.awakeMicros;
+        asleep += report.sleepMicros;
+        radio += report.radioOnMicros;
+        refreshes += report.panel.fullRefreshes + report.panel.partialRefreshes;
+        requests += report.httpRequests;
+    }
+
+    fprintf(out, "summary: %zu wakes over %.2f days, awake %.1f%%, radio %.1fs, %llu refreshes, %llu requests\n",
+            reports.size(), (awake + asleep) / 86400e6,
+            awake + asleep > 0 ? 100.0 * awake / (awake + asleep) : 0.0,
+            radio / 1e6, static_cast<unsigned long long>(refreshes), static_cast<unsigned long long>(requests));
+}
@@ -0,0 +1,93 @@
+#ifndef HOST_RUNNER_H
+#define HOST_RUNNER_H
+
+#include "HostTransport.h"
+#include "MockInkplate.h"
+#include <string>
+#include <vector>
+
+/**
+ * Options for a simulated deployment
+ */
+struct HostRunOptions {
+    std::string dataDir = "data";           // Initial SPIFFS contents (never modified)
+    std::string stateDir;                   // Working copy the firmware writes to (default: temp dir)
+    std::string configFile;                 // Replaces /config.json in the working copy
+    std::string fixturesDir;                // FixtureTransport root (empty: synthetic only)
+    std::string sdDir;                      // microSD card contents, kept across wakes (empty: no card)
+    std::string captureDir;                 // Per-wake frame capture (empty: off)
+    FrameWriter::Format captureFormat = FrameWriter::Format::PNG;
+    uint32_t wakes = 24;                    // Boot plus wakes-1 timer wakes
+    uint64_t days = 0;                      // If set, run until this much simulated time has passed
+    uint64_t startEpochSeconds = 1704067200ULL;  // 2024-01-01 00:00 UTC
+    uint32_t wifiConnectDelayMs = 1800;
+    uint32_t httpLatencyMs = 150;           // Server time per request
+    NetworkConditionTransport::Profile network;  // Link between unit and servers (default: ideal)
+    uint32_t networkSeed = 1;
+    uint64_t maxAwakeMs = 600000;           // Watchdog for a wake that never sleeps
+    bool log = false;                       // Firmware serial output to stdout
+    bool printWakes = true;                 // One line per wake on stdout
+    bool telemetry = false;                 // Decode image-request telemetry to stdout
+};
+
+/**
+ * What one wake cycle did, filled in by the child at esp_deep_sleep_start()
+ */
+struct WakeReport {
+    uint32_t index = 0;
+    uint64_t startEpochMicros = 0;
+    uint64_t awakeMicros = 0;
+    uint64_t sleepMicros = 0;               // Timer wakeup, 0 if none was armed
+    bool slept = false;                     // Reached esp_deep_sleep_start()
+    bool wallClockSynced = false;
+    bool rtcRetained = false;               // RTC slow memory stayed powered
+    bool ext0Armed = false;
+    PanelStats panel;
+    uint32_t httpRequests = 0;
+    uint32_t wifiConnects = 0;
+    uint64_t radioOnMicros = 0;
+    size_t rtcBytes = 0;                    // Size of the RTC_DATA_ATTR section
+};
+
+/**
+ * Runs the whole firmware (setup()/loop() from main.cpp) through a series
+ * of deep-sleep wake cycles on a virtual clock.
+ *
+ * Every wake is a forked child, so globals and statics start fresh like
+ * after a real deep sleep. The child boots with the emulated wall clock,
+ * restored RTC memory and the right wake cause, then runs loop() until the
+ * firmware calls esp_deep_sleep_start(). The parent advances the wall clock
+ * by the awake time plus the armed timer and starts the next wake. Weeks of
+ * operation take seconds because delay(), WiFi association, HTTP latency
+ * and panel refreshes only move the virtual clock.
+ */
+class HostRunner {
+public:
+    explicit HostRunner(const HostRunOptions& options) : options(options) {}
+
+    // Returns false if a wake crashed, hung or never armed a wakeup
+    bool run();
+
+    const std::vector<WakeReport>& getReports() const { return reports; }
+    void printReport(FILE* out, const WakeReport& report) const;
+    void printSummary(FILE* out) const;
+
+    // Memory shared by the parent and the current wake (HostRunner.cpp)
+    struct SharedWake;
+
+    // Seed options.stateDir (a temp dir if empty) from dataDir and configFile
+    static bool prepareStateDir(HostRunOptions& options);
+    // Put sdDir in the microSD slot, writes mirrored back (empty: slot stays empty)
+    static void insertCard(const std::string& sdDir);
+    // Fill in what the mocks saw during the current wake
+    static void fillReport(WakeReport& report);
+
+private:
+    HostRunOptions options;
+    std::vector<WakeReport> reports;
+
+    // Child side; never returns
+    void runWake(SharedWake* shared, uint32_t index, uint64_t epochMicros, bool synced);
+};
+
+#endif
@@ -0,0 +1,167 @@
+#include "HostSoak.h"
+#include "HostClock.h"
+#include "HostHeap.h"
+#include "HostSleep.h"
+#include "HTTPClient.h"
+#include "SPIFFS.h"
+#include "WiFi.h"
+#include <ArduinoJson.h>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+// Firmware entry points (src/main.cpp)
+void setup();
+void loop();
+
+static void onUnexpectedSleep() {
+    fprintf(stderr, "soak: firmware entered deep sleep; the soak needs Power.EnableDeepSleep off\n");
+    fflush(stdout);
+    _exit(3);
+}
+
+bool HostSoak::disableDeepSleep() {
+    std::string path = options.run.stateDir + "/config.json";
+    std::ifstream in(path);
+    if (!in) {
+        fprintf(stderr, "soak: %s not found; the soak needs a config\n", path.c_str());
+        return false;
+    }
+    std::ostringstream contents;
+    contents << in.rdbuf();
+    in.close();
+
+    JsonDocument doc;
+    DeserializationError error = deserializeJson(doc, contents.str().c_str());
+    if (error) {
+        fprintf(stderr, "soak: %s: %s\n", path.c_str(), error.c_str());
+        return false;
+    }
+    doc["Power"]["EnableDeepSleep"] = false;
+
+    std::string patched;
+    serializeJsonPretty(doc, patched);
+    std::ofstream out(path, std::ios::trunc);
+    out << patched;
+    return static_cast<bool>(out);
+}
+
+bool HostSoak::run() {
+    cycles.clear();
+    trends.clear();
+    faultCounts = FaultInjectingTransport::Counts();
+    if (!HostRunner::prepareStateDir(options.run) || !disableDeepSleep()) return false;
+    fprintf(stderr, "soak: SPIFFS state in %s\n", options.run.stateDir.c_str());
+
+    HostClock::setVirtual(true);
+    HostClock::setMicros(0);
+    HostClock::setBootEpochMicros(options.run.startEpochSeconds * 1000000ULL);
+    HostClock::setWallClockSynced(false);
+    HostSleep::reset();
+    HostSleep::setWakeupCause(ESP_SLEEP_WAKEUP_UNDEFINED);
+    HostSleep::setDeepSleepHandler(onUnexpectedSleep);
+    SPIFFS.mountDirectory(options.run.stateDir.c_str());
+    HostRunner::insertCard(options.run.sdDir);
+
+    FixtureTransport fixtures(options.run.fixturesDir);
+    fixtures.setLatencyMs(options.run.httpLatencyMs);
+    NetworkConditionTransport link(fixtures, options.run.network, options.run.networkSeed);
+    FaultInjectingTransport transport(link, options.faults, options.seed);
+    HTTPClient::setTransport(&transport);
+    WiFi.setConnectDelayMs(options.run.wifiConnectDelayMs);
+    Serial.setOutput(options.run.log ? stdout : nullptr);
+
+    uint64_t cycleMicros = options.cycleMinutes * 60ULL * 1000000ULL;
+    uint64_t endMicros = options.days * 86400ULL * 1000000ULL;
+    // Growing the sample vector mid-run would show up as a leak
+    cycles.reserve(static_cast<size_t>(endMicros / cycleMicros) + 1);
+
+    if (!HostHeap::enableDeviceModel(true)) {
+        fprintf(stderr, "soak: cannot map the device heap model\n");
+        return false;
+    }
+
+    uint64_t boundary = cycleMicros;
+    HostHeap::resetPeak();
+    HostHeap::Counters previous = HostHeap::snapshot();
+    uint64_t previousFailures = 0;
+    uint32_t previousRequests = HTTPClient::getRequestCount();
+    uint32_t previousFaults = 0;
+
+    setup();
+    while (HostClock::micros() < endMicros) {
+        loop();
+        if (HostClock::micros() < boundary) continue;
+
+        HostHeap::Counters now = HostHeap::snapshot();
+        HostHeap::DeviceHeap internal = HostHeap::deviceHeap(HostHeap::Region::INTERNAL);
+        const FaultInjectingTransport::Counts& counts = transport.getCounts();
+        uint32_t faults = counts.errors + counts.slow + counts.malformed;
+
+        SoakCycle cycle;
+        cycle.index = static_cast<uint32_t>(cycles.size());
+        cycle.endMicros = HostClock::micros();
+        cycle.retainedBytes = now.liveBytes;
+        cycle.retainedBlocks = now.liveBlocks;
+        cycle.highWaterBytes = now.peakLiveBytes;
+        cycle.allocations = now.allocations - previous.allocations;
+        cycle.freeInternal = internal.freeBytes;
+        cycle.largestFreeInternal = internal.largestFreeBlock;
+        cycle.largestFreePsram = HostHeap::deviceHeap(HostHeap::Region::PSRAM).largestFreeBlock;
+        cycle.failedAllocations = HostHeap::deviceAllocationFailures() - previousFailures;
+        cycle.httpRequests = HTTPClient::getRequestCount() - previousRequests;
+        cycle.faults = faults - previousFaults;
+        cycles.push_back(cycle);
+        if (options.printCycles) {
+            printCycle(stdout, cycle);
+        }
+
+        HostHeap::resetPeak();
+        previous = HostHeap::snapshot();
+        previousFailures = HostHeap::deviceAllocationFailures();
+        previousRequests = HTTPClient::getRequestCount();
+        previousFaults = faults;
+        boundary += cycleMicros;
+    }
+
+    faultCounts = transport.getCounts();
+    HostHeap::enableDeviceModel(false);
+    HTTPClient::setTransport(nullptr);
+
+    trends = SoakAnalyzer::analyze(cycles, options.limits);
+    printSummary(stdout);
+
+    return SoakAnalyzer::passed(cycles, trends);
+}
+
+void HostSoak::printCycle(FILE* out, const SoakCycle& cycle) const {
+    fprintf(out, "cycle %-4u day %6.2f  live %8zu B %6zu blocks  peak %8zu B  allocs %7llu  "
+                 "largest free %7zu B  psram %8zu B  http %3u  faults %2u  failed %llu\n",
+            cycle.index, cycle.endMicros / 86400e6,
+            cycle.retainedBytes, cycle.retainedBlocks, cycle.highWaterBytes,
+            static_cast<unsigned long long>(cycle.allocations),
+            cycle.largestFreeInternal, cycle.largestFreePsram,
+            cycle.httpRequests, cycle.faults,
+            static_cast<unsigned long long>(cycle.failedAllocations));
+}
+
+void HostSoak::printSummary(FILE* out) const {
+    uint64_t failed = 0;
+    for (const SoakCycle& cycle : cycles) {
+        failed += cycle.failedAllocations;
+    }
+
+    fprintf(out, "soak: %zu cycles over %.2f days, %u requests, faults: %u errors, %u slow, %u malformed\n",
+            cycles.size(), cycles.empty() ? 0.0 : cycles.back().endMicros / 86400e6,
+            faultCounts.requests, faultCounts.errors, faultCounts.slow, faultCounts.malformed);
+    if (trends.empty()) {
+        fprintf(out, "  not enough cycles after %u warm-up cycles to fit trends\n", options.limits.warmupCycles);
+    }
+    for (const SoakTrend& trend : trends) {
+        fprintf(out, "  %-20s mean %12.1f  change %+10.1f  limit %9.1f  %6.1f se  %s\n",
+                trend.metric, trend.mean, trend.change, trend.limit, trend.significance,
+                trend.failed ? "FAIL" : "ok");
+    }
+    fprintf(out, "  device allocation failures %llu  %s\n", static_cast<unsigned long long>(failed),
+            failed > 0 ? "FAIL" : "ok");
+}
@@ -0,0 +1,64 @@
+#ifndef HOST_SOAK_H
+#define HOST_SOAK_H
+
+#include "HostRunner.h"
+#include "HostTransport.h"
+#include "SoakAnalyzer.h"
+#include <cstdio>
+#include <vector>
+
+/**
+ * Options for a soak run. run supplies the data, state, config and fixture
+ * directories, start time, WiFi and HTTP timing and logging; its wake
+ * count and capture settings are not used.
+ */
+struct HostSoakOptions {
+    HostRunOptions run;
+    uint64_t days = 14;
+    uint32_t cycleMinutes = 60;
+    FaultInjectingTransport::Rates faults;
+    uint32_t seed = 1;
+    SoakLimits limits;
+    bool printCycles = true;            // One line per cycle on stdout
+
+    HostSoakOptions() {
+        faults.error = 0.05f;
+        faults.slow = 0.05f;
+        faults.malformed = 0.05f;
+    }
+};
+
+/**
+ * Long-run test of an always-on unit.
+ *
+ * Runs setup() once and then loop() for simulated weeks in this process,
+ * with Power.EnableDeepSleep forced off and a share of HTTP responses
+ * failing, timing out or arriving corrupted. The heap is replayed on the
+ * device model (HostHeap) and sampled every cycle: retained bytes, high-water
+ * mark, allocation count and largest free block. The run fails when any of
+ * them trends the wrong way or a device allocation would have failed, which
+ * is how leaks and fragmentation show up before they hit the field.
+ */
+class HostSoak {
+public:
+    explicit HostSoak(const HostSoakOptions& options) : options(options) {}
+
+    // Returns false if a trend failed, an allocation failed or the firmware slept
+    bool run();
+
+    const std::vector<SoakCycle>& getCycles() const { return cycles; }
+    const std::vector<SoakTrend>& getTrends() const { return trends; }
+
+    void printCycle(FILE* out, const SoakCycle& cycle) const;
+    void printSummary(FILE* out) const;
+
+private:
+    HostSoakOptions options;
+    std::vector<SoakCycle> cycles;
+    std::vector<SoakTrend> trends;
+    FaultInjectingTransport::Counts faultCounts;
+
+    bool disableDeepSleep();
+};
+
+#endif
@@ -0,0 +1,588 @@
+#include "RenderServer.h"
+#include "HostClock.h"
+#include "HostSleep.h"
+#include "HostTransport.h"
+#include "HTTPClient.h"
+#include "SD.h"
+#include "SPIFFS.h"
+#include "WiFi.h"
+#include "managers/LayoutManager.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <fstream>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Firmware entry points and layout (src/main.cpp)
+void setup();
+void loop();
+extern LayoutManager layoutManager;
+
+static const uint32_t RENDER_MAGIC = 0x31525049;  // "IPR1"
+static const size_t MAX_REQUEST_BYTES = 8192;
+static const size_t MAX_CONNECTIONS = 64;
+
+/**
+ * A client socket: request bytes in, then the response out
+ */
+struct RenderServer::Connection {
+    int fd = -1;
+    std::string input;
+    std::string output;
+    size_t sent = 0;
+    bool waiting = false;               // For the render of configHash
+    uint64_t configHash = 0;
+    uint32_t since = 0;
+    uint8_t mode = 1;
+    bool png = false;
+};
+
+/**
+ * A render child and what it has sent back so far
+ */
+struct RenderServer::Render {
+    uint64_t configHash = 0;
+    uint64_t dataVersion = 0;
+    std::string stateDir;
+    pid_t pid = -1;                     // -1 while queued
+    int fd = -1;
+    std::vector<uint8_t> output;
+};
+
+static volatile sig_atomic_t stopRequested = 0;
+
+static void onStopSignal(int) {
+    stopRequested = 1;
+}
+
+// Child-side pipe to the parent, written from the deep sleep handler
+static int renderFd = -1;
+
+static bool writeAll(int fd, const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    while (size > 0) {
+        ssize_t written = write(fd, bytes, size);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) return false;
+        bytes += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+static void onRendered() {
+    // Header, regions, then one gray level per pixel
+    Inkplate* panel = Inkplate::primary();
+    bool ok = panel != nullptr;
+    if (ok) {
+        uint32_t header[4] = {RENDER_MAGIC, static_cast<uint32_t>(panel->width()),
+                              static_cast<uint32_t>(panel->height()),
+                              static_cast<uint32_t>(layoutManager.getRegionCount())};
+        ok = writeAll(renderFd, header, sizeof(header));
+        for (size_t i = 0; ok && i < layoutManager.getRegionCount(); i++) {
+            const LayoutRegion* region = layoutManager.getRegion(i);
+            int32_t bounds[4] = {region->getX(), region->getY(), region->getWidth(), region->getHeight()};
+            ok = writeAll(renderFd, bounds, sizeof(bounds));
+        }
+
+        std::vector<uint8_t> levels(static_cast<size_t>(panel->width()) * panel->height());
+        for (int y = 0; y < panel->height(); y++) {
+            for (int x = 0; x < panel->width(); x++) {
+                levels[static_cast<size_t>(y) * panel->width() + x] = panel->getPanelPixel(x, y);
+            }
+        }
+        ok = ok && writeAll(renderFd, levels.data(), levels.size());
+    }
+    close(renderFd);
+    Serial.flush();
+    _exit(ok ? 0 : 4);
+}
+
+static uint64_t wallClockSeconds() {
+    // Real time: time() is the firmware's emulated clock on the host
+    struct timeval now;
+    gettimeofday(&now, nullptr);
+    return static_cast<uint64_t>(now.tv_sec);
+}
+
+static std::string httpResponse(int status, const char* type, const void* body, size_t size,
+                                const std::string& extraHeaders = std::string()) {
+    const char* reason = status == 200 ? "OK" : status == 304 ? "Not Modified" : status == 400 ? "Bad Request" :
+                         status == 404 ? "Not Found" : "Service Unavailable";
+    char head[256];
+    snprintf(head, sizeof(head),
+             "HTTP/1.1 %d %s\r\nContent-Type: %s\r\nContent-Length: %zu\r\nCache-Control: no-store\r\n"
+             "Connection: close\r\n",
+             status, reason, type, size);
+    std::string response = head;
+    response += extraHeaders;
+    response += "\r\n";
+    response.append(static_cast<const char*>(body), size);
+    return response;
+}
+
+static std::string textResponse(int status, const std::string& text) {
+    return httpResponse(status, "text/plain", text.data(), text.size());
+}
+
+RenderServer::RenderServer(const RenderServerOptions& options)
+    : options(options), cache(static_cast<uint32_t>(wallClockSeconds()), options.history) {}
+
+RenderServer::~RenderServer() {
+    for (auto& connection : connections) close(connection->fd);
+    for (auto& render : renders) {
+        if (render->pid > 0) {
+            kill(render->pid, SIGKILL);
+            waitpid(render->pid, nullptr, 0);
+            close(render->fd);
+        }
+    }
+    if (listenFd >= 0) close(listenFd);
+}
+
+bool RenderServer::parseRequest(const std::string& head, std::string& path, std::string& query) {
+    size_t lineEnd = head.find("\r\n");
+    std::string line = head.substr(0, lineEnd);
+    if (line.compare(0, 4, "GET ") != 0) return false;
+
+    size_t targetEnd = line.find(' ', 4);
+    if (targetEnd == std::string::npos || line.compare(targetEnd + 1, 5, "HTTP/") != 0) return false;
+    std::string target = line.substr(4, targetEnd - 4);
+    if (target.empty() || target[0] != '/') return false;
+
+    size_t mark = target.find('?');
+    path = target.substr(0, mark);
+    query = mark == std::string::npos ? std::string() : target.substr(mark + 1);
+    return true;
+}
+
+bool RenderServer::isValidName(const std::string& name) {
+    if (name.empty() || name.size() > 64) return false;
+    for (char c : name) {
+        if (!isalnum(static_cast<unsigned char>(c)) && c != '-' && c != '_') return false;
+    }
+    return true;
+}
+
+uint64_t RenderServer::fixturesFingerprint(const std::string& directory) {
+    // Names, sizes and modification times of every file below directory
+    uint64_t fingerprint = FrameCache::hash(directory.data(), directory.size());
+    DIR* dir = directory.empty() ? nullptr : opendir(directory.c_str());
+    if (!dir) return fingerprint;
+
+    std::vector<std::string> names;
+    while (struct dirent* entry = readdir(dir)) {
+        if (entry->d_name[0] != '.') names.push_back(entry->d_name);
+    }
+    closedir(dir);
+    std::sort(names.begin(), names.end());
+
+    for (const std::string& name : names) {
+        std::string path = directory + "/" + name;
+        struct stat info;
+        if (stat(path.c_str(), &info) != 0) continue;
+
+        fingerprint = FrameCache::hash(name.data(), name.size(), fingerprint);
+        if (S_ISDIR(info.st_mode)) {
+            uint64_t nested = fixturesFingerprint(path);
+            fingerprint = FrameCache::hash(&nested, sizeof(nested), fingerprint);
+        } else {
+            uint64_t stamp[3] = {static_cast<uint64_t>(info.st_size), static_cast<uint64_t>(info.st_mtim.tv_sec),
+                                 static_cast<uint64_t>(info.st_mtim.tv_nsec)};
+            fingerprint = FrameCache::hash(stamp, sizeof(stamp), fingerprint);
+        }
+    }
+    return fingerprint;
+}
+
+uint64_t RenderServer::dataVersion(uint64_t fixtures, uint64_t epochSeconds, uint32_t tickSeconds) {
+    // Synthetic weather changes every three hours (FixtureTransport)
+    uint64_t parts[3] = {fixtures, epochSeconds / 10800ULL, tickSeconds > 0 ? epochSeconds / tickSeconds : 0};
+    return FrameCache::hash(parts, sizeof(parts));
+}
+
+bool RenderServer::resolveConfig(const std::string& name, std::string& path, std::string& contents) const {
+    if (name == "default") {
+        path = !options.run.configFile.empty() ? options.run.configFile : options.run.dataDir + "/config.json";
+    } else if (!options.configsDir.empty() && isValidName(name)) {
+        path = options.configsDir + "/" + name + ".json";
+    } else {
+        return false;
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+    std::ostringstream text;
+    text << file.rdbuf();
+    contents = text.str();
+    return true;
+}
+
+std::string RenderServer::statusText() const {
+    size_t running = 0;
+    for (const auto& render : renders) {
+        if (render->pid > 0) running++;
+    }
+
+    char text[256];
+    snprintf(text, sizeof(text), "configs %zu\nrenders %u\nreused %u\nrendering %zu\nqueued %zu\nconnections %zu\n",
+             cache.getConfigCount(), cache.getRenders(), cache.getReused(), running, renders.size() - running,
+             connections.size());
+    return text;
+}
+
+void RenderServer::answer(Connection& connection, uint64_t configHash, const RenderedFrame& frame) {
+    connection.waiting = false;
+    char idHeader[48];
+    snprintf(idHeader, sizeof(idHeader), "X-Frame-Id: %u\r\n", frame.id);
+
+    if (connection.png) {
+        std::vector<uint8_t> gray(frame.levels.size());
+        for (size_t i = 0; i < gray.size(); i++) {
+            gray[i] = static_cast<uint8_t>(frame.levels[i] * 255 / 7);
+        }
+        std::vector<uint8_t> png;
+        FrameWriter::encodePng(gray.data(), frame.width, frame.height, png);
+        connection.output = httpResponse(200, "image/png", png.data(), png.size(), idHeader);
+        return;
+    }
+
+    std::vector<uint8_t> body;
+    int status = cache.answer(configHash, frame, connection.since, connection.mode, body);
+    connection.output = httpResponse(status, "application/octet-stream", body.data(), body.size(), idHeader);
+}
+
+bool RenderServer::handleRequest(Connection& connection) {
+    std::string path;
+    std::string query;
+    if (!parseRequest(connection.input, path, query)) {
+        connection.output = textResponse(400, "Bad request\n");
+        return true;
+    }
+
+    if (path == "/status") {
+        connection.output = textResponse(200, statusText());
+        return true;
+    }
+
+    static const std::string prefix = "/frame/";
+    std::string name = path.compare(0, prefix.size(), prefix) == 0 ? path.substr(prefix.size()) : std::string();
+    connection.png = name.size() > 4 && name.compare(name.size() - 4, 4, ".png") == 0;
+    if (connection.png) name.erase(name.size() - 4);
+
+    std::string configPath;
+    std::string contents;
+    if (name.empty() || !resolveConfig(name, configPath, contents)) {
+        connection.output = textResponse(404, "Unknown config\n");
+        return true;
+    }
+
+    connection.configHash = FrameCache::hash(contents.data(), contents.size());
+    connection.since = static_cast<uint32_t>(strtoul(HostTransport::queryParam(query, "since", "0").c_str(), nullptr, 10));
+    std::string mode = HostTransport::queryParam(query, "mode");
+    connection.mode = mode == "1bit" ? 0 : mode == "3bit" ? 1 : options.fullMode;
+
+    uint64_t version = dataVersion(fixturesFingerprint(options.run.fixturesDir), wallClockSeconds(), options.tickSeconds);
+    if (const RenderedFrame* frame = cache.find(connection.configHash, version)) {
+        answer(connection, connection.configHash, *frame);
+        return true;
+    }
+
+    // One render per config at a time; later requests wait for it
+    connection.waiting = true;
+    for (const auto& render : renders) {
+        if (render->configHash == connection.configHash) return true;
+    }
+
+    char hex[17];
+    snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(connection.configHash));
+    std::unique_ptr<Render> render(new Render());
+    render->configHash = connection.configHash;
+    render->dataVersion = version;
+    render->stateDir = stateRoot + "/" + hex;
+
+    struct stat info;
+    if (stat(render->stateDir.c_str(), &info) != 0) {
+        HostRunOptions seed = options.run;
+        seed.stateDir = render->stateDir;
+        seed.configFile = configPath;
+        if (!HostRunner::prepareStateDir(seed)) {
+            connection.waiting = false;
+            connection.output = textResponse(503, "Cannot prepare render state\n");
+            return true;
+        }
+    }
+    renders.push_back(std::move(render));
+    return true;
+}
+
+bool RenderServer::startRender(Render& render) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        perror("render-server: pipe");
+        return false;
+    }
+
+    fflush(stdout);
+    fflush(stderr);
+    pid_t child = fork();
+    if (child < 0) {
+        perror("render-server: fork");
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+    if (child == 0) {
+        close(fds[0]);
+        close(listenFd);
+        for (auto& connection : connections) close(connection->fd);
+        for (auto& other : renders) {
+            if (other->pid > 0) close(other->fd);
+        }
+        runRender(fds[1], render.stateDir);
+    }
+
+    close(fds[1]);
+    fcntl(fds[0], F_SETFL, O_NONBLOCK);
+    render.pid = child;
+    render.fd = fds[0];
+    return true;
+}
+
+void RenderServer::runRender(int fd, const std::string& stateDir) {
+    renderFd = fd;
+
+    // A timer wake with the clock set: no power-on demo, no SNTP wait
+    HostClock::setVirtual(true);
+    HostClock::setMicros(0);
+    HostClock::setBootEpochMicros(wallClockSeconds() * 1000000ULL);
+    HostClock::setWallClockSynced(true);
+
+    HostSleep::reset();
+    HostSleep::setWakeupCause(ESP_SLEEP_WAKEUP_TIMER);
+    HostSleep::setDeepSleepHandler(onRendered);
+
+    // Writes stay in the child: every render starts from the seeded state
+    // and fetches its data afresh instead of reusing a widget's cache
+    SPIFFS.mountDirectory(stateDir.c_str());
+    SPIFFS.unmountDirectory();
+    HostRunner::insertCard(options.run.sdDir);
+    SD.unmountDirectory();
+
+    FixtureTransport* transport = new FixtureTransport(options.run.fixturesDir);
+    transport->setLatencyMs(0);
+    HTTPClient::setTransport(transport);
+    WiFi.setConnectDelayMs(0);
+
+    Serial.setOutput(options.run.log ? stderr : nullptr);
+
+    setup();
+    while (HostClock::micros() < options.run.maxAwakeMs * 1000ULL) {
+        loop();
+    }
+
+    // Never went to sleep, so never drew a finished screen
+    close(fd);
+    _exit(3);
+}
+
+void RenderServer::finishRender(Render& render, bool ok) {
+    const RenderedFrame* frame = nullptr;
+    const uint8_t* data = render.output.data();
+    size_t size = render.output.size();
+    uint32_t header[4];
+
+    if (ok && size >= sizeof(header)) {
+        memcpy(header, data, sizeof(header));
+        size_t regionBytes = static_cast<size_t>(header[3]) * 4 * sizeof(int32_t);
+        size_t pixels = static_cast<size_t>(header[1]) * header[2];
+        ok = header[0] == RENDER_MAGIC && size == sizeof(header) + regionBytes + pixels;
+        if (ok) {
+            std::vector<FrameRegion> regions(header[3]);
+            for (size_t i = 0; i < regions.size(); i++) {
+                int32_t bounds[4];
+                memcpy(bounds, data + sizeof(header) + i * sizeof(bounds), sizeof(bounds));
+                regions[i] = FrameRegion{bounds[0], bounds[1], bounds[2], bounds[3]};
+            }
+            const uint8_t* levels = data + sizeof(header) + regionBytes;
+            frame = &cache.store(render.configHash, render.dataVersion, static_cast<int>(header[1]),
+                                 static_cast<int>(header[2]), std::vector<uint8_t>(levels, levels + pixels),
+                                 std::move(regions));
+        }
+    }
+
+    if (!frame) {
+        // Keep serving the last good screen while renders fail
+        fprintf(stderr, "render-server: render of config %016llx failed\n",
+                static_cast<unsigned long long>(render.configHash));
+        frame = cache.latest(render.configHash);
+    }
+
+    for (auto& connection : connections) {
+        if (!connection->waiting || connection->configHash != render.configHash) continue;
+        if (frame) {
+            answer(*connection, render.configHash, *frame);
+        } else {
+            connection->waiting = false;
+            connection->output = textResponse(503, "Render failed\n");
+        }
+    }
+}
+
+bool RenderServer::run() {
+    if (options.run.stateDir.empty()) {
+        char directory[] = "/tmp/inkplate_render_XXXXXX";
+        if (!mkdtemp(directory)) {
+            fprintf(stderr, "render-server: cannot create state directory\n");
+            return false;
+        }
+        stateRoot = directory;
+    } else {
+        stateRoot = options.run.stateDir;
+        mkdir(stateRoot.c_str(), 0755);
+    }
+
+    listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    int reuse = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(options.port);
+    if (listenFd < 0 || bind(listenFd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(listenFd, 16) != 0) {
+        perror("render-server: listen");
+        return false;
+    }
+    fcntl(listenFd, F_SETFL, O_NONBLOCK);
+
+    signal(SIGPIPE, SIG_IGN);
+    signal(SIGINT, onStopSignal);
+    signal(SIGTERM, onStopSignal);
+    fprintf(stderr, "render-server: listening on port %u, state in %s\n", options.port, stateRoot.c_str());
+
+    while (!stopRequested) {
+        // Start queued renders while there is room
+        size_t running = 0;
+        for (auto& render : renders) {
+            if (render->pid > 0) {
+                running++;
+            } else if (running < options.maxRenders) {
+                if (startRender(*render)) {
+                    running++;
+                } else {
+                    finishRender(*render, false);
+                }
+            }
+        }
+        renders.erase(std::remove_if(renders.begin(), renders.end(),
+                                     [](const std::unique_ptr<Render>& render) { return render->pid < 0; }),
+                      renders.end());
+
+        std::vector<struct pollfd> fds;
+        fds.push_back({listenFd, static_cast<short>(connections.size() < MAX_CONNECTIONS ? POLLIN : 0), 0});
+        for (auto& connection : connections) {
+            short events = !connection->output.empty() ? POLLOUT : connection->waiting ? 0 : POLLIN;
+            fds.push_back({connection->fd, events, 0});
+        }
+        size_t polled = connections.size();
+        for (auto& render : renders) {
+            fds.push_back({render->fd, POLLIN, 0});
+        }
+
+        if (poll(fds.data(), fds.size(), 1000) < 0) {
+            if (errno == EINTR) continue;
+            perror("render-server: poll");
+            break;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            int client = accept(listenFd, nullptr, nullptr);
+            if (client >= 0) {
+                fcntl(client, F_SETFL, O_NONBLOCK);
+                std::unique_ptr<Connection> connection(new Connection());
+                connection->fd = client;
+                connections.push_back(std::move(connection));
+            }
+        }
+
+        // Render output first, so waiting clients are answered this round
+        size_t renderBase = 1 + polled;
+        for (size_t i = 0; i < renders.size(); i++) {
+            Render& render = *renders[i];
+            if (!(fds[renderBase + i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+
+            uint8_t chunk[65536];
+            ssize_t count = read(render.fd, chunk, sizeof(chunk));
+            if (count > 0) {
+                render.output.insert(render.output.end(), chunk, chunk + count);
+                continue;
+            }
+            if (count < 0 && (errno == EAGAIN || errno == EINTR)) continue;
+
+            int status = 0;
+            close(render.fd);
+            waitpid(render.pid, &status, 0);
+            finishRender(render, WIFEXITED(status) && WEXITSTATUS(status) == 0);
+            render.pid = -1;
+        }
+        renders.erase(std::remove_if(renders.begin(), renders.end(),
+                                     [](const std::unique_ptr<Render>& render) { return render->pid < 0; }),
+                      renders.end());
+
+        for (size_t i = 0; i < connections.size(); i++) {
+            Connection& connection = *connections[i];
+            short revents = i < polled ? fds[i + 1].revents : 0;
+            bool closing = false;
+
+            if ((revents & POLLIN) && connection.output.empty() && !connection.waiting) {
+                char buffer[2048];
+                ssize_t count = read(connection.fd, buffer, sizeof(buffer));
+                if (count <= 0) {
+                    closing = count == 0 || (errno != EAGAIN && errno != EINTR);
+                } else {
+                    connection.input.append(buffer, static_cast<size_t>(count));
+                    if (connection.input.find("\r\n\r\n") != std::string::npos) {
+                        handleRequest(connection);
+                    } else if (connection.input.size() > MAX_REQUEST_BYTES) {
+                        connection.output = textResponse(400, "Request too large\n");
+                    }
+                }
+            }
+
+            if ((revents & POLLOUT) && !connection.output.empty()) {
+                ssize_t count = write(connection.fd, connection.output.data() + connection.sent,
+                                      connection.output.size() - connection.sent);
+                if (count > 0) connection.sent += static_cast<size_t>(count);
+                closing = (count < 0 && errno != EAGAIN && errno != EINTR) ||
+                          connection.sent == connection.output.size();
+            }
+            if (revents & (POLLHUP | POLLERR)) closing = true;
+
+            if (closing) {
+                close(connection.fd);
+                connection.fd = -1;
+            }
+        }
+        connections.erase(std::remove_if(connections.begin(), connections.end(),
+                                         [](const std::unique_ptr<Connection>& connection) {
+                                             return connection->fd < 0;
+                                         }),
+                          connections.end());
+    }
+
+    fprintf(stderr, "render-server: stopping\n%s", statusText().c_str());
+    return true;
+}
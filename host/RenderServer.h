@@ -0,0 +1,81 @@
+#ifndef RENDER_SERVER_H
+#define RENDER_SERVER_H
+
+#include "FrameCache.h"
+#include "HostRunner.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Options for the frame server. run supplies the data directory (fonts,
+ * images), the fixtures the widgets fetch from and logging; configFile is
+ * served as /frame/default.
+ */
+struct RenderServerOptions {
+    HostRunOptions run;
+    uint16_t port = 8080;
+    std::string configsDir;             // <name>.json served as /frame/<name>
+    uint32_t tickSeconds = 60;          // Wall-clock granularity of the data version
+    uint32_t maxRenders = 4;            // Renders running at once
+    size_t history = 8;                 // Frames kept per config for deltas
+    uint8_t fullMode = 1;               // Full frames: INKPLATE_3BIT, or 0 for 1-bit
+};
+
+/**
+ * Headless render server: the firmware's own LayoutManager, widgets and
+ * Compositor compose the screen on the host and devices in thin-client
+ * mode (Server.FrameUrl) download the result.
+ *
+ *   GET /frame/<name>?since=<id>[&mode=1bit|3bit]   PanelFrame, or 304
+ *   GET /frame/<name>.png                            the same screen as PNG
+ *   GET /status                                      cache statistics
+ *
+ * A render is a forked child that boots the firmware with the config
+ * (seeded into its own SPIFFS directory per config hash), lets it fetch
+ * from the fixtures and draw, and sends the panel back over a pipe when
+ * it goes to sleep. Renders are cached under the config hash and the data
+ * version: a fingerprint of the fixture files (replace them to publish new
+ * data), the synthetic weather period and the current tick. A request
+ * whose key is cached costs no render; concurrent requests for a config
+ * that is rendering wait for that one render. Any number of configs are
+ * served at once, up to maxRenders rendering in parallel.
+ */
+class RenderServer {
+public:
+    explicit RenderServer(const RenderServerOptions& options);
+    ~RenderServer();
+
+    // Serves until SIGINT or SIGTERM; false if the port cannot be opened
+    bool run();
+
+    // Made public for testing
+    static bool parseRequest(const std::string& head, std::string& path, std::string& query);
+    static bool isValidName(const std::string& name);
+    static uint64_t fixturesFingerprint(const std::string& directory);
+    static uint64_t dataVersion(uint64_t fixtures, uint64_t epochSeconds, uint32_t tickSeconds);
+
+    struct Connection;
+    struct Render;
+
+private:
+    RenderServerOptions options;
+    FrameCache cache;
+    std::string stateRoot;
+    int listenFd = -1;
+    std::vector<std::unique_ptr<Connection>> connections;
+    std::vector<std::unique_ptr<Render>> renders;      // Running, then queued
+
+    bool handleRequest(Connection& connection);
+    void answer(Connection& connection, uint64_t configHash, const RenderedFrame& frame);
+    bool startRender(Render& render);
+    void finishRender(Render& render, bool ok);
+    bool resolveConfig(const std::string& name, std::string& path, std::string& contents) const;
+    std::string statusText() const;
+
+    // Child side; never returns
+    void runRender(int fd, const std::string& stateDir);
+};
+
+#endif
@@ -0,0 +1,81 @@
+#include "SoakAnalyzer.h"
+#include <cmath>
+
+/**
+ * Least-squares trend of one metric; direction is +1 when growth is bad
+ * and -1 when shrinkage is
+ */
+static SoakTrend fitTrend(const char* metric, const std::vector<double>& values, double limit,
+                          int direction, const SoakLimits& limits) {
+    SoakTrend trend;
+    trend.metric = metric;
+    trend.limit = limit;
+
+    size_t n = values.size();
+    double meanX = (n - 1) / 2.0;
+    double meanY = 0.0;
+    for (double value : values) meanY += value;
+    meanY /= n;
+    trend.mean = meanY;
+
+    double sxx = 0.0;
+    double sxy = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        sxx += (i - meanX) * (i - meanX);
+        sxy += (i - meanX) * (values[i] - meanY);
+    }
+    double slope = sxy / sxx;
+
+    double residuals = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        double error = values[i] - (meanY + slope * (i - meanX));
+        residuals += error * error;
+    }
+    double standardError = std::sqrt(residuals / (n - 2) / sxx);
+
+    trend.change = slope * (n - 1);
+    if (standardError > 0.0) {
+        trend.significance = slope / standardError;
+    } else {
+        trend.significance = slope == 0.0 ? 0.0 : (slope > 0.0 ? HUGE_VAL : -HUGE_VAL);
+    }
+    trend.failed = direction * trend.change > limit && direction * trend.significance >= limits.minSignificance;
+    return trend;
+}
+
+std::vector<SoakTrend> SoakAnalyzer::analyze(const std::vector<SoakCycle>& cycles, const SoakLimits& limits) {
+    std::vector<SoakTrend> trends;
+    if (cycles.size() < limits.warmupCycles + 3) return trends;
+
+    std::vector<double> retained;
+    std::vector<double> highWater;
+    std::vector<double> allocations;
+    std::vector<double> largestFree;
+    for (size_t i = limits.warmupCycles; i < cycles.size(); i++) {
+        retained.push_back(static_cast<double>(cycles[i].retainedBytes));
+        highWater.push_back(static_cast<double>(cycles[i].highWaterBytes));
+        allocations.push_back(static_cast<double>(cycles[i].allocations));
+        largestFree.push_back(static_cast<double>(cycles[i].largestFreeInternal));
+    }
+
+    trends.push_back(fitTrend("retained bytes", retained, limits.retainedBytes, 1, limits));
+    trends.push_back(fitTrend("high-water bytes", highWater, limits.highWaterBytes, 1, limits));
+    SoakTrend allocationTrend = fitTrend("allocations/cycle", allocations, 0.0, 1, limits);
+    allocationTrend.limit = limits.allocationsFraction * allocationTrend.mean;
+    allocationTrend.failed = allocationTrend.change > allocationTrend.limit &&
+                             allocationTrend.significance >= limits.minSignificance;
+    trends.push_back(allocationTrend);
+    trends.push_back(fitTrend("largest free block", largestFree, limits.largestFreeBytes, -1, limits));
+    return trends;
+}
+
+bool SoakAnalyzer::passed(const std::vector<SoakCycle>& cycles, const std::vector<SoakTrend>& trends) {
+    if (trends.empty()) return false;
+    for (const SoakTrend& trend : trends) {
+        if (trend.failed) return false;
+    }
+    for (const SoakCycle& cycle : cycles) {
+        if (cycle.failedAllocations > 0) return false;
+    }
+    return true;
+}
@@ -0,0 +1,68 @@
+#ifndef SOAK_ANALYZER_H
+#define SOAK_ANALYZER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * How much a soak metric may drift across the measured cycles.
+ *
+ * A metric fails when its least-squares trend projects more than the limit
+ * over the run and the slope is at least minSignificance standard errors
+ * from zero, so fault-driven noise between cycles does not trip it.
+ */
+struct SoakLimits {
+    uint32_t warmupCycles = 6;          // Excluded from trends: first sync, caches filling
+    double retainedBytes = 1024;        // Heap still allocated at the end of a cycle
+    double highWaterBytes = 4096;       // Peak heap within a cycle
+    double allocationsFraction = 0.10;  // Allocations per cycle, relative to their mean
+    double largestFreeBytes = 4096;     // Shrinkage of the largest free internal block
+    double minSignificance = 3.0;
+};
+
+/**
+ * Heap figures for one soak cycle
+ */
+struct SoakCycle {
+    uint32_t index = 0;
+    uint64_t endMicros = 0;             // Uptime when the cycle closed
+    size_t retainedBytes = 0;           // Live heap at the end of the cycle
+    size_t retainedBlocks = 0;
+    size_t highWaterBytes = 0;          // Peak live heap during the cycle
+    uint64_t allocations = 0;
+    size_t freeInternal = 0;            // Device model
+    size_t largestFreeInternal = 0;
+    size_t largestFreePsram = 0;
+    uint64_t failedAllocations = 0;     // Requests the device heaps could not satisfy
+    uint32_t httpRequests = 0;
+    uint32_t faults = 0;                // Injected errors, slow and malformed responses
+};
+
+/**
+ * Trend of one metric across the measured cycles
+ */
+struct SoakTrend {
+    const char* metric = "";
+    double mean = 0.0;
+    double change = 0.0;                // Fitted growth from the first to the last measured cycle
+    double limit = 0.0;
+    double significance = 0.0;          // Slope in standard errors
+    bool failed = false;
+};
+
+/**
+ * Fits trends to soak cycles (after the warm-up) and judges them against
+ * SoakLimits. Kept apart from HostSoak so it can be tested without the
+ * firmware.
+ */
+class SoakAnalyzer {
+public:
+    // Empty if there are fewer than three cycles after the warm-up
+    static std::vector<SoakTrend> analyze(const std::vector<SoakCycle>& cycles, const SoakLimits& limits);
+
+    // No failed trend and no failed device allocation
+    static bool passed(const std::vector<SoakCycle>& cycles, const std::vector<SoakTrend>& trends);
+};
+
+#endif
@@ -0,0 +1,45 @@
+#include "TelemetrySink.h"
+#include <algorithm>
+
+HostResponse TelemetrySink::handle(const HostRequest& request) {
+    std::string parameter = queryParam(request.query, Telemetry::QUERY_PARAMETER);
+    if (!parameter.empty()) {
+        largestParameter = std::max(largestParameter, parameter.size());
+
+        std::vector<uint8_t> payload;
+        std::vector<TelemetryRecord> records;
+        if (Telemetry::fromParameter(parameter, payload) &&
+            Telemetry::decode(payload.data(), payload.size(), records)) {
+            reports++;
+            lastRecords = records;
+            if (log) {
+                fprintf(log, "telemetry: %s%s, %zu chars, %zu record%s\n", request.host.c_str(),
+                        request.path.c_str(), parameter.size(), records.size(), records.size() == 1 ? "" : "s");
+                for (const TelemetryRecord& record : records) {
+                    printRecord(log, record);
+                }
+            }
+        } else {
+            malformed++;
+            if (log) {
+                fprintf(log, "telemetry: %s%s, undecodable parameter (%zu chars)\n", request.host.c_str(),
+                        request.path.c_str(), parameter.size());
+            }
+        }
+    }
+    return inner.handle(request);
+}
+
+void TelemetrySink::printRecord(FILE* out, const TelemetryRecord& record) {
+    fprintf(out, "  wake %-5u cause %u  awake %6.2fs  ", record.wake, record.wakeCause, record.awakeMs / 1e3);
+    for (int i = 0; i < static_cast<int>(TelemetryPhase::COUNT); i++) {
+        if (record.phaseMs[i] == 0) continue;
+        fprintf(out, "%s %ums  ", Telemetry::getPhaseName(static_cast<TelemetryPhase>(i)), record.phaseMs[i]);
+    }
+    fprintf(out, "full %u partial %u  battery %umV  failures", record.fullRefreshes, record.partialRefreshes,
+            record.batteryMv);
+    for (int i = 0; i < static_cast<int>(WakeCounter::COUNT); i++) {
+        fprintf(out, " %s %u", WakeMetrics::getCounterName(static_cast<WakeCounter>(i)), record.failures[i]);
+    }
+    fprintf(out, "  heap min %u largest %u\n", record.minFreeInternal, record.largestFreeInternal);
+}
@@ -0,0 +1,38 @@
+#ifndef TELEMETRY_SINK_H
+#define TELEMETRY_SINK_H
+
+#include "HostTransport.h"
+#include "core/Telemetry.h"
+#include <cstdio>
+#include <vector>
+
+/**
+ * Stand-in for the image server's telemetry endpoint. Wraps the transport
+ * that answers requests, decodes the Telemetry query parameter of every
+ * request carrying one and optionally logs the records, one line each.
+ * Requests are forwarded unchanged.
+ */
+class TelemetrySink : public HostTransport {
+public:
+    explicit TelemetrySink(HostTransport& inner, FILE* log = nullptr) : inner(inner), log(log) {}
+
+    HostResponse handle(const HostRequest& request) override;
+
+    uint32_t getReports() const { return reports; }
+    uint32_t getMalformed() const { return malformed; }
+    size_t getLargestParameter() const { return largestParameter; }
+    // Records from the most recent report, newest first
+    const std::vector<TelemetryRecord>& getLastRecords() const { return lastRecords; }
+
+    static void printRecord(FILE* out, const TelemetryRecord& record);
+
+private:
+    HostTransport& inner;
+    FILE* log;
+    uint32_t reports = 0;
+    uint32_t malformed = 0;
+    size_t largestParameter = 0;
+    std::vector<TelemetryRecord> lastRecords;
+};
+
+#endif
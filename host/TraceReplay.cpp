@@ -0,0 +1,192 @@
+#include "TraceReplay.h"
+#include "HostClock.h"
+#include "HostSleep.h"
+#include "HTTPClient.h"
+#include "MockInkplate.h"
+#include "WiFi.h"
+#include "core/Telemetry.h"
+#include <fstream>
+#include <iterator>
+
+// Reachable from the configTime() SNTP hook
+static TraceReplay* activeReplay = nullptr;
+
+TraceTransport::TraceTransport(const std::vector<TraceEvent>& events, HostTransport* fallback)
+    : fallback(fallback) {
+    for (const TraceEvent& event : events) {
+        if (event.type == TraceEventType::HTTP) {
+            pending[event.url].push_back(&event);
+        }
+    }
+}
+
+HostResponse TraceTransport::handle(const HostRequest& request) {
+    // The trace keeps image URLs without telemetry, which differs between runs
+    auto it = pending.find(removeQueryParam(request.url, Telemetry::QUERY_PARAMETER));
+    if (it == pending.end() || it->second.empty()) {
+        unmatched++;
+        return fallback ? fallback->handle(request) : HostResponse();
+    }
+
+    const TraceEvent* event = it->second.front();
+    it->second.pop_front();
+    replayed++;
+
+    HostResponse response;
+    if (!event->bodyOmitted) {
+        response.body = event->body;
+    } else if (event->value == HTTP_CODE_OK && fallback) {
+        response = fallback->handle(request);
+    }
+    if (!event->headers.empty()) response.headers = event->headers;
+    response.status = event->value;
+    response.latencyMs = event->durationMs;
+    if (response.status < 0) {
+        response.body.clear();
+        response.headers.clear();
+    }
+    return response;
+}
+
+uint32_t TraceTransport::getUnused() const {
+    uint32_t unused = 0;
+    for (const auto& url : pending) {
+        unused += static_cast<uint32_t>(url.second.size());
+    }
+    return unused;
+}
+
+bool TraceReplay::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        fprintf(stderr, "replay: cannot open %s\n", path.c_str());
+        return false;
+    }
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (!load(data.data(), data.size())) {
+        fprintf(stderr, "replay: %s is not a readable input trace\n", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool TraceReplay::load(const uint8_t* data, size_t size) {
+    return InputTrace::parse(data, size, header, events);
+}
+
+size_t TraceReplay::count(TraceEventType type) const {
+    size_t total = 0;
+    for (const TraceEvent& event : events) {
+        if (event.type == type) total++;
+    }
+    return total;
+}
+
+uint32_t TraceReplay::recordedAwakeMs() const {
+    for (const TraceEvent& event : events) {
+        if (event.type == TraceEventType::SLEEP) return event.atMs;
+    }
+    return 0;
+}
+
+uint32_t TraceReplay::recordedSleepMs() const {
+    for (const TraceEvent& event : events) {
+        if (event.type == TraceEventType::SLEEP) return event.durationMs;
+    }
+    return 0;
+}
+
+void TraceReplay::install(HostTransport* fallback, uint64_t defaultEpochMicros) {
+    uninstall();
+    activeReplay = this;
+
+    HostSleep::setWakeupCause(static_cast<esp_sleep_wakeup_cause_t>(header.wakeCause));
+    if (header.clockValid) {
+        uint64_t bootMicros = header.bootMs * 1000ULL;
+        uint64_t epochMicros = header.bootEpochSeconds * 1000000ULL;
+        HostClock::setBootEpochMicros(epochMicros > bootMicros ? epochMicros - bootMicros : epochMicros);
+        HostClock::setWallClockSynced(true);
+    } else {
+        HostClock::setBootEpochMicros(defaultEpochMicros);
+        HostClock::setWallClockSynced(false);
+    }
+
+    Inkplate* panel = Inkplate::primary();
+    for (const TraceEvent& event : events) {
+        switch (event.type) {
+            case TraceEventType::BATTERY:
+                if (panel) panel->queueBatteryReading(event.volts);
+                break;
+            case TraceEventType::TIME_SYNC:
+                sntpAnswers.push_back(&event);
+                break;
+            case TraceEventType::WIFI:
+                wifiAttempts.push_back(&event);
+                break;
+            case TraceEventType::BUTTON:
+                buttonEdges.push_back(&event);
+                break;
+            default:
+                break;
+        }
+    }
+    HostClock::setSntpHandler(answerSntp);
+    applyWiFi(0);
+
+    transport = new TraceTransport(events, fallback);
+}
+
+void TraceReplay::poll() {
+    // The next association that has not started yet
+    applyWiFi(static_cast<size_t>(WiFi.getConnectCount()));
+
+    uint32_t now = static_cast<uint32_t>(millis());
+    while (nextButton < buttonEdges.size() && buttonEdges[nextButton]->atMs <= now) {
+        const TraceEvent* edge = buttonEdges[nextButton++];
+        digitalWrite(edge->pin, edge->value ? HIGH : LOW);
+    }
+}
+
+void TraceReplay::uninstall() {
+    if (activeReplay == this) {
+        HostClock::setSntpHandler(nullptr);
+        activeReplay = nullptr;
+    }
+    delete transport;
+    transport = nullptr;
+    wifiAttempts.clear();
+    buttonEdges.clear();
+    sntpAnswers.clear();
+    nextButton = 0;
+    sntpMisses = 0;
+}
+
+uint32_t TraceReplay::getDivergences() const {
+    uint32_t http = transport ? transport->getUnmatched() + transport->getUnused() : 0;
+    return http + sntpMisses + static_cast<uint32_t>(sntpAnswers.size());
+}
+
+void TraceReplay::applyWiFi(size_t attempt) {
+    if (attempt >= wifiAttempts.size()) return;
+    const TraceEvent* event = wifiAttempts[attempt];
+    WiFi.setNetworkAvailable(event->value != 0);
+    WiFi.setConnectDelayMs(event->durationMs);
+}
+
+bool TraceReplay::answerSntp(uint32_t& delayMs, uint64_t& epochUs) {
+    TraceReplay* replay = activeReplay;
+    if (!replay || replay->sntpAnswers.empty()) {
+        // More requests than the device made: answer at once from the RTC
+        if (replay) replay->sntpMisses++;
+        delayMs = 0;
+        epochUs = HostClock::epochMicros();
+        return true;
+    }
+
+    const TraceEvent* answer = replay->sntpAnswers.front();
+    replay->sntpAnswers.pop_front();
+    if (answer->epochSeconds == 0) return false;
+    delayMs = answer->durationMs;
+    epochUs = answer->epochSeconds * 1000000ULL;
+    return true;
+}
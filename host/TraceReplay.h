@@ -0,0 +1,85 @@
+#ifndef TRACE_REPLAY_H
+#define TRACE_REPLAY_H
+
+#include "HostTransport.h"
+#include "core/InputTrace.h"
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * Serves HTTP from a recorded trace. Each URL gets its recorded responses
+ * in order, with the recorded status, latency and headers. Responses recorded
+ * without a body take the body from the fallback transport (fixtures) but
+ * keep the recorded status and latency. Requests the trace has no answer
+ * for go to the fallback unchanged and are counted as unmatched, since the
+ * replay has left the recorded path.
+ */
+class TraceTransport : public HostTransport {
+public:
+    TraceTransport(const std::vector<TraceEvent>& events, HostTransport* fallback);
+
+    HostResponse handle(const HostRequest& request) override;
+
+    uint32_t getReplayed() const { return replayed; }
+    uint32_t getUnmatched() const { return unmatched; }
+    // Recorded responses nobody asked for
+    uint32_t getUnused() const;
+
+private:
+    std::map<std::string, std::deque<const TraceEvent*>> pending;
+    HostTransport* fallback;
+    uint32_t replayed = 0;
+    uint32_t unmatched = 0;
+};
+
+/**
+ * Feeds a recorded wake (InputTrace) back into the host build.
+ *
+ * install() sets everything known at boot: wake cause, RTC wall clock,
+ * queued battery readings, the SNTP answers for configTime() and the first
+ * WiFi association. poll() runs before every loop() and applies button
+ * edges whose time has come and the next association's outcome. HTTP goes
+ * through getTransport(). Inputs are consumed in the order the device saw
+ * them, so a replay is deterministic as long as the firmware asks for the
+ * same inputs; getDivergences() counts the times it did not.
+ */
+class TraceReplay {
+public:
+    bool load(const std::string& path);
+    bool load(const uint8_t* data, size_t size);
+
+    const TraceHeader& getHeader() const { return header; }
+    const std::vector<TraceEvent>& getEvents() const { return events; }
+    size_t count(TraceEventType type) const;
+
+    // Awake time and armed timer the device recorded (0 if it never slept)
+    uint32_t recordedAwakeMs() const;
+    uint32_t recordedSleepMs() const;
+
+    // defaultEpochMicros: wall clock at boot when the RTC had none
+    void install(HostTransport* fallback, uint64_t defaultEpochMicros);
+    void poll();
+    void uninstall();
+
+    TraceTransport* getTransport() { return transport; }
+    // Inputs asked for but not recorded, or recorded but never asked for
+    uint32_t getDivergences() const;
+
+private:
+    TraceHeader header;
+    std::vector<TraceEvent> events;
+
+    TraceTransport* transport = nullptr;
+    std::vector<const TraceEvent*> wifiAttempts;
+    std::vector<const TraceEvent*> buttonEdges;
+    std::deque<const TraceEvent*> sntpAnswers;
+    size_t nextButton = 0;
+    uint32_t sntpMisses = 0;
+
+    void applyWiFi(size_t attempt);
+    static bool answerSntp(uint32_t& delayMs, uint64_t& epochUs);
+};
+
+#endif
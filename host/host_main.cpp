@@ -0,0 +1,235 @@
+#include "AssetPackBuilder.h"
+#include "BatteryEstimator.h"
+#include "HostFlash.h"
+#include "HostFleet.h"
+#include "HostReplay.h"
+#include "HostRunner.h"
+#include "HostSoak.h"
+#include "RenderServer.h"
+#include <cstdlib>
+#include <cstring>
+
+/**
+ * Linux host build of the firmware.
+ *
+ * Usage: host [--data-dir <dir>] [--state-dir <dir>] [--config <file>]
+ *             [--fixtures <dir>] [--sd-dir <dir>] [--assets <pack>]
+ *             [--wakes <n> | --days <n>] [--start <unix seconds>]
+ *             [--capture <dir>] [--capture-format png|pgm]
+ *             [--wifi-delay-ms <ms>] [--http-latency-ms <ms>] [--network <preset>]
+ *             [--log] [--quiet] [--telemetry]
+ *             [--estimate] [--profile <power profile json>]
+ *             [--soak [--cycle-minutes <n>] [--seed <n>]
+ *                     [--error-rate <f>] [--slow-rate <f>] [--malformed-rate <f>]]
+ *             [--replay <trace> [--repeat <n>]]
+ *             [--serve <port> [--configs <dir>] [--tick <seconds>] [--renders <n>]]
+ *             [--fleet <n> [--spread <seconds>] [--server-host <host>] [--workers <n>]
+ *                          [--server-ms <ms>] [--bandwidth-kbps <n>] [--rtt-ms <ms>] [--devices]]
+ *             [--build-assets <manifest> --assets <pack>]
+ * Prints one line per wake cycle and a summary; --estimate adds projected
+ * battery life for the simulated schedule. --network puts a link with the
+ * round trip, bandwidth, loss and resets of a preset (ideal, good, fair,
+ * weak, poor) between the unit and its servers; --http-latency-ms is then
+ * the server's own time. --sd-dir puts a microSD card holding that
+ * directory in the slot; without it the slot is empty. --assets maps the
+ * pack file as the assets flash partition. --soak instead keeps the unit
+ * awake for --days (default 14) with injected network faults and fails
+ * if heap usage or fragmentation trends upward. --replay runs the wake
+ * recorded in a device's /trace.bin with its own inputs, --repeat times.
+ * --telemetry decodes and prints the wake metrics each image request
+ * carries (needs Server.Telemetry in the config). --serve renders the
+ * config (and every <name>.json in --configs) on request and serves the
+ * frames to thin clients over HTTP until interrupted. --fleet runs n units
+ * for --days (default 1) against one image server with limited workers
+ * and bandwidth, plus the --soak fault rates, and reports radio-on time
+ * across the fleet and the server's request rate and latency.
+ * --build-assets builds the pack described by a manifest into --assets
+ * instead of running anything (see host/AssetPackBuilder.h).
+ */
+static void usage(const char* program) {
+    fprintf(stderr,
+            "Usage: %s [--data-dir <dir>] [--state-dir <dir>] [--config <file>]\n"
+            "          [--fixtures <dir>] [--sd-dir <dir>] [--assets <pack>]\n"
+            "          [--wakes <n> | --days <n>] [--start <unix seconds>]\n"
+            "          [--capture <dir>] [--capture-format png|pgm]\n"
+            "          [--wifi-delay-ms <ms>] [--http-latency-ms <ms>] [--network <preset>]\n"
+            "          [--log] [--quiet] [--telemetry]\n"
+            "          [--estimate] [--profile <power profile json>]\n"
+            "          [--soak [--cycle-minutes <n>] [--seed <n>]\n"
+            "                  [--error-rate <f>] [--slow-rate <f>] [--malformed-rate <f>]]\n"
+            "          [--replay <trace> [--repeat <n>]]\n"
+            "          [--serve <port> [--configs <dir>] [--tick <seconds>] [--renders <n>]]\n"
+            "          [--fleet <n> [--spread <seconds>] [--server-host <host>] [--workers <n>]\n"
+            "                       [--server-ms <ms>] [--bandwidth-kbps <n>] [--rtt-ms <ms>] [--devices]]\n"
+            "          [--build-assets <manifest> --assets <pack>]\n",
+            program);
+}
+
+int main(int argc, char** argv) {
+    // POSIX TZ until the firmware calls configTime()
+    setenv("TZ", "UTC0", 1);
+
+    HostRunOptions options;
+    PowerProfile profile;
+    bool estimate = false;
+    HostSoakOptions soakOptions;
+    bool soak = false;
+    HostReplayOptions replayOptions;
+    RenderServerOptions serverOptions;
+    bool serve = false;
+    HostFleetOptions fleetOptions;
+    bool fleet = false;
+    std::string assetPack;
+    std::string assetManifest;
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (strcmp(arg, "--data-dir") == 0 && hasValue) {
+            options.dataDir = argv[++i];
+        } else if (strcmp(arg, "--state-dir") == 0 && hasValue) {
+            options.stateDir = argv[++i];
+        } else if (strcmp(arg, "--config") == 0 && hasValue) {
+            options.configFile = argv[++i];
+        } else if (strcmp(arg, "--fixtures") == 0 && hasValue) {
+            options.fixturesDir = argv[++i];
+        } else if (strcmp(arg, "--sd-dir") == 0 && hasValue) {
+            options.sdDir = argv[++i];
+        } else if (strcmp(arg, "--assets") == 0 && hasValue) {
+            assetPack = argv[++i];
+        } else if (strcmp(arg, "--build-assets") == 0 && hasValue) {
+            assetManifest = argv[++i];
+        } else if (strcmp(arg, "--wakes") == 0 && hasValue) {
+            options.wakes = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        } else if (strcmp(arg, "--days") == 0 && hasValue) {
+            options.days = strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(arg, "--start") == 0 && hasValue) {
+            options.startEpochSeconds = strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(arg, "--capture") == 0 && hasValue) {
+            options.captureDir = argv[++i];
+        } else if (strcmp(arg, "--capture-format") == 0 && hasValue) {
+            options.captureFormat = strcmp(argv[++i], "pgm") == 0 ? FrameWriter::Format::PGM
+                                                                  : FrameWriter::Format::PNG;
+        } else if (strcmp(arg, "--wifi-delay-ms") == 0 && hasValue) {
+            options.wifiConnectDelayMs = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        } else if (strcmp(arg, "--http-latency-ms") == 0 && hasValue) {
+            options.httpLatencyMs = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        } else if (strcmp(arg, "--network") == 0 && hasValue) {
+            if (!NetworkConditionTransport::preset(argv[++i], options.network)) {
+                fprintf(stderr, "Unknown network preset %s (one of %s)\n", argv[i],
+                        NetworkConditionTransport::presetNames());
+                return 2;
+            }
+        } else if (strcmp(arg, "--log") == 0) {
+            options.log = true;
+        } else if (strcmp(arg, "--quiet") == 0) {
+            options.printWakes = false;
+        } else if (strcmp(arg, "--telemetry") == 0) {
+            options.telemetry = true;
+        } else if (strcmp(arg, "--estimate") == 0) {
+            estimate = true;
+        } else if (strcmp(arg, "--profile") == 0 && hasValue) {
+            estimate = true;
+            if (!PowerProfile::loadProfile(argv[++i], profile)) return 2;
+        } else if (strcmp(arg, "--soak") == 0) {
+            soak = true;
+        } else if (strcmp(arg, "--cycle-minutes") == 0 && hasValue) {
+            soakOptions.cycleMinutes = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        } else if (strcmp(arg, "--seed") == 0 && hasValue) {
+            soakOptions.seed = fleetOptions.seed = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+            options.networkSeed = soakOptions.seed;
+        } else if (strcmp(arg, "--error-rate") == 0 && hasValue) {
+            soakOptions.faults.error = fleetOptions.faults.error = strtof(argv[++i], nullptr);
+        } else if (strcmp(arg, "--slow-rate") == 0 && hasValue) {
+            soakOptions.faults.slow = fleetOptions.faults.slow = strtof(argv[++i], nullptr);
+        } else if (strcmp(arg, "--malformed-rate") == 0 && hasValue) {
+            soakOptions.faults.malformed = fleetOptions.faults.malformed = strtof(argv[++i], nullptr);
+        } else if (strcmp(arg, "--replay") == 0 && hasValue) {
+            replayOptions.tracePath = argv[++i];
+        } else if (strcmp(arg, "--repeat") == 0 && hasValue) {
+            replayOptions.repeat = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        } else if (strcmp(arg, "--serve") == 0 && hasValue) {
+            serve = true;
+            serverOptions.port = static_cast<uint16_t>(strtoul(argv[++i], nullptr, 10));
+        } else if (strcmp(arg, "--configs") == 0 && hasValue) {
+            serverOptions.configsDir = argv[++i];
+        } else if (strcmp(arg, "--tick") == 0 && hasValue) {
+            serverOptions.tickSeconds = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        } else if (strcmp(arg, "--renders") == 0 && hasValue) {
+            serverOptions.maxRenders = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        } else if (strcmp(arg, "--fleet") == 0 && hasValue) {
+            fleet = true;
+            fleetOptions.devices = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        } else if (strcmp(arg, "--spread") == 0 && hasValue) {
+            fleetOptions.spreadSeconds = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        } else if (strcmp(arg, "--server-host") == 0 && hasValue) {
+            fleetOptions.serverHost = argv[++i];
+        } else if (strcmp(arg, "--workers") == 0 && hasValue) {
+            fleetOptions.server.workers = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        } else if (strcmp(arg, "--server-ms") == 0 && hasValue) {
+            fleetOptions.server.serviceMs = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        } else if (strcmp(arg, "--bandwidth-kbps") == 0 && hasValue) {
+            fleetOptions.server.bandwidthKbps = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        } else if (strcmp(arg, "--rtt-ms") == 0 && hasValue) {
+            fleetOptions.server.rttMs = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        } else if (strcmp(arg, "--devices") == 0) {
+            fleetOptions.printDevices = true;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (!assetManifest.empty()) {
+        AssetPackBuilder builder;
+        if (assetPack.empty() || !builder.addManifest(assetManifest) || !builder.write(assetPack)) {
+            if (assetPack.empty()) usage(argv[0]);
+            return 2;
+        }
+        printf("%s: %u assets\n", assetPack.c_str(), static_cast<unsigned>(builder.getCount()));
+        return 0;
+    }
+
+    // Every wake inherits the mapping
+    if (!assetPack.empty() && !HostFlash::attach(AssetPack::PARTITION_LABEL, assetPack.c_str())) {
+        fprintf(stderr, "asset pack %s not found\n", assetPack.c_str());
+        return 2;
+    }
+
+    if (serve) {
+        serverOptions.run = options;
+        if (serverOptions.maxRenders == 0) serverOptions.maxRenders = 1;
+        RenderServer server(serverOptions);
+        return server.run() ? 0 : 1;
+    }
+
+    if (fleet) {
+        fleetOptions.run = options;
+        if (options.days > 0) fleetOptions.days = options.days;
+        HostFleet fleetRun(fleetOptions);
+        return fleetRun.run() ? 0 : 1;
+    }
+
+    if (!replayOptions.tracePath.empty()) {
+        replayOptions.run = options;
+        HostReplay replay(replayOptions);
+        return replay.run() ? 0 : 1;
+    }
+
+    if (soak) {
+        soakOptions.run = options;
+        soakOptions.printCycles = options.printWakes;
+        if (options.days > 0) soakOptions.days = options.days;
+        if (soakOptions.cycleMinutes == 0) soakOptions.cycleMinutes = 60;
+        HostSoak soakRun(soakOptions);
+        return soakRun.run() ? 0 : 1;
+    }
+
+    HostRunner runner(options);
+    bool ok = runner.run();
+
+    if (estimate) {
+        BatteryEstimator::print(stdout, BatteryEstimator::estimate(runner.getReports(), profile), profile);
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,349 @@
+#include "AssetPack.h"
+#include "Compositor.h"
+#include "Logger.h"
+#include <esp_partition.h>
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+static const char PACK_MAGIC[4] = {'I', 'A', 'P', '1'};
+
+const char* const AssetPack::PARTITION_LABEL = "assets";
+
+static uint16_t getU16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+static uint32_t getU32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+static void putU16(std::vector<uint8_t>& out, size_t at, uint16_t value) {
+    out[at] = value & 0xff;
+    out[at + 1] = value >> 8;
+}
+
+static void putU32(std::vector<uint8_t>& out, size_t at, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out[at + i] = (value >> (8 * i)) & 0xff;
+    }
+}
+
+AssetPack& AssetPack::shared() {
+    static AssetPack pack;
+    return pack;
+}
+
+bool AssetPack::parse(const uint8_t* packData, size_t packSize) {
+    data = nullptr;
+    size = 0;
+    count = 0;
+
+    if (packSize < HEADER_SIZE || memcmp(packData, PACK_MAGIC, sizeof(PACK_MAGIC)) != 0 ||
+        packData[4] != VERSION) {
+        return false;
+    }
+
+    // A partition is larger than the pack in it
+    size_t entries = getU16(packData + 6);
+    size_t total = getU32(packData + 8);
+    if (total > packSize || HEADER_SIZE + entries * ENTRY_SIZE > total) return false;
+
+    const char* previous = "";
+    for (size_t i = 0; i < entries; i++) {
+        const uint8_t* at = packData + HEADER_SIZE + i * ENTRY_SIZE;
+        const char* name = reinterpret_cast<const char*>(at);
+        uint32_t offset = getU32(at + 24);
+        uint32_t length = getU32(at + 28);
+        // Names are terminated and strictly sorted, so find() can bisect
+        if (at[NAME_SIZE - 1] != '\0' || strcmp(previous, name) >= 0) return false;
+        if (offset > total || length > total - offset) return false;
+        if (static_cast<AssetType>(at[16]) == AssetType::FONT &&
+            (length < FONT_HEADER_SIZE || length < FONT_HEADER_SIZE + packData[offset + 1] * GLYPH_SIZE)) {
+            return false;
+        }
+        previous = name;
+    }
+
+    data = packData;
+    size = total;
+    count = entries;
+    return true;
+}
+
+bool AssetPack::map(const char* label) {
+    unmap();
+
+    const esp_partition_t* partition =
+        esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+    if (!partition) {
+        LOG_DEBUG("AssetPack", "No %s partition", label);
+        return false;
+    }
+
+    const void* mappedData = nullptr;
+    spi_flash_mmap_handle_t handle = 0;
+    if (esp_partition_mmap(partition, 0, partition->size, ESP_PARTITION_MMAP_DATA, &mappedData, &handle) != ESP_OK) {
+        LOG_ERROR("AssetPack", "Failed to map the %s partition", label);
+        return false;
+    }
+    mapHandle = handle;
+    mapped = true;
+
+    if (!parse(static_cast<const uint8_t*>(mappedData), partition->size)) {
+        LOG_WARN("AssetPack", "No asset pack in the %s partition", label);
+        unmap();
+        return false;
+    }
+    LOG_INFO("AssetPack", "%u assets, %u bytes mapped from %s", static_cast<unsigned>(count),
+             static_cast<unsigned>(size), label);
+    return true;
+}
+
+void AssetPack::unmap() {
+    if (mapped) {
+        spi_flash_munmap(mapHandle);
+        mapped = false;
+    }
+    data = nullptr;
+    size = 0;
+    count = 0;
+}
+
+bool AssetPack::find(const char* name, AssetType type, AssetInfo& info) const {
+    size_t low = 0;
+    size_t high = count;
+    while (low < high) {
+        size_t middle = (low + high) / 2;
+        const uint8_t* at = entry(middle);
+        int order = strcmp(name, reinterpret_cast<const char*>(at));
+        if (order == 0) {
+            if (static_cast<AssetType>(at[16]) != type) return false;
+            info.type = type;
+            info.width = getU16(at + 18);
+            info.height = getU16(at + 20);
+            info.param = getU16(at + 22);
+            info.data = data + getU32(at + 24);
+            info.length = getU32(at + 28);
+            return true;
+        }
+        if (order < 0) {
+            high = middle;
+        } else {
+            low = middle + 1;
+        }
+    }
+    return false;
+}
+
+bool AssetPack::getGlyph(const AssetInfo& font, char c, AssetGlyph& glyph) const {
+    size_t index = static_cast<uint8_t>(c) - font.data[0];
+    if (static_cast<uint8_t>(c) < font.data[0] || index >= font.data[1]) return false;
+
+    const uint8_t* record = font.data + FONT_HEADER_SIZE + index * GLYPH_SIZE;
+    glyph.offset = getU32(record);
+    glyph.width = record[4];
+    glyph.height = record[5];
+    glyph.xOffset = static_cast<int8_t>(record[6]);
+    glyph.yOffset = static_cast<int8_t>(record[7]);
+    glyph.advance = record[8];
+    // Characters missing inside the range have empty records
+    if (glyph.advance == 0 && glyph.width == 0) return false;
+
+    size_t bitmapBytes = static_cast<size_t>((glyph.width + 7) / 8) * glyph.height;
+    return glyph.offset <= font.length && bitmapBytes <= font.length - glyph.offset;
+}
+
+// Advance for characters the font does not have
+static int missingAdvance(const AssetPack& pack, const AssetInfo& font) {
+    AssetGlyph space;
+    return pack.getGlyph(font, ' ', space) ? space.advance : font.width;
+}
+
+int AssetPack::getTextWidth(const AssetInfo& font, const char* text) const {
+    int width = 0;
+    AssetGlyph glyph;
+    for (const char* c = text; *c; c++) {
+        width += getGlyph(font, *c, glyph) ? glyph.advance : missingAdvance(*this, font);
+    }
+    return width;
+}
+
+int AssetPack::drawText(Compositor& compositor, const AssetInfo& font, int x, int baseline, const char* text,
+                        uint8_t color) const {
+    int pen = x;
+    AssetGlyph glyph;
+    for (const char* c = text; *c; c++) {
+        if (!getGlyph(font, *c, glyph)) {
+            pen += missingAdvance(*this, font);
+            continue;
+        }
+
+        if (glyph.width > 0 && glyph.height > 0) {
+            compositor.blitMono(pen + glyph.xOffset, baseline + glyph.yOffset, font.data + glyph.offset, glyph.width,
+                                glyph.height, color);
+        }
+        pen += glyph.advance;
+    }
+
+    if (pen > x) {
+        compositor.markRegionChanged(LayoutRegion(x, baseline - font.param, pen - x, font.height));
+    }
+    return pen;
+}
+
+namespace {
+
+// Where one character of a line went: its pen position and the box its
+// advance and ink cover, at least the line's ascent to descent
+struct TextCell {
+    char c;
+    int pen;
+    int left;
+    int right;
+    int top;
+    int bottom;
+    bool ink;
+    AssetGlyph glyph;
+};
+
+}  // namespace
+
+static void layoutText(const AssetPack& pack, const AssetInfo& font, int x, int baseline, const char* text,
+                       std::vector<TextCell>& cells) {
+    int lineTop = baseline - font.param;
+    int pen = x;
+    for (const char* c = text; *c; c++) {
+        TextCell cell;
+        cell.c = *c;
+        cell.pen = pen;
+        cell.top = lineTop;
+        cell.bottom = lineTop + font.height;
+        if (pack.getGlyph(font, *c, cell.glyph)) {
+            const AssetGlyph& glyph = cell.glyph;
+            cell.ink = glyph.width > 0 && glyph.height > 0;
+            cell.left = std::min(pen, pen + glyph.xOffset);
+            cell.right = std::max(pen + glyph.advance, pen + glyph.xOffset + glyph.width);
+            if (cell.ink) {
+                cell.top = std::min(cell.top, baseline + glyph.yOffset);
+                cell.bottom = std::max(cell.bottom, baseline + glyph.yOffset + glyph.height);
+            }
+            pen += glyph.advance;
+        } else {
+            cell.ink = false;
+            cell.left = pen;
+            pen += missingAdvance(pack, font);
+            cell.right = pen;
+        }
+        cells.push_back(cell);
+    }
+}
+
+int AssetPack::updateText(Compositor& compositor, const AssetInfo& font, int x, int baseline, const char* previous,
+                          const char* text, uint8_t color, uint8_t background) const {
+    std::vector<TextCell> before;
+    std::vector<TextCell> after;
+    layoutText(*this, font, x, baseline, previous, before);
+    layoutText(*this, font, x, baseline, text, after);
+
+    // A cell is unchanged when the same character sits at the same pen
+    auto unchanged = [&](size_t i) {
+        return i < before.size() && i < after.size() && before[i].c == after[i].c && before[i].pen == after[i].pen;
+    };
+
+    int runs = 0;
+    size_t count = std::max(before.size(), after.size());
+    size_t i = 0;
+    while (i < count) {
+        if (unchanged(i)) {
+            i++;
+            continue;
+        }
+
+        int left = INT_MAX;
+        int right = INT_MIN;
+        int top = INT_MAX;
+        int bottom = INT_MIN;
+        for (; i < count && !unchanged(i); i++) {
+            for (const std::vector<TextCell>* cells : {&before, &after}) {
+                if (i < cells->size()) {
+                    const TextCell& cell = (*cells)[i];
+                    left = std::min(left, cell.left);
+                    right = std::max(right, cell.right);
+                    top = std::min(top, cell.top);
+                    bottom = std::max(bottom, cell.bottom);
+                }
+            }
+        }
+        if (right <= left) continue;
+
+        compositor.fillRect(left, top, right - left, bottom - top, background);
+        // Neighbours whose ink reaches into the run go back on top too
+        for (const TextCell& cell : after) {
+            if (cell.ink && cell.right > left && cell.left < right) {
+                compositor.blitMono(cell.pen + cell.glyph.xOffset, baseline + cell.glyph.yOffset,
+                                    font.data + cell.glyph.offset, cell.glyph.width, cell.glyph.height, color);
+            }
+        }
+        runs++;
+    }
+    return runs;
+}
+
+bool AssetPack::drawIcon(Compositor& compositor, const AssetInfo& icon, int x, int y) const {
+    Sprite sprite;
+    sprite.data = icon.data;
+    sprite.length = icon.length;
+    sprite.width = icon.width;
+    sprite.height = icon.height;
+    sprite.encoding = SpriteEncoding::PACKBITS;
+    sprite.key = icon.param == NO_KEY ? Sprite::NO_KEY : icon.param;
+    return compositor.blit(x, y, sprite);
+}
+
+bool AssetPack::drawBackground(Compositor& compositor, const AssetInfo& background, int x, int y) const {
+    // Straight from flash into the surface, a row at a time
+    Sprite sprite;
+    sprite.data = background.data;
+    sprite.length = background.length;
+    sprite.width = background.width;
+    sprite.height = background.height;
+    return compositor.blit(x, y, sprite);
+}
+
+bool AssetPack::encode(std::vector<AssetSource> sources, std::vector<uint8_t>& out) {
+    std::sort(sources.begin(), sources.end(),
+              [](const AssetSource& a, const AssetSource& b) { return a.name < b.name; });
+
+    size_t tableEnd = HEADER_SIZE + sources.size() * ENTRY_SIZE;
+    if (sources.size() > 0xffff) return false;
+    for (size_t i = 0; i < sources.size(); i++) {
+        const std::string& name = sources[i].name;
+        if (name.empty() || name.size() >= NAME_SIZE || (i > 0 && name == sources[i - 1].name)) return false;
+    }
+
+    out.assign(tableEnd, 0);
+    memcpy(out.data(), PACK_MAGIC, sizeof(PACK_MAGIC));
+    out[4] = VERSION;
+    putU16(out, 6, static_cast<uint16_t>(sources.size()));
+
+    for (size_t i = 0; i < sources.size(); i++) {
+        const AssetSource& source = sources[i];
+        // Data on word boundaries, as the flash cache reads it
+        out.resize((out.size() + 3) & ~static_cast<size_t>(3), 0);
+
+        size_t at = HEADER_SIZE + i * ENTRY_SIZE;
+        memcpy(&out[at], source.name.c_str(), source.name.size());
+        out[at + 16] = static_cast<uint8_t>(source.type);
+        putU16(out, at + 18, source.width);
+        putU16(out, at + 20, source.height);
+        putU16(out, at + 22, source.param);
+        putU32(out, at + 24, static_cast<uint32_t>(out.size()));
+        putU32(out, at + 28, static_cast<uint32_t>(source.data.size()));
+        out.insert(out.end(), source.data.begin(), source.data.end());
+    }
+
+    putU32(out, 8, static_cast<uint32_t>(out.size()));
+    return true;
+}
@@ -0,0 +1,131 @@
+#ifndef ASSET_PACK_H
+#define ASSET_PACK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Compositor;
+
+enum class AssetType : uint8_t {
+    FONT = 1,           // One size of a bitmap font
+    ICON,               // PackBits-compressed 8-bit pixels with a transparency key
+    BACKGROUND          // Uncompressed 8-bit pixels, copied row by row
+};
+
+/**
+ * One asset as found in the pack; data points into the mapped flash
+ */
+struct AssetInfo {
+    AssetType type;
+    uint16_t width;             // Fonts: widest advance
+    uint16_t height;            // Fonts: line height
+    uint16_t param;             // Fonts: ascent; icons: transparent value or AssetPack::NO_KEY
+    const uint8_t* data;
+    uint32_t length;
+};
+
+/**
+ * One glyph of a font; offset is from the start of the font's data
+ */
+struct AssetGlyph {
+    uint32_t offset;
+    uint8_t width;
+    uint8_t height;
+    int8_t xOffset;             // From the pen position to the left edge
+    int8_t yOffset;             // From the baseline to the top row (negative: above)
+    uint8_t advance;
+};
+
+/**
+ * Host side: one asset to encode
+ */
+struct AssetSource {
+    std::string name;
+    AssetType type;
+    uint16_t width;
+    uint16_t height;
+    uint16_t param;
+    std::vector<uint8_t> data;  // Already in the asset's stored form
+};
+
+/**
+ * Fonts, icons and static artwork in a dedicated flash partition, read in
+ * place through the flash cache instead of being copied into the heap.
+ *
+ * Layout: a 12-byte header ("IAP1", version, 0, entry count, pack size),
+ * a 32-byte entry per asset sorted by name (16-byte NUL-padded name, type,
+ * 0, width, height, param, data offset, data length), then the data.
+ * All fields are little-endian.
+ *
+ * Font data starts with the first character and the glyph count, then a
+ * 10-byte record per glyph (bitmap offset, width, height, x offset,
+ * y offset, advance, 0; all zero for a missing character), then the
+ * bitmaps: one bit per pixel, each row starting on a byte, most
+ * significant bit first, 1 = ink. Each size of a font is its own asset,
+ * rasterized by the host tool (host/AssetPackBuilder).
+ *
+ * Icons are PackBits runs over their rows, like panel frames (PanelFrame).
+ * Backgrounds are stored raw so rows can be copied straight from flash.
+ */
+class AssetPack {
+public:
+    static const uint8_t VERSION = 1;
+    static const size_t HEADER_SIZE = 12;
+    static const size_t ENTRY_SIZE = 32;
+    static const size_t NAME_SIZE = 16;
+    static const size_t FONT_HEADER_SIZE = 4;
+    static const size_t GLYPH_SIZE = 10;
+    static const uint16_t NO_KEY = 0x100;
+    static const char* const PARTITION_LABEL;
+
+    AssetPack() {}
+    ~AssetPack() { unmap(); }
+    AssetPack(const AssetPack&) = delete;
+    AssetPack& operator=(const AssetPack&) = delete;
+
+    // Checks the header and entry table; data must outlive the pack
+    bool parse(const uint8_t* data, size_t size);
+    // Map the partition with this label and parse the pack in it
+    bool map(const char* label = PARTITION_LABEL);
+    void unmap();
+
+    bool isLoaded() const { return data != nullptr; }
+    size_t getCount() const { return count; }
+    size_t getSize() const { return size; }
+
+    bool find(const char* name, AssetType type, AssetInfo& info) const;
+
+    // Glyphs outside the font are skipped with the width of the font's space
+    bool getGlyph(const AssetInfo& font, char c, AssetGlyph& glyph) const;
+    int getTextWidth(const AssetInfo& font, const char* text) const;
+
+    // Pen starts at x on the baseline; returns where it ends
+    int drawText(Compositor& compositor, const AssetInfo& font, int x, int baseline, const char* text,
+                 uint8_t color) const;
+    // Redraw only what differs from previous, drawn at the same pen and
+    // baseline: each run of changed character cells is filled with the
+    // background and its glyphs drawn again. Returns the runs redrawn
+    int updateText(Compositor& compositor, const AssetInfo& font, int x, int baseline, const char* previous,
+                   const char* text, uint8_t color, uint8_t background) const;
+    bool drawIcon(Compositor& compositor, const AssetInfo& icon, int x, int y) const;
+    bool drawBackground(Compositor& compositor, const AssetInfo& background, int x, int y) const;
+
+    // Host side: sort sources by name and lay them out as a pack
+    static bool encode(std::vector<AssetSource> sources, std::vector<uint8_t>& out);
+
+    // The pack in flash, mapped once per wake by the layout manager
+    static AssetPack& shared();
+
+private:
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    size_t count = 0;
+    uint32_t mapHandle = 0;
+    bool mapped = false;
+
+    const uint8_t* entry(size_t index) const { return data + HEADER_SIZE + index * ENTRY_SIZE; }
+};
+
+#endif
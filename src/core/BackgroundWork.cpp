@@ -0,0 +1,164 @@
+#include "BackgroundWork.h"
+#include "Logger.h"
+#include "RtcState.h"
+#include "../managers/BatteryManager.h"
+#include <cstring>
+#include <ctime>
+
+BackgroundWork::Entry BackgroundWork::entries[BackgroundWork::MAX_TASKS];
+size_t BackgroundWork::entryCount = 0;
+
+// Kept in RTC memory, see RtcState.h
+static const uint32_t WORK_MAGIC = 0x424b5731;  // "BKW1"
+
+// Before this the clock has not been set
+static const uint32_t MIN_EPOCH = 1577836800;  // 2020-01-01
+
+struct BackgroundWorkState {
+    uint32_t magic;
+    uint16_t lastMillivolts;            // Previous wake's reading
+    uint8_t budget;                     // PowerBudget of the last run
+    uint32_t nameHash[BackgroundWork::MAX_TASKS];
+    uint32_t lastRun[BackgroundWork::MAX_TASKS];
+};
+
+RTC_DATA_ATTR static BackgroundWorkState state;
+
+static uint32_t hashName(const char* name) {
+    uint32_t hash = 2166136261u;
+    for (const char* p = name; *p; p++) {
+        hash = (hash ^ static_cast<uint8_t>(*p)) * 16777619u;
+    }
+    return hash;
+}
+
+static void ensureState() {
+    if (!RtcState::ensure(state, WORK_MAGIC)) {
+        state.budget = static_cast<uint8_t>(PowerBudget::NORMAL);
+    }
+}
+
+// When the task in this slot last ran; 0 for never, or if the slot held another task
+static uint32_t& lastRunOf(size_t slot, const char* name) {
+    uint32_t hash = hashName(name);
+    if (state.nameHash[slot] != hash) {
+        state.nameHash[slot] = hash;
+        state.lastRun[slot] = 0;
+    }
+    return state.lastRun[slot];
+}
+
+bool BackgroundWork::add(const char* name, WorkCost cost, uint32_t intervalS, Task task, void* context) {
+    size_t slot = 0;
+    while (slot < entryCount && strcmp(entries[slot].name, name) != 0) slot++;
+    if (slot == MAX_TASKS) {
+        LOG_WARN("BackgroundWork", "No room for task %s", name);
+        return false;
+    }
+    entries[slot] = Entry{name, cost, intervalS, task, context};
+    if (slot == entryCount) entryCount++;
+    return true;
+}
+
+PowerBudget BackgroundWork::classify(uint16_t millivolts, uint16_t previousMillivolts, bool wasCharging) {
+    if (millivolts == 0) return PowerBudget::NORMAL;  // Not read this wake
+    if (previousMillivolts != 0) {
+        if (millivolts >= previousMillivolts + RISE_MV) return PowerBudget::CHARGING;
+        // Still charging while the voltage climbs, or sits at full on the charger;
+        // a one-off jump on battery falls back on the next wake
+        if (wasCharging && (millivolts > previousMillivolts ||
+                            (millivolts >= FULL_MV && millivolts + NOISE_MV >= previousMillivolts))) {
+            return PowerBudget::CHARGING;
+        }
+    }
+
+    int percent = BatteryManager::percentageForVoltage(millivolts / 1000.0f);
+    if (percent >= AMPLE_PERCENT) return PowerBudget::AMPLE;
+    if (percent <= LOW_PERCENT) return PowerBudget::LOW_BATTERY;
+    return PowerBudget::NORMAL;
+}
+
+bool BackgroundWork::isDue(WorkCost cost, PowerBudget budget, uint32_t sinceLastRunS, uint32_t intervalS) {
+    switch (budget) {
+        case PowerBudget::CHARGING:
+            return sinceLastRunS >= intervalS / CHARGING_DIVISOR;
+        case PowerBudget::AMPLE:
+            return sinceLastRunS >= intervalS;
+        case PowerBudget::NORMAL:
+            return sinceLastRunS / (cost == WorkCost::HEAVY ? NORMAL_HEAVY_FACTOR : 1) >= intervalS;
+        default:
+            return false;
+    }
+}
+
+int BackgroundWork::run(float batteryVolts) {
+    ensureState();
+    uint16_t millivolts = static_cast<uint16_t>(batteryVolts * 1000.0f + 0.5f);
+    bool wasCharging = state.budget == static_cast<uint8_t>(PowerBudget::CHARGING);
+    PowerBudget budget = classify(millivolts, state.lastMillivolts, wasCharging);
+    if (millivolts != 0) state.lastMillivolts = millivolts;
+    state.budget = static_cast<uint8_t>(budget);
+    if (budget == PowerBudget::CHARGING && !wasCharging) {
+        LOG_INFO("BackgroundWork", "Charging (%u mV), running deferred work", millivolts);
+    }
+
+    uint32_t now = static_cast<uint32_t>(time(nullptr));
+    if (now < MIN_EPOCH || budget == PowerBudget::LOW_BATTERY) return 0;
+
+    int ran = 0;
+    bool heavyRan = false;
+    for (size_t slot = 0; slot < entryCount; slot++) {
+        const Entry& entry = entries[slot];
+        uint32_t& lastRun = lastRunOf(slot, entry.name);
+        uint32_t since = lastRun == 0 || now < lastRun ? UINT32_MAX : now - lastRun;
+        if (!isDue(entry.cost, budget, since, entry.intervalS)) continue;
+        // On battery one heavy task per wake, so a wake never does all of them at once
+        if (entry.cost == WorkCost::HEAVY && heavyRan && budget != PowerBudget::CHARGING) continue;
+
+        unsigned long start = millis();
+        bool ok = entry.task(entry.context);
+        LOG_INFO("BackgroundWork", "%s %s in %lu ms (%s)", entry.name, ok ? "done" : "failed", millis() - start,
+                 getBudgetName(budget));
+        if (ok) lastRun = now;
+        if (entry.cost == WorkCost::HEAVY) heavyRan = true;
+        ran++;
+    }
+    return ran;
+}
+
+PowerBudget BackgroundWork::getBudget() {
+    ensureState();
+    return static_cast<PowerBudget>(state.budget);
+}
+
+const char* BackgroundWork::getBudgetName(PowerBudget budget) {
+    switch (budget) {
+        case PowerBudget::CHARGING: return "charging";
+        case PowerBudget::AMPLE: return "ample";
+        case PowerBudget::NORMAL: return "normal";
+        case PowerBudget::LOW_BATTERY: return "low battery";
+        default: return "unknown";
+    }
+}
+
+void BackgroundWork::print(Print& out) {
+    ensureState();
+    out.printf("Budget %s (last reading %u mV)\n", getBudgetName(getBudget()), state.lastMillivolts);
+    uint32_t now = static_cast<uint32_t>(time(nullptr));
+    for (size_t slot = 0; slot < entryCount; slot++) {
+        const Entry& entry = entries[slot];
+        uint32_t lastRun = lastRunOf(slot, entry.name);
+        out.printf("  %-14s %-5s every %lu s, ", entry.name, entry.cost == WorkCost::HEAVY ? "heavy" : "light",
+                   static_cast<unsigned long>(entry.intervalS));
+        if (lastRun == 0) {
+            out.printf("never run\n");
+        } else {
+            out.printf("last %lu s ago\n", static_cast<unsigned long>(now >= lastRun ? now - lastRun : 0));
+        }
+    }
+}
+
+void BackgroundWork::reset() {
+    memset(&state, 0, sizeof(state));
+    entryCount = 0;
+}
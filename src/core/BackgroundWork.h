@@ -0,0 +1,83 @@
+#ifndef BACKGROUND_WORK_H
+#define BACKGROUND_WORK_H
+
+#include <Arduino.h>
+#include <cstddef>
+#include <cstdint>
+
+// How much charge a task costs when it runs
+enum class WorkCost : uint8_t {
+    LIGHT = 0,          // A small flash write or a short computation
+    HEAVY               // Downloads, many flash erases, long CPU work
+};
+
+// What the battery allows this wake
+enum class PowerBudget : uint8_t {
+    CHARGING = 0,       // On USB: optional work is free
+    AMPLE,              // Above AMPLE_PERCENT
+    NORMAL,
+    LOW_BATTERY         // At or below LOW_PERCENT: nothing optional runs
+};
+
+/**
+ * Optional work that can wait for a better moment: cache trimming, extra
+ * flash copies, and anything else that keeps the device tidy but no one is
+ * waiting for.
+ *
+ * Tasks are registered each wake with an interval, and run() is called
+ * just before deep sleep with the wake's battery reading. How long a task
+ * may wait depends on the budget that reading gives:
+ *
+ *   CHARGING  every interval / 4, all due tasks
+ *   AMPLE     every interval, one heavy task per wake
+ *   NORMAL    light tasks every interval, heavy every 4 intervals, one per wake
+ *   LOW_BATTERY none
+ *
+ * The Inkplate has no charger status line, so charging is a rise of at least
+ * RISE_MV since the previous wake. It lasts while the voltage keeps rising,
+ * or holds steady at FULL_MV or above as a full battery on USB does. Last runs and the previous reading
+ * are kept in RTC memory; without a set clock nothing runs, because the
+ * intervals are in wall time.
+ */
+class BackgroundWork {
+public:
+    // Returns false if the task failed; it is then tried again next time it is due
+    typedef bool (*Task)(void* context);
+
+    static const size_t MAX_TASKS = 8;
+    static const uint16_t RISE_MV = 20;
+    static const uint16_t NOISE_MV = 10;
+    static const uint16_t FULL_MV = 4150;
+    static const int AMPLE_PERCENT = 60;
+    static const int LOW_PERCENT = 20;
+    static const uint32_t NORMAL_HEAVY_FACTOR = 4;
+    static const uint32_t CHARGING_DIVISOR = 4;
+
+    // Registering a name again replaces the task. False if the table is full.
+    static bool add(const char* name, WorkCost cost, uint32_t intervalS, Task task, void* context = nullptr);
+    // Before deep sleep (or on each update cycle when always on); returns the tasks run
+    static int run(float batteryVolts);
+
+    static PowerBudget getBudget();
+    static const char* getBudgetName(PowerBudget budget);
+    static void print(Print& out);
+
+    // Made public for testing
+    static PowerBudget classify(uint16_t millivolts, uint16_t previousMillivolts, bool wasCharging);
+    static bool isDue(WorkCost cost, PowerBudget budget, uint32_t sinceLastRunS, uint32_t intervalS);
+    static void reset();
+
+private:
+    struct Entry {
+        const char* name;
+        WorkCost cost;
+        uint32_t intervalS;
+        Task task;
+        void* context;
+    };
+
+    static Entry entries[MAX_TASKS];
+    static size_t entryCount;
+};
+
+#endif
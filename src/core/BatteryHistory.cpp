@@ -0,0 +1,296 @@
+#include "BatteryHistory.h"
+#include "Logger.h"
+#include "RtcState.h"
+#include "Storage.h"
+#include "WakeMetrics.h"
+#include "../managers/BatteryManager.h"
+#include "../managers/PowerManager.h"
+#include <cstring>
+#include <ctime>
+
+const char* const BatteryHistory::FILE_NAME = "/battery.bin";
+
+// Kept in RTC memory (see RtcState.h) and in the spill file
+static const uint32_t HISTORY_MAGIC = 0x42484931;  // "BHI1"
+
+// Before this the clock has not been set
+static const uint32_t MIN_EPOCH = 1577836800;  // 2020-01-01
+
+struct BatteryHistoryState {
+    uint32_t magic;
+    uint32_t baseEpoch;                 // Oldest sample, stored in full
+    uint16_t baseMillivolts;
+    uint16_t lastMillivolts;            // Newest sample, so appending needs no decoding
+    uint32_t lastEpoch;
+    uint32_t pendingMicroAh;            // Wake charge since the newest sample
+    uint16_t used;                      // Bytes of entries
+    uint16_t count;                     // Samples, the base included
+    uint8_t sinceSpill;
+    BatteryForecast latest;             // As of the newest sample
+    uint8_t entries[BatteryHistory::CAPACITY];
+};
+
+RTC_DATA_ATTR static BatteryHistoryState state;
+
+static size_t putVarint(uint32_t value, uint8_t* out) {
+    size_t length = 0;
+    do {
+        uint8_t byte = value & 0x7f;
+        value >>= 7;
+        if (value) byte |= 0x80;
+        out[length++] = byte;
+    } while (value);
+    return length;
+}
+
+static bool getVarint(const uint8_t* data, size_t size, size_t& at, uint32_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (at >= size) return false;
+        uint8_t byte = data[at++];
+        value |= static_cast<uint32_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+static uint32_t zigzag(int32_t value) {
+    return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+
+static int32_t unzigzag(uint32_t value) {
+    return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+}
+
+// One entry at 'at': minutes since the previous sample, mV change, wake charge (10 uAh)
+static bool readEntry(size_t& at, uint32_t& minutes, int32_t& deltaMv, uint32_t& charge) {
+    uint32_t encodedDelta;
+    if (!getVarint(state.entries, state.used, at, minutes) ||
+        !getVarint(state.entries, state.used, at, encodedDelta) ||
+        !getVarint(state.entries, state.used, at, charge)) {
+        return false;
+    }
+    deltaMv = unzigzag(encodedDelta);
+    return true;
+}
+
+static void dropOldest() {
+    size_t at = 0;
+    uint32_t minutes, charge;
+    int32_t deltaMv;
+    if (!readEntry(at, minutes, deltaMv, charge)) {
+        // Damaged; start again from the newest sample
+        state.baseEpoch = state.lastEpoch;
+        state.baseMillivolts = state.lastMillivolts;
+        state.used = 0;
+        state.count = 1;
+        return;
+    }
+    state.baseEpoch += minutes * 60;
+    state.baseMillivolts = static_cast<uint16_t>(state.baseMillivolts + deltaMv);
+    memmove(state.entries, state.entries + at, state.used - at);
+    state.used = static_cast<uint16_t>(state.used - at);
+    state.count--;
+}
+
+static void ensureState() {
+    if (!RtcState::ensure(state, HISTORY_MAGIC)) {
+        BatteryHistory::restore();
+    }
+}
+
+void BatteryHistory::endWake() {
+    // Without RTC memory each wake would start from the last spill
+    if (!PowerManager::isRetainingRtcMemory()) return;
+    ensureState();
+
+    // Charge at fixed currents; radio and panel draw on top of the CPU
+    float mAms = WakeMetrics::getAwakeMs() * ACTIVE_MA;
+    const PhaseTiming* wifi = WakeMetrics::findPhase("wifi");
+    if (wifi) mAms += wifi->totalMicros / 1000.0f * RADIO_MA;
+    const char* panelPhases[] = {"panel.full", "panel.partial"};
+    for (const char* name : panelPhases) {
+        const PhaseTiming* panel = WakeMetrics::findPhase(name);
+        if (panel) mAms += panel->totalMicros / 1000.0f * PANEL_MA;
+    }
+    uint32_t microAh = static_cast<uint32_t>(mAms / 3600.0f + 0.5f);
+
+    uint16_t millivolts = static_cast<uint16_t>(WakeMetrics::getBatteryVolts() * 1000.0f + 0.5f);
+    if (record(static_cast<uint32_t>(time(nullptr)), millivolts, microAh)) {
+        const BatteryForecast& outlook = state.latest;
+        if (outlook.valid) {
+            LOG_INFO("BatteryHistory", "%d%%, %.1f%%/day, about %.0f h left (wakes %.1f mAh/day)", outlook.percent,
+                     outlook.percentPerDay, outlook.hoursLeft, outlook.wakeMahPerDay);
+        } else {
+            LOG_INFO("BatteryHistory", "%u samples, not enough discharge yet for a forecast", state.count);
+        }
+    }
+}
+
+bool BatteryHistory::record(uint32_t epoch, uint16_t millivolts, uint32_t wakeMicroAh) {
+    ensureState();
+    state.pendingMicroAh += wakeMicroAh;
+    if (epoch < MIN_EPOCH || millivolts == 0) return false;
+
+    if (state.count == 0) {
+        state.baseEpoch = state.lastEpoch = epoch;
+        state.baseMillivolts = state.lastMillivolts = millivolts;
+        state.pendingMicroAh = 0;
+        state.count = 1;
+        state.latest = forecast();
+        return true;
+    }
+    if (epoch < state.lastEpoch + SAMPLE_INTERVAL_S) return false;
+
+    uint32_t minutes = (epoch - state.lastEpoch) / 60;
+    uint8_t entry[15];
+    size_t length = putVarint(minutes, entry);
+    length += putVarint(zigzag(static_cast<int32_t>(millivolts) - state.lastMillivolts), entry + length);
+    length += putVarint((state.pendingMicroAh + 5) / 10, entry + length);
+
+    while (state.used + length > CAPACITY && state.count > 1) {
+        dropOldest();
+    }
+    memcpy(state.entries + state.used, entry, length);
+    state.used = static_cast<uint16_t>(state.used + length);
+    state.count++;
+    // Whole minutes, so the decoded times add up to the same place
+    state.lastEpoch += minutes * 60;
+    state.lastMillivolts = millivolts;
+    state.pendingMicroAh = 0;
+    state.latest = forecast();
+
+    if (++state.sinceSpill >= SPILL_EVERY) {
+        spill();
+    }
+    return true;
+}
+
+void BatteryHistory::getSamples(std::vector<BatterySample>& samples) {
+    samples.clear();
+    if (!RtcState::isValid(state, HISTORY_MAGIC) || state.count == 0) return;
+
+    BatterySample sample = {state.baseEpoch, state.baseMillivolts, 0};
+    samples.push_back(sample);
+    size_t at = 0;
+    while (at < state.used) {
+        uint32_t minutes, charge;
+        int32_t deltaMv;
+        if (!readEntry(at, minutes, deltaMv, charge)) break;
+        sample.epoch += minutes * 60;
+        sample.millivolts = static_cast<uint16_t>(sample.millivolts + deltaMv);
+        sample.wakeMicroAh = charge * 10;
+        samples.push_back(sample);
+    }
+}
+
+BatteryForecast BatteryHistory::forecast() {
+    BatteryForecast result = {};
+    std::vector<BatterySample> samples;
+    getSamples(samples);
+    if (samples.empty()) return result;
+    result.percent = BatteryManager::percentageForVoltage(samples.back().millivolts / 1000.0f);
+
+    // Only the discharge since the last charge counts
+    size_t start = 0;
+    for (size_t i = 1; i < samples.size(); i++) {
+        if (samples[i].millivolts >= samples[i - 1].millivolts + CHARGE_RISE_MV) {
+            start = i;
+        }
+    }
+    uint32_t span = samples.back().epoch - samples[start].epoch;
+    if (samples.size() - start < 3 || span < MIN_SPAN_HOURS * 3600) return result;
+
+    // Least squares of charge against hours
+    double n = 0, sumX = 0, sumY = 0, sumXX = 0, sumXY = 0;
+    uint64_t microAh = 0;
+    for (size_t i = start; i < samples.size(); i++) {
+        double x = (samples[i].epoch - samples[start].epoch) / 3600.0;
+        double y = BatteryManager::percentageForVoltage(samples[i].millivolts / 1000.0f);
+        n++;
+        sumX += x;
+        sumY += y;
+        sumXX += x * x;
+        sumXY += x * y;
+        if (i > start) microAh += samples[i].wakeMicroAh;
+    }
+    double slope = (n * sumXY - sumX * sumY) / (n * sumXX - sumX * sumX);
+    if (!(slope < 0)) return result;
+
+    result.valid = true;
+    result.percentPerDay = static_cast<float>(-slope * 24);
+    result.hoursLeft = static_cast<float>(result.percent / -slope);
+    result.wakeMahPerDay = static_cast<float>(microAh / 1000.0 / (span / 86400.0));
+    return result;
+}
+
+BatteryForecast BatteryHistory::getForecast() {
+    return RtcState::isValid(state, HISTORY_MAGIC) ? state.latest : BatteryForecast{};
+}
+
+size_t BatteryHistory::getUsedBytes() {
+    return RtcState::isValid(state, HISTORY_MAGIC) ? state.used : 0;
+}
+
+bool BatteryHistory::spill() {
+    state.sinceSpill = 0;
+    // Left out of the logs index, so the quota never evicts it to make room
+    // for traces; removing it also drops an entry older firmware recorded
+    Storage::remove(StorageUse::LOGS, FILE_NAME);
+    fs::File file = Storage::open(StorageUse::LOGS, FILE_NAME, "w");
+    if (!file) {
+        LOG_ERROR("BatteryHistory", "Failed to open %s for writing", FILE_NAME);
+        return false;
+    }
+    size_t written = file.write(reinterpret_cast<const uint8_t*>(&state), sizeof(state));
+    file.close();
+    if (written != sizeof(state)) {
+        LOG_ERROR("BatteryHistory", "Short write to %s", FILE_NAME);
+        Storage::remove(StorageUse::LOGS, FILE_NAME);
+        return false;
+    }
+    return true;
+}
+
+bool BatteryHistory::restore() {
+    if (!Storage::exists(StorageUse::LOGS, FILE_NAME)) return false;
+    fs::File file = Storage::open(StorageUse::LOGS, FILE_NAME, "r");
+    if (!file) return false;
+
+    BatteryHistoryState stored;
+    bool ok = file.size() == sizeof(stored) &&
+              file.read(reinterpret_cast<uint8_t*>(&stored), sizeof(stored)) == sizeof(stored);
+    file.close();
+    if (!ok || stored.magic != HISTORY_MAGIC || stored.used > CAPACITY) {
+        LOG_WARN("BatteryHistory", "Ignoring damaged %s", FILE_NAME);
+        return false;
+    }
+
+    // Charge since the spill was lost with RTC memory
+    state = stored;
+    state.pendingMicroAh = 0;
+    LOG_INFO("BatteryHistory", "Restored %u samples from %s", state.count, FILE_NAME);
+    return true;
+}
+
+void BatteryHistory::reset() {
+    memset(&state, 0, sizeof(state));
+}
+
+void BatteryHistory::print(Print& out) {
+    std::vector<BatterySample> samples;
+    getSamples(samples);
+    if (samples.empty()) {
+        out.printf("no battery history yet\n");
+        return;
+    }
+    out.printf("%u samples over %.1f days in %u bytes\n", static_cast<unsigned>(samples.size()),
+               (samples.back().epoch - samples.front().epoch) / 86400.0, static_cast<unsigned>(state.used));
+    BatteryForecast outlook = getForecast();
+    if (outlook.valid) {
+        out.printf("%d%%, %.1f%%/day, about %.0f h left; wakes use %.1f mAh/day\n", outlook.percent,
+                   outlook.percentPerDay, outlook.hoursLeft, outlook.wakeMahPerDay);
+    } else {
+        out.printf("%d%%, not enough discharge yet for a forecast\n", outlook.percent);
+    }
+}
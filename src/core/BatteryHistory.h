@@ -0,0 +1,79 @@
+#ifndef BATTERY_HISTORY_H
+#define BATTERY_HISTORY_H
+
+#include <Arduino.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * One point of the battery history
+ */
+struct BatterySample {
+    uint32_t epoch;                     // Seconds (UTC)
+    uint16_t millivolts;
+    uint32_t wakeMicroAh;               // Spent by wakes since the previous sample
+};
+
+/**
+ * Discharge rate and runtime left, from the samples since the last charge.
+ * Plain data: it is kept in RTC memory.
+ */
+struct BatteryForecast {
+    bool valid;                         // Needs MIN_SPAN_HOURS of discharge
+    float percentPerDay;
+    float hoursLeft;
+    float wakeMahPerDay;                // Estimated charge spent by wakes
+    int percent;                        // Discharge curve at the newest sample
+};
+
+/**
+ * Battery voltage and wake charge over the last couple of weeks, kept in
+ * RTC memory so each unit can tell when it will need charging.
+ *
+ * endWake() adds the wake's estimated charge (awake, radio and panel time
+ * at fixed currents) to a running total, and appends a sample at most every
+ * SAMPLE_INTERVAL_S once the clock is set. The first sample is stored in
+ * full; the rest are varints of (minutes since the previous sample, zigzag
+ * mV change, wake charge in 10 uAh), usually 3-4 bytes, so the CAPACITY-byte
+ * buffer holds about two weeks. When it is full the oldest sample is folded
+ * into the base.
+ * Every SPILL_EVERY samples the history is copied to flash (/battery.bin
+ * in log storage) and it is read back from there after a power loss.
+ *
+ * The forecast is worked out when a sample is added and kept with the
+ * history, so widgets and logs read it without decoding anything.
+ */
+class BatteryHistory {
+public:
+    static const size_t CAPACITY = 512;
+    static const uint32_t SAMPLE_INTERVAL_S = 7200;
+    static const uint8_t SPILL_EVERY = 12;
+    static const uint16_t CHARGE_RISE_MV = 50;      // A rise this large means it was charged
+    static const uint32_t MIN_SPAN_HOURS = 12;
+    static const char* const FILE_NAME;
+
+    // Currents for the wake charge estimate (mA)
+    static constexpr float ACTIVE_MA = 45.0f;
+    static constexpr float RADIO_MA = 110.0f;       // On top of ACTIVE_MA
+    static constexpr float PANEL_MA = 80.0f;        // On top of ACTIVE_MA
+
+    // Before deep sleep: account this wake and sample if one is due. The
+    // history is read back from flash first if RTC memory was lost.
+    static void endWake();
+
+    // As of the newest sample; not valid until there is enough discharge
+    static BatteryForecast getForecast();
+    static void print(Print& out);
+
+    // Made public for testing
+    static bool record(uint32_t epoch, uint16_t millivolts, uint32_t wakeMicroAh);
+    static void getSamples(std::vector<BatterySample>& samples);
+    static BatteryForecast forecast();
+    static size_t getUsedBytes();
+    static bool spill();
+    static bool restore();
+    static void reset();
+};
+
+#endif
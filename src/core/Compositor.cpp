@@ -1,5 +1,7 @@
 #include "Compositor.h"
 #include "Logger.h"
+#include "MemoryTracker.h"
+#include "WakeMetrics.h"
 #include <cstring>
 #include <algorithm>
 
@@ -69,8 +71,9 @@ bool Compositor::initialize() {
         return false;
     }
 
-    // Allocate virtual surface buffer
-    virtualSurface = new(std::nothrow) uint8_t[surfaceSize];
+    // Allocate virtual surface buffer (PSRAM preferred to spare the internal heap)
+    virtualSurface = static_cast<uint8_t*>(
+        MemoryTracker::allocate(MemorySubsystem::COMPOSITOR, surfaceSize, true));
     if (!virtualSurface) {
         setError(CompositorError::MemoryAllocationFailed);
         logError("initialize", lastError);
@@ -78,10 +81,11 @@ bool Compositor::initialize() {
     }
 
     // Allocate dirty regions tracking (one bool per pixel for simplicity)
-    size_t dirtySize = static_cast<size_t>(surfaceWidth) * surfaceHeight;
-    dirtyRegions = new(std::nothrow) bool[dirtySize];
+    size_t dirtySize = static_cast<size_t>(surfaceWidth) * surfaceHeight * sizeof(bool);
+    dirtyRegions = static_cast<bool*>(
+        MemoryTracker::allocate(MemorySubsystem::COMPOSITOR, dirtySize, true));
     if (!dirtyRegions) {
-        delete[] virtualSurface;
+        MemoryTracker::release(MemorySubsystem::COMPOSITOR, virtualSurface, surfaceSize);
         virtualSurface = nullptr;
         setError(CompositorError::MemoryAllocationFailed);
         logError("initialize", lastError);
@@ -121,12 +125,13 @@ bool Compositor::initializeWithRetry(int maxAttempts) {
 
 void Compositor::cleanup() {
     if (virtualSurface) {
-        delete[] virtualSurface;
+        MemoryTracker::release(MemorySubsystem::COMPOSITOR, virtualSurface, surfaceSize);
         virtualSurface = nullptr;
     }
 
     if (dirtyRegions) {
-        delete[] dirtyRegions;
+        MemoryTracker::release(MemorySubsystem::COMPOSITOR, dirtyRegions,
+                               static_cast<size_t>(surfaceWidth) * surfaceHeight * sizeof(bool));
         dirtyRegions = nullptr;
     }
 
@@ -305,6 +310,186 @@ bool Compositor::fillRect(int x, int y, int w, int h, uint8_t color) {
     return success;
 }
 
+namespace {
+
+/**
+ * Reads PackBits runs as one stream of bytes, whatever rows they span
+ */
+class PackBitsReader {
+public:
+    PackBitsReader(const uint8_t* data, size_t length) : data(data), length(length) {}
+
+    // The next count bytes into out, or skipped with nullptr; false if the runs end first
+    bool read(uint8_t* out, size_t count) {
+        while (count > 0) {
+            if (remaining == 0 && !nextRun()) return false;
+            size_t take = std::min(count, remaining);
+            if (out) {
+                if (literal) {
+                    memcpy(out, data + at, take);
+                } else {
+                    memset(out, data[at], take);
+                }
+                out += take;
+            }
+            remaining -= take;
+            count -= take;
+            if (literal) {
+                at += take;
+            } else if (remaining == 0) {
+                at++;
+            }
+        }
+        return true;
+    }
+
+private:
+    const uint8_t* data;
+    size_t length;
+    size_t at = 0;
+    size_t remaining = 0;
+    bool literal = false;
+
+    bool nextRun() {
+        while (at < length) {
+            int8_t control = static_cast<int8_t>(data[at++]);
+            if (control == -128) continue;
+            literal = control >= 0;
+            remaining = literal ? static_cast<size_t>(control) + 1 : static_cast<size_t>(1 - control);
+            return (literal ? remaining : 1) <= length - at;
+        }
+        return false;
+    }
+};
+
+// Values of count pixels from column on, one byte each
+void unpackRow(const uint8_t* row, int bitsPerPixel, int column, int count, uint8_t* out) {
+    int perByte = 8 / bitsPerPixel;
+    uint8_t top = static_cast<uint8_t>((1 << bitsPerPixel) - 1);
+    for (int i = 0; i < count; i++, column++) {
+        int shift = 8 - bitsPerPixel * (column % perByte + 1);
+        out[i] = (row[column / perByte] >> shift) & top;
+    }
+}
+
+}  // namespace
+
+bool Compositor::blit(int x, int y, const Sprite& sprite) {
+    if (!virtualSurface) {
+        setError(CompositorError::SurfaceNotInitialized);
+        logError("blit", lastError);
+        return false;
+    }
+
+    int bits = sprite.bitsPerPixel;
+    size_t stride = sprite.getStride();
+    if (!sprite.data || sprite.width == 0 || sprite.height == 0 || (bits != 1 && bits != 2 && bits != 4 && bits != 8) ||
+        (sprite.encoding == SpriteEncoding::RAW && sprite.length < stride * sprite.height)) {
+        setError(CompositorError::InvalidRegion);
+        return false;
+    }
+
+    int left = std::max(0, x);
+    int top = std::max(0, y);
+    int right = std::min(surfaceWidth, x + sprite.width);
+    int bottom = std::min(surfaceHeight, y + sprite.height);
+    if (left >= right || top >= bottom) return true;
+    int count = right - left;
+
+    // Gray level per source value; 8-bit sources without a palette are copied as they are
+    bool direct = bits == 8 && !sprite.palette;
+    uint8_t levels[256];
+    if (!direct) {
+        int topValue = (1 << bits) - 1;
+        for (int value = 0; value <= topValue; value++) {
+            levels[value] = sprite.palette ? sprite.palette[value] : static_cast<uint8_t>(value * 255 / topValue);
+        }
+    }
+
+    // A decoded row, then the clipped columns as one value each
+    blitRow.resize(stride + count);
+    uint8_t* packed = blitRow.data();
+    uint8_t* values = packed + stride;
+
+    PackBitsReader reader(sprite.data, sprite.length);
+    bool packBits = sprite.encoding == SpriteEncoding::PACKBITS;
+    bool complete = !packBits || reader.read(nullptr, stride * (top - y));
+    size_t maskStride = (static_cast<size_t>(sprite.width) + 7) / 8;
+    int firstColumn = left - x;
+
+    for (int row = top; row < bottom && complete; row++) {
+        const uint8_t* source = sprite.data + static_cast<size_t>(row - y) * stride;
+        if (packBits) {
+            if (!reader.read(packed, stride)) {
+                complete = false;
+                break;
+            }
+            source = packed;
+        }
+
+        const uint8_t* rowValues = values;
+        if (bits == 8) {
+            rowValues = source + firstColumn;
+        } else {
+            unpackRow(source, bits, firstColumn, count, values);
+        }
+
+        uint8_t* target = virtualSurface + getPixelIndex(left, row);
+        const uint8_t* maskRow = sprite.mask ? sprite.mask + static_cast<size_t>(row - y) * maskStride : nullptr;
+        if (!maskRow && sprite.key == Sprite::NO_KEY) {
+            // Opaque: the whole row at once
+            if (direct) {
+                memcpy(target, rowValues, count);
+            } else {
+                for (int i = 0; i < count; i++) target[i] = levels[rowValues[i]];
+            }
+            continue;
+        }
+
+        // Spans between transparent pixels
+        auto visible = [&](int i) {
+            int column = firstColumn + i;
+            return rowValues[i] != sprite.key && (!maskRow || (maskRow[column / 8] & (0x80 >> (column % 8))));
+        };
+        int i = 0;
+        while (i < count) {
+            while (i < count && !visible(i)) i++;
+            int start = i;
+            while (i < count && visible(i)) i++;
+            if (direct) {
+                memcpy(target + start, rowValues + start, i - start);
+            } else {
+                for (int j = start; j < i; j++) target[j] = levels[rowValues[j]];
+            }
+        }
+    }
+
+    markRegionChanged(LayoutRegion(left, top, count, bottom - top));
+    if (!complete) {
+        LOG_WARN("Compositor", "Sprite data ends before its %dx%d pixels", sprite.width, sprite.height);
+        return false;
+    }
+    return true;
+}
+
+bool Compositor::blitMono(int x, int y, const uint8_t* bits, int w, int h, uint8_t color) {
+    if (w <= 0 || h <= 0 || w > 0xffff || h > 0xffff) {
+        setError(CompositorError::InvalidRegion);
+        return false;
+    }
+
+    const uint8_t palette[2] = {255, color};
+    Sprite sprite;
+    sprite.data = bits;
+    sprite.width = static_cast<uint16_t>(w);
+    sprite.height = static_cast<uint16_t>(h);
+    sprite.bitsPerPixel = 1;
+    sprite.length = sprite.getStride() * sprite.height;
+    sprite.key = 0;
+    sprite.palette = palette;
+    return blit(x, y, sprite);
+}
+
 bool Compositor::markRegionChanged(const LayoutRegion& region) {
     // Validate region bounds
     if (!validateRegion(region)) {
@@ -411,7 +596,10 @@ bool Compositor::displayToInkplate(Inkplate& display) {
         }
 
         // Perform full display update
-        display.display();
+        {
+            WakeMetrics::Phase phase("panel.full");
+            display.display();
+        }
 
         // Reset change tracking after successful display
         resetChangeTracking();
@@ -513,7 +701,10 @@ bool Compositor::partialDisplayToInkplate(Inkplate& display, const std::vector<L
         }
 
         // Perform partial display update
-        display.partialUpdate();
+        {
+            WakeMetrics::Phase phase("panel.partial");
+            display.partialUpdate();
+        }
 
         // Update performance metrics
         unsigned long totalUpdateTime = millis() - startTime;
@@ -645,10 +836,21 @@ LayoutRegion Compositor::clampRegionToBounds(const LayoutRegion& region) const {
 }
 
 bool Compositor::checkMemoryPressure() const {
-    // Simple memory pressure check - in a real implementation,
-    // you might check available heap memory
     size_t requiredMemory = surfaceSize + (surfaceWidth * surfaceHeight * sizeof(bool));
-    return requiredMemory > memoryPressureThreshold;
+    if (requiredMemory > memoryPressureThreshold) {
+        return true;
+    }
+
+    // Each buffer needs one contiguous block; total free memory is not enough
+    // once the heap has fragmented after a long uptime
+    HeapSnapshot heap = MemoryTracker::takeSnapshot();
+    size_t largestBlock = std::max(heap.largestFreeInternal, heap.largestFreePsram);
+    if (surfaceSize > largestBlock) {
+        LOG_WARN("Compositor", "Largest free block %zu bytes < surface %zu bytes (fragmentation %.0f%%)",
+                 largestBlock, surfaceSize, heap.fragmentation * 100.0f);
+        return true;
+    }
+    return false;
 }
 
 bool Compositor::isValidRegion(const LayoutRegion& region) const {
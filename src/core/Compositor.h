@@ -9,6 +9,7 @@
 #include <Inkplate.h>
 #endif
 #include "LayoutRegion.h"
+#include "Sprite.h"
 
 /**
  * Error codes for Compositor operations
@@ -37,6 +38,9 @@ private:
     int bytesPerPixel;
     size_t surfaceSize;
 
+    // Scratch for one unpacked sprite row, kept between blits
+    std::vector<uint8_t> blitRow;
+
     // Change tracking
     std::vector<LayoutRegion> changedAreas;
     bool hasChanges;
@@ -80,7 +84,6 @@ private:
     // Partial update optimization methods
     void optimizeRegionsForPartialUpdate();
     bool shouldMergeRegions(const LayoutRegion& a, const LayoutRegion& b) const;
-    std::vector<LayoutRegion> coalesceRegions(const std::vector<LayoutRegion>& regions) const;
     void updateRegionHistory(const LayoutRegion& region, unsigned long updateTime);
     bool shouldUsePartialUpdate(const std::vector<LayoutRegion>& regions) const;
     void updatePerformanceMetrics(unsigned long updateTime, size_t pixelsUpdated);
@@ -121,6 +124,11 @@ public:
     bool drawRect(int x, int y, int w, int h, uint8_t color);
     bool fillRect(int x, int y, int w, int h, uint8_t color);
 
+    // Sprites, clipped to the surface and marked changed as one region
+    bool blit(int x, int y, const Sprite& sprite);
+    // Raw 1-bit source: set bits are drawn in color, clear bits left alone
+    bool blitMono(int x, int y, const uint8_t* bits, int w, int h, uint8_t color);
+
     // Change tracking
     bool markRegionChanged(const LayoutRegion& region);
     void resetChangeTracking();
@@ -162,6 +170,9 @@ public:
     // Bounds checking and validation
     bool isValidRegion(const LayoutRegion& region) const;
     LayoutRegion correctInvalidRegion(const LayoutRegion& region) const;
+
+    // Region coalescing
+    std::vector<LayoutRegion> coalesceRegions(const std::vector<LayoutRegion>& regions) const; // Made public for benchmarking
 };
 
 #endif
@@ -0,0 +1,465 @@
+#include "InputTrace.h"
+#include "Logger.h"
+#include "MemoryTracker.h"
+#include "Storage.h"
+#include <cstring>
+#include <ctime>
+
+const char* InputTrace::TRACE_FILE = "/trace.bin";
+const char* InputTrace::PREVIOUS_TRACE_FILE = "/trace.prev.bin";
+
+bool InputTrace::recording = false;
+bool InputTrace::truncated = false;
+uint8_t* InputTrace::buffer = nullptr;
+size_t InputTrace::capacity = 0;
+size_t InputTrace::length = 0;
+TraceHeader InputTrace::wake;
+size_t InputTrace::streamFlag = 0;
+size_t InputTrace::streamBody = 0;
+
+static const uint8_t MAGIC[4] = {'I', 'T', 'R', 'C'};
+static const uint8_t VERSION = 2;             // 2: HTTP records carry headers
+static const size_t FLAGS_OFFSET = 6;
+static const uint8_t FLAG_CLOCK_VALID = 0x01;
+static const uint8_t FLAG_TRUNCATED = 0x02;
+
+// Always left free so the sleep record fits after the budget runs out
+static const size_t SLEEP_RESERVE = 16;
+
+// A streamed body's length is written padded to this many bytes, so it can
+// be rewritten in place as chunks arrive
+static const size_t STREAM_LENGTH_BYTES = 5;
+
+// Anything earlier than 2020-01-01 means the RTC was never set
+static const time_t VALID_EPOCH = 1577836800;
+
+static size_t varintSize(uint64_t value) {
+    size_t size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        size++;
+    }
+    return size;
+}
+
+static uint64_t zigzag(int32_t value) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(value)) << 1) ^ (value < 0 ? ~0ULL : 0ULL);
+}
+
+static int32_t unzigzag(uint64_t value) {
+    return static_cast<int32_t>((value >> 1) ^ (~(value & 1) + 1));
+}
+
+void InputTrace::beginWake(uint8_t wakeCause) {
+    time_t now = time(nullptr);
+    wake.wakeCause = wakeCause;
+    wake.clockValid = now > VALID_EPOCH;
+    wake.bootEpochSeconds = wake.clockValid ? static_cast<uint64_t>(now) : 0;
+    wake.bootMs = static_cast<uint32_t>(millis());
+}
+
+bool InputTrace::start(size_t maxBytes) {
+    if (recording) return true;
+    if (maxBytes < 64) {
+        LOG_WARN("InputTrace", "Trace budget of %u bytes is too small", static_cast<unsigned>(maxBytes));
+        return false;
+    }
+
+    buffer = static_cast<uint8_t*>(MemoryTracker::allocate(MemorySubsystem::LOGGING, maxBytes, true));
+    if (!buffer) {
+        LOG_ERROR("InputTrace", "Cannot allocate %u byte trace buffer", static_cast<unsigned>(maxBytes));
+        return false;
+    }
+    capacity = maxBytes;
+    length = 0;
+    truncated = false;
+
+    for (uint8_t byte : MAGIC) putByte(byte);
+    putByte(VERSION);
+    putByte(wake.wakeCause);
+    putByte(wake.clockValid ? FLAG_CLOCK_VALID : 0);
+    putVarint(wake.bootEpochSeconds);
+    putVarint(wake.bootMs);
+
+    recording = true;
+    LOG_INFO("InputTrace", "Recording inputs of this wake (%u byte budget)", static_cast<unsigned>(maxBytes));
+    return true;
+}
+
+void InputTrace::recordHttp(unsigned long startMs, const String& url, int status, const String& body,
+                            const String& headers) {
+    if (!recording) return;
+    TraceEvent event;
+    event.type = TraceEventType::HTTP;
+    event.atMs = static_cast<uint32_t>(startMs);
+    event.durationMs = static_cast<uint32_t>(millis() - startMs);
+    event.value = status;
+    event.url = url.c_str();
+    event.headers.assign(headers.c_str(), headers.length());
+    event.body.assign(body.c_str(), body.length());
+
+    // Keep the timing when the body does not fit
+    if (length + encodedSize(event) + SLEEP_RESERVE > capacity) {
+        event.body.clear();
+        event.bodyOmitted = true;
+    }
+    append(event);
+}
+
+void InputTrace::recordHttpTiming(unsigned long startMs, const char* url, int status) {
+    if (!recording) return;
+    TraceEvent event;
+    event.type = TraceEventType::HTTP;
+    event.atMs = static_cast<uint32_t>(startMs);
+    event.durationMs = static_cast<uint32_t>(millis() - startMs);
+    event.value = status;
+    event.bodyOmitted = true;
+    event.url = url ? url : "";
+    append(event);
+}
+
+void InputTrace::recordHttpStart(unsigned long startMs, const char* url, int status, const String& headers) {
+    if (!recording) return;
+    TraceEvent event;
+    event.type = TraceEventType::HTTP;
+    event.atMs = static_cast<uint32_t>(startMs);
+    event.durationMs = static_cast<uint32_t>(millis() - startMs);
+    event.value = status;
+    event.url = url ? url : "";
+    event.headers.assign(headers.c_str(), headers.length());
+
+    size_t start = length;
+    if (length + encodedSize(event) + STREAM_LENGTH_BYTES + SLEEP_RESERVE > capacity) {
+        append(event);  // Truncates the trace
+        return;
+    }
+    encode(event);
+    // Replace the one-byte empty body length with a padded one
+    length--;
+    streamBody = length;
+    length += STREAM_LENGTH_BYTES;
+    putPaddedLength(0);
+    streamFlag = start + 1 + varintSize(event.atMs) + varintSize(event.durationMs) + varintSize(zigzag(event.value));
+}
+
+void InputTrace::recordHttpBody(const void* data, size_t size) {
+    if (!recording || streamFlag == 0 || size == 0) return;
+    if (length + size + SLEEP_RESERVE > capacity) {
+        // Keep the timing and headers, as for a body recorded in one piece
+        buffer[streamFlag] = 1;
+        length = streamBody + STREAM_LENGTH_BYTES;
+        putPaddedLength(0);
+        streamFlag = 0;
+        return;
+    }
+    memcpy(buffer + length, data, size);
+    length += size;
+    putPaddedLength(length - streamBody - STREAM_LENGTH_BYTES);
+}
+
+void InputTrace::recordWiFi(unsigned long startMs, bool connected) {
+    if (!recording) return;
+    TraceEvent event;
+    event.type = TraceEventType::WIFI;
+    event.atMs = static_cast<uint32_t>(startMs);
+    event.durationMs = static_cast<uint32_t>(millis() - startMs);
+    event.value = connected ? 1 : 0;
+    append(event);
+}
+
+void InputTrace::recordTimeSync(unsigned long startMs, time_t epochSeconds) {
+    if (!recording) return;
+    TraceEvent event;
+    event.type = TraceEventType::TIME_SYNC;
+    event.atMs = static_cast<uint32_t>(startMs);
+    event.durationMs = static_cast<uint32_t>(millis() - startMs);
+    event.epochSeconds = epochSeconds > VALID_EPOCH ? static_cast<uint64_t>(epochSeconds) : 0;
+    append(event);
+}
+
+void InputTrace::recordBattery(float volts) {
+    if (!recording) return;
+    TraceEvent event;
+    event.type = TraceEventType::BATTERY;
+    event.atMs = static_cast<uint32_t>(millis());
+    event.volts = volts;
+    append(event);
+}
+
+void InputTrace::recordButton(uint8_t pin, int level) {
+    if (!recording) return;
+    TraceEvent event;
+    event.type = TraceEventType::BUTTON;
+    event.atMs = static_cast<uint32_t>(millis());
+    event.pin = pin;
+    event.value = level ? 1 : 0;
+    append(event);
+}
+
+bool InputTrace::finish(unsigned long sleepMs) {
+    if (!recording) return false;
+    TraceEvent event;
+    event.type = TraceEventType::SLEEP;
+    event.atMs = static_cast<uint32_t>(millis());
+    event.durationMs = static_cast<uint32_t>(sleepMs);
+    if (length + encodedSize(event) <= capacity) {
+        encode(event);
+    }
+    recording = false;
+    streamFlag = 0;
+    return save();
+}
+
+bool InputTrace::append(const TraceEvent& event) {
+    streamFlag = 0;
+    if (length + encodedSize(event) + SLEEP_RESERVE > capacity) {
+        // Out of budget: keep what we have, even if the unit never sleeps
+        LOG_WARN("InputTrace", "Trace budget exhausted after %u bytes, saving", static_cast<unsigned>(length));
+        truncated = true;
+        recording = false;
+        save();
+        return false;
+    }
+    encode(event);
+    return true;
+}
+
+size_t InputTrace::encodedSize(const TraceEvent& event) {
+    size_t size = 1 + varintSize(event.atMs);
+    switch (event.type) {
+        case TraceEventType::HTTP:
+            size += varintSize(event.durationMs) + varintSize(zigzag(event.value)) + 1 +
+                    varintSize(event.url.size()) + event.url.size() +
+                    varintSize(event.headers.size()) + event.headers.size() +
+                    varintSize(event.body.size()) + event.body.size();
+            break;
+        case TraceEventType::WIFI:
+            size += varintSize(event.durationMs) + 1;
+            break;
+        case TraceEventType::TIME_SYNC:
+            size += varintSize(event.durationMs) + varintSize(event.epochSeconds);
+            break;
+        case TraceEventType::BATTERY:
+            size += 4;
+            break;
+        case TraceEventType::BUTTON:
+            size += 2;
+            break;
+        case TraceEventType::SLEEP:
+            size += varintSize(event.durationMs);
+            break;
+    }
+    return size;
+}
+
+void InputTrace::encode(const TraceEvent& event) {
+    putByte(static_cast<uint8_t>(event.type));
+    putVarint(event.atMs);
+    switch (event.type) {
+        case TraceEventType::HTTP:
+            putVarint(event.durationMs);
+            putVarint(zigzag(event.value));
+            putByte(event.bodyOmitted ? 1 : 0);
+            putString(event.url.data(), event.url.size());
+            putString(event.headers.data(), event.headers.size());
+            putString(event.body.data(), event.body.size());
+            break;
+        case TraceEventType::WIFI:
+            putVarint(event.durationMs);
+            putByte(event.value ? 1 : 0);
+            break;
+        case TraceEventType::TIME_SYNC:
+            putVarint(event.durationMs);
+            putVarint(event.epochSeconds);
+            break;
+        case TraceEventType::BATTERY: {
+            uint32_t bits;
+            memcpy(&bits, &event.volts, sizeof(bits));
+            for (int i = 0; i < 4; i++) putByte(static_cast<uint8_t>(bits >> (8 * i)));
+            break;
+        }
+        case TraceEventType::BUTTON:
+            putByte(event.pin);
+            putByte(event.value ? 1 : 0);
+            break;
+        case TraceEventType::SLEEP:
+            putVarint(event.durationMs);
+            break;
+    }
+}
+
+bool InputTrace::save() {
+    if (!buffer) return false;
+    buffer[FLAGS_OFFSET] = (wake.clockValid ? FLAG_CLOCK_VALID : 0) | (truncated ? FLAG_TRUNCATED : 0);
+
+    if (Storage::exists(StorageUse::LOGS, TRACE_FILE)) {
+        Storage::remove(StorageUse::LOGS, PREVIOUS_TRACE_FILE);
+        Storage::rename(StorageUse::LOGS, TRACE_FILE, PREVIOUS_TRACE_FILE);
+    }
+    if (!Storage::reserve(StorageUse::LOGS, length)) {
+        return false;
+    }
+
+    fs::File file = Storage::open(StorageUse::LOGS, TRACE_FILE, "w");
+    if (!file) {
+        LOG_ERROR("InputTrace", "Failed to open %s for writing", TRACE_FILE);
+        return false;
+    }
+    size_t written = file.write(buffer, length);
+    file.close();
+
+    if (written != length) {
+        LOG_ERROR("InputTrace", "Short write to %s (%u of %u bytes)", TRACE_FILE,
+                  static_cast<unsigned>(written), static_cast<unsigned>(length));
+        return false;
+    }
+    Storage::recordWrite(StorageUse::LOGS, TRACE_FILE, length);
+    LOG_INFO("InputTrace", "Saved %u byte input trace to %s", static_cast<unsigned>(length), TRACE_FILE);
+    return true;
+}
+
+void InputTrace::reset() {
+    MemoryTracker::release(MemorySubsystem::LOGGING, buffer, capacity);
+    buffer = nullptr;
+    capacity = 0;
+    length = 0;
+    recording = false;
+    truncated = false;
+    streamFlag = 0;
+    streamBody = 0;
+    wake = TraceHeader();
+}
+
+void InputTrace::putByte(uint8_t byte) {
+    buffer[length++] = byte;
+}
+
+void InputTrace::putVarint(uint64_t value) {
+    while (value >= 0x80) {
+        putByte(static_cast<uint8_t>(value) | 0x80);
+        value >>= 7;
+    }
+    putByte(static_cast<uint8_t>(value));
+}
+
+void InputTrace::putPaddedLength(size_t value) {
+    // Continuation bits on all but the last byte; the reader takes the extra zeros
+    uint8_t* out = buffer + streamBody;
+    for (size_t i = 0; i < STREAM_LENGTH_BYTES; i++) {
+        uint8_t bits = static_cast<uint8_t>((value >> (7 * i)) & 0x7F);
+        out[i] = i + 1 < STREAM_LENGTH_BYTES ? (bits | 0x80) : bits;
+    }
+}
+
+void InputTrace::putString(const char* text, size_t size) {
+    putVarint(size);
+    memcpy(buffer + length, text, size);
+    length += size;
+}
+
+/**
+ * Bounds-checked cursor over an encoded trace
+ */
+class TraceReader {
+public:
+    TraceReader(const uint8_t* data, size_t size) : data(data), size(size), position(0), failed(false) {}
+
+    bool atEnd() const { return position >= size; }
+    bool ok() const { return !failed; }
+
+    uint8_t byte() {
+        if (position >= size) {
+            failed = true;
+            return 0;
+        }
+        return data[position++];
+    }
+
+    uint64_t varint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8_t next = byte();
+            value |= static_cast<uint64_t>(next & 0x7F) << shift;
+            if (!(next & 0x80)) return value;
+        }
+        failed = true;
+        return 0;
+    }
+
+    std::string string() {
+        uint64_t length = varint();
+        if (failed || length > size - position) {
+            failed = true;
+            return std::string();
+        }
+        std::string text(reinterpret_cast<const char*>(data + position), static_cast<size_t>(length));
+        position += static_cast<size_t>(length);
+        return text;
+    }
+
+private:
+    const uint8_t* data;
+    size_t size;
+    size_t position;
+    bool failed;
+};
+
+bool InputTrace::parse(const uint8_t* data, size_t size, TraceHeader& header, std::vector<TraceEvent>& events) {
+    events.clear();
+    // Version 1 traces have no HTTP headers
+    if (!data || size < 7 || memcmp(data, MAGIC, sizeof(MAGIC)) != 0 || data[4] < 1 || data[4] > VERSION) {
+        return false;
+    }
+    uint8_t version = data[4];
+
+    TraceReader reader(data + 5, size - 5);
+    header.wakeCause = reader.byte();
+    uint8_t flags = reader.byte();
+    header.clockValid = (flags & FLAG_CLOCK_VALID) != 0;
+    header.truncated = (flags & FLAG_TRUNCATED) != 0;
+    header.bootEpochSeconds = reader.varint();
+    header.bootMs = static_cast<uint32_t>(reader.varint());
+
+    while (reader.ok() && !reader.atEnd()) {
+        TraceEvent event;
+        event.type = static_cast<TraceEventType>(reader.byte());
+        event.atMs = static_cast<uint32_t>(reader.varint());
+        switch (event.type) {
+            case TraceEventType::HTTP:
+                event.durationMs = static_cast<uint32_t>(reader.varint());
+                event.value = unzigzag(reader.varint());
+                event.bodyOmitted = reader.byte() != 0;
+                event.url = reader.string();
+                if (version >= 2) event.headers = reader.string();
+                event.body = reader.string();
+                break;
+            case TraceEventType::WIFI:
+                event.durationMs = static_cast<uint32_t>(reader.varint());
+                event.value = reader.byte();
+                break;
+            case TraceEventType::TIME_SYNC:
+                event.durationMs = static_cast<uint32_t>(reader.varint());
+                event.epochSeconds = reader.varint();
+                break;
+            case TraceEventType::BATTERY: {
+                uint32_t bits = 0;
+                for (int i = 0; i < 4; i++) bits |= static_cast<uint32_t>(reader.byte()) << (8 * i);
+                memcpy(&event.volts, &bits, sizeof(bits));
+                break;
+            }
+            case TraceEventType::BUTTON:
+                event.pin = reader.byte();
+                event.value = reader.byte();
+                break;
+            case TraceEventType::SLEEP:
+                event.durationMs = static_cast<uint32_t>(reader.varint());
+                break;
+            default:
+                return false;
+        }
+        if (reader.ok()) {
+            events.push_back(event);
+        }
+    }
+    return reader.ok();
+}
@@ -0,0 +1,129 @@
+#ifndef INPUT_TRACE_H
+#define INPUT_TRACE_H
+
+#include <Arduino.h>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <vector>
+
+/**
+ * Kinds of external input captured in a trace
+ */
+enum class TraceEventType : uint8_t {
+    HTTP = 1,       // One request: status, latency, headers read, body (unless omitted)
+    WIFI = 2,       // One association attempt: time taken, connected or not
+    TIME_SYNC = 3,  // One configTime() server attempt: time taken, epoch obtained
+    BATTERY = 4,    // One readBattery() value
+    BUTTON = 5,     // A wake button changed level
+    SLEEP = 6       // Entered deep sleep; durationMs is the armed timer
+};
+
+/**
+ * One recorded input. Fields not used by a type stay zero/empty.
+ */
+struct TraceEvent {
+    TraceEventType type = TraceEventType::HTTP;
+    uint32_t atMs = 0;            // millis() when the input was requested
+    uint32_t durationMs = 0;      // HTTP latency, association time, SNTP wait, sleep timer
+    int32_t value = 0;            // HTTP status, WiFi connected, button level
+    uint8_t pin = 0;              // BUTTON
+    uint64_t epochSeconds = 0;    // TIME_SYNC result (0: no answer)
+    float volts = 0.0f;           // BATTERY
+    bool bodyOmitted = false;     // HTTP: timing only (body not captured or over budget)
+    std::string url;
+    std::string headers;          // HTTP: "Name: value\n" for each response header the firmware read
+    std::string body;
+};
+
+/**
+ * State of the device when the traced wake started
+ */
+struct TraceHeader {
+    uint8_t wakeCause = 0;        // esp_sleep_wakeup_cause_t
+    bool clockValid = false;      // RTC held a synced wall clock at boot
+    bool truncated = false;       // Budget ran out; later inputs are missing
+    uint64_t bootEpochSeconds = 0;
+    uint32_t bootMs = 0;          // millis() when bootEpochSeconds was read
+};
+
+/**
+ * InputTrace records every external input of one wake so the host build
+ * can replay it deterministically (host/TraceReplay.h).
+ *
+ * The firmware reports inputs where it reads them: HTTP responses and their
+ * latency, WiFi association, SNTP results, battery readings, button edges and
+ * the wake cause. Recording is off unless Debug.RecordInputs is set; then
+ * events are appended to a PSRAM buffer of Debug.TraceBytes and written to
+ * /trace.bin in one flash write just before deep sleep (the previous trace
+ * moves to /trace.prev.bin). Bodies read as a stream are appended chunk by
+ * chunk with recordHttpBody(). Bodies that do not fit are dropped but their
+ * timing is kept; once even that does not fit the trace is marked truncated
+ * and saved right away, which is also how always-on units get a trace.
+ *
+ * Format: "ITRC", version, header, then events of
+ * type byte + varint atMs + type-specific fields (varints, length-prefixed
+ * strings). An HTTP record costs its URL, headers and body plus under 25
+ * bytes.
+ */
+class InputTrace {
+public:
+    static const char* TRACE_FILE;
+    static const char* PREVIOUS_TRACE_FILE;
+
+    // First thing in setup(); notes the wake cause and RTC time even when
+    // recording is started later (or never)
+    static void beginWake(uint8_t wakeCause);
+
+    // Start recording this wake into a buffer of maxBytes
+    static bool start(size_t maxBytes);
+    static bool isRecording() { return recording; }
+
+    static void recordHttp(unsigned long startMs, const String& url, int status, const String& body,
+                           const String& headers = String());
+    static void recordHttpTiming(unsigned long startMs, const char* url, int status);
+    // A response whose body is read as a stream: recordHttpStart() once the
+    // status is known, then recordHttpBody() with each chunk as it is read
+    static void recordHttpStart(unsigned long startMs, const char* url, int status, const String& headers);
+    static void recordHttpBody(const void* data, size_t size);
+    static void recordWiFi(unsigned long startMs, bool connected);
+    static void recordTimeSync(unsigned long startMs, time_t epochSeconds);
+    static void recordBattery(float volts);
+    static void recordButton(uint8_t pin, int level);
+
+    // Append the sleep record and write the trace to log storage
+    static bool finish(unsigned long sleepMs);
+
+    // Encoded bytes so far (header included)
+    static const uint8_t* data() { return buffer; }
+    static size_t size() { return length; }
+
+    // Decode a trace; returns false if it is not one or is corrupt
+    static bool parse(const uint8_t* data, size_t size, TraceHeader& header, std::vector<TraceEvent>& events);
+
+    // Drop the buffer and forget the wake (made public for testing)
+    static void reset();
+
+private:
+    static bool recording;
+    static bool truncated;
+    static uint8_t* buffer;
+    static size_t capacity;
+    static size_t length;
+    static TraceHeader wake;
+    static size_t streamFlag;           // Offset of the open HTTP record's bodyOmitted byte, 0 = none
+    static size_t streamBody;           // Offset of its body length
+
+    static bool append(const TraceEvent& event);
+    static size_t encodedSize(const TraceEvent& event);
+    static void encode(const TraceEvent& event);
+    static bool save();
+
+    static void putByte(uint8_t byte);
+    static void putVarint(uint64_t value);
+    static void putString(const char* text, size_t size);
+    static void putPaddedLength(size_t value);
+};
+
+#endif
@@ -6,6 +6,8 @@
 #include "../widgets/time/TimeWidget.h"
 #include "../widgets/weather/WeatherWidget.h"
 #include "../widgets/name/NameWidget.h"
+#include "../widgets/chart/ChartWidget.h"
+#include "../widgets/calendar/CalendarWidget.h"
 #include "../managers/ConfigManager.h"
 #include <vector>
 
@@ -27,7 +29,27 @@ public:
 };
 
 LayoutRegion::LayoutRegion(int x, int y, int w, int h)
-    : x(x), y(y), width(w), height(h), impl(new LayoutRegionImpl()), legacyWidget(nullptr), isDirty(true) {
+    : x(x), y(y), width(w), height(h), impl(new LayoutRegionImpl()), legacyWidget(nullptr), isDirty(true), staticContent(false) {
+}
+
+LayoutRegion::LayoutRegion(const LayoutRegion& other)
+    : x(other.x), y(other.y), width(other.width), height(other.height),
+      impl(new LayoutRegionImpl()), legacyWidget(other.legacyWidget), isDirty(other.isDirty),
+      staticContent(other.staticContent) {
+}
+
+LayoutRegion& LayoutRegion::operator=(const LayoutRegion& other) {
+    if (this != &other) {
+        x = other.x;
+        y = other.y;
+        width = other.width;
+        height = other.height;
+        legacyWidget = other.legacyWidget;
+        isDirty = other.isDirty;
+        staticContent = other.staticContent;
+        // Keep our own widget collection; the impl owns widgets and must not be shared
+    }
+    return *this;
 }
 
 LayoutRegion::~LayoutRegion() {
@@ -240,5 +262,24 @@ void LayoutRegion::createWidgetsFromConfig(const AppConfig& config, const String
         }
     }
 
+    // Create chart widgets assigned to this region
+    for (const auto& chartConfig : config.chartWidgets) {
+        if (chartConfig.region == regionId) {
+            ChartWidget* widget = new ChartWidget(display, chartConfig.hours, chartConfig.chartUpdateMs);
+            addWidget(widget);
+            LOG_DEBUG("LayoutRegion", "  Created ChartWidget for region '%s'", regionId.c_str());
+        }
+    }
+
+    // Create calendar widgets assigned to this region
+    for (const auto& calendarConfig : config.calendarWidgets) {
+        if (calendarConfig.region == regionId) {
+            CalendarWidget* widget = new CalendarWidget(display, calendarConfig.source, calendarConfig.events,
+                                                        calendarConfig.days, calendarConfig.calendarUpdateMs);
+            addWidget(widget);
+            LOG_DEBUG("LayoutRegion", "  Created CalendarWidget for region '%s'", regionId.c_str());
+        }
+    }
+
     LOG_INFO("LayoutRegion", "Region '%s': Created %d widgets", regionId.c_str(), getWidgetCount());
 }
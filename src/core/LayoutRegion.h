@@ -18,6 +18,10 @@ public:
     // Constructor
     LayoutRegion(int x = 0, int y = 0, int w = 0, int h = 0);
 
+    // Copies carry geometry, dirty and static state only; widgets stay with the original
+    LayoutRegion(const LayoutRegion& other);
+    LayoutRegion& operator=(const LayoutRegion& other);
+
     // Destructor
     ~LayoutRegion();
 
@@ -60,6 +64,10 @@ public:
     void markClean();
     bool needsUpdate() const;
 
+    // Static regions are drawn once into the static layer (StaticLayer)
+    void setStatic(bool isStatic) { staticContent = isStatic; }
+    bool isStatic() const { return staticContent; }
+
     // Geometry helper methods
     bool contains(int pointX, int pointY) const;
     bool intersects(const LayoutRegion& other) const;
@@ -78,6 +86,7 @@ private:
     LayoutRegionImpl* impl; // PIMPL to hide widget collection implementation
     Widget* legacyWidget; // For backward compatibility
     bool isDirty;
+    bool staticContent;
 };
 
 #endif
@@ -1,17 +1,114 @@
 #include "Logger.h"
+#include "MemoryTracker.h"
+#include <algorithm>
+#include <cstring>
+#include <strings.h>
 
 LogLevel Logger::currentLogLevel = LogLevel::INFO;
+LogLevel Logger::lowestLevel = LogLevel::INFO;
+Logger::TagLevel Logger::tagLevels[Logger::MAX_TAG_LEVELS];
+size_t Logger::tagLevelCount = 0;
 
 void Logger::setLogLevel(LogLevel level) {
     currentLogLevel = level;
+    updateLowestLevel();
 }
 
 LogLevel Logger::getLogLevel() {
     return currentLogLevel;
 }
 
+bool Logger::setTagLevel(const char* tag, LogLevel level) {
+    if (!tag || !*tag || strlen(tag) >= MAX_TAG_LENGTH) return false;
+
+    for (size_t i = 0; i < tagLevelCount; i++) {
+        if (strcmp(tagLevels[i].tag, tag) == 0) {
+            tagLevels[i].level = level;
+            updateLowestLevel();
+            return true;
+        }
+    }
+
+    if (tagLevelCount >= MAX_TAG_LEVELS) return false;
+    strncpy(tagLevels[tagLevelCount].tag, tag, MAX_TAG_LENGTH);
+    tagLevels[tagLevelCount].level = level;
+    tagLevelCount++;
+    updateLowestLevel();
+    return true;
+}
+
+void Logger::clearTagLevel(const char* tag) {
+    for (size_t i = 0; i < tagLevelCount; i++) {
+        if (strcmp(tagLevels[i].tag, tag) == 0) {
+            tagLevels[i] = tagLevels[--tagLevelCount];
+            break;
+        }
+    }
+    updateLowestLevel();
+}
+
+void Logger::clearTagLevels() {
+    tagLevelCount = 0;
+    updateLowestLevel();
+}
+
+const char* Logger::getTagName(size_t index) {
+    return index < tagLevelCount ? tagLevels[index].tag : "";
+}
+
+LogLevel Logger::getTagLevel(size_t index) {
+    return index < tagLevelCount ? tagLevels[index].level : currentLogLevel;
+}
+
+LogLevel Logger::getEffectiveLevel(const char* tag) {
+    for (size_t i = 0; i < tagLevelCount; i++) {
+        if (strcmp(tagLevels[i].tag, tag) == 0) {
+            return tagLevels[i].level;
+        }
+    }
+    return currentLogLevel;
+}
+
+bool Logger::isEnabled(LogLevel level, const char* tag) {
+    // Common case: no override is more verbose than this message
+    if (level < lowestLevel) return false;
+    if (tagLevelCount == 0) return level >= currentLogLevel;
+    return level >= getEffectiveLevel(tag);
+}
+
+const char* Logger::getLevelName(LogLevel level) {
+    switch (level) {
+        case LogLevel::DEBUG: return "debug";
+        case LogLevel::INFO:  return "info";
+        case LogLevel::WARN:  return "warn";
+        case LogLevel::ERROR: return "error";
+        case LogLevel::FATAL: return "fatal";
+        default: return "unknown";
+    }
+}
+
+bool Logger::parseLevel(const char* text, LogLevel& level) {
+    static const LogLevel levels[] = {LogLevel::DEBUG, LogLevel::INFO, LogLevel::WARN, LogLevel::ERROR, LogLevel::FATAL};
+    for (LogLevel candidate : levels) {
+        if (strcasecmp(text, getLevelName(candidate)) == 0) {
+            level = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+void Logger::updateLowestLevel() {
+    lowestLevel = currentLogLevel;
+    for (size_t i = 0; i < tagLevelCount; i++) {
+        if (tagLevels[i].level < lowestLevel) {
+            lowestLevel = tagLevels[i].level;
+        }
+    }
+}
+
 void Logger::debug(const char* className, const char* message, ...) {
-    if (currentLogLevel <= LogLevel::DEBUG) {
+    if (isEnabled(LogLevel::DEBUG, className)) {
         va_list args;
         va_start(args, message);
         log(LogLevel::DEBUG, className, message, args);
@@ -20,7 +117,7 @@ void Logger::debug(const char* className, const char* message, ...) {
 }
 
 void Logger::info(const char* className, const char* message, ...) {
-    if (currentLogLevel <= LogLevel::INFO) {
+    if (isEnabled(LogLevel::INFO, className)) {
         va_list args;
         va_start(args, message);
         log(LogLevel::INFO, className, message, args);
@@ -29,7 +126,7 @@ void Logger::info(const char* className, const char* message, ...) {
 }
 
 void Logger::warn(const char* className, const char* message, ...) {
-    if (currentLogLevel <= LogLevel::WARN) {
+    if (isEnabled(LogLevel::WARN, className)) {
         va_list args;
         va_start(args, message);
         log(LogLevel::WARN, className, message, args);
@@ -38,7 +135,7 @@ void Logger::warn(const char* className, const char* message, ...) {
 }
 
 void Logger::error(const char* className, const char* message, ...) {
-    if (currentLogLevel <= LogLevel::ERROR) {
+    if (isEnabled(LogLevel::ERROR, className)) {
         va_list args;
         va_start(args, message);
         log(LogLevel::ERROR, className, message, args);
@@ -47,7 +144,7 @@ void Logger::error(const char* className, const char* message, ...) {
 }
 
 void Logger::fatal(const char* className, const char* message, ...) {
-    if (currentLogLevel <= LogLevel::FATAL) {
+    if (isEnabled(LogLevel::FATAL, className)) {
         va_list args;
         va_start(args, message);
         log(LogLevel::FATAL, className, message, args);
@@ -57,16 +154,20 @@ void Logger::fatal(const char* className, const char* message, ...) {
 
 void Logger::log(LogLevel level, const char* className, const char* message, va_list args) {
     // Format: [TIMESTAMP] [LEVEL] [CLASS] MESSAGE
-    String timestamp = getTimestamp();
+    char timestamp[16];
+    formatTimestamp(timestamp, sizeof(timestamp));
     const char* levelStr = getLevelString(level);
 
     // Print prefix
-    Serial.printf("[%s] [%s] [%s] ", timestamp.c_str(), levelStr, className);
+    Serial.printf("[%s] [%s] [%s] ", timestamp, levelStr, className);
 
     // Print formatted message
     char buffer[512];
-    vsnprintf(buffer, sizeof(buffer), message, args);
+    int length = vsnprintf(buffer, sizeof(buffer), message, args);
     Serial.println(buffer);
+    if (length > 0) {
+        MemoryTracker::recordLogLine(std::min(static_cast<size_t>(length), sizeof(buffer) - 1));
+    }
 }
 
 const char* Logger::getLevelString(LogLevel level) {
@@ -80,7 +181,7 @@ const char* Logger::getLevelString(LogLevel level) {
     }
 }
 
-String Logger::getTimestamp() {
+void Logger::formatTimestamp(char* buffer, size_t size) {
     unsigned long currentMillis = millis();
     unsigned long seconds = currentMillis / 1000;
     unsigned long milliseconds = currentMillis % 1000;
@@ -89,9 +190,6 @@ String Logger::getTimestamp() {
     unsigned long minutes = (seconds % 3600) / 60;
     seconds = seconds % 60;
 
-    char timestamp[16];
-    snprintf(timestamp, sizeof(timestamp), "%02lu:%02lu:%02lu.%03lu",
+    snprintf(buffer, size, "%02lu:%02lu:%02lu.%03lu",
              hours, minutes, seconds, milliseconds);
-
-    return String(timestamp);
 }
@@ -14,9 +14,28 @@ enum class LogLevel {
 
 class Logger {
 public:
+    static const size_t MAX_TAG_LEVELS = 8;
+    static const size_t MAX_TAG_LENGTH = 24;
+
     static void setLogLevel(LogLevel level);
     static LogLevel getLogLevel();
 
+    // Per-tag overrides of the global level (the tag is the className argument)
+    static bool setTagLevel(const char* tag, LogLevel level);
+    static void clearTagLevel(const char* tag);
+    static void clearTagLevels();
+    static size_t getTagLevelCount() { return tagLevelCount; }
+    static const char* getTagName(size_t index);
+    static LogLevel getTagLevel(size_t index);
+
+    // Level in effect for a tag, and whether a message would be printed
+    static LogLevel getEffectiveLevel(const char* tag);
+    static bool isEnabled(LogLevel level, const char* tag);
+
+    // "debug", "info", ... (console and config spelling)
+    static const char* getLevelName(LogLevel level);
+    static bool parseLevel(const char* text, LogLevel& level);
+
     // Main logging methods
     static void debug(const char* className, const char* message, ...);
     static void info(const char* className, const char* message, ...);
@@ -32,10 +51,20 @@ public:
     #define LOG_FATAL(className, ...) Logger::fatal(className, __VA_ARGS__)
 
 private:
+    struct TagLevel {
+        char tag[MAX_TAG_LENGTH];
+        LogLevel level;
+    };
+
     static LogLevel currentLogLevel;
+    static LogLevel lowestLevel;    // Most verbose of the global and tag levels
+    static TagLevel tagLevels[MAX_TAG_LEVELS];
+    static size_t tagLevelCount;
+
+    static void updateLowestLevel();
     static void log(LogLevel level, const char* className, const char* message, va_list args);
     static const char* getLevelString(LogLevel level);
-    static String getTimestamp();
+    static void formatTimestamp(char* buffer, size_t size);
 };
 
 #endif // LOGGER_H
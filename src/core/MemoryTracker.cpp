@@ -0,0 +1,227 @@
+#include "MemoryTracker.h"
+#include "Logger.h"
+#include <esp_heap_caps.h>
+
+bool MemoryTracker::enabled = false;
+bool MemoryTracker::steadyStateAssert = false;
+bool MemoryTracker::inSteadyState = false;
+size_t MemoryTracker::steadyStartBytes = 0;
+size_t MemoryTracker::steadyStartBlocks = 0;
+unsigned long MemoryTracker::steadyStateViolations = 0;
+unsigned long MemoryTracker::logLines = 0;
+unsigned long MemoryTracker::logBytes = 0;
+MemoryTracker::Scope* MemoryTracker::activeScope = nullptr;
+SubsystemMemoryStats MemoryTracker::stats[static_cast<int>(MemorySubsystem::COUNT)] = {};
+
+// Requests at least this large are steered to PSRAM when asked to, keeping the
+// internal heap free of long-lived multi-kilobyte blocks that fragment it
+static const size_t PSRAM_PREFERENCE_THRESHOLD = 16 * 1024;
+
+void MemoryTracker::setEnabled(bool enable) {
+    enabled = enable;
+    LOG_INFO("MemoryTracker", "Scope tracking %s", enable ? "enabled" : "disabled");
+}
+
+void* MemoryTracker::allocate(MemorySubsystem subsystem, size_t bytes, bool preferPsram) {
+    void* ptr = nullptr;
+
+    if (preferPsram && bytes >= PSRAM_PREFERENCE_THRESHOLD) {
+        ptr = heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    }
+
+    if (!ptr) {
+        ptr = heap_caps_malloc(bytes, MALLOC_CAP_8BIT);
+    }
+
+    if (!ptr) {
+        HeapSnapshot snapshot = takeSnapshot();
+        LOG_ERROR("MemoryTracker", "%s: failed to allocate %zu bytes (largest free: internal %zu, PSRAM %zu, fragmentation %.0f%%)",
+                  getSubsystemName(subsystem), bytes, snapshot.largestFreeInternal,
+                  snapshot.largestFreePsram, snapshot.fragmentation * 100.0f);
+        return nullptr;
+    }
+
+    recordAllocation(subsystem, bytes);
+    return ptr;
+}
+
+void MemoryTracker::release(MemorySubsystem subsystem, void* ptr, size_t bytes) {
+    if (!ptr) return;
+
+    heap_caps_free(ptr);
+    recordFree(subsystem, bytes);
+}
+
+void MemoryTracker::recordAllocation(MemorySubsystem subsystem, size_t bytes, unsigned long count) {
+    SubsystemMemoryStats& s = stats[static_cast<int>(subsystem)];
+    s.currentBytes += bytes;
+    s.allocationCount += count;
+    if (s.currentBytes > s.peakBytes) {
+        s.peakBytes = s.currentBytes;
+    }
+}
+
+void MemoryTracker::recordFree(MemorySubsystem subsystem, size_t bytes, unsigned long count) {
+    SubsystemMemoryStats& s = stats[static_cast<int>(subsystem)];
+    s.currentBytes = bytes > s.currentBytes ? 0 : s.currentBytes - bytes;
+    s.freeCount += count;
+}
+
+SubsystemMemoryStats MemoryTracker::getStats(MemorySubsystem subsystem) {
+    return stats[static_cast<int>(subsystem)];
+}
+
+HeapSnapshot MemoryTracker::takeSnapshot() {
+    HeapSnapshot snapshot;
+    snapshot.freeInternal = heap_caps_get_free_size(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    snapshot.largestFreeInternal = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    snapshot.minimumFreeInternal = heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    snapshot.freePsram = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+    snapshot.largestFreePsram = heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM);
+    readHeapTotals(snapshot.totalAllocatedBytes, snapshot.allocatedBlocks);
+
+    snapshot.fragmentation = 0.0f;
+    if (snapshot.freeInternal > 0) {
+        snapshot.fragmentation = 1.0f - static_cast<float>(snapshot.largestFreeInternal) / snapshot.freeInternal;
+    }
+    return snapshot;
+}
+
+const char* MemoryTracker::getSubsystemName(MemorySubsystem subsystem) {
+    switch (subsystem) {
+        case MemorySubsystem::COMPOSITOR:   return "compositor";
+        case MemorySubsystem::IMAGE_DECODE: return "image";
+        case MemorySubsystem::JSON:         return "json";
+        case MemorySubsystem::NETWORK:      return "network";
+        case MemorySubsystem::WIDGETS:      return "widgets";
+        case MemorySubsystem::LOGGING:      return "logging";
+        default: return "unknown";
+    }
+}
+
+void MemoryTracker::resetPeaks() {
+    for (int i = 0; i < static_cast<int>(MemorySubsystem::COUNT); i++) {
+        stats[i].peakBytes = stats[i].currentBytes;
+    }
+}
+
+void MemoryTracker::logReport(const char* reason) {
+    HeapSnapshot snapshot = takeSnapshot();
+
+    LOG_INFO("MemoryTracker", "Heap report (%s): internal free %zu, largest %zu, min %zu, fragmentation %.0f%%",
+             reason, snapshot.freeInternal, snapshot.largestFreeInternal,
+             snapshot.minimumFreeInternal, snapshot.fragmentation * 100.0f);
+    LOG_INFO("MemoryTracker", "  PSRAM free %zu, largest %zu; %zu blocks / %zu bytes allocated",
+             snapshot.freePsram, snapshot.largestFreePsram,
+             snapshot.allocatedBlocks, snapshot.totalAllocatedBytes);
+
+    for (int i = 0; i < static_cast<int>(MemorySubsystem::COUNT); i++) {
+        const SubsystemMemoryStats& s = stats[i];
+        if (s.allocationCount == 0 && s.peakBytes == 0) continue;
+        LOG_INFO("MemoryTracker", "  %-10s current %zu, peak %zu, allocs %lu, frees %lu",
+                 getSubsystemName(static_cast<MemorySubsystem>(i)),
+                 s.currentBytes, s.peakBytes, s.allocationCount, s.freeCount);
+    }
+
+    LOG_INFO("MemoryTracker", "  %lu log lines, %lu bytes formatted", logLines, logBytes);
+
+    if (steadyStateViolations > 0) {
+        LOG_WARN("MemoryTracker", "  Steady-state violations: %lu", steadyStateViolations);
+    }
+}
+
+void MemoryTracker::beginSteadyState() {
+    if (!steadyStateAssert) return;
+
+    readHeapTotals(steadyStartBytes, steadyStartBlocks);
+    inSteadyState = true;
+}
+
+bool MemoryTracker::endSteadyState(const char* label) {
+    if (!steadyStateAssert || !inSteadyState) return true;
+    inSteadyState = false;
+
+    size_t endBytes, endBlocks;
+    readHeapTotals(endBytes, endBlocks);
+
+    if (endBlocks > steadyStartBlocks || endBytes > steadyStartBytes) {
+        steadyStateViolations++;
+        LOG_FATAL("MemoryTracker", "Steady-state violation in %s: +%ld blocks, +%ld bytes",
+                  label,
+                  static_cast<long>(endBlocks) - static_cast<long>(steadyStartBlocks),
+                  static_cast<long>(endBytes) - static_cast<long>(steadyStartBytes));
+        return false;
+    }
+    return true;
+}
+
+void MemoryTracker::readHeapTotals(size_t& allocatedBytes, size_t& allocatedBlocks) {
+    multi_heap_info_t info;
+    heap_caps_get_info(&info, MALLOC_CAP_8BIT);
+    allocatedBytes = info.total_allocated_bytes;
+    allocatedBlocks = info.allocated_blocks;
+}
+
+MemoryTracker::Scope::Scope(MemorySubsystem subsystem)
+    : subsystem(subsystem), parent(nullptr), active(MemoryTracker::enabled),
+      startBytes(0), startBlocks(0), childBytes(0), childBlocks(0),
+      peakOwnBytes(0), peakOwnBlocks(0) {
+    if (!active) return;
+
+    parent = MemoryTracker::activeScope;
+    MemoryTracker::activeScope = this;
+    MemoryTracker::readHeapTotals(startBytes, startBlocks);
+}
+
+void MemoryTracker::Scope::measure(long& ownBytes, long& ownBlocks, long& totalBytes, long& totalBlocks) const {
+    size_t endBytes, endBlocks;
+    MemoryTracker::readHeapTotals(endBytes, endBlocks);
+
+    totalBytes = static_cast<long>(endBytes) - static_cast<long>(startBytes);
+    totalBlocks = static_cast<long>(endBlocks) - static_cast<long>(startBlocks);
+
+    // Only attribute what nested scopes did not already claim
+    ownBytes = totalBytes - childBytes;
+    ownBlocks = totalBlocks - childBlocks;
+}
+
+void MemoryTracker::Scope::checkpoint() {
+    if (!active) return;
+
+    long ownBytes, ownBlocks, totalBytes, totalBlocks;
+    measure(ownBytes, ownBlocks, totalBytes, totalBlocks);
+
+    if (ownBytes > peakOwnBytes) peakOwnBytes = ownBytes;
+    if (ownBlocks > peakOwnBlocks) peakOwnBlocks = ownBlocks;
+}
+
+MemoryTracker::Scope::~Scope() {
+    if (!active) return;
+
+    long ownBytes, ownBlocks, totalBytes, totalBlocks;
+    measure(ownBytes, ownBlocks, totalBytes, totalBlocks);
+
+    SubsystemMemoryStats& s = MemoryTracker::stats[static_cast<int>(subsystem)];
+
+    // Transient usage seen at a checkpoint counts towards the peak even if freed since
+    if (peakOwnBytes > 0 && s.currentBytes + peakOwnBytes > s.peakBytes) {
+        s.peakBytes = s.currentBytes + peakOwnBytes;
+    }
+
+    long allocatedBlocks = ownBlocks > peakOwnBlocks ? ownBlocks : peakOwnBlocks;
+
+    if (ownBytes > 0) {
+        MemoryTracker::recordAllocation(subsystem, ownBytes, allocatedBlocks > 0 ? allocatedBlocks : 0);
+    } else {
+        s.allocationCount += allocatedBlocks > 0 ? allocatedBlocks : 0;
+        if (ownBytes < 0) {
+            MemoryTracker::recordFree(subsystem, -ownBytes, ownBlocks < 0 ? -ownBlocks : 0);
+        }
+    }
+
+    MemoryTracker::activeScope = parent;
+    if (parent) {
+        parent->childBytes += totalBytes;
+        parent->childBlocks += totalBlocks;
+    }
+}
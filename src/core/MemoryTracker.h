@@ -0,0 +1,130 @@
+#ifndef MEMORY_TRACKER_H
+#define MEMORY_TRACKER_H
+
+#include <cstddef>
+
+/**
+ * Subsystems that heap usage is attributed to
+ */
+enum class MemorySubsystem {
+    COMPOSITOR = 0,
+    IMAGE_DECODE,
+    JSON,
+    NETWORK,
+    WIDGETS,
+    LOGGING,
+    COUNT
+};
+
+/**
+ * Per-subsystem allocation accounting
+ */
+struct SubsystemMemoryStats {
+    size_t currentBytes;
+    size_t peakBytes;
+    unsigned long allocationCount;
+    unsigned long freeCount;
+};
+
+/**
+ * Point-in-time view of the heap (internal RAM and PSRAM)
+ */
+struct HeapSnapshot {
+    size_t freeInternal;
+    size_t largestFreeInternal;
+    size_t minimumFreeInternal;   // Low-water mark since boot
+    size_t freePsram;
+    size_t largestFreePsram;
+    size_t allocatedBlocks;
+    size_t totalAllocatedBytes;
+    float fragmentation;          // 1 - largest/free for internal RAM (0 = none)
+};
+
+/**
+ * MemoryTracker attributes heap usage to subsystems and tracks high-water marks.
+ *
+ * Owned buffers (compositor surface) are accounted exactly through allocate()/release().
+ * Library-driven allocations (JSON documents, HTTP clients, image decoding) are
+ * attributed by wrapping the work in a MemoryTracker::Scope, which records the
+ * net change in allocated bytes and blocks. Scopes are no-ops unless tracking
+ * is enabled, since sampling the heap walks its block list.
+ *
+ * Steady-state mode checks that a section of the wake cycle (e.g. an idle loop()
+ * iteration) leaves no net allocations behind.
+ */
+class MemoryTracker {
+public:
+    class Scope {
+    public:
+        explicit Scope(MemorySubsystem subsystem);
+        ~Scope();
+
+        // Sample the heap while transient buffers are alive so they show up in peaks
+        void checkpoint();
+
+    private:
+        MemorySubsystem subsystem;
+        Scope* parent;
+        bool active;
+        size_t startBytes;
+        size_t startBlocks;
+        long childBytes;   // Net bytes already attributed by nested scopes
+        long childBlocks;
+        long peakOwnBytes;
+        long peakOwnBlocks;
+
+        void measure(long& ownBytes, long& ownBlocks, long& totalBytes, long& totalBlocks) const;
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+    // Scope-based tracking (owned-buffer accounting is always on)
+    static void setEnabled(bool enabled);
+    static bool isEnabled() { return enabled; }
+
+    // Tagged allocation for large owned buffers; large requests prefer PSRAM
+    static void* allocate(MemorySubsystem subsystem, size_t bytes, bool preferPsram = false);
+    static void release(MemorySubsystem subsystem, void* ptr, size_t bytes);
+
+    // Manual accounting for allocations made elsewhere
+    static void recordAllocation(MemorySubsystem subsystem, size_t bytes, unsigned long count = 1);
+    static void recordFree(MemorySubsystem subsystem, size_t bytes, unsigned long count = 1);
+
+    // Log lines are counted, not scoped: a heap walk per line would cost more
+    // than the line and skew the timing being measured
+    static void recordLogLine(size_t bytes) { logLines++; logBytes += bytes; }
+    static unsigned long getLogLines() { return logLines; }
+    static unsigned long getLogBytes() { return logBytes; }
+
+    // Statistics
+    static SubsystemMemoryStats getStats(MemorySubsystem subsystem);
+    static HeapSnapshot takeSnapshot();
+    static const char* getSubsystemName(MemorySubsystem subsystem);
+    static void resetPeaks();
+    static void logReport(const char* reason);
+
+    // Steady-state assertion mode
+    static void setSteadyStateAssert(bool enabled) { steadyStateAssert = enabled; }
+    static bool isSteadyStateAssertEnabled() { return steadyStateAssert; }
+    static void beginSteadyState();
+    static bool endSteadyState(const char* label);
+    static void cancelSteadyState() { inSteadyState = false; }  // The iteration did work, don't check it
+    static unsigned long getSteadyStateViolations() { return steadyStateViolations; }
+
+private:
+    static bool enabled;
+    static bool steadyStateAssert;
+    static bool inSteadyState;
+    static size_t steadyStartBytes;
+    static size_t steadyStartBlocks;
+    static unsigned long steadyStateViolations;
+    static unsigned long logLines;
+    static unsigned long logBytes;
+    static Scope* activeScope;
+    static SubsystemMemoryStats stats[static_cast<int>(MemorySubsystem::COUNT)];
+
+    static void readHeapTotals(size_t& allocatedBytes, size_t& allocatedBlocks);
+};
+
+#endif
@@ -0,0 +1,219 @@
+#include "PanelFrame.h"
+#include <algorithm>
+#include <cstring>
+
+static const char FRAME_MAGIC[4] = {'I', 'P', 'F', '1'};
+
+static uint16_t getU16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+static uint32_t getU32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+static void putU16(std::vector<uint8_t>& out, size_t at, uint16_t value) {
+    out[at] = value & 0xff;
+    out[at + 1] = value >> 8;
+}
+
+static void putU32(std::vector<uint8_t>& out, size_t at, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out[at + i] = (value >> (8 * i)) & 0xff;
+    }
+}
+
+size_t PanelFrame::bufferSize(uint8_t mode, int width, int height) {
+    return static_cast<size_t>(width) * bitsPerPixel(mode) / 8 * height;
+}
+
+bool PanelFrame::isAligned(uint8_t mode, int x, int width) {
+    int bits = bitsPerPixel(mode);
+    return (x * bits) % 8 == 0 && (width * bits) % 8 == 0;
+}
+
+bool PanelFrame::parse(const uint8_t* frameData, size_t frameSize) {
+    data = nullptr;
+    size = 0;
+    rects.clear();
+
+    if (frameSize < HEADER_SIZE || memcmp(frameData, FRAME_MAGIC, sizeof(FRAME_MAGIC)) != 0 ||
+        frameData[4] != VERSION) {
+        return false;
+    }
+
+    header.mode = frameData[5];
+    header.flags = frameData[6];
+    size_t count = frameData[7];
+    header.width = getU16(frameData + 8);
+    header.height = getU16(frameData + 10);
+    header.frameId = getU32(frameData + 12);
+    header.baseId = getU32(frameData + 16);
+    header.sleepSeconds = getU32(frameData + 20);
+
+    if (header.mode > 1 || header.width == 0 || header.height == 0 || count > MAX_RECTS ||
+        !isAligned(header.mode, 0, header.width)) {
+        return false;
+    }
+    // Partial updates only exist in 1-bit mode
+    if (isDelta() && header.mode != 0) return false;
+
+    size_t offset = HEADER_SIZE + count * RECT_SIZE;
+    if (frameSize < offset) return false;
+
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t* entry = frameData + HEADER_SIZE + i * RECT_SIZE;
+        PanelFrameRect rect;
+        rect.x = getU16(entry);
+        rect.y = getU16(entry + 2);
+        rect.width = getU16(entry + 4);
+        rect.height = getU16(entry + 6);
+        rect.dataLength = getU32(entry + 8);
+        rect.previousLength = getU32(entry + 12);
+
+        if (rect.width == 0 || rect.height == 0 || rect.x + rect.width > header.width ||
+            rect.y + rect.height > header.height || !isAligned(header.mode, rect.x, rect.width)) {
+            return false;
+        }
+        if (!isDelta() && rect.previousLength != 0) return false;
+
+        if (rect.dataLength > frameSize - offset) return false;
+        rect.dataOffset = static_cast<uint32_t>(offset);
+        offset += rect.dataLength;
+        if (rect.previousLength > frameSize - offset) return false;
+        rect.previousOffset = static_cast<uint32_t>(offset);
+        offset += rect.previousLength;
+
+        rects.push_back(rect);
+    }
+    if (offset != frameSize) return false;
+
+    data = frameData;
+    size = frameSize;
+    return true;
+}
+
+bool PanelFrame::unpack(size_t index, bool previous, uint8_t* buffer) const {
+    if (!data || index >= rects.size() || (previous && !isDelta())) return false;
+
+    const PanelFrameRect& rect = rects[index];
+    return previous ? unpackRows(rect, data + rect.previousOffset, rect.previousLength, buffer)
+                    : unpackRows(rect, data + rect.dataOffset, rect.dataLength, buffer);
+}
+
+bool PanelFrame::unpackRows(const PanelFrameRect& rect, const uint8_t* packed, size_t length,
+                            uint8_t* buffer) const {
+    int bits = bitsPerPixel(header.mode);
+    size_t stride = static_cast<size_t>(header.width) * bits / 8;
+    size_t rowBytes = static_cast<size_t>(rect.width) * bits / 8;
+    size_t left = static_cast<size_t>(rect.x) * bits / 8;
+    size_t total = rowBytes * rect.height;
+
+    // PackBits straight into the panel buffer, splitting runs at row ends
+    size_t at = 0;
+    size_t pos = 0;
+    while (at < length) {
+        int8_t control = static_cast<int8_t>(packed[at++]);
+        if (control == -128) continue;
+
+        size_t count = control >= 0 ? static_cast<size_t>(control) + 1 : static_cast<size_t>(1 - control);
+        const uint8_t* literal = control >= 0 ? packed + at : nullptr;
+        size_t consumed = control >= 0 ? count : 1;
+        if (consumed > length - at || count > total - pos) return false;
+        uint8_t value = packed[at];
+        at += consumed;
+
+        while (count > 0) {
+            size_t column = pos % rowBytes;
+            size_t chunk = std::min(count, rowBytes - column);
+            uint8_t* dest = buffer + (rect.y + pos / rowBytes) * stride + left + column;
+            if (literal) {
+                memcpy(dest, literal, chunk);
+                literal += chunk;
+            } else {
+                memset(dest, value, chunk);
+            }
+            pos += chunk;
+            count -= chunk;
+        }
+    }
+    return pos == total;
+}
+
+void PanelFrame::packBits(const uint8_t* input, size_t length, std::vector<uint8_t>& out) {
+    size_t i = 0;
+    while (i < length) {
+        size_t run = 1;
+        while (i + run < length && run < 128 && input[i + run] == input[i]) run++;
+        if (run >= 3) {
+            out.push_back(static_cast<uint8_t>(257 - run));
+            out.push_back(input[i]);
+            i += run;
+            continue;
+        }
+
+        // Literals up to the next run of three or more
+        size_t start = i;
+        while (i < length && i - start < 128) {
+            if (i + 2 < length && input[i] == input[i + 1] && input[i] == input[i + 2]) break;
+            i++;
+        }
+        out.push_back(static_cast<uint8_t>(i - start - 1));
+        out.insert(out.end(), input + start, input + i);
+    }
+}
+
+bool PanelFrame::encode(const PanelFrameHeader& frameHeader, const std::vector<PanelFrameRect>& frameRects,
+                        const uint8_t* image, const uint8_t* previous, std::vector<uint8_t>& out) {
+    bool delta = previous != nullptr;
+    if (frameHeader.mode > 1 || frameRects.size() > MAX_RECTS || (delta && frameHeader.mode != 0) ||
+        !isAligned(frameHeader.mode, 0, frameHeader.width)) {
+        return false;
+    }
+
+    out.assign(HEADER_SIZE + frameRects.size() * RECT_SIZE, 0);
+    memcpy(out.data(), FRAME_MAGIC, sizeof(FRAME_MAGIC));
+    out[4] = VERSION;
+    out[5] = frameHeader.mode;
+    out[6] = static_cast<uint8_t>(delta ? (frameHeader.flags | FLAG_DELTA) : (frameHeader.flags & ~FLAG_DELTA));
+    out[7] = static_cast<uint8_t>(frameRects.size());
+    putU16(out, 8, frameHeader.width);
+    putU16(out, 10, frameHeader.height);
+    putU32(out, 12, frameHeader.frameId);
+    putU32(out, 16, delta ? frameHeader.baseId : 0);
+    putU32(out, 20, frameHeader.sleepSeconds);
+
+    int bits = bitsPerPixel(frameHeader.mode);
+    size_t stride = static_cast<size_t>(frameHeader.width) * bits / 8;
+    std::vector<uint8_t> rows;
+
+    for (size_t i = 0; i < frameRects.size(); i++) {
+        const PanelFrameRect& rect = frameRects[i];
+        if (rect.width == 0 || rect.height == 0 || rect.x + rect.width > frameHeader.width ||
+            rect.y + rect.height > frameHeader.height || !isAligned(frameHeader.mode, rect.x, rect.width)) {
+            return false;
+        }
+
+        size_t rowBytes = static_cast<size_t>(rect.width) * bits / 8;
+        size_t left = static_cast<size_t>(rect.x) * bits / 8;
+        size_t entry = HEADER_SIZE + i * RECT_SIZE;
+        putU16(out, entry, rect.x);
+        putU16(out, entry + 2, rect.y);
+        putU16(out, entry + 4, rect.width);
+        putU16(out, entry + 6, rect.height);
+
+        const uint8_t* sources[2] = {image, previous};
+        for (int source = 0; source < (delta ? 2 : 1); source++) {
+            rows.clear();
+            for (int y = rect.y; y < rect.y + rect.height; y++) {
+                const uint8_t* row = sources[source] + y * stride + left;
+                rows.insert(rows.end(), row, row + rowBytes);
+            }
+            size_t before = out.size();
+            packBits(rows.data(), rows.size(), out);
+            putU32(out, entry + 8 + source * 4, static_cast<uint32_t>(out.size() - before));
+        }
+    }
+    return true;
+}
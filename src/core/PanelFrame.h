@@ -0,0 +1,96 @@
+#ifndef PANEL_FRAME_H
+#define PANEL_FRAME_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Frame header fields (little-endian on the wire)
+ */
+struct PanelFrameHeader {
+    uint8_t mode;               // INKPLATE_1BIT (0) or INKPLATE_3BIT (1)
+    uint8_t flags;              // PanelFrame::FLAG_*
+    uint16_t width;
+    uint16_t height;
+    uint32_t frameId;           // Server's id for the composed image; 0 is never used
+    uint32_t baseId;            // Delta frames: the frame the rects apply on top of
+    uint32_t sleepSeconds;      // Until the next request; 0 = use the configured interval
+};
+
+/**
+ * One dirty rectangle and where its compressed rows are in the frame
+ */
+struct PanelFrameRect {
+    uint16_t x;
+    uint16_t y;
+    uint16_t width;
+    uint16_t height;
+    uint32_t dataOffset;
+    uint32_t dataLength;
+    uint32_t previousOffset;    // Delta frames: what the panel shows there now
+    uint32_t previousLength;
+};
+
+/**
+ * A pre-composed panel image from the frame server, in the driver's own
+ * buffer layout so it can be presented without any widget or compositor
+ * work.
+ *
+ * Layout: a 24-byte header ("IPF1", version, mode, flags, rect count,
+ * width, height, frame id, base id, sleep seconds), a 16-byte entry per
+ * rect (x, y, width, height, data length, previous length), then each
+ * rect's rows compressed with PackBits, followed by its previous rows for
+ * delta frames.
+ *
+ * Rows are packed like the driver's buffers: 1-bit frames use 8 pixels per
+ * byte, leftmost pixel in the least significant bit (pixelMaskLUT), 1 =
+ * black (_partial); 3-bit frames use 2 pixels per byte, high nibble first,
+ * 0 = black and 7 = white (DMemory4Bit). Rects start and end on byte boundaries so rows can be
+ * copied straight into those buffers.
+ *
+ * A full frame covers everything that is not white. A delta frame (1-bit
+ * only) carries just the rects that changed since baseId, plus what those
+ * rects showed before, which is all a partial update needs to know about
+ * the panel after deep sleep has cleared the driver's buffers.
+ */
+class PanelFrame {
+public:
+    static const uint8_t VERSION = 2;      // 2: 1-bit rows LSB-first
+    static const uint8_t FLAG_DELTA = 0x01;
+    static const size_t HEADER_SIZE = 24;
+    static const size_t RECT_SIZE = 16;
+    static const size_t MAX_RECTS = 64;
+
+    // Checks the header, rect table and data bounds; data must outlive the frame
+    bool parse(const uint8_t* data, size_t size);
+
+    const PanelFrameHeader& getHeader() const { return header; }
+    bool isDelta() const { return (header.flags & FLAG_DELTA) != 0; }
+    size_t getRectCount() const { return rects.size(); }
+    const PanelFrameRect& getRect(size_t index) const { return rects[index]; }
+
+    // Decompress one rect (or, for deltas, what it replaces) into a panel buffer
+    bool unpack(size_t index, bool previous, uint8_t* buffer) const;
+
+    // Server side: rects of image (and previous, for a delta) as a frame
+    static bool encode(const PanelFrameHeader& header, const std::vector<PanelFrameRect>& rects,
+                       const uint8_t* image, const uint8_t* previous, std::vector<uint8_t>& out);
+
+    static int bitsPerPixel(uint8_t mode) { return mode == 0 ? 1 : 4; }
+    static size_t bufferSize(uint8_t mode, int width, int height);
+    // Rect edges fall on whole bytes of the packed rows
+    static bool isAligned(uint8_t mode, int x, int width);
+
+    static void packBits(const uint8_t* data, size_t size, std::vector<uint8_t>& out);
+
+private:
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    PanelFrameHeader header = {};
+    std::vector<PanelFrameRect> rects;
+
+    bool unpackRows(const PanelFrameRect& rect, const uint8_t* packed, size_t length, uint8_t* buffer) const;
+};
+
+#endif
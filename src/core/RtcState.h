@@ -0,0 +1,30 @@
+#ifndef RTC_STATE_H
+#define RTC_STATE_H
+
+#include <cstdint>
+#include <cstring>
+
+/**
+ * State kept across deep sleep in RTC slow memory: a struct declared
+ * RTC_DATA_ATTR static whose first member is a uint32_t magic. Each module
+ * has its own magic. A mismatch means RTC memory was lost (power-on, or a
+ * brownout) and whatever is there is garbage.
+ */
+class RtcState {
+public:
+    template <typename State>
+    static bool isValid(const State& state, uint32_t magic) {
+        return state.magic == magic;
+    }
+
+    // True if state survived; otherwise it is zeroed and stamped with magic
+    template <typename State>
+    static bool ensure(State& state, uint32_t magic) {
+        if (state.magic == magic) return true;
+        memset(&state, 0, sizeof(state));
+        state.magic = magic;
+        return false;
+    }
+};
+
+#endif
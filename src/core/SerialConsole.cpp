@@ -0,0 +1,155 @@
+#include "SerialConsole.h"
+#include "BatteryHistory.h"
+#include "Logger.h"
+#include "MemoryTracker.h"
+#include "WakeMetrics.h"
+#include <cstring>
+#include <strings.h>
+
+SerialConsole::SerialConsole(Stream& stream)
+    : stream(stream), lineLength(0), overflow(false), lastCommandMs(0) {
+    addCommand("help", "", "List commands", [this](int, char*[], Print&) { printHelp(); });
+    addCommand("metrics", "", "Phase timings of this wake", [](int, char*[], Print& out) { WakeMetrics::print(out); });
+    addCommand("log", "[tag] [level|default]", "Show or set log levels",
+               [this](int argc, char* argv[], Print&) { handleLog(argc, argv); });
+    addCommand("mem", "", "Heap, PSRAM and per-subsystem usage", [this](int, char*[], Print&) { printMemory(); });
+    addCommand("battery", "", "Battery history and runtime forecast",
+               [](int, char*[], Print& out) { BatteryHistory::print(out); });
+}
+
+void SerialConsole::addCommand(const char* name, const char* usage, const char* help, Handler handler) {
+    for (Command& command : commands) {
+        if (strcmp(command.name, name) == 0) {
+            command.usage = usage;
+            command.help = help;
+            command.handler = handler;
+            return;
+        }
+    }
+    commands.push_back({name, usage, help, handler});
+}
+
+void SerialConsole::poll() {
+    while (stream.available() > 0) {
+        int c = stream.read();
+        if (c < 0) break;
+
+        if (c == '\r' || c == '\n') {
+            if (overflow) {
+                stream.printf("error: line longer than %u characters\n", static_cast<unsigned>(MAX_LINE - 1));
+            } else if (lineLength > 0) {
+                line[lineLength] = '\0';
+                execute(line);
+            }
+            lineLength = 0;
+            overflow = false;
+        } else if (c == '\b' || c == 0x7f) {
+            if (lineLength > 0) lineLength--;
+        } else if (lineLength < MAX_LINE - 1) {
+            line[lineLength++] = static_cast<char>(c);
+        } else {
+            overflow = true;
+        }
+    }
+}
+
+bool SerialConsole::execute(char* text) {
+    char* argv[MAX_ARGS];
+    int argc = 0;
+    char* save = nullptr;
+    for (char* word = strtok_r(text, " \t", &save); word; word = strtok_r(nullptr, " \t", &save)) {
+        if (argc == MAX_ARGS) {
+            stream.printf("error: at most %d words per command\n", MAX_ARGS);
+            return false;
+        }
+        argv[argc++] = word;
+    }
+    if (argc == 0) return false;
+
+    lastCommandMs = millis();
+    if (lastCommandMs == 0) lastCommandMs = 1;
+
+    for (Command& command : commands) {
+        if (strcasecmp(command.name, argv[0]) == 0) {
+            command.handler(argc, argv, stream);
+            return true;
+        }
+    }
+
+    stream.printf("error: unknown command '%s' (try help)\n", argv[0]);
+    return false;
+}
+
+bool SerialConsole::isIdle(unsigned long quietMs) const {
+    return lastCommandMs == 0 || millis() - lastCommandMs >= quietMs;
+}
+
+void SerialConsole::printHelp() {
+    for (const Command& command : commands) {
+        char signature[40];
+        snprintf(signature, sizeof(signature), "%s %s", command.name, command.usage);
+        stream.printf("  %-28s %s\n", signature, command.help);
+    }
+}
+
+void SerialConsole::printLogLevels() {
+    stream.printf("log level %s\n", Logger::getLevelName(Logger::getLogLevel()));
+    for (size_t i = 0; i < Logger::getTagLevelCount(); i++) {
+        stream.printf("  %-24s %s\n", Logger::getTagName(i), Logger::getLevelName(Logger::getTagLevel(i)));
+    }
+}
+
+void SerialConsole::handleLog(int argc, char* argv[]) {
+    LogLevel level;
+
+    if (argc == 2) {
+        if (strcasecmp(argv[1], "default") == 0) {
+            Logger::clearTagLevels();
+        } else if (Logger::parseLevel(argv[1], level)) {
+            Logger::setLogLevel(level);
+        } else {
+            stream.printf("error: unknown level '%s'\n", argv[1]);
+            return;
+        }
+    } else if (argc == 3) {
+        if (strcasecmp(argv[2], "default") == 0) {
+            Logger::clearTagLevel(argv[1]);
+        } else if (!Logger::parseLevel(argv[2], level)) {
+            stream.printf("error: unknown level '%s'\n", argv[2]);
+            return;
+        } else if (!Logger::setTagLevel(argv[1], level)) {
+            stream.printf("error: cannot override '%s' (%u tags max, names under %u characters)\n", argv[1],
+                          static_cast<unsigned>(Logger::MAX_TAG_LEVELS), static_cast<unsigned>(Logger::MAX_TAG_LENGTH));
+            return;
+        }
+    } else if (argc > 3) {
+        stream.printf("usage: log [tag] [debug|info|warn|error|fatal|default]\n");
+        return;
+    }
+
+    printLogLevels();
+}
+
+void SerialConsole::printMemory() {
+    HeapSnapshot snapshot = MemoryTracker::takeSnapshot();
+
+    stream.printf("internal free %zu, largest %zu, min %zu, fragmentation %.0f%%\n",
+                  snapshot.freeInternal, snapshot.largestFreeInternal,
+                  snapshot.minimumFreeInternal, snapshot.fragmentation * 100.0f);
+    stream.printf("PSRAM free %zu, largest %zu; %zu blocks / %zu bytes allocated\n",
+                  snapshot.freePsram, snapshot.largestFreePsram,
+                  snapshot.allocatedBlocks, snapshot.totalAllocatedBytes);
+
+    for (int i = 0; i < static_cast<int>(MemorySubsystem::COUNT); i++) {
+        MemorySubsystem subsystem = static_cast<MemorySubsystem>(i);
+        SubsystemMemoryStats s = MemoryTracker::getStats(subsystem);
+        if (s.allocationCount == 0 && s.peakBytes == 0) continue;
+        stream.printf("  %-10s current %zu, peak %zu, allocs %lu, frees %lu\n",
+                      MemoryTracker::getSubsystemName(subsystem),
+                      s.currentBytes, s.peakBytes, s.allocationCount, s.freeCount);
+    }
+
+    if (!MemoryTracker::isEnabled()) {
+        stream.printf("(scope tracking off: only owned buffers are attributed; set Debug.TrackMemory)\n");
+    }
+}
@@ -0,0 +1,66 @@
+#ifndef SERIAL_CONSOLE_H
+#define SERIAL_CONSOLE_H
+
+#include <Arduino.h>
+#include <functional>
+#include <vector>
+
+/**
+ * SerialConsole is a line-based command interface on the serial port for
+ * inspecting and tuning a unit in place.
+ *
+ * poll() is called from loop() while the unit is awake. It only consumes
+ * bytes the UART has already received and never waits for more, so an idle
+ * console costs one available() call per loop. Lines are collected in a
+ * fixed buffer and split on spaces; the first word selects the command.
+ *
+ * Built in: help, metrics (WakeMetrics phase timings), log (global and
+ * per-tag levels) and mem (heap, PSRAM and per-subsystem usage). Managers
+ * add their own commands with addCommand() (see LayoutManager).
+ */
+class SerialConsole {
+public:
+    static const size_t MAX_LINE = 96;
+    static const int MAX_ARGS = 6;
+
+    // argv[0] is the command name
+    typedef std::function<void(int argc, char* argv[], Print& out)> Handler;
+
+    explicit SerialConsole(Stream& stream);
+
+    // usage: arguments shown by help, e.g. "<region>"
+    void addCommand(const char* name, const char* usage, const char* help, Handler handler);
+
+    // Run every complete line received so far
+    void poll();
+
+    // Parse and run one line (made public for testing)
+    bool execute(char* line);
+
+    // millis() of the last command, 0 if none yet
+    unsigned long getLastCommandMs() const { return lastCommandMs; }
+    // True when no command arrived in the last quietMs
+    bool isIdle(unsigned long quietMs) const;
+
+private:
+    struct Command {
+        const char* name;
+        const char* usage;
+        const char* help;
+        Handler handler;
+    };
+
+    Stream& stream;
+    std::vector<Command> commands;
+    char line[MAX_LINE];
+    size_t lineLength;
+    bool overflow;
+    unsigned long lastCommandMs;
+
+    void printHelp();
+    void printLogLevels();
+    void handleLog(int argc, char* argv[]);
+    void printMemory();
+};
+
+#endif
@@ -0,0 +1,101 @@
+#include "SourceCache.h"
+#include "Logger.h"
+#include "Storage.h"
+#include <ctime>
+
+static const uint32_t SOURCE_MAGIC = 0x53524331;  // "SRC1"
+
+// Before this the clock has not been set
+static const uint32_t MIN_EPOCH = 1577836800;  // 2020-01-01
+
+SourceCache::SourceCache(const char* key, uint32_t freshS, uint32_t maxAgeS)
+    : keyHash(2166136261u), freshS(freshS), maxAgeS(maxAgeS), fetchedAt(0), present(false) {
+    for (const char* p = key; *p; p++) {
+        keyHash = (keyHash ^ static_cast<uint8_t>(*p)) * 16777619u;
+    }
+    snprintf(fileName, sizeof(fileName), "/src-%08lx.bin", static_cast<unsigned long>(keyHash));
+}
+
+bool SourceCache::load(String& body) {
+    present = false;
+    if (!Storage::exists(StorageUse::IMAGE_CACHE, fileName)) return false;
+
+    fs::File file = Storage::open(StorageUse::IMAGE_CACHE, fileName, "r");
+    if (!file) return false;
+    Header header;
+    bool ok = file.read(reinterpret_cast<uint8_t*>(&header), sizeof(header)) == sizeof(header) &&
+              header.magic == SOURCE_MAGIC && header.keyHash == keyHash &&
+              header.length == file.size() - sizeof(header);
+    if (ok) {
+        body = String();
+        body.reserve(header.length);
+        char chunk[256];
+        size_t left = header.length;
+        while (ok && left > 0) {
+            size_t want = left < sizeof(chunk) ? left : sizeof(chunk);
+            size_t got = file.read(reinterpret_cast<uint8_t*>(chunk), want);
+            ok = got == want;
+            body.concat(chunk, got);
+            left -= got;
+        }
+    }
+    file.close();
+
+    if (!ok) {
+        LOG_INFO("SourceCache", "%s is for another build or source, ignoring it", fileName);
+        body = String();
+        return false;
+    }
+    fetchedAt = header.fetchedAt;
+    if (getFreshness() == Freshness::EXPIRED) {
+        LOG_INFO("SourceCache", "%s expired (fetched at %lu)", fileName, static_cast<unsigned long>(fetchedAt));
+        body = String();
+        return false;
+    }
+    present = true;
+    Storage::touch(StorageUse::IMAGE_CACHE, fileName);
+    return true;
+}
+
+bool SourceCache::store(const String& body) {
+    uint32_t now = static_cast<uint32_t>(time(nullptr));
+    Header header = {SOURCE_MAGIC, keyHash, now >= MIN_EPOCH ? now : 0, static_cast<uint32_t>(body.length())};
+    // Good either way for the rest of this wake
+    fetchedAt = header.fetchedAt;
+    present = true;
+
+    size_t bytes = sizeof(header) + body.length();
+    Storage::remove(StorageUse::IMAGE_CACHE, fileName);
+    if (!Storage::reserve(StorageUse::IMAGE_CACHE, bytes)) {
+        LOG_WARN("SourceCache", "No room for %s (%u bytes)", fileName, static_cast<unsigned>(bytes));
+        return false;
+    }
+    fs::File file = Storage::open(StorageUse::IMAGE_CACHE, fileName, "w");
+    if (!file) {
+        LOG_ERROR("SourceCache", "Failed to open %s for writing", fileName);
+        return false;
+    }
+    size_t written = file.write(reinterpret_cast<const uint8_t*>(&header), sizeof(header));
+    written += file.write(reinterpret_cast<const uint8_t*>(body.c_str()), body.length());
+    file.close();
+
+    if (written != bytes) {
+        LOG_ERROR("SourceCache", "Short write to %s", fileName);
+        Storage::remove(StorageUse::IMAGE_CACHE, fileName);
+        return false;
+    }
+    Storage::recordWrite(StorageUse::IMAGE_CACHE, fileName, bytes);
+    return true;
+}
+
+Freshness SourceCache::getFreshness() const {
+    return classify(fetchedAt, static_cast<uint32_t>(time(nullptr)), freshS, maxAgeS);
+}
+
+Freshness SourceCache::classify(uint32_t fetchedAt, uint32_t now, uint32_t freshS, uint32_t maxAgeS) {
+    // Age unknown, or the clock went back: show it, but ask again
+    if (fetchedAt == 0 || now < MIN_EPOCH || now < fetchedAt) return Freshness::STALE;
+    uint32_t age = now - fetchedAt;
+    if (age < freshS) return Freshness::FRESH;
+    return age < maxAgeS ? Freshness::STALE : Freshness::EXPIRED;
+}
@@ -0,0 +1,58 @@
+#ifndef SOURCE_CACHE_H
+#define SOURCE_CACHE_H
+
+#include <Arduino.h>
+#include <cstdint>
+
+// How usable a cached value is
+enum class Freshness : uint8_t {
+    FRESH = 0,          // Newer than the fresh window: no need to ask again
+    STALE,              // Still shown, but checked for news after drawing
+    EXPIRED             // Too old to show
+};
+
+/**
+ * The last good response of one network source, kept in the image cache
+ * so a widget can draw straight away and ask the server afterwards
+ * (stale-while-revalidate).
+ *
+ * A value is FRESH for freshS seconds after it was fetched, then STALE up
+ * to maxAgeS, then EXPIRED. Without a set clock its age is unknown and it
+ * counts as STALE. The file is named after an FNV-1a hash of the key (the
+ * request, without anything that changes between calls) and starts with
+ * a small header holding a magic and the key hash, so a file in another
+ * format or for another key is ignored.
+ */
+class SourceCache {
+public:
+    SourceCache(const char* key, uint32_t freshS, uint32_t maxAgeS);
+
+    // False if there is no value, or it has expired
+    bool load(String& body);
+    bool store(const String& body);
+
+    bool hasValue() const { return present; }
+    uint32_t getFetchedAt() const { return fetchedAt; }  // 0: fetched before the clock was set
+    Freshness getFreshness() const;
+    const char* getFileName() const { return fileName; }
+
+    // Made public for testing
+    static Freshness classify(uint32_t fetchedAt, uint32_t now, uint32_t freshS, uint32_t maxAgeS);
+
+private:
+    struct Header {
+        uint32_t magic;
+        uint32_t keyHash;
+        uint32_t fetchedAt;
+        uint32_t length;
+    };
+
+    uint32_t keyHash;
+    uint32_t freshS;
+    uint32_t maxAgeS;
+    uint32_t fetchedAt;
+    bool present;
+    char fileName[20];
+};
+
+#endif
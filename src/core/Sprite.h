@@ -0,0 +1,39 @@
+#ifndef SPRITE_H
+#define SPRITE_H
+
+#include <cstddef>
+#include <cstdint>
+
+enum class SpriteEncoding : uint8_t {
+    RAW,                // Rows one after another
+    PACKBITS            // PackBits runs over all the packed rows, like panel frames (PanelFrame)
+};
+
+/**
+ * A packed image for Compositor::blit(), read in place from flash or a
+ * const table; nothing is copied into the heap.
+ *
+ * Pixels are 1, 2, 4 or 8 bits, each row starting on a byte, most
+ * significant bits first. Values become surface gray levels through the
+ * palette, or spread evenly from 0 (black) to the top value (white)
+ * without one. Pixels equal to the key, or clear in the mask, keep what
+ * is already on the surface. The mask is one bit per pixel, laid out like
+ * a raw 1-bit sprite of the same size.
+ */
+struct Sprite {
+    static const int NO_KEY = -1;
+
+    const uint8_t* data = nullptr;
+    size_t length = 0;
+    uint16_t width = 0;
+    uint16_t height = 0;
+    uint8_t bitsPerPixel = 8;
+    SpriteEncoding encoding = SpriteEncoding::RAW;
+    int key = NO_KEY;                   // Source value, before the palette
+    const uint8_t* mask = nullptr;
+    const uint8_t* palette = nullptr;   // 1 << bitsPerPixel gray levels
+
+    size_t getStride() const { return (static_cast<size_t>(width) * bitsPerPixel + 7) / 8; }
+};
+
+#endif
@@ -0,0 +1,146 @@
+#include "StaticLayer.h"
+#include "Compositor.h"
+#include "Logger.h"
+#include "MemoryTracker.h"
+#include "PanelFrame.h"
+#include "Storage.h"
+#include <cstring>
+#include <esp_idf_version.h>
+#if ESP_IDF_VERSION_MAJOR >= 5
+#include <esp_app_desc.h>
+#else
+#include <esp_ota_ops.h>
+#endif
+
+static const uint8_t LAYER_MAGIC[4] = {'I', 'S', 'L', '1'};
+
+// Static widgets are drawn by the firmware, so another app image redraws the
+// layer. The ELF hash changes with the code, unlike __DATE__ in a file that
+// an incremental build does not recompile.
+static const uint8_t* appElfSha256() {
+#if ESP_IDF_VERSION_MAJOR >= 5
+    return esp_app_get_description()->app_elf_sha256;
+#else
+    return esp_ota_get_app_description()->app_elf_sha256;
+#endif
+}
+
+const char* const StaticLayer::FILE_NAME = "/static.bin";
+
+static uint16_t getU16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+static uint32_t getU32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+static void putU16(std::vector<uint8_t>& out, size_t at, uint16_t value) {
+    out[at] = value & 0xff;
+    out[at + 1] = value >> 8;
+}
+
+static void putU32(std::vector<uint8_t>& out, size_t at, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out[at + i] = (value >> (8 * i)) & 0xff;
+    }
+}
+
+StaticLayer::StaticLayer(uint32_t configHash) {
+    // FNV-1a over the app image hash, starting from the config hash
+    key = configHash;
+    const uint8_t* sha256 = appElfSha256();
+    for (int i = 0; i < 32; i++) {
+        key = (key ^ sha256[i]) * 16777619u;
+    }
+}
+
+bool StaticLayer::encode(const Compositor& compositor, uint32_t key, std::vector<uint8_t>& out) {
+    const uint8_t* surface = compositor.getSurfaceBuffer();
+    if (!surface) return false;
+
+    out.assign(HEADER_SIZE, 0);
+    memcpy(out.data(), LAYER_MAGIC, sizeof(LAYER_MAGIC));
+    out[4] = VERSION;
+    putU16(out, 6, static_cast<uint16_t>(compositor.getWidth()));
+    putU16(out, 8, static_cast<uint16_t>(compositor.getHeight()));
+    putU32(out, 12, key);
+    PanelFrame::packBits(surface, compositor.getSurfaceSize(), out);
+    return true;
+}
+
+bool StaticLayer::check(const uint8_t* data, size_t size, const Compositor& compositor, uint32_t key) {
+    return size > HEADER_SIZE && memcmp(data, LAYER_MAGIC, sizeof(LAYER_MAGIC)) == 0 && data[4] == VERSION &&
+           getU16(data + 6) == compositor.getWidth() && getU16(data + 8) == compositor.getHeight() &&
+           getU32(data + 12) == key;
+}
+
+bool StaticLayer::restore(Compositor& compositor) {
+    if (!compositor.isInitialized() || !Storage::exists(StorageUse::IMAGE_CACHE, FILE_NAME)) return false;
+
+    fs::File file = Storage::open(StorageUse::IMAGE_CACHE, FILE_NAME, "r");
+    if (!file) return false;
+    size_t size = file.size();
+    uint8_t* data = size > HEADER_SIZE
+                        ? static_cast<uint8_t*>(MemoryTracker::allocate(MemorySubsystem::COMPOSITOR, size, true))
+                        : nullptr;
+    bool ok = data && file.read(data, size) == size;
+    file.close();
+
+    if (ok && !check(data, size, compositor, key)) {
+        LOG_INFO("StaticLayer", "Stored layer is for another config or build; rendering it again");
+        ok = false;
+    }
+    if (ok) {
+        // The runs cover the whole surface, so this replaces clearing it
+        Sprite sprite;
+        sprite.data = data + HEADER_SIZE;
+        sprite.length = size - HEADER_SIZE;
+        sprite.width = static_cast<uint16_t>(compositor.getWidth());
+        sprite.height = static_cast<uint16_t>(compositor.getHeight());
+        sprite.encoding = SpriteEncoding::PACKBITS;
+        ok = compositor.blit(0, 0, sprite);
+        if (ok) {
+            Storage::touch(StorageUse::IMAGE_CACHE, FILE_NAME);
+        } else {
+            LOG_WARN("StaticLayer", "%s is damaged", FILE_NAME);
+        }
+    }
+
+    MemoryTracker::release(MemorySubsystem::COMPOSITOR, data, size);
+    return ok;
+}
+
+bool StaticLayer::save(const Compositor& compositor) {
+    std::vector<uint8_t> layer;
+    if (!encode(compositor, key, layer)) return false;
+
+    Storage::remove(StorageUse::IMAGE_CACHE, FILE_NAME);
+    if (!Storage::reserve(StorageUse::IMAGE_CACHE, layer.size())) {
+        LOG_WARN("StaticLayer", "No room for the %u byte layer", static_cast<unsigned>(layer.size()));
+        return false;
+    }
+
+    fs::File file = Storage::open(StorageUse::IMAGE_CACHE, FILE_NAME, "w");
+    if (!file) {
+        LOG_ERROR("StaticLayer", "Failed to open %s for writing", FILE_NAME);
+        return false;
+    }
+    size_t written = file.write(layer.data(), layer.size());
+    file.close();
+
+    if (written != layer.size()) {
+        LOG_ERROR("StaticLayer", "Short write to %s (%u of %u bytes)", FILE_NAME, static_cast<unsigned>(written),
+                  static_cast<unsigned>(layer.size()));
+        Storage::remove(StorageUse::IMAGE_CACHE, FILE_NAME);
+        return false;
+    }
+    Storage::recordWrite(StorageUse::IMAGE_CACHE, FILE_NAME, layer.size());
+    LOG_INFO("StaticLayer", "Saved %u byte static layer", static_cast<unsigned>(layer.size()));
+    return true;
+}
+
+void StaticLayer::invalidate() {
+    Storage::remove(StorageUse::IMAGE_CACHE, FILE_NAME);
+}
@@ -0,0 +1,48 @@
+#ifndef STATIC_LAYER_H
+#define STATIC_LAYER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Compositor;
+
+/**
+ * The part of the frame that only changes with the config: static regions
+ * (NameWidget, or any region with "Static": true) and the layout borders.
+ *
+ * It is rendered once, PackBits-compressed and kept in the image cache.
+ * A full render then starts by unpacking it onto the compositor instead
+ * of clearing the surface, and only the dynamic regions are drawn on top.
+ *
+ * File: a 16-byte header ("ISL1", version, 0, width, height, key) and the
+ * PackBits runs over the whole surface, little-endian. The key mixes the
+ * config hash with the firmware build, so a new config or a new firmware
+ * (which may draw static widgets differently) renders the layer again.
+ */
+class StaticLayer {
+public:
+    static const uint8_t VERSION = 1;
+    static const size_t HEADER_SIZE = 16;
+    static const char* const FILE_NAME;
+
+    explicit StaticLayer(uint32_t configHash);
+
+    // Unpack the stored layer onto the whole surface; false if there is
+    // none for this key and size, and the surface is then left alone
+    bool restore(Compositor& compositor);
+    // Store the surface as it is now
+    bool save(const Compositor& compositor);
+    void invalidate();
+
+    uint32_t getKey() const { return key; }
+
+    static bool encode(const Compositor& compositor, uint32_t key, std::vector<uint8_t>& out);
+    // Checks the header against the surface and key; the runs follow it
+    static bool check(const uint8_t* data, size_t size, const Compositor& compositor, uint32_t key);
+
+private:
+    uint32_t key;
+};
+
+#endif
@@ -0,0 +1,334 @@
+#include "Storage.h"
+#include "Logger.h"
+#include <SD.h>
+#include <SPI.h>
+#include <cstdio>
+
+#ifdef STORAGE_LITTLEFS
+#include <LittleFS.h>
+#define INTERNAL_FS LittleFS
+#define INTERNAL_FS_NAME "LittleFS"
+#else
+#include <SPIFFS.h>
+#define INTERNAL_FS SPIFFS
+#define INTERNAL_FS_NAME "SPIFFS"
+#endif
+
+// Inkplate 10 microSD slot, on its own SPI bus
+static const int8_t SD_SCK_PIN = 14;
+static const int8_t SD_MISO_PIN = 12;
+static const int8_t SD_MOSI_PIN = 13;
+static const int8_t SD_CS_PIN = 15;
+static const uint32_t SD_FREQUENCY = 20000000;
+
+/**
+ * Fixed layout of each use: a directory and, for caches, an index file
+ */
+struct StorageUseInfo {
+    const char* name;
+    const char* directory;
+    const char* indexFile;
+};
+
+static const StorageUseInfo USES[] = {
+    {"config", "", nullptr},
+    {"images", "/cache", "/cache/index.lru"},
+    {"logs", "", "/logs.lru"},
+};
+
+static SPIClass sdSpi(HSPI);
+
+Storage::Route Storage::routes[static_cast<int>(StorageUse::COUNT)];
+bool Storage::cardMounted = false;
+
+bool Storage::begin() {
+    if (!INTERNAL_FS.begin(true)) {
+        LOG_ERROR("Storage", "Failed to mount %s", INTERNAL_FS_NAME);
+        return false;
+    }
+    LOG_INFO("Storage", "%s mounted successfully", INTERNAL_FS_NAME);
+    return true;
+}
+
+bool Storage::mountCard() {
+    if (cardMounted) return true;
+
+    sdSpi.begin(SD_SCK_PIN, SD_MISO_PIN, SD_MOSI_PIN, SD_CS_PIN);
+    if (!SD.begin(SD_CS_PIN, sdSpi, SD_FREQUENCY) || SD.cardType() == CARD_NONE) {
+        LOG_WARN("Storage", "No microSD card");
+        return false;
+    }
+    cardMounted = true;
+    LOG_INFO("Storage", "microSD mounted, %lu MB", static_cast<unsigned long>(SD.cardSize() / (1024 * 1024)));
+    return true;
+}
+
+bool Storage::configure(StorageUse use, StorageBackend backend, size_t quotaBytes) {
+    Route& target = route(use);
+    bool ok = true;
+
+    if (use == StorageUse::CONFIG && backend != StorageBackend::INTERNAL) {
+        LOG_WARN("Storage", "The config always lives on internal flash");
+        backend = StorageBackend::INTERNAL;
+        ok = false;
+    } else if (backend == StorageBackend::SD_CARD && !mountCard()) {
+        LOG_WARN("Storage", "Keeping %s on internal flash", getUseName(use));
+        backend = StorageBackend::INTERNAL;
+        ok = false;
+    }
+
+    // A different filesystem has a different index
+    if (target.backend != backend) {
+        target.entries.clear();
+        target.indexLoaded = false;
+        target.indexDirty = false;
+        target.clock = 0;
+    }
+    target.backend = backend;
+    target.quotaBytes = quotaBytes;
+
+    const char* directory = USES[static_cast<int>(use)].directory;
+    if (directory[0] != '\0') {
+        fs(use).mkdir(directory);
+    }
+    LOG_DEBUG("Storage", "%s on %s, quota %u bytes", getUseName(use), getBackendName(backend),
+              static_cast<unsigned>(quotaBytes));
+    return ok;
+}
+
+StorageBackend Storage::getBackend(StorageUse use) {
+    return route(use).backend;
+}
+
+size_t Storage::getQuota(StorageUse use) {
+    return route(use).quotaBytes;
+}
+
+String Storage::path(StorageUse use, const char* name) {
+    return String(USES[static_cast<int>(use)].directory) + name;
+}
+
+fs::FS& Storage::fs(StorageUse use) {
+    if (route(use).backend == StorageBackend::SD_CARD) {
+        return SD;
+    }
+    return INTERNAL_FS;
+}
+
+fs::File Storage::open(StorageUse use, const char* name, const char* mode) {
+    return fs(use).open(path(use, name), mode);
+}
+
+bool Storage::exists(StorageUse use, const char* name) {
+    return fs(use).exists(path(use, name));
+}
+
+bool Storage::remove(StorageUse use, const char* name) {
+    Route& target = route(use);
+    if (target.quotaBytes > 0) {
+        loadIndex(use);
+        for (size_t i = 0; i < target.entries.size(); i++) {
+            if (target.entries[i].name == name) {
+                target.entries.erase(target.entries.begin() + i);
+                target.indexDirty = true;
+                break;
+            }
+        }
+    }
+    return fs(use).remove(path(use, name));
+}
+
+bool Storage::rename(StorageUse use, const char* from, const char* to) {
+    if (route(use).quotaBytes > 0) {
+        loadIndex(use);
+        StorageEntry* replaced = findEntry(use, to);
+        if (replaced) {
+            std::vector<StorageEntry>& entries = route(use).entries;
+            entries.erase(entries.begin() + (replaced - entries.data()));
+        }
+        StorageEntry* moved = findEntry(use, from);
+        if (moved) moved->name = to;
+        route(use).indexDirty = true;
+    }
+    return fs(use).rename(path(use, from).c_str(), path(use, to).c_str());
+}
+
+bool Storage::reserve(StorageUse use, size_t bytes) {
+    Route& target = route(use);
+    if (target.quotaBytes == 0) return true;
+    if (bytes > target.quotaBytes) {
+        LOG_WARN("Storage", "%u bytes exceed the %s quota", static_cast<unsigned>(bytes), getUseName(use));
+        return false;
+    }
+
+    evictUntil(use, target.quotaBytes - bytes);
+    return true;
+}
+
+int Storage::trim(StorageUse use, size_t targetBytes) {
+    if (route(use).quotaBytes == 0) return 0;
+    int evicted = evictUntil(use, targetBytes);
+    if (evicted > 0) {
+        LOG_INFO("Storage", "Trimmed %d files from %s, %u bytes left", evicted, getUseName(use),
+                 static_cast<unsigned>(getUsedBytes(use)));
+    }
+    return evicted;
+}
+
+int Storage::evictUntil(StorageUse use, size_t targetBytes) {
+    Route& target = route(use);
+    loadIndex(use);
+    size_t used = getUsedBytes(use);
+    int evicted = 0;
+    while (used > targetBytes && !target.entries.empty()) {
+        size_t oldest = 0;
+        for (size_t i = 1; i < target.entries.size(); i++) {
+            if (target.entries[i].lastUse < target.entries[oldest].lastUse) oldest = i;
+        }
+        const StorageEntry& victim = target.entries[oldest];
+        LOG_DEBUG("Storage", "Evicting %s (%u bytes) from %s", victim.name.c_str(),
+                  static_cast<unsigned>(victim.bytes), getUseName(use));
+        fs(use).remove(path(use, victim.name.c_str()));
+        used -= victim.bytes;
+        target.entries.erase(target.entries.begin() + oldest);
+        target.indexDirty = true;
+        evicted++;
+    }
+    return evicted;
+}
+
+void Storage::recordWrite(StorageUse use, const char* name, size_t bytes) {
+    Route& target = route(use);
+    if (target.quotaBytes == 0) return;
+
+    loadIndex(use);
+    StorageEntry* entry = findEntry(use, name);
+    if (!entry) {
+        target.entries.push_back(StorageEntry{String(name), 0, 0});
+        entry = &target.entries.back();
+    }
+    entry->bytes = static_cast<uint32_t>(bytes);
+    entry->lastUse = ++target.clock;
+    target.indexDirty = true;
+}
+
+void Storage::touch(StorageUse use, const char* name) {
+    Route& target = route(use);
+    if (target.quotaBytes == 0) return;
+
+    loadIndex(use);
+    StorageEntry* entry = findEntry(use, name);
+    if (entry) {
+        entry->lastUse = ++target.clock;
+        target.indexDirty = true;
+    }
+}
+
+size_t Storage::getUsedBytes(StorageUse use) {
+    loadIndex(use);
+    size_t used = 0;
+    for (const StorageEntry& entry : route(use).entries) {
+        used += entry.bytes;
+    }
+    return used;
+}
+
+const std::vector<StorageEntry>& Storage::getEntries(StorageUse use) {
+    loadIndex(use);
+    return route(use).entries;
+}
+
+bool Storage::flush() {
+    bool ok = true;
+    for (int i = 0; i < static_cast<int>(StorageUse::COUNT); i++) {
+        if (routes[i].indexDirty) {
+            ok = saveIndex(static_cast<StorageUse>(i)) && ok;
+        }
+    }
+    return ok;
+}
+
+StorageEntry* Storage::findEntry(StorageUse use, const char* name) {
+    for (StorageEntry& entry : route(use).entries) {
+        if (entry.name == name) return &entry;
+    }
+    return nullptr;
+}
+
+void Storage::loadIndex(StorageUse use) {
+    Route& target = route(use);
+    const char* indexFile = USES[static_cast<int>(use)].indexFile;
+    if (target.indexLoaded || target.quotaBytes == 0 || !indexFile) return;
+    target.indexLoaded = true;
+
+    fs::File file = fs(use).open(indexFile, "r");
+    if (!file) return;
+
+    // One "<last use> <bytes> <name>" line per file
+    String line;
+    int c;
+    do {
+        c = file.read();
+        if (c >= 0 && c != '\n') {
+            line += static_cast<char>(c);
+            continue;
+        }
+        unsigned long lastUse = 0;
+        unsigned long bytes = 0;
+        int nameStart = 0;
+        if (sscanf(line.c_str(), "%lu %lu %n", &lastUse, &bytes, &nameStart) == 2 && nameStart > 0 &&
+            line[nameStart] == '/') {
+            target.entries.push_back(StorageEntry{line.substring(nameStart), static_cast<uint32_t>(bytes),
+                                                  static_cast<uint32_t>(lastUse)});
+            if (lastUse > target.clock) target.clock = static_cast<uint32_t>(lastUse);
+        }
+        line = "";
+    } while (c >= 0);
+    file.close();
+
+    LOG_DEBUG("Storage", "%s index: %u files, %u bytes", getUseName(use),
+              static_cast<unsigned>(target.entries.size()), static_cast<unsigned>(getUsedBytes(use)));
+}
+
+bool Storage::saveIndex(StorageUse use) {
+    Route& target = route(use);
+    const char* indexFile = USES[static_cast<int>(use)].indexFile;
+    if (!indexFile) return true;
+
+    fs::File file = fs(use).open(indexFile, "w");
+    if (!file) {
+        LOG_ERROR("Storage", "Failed to write %s", indexFile);
+        return false;
+    }
+    for (const StorageEntry& entry : target.entries) {
+        file.printf("%lu %lu %s\n", static_cast<unsigned long>(entry.lastUse),
+                    static_cast<unsigned long>(entry.bytes), entry.name.c_str());
+    }
+    file.close();
+    target.indexDirty = false;
+    return true;
+}
+
+StorageBackend Storage::parseBackend(const String& name) {
+    return name == "sd" ? StorageBackend::SD_CARD : StorageBackend::INTERNAL;
+}
+
+const char* Storage::getBackendName(StorageBackend backend) {
+    return backend == StorageBackend::SD_CARD ? "sd" : "internal";
+}
+
+const char* Storage::getUseName(StorageUse use) {
+    return USES[static_cast<int>(use)].name;
+}
+
+void Storage::reset() {
+    for (Route& target : routes) {
+        target.backend = StorageBackend::INTERNAL;
+        target.quotaBytes = 0;
+        target.indexLoaded = false;
+        target.indexDirty = false;
+        target.clock = 0;
+        target.entries.clear();
+    }
+    cardMounted = false;
+}
@@ -0,0 +1,115 @@
+#ifndef STORAGE_H
+#define STORAGE_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * What a file is for; each use is routed to one backend
+ */
+enum class StorageUse : uint8_t {
+    CONFIG = 0,         // config.json (always internal flash)
+    IMAGE_CACHE,        // Downloaded images and frames, under /cache
+    LOGS,               // Input traces and other diagnostics
+    COUNT
+};
+
+enum class StorageBackend : uint8_t {
+    INTERNAL = 0,       // SPIFFS, or LittleFS when built with STORAGE_LITTLEFS
+    SD_CARD             // Inkplate microSD slot
+};
+
+/**
+ * One file in a cache's LRU index
+ */
+struct StorageEntry {
+    String name;
+    uint32_t bytes;
+    uint32_t lastUse;   // Index clock, not wall time: the RTC may not be set
+};
+
+/**
+ * Storage decides which filesystem each kind of file lives on.
+ *
+ * Internal flash is SPIFFS unless the firmware is built with
+ * STORAGE_LITTLEFS (set board_build.filesystem = littlefs to match).
+ * There is one internal partition, so this is a build-time choice for
+ * every use on it, not a backend a use can be routed to.
+ * SPIFFS has no directories and its open() and exists() scan every file,
+ * so they slow down as a cache fills; LittleFS does not. The microSD card
+ * is mounted the first time a use is routed to it. Without a card the use
+ * stays on internal flash.
+ *
+ * The config always lives on internal flash, because it says where
+ * everything else goes. A use with a quota is a cache. Storage keeps an
+ * index of its files with their sizes and last use, and reserve() evicts
+ * the least recently used ones to make room. The index means caches never
+ * have to list a directory, which SPIFFS cannot do cheaply. Files the
+ * index does not know are never evicted.
+ */
+class Storage {
+public:
+    // Mount internal flash, formatting it if it cannot be mounted
+    static bool begin();
+
+    // Route use to backend with a quota in bytes (0: no quota, no index).
+    // False if the backend is unavailable; the use then stays internal.
+    static bool configure(StorageUse use, StorageBackend backend, size_t quotaBytes);
+    static StorageBackend getBackend(StorageUse use);
+    static size_t getQuota(StorageUse use);
+
+    // name is absolute ("/trace.bin"); the use's directory is prepended
+    static String path(StorageUse use, const char* name);
+    static fs::FS& fs(StorageUse use);
+    static fs::File open(StorageUse use, const char* name, const char* mode = "r");
+    static bool exists(StorageUse use, const char* name);
+    static bool remove(StorageUse use, const char* name);
+    static bool rename(StorageUse use, const char* from, const char* to);
+
+    // Before writing a new file of bytes: evict least recently used files
+    // until it fits the quota. False if it could never fit.
+    static bool reserve(StorageUse use, size_t bytes);
+    // Evict least recently used files until at most targetBytes are used;
+    // returns the number of files evicted
+    static int trim(StorageUse use, size_t targetBytes);
+    // After writing a file, and after reading one
+    static void recordWrite(StorageUse use, const char* name, size_t bytes);
+    static void touch(StorageUse use, const char* name);
+    static size_t getUsedBytes(StorageUse use);
+    static const std::vector<StorageEntry>& getEntries(StorageUse use);
+
+    // Write changed cache indexes; call before deep sleep
+    static bool flush();
+
+    static StorageBackend parseBackend(const String& name);
+    static const char* getBackendName(StorageBackend backend);
+    static const char* getUseName(StorageUse use);
+
+    // Forget routes and indexes (made public for testing)
+    static void reset();
+
+private:
+    struct Route {
+        StorageBackend backend;
+        size_t quotaBytes;
+        bool indexLoaded;
+        bool indexDirty;
+        uint32_t clock;
+        std::vector<StorageEntry> entries;
+    };
+
+    static Route routes[static_cast<int>(StorageUse::COUNT)];
+    static bool cardMounted;
+
+    static Route& route(StorageUse use) { return routes[static_cast<int>(use)]; }
+    static bool mountCard();
+    static void loadIndex(StorageUse use);
+    static bool saveIndex(StorageUse use);
+    static StorageEntry* findEntry(StorageUse use, const char* name);
+    static int evictUntil(StorageUse use, size_t targetBytes);
+};
+
+#endif
@@ -0,0 +1,245 @@
+#include "Telemetry.h"
+#include "MemoryTracker.h"
+#include "RtcState.h"
+#include <algorithm>
+#include <cstring>
+
+const char* Telemetry::QUERY_PARAMETER = "tm";
+bool Telemetry::enabled = false;
+size_t Telemetry::maxChars = 120;
+
+// Kept in RTC memory, see RtcState.h
+static const uint32_t HISTORY_MAGIC = 0x544c4d31;  // "TLM1"
+
+struct TelemetryHistory {
+    uint32_t magic;
+    uint32_t wakes;
+    uint8_t wakeCause;
+    uint8_t count;
+    uint8_t next;
+    TelemetryRecord records[Telemetry::HISTORY];
+};
+
+RTC_DATA_ATTR static TelemetryHistory history;
+
+static const char BASE64URL[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+static size_t putVarint(uint64_t value, uint8_t* out, size_t capacity, size_t at) {
+    do {
+        uint8_t byte = value & 0x7f;
+        value >>= 7;
+        if (value) byte |= 0x80;
+        if (at < capacity) out[at] = byte;
+        at++;
+    } while (value);
+    return at;
+}
+
+static bool getVarint(const uint8_t* data, size_t size, size_t& at, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (at >= size) return false;
+        uint8_t byte = data[at++];
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+void Telemetry::configure(bool enable, size_t chars) {
+    enabled = enable;
+    maxChars = chars;
+}
+
+void Telemetry::beginWake(uint8_t wakeCause) {
+    RtcState::ensure(history, HISTORY_MAGIC);
+    history.wakes++;
+    history.wakeCause = wakeCause;
+}
+
+void Telemetry::endWake() {
+    if (!RtcState::isValid(history, HISTORY_MAGIC)) return;
+
+    TelemetryRecord record = {};
+    record.wake = history.wakes;
+    record.wakeCause = history.wakeCause;
+    record.awakeMs = WakeMetrics::getAwakeMs();
+
+    for (int i = 0; i < static_cast<int>(TelemetryPhase::COUNT); i++) {
+        const PhaseTiming* phase = WakeMetrics::findPhase(getPhaseName(static_cast<TelemetryPhase>(i)));
+        record.phaseMs[i] = phase ? static_cast<uint32_t>(phase->totalMicros / 1000) : 0;
+        if (phase && i == static_cast<int>(TelemetryPhase::PANEL_FULL)) {
+            record.fullRefreshes = static_cast<uint16_t>(phase->count);
+        } else if (phase && i == static_cast<int>(TelemetryPhase::PANEL_PARTIAL)) {
+            record.partialRefreshes = static_cast<uint16_t>(phase->count);
+        }
+    }
+
+    record.batteryMv = static_cast<uint16_t>(WakeMetrics::getBatteryVolts() * 1000.0f + 0.5f);
+    for (int i = 0; i < static_cast<int>(WakeCounter::COUNT); i++) {
+        unsigned long count = WakeMetrics::getCount(static_cast<WakeCounter>(i));
+        record.failures[i] = static_cast<uint16_t>(count > 0xffff ? 0xffff : count);
+    }
+
+    HeapSnapshot snapshot = MemoryTracker::takeSnapshot();
+    record.minFreeInternal = static_cast<uint32_t>(snapshot.minimumFreeInternal);
+    record.largestFreeInternal = static_cast<uint32_t>(snapshot.largestFreeInternal);
+
+    history.records[history.next] = record;
+    history.next = (history.next + 1) % HISTORY;
+    if (history.count < HISTORY) history.count++;
+}
+
+String Telemetry::appendToUrl(const char* url) {
+    String result(url);
+    if (!enabled || maxChars == 0) return result;
+
+    // Base64 turns 3 bytes into 4 characters
+    uint8_t payload[192];
+    size_t capacity = std::min(sizeof(payload), maxChars * 3 / 4);
+    size_t length = encode(payload, capacity);
+    if (length == 0) return result;
+
+    std::string parameter = toParameter(payload, length);
+    result += strchr(url, '?') ? "&" : "?";
+    result += QUERY_PARAMETER;
+    result += "=";
+    result += parameter.c_str();
+    return result;
+}
+
+size_t Telemetry::encodeRecord(const TelemetryRecord& record, uint32_t newestWake, uint8_t* out, size_t capacity) {
+    size_t at = putVarint(newestWake - record.wake, out, capacity, 0);
+    if (at < capacity) out[at] = record.wakeCause;
+    at++;
+    at = putVarint(record.awakeMs, out, capacity, at);
+    for (uint32_t ms : record.phaseMs) {
+        at = putVarint(ms, out, capacity, at);
+    }
+    at = putVarint(record.fullRefreshes, out, capacity, at);
+    at = putVarint(record.partialRefreshes, out, capacity, at);
+    at = putVarint(record.batteryMv, out, capacity, at);
+    for (uint16_t failures : record.failures) {
+        at = putVarint(failures, out, capacity, at);
+    }
+    at = putVarint(record.minFreeInternal, out, capacity, at);
+    at = putVarint(record.largestFreeInternal, out, capacity, at);
+    return at;
+}
+
+size_t Telemetry::encode(uint8_t* out, size_t capacity) {
+    if (!RtcState::isValid(history, HISTORY_MAGIC) || history.count == 0) return 0;
+
+    const TelemetryRecord& newest = history.records[(history.next + HISTORY - 1) % HISTORY];
+    size_t at = putVarint(VERSION, out, capacity, 0);
+    at = putVarint(newest.wake, out, capacity, at);
+    size_t countAt = at++;
+    if (at > capacity) return 0;
+
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < history.count; i++) {
+        const TelemetryRecord& record = history.records[(history.next + HISTORY - 1 - i) % HISTORY];
+        size_t length = encodeRecord(record, newest.wake, out + at, capacity - at);
+        if (at + length > capacity) break;
+        at += length;
+        count++;
+    }
+    if (count == 0) return 0;
+
+    out[countAt] = count;
+    return at;
+}
+
+bool Telemetry::decode(const uint8_t* data, size_t size, std::vector<TelemetryRecord>& records) {
+    records.clear();
+    size_t at = 0;
+    uint64_t version, newestWake;
+    if (!getVarint(data, size, at, version) || version != VERSION) return false;
+    if (!getVarint(data, size, at, newestWake) || at >= size) return false;
+    uint8_t count = data[at++];
+
+    for (uint8_t i = 0; i < count; i++) {
+        TelemetryRecord record = {};
+        uint64_t value;
+        if (!getVarint(data, size, at, value) || at >= size) return false;
+        record.wake = static_cast<uint32_t>(newestWake - value);
+        record.wakeCause = data[at++];
+        if (!getVarint(data, size, at, value)) return false;
+        record.awakeMs = static_cast<uint32_t>(value);
+        for (uint32_t& ms : record.phaseMs) {
+            if (!getVarint(data, size, at, value)) return false;
+            ms = static_cast<uint32_t>(value);
+        }
+        if (!getVarint(data, size, at, value)) return false;
+        record.fullRefreshes = static_cast<uint16_t>(value);
+        if (!getVarint(data, size, at, value)) return false;
+        record.partialRefreshes = static_cast<uint16_t>(value);
+        if (!getVarint(data, size, at, value)) return false;
+        record.batteryMv = static_cast<uint16_t>(value);
+        for (uint16_t& failures : record.failures) {
+            if (!getVarint(data, size, at, value)) return false;
+            failures = static_cast<uint16_t>(value);
+        }
+        if (!getVarint(data, size, at, value)) return false;
+        record.minFreeInternal = static_cast<uint32_t>(value);
+        if (!getVarint(data, size, at, value)) return false;
+        record.largestFreeInternal = static_cast<uint32_t>(value);
+        records.push_back(record);
+    }
+    return at == size;
+}
+
+std::string Telemetry::toParameter(const uint8_t* data, size_t size) {
+    std::string text;
+    text.reserve((size * 4 + 2) / 3);
+    for (size_t i = 0; i < size; i += 3) {
+        uint32_t chunk = static_cast<uint32_t>(data[i]) << 16;
+        if (i + 1 < size) chunk |= static_cast<uint32_t>(data[i + 1]) << 8;
+        if (i + 2 < size) chunk |= data[i + 2];
+        text += BASE64URL[(chunk >> 18) & 0x3f];
+        text += BASE64URL[(chunk >> 12) & 0x3f];
+        if (i + 1 < size) text += BASE64URL[(chunk >> 6) & 0x3f];
+        if (i + 2 < size) text += BASE64URL[chunk & 0x3f];
+    }
+    return text;
+}
+
+bool Telemetry::fromParameter(const std::string& text, std::vector<uint8_t>& data) {
+    data.clear();
+    uint32_t bits = 0;
+    int bitCount = 0;
+    for (char c : text) {
+        const char* found = c ? strchr(BASE64URL, c) : nullptr;
+        if (!found) return false;
+        bits = (bits << 6) | static_cast<uint32_t>(found - BASE64URL);
+        bitCount += 6;
+        if (bitCount >= 8) {
+            bitCount -= 8;
+            data.push_back(static_cast<uint8_t>(bits >> bitCount));
+        }
+    }
+    return bitCount < 6;
+}
+
+size_t Telemetry::getHistoryCount() {
+    return RtcState::isValid(history, HISTORY_MAGIC) ? history.count : 0;
+}
+
+const char* Telemetry::getPhaseName(TelemetryPhase phase) {
+    switch (phase) {
+        case TelemetryPhase::CONFIG: return "config";
+        case TelemetryPhase::WIFI: return "wifi";
+        case TelemetryPhase::FETCH: return "fetch";
+        case TelemetryPhase::RENDER_FULL: return "render.full";
+        case TelemetryPhase::RENDER_PARTIAL: return "render.partial";
+        case TelemetryPhase::PANEL_FULL: return "panel.full";
+        case TelemetryPhase::PANEL_PARTIAL: return "panel.partial";
+        default: return "unknown";
+    }
+}
+
+void Telemetry::reset() {
+    memset(&history, 0, sizeof(history));
+    enabled = false;
+    maxChars = 120;
+}
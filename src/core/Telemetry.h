@@ -0,0 +1,95 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <Arduino.h>
+#include "WakeMetrics.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Phases carried in telemetry, in wire order (WakeMetrics phase names)
+ */
+enum class TelemetryPhase : uint8_t {
+    CONFIG = 0,
+    WIFI,
+    FETCH,
+    RENDER_FULL,
+    RENDER_PARTIAL,
+    PANEL_FULL,
+    PANEL_PARTIAL,
+    COUNT
+};
+
+/**
+ * Summary of one finished wake. Plain data: it is kept in RTC memory.
+ */
+struct TelemetryRecord {
+    uint32_t wake;                      // Wakes since power-on (RTC memory lost resets it)
+    uint8_t wakeCause;                  // esp_sleep_wakeup_cause_t
+    uint32_t awakeMs;
+    uint32_t phaseMs[static_cast<int>(TelemetryPhase::COUNT)];
+    uint16_t fullRefreshes;
+    uint16_t partialRefreshes;
+    uint16_t batteryMv;                 // 0: not read this wake
+    uint16_t failures[static_cast<int>(WakeCounter::COUNT)];
+    uint32_t minFreeInternal;           // Heap low-water mark (bytes)
+    uint32_t largestFreeInternal;       // Largest free block at the end of the wake
+};
+
+/**
+ * Telemetry rides on the image request the device makes anyway: the last
+ * few wakes are summarised from WakeMetrics and MemoryTracker, kept in RTC
+ * memory across deep sleep, and appended to the image URL as one query
+ * parameter (QUERY_PARAMETER). No extra connection or round trip is made;
+ * servers that do not know the parameter ignore it.
+ *
+ * The parameter is base64url (no padding) of:
+ *   version byte (1), varint newest wake, record count byte, then per
+ *   record, newest first: varint (newest wake - wake), wake cause byte,
+ *   varints awakeMs, phase ms x TelemetryPhase::COUNT, full and partial
+ *   refreshes, battery mV, failures x WakeCounter::COUNT, min free and
+ *   largest free internal heap.
+ * A record is typically 25-35 bytes. Older records are left out when the
+ * encoded parameter would exceed the configured character cap.
+ */
+class Telemetry {
+public:
+    static const char* QUERY_PARAMETER;
+    static const uint8_t VERSION = 1;
+    static const size_t HISTORY = 4;
+
+    // Server.Telemetry / Server.TelemetryChars
+    static void configure(bool enabled, size_t maxChars);
+    static bool isEnabled() { return enabled; }
+
+    // Start of setup(): number this wake
+    static void beginWake(uint8_t wakeCause);
+    // Before deep sleep: summarise this wake into the RTC history
+    static void endWake();
+
+    // url with the telemetry parameter appended (url unchanged when off or empty)
+    static String appendToUrl(const char* url);
+
+    // Binary payload of the newest records that fit in capacity; 0 if none do
+    static size_t encode(uint8_t* out, size_t capacity);
+    static bool decode(const uint8_t* data, size_t size, std::vector<TelemetryRecord>& records);
+    // Base64url parameter value <-> bytes
+    static std::string toParameter(const uint8_t* data, size_t size);
+    static bool fromParameter(const std::string& text, std::vector<uint8_t>& data);
+
+    static size_t getHistoryCount();
+    static const char* getPhaseName(TelemetryPhase phase);
+
+    // Forget the history and configuration (made public for testing)
+    static void reset();
+
+private:
+    static bool enabled;
+    static size_t maxChars;
+
+    static size_t encodeRecord(const TelemetryRecord& record, uint32_t newestWake, uint8_t* out, size_t capacity);
+};
+
+#endif
@@ -0,0 +1,106 @@
+#include "WakeMetrics.h"
+#include <cstring>
+
+PhaseTiming WakeMetrics::phases[WakeMetrics::MAX_PHASES] = {};
+size_t WakeMetrics::phaseCount = 0;
+unsigned long WakeMetrics::droppedPhases = 0;
+unsigned long WakeMetrics::counters[static_cast<int>(WakeCounter::COUNT)] = {};
+float WakeMetrics::batteryVolts = 0.0f;
+uint32_t WakeMetrics::wakeStartMs = 0;
+
+WakeMetrics::Phase::Phase(const char* name) : name(name), startMs(millis()), startMicros(micros()) {
+}
+
+WakeMetrics::Phase::~Phase() {
+    record(name, startMs, static_cast<uint32_t>(micros()) - startMicros);
+}
+
+void WakeMetrics::beginWake() {
+    phaseCount = 0;
+    droppedPhases = 0;
+    for (unsigned long& counter : counters) {
+        counter = 0;
+    }
+    batteryVolts = 0.0f;
+    wakeStartMs = millis();
+}
+
+void WakeMetrics::record(const char* name, uint32_t startMs, uint32_t durationMicros) {
+    PhaseTiming* phase = const_cast<PhaseTiming*>(findPhase(name));
+    if (!phase) {
+        if (phaseCount >= MAX_PHASES) {
+            droppedPhases++;
+            return;
+        }
+        phase = &phases[phaseCount++];
+        phase->name = name;
+        phase->count = 0;
+        phase->firstStartMs = startMs;
+        phase->totalMicros = 0;
+        phase->maxMicros = 0;
+    }
+
+    phase->count++;
+    phase->totalMicros += durationMicros;
+    phase->lastMicros = durationMicros;
+    if (durationMicros > phase->maxMicros) {
+        phase->maxMicros = durationMicros;
+    }
+}
+
+void WakeMetrics::count(WakeCounter counter) {
+    counters[static_cast<int>(counter)]++;
+}
+
+unsigned long WakeMetrics::getCount(WakeCounter counter) {
+    return counters[static_cast<int>(counter)];
+}
+
+const char* WakeMetrics::getCounterName(WakeCounter counter) {
+    switch (counter) {
+        case WakeCounter::WIFI_FAILURES: return "wifi";
+        case WakeCounter::HTTP_FAILURES: return "http";
+        case WakeCounter::IMAGE_FAILURES: return "image";
+        case WakeCounter::TIME_SYNC_FAILURES: return "sntp";
+        default: return "unknown";
+    }
+}
+
+const PhaseTiming* WakeMetrics::getPhase(size_t index) {
+    return index < phaseCount ? &phases[index] : nullptr;
+}
+
+const PhaseTiming* WakeMetrics::findPhase(const char* name) {
+    for (size_t i = 0; i < phaseCount; i++) {
+        if (phases[i].name == name || strcmp(phases[i].name, name) == 0) {
+            return &phases[i];
+        }
+    }
+    return nullptr;
+}
+
+uint32_t WakeMetrics::getAwakeMs() {
+    return static_cast<uint32_t>(millis()) - wakeStartMs;
+}
+
+void WakeMetrics::print(Print& out) {
+    out.printf("awake %lu ms, %u phases\n", static_cast<unsigned long>(getAwakeMs()),
+               static_cast<unsigned>(phaseCount));
+    out.printf("  %-16s %6s %8s %10s %10s %10s\n", "phase", "count", "start", "total ms", "max ms", "last ms");
+    for (size_t i = 0; i < phaseCount; i++) {
+        const PhaseTiming& phase = phases[i];
+        out.printf("  %-16s %6lu %8lu %10.1f %10.1f %10.1f\n", phase.name, phase.count,
+                   static_cast<unsigned long>(phase.firstStartMs - wakeStartMs),
+                   phase.totalMicros / 1000.0, phase.maxMicros / 1000.0, phase.lastMicros / 1000.0);
+    }
+    if (droppedPhases > 0) {
+        out.printf("  (%lu phase records dropped, table full)\n", droppedPhases);
+    }
+
+    out.printf("failures:");
+    for (int i = 0; i < static_cast<int>(WakeCounter::COUNT); i++) {
+        WakeCounter counter = static_cast<WakeCounter>(i);
+        out.printf(" %s %lu", getCounterName(counter), getCount(counter));
+    }
+    out.printf(", battery %.3f V\n", batteryVolts);
+}
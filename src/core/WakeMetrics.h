@@ -0,0 +1,90 @@
+#ifndef WAKE_METRICS_H
+#define WAKE_METRICS_H
+
+#include <Arduino.h>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Failures counted during a wake
+ */
+enum class WakeCounter : uint8_t {
+    WIFI_FAILURES = 0,      // Association attempts that timed out
+    HTTP_FAILURES,          // API requests without a 200 response
+    IMAGE_FAILURES,         // Image loads that failed every attempt
+    TIME_SYNC_FAILURES,     // configTime() rounds where no server answered
+    COUNT
+};
+
+/**
+ * Accumulated timing of one named phase of the current wake
+ */
+struct PhaseTiming {
+    const char* name;             // String literal passed to Phase
+    unsigned long count;
+    uint32_t firstStartMs;        // millis() when the phase first started
+    uint64_t totalMicros;
+    uint32_t maxMicros;
+    uint32_t lastMicros;
+};
+
+/**
+ * WakeMetrics times the phases of a wake (config load, WiFi, data fetch,
+ * full and partial renders, panel refreshes) and counts failures, so they
+ * can be read back over the serial console without a debugger and sent
+ * home as Telemetry.
+ *
+ * Phases are keyed by name: repeated phases (every partial render of an
+ * always-on unit) accumulate count, total, max and last duration. The table
+ * is fixed-size and allocation-free; phases beyond MAX_PHASES are dropped.
+ */
+class WakeMetrics {
+public:
+    static const size_t MAX_PHASES = 16;
+
+    class Phase {
+    public:
+        // name must outlive the wake (use a string literal)
+        explicit Phase(const char* name);
+        ~Phase();
+
+    private:
+        const char* name;
+        uint32_t startMs;
+        uint32_t startMicros;
+
+        Phase(const Phase&) = delete;
+        Phase& operator=(const Phase&) = delete;
+    };
+
+    // Start of setup(); forgets the previous wake
+    static void beginWake();
+
+    static void record(const char* name, uint32_t startMs, uint32_t durationMicros);
+    static void count(WakeCounter counter);
+    static void recordBattery(float volts) { batteryVolts = volts; }
+
+    static size_t getPhaseCount() { return phaseCount; }
+    static const PhaseTiming* getPhase(size_t index);
+    static const PhaseTiming* findPhase(const char* name);
+    static unsigned long getDroppedPhases() { return droppedPhases; }
+    static unsigned long getCount(WakeCounter counter);
+    static const char* getCounterName(WakeCounter counter);
+    // Last battery reading this wake (0 if none)
+    static float getBatteryVolts() { return batteryVolts; }
+
+    // millis() since beginWake()
+    static uint32_t getAwakeMs();
+
+    static void print(Print& out);
+
+private:
+    static PhaseTiming phases[MAX_PHASES];
+    static size_t phaseCount;
+    static unsigned long droppedPhases;
+    static unsigned long counters[static_cast<int>(WakeCounter::COUNT)];
+    static float batteryVolts;
+    static uint32_t wakeStartMs;
+};
+
+#endif
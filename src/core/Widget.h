@@ -25,6 +25,9 @@ public:
 
     // New compositor-based rendering method (default implementation for backward compatibility)
     virtual void renderToCompositor(Compositor& compositor, const LayoutRegion& region);
+    // Redraw in place only what changed since the last renderToCompositor(), without
+    // clearing the region; false if the widget can't, and the region is rendered in full
+    virtual bool updateOnCompositor(Compositor& compositor, const LayoutRegion& region) { return false; }
 
     // Virtual method for layout change notifications
     virtual void onRegionChanged(const LayoutRegion& oldRegion, const LayoutRegion& newRegion) {}
@@ -32,7 +35,11 @@ public:
     // Deep sleep optimization methods
     virtual void forceUpdate();
     virtual bool needsImmediateUpdate() const { return false; } // Most widgets don't need immediate updates
+    virtual bool isStatic() const { return false; } // Output depends only on the config (see StaticLayer)
     virtual void update();
+    // Called after the panel has been drawn from cached data: fetch anything
+    // stale and return true if what the widget shows has changed
+    virtual bool revalidate() { return false; }
 
 protected:
     Inkplate& display;
@@ -1,15 +1,24 @@
 #include "managers/LayoutManager.h"
 #include "managers/PowerManager.h"
+#include "core/BatteryHistory.h"
 #include "core/Logger.h"
+#include "core/MemoryTracker.h"
+#include "core/InputTrace.h"
+#include "core/SerialConsole.h"
+#include "core/Storage.h"
+#include "core/Telemetry.h"
+#include "core/WakeMetrics.h"
 #include <esp_sleep.h>
 #include <WiFi.h>
 
 LayoutManager layoutManager;
+SerialConsole console(Serial);
 
-void handleWakeButton();
+bool handleWakeButton();
 
 void setup() {
     Serial.begin(115200);
+    WakeMetrics::beginWake();
     delay(1000);
 
     // Initialize logger
@@ -19,6 +28,8 @@ void setup() {
 
     // Check wake reason to determine if this is a scheduled wake or button wake
     esp_sleep_wakeup_cause_t wakeup_reason = esp_sleep_get_wakeup_cause();
+    InputTrace::beginWake(static_cast<uint8_t>(wakeup_reason));
+    Telemetry::beginWake(static_cast<uint8_t>(wakeup_reason));
 
     switch(wakeup_reason) {
         case ESP_SLEEP_WAKEUP_EXT0:
@@ -40,7 +51,11 @@ void setup() {
     LOG_INFO("Main", "Button pins initialized: 36, 34, 39");
 
     // Initialize layout manager - this now does all the heavy lifting
-    layoutManager.begin();
+    {
+        WakeMetrics::Phase phase("setup");
+        layoutManager.begin();
+    }
+    layoutManager.registerConsoleCommands(console);
 
     // Demonstrate compositor integration (only on initial boot)
     if (wakeup_reason == ESP_SLEEP_WAKEUP_UNDEFINED) {
@@ -61,11 +76,17 @@ void setup() {
 }
 
 void loop() {
+    // Serial commands run outside the steady-state check since they may allocate
+    console.poll();
+
+    // Idle iterations must not leave allocations behind (checked when enabled)
+    MemoryTracker::beginSteadyState();
+
     // Handle button presses for manual refresh
-    handleWakeButton();
+    bool busy = handleWakeButton();
 
     // Let layout manager handle immediate updates and sleep preparation
-    layoutManager.loop();
+    busy = layoutManager.loop() || busy;
 
     // Simplified deep sleep logic - most work now done in setup()
     static unsigned long loopStartTime = millis();
@@ -82,11 +103,22 @@ void loop() {
         unsigned long currentTime = millis();
         unsigned long timeInLoop = currentTime - loopStartTime;
 
-        // Give some time for immediate updates, then sleep
-        if (timeInLoop > 30000) { // 30 seconds max in active loop
+        // Give some time for immediate updates, then sleep (stay up while the console is in use).
+        // Thin clients have no widgets to tick and sleep as soon as the frame is up.
+        unsigned long activeWindowMs = layoutManager.isThinClient() ? 0 : 30000;
+        if (timeInLoop > activeWindowMs && console.isIdle(30000)) {
             LOG_INFO("Main", "Entering deep sleep mode...");
             LOG_INFO("Main", "Next wake in: %lu ms", cachedUpdateInterval);
 
+            if (MemoryTracker::isEnabled()) {
+                MemoryTracker::logReport("pre-sleep");
+            }
+            layoutManager.runBackgroundWork();
+            Telemetry::endWake();
+            BatteryHistory::endWake();
+            InputTrace::finish(cachedUpdateInterval);
+            Storage::flush();
+
             // Setup wake sources
             int wakeButtonPin = layoutManager.getWakeButtonPin();
             PowerManager::enableWakeOnButton(wakeButtonPin);
@@ -102,14 +134,23 @@ void loop() {
     if (millis() - lastStatusPrint > 300000) { // 5 minutes
         LOG_INFO("Main", "Active mode - Free heap: %d bytes, Uptime: %lu seconds",
                  ESP.getFreeHeap(), millis() / 1000);
+        MemoryTracker::logReport("periodic");
         lastStatusPrint = millis();
+        busy = true;
+    }
+
+    // Only idle iterations are checked: updates may keep what they allocate (caches, drawn text)
+    if (busy) {
+        MemoryTracker::cancelSteadyState();
+    } else {
+        MemoryTracker::endSteadyState("idle loop");
     }
 
     // Small delay to prevent tight loop
     delay(1000);
 }
 
-void handleWakeButton() {
+bool handleWakeButton() {
     // Test multiple button pins
     bool button36 = digitalRead(36);
     bool button34 = digitalRead(34);
@@ -124,6 +165,11 @@ void handleWakeButton() {
 
     // Check any button press (LOW because of INPUT_PULLUP)
     static bool lastButton36 = HIGH, lastButton34 = HIGH, lastButton39 = HIGH;
+    bool changed = button36 != lastButton36 || button34 != lastButton34 || button39 != lastButton39;
+
+    if (button36 != lastButton36) InputTrace::recordButton(36, button36);
+    if (button34 != lastButton34) InputTrace::recordButton(34, button34);
+    if (button39 != lastButton39) InputTrace::recordButton(39, button39);
 
     if ((button36 == LOW && lastButton36 == HIGH) ||
         (button34 == LOW && lastButton34 == HIGH) ||
@@ -137,4 +183,5 @@ void handleWakeButton() {
     lastButton36 = button36;
     lastButton34 = button34;
     lastButton39 = button39;
+    return changed; // Recorded or refreshed
 }
@@ -0,0 +1,109 @@
+#include "BatteryManager.h"
+#include "../core/InputTrace.h"
+#include "../core/Logger.h"
+#include "../core/RtcState.h"
+#include "../core/WakeMetrics.h"
+#include <algorithm>
+
+bool BatteryManager::readingValid = false;
+unsigned long BatteryManager::readingMs = 0;
+float BatteryManager::voltage = 0.0f;
+int BatteryManager::percentage = 0;
+
+// Resting voltage of a single Li-ion cell against its remaining charge
+struct DischargePoint {
+    float volts;
+    int percent;
+};
+
+static const DischargePoint DISCHARGE_CURVE[] = {
+    {3.20f, 0},  {3.45f, 5},  {3.68f, 10}, {3.74f, 15}, {3.77f, 20}, {3.79f, 30},
+    {3.82f, 40}, {3.87f, 50}, {3.92f, 60}, {3.98f, 70}, {4.02f, 80}, {4.08f, 85},
+    {4.11f, 90}, {4.15f, 95}, {4.20f, 100},
+};
+static const int DISCHARGE_POINTS = sizeof(DISCHARGE_CURVE) / sizeof(DISCHARGE_CURVE[0]);
+
+// Inkplate 10: a MOSFET on the internal I/O expander switches the 1:2 divider onto GPIO 35
+static const uint8_t DIVIDER_PIN = 9;
+static const uint8_t BATTERY_PIN = 35;
+static const unsigned long DIVIDER_SETTLE_MS = 5;
+static const float DIVIDER_RATIO = 2.0f;
+
+// Kept in RTC memory, see RtcState.h
+static const uint32_t SHOWN_MAGIC = 0x42415431;  // "BAT1"
+
+struct BatteryShown {
+    uint32_t magic;
+    int32_t percent;
+};
+
+RTC_DATA_ATTR static BatteryShown shown;
+
+float BatteryManager::getVoltage(Inkplate& display) {
+    sample(display);
+    return voltage;
+}
+
+int BatteryManager::getPercentage(Inkplate& display) {
+    sample(display);
+    return percentage;
+}
+
+void BatteryManager::sample(Inkplate& display) {
+    if (readingValid && millis() - readingMs < MAX_AGE_MS) {
+        return;
+    }
+
+    // Divider on once for all samples. Older boards switch it with a PMOS
+    // whose gate idles high, so drive the opposite of what the pin reads.
+    uint8_t on = display.digitalReadIO(DIVIDER_PIN, IO_INT_ADDR) ? LOW : HIGH;
+    display.pinModeIO(DIVIDER_PIN, OUTPUT, IO_INT_ADDR);
+    display.digitalWriteIO(DIVIDER_PIN, on, IO_INT_ADDR);
+    delay(DIVIDER_SETTLE_MS);
+    float samples[SAMPLES];
+    for (int i = 0; i < SAMPLES; i++) {
+        samples[i] = analogReadMilliVolts(BATTERY_PIN) / 1000.0f * DIVIDER_RATIO;
+    }
+    display.pinModeIO(DIVIDER_PIN, INPUT, IO_INT_ADDR);
+    voltage = median(samples, SAMPLES);
+    readingMs = millis();
+    readingValid = true;
+    InputTrace::recordBattery(voltage);
+    WakeMetrics::recordBattery(voltage);
+
+    int curve = percentageForVoltage(voltage);
+    if (!RtcState::ensure(shown, SHOWN_MAGIC)) {
+        shown.percent = curve;
+    }
+    shown.percent = applyHysteresis(shown.percent, curve);
+    percentage = shown.percent;
+
+    LOG_DEBUG("BatteryManager", "%.3fV (median of %d) -> %d%%, shown %d%%", voltage, SAMPLES, curve, percentage);
+}
+
+int BatteryManager::percentageForVoltage(float volts) {
+    if (volts <= DISCHARGE_CURVE[0].volts) return 0;
+    for (int i = 1; i < DISCHARGE_POINTS; i++) {
+        const DischargePoint& low = DISCHARGE_CURVE[i - 1];
+        const DischargePoint& high = DISCHARGE_CURVE[i];
+        if (volts < high.volts) {
+            float t = (volts - low.volts) / (high.volts - low.volts);
+            return low.percent + static_cast<int>(t * (high.percent - low.percent));
+        }
+    }
+    return 100;
+}
+
+int BatteryManager::applyHysteresis(int shownPercent, int curvePercent) {
+    // Empty and full are always shown as soon as they are reached
+    if (curvePercent == 0 || curvePercent == 100) return curvePercent;
+    if (curvePercent > shownPercent - HYSTERESIS_PERCENT && curvePercent < shownPercent + HYSTERESIS_PERCENT) {
+        return shownPercent;
+    }
+    return curvePercent;
+}
+
+float BatteryManager::median(float* samples, int count) {
+    std::sort(samples, samples + count);
+    return count % 2 ? samples[count / 2] : (samples[count / 2 - 1] + samples[count / 2]) / 2;
+}
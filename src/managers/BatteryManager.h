@@ -0,0 +1,49 @@
+#ifndef BATTERY_MANAGER_H
+#define BATTERY_MANAGER_H
+
+#include <Inkplate.h>
+
+/**
+ * The battery reading for everything that shows or logs it.
+ *
+ * Inkplate::readBattery() switches the divider on, waits and samples the
+ * ADC once, so calling it per sample would toggle the MOSFET every time.
+ * The first request of a wake instead switches the divider on once, takes
+ * SAMPLES ADC reads back to back and keeps the median, which drops the odd
+ * one taken while WiFi or the panel draws current. Later requests get the
+ * cached value; a device kept awake reads again after MAX_AGE_MS.
+ *
+ * The charge comes from a Li-ion discharge curve (resting voltage of one
+ * cell, interpolated between points) instead of a straight line. The
+ * shown percentage only moves once the curve is HYSTERESIS_PERCENT away
+ * from it, so a voltage wobbling around a step doesn't change the screen
+ * every wake; it is kept in RTC memory across deep sleep.
+ */
+class BatteryManager {
+public:
+    static const int SAMPLES = 5;
+    static const int HYSTERESIS_PERCENT = 3;
+    static const unsigned long MAX_AGE_MS = 600000; // 10 minutes
+
+    static float getVoltage(Inkplate& display);
+    static int getPercentage(Inkplate& display);
+    static bool hasReading() { return readingValid; }
+
+    // Forget the cached reading (the next request reads the ADC again)
+    static void invalidate() { readingValid = false; }
+
+    // Made public for testing
+    static int percentageForVoltage(float volts);
+    static int applyHysteresis(int shown, int percentage);
+    static float median(float* samples, int count);
+
+private:
+    static bool readingValid;
+    static unsigned long readingMs;
+    static float voltage;
+    static int percentage;
+
+    static void sample(Inkplate& display);
+};
+
+#endif
@@ -1,7 +1,7 @@
 #include "ConfigManager.h"
 #include "../core/Logger.h"
-#include <FS.h>
-#include <SPIFFS.h>
+#include "../core/MemoryTracker.h"
+#include "../core/Storage.h"
 
 // WidgetTypeRegistry implementation using template-based type traits
 WidgetType WidgetTypeRegistry::fromString(const String& typeStr) {
@@ -12,6 +12,8 @@ WidgetType WidgetTypeRegistry::fromString(const String& typeStr) {
     if (typeStr == WidgetTypeTraits<BatteryWidget>::name()) return WidgetTypeTraits<BatteryWidget>::type();
     if (typeStr == WidgetTypeTraits<ImageWidget>::name()) return WidgetTypeTraits<ImageWidget>::type();
     if (typeStr == WidgetTypeTraits<LayoutWidget>::name()) return WidgetTypeTraits<LayoutWidget>::type();
+    if (typeStr == WidgetTypeTraits<ChartWidget>::name()) return WidgetTypeTraits<ChartWidget>::type();
+    if (typeStr == WidgetTypeTraits<CalendarWidget>::name()) return WidgetTypeTraits<CalendarWidget>::type();
     return WidgetType::UNKNOWN;
 }
 
@@ -23,36 +25,55 @@ String WidgetTypeRegistry::toString(WidgetType type) {
         case WidgetType::BATTERY: return WidgetTypeTraits<BatteryWidget>::name();
         case WidgetType::IMAGE: return WidgetTypeTraits<ImageWidget>::name();
         case WidgetType::LAYOUT: return WidgetTypeTraits<LayoutWidget>::name();
+        case WidgetType::CHART: return WidgetTypeTraits<ChartWidget>::name();
+        case WidgetType::CALENDAR: return WidgetTypeTraits<CalendarWidget>::name();
         default: return "unknown";
     }
 }
 
+/**
+ * Print that only hashes what is written to it (32-bit FNV-1a)
+ */
+class HashPrint : public Print {
+public:
+    uint32_t hash = 2166136261u;
+
+    size_t write(uint8_t c) override {
+        hash = (hash ^ c) * 16777619u;
+        return 1;
+    }
+};
+
+static uint32_t hashDocument(const JsonDocument& doc) {
+    HashPrint hasher;
+    serializeJson(doc, hasher);
+    return hasher.hash;
+}
+
 ConfigManager::ConfigManager() : configFileExists(false) {
     setDefaults();
 }
 
 bool ConfigManager::begin() {
-    if (!SPIFFS.begin(true)) {
-        LOG_ERROR("ConfigManager", "Failed to mount SPIFFS");
+    if (!Storage::begin()) {
+        LOG_ERROR("ConfigManager", "Failed to mount internal storage");
         return false;
     }
 
-    LOG_INFO("ConfigManager", "SPIFFS mounted successfully");
-
     return loadConfig();
 }
 
 bool ConfigManager::loadConfig() {
     LOG_DEBUG("ConfigManager", "Looking for config file: %s", CONFIG_FILE);
 
-    configFileExists = SPIFFS.exists(CONFIG_FILE);
+    configFileExists = Storage::exists(StorageUse::CONFIG, CONFIG_FILE);
 
     if (!configFileExists) {
         LOG_WARN("ConfigManager", "Config file %s not found, using defaults", CONFIG_FILE);
         return saveConfig(); // Create default config file
     }
 
-    fs::File file = SPIFFS.open(CONFIG_FILE, "r");
+    fs::File file = Storage::open(StorageUse::CONFIG, CONFIG_FILE, "r");
     if (!file) {
         LOG_ERROR("ConfigManager", "Failed to open config file: %s", CONFIG_FILE);
         return false;
@@ -60,9 +81,11 @@ bool ConfigManager::loadConfig() {
 
     LOG_DEBUG("ConfigManager", "Config file opened successfully, size: %d bytes", file.size());
 
+    MemoryTracker::Scope memoryScope(MemorySubsystem::JSON);
     JsonDocument doc;
     DeserializationError error = deserializeJson(doc, file);
     file.close();
+    memoryScope.checkpoint();
 
     if (error) {
         LOG_ERROR("ConfigManager", "Failed to parse config file: %s", error.c_str());
@@ -73,6 +96,10 @@ bool ConfigManager::loadConfig() {
     config.wifiSSID = doc["Wifi"]["SSID"] | "YOUR_WIFI_SSID";
     config.wifiPassword = doc["Wifi"]["Password"] | "YOUR_WIFI_PASSWORD";
     config.serverURL = doc["Server"]["Url"] | "http://example.com/image.jpg";
+    config.sendTelemetry = doc["Server"]["Telemetry"] | false;
+    config.telemetryChars = doc["Server"]["TelemetryChars"] | 120;
+    config.frameURL = doc["Server"]["FrameUrl"] | "";
+    config.frameRefreshMs = doc["Server"]["FrameRefreshMs"] | 3600000UL;
 
     // Clear existing widget configurations
     config.weatherWidgets.clear();
@@ -81,6 +108,8 @@ bool ConfigManager::loadConfig() {
     config.batteryWidgets.clear();
     config.imageWidgets.clear();
     config.layoutWidgets.clear();
+    config.chartWidgets.clear();
+    config.calendarWidgets.clear();
 
     // Parse widgets array
     JsonArray widgets = doc["Widgets"];
@@ -140,6 +169,26 @@ bool ConfigManager::loadConfig() {
                 break;
             }
 
+            case WidgetType::CHART: {
+                ChartWidgetConfig chartConfig;
+                chartConfig.region = widget["region"] | "";
+                chartConfig.hours = widget["hours"] | 24;
+                chartConfig.chartUpdateMs = widget["chartUpdateMs"] | 3600000UL;
+                config.chartWidgets.push_back(chartConfig);
+                break;
+            }
+
+            case WidgetType::CALENDAR: {
+                CalendarWidgetConfig calendarConfig;
+                calendarConfig.region = widget["region"] | "";
+                calendarConfig.source = widget["source"] | "";
+                calendarConfig.events = widget["events"] | 5;
+                calendarConfig.days = widget["days"] | 7;
+                calendarConfig.calendarUpdateMs = widget["calendarUpdateMs"] | 1800000UL;
+                config.calendarWidgets.push_back(calendarConfig);
+                break;
+            }
+
             case WidgetType::LAYOUT: {
                 LayoutWidgetConfig layoutConfig;
                 // No region assignment - LayoutWidget is global
@@ -172,6 +221,7 @@ bool ConfigManager::loadConfig() {
         regionConfig.y = regionObj["Y"] | 0;
         regionConfig.width = regionObj["Width"] | 300;
         regionConfig.height = regionObj["Height"] | 300;
+        regionConfig.isStatic = regionObj["Static"] | false;
 
         config.regions[regionId] = regionConfig;
     }
@@ -190,13 +240,29 @@ bool ConfigManager::loadConfig() {
 
     // Debug configuration
     config.showDebugOnScreen = doc["Debug"]["ShowOnScreen"] | false;
+    config.trackMemory = doc["Debug"]["TrackMemory"] | false;
+    config.assertSteadyStateAllocations = doc["Debug"]["AssertSteadyState"] | false;
+    config.recordInputs = doc["Debug"]["RecordInputs"] | false;
+    config.traceBytes = doc["Debug"]["TraceBytes"] | 65536;
+
+    // Storage configuration
+    config.imageCacheStorage = doc["Storage"]["ImageCache"] | "internal";
+    config.imageCacheKB = doc["Storage"]["ImageCacheKB"] | 512;
+    config.logStorage = doc["Storage"]["Logs"] | "internal";
+    config.logKB = doc["Storage"]["LogsKB"] | 0;
+
+    config.configHash = hashDocument(doc);
 
     LOG_INFO("ConfigManager", "Configuration loaded successfully");
     LOG_INFO("ConfigManager", "WiFi SSID: %s", config.wifiSSID.c_str());
     LOG_INFO("ConfigManager", "Server URL: %s", config.serverURL.c_str());
-    LOG_INFO("ConfigManager", "Loaded %d weather, %d name, %d dateTime, %d battery, %d image widgets",
+    if (!config.frameURL.isEmpty()) {
+        LOG_INFO("ConfigManager", "Frame URL: %s (thin client)", config.frameURL.c_str());
+    }
+    LOG_INFO("ConfigManager", "Loaded %d weather, %d name, %d dateTime, %d battery, %d image, %d chart, %d calendar widgets",
              config.weatherWidgets.size(), config.nameWidgets.size(), config.dateTimeWidgets.size(),
-             config.batteryWidgets.size(), config.imageWidgets.size());
+             config.batteryWidgets.size(), config.imageWidgets.size(), config.chartWidgets.size(),
+             config.calendarWidgets.size());
     LOG_INFO("ConfigManager", "Loaded %d regions", config.regions.size());
 
     return true;
@@ -211,6 +277,10 @@ bool ConfigManager::saveConfig() {
 
     // Server configuration
     doc["Server"]["Url"] = config.serverURL;
+    doc["Server"]["Telemetry"] = config.sendTelemetry;
+    doc["Server"]["TelemetryChars"] = config.telemetryChars;
+    doc["Server"]["FrameUrl"] = config.frameURL;
+    doc["Server"]["FrameRefreshMs"] = config.frameRefreshMs;
 
     // Widgets array
     JsonArray widgets = doc["Widgets"].to<JsonArray>();
@@ -253,6 +323,24 @@ bool ConfigManager::saveConfig() {
         widget["ImageWidget"]["imageRefreshMs"] = image.imageRefreshMs;
     }
 
+    // Add chart widgets
+    for (const auto& chart : config.chartWidgets) {
+        JsonObject widget = widgets.add<JsonObject>();
+        widget["ChartWidget"]["region"] = chart.region;
+        widget["ChartWidget"]["hours"] = chart.hours;
+        widget["ChartWidget"]["chartUpdateMs"] = chart.chartUpdateMs;
+    }
+
+    // Add calendar widgets
+    for (const auto& calendar : config.calendarWidgets) {
+        JsonObject widget = widgets.add<JsonObject>();
+        widget["CalendarWidget"]["region"] = calendar.region;
+        widget["CalendarWidget"]["source"] = calendar.source;
+        widget["CalendarWidget"]["events"] = calendar.events;
+        widget["CalendarWidget"]["days"] = calendar.days;
+        widget["CalendarWidget"]["calendarUpdateMs"] = calendar.calendarUpdateMs;
+    }
+
     // Layout configuration
     JsonObject layout = doc["Layout"].to<JsonObject>();
     for (const auto& regionPair : config.regions) {
@@ -261,6 +349,9 @@ bool ConfigManager::saveConfig() {
         regionObj["Y"] = regionPair.second.y;
         regionObj["Width"] = regionPair.second.width;
         regionObj["Height"] = regionPair.second.height;
+        if (regionPair.second.isStatic) {
+            regionObj["Static"] = true;
+        }
     }
 
     // Display configuration
@@ -277,8 +368,18 @@ bool ConfigManager::saveConfig() {
 
     // Debug configuration
     doc["Debug"]["ShowOnScreen"] = config.showDebugOnScreen;
-
-    fs::File file = SPIFFS.open(CONFIG_FILE, "w");
+    doc["Debug"]["TrackMemory"] = config.trackMemory;
+    doc["Debug"]["AssertSteadyState"] = config.assertSteadyStateAllocations;
+    doc["Debug"]["RecordInputs"] = config.recordInputs;
+    doc["Debug"]["TraceBytes"] = config.traceBytes;
+
+    // Storage configuration
+    doc["Storage"]["ImageCache"] = config.imageCacheStorage;
+    doc["Storage"]["ImageCacheKB"] = config.imageCacheKB;
+    doc["Storage"]["Logs"] = config.logStorage;
+    doc["Storage"]["LogsKB"] = config.logKB;
+
+    fs::File file = Storage::open(StorageUse::CONFIG, CONFIG_FILE, "w");
     if (!file) {
         LOG_ERROR("ConfigManager", "Failed to create config file");
         return false;
@@ -299,6 +400,10 @@ void ConfigManager::setDefaults() {
     config.wifiSSID = "YOUR_WIFI_SSID";
     config.wifiPassword = "YOUR_WIFI_PASSWORD";
     config.serverURL = "http://example.com/image.jpg";
+    config.sendTelemetry = false;
+    config.telemetryChars = 120;
+    config.frameURL = "";
+    config.frameRefreshMs = 3600000UL;
 
     // Clear widget collections
     config.weatherWidgets.clear();
@@ -307,7 +412,10 @@ void ConfigManager::setDefaults() {
     config.batteryWidgets.clear();
     config.imageWidgets.clear();
     config.layoutWidgets.clear();
+    config.chartWidgets.clear();
+    config.calendarWidgets.clear();
     config.regions.clear();
+    config.configHash = 0;
 
     config.displayWidth = 1200;
     config.displayHeight = 825;
@@ -319,6 +427,15 @@ void ConfigManager::setDefaults() {
     config.deepSleepThresholdMs = 600000UL; // 10 minutes
 
     config.showDebugOnScreen = false;
+    config.trackMemory = false;
+    config.assertSteadyStateAllocations = false;
+    config.recordInputs = false;
+    config.traceBytes = 65536;
+
+    config.imageCacheStorage = "internal";
+    config.imageCacheKB = 512;
+    config.logStorage = "internal";
+    config.logKB = 0;
 }
 bool ConfigManager::isConfigured() const {
     // Check if config file existed when loaded
@@ -339,8 +456,9 @@ bool ConfigManager::isConfigured() const {
         return false;
     }
 
-    if (config.serverURL == "http://example.com/image.jpg" ||
-        config.serverURL.isEmpty()) {
+    // A frame server replaces the image server in thin-client mode
+    if ((config.serverURL == "http://example.com/image.jpg" ||
+         config.serverURL.isEmpty()) && config.frameURL.isEmpty()) {
         return false;
     }
 
@@ -364,8 +482,8 @@ String ConfigManager::getConfigurationError() const {
         return "WiFi password not configured. Please update your configuration.";
     }
 
-    if (config.serverURL == "http://example.com/image.jpg" ||
-        config.serverURL.isEmpty()) {
+    if ((config.serverURL == "http://example.com/image.jpg" ||
+         config.serverURL.isEmpty()) && config.frameURL.isEmpty()) {
         return "Image server URL not configured. Please update your configuration.";
     }
 
@@ -384,5 +502,6 @@ RegionConfig ConfigManager::getRegionConfig(const String& regionId) const {
     defaultConfig.y = 0;
     defaultConfig.width = 300;
     defaultConfig.height = 300;
+    defaultConfig.isStatic = false;
     return defaultConfig;
 }
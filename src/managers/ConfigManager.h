@@ -13,6 +13,8 @@ enum class WidgetType {
     BATTERY,
     IMAGE,
     LAYOUT,
+    CHART,
+    CALENDAR,
     UNKNOWN
 };
 
@@ -23,6 +25,8 @@ class TimeWidget;
 class BatteryWidget;
 class ImageWidget;
 class LayoutWidget;
+class ChartWidget;
+class CalendarWidget;
 
 // Macro to automatically generate widget type traits (like nameof)
 #define DECLARE_WIDGET_TYPE(WidgetClass, TypeName, EnumValue) \
@@ -50,6 +54,8 @@ DECLARE_WIDGET_TYPE(TimeWidget, "TimeWidget", WidgetType::DATE_TIME)
 DECLARE_WIDGET_TYPE(BatteryWidget, "BatteryWidget", WidgetType::BATTERY)
 DECLARE_WIDGET_TYPE(ImageWidget, "ImageWidget", WidgetType::IMAGE)
 DECLARE_WIDGET_TYPE(LayoutWidget, "LayoutWidget", WidgetType::LAYOUT)
+DECLARE_WIDGET_TYPE(ChartWidget, "ChartWidget", WidgetType::CHART)
+DECLARE_WIDGET_TYPE(CalendarWidget, "CalendarWidget", WidgetType::CALENDAR)
 
 // Widget type string mapping
 class WidgetTypeRegistry {
@@ -101,6 +107,20 @@ struct ImageWidgetConfig {
     unsigned long imageRefreshMs;
 };
 
+struct ChartWidgetConfig {
+    String region;
+    int hours;                          // Columns, one per hour
+    unsigned long chartUpdateMs;
+};
+
+struct CalendarWidgetConfig {
+    String region;
+    String source;                      // iCalendar URL, or a file on config storage ("/cal.ics")
+    int events;                         // Most events shown
+    int days;                           // Days ahead to show
+    unsigned long calendarUpdateMs;
+};
+
 struct LayoutWidgetConfig {
     // No region field - LayoutWidget is global and not assigned to a specific region
     bool showRegionBorders;
@@ -117,6 +137,7 @@ struct RegionConfig {
     int y;
     int width;
     int height;
+    bool isStatic;                      // Drawn once into the static layer (StaticLayer)
 };
 
 // Main application configuration
@@ -127,6 +148,10 @@ struct AppConfig {
 
     // Server Configuration
     String serverURL;
+    bool sendTelemetry;                 // Append recent wake metrics to image requests
+    unsigned long telemetryChars;       // Cap on the telemetry query parameter
+    String frameURL;                    // Thin-client mode: pre-composed panel frames (empty = off)
+    unsigned long frameRefreshMs;       // Sleep between frames unless the server says otherwise
 
     // Widget Configurations
     std::vector<WeatherWidgetConfig> weatherWidgets;
@@ -135,10 +160,15 @@ struct AppConfig {
     std::vector<BatteryWidgetConfig> batteryWidgets;
     std::vector<ImageWidgetConfig> imageWidgets;
     std::vector<LayoutWidgetConfig> layoutWidgets;
+    std::vector<ChartWidgetConfig> chartWidgets;
+    std::vector<CalendarWidgetConfig> calendarWidgets;
 
     // Layout Configuration (region_id -> RegionConfig)
     std::map<String, RegionConfig> regions;
 
+    // FNV-1a of the parsed config; keys anything rendered from it
+    uint32_t configHash;
+
     // Display Configuration
     int displayWidth;
     int displayHeight;
@@ -153,6 +183,16 @@ struct AppConfig {
 
     // Debug Configuration
     bool showDebugOnScreen;
+    bool trackMemory;                   // Attribute heap usage to subsystems
+    bool assertSteadyStateAllocations;  // Flag allocations in idle loop iterations
+    bool recordInputs;                  // Save this wake's external inputs to /trace.bin
+    unsigned long traceBytes;           // Trace buffer budget (PSRAM)
+
+    // Storage Configuration ("internal" or "sd"; quotas in KB, 0 = none)
+    String imageCacheStorage;
+    unsigned long imageCacheKB;
+    String logStorage;
+    unsigned long logKB;
 };
 
 class ConfigManager {
@@ -176,6 +216,8 @@ public:
     const std::vector<BatteryWidgetConfig>& getBatteryWidgets() const { return config.batteryWidgets; }
     const std::vector<ImageWidgetConfig>& getImageWidgets() const { return config.imageWidgets; }
     const std::vector<LayoutWidgetConfig>& getLayoutWidgets() const { return config.layoutWidgets; }
+    const std::vector<ChartWidgetConfig>& getChartWidgets() const { return config.chartWidgets; }
+    const std::vector<CalendarWidgetConfig>& getCalendarWidgets() const { return config.calendarWidgets; }
 
     // Region access helpers
     const std::map<String, RegionConfig>& getRegions() const { return config.regions; }
@@ -1,6 +1,7 @@
 #include "DisplayManager.h"
 #include "../core/Logger.h"
 #include "../core/Compositor.h"
+#include "../core/WakeMetrics.h"
 
 DisplayManager::DisplayManager(Inkplate &display) : display(display), preferredDisplayMode(INKPLATE_3BIT), compositor(nullptr), debugModeEnabled(false), debugLineCount(0), debugStartY(700) {}
 
@@ -65,6 +66,7 @@ void DisplayManager::clear() {
 
 void DisplayManager::update() {
     LOG_DEBUG("DisplayManager", "Performing full display update...");
+    WakeMetrics::Phase phase("panel.full");
     display.display();
     LOG_DEBUG("DisplayManager", "Display update complete");
 }
@@ -78,7 +80,10 @@ void DisplayManager::partialUpdate() {
         display.setDisplayMode(INKPLATE_1BIT);
     }
 
-    display.partialUpdate();
+    {
+        WakeMetrics::Phase phase("panel.partial");
+        display.partialUpdate();
+    }
 
     // Switch back to preferred mode
     if (preferredDisplayMode != INKPLATE_1BIT) {
@@ -104,7 +109,10 @@ void DisplayManager::smartPartialUpdate() {
     }
 
     // Perform partial update
-    display.partialUpdate();
+    {
+        WakeMetrics::Phase phase("panel.partial");
+        display.partialUpdate();
+    }
 
     // Restore original mode
     if (currentMode != INKPLATE_1BIT) {
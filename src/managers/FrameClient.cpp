@@ -0,0 +1,198 @@
+#include "FrameClient.h"
+#include "../core/Logger.h"
+#include "../core/MemoryTracker.h"
+#include "../core/InputTrace.h"
+#include "../core/Telemetry.h"
+#include "../core/WakeMetrics.h"
+#include <HTTPClient.h>
+
+// Frame on the panel, survives deep sleep (0 after power-on)
+RTC_DATA_ATTR static uint32_t shownFrameId = 0;
+
+FrameClient::FrameClient(Inkplate& display, const char* frameUrl, unsigned long defaultSleepMs)
+    : display(display), frameUrl(frameUrl), defaultSleepMs(defaultSleepMs), sleepMs(0),
+      lastFrameBytes(0), lastRectCount(0) {}
+
+uint32_t FrameClient::getShownFrameId() {
+    return shownFrameId;
+}
+
+void FrameClient::forgetShownFrame() {
+    shownFrameId = 0;
+}
+
+unsigned long FrameClient::getSleepMs() const {
+    return sleepMs > 0 ? sleepMs : defaultSleepMs;
+}
+
+bool FrameClient::update() {
+    lastFrameBytes = 0;
+    lastRectCount = 0;
+    uint32_t since = shownFrameId;
+
+    // A delta for some other base frame is retried once as a full frame
+    for (int attempt = 0; attempt < 2; attempt++) {
+        int status = 0;
+        uint8_t* body = nullptr;
+        size_t length = 0;
+        size_t capacity = 0;
+        bool fetched;
+        {
+            WakeMetrics::Phase phase("fetch");
+            fetched = fetch(since, status, body, length, capacity);
+        }
+
+        if (status == HTTP_CODE_NOT_MODIFIED) {
+            LOG_INFO("FrameClient", "Frame %u is current", shownFrameId);
+            return true;
+        }
+        if (!fetched) {
+            WakeMetrics::count(WakeCounter::HTTP_FAILURES);
+            LOG_ERROR("FrameClient", "Frame request failed: %d", status);
+            return false;
+        }
+        lastFrameBytes = length;
+
+        PanelFrame frame;
+        if (!frame.parse(body, length)) {
+            MemoryTracker::release(MemorySubsystem::NETWORK, body, capacity);
+            WakeMetrics::count(WakeCounter::IMAGE_FAILURES);
+            LOG_ERROR("FrameClient", "Malformed frame (%zu bytes)", length);
+            return false;
+        }
+
+        const PanelFrameHeader& header = frame.getHeader();
+        if (header.sleepSeconds > 0) {
+            sleepMs = header.sleepSeconds * 1000UL;
+        }
+
+        if (frame.isDelta() && header.baseId != shownFrameId) {
+            MemoryTracker::release(MemorySubsystem::NETWORK, body, capacity);
+            LOG_WARN("FrameClient", "Delta for frame %u but frame %u is shown, requesting a full frame",
+                     header.baseId, shownFrameId);
+            since = 0;
+            continue;
+        }
+
+        bool presented = present(frame);
+        MemoryTracker::release(MemorySubsystem::NETWORK, body, capacity);
+        return presented;
+    }
+    return false;
+}
+
+bool FrameClient::fetch(uint32_t since, int& status, uint8_t*& body, size_t& length, size_t& capacity) {
+    String url = frameUrl;
+    url += strchr(frameUrl, '?') ? "&since=" : "?since=";
+    url += String(since);
+
+    HTTPClient http;
+    http.begin(Telemetry::appendToUrl(url.c_str()));
+    http.setTimeout(10000);
+    http.setReuse(false);
+    // The body straight off the socket, without chunked framing
+    http.useHTTP10(true);
+
+    unsigned long requestStart = millis();
+    status = http.GET();
+    InputTrace::recordHttpStart(requestStart, url.c_str(), status, String());
+    if (status != HTTP_CODE_OK) {
+        http.end();
+        return false;
+    }
+
+    // -1 when the server did not send a length: read until it closes
+    int size = http.getSize();
+    if (size == 0 || (size > 0 && static_cast<size_t>(size) > MAX_FRAME_BYTES)) {
+        LOG_ERROR("FrameClient", "Frame size %d outside 1..%zu bytes", size, MAX_FRAME_BYTES);
+        http.end();
+        return false;
+    }
+    capacity = size > 0 ? static_cast<size_t>(size) : MAX_FRAME_BYTES;
+
+    // Frames go to PSRAM; the internal heap only sees the HTTP client
+    body = static_cast<uint8_t*>(MemoryTracker::allocate(MemorySubsystem::NETWORK, capacity, true));
+    if (!body) {
+        LOG_ERROR("FrameClient", "No memory for a %zu byte frame", capacity);
+        http.end();
+        return false;
+    }
+
+    Stream& stream = http.getStream();
+    length = stream.readBytes(body, capacity);
+    InputTrace::recordHttpBody(body, length);
+    bool overflow = size < 0 && length == capacity && stream.available() > 0;
+    http.end();
+    if ((size > 0 && length != capacity) || length == 0 || overflow) {
+        if (overflow) {
+            LOG_ERROR("FrameClient", "Frame larger than %zu bytes", MAX_FRAME_BYTES);
+        } else {
+            LOG_ERROR("FrameClient", "Frame cut short: %zu of %d bytes", length, size);
+        }
+        MemoryTracker::release(MemorySubsystem::NETWORK, body, capacity);
+        body = nullptr;
+        return false;
+    }
+    return true;
+}
+
+bool FrameClient::present(const PanelFrame& frame) {
+    const PanelFrameHeader& header = frame.getHeader();
+    if (header.width != display.width() || header.height != display.height()) {
+        LOG_ERROR("FrameClient", "Frame is %ux%u, panel is %dx%d", header.width, header.height,
+                  display.width(), display.height());
+        return false;
+    }
+
+    lastRectCount = frame.getRectCount();
+    if ((frame.isDelta() && lastRectCount == 0) || (!frame.isDelta() && header.frameId == shownFrameId)) {
+        LOG_INFO("FrameClient", "Frame %u already shown", header.frameId);
+        shownFrameId = header.frameId;
+        return true;
+    }
+
+    if (!frame.isDelta()) {
+        {
+            WakeMetrics::Phase phase("render.full");
+            display.setDisplayMode(header.mode);
+            display.clearDisplay();
+            uint8_t* buffer = header.mode == INKPLATE_1BIT ? display._partial : display.DMemory4Bit;
+            for (size_t i = 0; i < frame.getRectCount(); i++) {
+                if (!frame.unpack(i, false, buffer)) {
+                    LOG_ERROR("FrameClient", "Rect %zu of frame %u is corrupt", i, header.frameId);
+                    return false;
+                }
+            }
+        }
+        WakeMetrics::Phase phase("panel.full");
+        display.display();
+    } else {
+        {
+            // The driver forgot the panel contents in deep sleep: take what the
+            // dirty rects show now as the shown image, then draw the new rects
+            WakeMetrics::Phase phase("render.partial");
+            display.setDisplayMode(INKPLATE_1BIT);
+            display.clearDisplay();
+            for (size_t i = 0; i < frame.getRectCount(); i++) {
+                if (!frame.unpack(i, true, display._partial)) {
+                    LOG_ERROR("FrameClient", "Rect %zu of delta %u is corrupt", i, header.frameId);
+                    return false;
+                }
+            }
+            display.preloadScreen();
+            for (size_t i = 0; i < frame.getRectCount(); i++) {
+                if (!frame.unpack(i, false, display._partial)) {
+                    LOG_ERROR("FrameClient", "Rect %zu of delta %u is corrupt", i, header.frameId);
+                    return false;
+                }
+            }
+        }
+        WakeMetrics::Phase phase("panel.partial");
+        display.partialUpdate(true);
+    }
+
+    LOG_INFO("FrameClient", "Showing frame %u (%s, %zu rects, %zu bytes)", header.frameId,
+             frame.isDelta() ? "partial" : "full", lastRectCount, lastFrameBytes);
+    shownFrameId = header.frameId;
+    return true;
+}
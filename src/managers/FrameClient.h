@@ -0,0 +1,50 @@
+#ifndef FRAME_CLIENT_H
+#define FRAME_CLIENT_H
+
+#include <Inkplate.h>
+#include "../core/PanelFrame.h"
+
+/**
+ * Thin-client mode: instead of running widgets, ask the frame server for
+ * the whole screen as one PanelFrame and present it as is.
+ *
+ * Each request carries the id of the frame on the panel (kept in RTC
+ * memory) as "since", so the server can answer with only the rects that
+ * changed, drawn with a partial update. After a power-on, or when the
+ * server has nothing newer, it sends a full frame or an empty one. The
+ * frame also tells the device how long to sleep.
+ */
+class FrameClient {
+public:
+    static const size_t MAX_FRAME_BYTES = 256 * 1024;
+
+    FrameClient(Inkplate& display, const char* frameUrl, unsigned long defaultSleepMs);
+
+    // Fetch and present the current frame; false leaves the panel untouched
+    bool update();
+
+    // Server's requested sleep, or the configured interval
+    unsigned long getSleepMs() const;
+
+    // Frame on the panel; 0 after power-on
+    static uint32_t getShownFrameId();
+    static void forgetShownFrame(); // Made public for testing
+
+    // Last update: bytes downloaded and rects drawn
+    size_t getLastFrameBytes() const { return lastFrameBytes; }
+    size_t getLastRectCount() const { return lastRectCount; }
+
+private:
+    Inkplate& display;
+    const char* frameUrl;
+    unsigned long defaultSleepMs;
+    unsigned long sleepMs;
+    size_t lastFrameBytes;
+    size_t lastRectCount;
+
+    // Body (capacity bytes allocated in PSRAM, caller releases) when the server answers 200
+    bool fetch(uint32_t since, int& status, uint8_t*& body, size_t& length, size_t& capacity);
+    bool present(const PanelFrame& frame);
+};
+
+#endif
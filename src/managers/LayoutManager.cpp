@@ -1,11 +1,26 @@
 #include "LayoutManager.h"
+#include "FrameClient.h"
+#include "BatteryManager.h"
+#include "PowerManager.h"
+#include "../core/AssetPack.h"
+#include "../core/BackgroundWork.h"
 #include "../core/Logger.h"
+#include "../core/MemoryTracker.h"
+#include "../core/InputTrace.h"
+#include "../core/SerialConsole.h"
+#include "../core/StaticLayer.h"
+#include "../core/Storage.h"
+#include "../core/Telemetry.h"
+#include "../core/WakeMetrics.h"
 #include "../widgets/image/ImageWidget.h"
 #include "../widgets/battery/BatteryWidget.h"
 #include "../widgets/time/TimeWidget.h"
 #include "../widgets/weather/WeatherWidget.h"
+#include "../widgets/chart/ChartWidget.h"
+#include "../widgets/calendar/CalendarWidget.h"
 #include "../widgets/name/NameWidget.h"
 #include "../widgets/layout/LayoutWidget.h"
+#include <strings.h>
 
 // Helper function for C++11 compatibility (make_unique not available until C++14)
 template<typename T, typename... Args>
@@ -14,7 +29,7 @@ std::unique_ptr<T> make_unique_helper(Args&&... args) {
 }
 
 LayoutManager::LayoutManager()
-    : display(INKPLATE_3BIT), lastUpdate(0), layoutWidget(nullptr), compositor(nullptr), debugModeEnabled(false) {
+    : display(INKPLATE_3BIT), lastUpdate(0), layoutWidget(nullptr), compositor(nullptr), frameClient(nullptr), staticLayer(nullptr), debugModeEnabled(false) {
 
     // Initialize config manager
     configManager = new ConfigManager();
@@ -29,6 +44,8 @@ LayoutManager::~LayoutManager() {
     delete wifiManager;
     delete layoutWidget; // Clean up global layout widget
     delete compositor;
+    delete frameClient;
+    delete staticLayer;
 
     // regions vector will automatically clean up unique_ptrs (and regions will clean up their widgets)
 }
@@ -42,7 +59,12 @@ void LayoutManager::begin() {
     LOG_INFO("LayoutManager", "Starting Inkplate Layout Manager...");
 
     // Initialize configuration manager first
-    if (!configManager->begin()) {
+    bool configLoaded;
+    {
+        WakeMetrics::Phase phase("config");
+        configLoaded = configManager->begin();
+    }
+    if (!configLoaded) {
         LOG_ERROR("LayoutManager", "Failed to initialize configuration manager!");
         return;
     }
@@ -58,10 +80,49 @@ void LayoutManager::begin() {
     // Enable debug mode if configured
     debugModeEnabled = config.showDebugOnScreen;
 
+    // Memory accounting
+    if (config.trackMemory) {
+        MemoryTracker::setEnabled(true);
+    }
+    MemoryTracker::setSteadyStateAssert(config.assertSteadyStateAllocations);
+
+    // Input recording for host replay
+    if (config.recordInputs) {
+        InputTrace::start(config.traceBytes);
+    }
+
+    // Caches and logs may live on the microSD card
+    Storage::configure(StorageUse::IMAGE_CACHE, Storage::parseBackend(config.imageCacheStorage),
+                       config.imageCacheKB * 1024);
+    Storage::configure(StorageUse::LOGS, Storage::parseBackend(config.logStorage), config.logKB * 1024);
+
+    // Trimming caches well below their quotas waits for a wake with power to spare
+    bool cachesToTrim = Storage::getQuota(StorageUse::IMAGE_CACHE) > 0 || Storage::getQuota(StorageUse::LOGS) > 0;
+    if (cachesToTrim) {
+        BackgroundWork::add("cache-trim", WorkCost::HEAVY, CACHE_TRIM_INTERVAL_S, trimCaches);
+    }
+
+    // Wake metrics piggybacked on image requests
+    Telemetry::configure(config.sendTelemetry, config.telemetryChars);
+
+    // Telemetry history, the shown frame id, the battery level and history and background work
+    // schedules live in RTC memory
+    PowerManager::setRetainRtcMemory(config.sendTelemetry || !config.frameURL.isEmpty() ||
+                                     !config.batteryWidgets.empty() || cachesToTrim);
+
+    if (!config.frameURL.isEmpty()) {
+        beginThinClient();
+        return;
+    }
+
+    // Fonts, icons and artwork are read in place from the assets partition
+    AssetPack::shared().map();
+
     // Debug: Check widget counts in config
-    LOG_DEBUG("LayoutManager", "Config loaded - Widget counts: weather=%d, name=%d, dateTime=%d, battery=%d, image=%d, layout=%d",
+    LOG_DEBUG("LayoutManager", "Config loaded - Widget counts: weather=%d, name=%d, dateTime=%d, battery=%d, image=%d, chart=%d, calendar=%d, layout=%d",
               config.weatherWidgets.size(), config.nameWidgets.size(), config.dateTimeWidgets.size(),
-              config.batteryWidgets.size(), config.imageWidgets.size(), config.layoutWidgets.size());
+              config.batteryWidgets.size(), config.imageWidgets.size(), config.chartWidgets.size(),
+              config.calendarWidgets.size(), config.layoutWidgets.size());
 
     // Calculate layout regions based on config
     calculateLayoutRegions();
@@ -88,10 +149,42 @@ void LayoutManager::begin() {
     createAndAssignWidgets();
     LOG_DEBUG("LayoutManager", "createAndAssignWidgets() completed");
 
+    // Static regions and borders are drawn once and then restored from flash
+    bool hasStaticContent = !config.layoutWidgets.empty() && config.layoutWidgets[0].showRegionBorders;
+    for (const auto& region : regions) {
+        hasStaticContent = hasStaticContent || region->isStatic();
+    }
+    if (hasStaticContent && compositor && compositor->isInitialized()) {
+        staticLayer = new StaticLayer(config.configHash);
+    }
+
     initializeComponents();
     performInitialSetup();
 }
 
+void LayoutManager::beginThinClient() {
+    const AppConfig& config = configManager->getConfig();
+    LOG_INFO("LayoutManager", "Thin-client mode - frames from %s", config.frameURL.c_str());
+
+    // No regions, widgets or compositor surface: the server composes the panel
+    displayManager = new DisplayManager(display);
+    displayManager->enableDebugMode(debugModeEnabled);
+    wifiManager = new WiFiManager(config.wifiSSID.c_str(), config.wifiPassword.c_str());
+    frameClient = new FrameClient(display, config.frameURL.c_str(), config.frameRefreshMs);
+
+    displayManager->initialize();
+    updateFrame();
+    lastUpdate = millis();
+}
+
+bool LayoutManager::updateFrame() {
+    if (!ensureConnectivity()) {
+        LOG_ERROR("LayoutManager", "No connectivity - keeping the frame on the panel");
+        return false;
+    }
+    return frameClient->update();
+}
+
 void LayoutManager::calculateLayoutRegions() {
     const AppConfig& config = configManager->getConfig();
 
@@ -118,6 +211,7 @@ void LayoutManager::calculateLayoutRegions() {
             regionConfig.width,
             regionConfig.height
         );
+        region->setStatic(regionConfig.isStatic);
 
         LOG_DEBUG("LayoutManager", "LayoutRegion created successfully for '%s'", regionId.c_str());
 
@@ -139,6 +233,8 @@ void LayoutManager::createAndAssignWidgets() {
 
     LOG_INFO("LayoutManager", "Creating widgets and regions based on configuration...");
 
+    MemoryTracker::Scope memoryScope(MemorySubsystem::WIDGETS);
+
     // Create and assign weather widgets
     LOG_DEBUG("LayoutManager", "Creating %d weather widgets", config.weatherWidgets.size());
     for (const auto& weatherConfig : config.weatherWidgets) {
@@ -226,6 +322,37 @@ void LayoutManager::createAndAssignWidgets() {
         }
     }
 
+    // Create and assign chart widgets
+    LOG_DEBUG("LayoutManager", "Creating %d chart widgets", config.chartWidgets.size());
+    for (const auto& chartConfig : config.chartWidgets) {
+        ChartWidget* widget = new ChartWidget(display, chartConfig.hours, chartConfig.chartUpdateMs);
+
+        LOG_DEBUG("LayoutManager", "Created ChartWidget for region: %s", chartConfig.region.c_str());
+        LayoutRegion* region = getOrCreateRegion(chartConfig.region);
+        if (region) {
+            region->addWidget(widget);
+            LOG_DEBUG("LayoutManager", "  ChartWidget successfully assigned to region %s", chartConfig.region.c_str());
+        } else {
+            LOG_ERROR("LayoutManager", "  ERROR: Failed to get region %s for ChartWidget", chartConfig.region.c_str());
+        }
+    }
+
+    // Create and assign calendar widgets
+    LOG_DEBUG("LayoutManager", "Creating %d calendar widgets", config.calendarWidgets.size());
+    for (const auto& calendarConfig : config.calendarWidgets) {
+        CalendarWidget* widget = new CalendarWidget(display, calendarConfig.source, calendarConfig.events,
+                                                    calendarConfig.days, calendarConfig.calendarUpdateMs);
+
+        LOG_DEBUG("LayoutManager", "Created CalendarWidget for region: %s", calendarConfig.region.c_str());
+        LayoutRegion* region = getOrCreateRegion(calendarConfig.region);
+        if (region) {
+            region->addWidget(widget);
+            LOG_DEBUG("LayoutManager", "  CalendarWidget successfully assigned to region %s", calendarConfig.region.c_str());
+        } else {
+            LOG_ERROR("LayoutManager", "  ERROR: Failed to get region %s for CalendarWidget", calendarConfig.region.c_str());
+        }
+    }
+
     // Create global layout widget (not assigned to any specific region)
     layoutWidget = nullptr;
     if (!config.layoutWidgets.empty()) {
@@ -246,6 +373,17 @@ void LayoutManager::createAndAssignWidgets() {
         LOG_DEBUG("LayoutManager", "  %s widget created as global layout renderer", typeName.c_str());
     }
 
+    // A region holding only static widgets is static even without "Static" in the config
+    for (const auto& region : regions) {
+        bool allStatic = region->getWidgetCount() > 0 && !region->getLegacyWidget();
+        for (size_t i = 0; allStatic && i < region->getWidgetCount(); ++i) {
+            allStatic = region->getWidget(i) && region->getWidget(i)->isStatic();
+        }
+        if (allStatic) {
+            region->setStatic(true);
+        }
+    }
+
     LOG_INFO("LayoutManager", "Widget and region creation complete");
 }
 
@@ -344,15 +482,43 @@ void LayoutManager::initializeComponents() {
     LOG_INFO("LayoutManager", "All components and widgets initialized");
 }
 
-void LayoutManager::loop() {
+bool LayoutManager::loop() {
     // In deep sleep mode, most work is done in setup()
     // This loop only handles immediate updates and prepares for sleep
 
+    if (frameClient) {
+        // Always-on thin clients poll the frame server on its schedule
+        if (!shouldEnterDeepSleep() && millis() - lastUpdate >= getShortestUpdateInterval()) {
+            updateFrame();
+            lastUpdate = millis();
+            return true;
+        }
+        return false;
+    }
+
     // Check for immediate widget updates (like time ticking)
-    handleImmediateUpdates();
+    bool updated = handleImmediateUpdates();
 
     // Check if we should enter deep sleep
-    checkDeepSleepConditions();
+    return checkDeepSleepConditions() || updated;
+}
+
+void LayoutManager::runBackgroundWork() {
+    WakeMetrics::Phase phase("background");
+    BackgroundWork::run(BatteryManager::getVoltage(display));
+}
+
+bool LayoutManager::trimCaches(void* context) {
+    (void)context;
+    // Smaller caches are faster to search on SPIFFS, and writes on the render path evict less
+    const StorageUse uses[] = {StorageUse::IMAGE_CACHE, StorageUse::LOGS};
+    for (StorageUse use : uses) {
+        size_t quota = Storage::getQuota(use);
+        if (quota > 0) {
+            Storage::trim(use, quota * CACHE_TRIM_PERCENT / 100);
+        }
+    }
+    return Storage::flush();
 }
 
 void LayoutManager::performInitialSetup() {
@@ -384,54 +550,49 @@ void LayoutManager::performScheduledUpdates() {
 
     if (debugModeEnabled) {
         displayManager->showDebugMessage("Starting scheduled updates...");
+    } else {
+        // Clear any previous status messages when not in debug mode
+        displayManager->clear();
     }
 
-    if (wifiManager->connect()) {
-        LOG_INFO("LayoutManager", "WiFi connected, performing full update");
+    // Draw what the caches hold before touching the network: the panel is up
+    // while WiFi associates, and stays up if it never does
+    forceWidgetDataUpdate();
+    renderAllRegions();
+
+    if (!wifiManager->connect()) {
+        LOG_ERROR("LayoutManager", "WiFi connection failed - keeping the cached render");
 
         if (debugModeEnabled) {
-            displayManager->showStatus("Connected", "WiFi", wifiManager->getIPAddress().c_str());
-            displayManager->showDebugMessage(("WiFi: " + wifiManager->getIPAddress()).c_str());
-        } else {
-            // Clear any previous status messages when not in debug mode
-            displayManager->clear();
+            displayManager->showDebugMessage("WiFi failed - using cache");
         }
+        return;
+    }
 
-        // Force connectivity check and widget updates
-        if (ensureConnectivity()) {
-            LOG_INFO("LayoutManager", "Connectivity ensured - updating all widgets");
-
-            if (debugModeEnabled) {
-                displayManager->showDebugMessage("Updating widgets...");
-            }
-
-            // Force all widgets to update their data
-            forceWidgetDataUpdate();
-
-            // Render all regions with fresh data
-            renderAllRegions();
+    LOG_INFO("LayoutManager", "WiFi connected, revalidating widgets");
 
-            if (debugModeEnabled) {
-                displayManager->showDebugMessage("Update complete");
-            }
-        }
-    } else {
-        LOG_ERROR("LayoutManager", "WiFi connection failed - rendering with cached data");
+    if (debugModeEnabled) {
+        displayManager->showDebugMessage(("WiFi: " + wifiManager->getIPAddress()).c_str());
+    }
 
+    // Fetch what is stale and redraw only the regions that changed
+    if (ensureConnectivity()) {
         if (debugModeEnabled) {
-            displayManager->showDebugMessage("WiFi failed - using cache");
+            displayManager->showDebugMessage("Updating widgets...");
         }
 
-        // Clear any status messages and render widgets directly
-        if (!debugModeEnabled) {
-            displayManager->clear();
+        if (revalidateWidgets()) {
+            renderChangedRegions();
         }
 
-        renderAllRegions();
+        if (debugModeEnabled) {
+            displayManager->showDebugMessage("Update complete");
+        }
     }
 }
 
 void LayoutManager::forceWidgetDataUpdate() {
+    WakeMetrics::Phase phase("fetch");
     LOG_INFO("LayoutManager", "Forcing widget data updates...");
 
     // Update all widgets in all regions
@@ -454,7 +615,34 @@ void LayoutManager::forceWidgetDataUpdate() {
     }
 }
 
-void LayoutManager::handleImmediateUpdates() {
+bool LayoutManager::revalidateWidgets() {
+    WakeMetrics::Phase phase("fetch");
+    bool changed = false;
+
+    // A widget can show data another one fetched (the chart shows the weather
+    // widget's forecast), so go round again while anything changes
+    for (int pass = 0; pass < MAX_REVALIDATE_PASSES; pass++) {
+        bool passChanged = false;
+        for (auto it = regionsBegin(); it != regionsEnd(); ++it) {
+            LayoutRegion* region = it->get();
+            if (!region) continue;
+            for (size_t i = 0; i < region->getWidgetCount(); ++i) {
+                Widget* widget = region->getWidget(i);
+                if (widget && widget->revalidate()) {
+                    LOG_INFO("LayoutManager", "%s has new data, redrawing its region",
+                             WidgetTypeRegistry::toString(widget->getWidgetType()).c_str());
+                    region->markDirty();
+                    passChanged = true;
+                }
+            }
+        }
+        if (!passChanged) break;
+        changed = true;
+    }
+    return changed;
+}
+
+bool LayoutManager::handleImmediateUpdates() {
     // Handle only time-sensitive updates that can't wait for deep sleep cycle
     bool needsImmediateRender = false;
 
@@ -475,15 +663,32 @@ void LayoutManager::handleImmediateUpdates() {
         LOG_DEBUG("LayoutManager", "Performing immediate render for time-sensitive updates");
         renderChangedRegions();
     }
+    return needsImmediateRender;
 }
 
-void LayoutManager::checkDeepSleepConditions() {
+bool LayoutManager::checkDeepSleepConditions() {
     // This method determines if we should prepare for deep sleep
     unsigned long currentTime = millis();
     unsigned long timeSinceLastUpdate = currentTime - lastUpdate;
 
     // Check if it's time for the next scheduled update
     if (timeSinceLastUpdate >= getShortestUpdateInterval()) {
+        if (!shouldEnterDeepSleep()) {
+            // Always-on: nothing wakes us up later, so run the update cycle here.
+            // It clears the panel first, so every region has to be redrawn.
+            LOG_INFO("LayoutManager", "Time for next scheduled update - deep sleep disabled, updating now");
+            for (auto it = regionsBegin(); it != regionsEnd(); ++it) {
+                LayoutRegion* region = it->get();
+                if (region) {
+                    region->markDirty();
+                }
+            }
+            performScheduledUpdates();
+            runBackgroundWork();
+            lastUpdate = millis();
+            return true;
+        }
+
         LOG_INFO("LayoutManager", "Time for next scheduled update - preparing for deep sleep wake");
 
         if (debugModeEnabled) {
@@ -491,7 +696,9 @@ void LayoutManager::checkDeepSleepConditions() {
         }
 
         prepareForDeepSleep();
+        return true;
     }
+    return false;
 }
 
 void LayoutManager::prepareForDeepSleep() {
@@ -556,72 +763,43 @@ bool LayoutManager::ensureConnectivity() {
 
 
 void LayoutManager::renderAllRegions() {
+    WakeMetrics::Phase phase("render.full");
     LOG_DEBUG("LayoutManager", "Rendering all regions...");
 
     // Use compositor if available, otherwise fall back to direct rendering
     if (compositor && compositor->isInitialized() && displayManager->getCompositor() && !compositor->isInFallbackMode()) {
         LOG_DEBUG("LayoutManager", "Using compositor for rendering all regions");
 
-        // Clear compositor surface
-        compositor->clear();
-
         bool compositorRenderingSuccessful = true;
 
-        // Render each region to compositor with error handling
+        // Start from the static layer; without a stored one, draw and store it
+        if (!staticLayer || !staticLayer->restore(*compositor)) {
+            compositor->clear();
+            if (staticLayer && !renderStaticLayer()) {
+                compositorRenderingSuccessful = false;
+            }
+        }
+
+        // Render each dynamic region to compositor with error handling
         for (auto it = regionsBegin(); it != regionsEnd(); ++it) {
             LayoutRegion* region = it->get();
-            if (region) {
-                LOG_DEBUG("LayoutManager", "Rendering region at (%d,%d) %dx%d with %d widgets to compositor",
-                          region->getX(), region->getY(),
-                          region->getWidth(), region->getHeight(),
-                          region->getWidgetCount());
-
-                // Clear region on compositor with error checking
-                LOG_DEBUG("LayoutManager", "Clearing region (%d,%d) %dx%d on compositor",
-                          region->getX(), region->getY(),
-                          region->getWidth(), region->getHeight());
-                if (!compositor->clearRegion(*region)) {
-                    LOG_ERROR("LayoutManager", "Failed to clear region on compositor, error: %s",
-                              compositor->getErrorString(compositor->getLastError()));
-                    compositorRenderingSuccessful = false;
-                    continue;
-                }
-
-                // Render all widgets in the region to compositor with error isolation
-                for (size_t i = 0; i < region->getWidgetCount(); ++i) {
-                    Widget* widget = region->getWidget(i);
-                    if (widget) {
-                        try {
-                            widget->renderToCompositor(*compositor, *region);
-                        } catch (...) {
-                            LOG_ERROR("LayoutManager", "Widget rendering failed for widget %zu in region (%d,%d)",
-                                      i, region->getX(), region->getY());
-                            // Continue with other widgets
-                        }
-                    }
-                }
-
-                // Handle legacy widget if present with error isolation
-                if (region->getLegacyWidget()) {
-                    try {
-                        region->getLegacyWidget()->renderToCompositor(*compositor, *region);
-                    } catch (...) {
-                        LOG_ERROR("LayoutManager", "Legacy widget rendering failed in region (%d,%d)",
-                                  region->getX(), region->getY());
-                        // Continue with other regions
-                    }
-                }
-
-                // Mark region as clean after rendering
+            if (region && staticLayer && region->isStatic()) {
                 region->markClean();
+            } else if (region && !renderRegionToCompositor(*compositor, *region)) {
+                compositorRenderingSuccessful = false;
             }
         }
 
         // Render global layout elements (borders, separators) to compositor with error handling
         if (layoutWidget) {
             try {
-                LayoutRegion fullDisplayRegion(0, 0, display.width(), display.height());
-                layoutWidget->renderToCompositor(*compositor, fullDisplayRegion);
+                if (staticLayer) {
+                    // Dynamic regions were cleared over their own borders
+                    layoutWidget->renderBordersToCompositor(*compositor, false);
+                } else {
+                    LayoutRegion fullDisplayRegion(0, 0, display.width(), display.height());
+                    layoutWidget->renderToCompositor(*compositor, fullDisplayRegion);
+                }
             } catch (...) {
                 LOG_ERROR("LayoutManager", "Layout widget rendering failed");
                 compositorRenderingSuccessful = false;
@@ -712,7 +890,100 @@ void LayoutManager::renderAllRegions() {
     LOG_DEBUG("LayoutManager", "Region rendering complete");
 }
 
+bool LayoutManager::renderRegionToCompositor(Compositor& compositor, LayoutRegion& region) {
+    LOG_DEBUG("LayoutManager", "Rendering region at (%d,%d) %dx%d with %d widgets to compositor",
+              region.getX(), region.getY(), region.getWidth(), region.getHeight(), region.getWidgetCount());
+
+    // Clear region on compositor with error checking
+    if (!compositor.clearRegion(region)) {
+        LOG_ERROR("LayoutManager", "Failed to clear region on compositor, error: %s",
+                  compositor.getErrorString(compositor.getLastError()));
+        return false;
+    }
+
+    // Render all widgets in the region to compositor with error isolation
+    for (size_t i = 0; i < region.getWidgetCount(); ++i) {
+        Widget* widget = region.getWidget(i);
+        if (widget) {
+            try {
+                widget->renderToCompositor(compositor, region);
+            } catch (...) {
+                LOG_ERROR("LayoutManager", "Widget rendering failed for widget %zu in region (%d,%d)",
+                          i, region.getX(), region.getY());
+                // Continue with other widgets
+            }
+        }
+    }
+
+    // Handle legacy widget if present with error isolation
+    if (region.getLegacyWidget()) {
+        try {
+            region.getLegacyWidget()->renderToCompositor(compositor, region);
+        } catch (...) {
+            LOG_ERROR("LayoutManager", "Legacy widget rendering failed in region (%d,%d)",
+                      region.getX(), region.getY());
+        }
+    }
+
+    // Mark region as clean after rendering
+    region.markClean();
+    return true;
+}
+
+bool LayoutManager::updateRegionOnCompositor(Compositor& compositor, LayoutRegion& region) {
+    if (region.getWidgetCount() == 0 || region.getLegacyWidget()) {
+        return false;
+    }
+    // A widget that can't update in place means the whole region is cleared and rendered again
+    for (size_t i = 0; i < region.getWidgetCount(); ++i) {
+        Widget* widget = region.getWidget(i);
+        if (!widget || !widget->updateOnCompositor(compositor, region)) {
+            return false;
+        }
+    }
+    LOG_DEBUG("LayoutManager", "Updated region at (%d,%d) in place", region.getX(), region.getY());
+    return true;
+}
+
+bool LayoutManager::renderChangedRegion(Compositor& compositor, LayoutRegion& region) {
+    if (updateRegionOnCompositor(compositor, region)) {
+        // Only what changed was redrawn and marked
+        region.markClean();
+        return true;
+    }
+    return renderRegionToCompositor(compositor, region);
+}
+
+bool LayoutManager::renderStaticLayer() {
+    WakeMetrics::Phase phase("render.static");
+    LOG_INFO("LayoutManager", "Rendering the static layer");
+
+    bool successful = true;
+    for (auto it = regionsBegin(); it != regionsEnd(); ++it) {
+        LayoutRegion* region = it->get();
+        if (region && region->isStatic() && !renderRegionToCompositor(*compositor, *region)) {
+            successful = false;
+        }
+    }
+
+    if (layoutWidget) {
+        try {
+            layoutWidget->renderBordersToCompositor(*compositor, true);
+        } catch (...) {
+            LOG_ERROR("LayoutManager", "Layout widget rendering failed");
+            successful = false;
+        }
+    }
+
+    // A layer with holes in it would be restored on every wake, so only keep a clean one
+    if (successful) {
+        staticLayer->save(*compositor);
+    }
+    return successful;
+}
+
 void LayoutManager::renderChangedRegions() {
+    WakeMetrics::Phase phase("render.partial");
     LOG_DEBUG("LayoutManager", "Rendering changed regions...");
 
     // Use compositor if available for efficient partial updates
@@ -725,47 +996,15 @@ void LayoutManager::renderChangedRegions() {
         // Check which regions need updates and render them to compositor with error handling
         for (auto it = regionsBegin(); it != regionsEnd(); ++it) {
             LayoutRegion* region = it->get();
+            // Static regions are already on the surface from the static layer
+            if (region && staticLayer && region->isStatic()) {
+                continue;
+            }
             if (region && region->needsUpdate()) {
-                LOG_DEBUG("LayoutManager", "Rendering changed region at (%d,%d) %dx%d with %d widgets to compositor",
-                          region->getX(), region->getY(),
-                          region->getWidth(), region->getHeight(),
-                          region->getWidgetCount());
-
-                // Clear region on compositor with error checking
-                if (!compositor->clearRegion(*region)) {
-                    LOG_ERROR("LayoutManager", "Failed to clear changed region on compositor, error: %s",
-                              compositor->getErrorString(compositor->getLastError()));
+                if (!renderChangedRegion(*compositor, *region)) {
                     compositorRenderingSuccessful = false;
                     continue;
                 }
-
-                // Render all widgets in the region to compositor with error isolation
-                for (size_t i = 0; i < region->getWidgetCount(); ++i) {
-                    Widget* widget = region->getWidget(i);
-                    if (widget) {
-                        try {
-                            widget->renderToCompositor(*compositor, *region);
-                        } catch (...) {
-                            LOG_ERROR("LayoutManager", "Widget rendering failed for widget %zu in changed region (%d,%d)",
-                                      i, region->getX(), region->getY());
-                            // Continue with other widgets
-                        }
-                    }
-                }
-
-                // Handle legacy widget if present with error isolation
-                if (region->getLegacyWidget()) {
-                    try {
-                        region->getLegacyWidget()->renderToCompositor(*compositor, *region);
-                    } catch (...) {
-                        LOG_ERROR("LayoutManager", "Legacy widget rendering failed in changed region (%d,%d)",
-                                  region->getX(), region->getY());
-                        // Continue with other regions
-                    }
-                }
-
-                // Mark region as clean after rendering
-                region->markClean();
                 hasChanges = true;
             }
         }
@@ -836,6 +1075,12 @@ void LayoutManager::clearRegion(const LayoutRegion& region) {
 void LayoutManager::forceRefresh() {
     LOG_INFO("LayoutManager", "Manual layout refresh triggered by WAKE button");
 
+    if (frameClient) {
+        updateFrame();
+        lastUpdate = millis();
+        return;
+    }
+
     if (ensureConnectivity()) {
         LOG_INFO("LayoutManager", "Connectivity ensured - forcing region refresh");
 
@@ -849,6 +1094,9 @@ void LayoutManager::forceRefresh() {
 
         // Use compositor-based rendering for full refresh
         renderAllRegions();
+        if (revalidateWidgets()) {
+            renderChangedRegions();
+        }
 
         // Update the last update time to reset the scheduled timer
         lastUpdate = millis();
@@ -928,6 +1176,7 @@ void LayoutManager::forceTimeAndBatteryUpdate() {
 
 unsigned long LayoutManager::getShortestUpdateInterval() const {
     if (!configManager) return 3600000; // Default 1 hour if no config
+    if (frameClient) return frameClient->getSleepMs();
 
     const AppConfig& config = configManager->getConfig();
 
@@ -946,6 +1195,14 @@ unsigned long LayoutManager::getShortestUpdateInterval() const {
         shortest = min(shortest, batteryConfig.batteryUpdateMs);
     }
 
+    for (const auto& chartConfig : config.chartWidgets) {
+        shortest = min(shortest, chartConfig.chartUpdateMs);
+    }
+
+    for (const auto& calendarConfig : config.calendarWidgets) {
+        shortest = min(shortest, calendarConfig.calendarUpdateMs);
+    }
+
     return shortest;
 }
 
@@ -1101,3 +1358,121 @@ bool LayoutManager::removeWidgetFromRegion(Widget* widget, const String& regionI
     LOG_ERROR("LayoutManager", "ERROR: Widget not found in region '%s'", regionId.c_str());
     return false;
 }
+
+void LayoutManager::registerConsoleCommands(SerialConsole& console) {
+    console.addCommand("widgets", "", "List regions and their widgets",
+                       [this](int, char*[], Print& out) { printWidgets(out); });
+
+    console.addCommand("update", "<region>", "Fetch and redraw one region's widgets",
+                       [this](int argc, char* argv[], Print& out) {
+        if (argc != 2) {
+            out.printf("usage: update <region> (see widgets)\n");
+            return;
+        }
+        updateRegionWidgets(argv[1], out);
+    });
+
+    console.addCommand("refresh", "[full|partial]", "Redraw every region",
+                       [this](int argc, char* argv[], Print& out) {
+        bool full = argc < 2 || strcasecmp(argv[1], "full") == 0;
+        if (argc > 2 || (!full && strcasecmp(argv[1], "partial") != 0)) {
+            out.printf("usage: refresh [full|partial]\n");
+            return;
+        }
+
+        for (auto it = regionsBegin(); it != regionsEnd(); ++it) {
+            if (it->get()) it->get()->markDirty();
+        }
+        unsigned long start = millis();
+        if (full) {
+            renderAllRegions();
+        } else {
+            renderChangedRegions();
+        }
+        out.printf("%s refresh done in %lu ms\n", full ? "full" : "partial", millis() - start);
+    });
+
+    console.addCommand("schedule", "", "Update intervals and the next wake",
+                       [this](int, char*[], Print& out) { printSchedule(out); });
+
+    console.addCommand("work", "[run]", "Deferred background work and the power budget",
+                       [this](int argc, char* argv[], Print& out) {
+        if (argc > 2 || (argc == 2 && strcasecmp(argv[1], "run") != 0)) {
+            out.printf("usage: work [run]\n");
+            return;
+        }
+        if (argc == 2) {
+            int ran = BackgroundWork::run(BatteryManager::getVoltage(display));
+            out.printf("%d task%s run\n", ran, ran == 1 ? "" : "s");
+        }
+        BackgroundWork::print(out);
+    });
+}
+
+void LayoutManager::printWidgets(Print& out) const {
+    for (const auto& entry : regionMap) {
+        const LayoutRegion* region = entry.second;
+        out.printf("  %-12s (%d,%d) %dx%d%s:", entry.first.c_str(), region->getX(), region->getY(),
+                   region->getWidth(), region->getHeight(), region->needsUpdate() ? " dirty" : "");
+        for (size_t i = 0; i < region->getWidgetCount(); ++i) {
+            Widget* widget = region->getWidget(i);
+            if (widget) {
+                out.printf(" %s", WidgetTypeRegistry::toString(widget->getWidgetType()).c_str());
+            }
+        }
+        out.printf("\n");
+    }
+}
+
+bool LayoutManager::updateRegionWidgets(const char* regionId, Print& out) {
+    LayoutRegion* region = getRegionById(regionId);
+    if (!region) {
+        out.printf("error: no region '%s' (see widgets)\n", regionId);
+        return false;
+    }
+
+    unsigned long start = millis();
+    for (size_t i = 0; i < region->getWidgetCount(); ++i) {
+        Widget* widget = region->getWidget(i);
+        if (widget) {
+            widget->forceUpdate();
+        }
+    }
+    region->markDirty();
+    renderChangedRegions();
+    if (revalidateWidgets()) {
+        renderChangedRegions();
+    }
+
+    out.printf("%s: %zu widget%s updated in %lu ms\n", regionId, region->getWidgetCount(),
+               region->getWidgetCount() == 1 ? "" : "s", millis() - start);
+    return true;
+}
+
+void LayoutManager::printSchedule(Print& out) const {
+    const AppConfig& config = configManager->getConfig();
+    unsigned long interval = getShortestUpdateInterval();
+    unsigned long sinceUpdate = millis() - lastUpdate;
+
+    out.printf("deep sleep %s, wake button pin %d\n", config.enableDeepSleep ? "on" : "off", config.wakeButtonPin);
+    out.printf("update interval %lu s (shortest widget), last update %lu s ago, next %s %lu s\n",
+               interval / 1000, sinceUpdate / 1000,
+               config.enableDeepSleep ? "wake in" : "update in",
+               sinceUpdate < interval ? (interval - sinceUpdate) / 1000 : 0);
+
+    for (const auto& imageConfig : config.imageWidgets) {
+        out.printf("  ImageWidget    %-12s every %lu s\n", imageConfig.region.c_str(), imageConfig.imageRefreshMs / 1000);
+    }
+    for (const auto& dateTimeConfig : config.dateTimeWidgets) {
+        out.printf("  TimeWidget     %-12s every %lu s\n", dateTimeConfig.region.c_str(), dateTimeConfig.timeUpdateMs / 1000);
+    }
+    for (const auto& batteryConfig : config.batteryWidgets) {
+        out.printf("  BatteryWidget  %-12s every %lu s\n", batteryConfig.region.c_str(), batteryConfig.batteryUpdateMs / 1000);
+    }
+    for (const auto& chartConfig : config.chartWidgets) {
+        out.printf("  ChartWidget    %-12s every %lu s\n", chartConfig.region.c_str(), chartConfig.chartUpdateMs / 1000);
+    }
+    for (const auto& calendarConfig : config.calendarWidgets) {
+        out.printf("  CalendarWidget %-12s every %lu s\n", calendarConfig.region.c_str(), calendarConfig.calendarUpdateMs / 1000);
+    }
+}
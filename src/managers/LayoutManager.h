@@ -12,6 +12,9 @@
 
 // Forward declarations
 class LayoutWidget;
+class SerialConsole;
+class FrameClient;
+class StaticLayer;
 
 class LayoutManager {
 public:
@@ -19,7 +22,7 @@ public:
     ~LayoutManager();
 
     void begin();
-    void loop();
+    bool loop(); // True if it updated anything
     void forceRefresh(); // Manual refresh triggered by button
     void forceTimeAndBatteryUpdate(); // Force update of time and battery widgets using compositor partial rendering
 
@@ -46,6 +49,8 @@ public:
     int getWakeButtonPin() const;
     bool shouldEnterDeepSleep() const;
     unsigned long getDeepSleepThreshold() const;
+    // Server.FrameUrl set: frames come pre-composed, no widgets run
+    bool isThinClient() const { return frameClient != nullptr; }
 
     // Widget-region assignment methods
     bool assignWidgetToRegion(Widget* widget, const String& regionId);
@@ -54,6 +59,16 @@ public:
     // Compositor integration demonstration
     void demonstrateCompositorIntegration();
 
+    // Optional work the battery allows this wake; call before deep sleep
+    void runBackgroundWork();
+
+    // Serial console commands: widgets, update, refresh, schedule, work
+    void registerConsoleCommands(SerialConsole& console);
+
+    // One region of renderChangedRegions(): in place if every widget can, else cleared and redrawn.
+    // Made public for testing
+    static bool renderChangedRegion(Compositor& compositor, LayoutRegion& region);
+
 private:
     // Core components
     Inkplate display;
@@ -61,6 +76,8 @@ private:
     DisplayManager* displayManager;
     WiFiManager* wifiManager;
     Compositor* compositor;
+    FrameClient* frameClient;
+    StaticLayer* staticLayer; // Set when some region or the borders are static
 
     // Region collection system
     std::vector<std::unique_ptr<LayoutRegion>> regions;
@@ -73,22 +90,37 @@ private:
     unsigned long lastUpdate;
     bool debugModeEnabled;
 
+    // Caches are trimmed to this share of their quotas, at most daily
+    static const uint32_t CACHE_TRIM_INTERVAL_S = 86400;
+    static const size_t CACHE_TRIM_PERCENT = 75;
+    static const int MAX_REVALIDATE_PASSES = 3;
+
     // Private methods
     void calculateLayoutRegions();
     void createAndAssignWidgets();
+    static bool renderRegionToCompositor(Compositor& compositor, LayoutRegion& region);
+    static bool updateRegionOnCompositor(Compositor& compositor, LayoutRegion& region); // In place, for widgets that support it
+    bool renderStaticLayer(); // Static regions and all borders onto a cleared surface, then saved
     void initializeComponents();
     void performInitialSetup();
     void performScheduledUpdates(); // New: Perform all updates in setup for deep sleep
     void forceWidgetDataUpdate(); // New: Force all widgets to update their data
-    void handleImmediateUpdates(); // New: Handle only time-sensitive updates
-    void checkDeepSleepConditions(); // New: Check if ready for deep sleep
+    bool revalidateWidgets(); // After a render from cached data: true if some region needs redrawing
+    bool handleImmediateUpdates(); // New: Handle only time-sensitive updates
+    bool checkDeepSleepConditions(); // New: Check if ready for deep sleep
     void prepareForDeepSleep(); // New: Prepare system for deep sleep
     void handleScheduledUpdate(); // Legacy method - may be removed
     void handleWidgetUpdates(); // Legacy method - may be removed
     bool ensureConnectivity();
+    void beginThinClient();
+    bool updateFrame();
     void renderAllRegions();
     void renderChangedRegions(); // New method for partial updates
     void clearRegion(const LayoutRegion& region);
+    void printWidgets(Print& out) const;
+    bool updateRegionWidgets(const char* regionId, Print& out);
+    void printSchedule(Print& out) const;
+    static bool trimCaches(void* context); // Background task
     // drawLayoutBorders() removed - now handled by LayoutWidget
 };
 
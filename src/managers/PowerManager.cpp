@@ -2,6 +2,8 @@
 #include "../core/Logger.h"
 #include <WiFi.h>
 
+bool PowerManager::retainRtcMemory = false;
+
 void PowerManager::enableDeepSleep(unsigned long sleepTimeMs) {
     esp_sleep_enable_timer_wakeup(sleepTimeMs * 1000); // Convert to microseconds
 }
@@ -40,6 +42,8 @@ void PowerManager::configureLowPowerMode() {
 void PowerManager::disableUnusedPeripherals() {
     // Disable ADC, DAC, and other unused peripherals
     esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_PERIPH, ESP_PD_OPTION_OFF);
-    esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_SLOW_MEM, ESP_PD_OPTION_OFF);
+    // AUTO leaves slow memory powered only while RTC_DATA_ATTR data exists
+    esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_SLOW_MEM,
+                        retainRtcMemory ? ESP_PD_OPTION_AUTO : ESP_PD_OPTION_OFF);
     esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_FAST_MEM, ESP_PD_OPTION_OFF);
 }
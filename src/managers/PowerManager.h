@@ -11,8 +11,13 @@ public:
     static void enableWakeOnTimer(unsigned long timeMs);
     static void enterDeepSleep();
     static void configureLowPowerMode();
+    // Keep RTC slow memory (RTC_DATA_ATTR state) powered in deep sleep
+    static void setRetainRtcMemory(bool retain) { retainRtcMemory = retain; }
+    static bool isRetainingRtcMemory() { return retainRtcMemory; }
 
 private:
+    static bool retainRtcMemory;
+
     static void disableUnusedPeripherals();
 };
 
@@ -1,5 +1,7 @@
 #include "WiFiManager.h"
 #include "../core/Logger.h"
+#include "../core/InputTrace.h"
+#include "../core/WakeMetrics.h"
 
 WiFiManager::WiFiManager(const char* ssid, const char* password)
     : ssid(ssid), password(password), lastConnectionCheck(0) {}
@@ -56,9 +58,16 @@ String WiFiManager::getStatusString() {
 }
 
 bool WiFiManager::attemptConnection() {
+    WakeMetrics::Phase phase("wifi");
     logConnectionAttempt();
+    unsigned long connectStart = millis();
     WiFi.begin(ssid, password);
-    return waitForConnection();
+    bool connected = waitForConnection();
+    InputTrace::recordWiFi(connectStart, connected);
+    if (!connected) {
+        WakeMetrics::count(WakeCounter::WIFI_FAILURES);
+    }
+    return connected;
 }
 
 void WiFiManager::logConnectionAttempt() {
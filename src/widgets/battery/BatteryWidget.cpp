@@ -1,13 +1,48 @@
 #include "BatteryWidget.h"
+#include "../../core/BatteryHistory.h"
 #include "../../core/Logger.h"
 #include "../../core/Compositor.h"
+#include "../../managers/BatteryManager.h"
 #include "../../managers/ConfigManager.h"
 
+// Battery outline and tip, 1 bit per pixel: a 40x20 body inside a 2-pixel
+// frame, with the 4x12 tip on the right. The fill level is drawn over it.
+static const int BATTERY_SPRITE_WIDTH = 45;
+static const int BATTERY_SPRITE_HEIGHT = 22;
+static const int BATTERY_BODY_WIDTH = 40;
+static const int BATTERY_BODY_HEIGHT = 20;
+static const uint8_t BATTERY_OUTLINE_BITS[] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xc0,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xc0,
+    0xc0, 0x00, 0x00, 0x00, 0x00, 0xc0,
+    0xc0, 0x00, 0x00, 0x00, 0x00, 0xc0,
+    0xc0, 0x00, 0x00, 0x00, 0x00, 0xc0,
+    0xc0, 0x00, 0x00, 0x00, 0x00, 0xf8,
+    0xc0, 0x00, 0x00, 0x00, 0x00, 0xf8,
+    0xc0, 0x00, 0x00, 0x00, 0x00, 0xf8,
+    0xc0, 0x00, 0x00, 0x00, 0x00, 0xf8,
+    0xc0, 0x00, 0x00, 0x00, 0x00, 0xf8,
+    0xc0, 0x00, 0x00, 0x00, 0x00, 0xf8,
+    0xc0, 0x00, 0x00, 0x00, 0x00, 0xf8,
+    0xc0, 0x00, 0x00, 0x00, 0x00, 0xf8,
+    0xc0, 0x00, 0x00, 0x00, 0x00, 0xf8,
+    0xc0, 0x00, 0x00, 0x00, 0x00, 0xf8,
+    0xc0, 0x00, 0x00, 0x00, 0x00, 0xf8,
+    0xc0, 0x00, 0x00, 0x00, 0x00, 0xf8,
+    0xc0, 0x00, 0x00, 0x00, 0x00, 0xc0,
+    0xc0, 0x00, 0x00, 0x00, 0x00, 0xc0,
+    0xc0, 0x00, 0x00, 0x00, 0x00, 0xc0,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xc0,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xc0,
+};
+
 BatteryWidget::BatteryWidget(Inkplate& display)
-    : Widget(display), lastBatteryUpdate(0), batteryUpdateInterval(DEFAULT_BATTERY_UPDATE_INTERVAL) {}
+    : Widget(display), lastBatteryUpdate(0), batteryUpdateInterval(DEFAULT_BATTERY_UPDATE_INTERVAL),
+      drawnPercentage(-1), drawnCentivolts(-1) {}
 
 BatteryWidget::BatteryWidget(Inkplate& display, unsigned long updateInterval)
-    : Widget(display), lastBatteryUpdate(0), batteryUpdateInterval(updateInterval) {
+    : Widget(display), lastBatteryUpdate(0), batteryUpdateInterval(updateInterval),
+      drawnPercentage(-1), drawnCentivolts(-1) {
     LOG_INFO("BatteryWidget", "Created with update interval: %lu ms (%lu seconds)", updateInterval, updateInterval / 1000);
 }
 
@@ -18,7 +53,21 @@ void BatteryWidget::begin() {
 
 bool BatteryWidget::shouldUpdate() {
     unsigned long currentTime = millis();
-    return (currentTime - lastBatteryUpdate >= batteryUpdateInterval) || (lastBatteryUpdate == 0);
+    if (lastBatteryUpdate == 0) {
+        return true;
+    }
+    if (currentTime - lastBatteryUpdate < batteryUpdateInterval) {
+        return false;
+    }
+
+    // Due, but the filtered reading is stable: skip the render if it would draw the same thing
+    if (BatteryManager::getPercentage(display) == drawnPercentage &&
+        centivolts(BatteryManager::getVoltage(display)) == drawnCentivolts) {
+        LOG_DEBUG("BatteryWidget", "Battery unchanged at %d%%, skipping render", drawnPercentage);
+        lastBatteryUpdate = currentTime;
+        return false;
+    }
+    return true;
 }
 
 void BatteryWidget::render(const LayoutRegion& region) {
@@ -59,26 +108,23 @@ void BatteryWidget::forceUpdate() {
 }
 
 float BatteryWidget::getBatteryVoltage() {
-    return display.readBattery();
+    return BatteryManager::getVoltage(display);
 }
 
 int BatteryWidget::getBatteryPercentage() {
-    float voltage = getBatteryVoltage();
+    return BatteryManager::getPercentage(display);
+}
 
-    if (voltage <= MIN_BATTERY_VOLTAGE) {
-        return 0;
-    } else if (voltage >= MAX_BATTERY_VOLTAGE) {
-        return 100;
-    } else {
-        float range = MAX_BATTERY_VOLTAGE - MIN_BATTERY_VOLTAGE;
-        float current = voltage - MIN_BATTERY_VOLTAGE;
-        return (int)((current / range) * 100);
-    }
+int BatteryWidget::centivolts(float voltage) {
+    // The voltage is shown with two decimals
+    return static_cast<int>(voltage * 100.0f + 0.5f);
 }
 
 void BatteryWidget::drawBatteryIndicator(const LayoutRegion& region) {
     int percentage = getBatteryPercentage();
     float voltage = getBatteryVoltage();
+    drawnPercentage = percentage;
+    drawnCentivolts = centivolts(voltage);
 
     LOG_DEBUG("BatteryWidget", "drawBatteryIndicator() - Drawing battery: %d%% (%.2fV)", percentage, voltage);
     LOG_DEBUG("BatteryWidget", "region bounds: (%d,%d) %dx%d",
@@ -123,6 +169,14 @@ void BatteryWidget::drawBatteryIndicator(const LayoutRegion& region) {
     display.setTextWrap(false);
     display.printf("%.2fV", voltage);
     LOG_DEBUG("BatteryWidget", "Drew voltage: %.2fV", voltage);
+
+    // Runtime left, once there is enough history for a forecast
+    BatteryForecast outlook = BatteryHistory::getForecast();
+    if (outlook.valid) {
+        display.setCursor(labelX, labelY + 145);
+        display.printf("~%.0f days left", outlook.hoursLeft / 24.0f);
+        LOG_DEBUG("BatteryWidget", "Drew runtime: %.0f h", outlook.hoursLeft);
+    }
 }
 
 void BatteryWidget::drawBatteryIcon(int x, int y, int percentage, int iconWidth, int iconHeight) {
@@ -143,6 +197,8 @@ void BatteryWidget::drawBatteryIcon(int x, int y, int percentage, int iconWidth,
 void BatteryWidget::drawBatteryIndicatorToCompositor(Compositor& compositor, const LayoutRegion& region) {
     int percentage = getBatteryPercentage();
     float voltage = getBatteryVoltage();
+    drawnPercentage = percentage;
+    drawnCentivolts = centivolts(voltage);
 
     LOG_DEBUG("BatteryWidget", "drawBatteryIndicatorToCompositor() - Drawing battery: %d%% (%.2fV)", percentage, voltage);
 
@@ -160,31 +216,39 @@ void BatteryWidget::drawBatteryIndicatorToCompositor(Compositor& compositor, con
     LOG_DEBUG("BatteryWidget", "Drew percentage area to compositor: %d%%", percentage);
 
     // Draw battery icon to compositor
-    int iconWidth = 40;
-    int iconHeight = 20;
     int iconX = labelX;
     int iconY = labelY + 100;
 
-    drawBatteryIconToCompositor(compositor, iconX, iconY, percentage, iconWidth, iconHeight);
+    drawBatteryIconToCompositor(compositor, iconX, iconY, percentage);
     LOG_DEBUG("BatteryWidget", "Drew battery icon to compositor");
 
     // Draw voltage info area
     compositor.fillRect(labelX, labelY + 125, 50, 15, 0); // Black rectangle for voltage
     LOG_DEBUG("BatteryWidget", "Drew voltage area to compositor: %.2fV", voltage);
-}
 
-void BatteryWidget::drawBatteryIconToCompositor(Compositor& compositor, int x, int y, int percentage, int iconWidth, int iconHeight) {
-    // Battery outline in black
-    compositor.drawRect(x, y, iconWidth, iconHeight, 0);
-    compositor.drawRect(x - 1, y - 1, iconWidth + 2, iconHeight + 2, 0); // Thicker outline
+    // Runtime left area, once there is enough history for a forecast
+    if (BatteryHistory::getForecast().valid) {
+        compositor.fillRect(labelX, labelY + 145, 70, 10, 0);
+    }
+}
 
-    // Battery tip in black
-    compositor.fillRect(x + iconWidth, y + 4, 4, iconHeight - 8, 0);
+void BatteryWidget::drawBatteryIconToCompositor(Compositor& compositor, int x, int y, int percentage) {
+    // Outline and tip in black; the frame starts a pixel outside the body
+    static const uint8_t inkPalette[2] = {255, 0};
+    Sprite outline;
+    outline.data = BATTERY_OUTLINE_BITS;
+    outline.length = sizeof(BATTERY_OUTLINE_BITS);
+    outline.width = BATTERY_SPRITE_WIDTH;
+    outline.height = BATTERY_SPRITE_HEIGHT;
+    outline.bitsPerPixel = 1;
+    outline.key = 0;
+    outline.palette = inkPalette;
+    compositor.blit(x - 1, y - 1, outline);
 
     // Fill battery based on percentage in black
-    int fillWidth = ((iconWidth - 4) * percentage) / 100;
+    int fillWidth = ((BATTERY_BODY_WIDTH - 4) * percentage) / 100;
     if (fillWidth > 0) {
-        compositor.fillRect(x + 2, y + 2, fillWidth, iconHeight - 4, 0);
+        compositor.fillRect(x + 2, y + 2, fillWidth, BATTERY_BODY_HEIGHT - 4, 0);
     }
 }
 WidgetType BatteryWidget::getWidgetType() const {
@@ -18,7 +18,7 @@ public:
     void begin() override;
     WidgetType getWidgetType() const override;
 
-    // Battery-specific methods
+    // Battery-specific methods; one filtered reading per wake (BatteryManager)
     void forceUpdate();
     float getBatteryVoltage();
     int getBatteryPercentage();
@@ -27,14 +27,18 @@ private:
     unsigned long lastBatteryUpdate;
     unsigned long batteryUpdateInterval;
 
+    // What the last render showed; a due update that would draw the same is skipped
+    int drawnPercentage;
+    int drawnCentivolts;
+
     static const unsigned long DEFAULT_BATTERY_UPDATE_INTERVAL = 900000; // 15 minutes
-    static constexpr float MIN_BATTERY_VOLTAGE = 3.2;
-    static constexpr float MAX_BATTERY_VOLTAGE = 4.2;
+
+    static int centivolts(float voltage);
 
     void drawBatteryIndicator(const LayoutRegion& region);
     void drawBatteryIndicatorToCompositor(Compositor& compositor, const LayoutRegion& region);
     void drawBatteryIcon(int x, int y, int percentage, int iconWidth, int iconHeight);
-    void drawBatteryIconToCompositor(Compositor& compositor, int x, int y, int percentage, int iconWidth, int iconHeight);
+    void drawBatteryIconToCompositor(Compositor& compositor, int x, int y, int percentage);
 };
 
 #endif
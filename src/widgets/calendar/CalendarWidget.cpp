@@ -0,0 +1,403 @@
+#include "CalendarWidget.h"
+#include "../../core/Logger.h"
+#include "../../core/Compositor.h"
+#include "../../core/InputTrace.h"
+#include "../../core/MemoryTracker.h"
+#include "../../core/Storage.h"
+#include "../../core/WakeMetrics.h"
+#include "../../managers/ConfigManager.h"
+#include <HTTPClient.h>
+#include <WiFi.h>
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+
+// Before this the clock has not been set
+static const time_t MIN_EPOCH = 1577836800;  // 2020-01-01
+
+static const int MARGIN = 10;
+static const int LINE_HEIGHT = 30;  // Time row and summary row
+
+CalendarWidget::CalendarWidget(Inkplate& display, const String& source, int maxEvents, int days,
+                               unsigned long updateInterval)
+    : Widget(display), source(source),
+      maxEvents(std::min(std::max(maxEvents, 1), static_cast<int>(IcsParser::MAX_EVENTS))),
+      days(std::max(days, 1)), updateInterval(updateInterval), lastCalendarUpdate(0), lastFetch(0),
+      waitingForClock(false), lastNotModified(false), revalidatePending(false), nextEventEnd(0), cacheRead(false), cache(), shown(),
+      shownCount(0) {
+    // FNV-1a of the source names its cache file
+    sourceHash = 2166136261u;
+    for (const char* p = source.c_str(); *p; p++) {
+        sourceHash = (sourceHash ^ static_cast<uint8_t>(*p)) * 16777619u;
+    }
+    snprintf(cacheName, sizeof(cacheName), "/cal-%08lx.bin", static_cast<unsigned long>(sourceHash));
+    LOG_INFO("CalendarWidget", "Created for %s: %d events over %d days, update interval: %lu ms",
+             source.c_str(), this->maxEvents, this->days, updateInterval);
+}
+
+void CalendarWidget::begin() {
+    LOG_INFO("CalendarWidget", "Initializing calendar widget...");
+    lastCalendarUpdate = 0;
+    lastFetch = 0;
+}
+
+void CalendarWidget::forceUpdate() {
+    // Fetch again with the next render, or just after it when the cache can be drawn meanwhile
+    lastCalendarUpdate = 0;
+    lastFetch = 0;
+}
+
+bool CalendarWidget::shouldUpdate() {
+    if (lastCalendarUpdate == 0 || millis() - lastCalendarUpdate >= updateInterval) {
+        return true;
+    }
+    time_t now = time(nullptr);
+    if (waitingForClock) {
+        return now >= MIN_EPOCH;
+    }
+    // The first event to end is over: show the next one
+    return nextEventEnd != 0 && static_cast<uint32_t>(now) >= nextEventEnd;
+}
+
+void CalendarWidget::update() {
+    uint32_t now = static_cast<uint32_t>(time(nullptr));
+    if (lastFetch == 0 || millis() - lastFetch >= updateInterval) {
+        if (!cacheRead && !source.startsWith("/")) {
+            loadCache();
+            cacheRead = true;
+        }
+        if (now >= MIN_EPOCH && !source.startsWith("/") && cacheCovers(now)) {
+            // Draw the cached events now and ask the server once the panel is up
+            revalidatePending = true;
+            selectShown(now);
+            return;
+        }
+        refresh();
+    } else {
+        selectShown(now);
+    }
+}
+
+bool CalendarWidget::revalidate() {
+    if (!revalidatePending) {
+        return false;
+    }
+    revalidatePending = false;
+
+    bool wasWaiting = waitingForClock;
+    CalendarEvent before[IcsParser::MAX_EVENTS];
+    size_t beforeCount = shownCount;
+    for (size_t i = 0; i < shownCount; i++) {
+        before[i] = getEvent(i);
+    }
+    refresh();
+    return waitingForClock != wasWaiting || !sameShown(before, beforeCount);
+}
+
+bool CalendarWidget::sameShown(const CalendarEvent* events, size_t count) const {
+    if (count != shownCount) return false;
+    for (size_t i = 0; i < count; i++) {
+        const CalendarEvent& event = getEvent(i);
+        if (event.start != events[i].start || event.end != events[i].end || event.allDay != events[i].allDay ||
+            strcmp(event.summary, events[i].summary) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CalendarWidget::refresh() {
+    time_t now = time(nullptr);
+    lastNotModified = false;
+    if (now < MIN_EPOCH) {
+        // Which events are upcoming depends on the date
+        LOG_INFO("CalendarWidget", "Clock not set, waiting before reading the calendar");
+        waitingForClock = true;
+        // The time widget may set the clock once WiFi is up; look again then
+        revalidatePending = true;
+        return false;
+    }
+    waitingForClock = false;
+    lastFetch = millis();
+
+    if (!cacheRead) {
+        loadCache();
+        cacheRead = true;
+    }
+
+    uint32_t epoch = static_cast<uint32_t>(now);
+    bool ok = source.startsWith("/") ? readFile(epoch) : fetchUrl(epoch, cacheCovers(epoch));
+    if (!ok && cache.magic == CACHE_MAGIC) {
+        LOG_WARN("CalendarWidget", "Showing cached events from %lu", static_cast<unsigned long>(cache.parsedAt));
+    }
+    selectShown(epoch);
+    return ok;
+}
+
+bool CalendarWidget::cacheCovers(uint32_t now) const {
+    if (cache.magic != CACHE_MAGIC || now < cache.parsedAt || now + days * 86400u > cache.horizon) {
+        return false;
+    }
+    // A full list may be missing events after its last one
+    if (cache.count < IcsParser::MAX_EVENTS) return true;
+    int upcoming = 0;
+    for (uint32_t i = 0; i < cache.count; i++) {
+        if (std::max(cache.events[i].end, cache.events[i].start + 1) > now) upcoming++;
+    }
+    return upcoming >= maxEvents;
+}
+
+bool CalendarWidget::fetchUrl(uint32_t now, bool conditional) {
+    if (WiFi.status() != WL_CONNECTED) {
+        LOG_WARN("CalendarWidget", "WiFi not connected, cannot fetch calendar");
+        revalidatePending = true;
+        return false;
+    }
+
+    MemoryTracker::Scope memoryScope(MemorySubsystem::NETWORK);
+    HTTPClient http;
+    http.begin(source);
+    http.setTimeout(10000);
+    http.setReuse(false);
+    // The body straight off the socket, without chunked framing
+    http.useHTTP10(true);
+    static const char* headerKeys[] = {"ETag", "Last-Modified"};
+    http.collectHeaders(headerKeys, 2);
+    if (conditional) {
+        if (cache.etag[0]) http.addHeader("If-None-Match", cache.etag);
+        if (cache.lastModified[0]) http.addHeader("If-Modified-Since", cache.lastModified);
+    }
+
+    unsigned long requestStart = millis();
+    int status = http.GET();
+    String etag = http.header("ETag");
+    String lastModified = http.header("Last-Modified");
+    String headers;
+    if (etag.length() > 0) headers += "ETag: " + etag + "\n";
+    if (lastModified.length() > 0) headers += "Last-Modified: " + lastModified + "\n";
+    InputTrace::recordHttpStart(requestStart, source.c_str(), status, headers);
+
+    if (status == HTTP_CODE_NOT_MODIFIED && conditional) {
+        http.end();
+        lastNotModified = true;
+        Storage::touch(StorageUse::IMAGE_CACHE, cacheName);
+        LOG_INFO("CalendarWidget", "Calendar not modified, %lu cached events", static_cast<unsigned long>(cache.count));
+        return true;
+    }
+    if (status != HTTP_CODE_OK) {
+        http.end();
+        WakeMetrics::count(WakeCounter::HTTP_FAILURES);
+        LOG_ERROR("CalendarWidget", "Calendar fetch failed: %d", status);
+        return false;
+    }
+
+    // A day past the shown window, so the cache lasts until tomorrow
+    uint32_t horizon = now + (days + 1) * 86400u;
+    IcsParser parser(now, horizon, IcsParser::MAX_EVENTS);
+    int remaining = http.getSize();  // -1: until the server closes the connection
+    Stream& stream = http.getStream();
+    char chunk[CHUNK_BYTES];
+    size_t received = 0;
+    while (remaining != 0) {
+        size_t wanted = remaining < 0 ? sizeof(chunk) : std::min(sizeof(chunk), static_cast<size_t>(remaining));
+        size_t length = stream.readBytes(chunk, wanted);
+        if (length == 0) break;
+        parser.feed(chunk, length);
+        InputTrace::recordHttpBody(chunk, length);
+        received += length;
+        if (remaining > 0) remaining -= length;
+    }
+    memoryScope.checkpoint();
+    http.end();
+
+    if (remaining > 0) {
+        WakeMetrics::count(WakeCounter::HTTP_FAILURES);
+        LOG_ERROR("CalendarWidget", "Calendar cut short after %zu bytes", received);
+        return false;
+    }
+    parser.finish();
+
+    keep(parser, now, horizon);
+    // Validators too long for the cache are not sent back
+    if (etag.length() < sizeof(cache.etag)) strcpy(cache.etag, etag.c_str());
+    if (lastModified.length() < sizeof(cache.lastModified)) strcpy(cache.lastModified, lastModified.c_str());
+    saveCache();
+    LOG_INFO("CalendarWidget", "Read %zu events from %zu bytes, kept %zu", parser.getEventsRead(), received,
+             parser.getCount());
+    return true;
+}
+
+bool CalendarWidget::readFile(uint32_t now) {
+    if (!Storage::exists(StorageUse::CONFIG, source.c_str())) {
+        LOG_ERROR("CalendarWidget", "Calendar file %s not found", source.c_str());
+        return false;
+    }
+    fs::File file = Storage::open(StorageUse::CONFIG, source.c_str(), "r");
+    if (!file) {
+        LOG_ERROR("CalendarWidget", "Failed to open %s", source.c_str());
+        return false;
+    }
+
+    uint32_t horizon = now + days * 86400u;
+    IcsParser parser(now, horizon, IcsParser::MAX_EVENTS);
+    uint8_t chunk[CHUNK_BYTES];
+    size_t length;
+    while ((length = file.read(chunk, sizeof(chunk))) > 0) {
+        parser.feed(reinterpret_cast<const char*>(chunk), length);
+    }
+    file.close();
+    parser.finish();
+
+    // Local files are read again each time; nothing to cache
+    keep(parser, now, horizon);
+    LOG_INFO("CalendarWidget", "Read %zu events from %s, kept %zu", parser.getEventsRead(), source.c_str(),
+             parser.getCount());
+    return true;
+}
+
+void CalendarWidget::keep(const IcsParser& parser, uint32_t now, uint32_t horizon) {
+    memset(&cache, 0, sizeof(cache));
+    cache.magic = CACHE_MAGIC;
+    cache.sourceHash = sourceHash;
+    cache.parsedAt = now;
+    cache.horizon = horizon;
+    cache.count = parser.getCount();
+    for (size_t i = 0; i < parser.getCount(); i++) {
+        cache.events[i] = parser.getEvent(i);
+    }
+}
+
+bool CalendarWidget::loadCache() {
+    if (!Storage::exists(StorageUse::IMAGE_CACHE, cacheName)) return false;
+
+    fs::File file = Storage::open(StorageUse::IMAGE_CACHE, cacheName, "r");
+    if (!file) return false;
+    bool ok = file.read(reinterpret_cast<uint8_t*>(&cache), sizeof(cache)) == sizeof(cache);
+    file.close();
+
+    if (!ok || cache.magic != CACHE_MAGIC || cache.sourceHash != sourceHash || cache.count > IcsParser::MAX_EVENTS) {
+        LOG_INFO("CalendarWidget", "%s is for another build or feed, ignoring it", cacheName);
+        memset(&cache, 0, sizeof(cache));
+        return false;
+    }
+    return true;
+}
+
+bool CalendarWidget::saveCache() {
+    Storage::remove(StorageUse::IMAGE_CACHE, cacheName);
+    if (!Storage::reserve(StorageUse::IMAGE_CACHE, sizeof(cache))) {
+        LOG_WARN("CalendarWidget", "No room for the calendar cache");
+        return false;
+    }
+
+    fs::File file = Storage::open(StorageUse::IMAGE_CACHE, cacheName, "w");
+    if (!file) {
+        LOG_ERROR("CalendarWidget", "Failed to open %s for writing", cacheName);
+        return false;
+    }
+    size_t written = file.write(reinterpret_cast<const uint8_t*>(&cache), sizeof(cache));
+    file.close();
+
+    if (written != sizeof(cache)) {
+        LOG_ERROR("CalendarWidget", "Short write to %s", cacheName);
+        Storage::remove(StorageUse::IMAGE_CACHE, cacheName);
+        return false;
+    }
+    Storage::recordWrite(StorageUse::IMAGE_CACHE, cacheName, sizeof(cache));
+    return true;
+}
+
+void CalendarWidget::selectShown(uint32_t now) {
+    shownCount = 0;
+    nextEventEnd = 0;
+    if (cache.magic != CACHE_MAGIC) return;
+
+    uint32_t windowEnd = now + days * 86400u;
+    for (uint32_t i = 0; i < cache.count && shownCount < static_cast<size_t>(maxEvents); i++) {
+        const CalendarEvent& event = cache.events[i];
+        uint32_t end = std::max(event.end, event.start + 1);
+        if (end <= now || event.start >= windowEnd) continue;
+        shown[shownCount++] = static_cast<uint8_t>(i);
+        if (nextEventEnd == 0 || end < nextEventEnd) nextEventEnd = end;
+    }
+}
+
+void CalendarWidget::render(const LayoutRegion& region) {
+    LOG_DEBUG("CalendarWidget", "Rendering in region: %dx%d at (%d,%d)",
+              region.getWidth(), region.getHeight(), region.getX(), region.getY());
+
+    clearRegion(region);
+    update();
+
+    int x = region.getX() + MARGIN;
+    int y = region.getY() + MARGIN;
+    int bottom = region.getY() + region.getHeight() - MARGIN;
+
+    display.setCursor(x, y);
+    display.setTextSize(2);
+    display.setTextColor(0);
+    display.setTextWrap(false);
+    display.print("CALENDAR");
+    y += 30;
+
+    if (waitingForClock || shownCount == 0) {
+        display.setCursor(x, y);
+        display.setTextSize(1);
+        display.print(waitingForClock ? "Waiting for clock" : "No upcoming events");
+    }
+    for (size_t i = 0; i < shownCount && y + LINE_HEIGHT <= bottom; i++) {
+        drawEventLine(x, y, getEvent(i));
+        y += LINE_HEIGHT;
+    }
+
+    lastCalendarUpdate = millis();
+}
+
+void CalendarWidget::drawEventLine(int x, int y, const CalendarEvent& event) {
+    time_t start = event.start;
+    struct tm local;
+    localtime_r(&start, &local);
+    char when[24];
+    strftime(when, sizeof(when), event.allDay ? "%a %d %b" : "%a %d %b %H:%M", &local);
+
+    display.setCursor(x, y);
+    display.setTextSize(1);
+    display.print(when);
+    display.setCursor(x, y + 10);
+    display.setTextSize(2);
+    display.print(event.summary);
+}
+
+void CalendarWidget::renderToCompositor(Compositor& compositor, const LayoutRegion& region) {
+    LOG_DEBUG("CalendarWidget", "Rendering to compositor in region: %dx%d at (%d,%d)",
+              region.getWidth(), region.getHeight(), region.getX(), region.getY());
+
+    clearRegionOnCompositor(compositor, region);
+    update();
+
+    int x = region.getX() + MARGIN;
+    int y = region.getY() + MARGIN;
+    int bottom = region.getY() + region.getHeight() - MARGIN;
+    int width = region.getWidth() - 2 * MARGIN;
+
+    // Title area
+    compositor.fillRect(x, y, 96, 16, 0);
+    y += 30;
+
+    // Each event: a gray time row and a black summary bar as long as its text
+    for (size_t i = 0; i < shownCount && y + LINE_HEIGHT <= bottom; i++) {
+        const CalendarEvent& event = getEvent(i);
+        compositor.fillRect(x, y, event.allDay ? 54 : 84, 7, 0xaa);
+        int summaryWidth = std::min(static_cast<int>(strlen(event.summary)) * 12, width);
+        if (summaryWidth > 0) {
+            compositor.fillRect(x, y + 10, summaryWidth, 14, 0);
+        }
+        y += LINE_HEIGHT;
+    }
+
+    lastCalendarUpdate = millis();
+}
+
+WidgetType CalendarWidget::getWidgetType() const {
+    return WidgetTypeTraits<CalendarWidget>::type();
+}
@@ -0,0 +1,91 @@
+#ifndef CALENDAR_WIDGET_H
+#define CALENDAR_WIDGET_H
+
+#include "../../core/Widget.h"
+#include "IcsParser.h"
+#include <cstdint>
+
+// Forward declaration
+class Compositor;
+
+/**
+ * Upcoming events from an iCalendar feed: an http(s) URL, or a file on the
+ * config storage when the source starts with '/'.
+ *
+ * The feed is parsed as it downloads (IcsParser), so its size doesn't
+ * matter; only the soonest events are kept. They go to a small cache file
+ * with the response's ETag and Last-Modified, and the next fetch is
+ * conditional: a 304 costs a few hundred bytes instead of the whole feed.
+ * The cache covers a day past the shown window so most wakes can use it;
+ * once it runs short of events it is fetched unconditionally again. A
+ * failed fetch falls back to the cache, however old. When the cache covers
+ * the window, a due update draws it straight away and the conditional
+ * fetch waits for revalidate(), after the panel is up.
+ */
+class CalendarWidget : public Widget {
+public:
+    CalendarWidget(Inkplate& display, const String& source, int maxEvents, int days,
+                   unsigned long updateInterval);
+
+    // Widget interface implementation
+    void render(const LayoutRegion& region) override;
+    void renderToCompositor(Compositor& compositor, const LayoutRegion& region) override;
+    bool shouldUpdate() override;
+    void begin() override;
+    void forceUpdate() override;
+    bool revalidate() override;
+    WidgetType getWidgetType() const override;
+
+    // Made public for testing
+    bool refresh();
+    size_t getEventCount() const { return shownCount; }
+    const CalendarEvent& getEvent(size_t index) const { return cache.events[shown[index]]; }
+    bool wasNotModified() const { return lastNotModified; }
+
+private:
+    static const uint32_t CACHE_MAGIC = 0x43414c31;  // "CAL1"
+    static const size_t CHUNK_BYTES = 512;
+
+    // Cache file contents, written as is
+    struct Cache {
+        uint32_t magic;
+        uint32_t sourceHash;
+        uint32_t parsedAt;              // Window start of the parse
+        uint32_t horizon;               // Window end of the parse
+        uint32_t count;
+        char etag[64];
+        char lastModified[40];
+        CalendarEvent events[IcsParser::MAX_EVENTS];
+    };
+
+    String source;
+    int maxEvents;
+    int days;
+    unsigned long updateInterval;
+    unsigned long lastCalendarUpdate;
+    unsigned long lastFetch;
+    bool waitingForClock;
+    bool lastNotModified;
+    bool revalidatePending;             // Drawn from the cache, fetch after the render
+    uint32_t nextEventEnd;              // When the first shown event is over
+
+    uint32_t sourceHash;
+    char cacheName[20];
+    bool cacheRead;
+    Cache cache;
+    uint8_t shown[IcsParser::MAX_EVENTS];
+    size_t shownCount;
+
+    void update();
+    bool loadCache();
+    bool saveCache();
+    bool cacheCovers(uint32_t now) const;
+    bool sameShown(const CalendarEvent* events, size_t count) const;
+    bool fetchUrl(uint32_t now, bool conditional);
+    bool readFile(uint32_t now);
+    void keep(const IcsParser& parser, uint32_t now, uint32_t horizon);
+    void selectShown(uint32_t now);
+    void drawEventLine(int x, int y, const CalendarEvent& event);
+};
+
+#endif
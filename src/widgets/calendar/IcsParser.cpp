@@ -0,0 +1,418 @@
+#include "IcsParser.h"
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+IcsParser::IcsParser(uint32_t windowStart, uint32_t windowEnd, size_t keep)
+    : windowStart(windowStart), windowEnd(windowEnd), keep(keep < MAX_EVENTS ? keep : MAX_EVENTS), count(0),
+      eventsRead(0), lineLength(0), lineEnded(false), inEvent(false), nestedDepth(0), hasStart(false),
+      cancelled(false), duration(0), current(), recurrence(), startUtc(false), uid(0), recurrenceId(0), exdates(),
+      exdateCount(0), overrides(), overrideCount(0) {}
+
+void IcsParser::feed(const char* data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        char c = data[i];
+        if (c == '\r') continue;
+        if (lineEnded) {
+            lineEnded = false;
+            // Folded: the break and the one whitespace character go
+            if (c == ' ' || c == '\t') continue;
+            processLine();
+        }
+        if (c == '\n') {
+            lineEnded = true;
+        } else if (lineLength < LINE_CHARS - 1) {
+            line[lineLength++] = c;
+        }
+    }
+}
+
+void IcsParser::finish() {
+    if (lineLength > 0) {
+        processLine();
+    }
+    lineEnded = false;
+}
+
+// Days since 1970-01-01 of a proleptic Gregorian date
+static int32_t daysFromCivil(int year, int month, int day) {
+    year -= month <= 2;
+    int era = (year >= 0 ? year : year - 399) / 400;
+    int yearOfEra = year - era * 400;
+    int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+static int digits(const char* text, int length) {
+    int value = 0;
+    for (int i = 0; i < length; i++) {
+        if (text[i] < '0' || text[i] > '9') return -1;
+        value = value * 10 + (text[i] - '0');
+    }
+    return value;
+}
+
+bool IcsParser::parseTime(const char* value, bool utc, uint32_t& epoch, bool& allDay) {
+    // 20240115 or 20240115T093000 or 20240115T093000Z
+    int year = digits(value, 4), month = digits(value + 4, 2), day = digits(value + 6, 2);
+    if (year < 1970 || month < 1 || month > 12 || day < 1 || day > 31) return false;
+
+    int hour = 0, minute = 0, second = 0;
+    allDay = value[8] != 'T';
+    if (!allDay) {
+        hour = digits(value + 9, 2);
+        minute = digits(value + 11, 2);
+        second = digits(value + 13, 2);
+        if (hour < 0 || minute < 0 || second < 0) return false;
+        utc = utc || value[15] == 'Z';
+    }
+
+    if (utc && !allDay) {
+        epoch = static_cast<uint32_t>(daysFromCivil(year, month, day)) * 86400u + hour * 3600 + minute * 60 + second;
+        return true;
+    }
+    // Wall-clock time where the device is
+    struct tm local = {};
+    local.tm_year = year - 1900;
+    local.tm_mon = month - 1;
+    local.tm_mday = day;
+    local.tm_hour = hour;
+    local.tm_min = minute;
+    local.tm_sec = second;
+    local.tm_isdst = -1;
+    time_t converted = mktime(&local);
+    if (converted < 0) return false;
+    epoch = static_cast<uint32_t>(converted);
+    return true;
+}
+
+uint32_t IcsParser::parseDuration(const char* value) {
+    // P1W, P1D, PT1H30M, P1DT2H; signs and fractions are not used for events
+    if (*value == '+') value++;
+    if (*value != 'P') return 0;
+    uint32_t seconds = 0;
+    for (const char* p = value + 1; *p;) {
+        if (*p == 'T') {
+            p++;
+            continue;
+        }
+        char* unit;
+        unsigned long amount = strtoul(p, &unit, 10);
+        if (unit == p) return 0;
+        switch (*unit) {
+            case 'W': seconds += amount * 604800; break;
+            case 'D': seconds += amount * 86400; break;
+            case 'H': seconds += amount * 3600; break;
+            case 'M': seconds += amount * 60; break;
+            case 'S': seconds += amount; break;
+            default: return 0;
+        }
+        p = unit + 1;
+    }
+    return seconds;
+}
+
+static const uint32_t WEEK = 604800;
+
+static uint32_t hashUid(const char* value) {
+    uint32_t hash = 2166136261u;
+    for (const char* p = value; *p; p++) {
+        hash = (hash ^ static_cast<uint8_t>(*p)) * 16777619u;
+    }
+    return hash;
+}
+
+void IcsParser::parseRule(const char* value) {
+    // FREQ=WEEKLY;INTERVAL=2;COUNT=10;BYDAY=MO,TH (UNTIL is a DATE or DATE-TIME)
+    static const char* const DAYS[] = {"MO", "TU", "WE", "TH", "FR", "SA", "SU"};
+    uint32_t base = 0, interval = 1;
+    uint8_t weekdays = 0;
+    bool daily = false;
+    bool supported = true;
+    char part[48];
+    while (*value) {
+        size_t length = strcspn(value, ";");
+        size_t copied = length < sizeof(part) - 1 ? length : sizeof(part) - 1;
+        memcpy(part, value, copied);
+        part[copied] = '\0';
+        value += length + (value[length] == ';');
+
+        if (strcmp(part, "FREQ=DAILY") == 0) {
+            base = 86400;
+            daily = true;
+        } else if (strcmp(part, "FREQ=WEEKLY") == 0) {
+            base = WEEK;
+        } else if (strncmp(part, "FREQ=", 5) == 0) {
+            supported = false;  // Monthly and yearly: first occurrence only
+        } else if (strncmp(part, "INTERVAL=", 9) == 0) {
+            interval = strtoul(part + 9, nullptr, 10);
+        } else if (strncmp(part, "COUNT=", 6) == 0) {
+            recurrence.count = strtoul(part + 6, nullptr, 10);
+        } else if (strncmp(part, "UNTIL=", 6) == 0) {
+            bool allDay;
+            if (parseTime(part + 6, false, recurrence.until, allDay) && allDay) {
+                recurrence.until += 86399;  // Through the end of that day
+            }
+        } else if (strncmp(part, "BYDAY=", 6) == 0) {
+            // Plain days only; "1MO" or "-1FR" belong to monthly rules
+            for (const char* day = part + 6; *day;) {
+                size_t dayLength = strcspn(day, ",");
+                int found = -1;
+                for (int i = 0; i < 7; i++) {
+                    if (dayLength == 2 && strncmp(day, DAYS[i], 2) == 0) found = i;
+                }
+                day += dayLength + (day[dayLength] == ',');
+                if (found < 0) {
+                    supported = false;
+                } else {
+                    weekdays |= static_cast<uint8_t>(1 << found);
+                }
+            }
+        } else if (strncmp(part, "BY", 2) == 0) {
+            supported = false;  // BYMONTHDAY, BYSETPOS and the like: first occurrence only
+        }
+    }
+
+    // Daily on some weekdays is weekly on those days
+    if (daily && weekdays != 0) {
+        if (interval != 1) supported = false;
+        base = WEEK;
+    }
+    recurrence.weekdays = weekdays;
+    recurrence.period = supported && interval > 0 ? base * interval : 0;
+}
+
+void IcsParser::parseExdates(const char* value) {
+    // EXDATE;TZID=Europe/Berlin:20240122T090000,20240129T090000 (may repeat)
+    while (*value) {
+        size_t length = strcspn(value, ",");
+        uint32_t epoch;
+        bool allDay;
+        if (exdateCount < MAX_EXDATES && parseTime(value, false, epoch, allDay)) {
+            exdates[exdateCount++] = epoch;
+        }
+        value += length + (value[length] == ',');
+    }
+}
+
+void IcsParser::beginEvent() {
+    inEvent = true;
+    nestedDepth = 0;
+    hasStart = false;
+    cancelled = false;
+    duration = 0;
+    startUtc = false;
+    uid = 0;
+    recurrenceId = 0;
+    exdateCount = 0;
+    memset(&current, 0, sizeof(current));
+    memset(&recurrence, 0, sizeof(recurrence));
+}
+
+void IcsParser::endEvent() {
+    inEvent = false;
+    eventsRead++;
+    // Even a cancelled override takes its occurrence out of the series
+    if (recurrenceId != 0 && uid != 0) addOverride();
+    if (!hasStart || cancelled) return;
+
+    uint32_t start = current.start;
+    uint32_t length;
+    if (current.end > start) {
+        length = current.end - start;
+    } else if (duration > 0) {
+        length = duration;
+    } else {
+        length = current.allDay ? 86400 : 0;
+    }
+
+    if (recurrence.period == 0) {
+        if (!isReplaced(start)) offer(start, start + length);
+        return;
+    }
+    if (recurrence.weekdays != 0) {
+        expandWeekdays(start, length);
+        return;
+    }
+
+    // Skip to the first occurrence still running at the window start
+    uint32_t index = 0;
+    if (start + length <= windowStart) {
+        index = (windowStart - start - length) / recurrence.period + 1;
+    }
+    for (size_t offered = 0; offered < keep; index++) {
+        uint32_t occurrence = start + index * recurrence.period;
+        if (recurrence.count > 0 && index >= recurrence.count) break;
+        if (recurrence.until > 0 && occurrence > recurrence.until) break;
+        if (occurrence >= windowEnd) break;
+        if (isReplaced(occurrence)) continue;
+        offer(occurrence, occurrence + length);
+        offered++;
+    }
+}
+
+void IcsParser::expandWeekdays(uint32_t start, uint32_t length) {
+    // Weeks run Monday to Sunday; days before DTSTART in its week don't count
+    time_t startTime = static_cast<time_t>(start);
+    struct tm parts;
+    if (startUtc) {
+        gmtime_r(&startTime, &parts);
+    } else {
+        localtime_r(&startTime, &parts);
+    }
+    uint32_t startDay = static_cast<uint32_t>((parts.tm_wday + 6) % 7);
+    uint32_t monday = start - startDay * 86400;
+
+    uint32_t perWeek = 0, firstWeek = 0;
+    for (uint32_t day = 0; day < 7; day++) {
+        if (!(recurrence.weekdays & (1 << day))) continue;
+        perWeek++;
+        if (day >= startDay) firstWeek++;
+    }
+
+    // Skip the weeks that are over before the window starts
+    uint32_t week = 0;
+    uint32_t index = 0;
+    uint32_t weekEnd = 6 * 86400 + length;
+    if (monday + weekEnd < windowStart) {
+        week = (windowStart - monday - weekEnd) / recurrence.period;
+        if (week > 0) index = firstWeek + (week - 1) * perWeek;
+    }
+    for (size_t offered = 0; offered < keep; week++) {
+        uint32_t weekStart = monday + week * recurrence.period;
+        for (uint32_t day = 0; day < 7; day++) {
+            if (!(recurrence.weekdays & (1 << day))) continue;
+            uint32_t occurrence = weekStart + day * 86400;
+            if (occurrence < start) continue;
+            if (recurrence.count > 0 && index >= recurrence.count) return;
+            index++;
+            if (recurrence.until > 0 && occurrence > recurrence.until) return;
+            if (occurrence >= windowEnd) return;
+            if (isReplaced(occurrence)) continue;
+            offer(occurrence, occurrence + length);
+            offered++;
+        }
+    }
+}
+
+bool IcsParser::isReplaced(uint32_t occurrence) const {
+    if (recurrenceId != 0) return false;  // This is the replacement
+    for (size_t i = 0; i < exdateCount; i++) {
+        if (exdates[i] == occurrence) return true;
+    }
+    if (uid == 0) return false;
+    for (size_t i = 0; i < overrideCount; i++) {
+        if (overrides[i].uid == uid && overrides[i].start == occurrence) return true;
+    }
+    return false;
+}
+
+void IcsParser::addOverride() {
+    // The series came first: drop the occurrence it already offered
+    size_t kept = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (eventUids[i] == uid && events[i].start == recurrenceId) continue;
+        events[kept] = events[i];
+        eventUids[kept] = eventUids[i];
+        kept++;
+    }
+    count = kept;
+
+    if (overrideCount < MAX_OVERRIDES) {
+        overrides[overrideCount].uid = uid;
+        overrides[overrideCount].start = recurrenceId;
+        overrideCount++;
+    }
+}
+
+void IcsParser::offer(uint32_t start, uint32_t end) {
+    if (end <= windowStart || start >= windowEnd) return;
+    // An instant event still shows while it is happening
+    if (end == start && start < windowStart) return;
+
+    // Sorted by start; a full list only takes an earlier event
+    size_t at = count;
+    while (at > 0 && events[at - 1].start > start) at--;
+    if (at >= keep) return;
+    size_t last = count < keep ? count : keep - 1;
+    memmove(&events[at + 1], &events[at], (last - at) * sizeof(CalendarEvent));
+    memmove(&eventUids[at + 1], &eventUids[at], (last - at) * sizeof(uint32_t));
+    events[at] = current;
+    eventUids[at] = uid;
+    events[at].start = start;
+    events[at].end = end;
+    if (count < keep) count++;
+}
+
+void IcsParser::processLine() {
+    line[lineLength] = '\0';
+    lineLength = 0;
+
+    // NAME;PARAM=x;PARAM="a:b":VALUE
+    char* value = nullptr;
+    bool quoted = false;
+    for (char* p = line; *p; p++) {
+        if (*p == '"') quoted = !quoted;
+        if (*p == ':' && !quoted) {
+            *p = '\0';
+            value = p + 1;
+            break;
+        }
+    }
+    if (!value) return;
+    char* params = strchr(line, ';');
+    if (params) *params++ = '\0';
+    const char* name = line;
+
+    if (strcmp(name, "BEGIN") == 0) {
+        if (strcmp(value, "VEVENT") == 0 && !inEvent) {
+            beginEvent();
+        } else if (inEvent) {
+            nestedDepth++;
+        }
+        return;
+    }
+    if (strcmp(name, "END") == 0) {
+        if (inEvent && nestedDepth > 0) {
+            nestedDepth--;
+        } else if (inEvent && strcmp(value, "VEVENT") == 0) {
+            endEvent();
+        }
+        return;
+    }
+    if (!inEvent || nestedDepth > 0) return;
+
+    if (strcmp(name, "DTSTART") == 0) {
+        hasStart = parseTime(value, false, current.start, current.allDay);
+        startUtc = strlen(value) >= 16 && value[15] == 'Z';
+    } else if (strcmp(name, "DTEND") == 0) {
+        bool allDay;
+        if (!parseTime(value, false, current.end, allDay)) current.end = 0;
+    } else if (strcmp(name, "DURATION") == 0) {
+        duration = parseDuration(value);
+    } else if (strcmp(name, "RRULE") == 0) {
+        parseRule(value);
+    } else if (strcmp(name, "EXDATE") == 0) {
+        parseExdates(value);
+    } else if (strcmp(name, "UID") == 0) {
+        uid = hashUid(value);
+    } else if (strcmp(name, "RECURRENCE-ID") == 0) {
+        bool allDay;
+        if (!parseTime(value, false, recurrenceId, allDay)) recurrenceId = 0;
+    } else if (strcmp(name, "STATUS") == 0) {
+        cancelled = strcmp(value, "CANCELLED") == 0;
+    } else if (strcmp(name, "SUMMARY") == 0) {
+        // Unescape \, \; \\ and turn \n into a space
+        size_t length = 0;
+        for (const char* p = value; *p && length < CalendarEvent::SUMMARY_CHARS - 1; p++) {
+            char c = *p;
+            if (c == '\\' && p[1]) {
+                c = *++p;
+                if (c == 'n' || c == 'N') c = ' ';
+            }
+            current.summary[length++] = c;
+        }
+        current.summary[length] = '\0';
+    }
+}
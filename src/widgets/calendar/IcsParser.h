@@ -0,0 +1,116 @@
+#ifndef ICS_PARSER_H
+#define ICS_PARSER_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * One event occurrence, fixed size so a list of them needs no allocation
+ */
+struct CalendarEvent {
+    static const size_t SUMMARY_CHARS = 48;
+
+    uint32_t start;                     // Seconds (UTC)
+    uint32_t end;
+    bool allDay;
+    char summary[SUMMARY_CHARS];        // Cut to fit, always terminated
+};
+
+/**
+ * Single-pass iCalendar (RFC 5545) reader that keeps only the soonest
+ * events overlapping a time window.
+ *
+ * Text is fed in chunks of any size as it arrives, so a feed of hundreds
+ * of KB never has to be held in memory: the parser needs one LINE_CHARS
+ * line buffer, the event being read and the `keep` results, sorted by
+ * start. Folded lines are joined; anything past LINE_CHARS is dropped,
+ * which only ever cuts a long SUMMARY or DESCRIPTION.
+ *
+ * Times ending in Z are UTC; floating and TZID times are taken as the
+ * device's local time (mktime), as are all-day dates. DAILY and WEEKLY
+ * RRULEs with INTERVAL, COUNT and UNTIL are expanded into the window, as is
+ * BYDAY on weekly rules (and on daily ones with INTERVAL=1); other rules
+ * count as their first occurrence only. EXDATEs are left out, and an
+ * occurrence moved or cancelled by a RECURRENCE-ID override is replaced by
+ * the override, whichever of the two comes first in the feed. Cancelled
+ * events and the contents of VALARM and other nested components are
+ * skipped.
+ */
+class IcsParser {
+public:
+    static const size_t MAX_EVENTS = 16;
+    static const size_t LINE_CHARS = 160;
+    static const size_t MAX_EXDATES = 8;        // Per event; more are shown anyway
+    static const size_t MAX_OVERRIDES = 16;     // RECURRENCE-IDs remembered across the feed
+
+    IcsParser(uint32_t windowStart, uint32_t windowEnd, size_t keep);
+
+    void feed(const char* data, size_t length);
+    // After the last chunk: handles a final line without a line break
+    void finish();
+
+    size_t getCount() const { return count; }
+    const CalendarEvent& getEvent(size_t index) const { return events[index]; }
+    // VEVENTs read, whether kept or not
+    size_t getEventsRead() const { return eventsRead; }
+
+    // Made public for testing; false if value isn't a DATE or DATE-TIME
+    static bool parseTime(const char* value, bool utc, uint32_t& epoch, bool& allDay);
+    static uint32_t parseDuration(const char* value);
+
+private:
+    struct Recurrence {
+        uint32_t period;                // Seconds between occurrences, 0 = none
+        uint32_t count;                 // Occurrences, 0 = unlimited
+        uint32_t until;                 // Last start, 0 = unlimited
+        uint8_t weekdays;               // Weekly BYDAY, bit 0 = Monday; 0 = DTSTART's day
+    };
+
+    // An occurrence of a recurring event that another VEVENT replaces
+    struct Override {
+        uint32_t uid;                   // Hash of the UID
+        uint32_t start;                 // RECURRENCE-ID
+    };
+
+    uint32_t windowStart;
+    uint32_t windowEnd;
+    size_t keep;
+    CalendarEvent events[MAX_EVENTS];
+    uint32_t eventUids[MAX_EVENTS];     // UID hash of each kept event
+    size_t count;
+    size_t eventsRead;
+
+    // Line being assembled
+    char line[LINE_CHARS];
+    size_t lineLength;
+    bool lineEnded;                     // Saw a line break; a space or tab next continues it
+
+    // Event being read
+    bool inEvent;
+    int nestedDepth;                    // Inside VALARM and the like
+    bool hasStart;
+    bool cancelled;
+    uint32_t duration;
+    CalendarEvent current;
+    Recurrence recurrence;
+    bool startUtc;                      // DTSTART ended in Z: BYDAY days are UTC days
+    uint32_t uid;
+    uint32_t recurrenceId;              // 0 unless this VEVENT overrides an occurrence
+    uint32_t exdates[MAX_EXDATES];
+    size_t exdateCount;
+
+    Override overrides[MAX_OVERRIDES];
+    size_t overrideCount;
+
+    void processLine();
+    void beginEvent();
+    void endEvent();
+    void offer(uint32_t start, uint32_t end);
+    void expandWeekdays(uint32_t start, uint32_t length);
+    bool isReplaced(uint32_t occurrence) const;
+    void addOverride();
+    void parseRule(const char* value);
+    void parseExdates(const char* value);
+};
+
+#endif
@@ -0,0 +1,274 @@
+#include "ChartWidget.h"
+#include "../weather/HourlyForecast.h"
+#include "../../core/Logger.h"
+#include "../../core/Compositor.h"
+#include "../../managers/ConfigManager.h"
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+
+// Before this the clock has not been set
+static const time_t MIN_EPOCH = 1577836800;  // 2020-01-01
+
+ChartWidget::ChartWidget(Inkplate& display, int hours, unsigned long updateInterval)
+    : Widget(display), hours(std::min(std::max(hours, 2), HourlyForecast::MAX_HOURS)),
+      updateInterval(updateInterval), lastChartUpdate(0), drawn(false), drawnGeometry(), drawnLow(0),
+      drawnHigh(0), drawnHour(0), drawnRevision(0), reportedRevision(0), lastChangedColumns(0) {
+    LOG_INFO("ChartWidget", "Created for %d hours, update interval: %lu ms", this->hours, updateInterval);
+}
+
+void ChartWidget::begin() {
+    LOG_INFO("ChartWidget", "Initializing chart widget...");
+    lastChartUpdate = 0;
+    drawn = false;
+}
+
+void ChartWidget::forceUpdate() {
+    // Axes and all columns again on the next render
+    lastChartUpdate = 0;
+    drawn = false;
+}
+
+bool ChartWidget::shouldUpdate() {
+    if (lastChartUpdate == 0 || millis() - lastChartUpdate >= updateInterval) {
+        return true;
+    }
+    // A new forecast or the next hour
+    return HourlyForecast::getRevision() != drawnRevision || currentHour() != drawnHour;
+}
+
+bool ChartWidget::revalidate() {
+    // Nothing of its own to fetch: the weather widget may have revised the forecast.
+    // Reported once, so later passes don't see the same revision as news
+    uint32_t revision = HourlyForecast::getRevision();
+    if (revision == drawnRevision || revision == reportedRevision) {
+        return false;
+    }
+    reportedRevision = revision;
+    return true;
+}
+
+uint32_t ChartWidget::currentHour() const {
+    time_t now = time(nullptr);
+    if (now >= MIN_EPOCH) {
+        return static_cast<uint32_t>(now / 3600);
+    }
+    // No clock yet: start where the forecast does
+    return HourlyForecast::getCount() > 0 ? HourlyForecast::getEpoch(0) / 3600 : 0;
+}
+
+uint32_t ChartWidget::hourOfColumn(uint32_t startHour, int column) const {
+    int offset = (column - static_cast<int>(startHour % hours) + hours) % hours;
+    return startHour + offset;
+}
+
+bool ChartWidget::layout(const LayoutRegion& region, Geometry& geometry) const {
+    geometry.plotX = region.getX() + MARGIN + LABEL_WIDTH;
+    geometry.plotY = region.getY() + MARGIN;
+    geometry.columnWidth = (region.getWidth() - 2 * MARGIN - LABEL_WIDTH) / hours;
+    geometry.plotHeight = region.getHeight() - 2 * MARGIN - STRIP_HEIGHT;
+    geometry.axisY = geometry.plotY + geometry.plotHeight;
+    return geometry.columnWidth >= 2 && geometry.plotHeight >= 10;
+}
+
+bool ChartWidget::scaleFor(uint32_t startHour, int& low, int& high) const {
+    float lowest = INFINITY;
+    float highest = -INFINITY;
+    for (int column = 0; column < hours; column++) {
+        int index = HourlyForecast::find(hourOfColumn(startHour, column) * 3600);
+        if (index < 0 || std::isnan(HourlyForecast::getTemperature(index))) continue;
+        lowest = std::min(lowest, HourlyForecast::getTemperature(index));
+        highest = std::max(highest, HourlyForecast::getTemperature(index));
+    }
+    if (lowest > highest) {
+        low = 0;
+        high = 10;
+        return false;
+    }
+    // Whole tens, so the scale survives small changes in the forecast
+    low = static_cast<int>(std::floor(lowest / 10.0f)) * 10;
+    high = std::max(static_cast<int>(std::ceil(highest / 10.0f)) * 10, low + 10);
+    return true;
+}
+
+void ChartWidget::columnsFor(uint32_t startHour, const Geometry& geometry, int low, int high,
+                             std::vector<Column>& columns) const {
+    columns.assign(hours, Column{-1, -1});
+    for (int column = 0; column < hours; column++) {
+        int index = HourlyForecast::find(hourOfColumn(startHour, column) * 3600);
+        if (index < 0) continue;
+
+        float temperature = HourlyForecast::getTemperature(index);
+        if (!std::isnan(temperature)) {
+            float y = (high - temperature) * (geometry.plotHeight - 1) / (high - low);
+            columns[column].markerY = static_cast<int16_t>(std::min(std::max(y, 0.0f), geometry.plotHeight - 1.0f));
+        }
+        int rain = HourlyForecast::getPrecipitation(index);
+        if (rain >= 0) {
+            columns[column].barHeight = static_cast<int16_t>(rain * geometry.plotHeight / 100);
+        }
+    }
+}
+
+void ChartWidget::drawColumn(Compositor& compositor, const Geometry& geometry, int column, const Column& values) {
+    int x = geometry.plotX + column * geometry.columnWidth;
+    compositor.fillRect(x, geometry.plotY, geometry.columnWidth, geometry.plotHeight, 255);
+
+    // Rain probability as a gray bar with a gap to the next column
+    if (values.barHeight > 0) {
+        int inset = geometry.columnWidth > 2 ? 1 : 0;
+        compositor.fillRect(x + inset, geometry.axisY - values.barHeight, geometry.columnWidth - 2 * inset,
+                            values.barHeight, BAR_COLOR);
+    }
+    // Temperature as a short black step, three pixels thick
+    if (values.markerY >= 0) {
+        int top = std::max(values.markerY - 1, 0);
+        compositor.fillRect(x, geometry.plotY + top, geometry.columnWidth,
+                            std::min(3, geometry.plotHeight - top), 0);
+    }
+}
+
+void ChartWidget::drawHourMark(Compositor& compositor, const Geometry& geometry, int column, bool on) {
+    int x = geometry.plotX + column * geometry.columnWidth;
+    compositor.fillRect(x, geometry.axisY + 5, geometry.columnWidth, STRIP_HEIGHT - 5, on ? 0 : 255);
+}
+
+void ChartWidget::renderToCompositor(Compositor& compositor, const LayoutRegion& region) {
+    LOG_DEBUG("ChartWidget", "renderToCompositor() called - region: %dx%d at (%d,%d)",
+              region.getWidth(), region.getHeight(), region.getX(), region.getY());
+
+    clearRegionOnCompositor(compositor, region);
+    lastChartUpdate = millis();
+    drawnRevision = HourlyForecast::getRevision();
+    drawnHour = currentHour();
+    drawn = false;
+
+    Geometry geometry;
+    if (!layout(region, geometry)) {
+        LOG_WARN("ChartWidget", "Region %dx%d is too small for %d columns", region.getWidth(), region.getHeight(),
+                 hours);
+        return;
+    }
+    int low, high;
+    scaleFor(drawnHour, low, high);
+
+    // Axes, a tick every six hours, and the scale labels
+    int plotWidth = geometry.columnWidth * hours;
+    compositor.fillRect(geometry.plotX - 1, geometry.plotY, 1, geometry.plotHeight + 1, 0);
+    compositor.fillRect(geometry.plotX - 1, geometry.axisY, plotWidth + 1, 1, 0);
+    if (hours % TICK_HOURS == 0) {
+        for (int column = 0; column < hours; column += TICK_HOURS) {
+            compositor.fillRect(geometry.plotX + column * geometry.columnWidth, geometry.axisY + 1, 1, 3, 0);
+        }
+    }
+    compositor.fillRect(region.getX() + MARGIN, geometry.plotY, LABEL_WIDTH - 6, 7, 0);       // high
+    compositor.fillRect(region.getX() + MARGIN, geometry.axisY - 7, LABEL_WIDTH - 6, 7, 0);   // low
+
+    columnsFor(drawnHour, geometry, low, high, drawnColumns);
+    for (int column = 0; column < hours; column++) {
+        drawColumn(compositor, geometry, column, drawnColumns[column]);
+    }
+    drawHourMark(compositor, geometry, drawnHour % hours, true);
+
+    drawn = true;
+    drawnGeometry = geometry;
+    drawnLow = low;
+    drawnHigh = high;
+    lastChangedColumns = hours;
+}
+
+bool ChartWidget::updateOnCompositor(Compositor& compositor, const LayoutRegion& region) {
+    Geometry geometry;
+    if (!drawn || !layout(region, geometry) || geometry.plotX != drawnGeometry.plotX ||
+        geometry.plotY != drawnGeometry.plotY || geometry.columnWidth != drawnGeometry.columnWidth ||
+        geometry.plotHeight != drawnGeometry.plotHeight) {
+        return false;
+    }
+
+    uint32_t startHour = currentHour();
+    int low, high;
+    if (scaleFor(startHour, low, high) && (low < drawnLow || high > drawnHigh)) {
+        LOG_DEBUG("ChartWidget", "Forecast %d..%d is outside the drawn scale %d..%d", low, high, drawnLow, drawnHigh);
+        return false;
+    }
+
+    // Only the columns that look different are cleared and drawn again
+    std::vector<Column> columns;
+    columnsFor(startHour, geometry, drawnLow, drawnHigh, columns);
+    int changed = 0;
+    for (int column = 0; column < hours; column++) {
+        if (columns[column] != drawnColumns[column]) {
+            drawColumn(compositor, geometry, column, columns[column]);
+            changed++;
+        }
+    }
+    if (startHour % hours != drawnHour % hours) {
+        drawHourMark(compositor, geometry, drawnHour % hours, false);
+        drawHourMark(compositor, geometry, startHour % hours, true);
+    }
+    LOG_DEBUG("ChartWidget", "Updated %d of %d columns", changed, hours);
+
+    drawnColumns.swap(columns);
+    drawnHour = startHour;
+    drawnRevision = HourlyForecast::getRevision();
+    lastChangedColumns = changed;
+    lastChartUpdate = millis();
+    return true;
+}
+
+void ChartWidget::render(const LayoutRegion& region) {
+    LOG_DEBUG("ChartWidget", "render() called - region: %dx%d at (%d,%d)",
+              region.getWidth(), region.getHeight(), region.getX(), region.getY());
+
+    clearRegion(region);
+    lastChartUpdate = millis();
+    drawnRevision = HourlyForecast::getRevision();
+    drawnHour = currentHour();
+    drawn = false;
+
+    Geometry geometry;
+    if (!layout(region, geometry)) {
+        LOG_WARN("ChartWidget", "Region %dx%d is too small for %d columns", region.getWidth(), region.getHeight(),
+                 hours);
+        return;
+    }
+    int low, high;
+    scaleFor(drawnHour, low, high);
+
+    int plotWidth = geometry.columnWidth * hours;
+    display.drawFastVLine(geometry.plotX - 1, geometry.plotY, geometry.plotHeight + 1, 0);
+    display.drawFastHLine(geometry.plotX - 1, geometry.axisY, plotWidth + 1, 0);
+    if (hours % TICK_HOURS == 0) {
+        for (int column = 0; column < hours; column += TICK_HOURS) {
+            display.drawFastVLine(geometry.plotX + column * geometry.columnWidth, geometry.axisY + 1, 3, 0);
+        }
+    }
+    display.setTextSize(1);
+    display.setTextColor(0);
+    display.setTextWrap(false);
+    display.setCursor(region.getX() + MARGIN, geometry.plotY);
+    display.print(high);
+    display.setCursor(region.getX() + MARGIN, geometry.axisY - 7);
+    display.print(low);
+
+    std::vector<Column> columns;
+    columnsFor(drawnHour, geometry, low, high, columns);
+    for (int column = 0; column < hours; column++) {
+        int x = geometry.plotX + column * geometry.columnWidth;
+        if (columns[column].barHeight > 0) {
+            int inset = geometry.columnWidth > 2 ? 1 : 0;
+            display.fillRect(x + inset, geometry.axisY - columns[column].barHeight,
+                             geometry.columnWidth - 2 * inset, columns[column].barHeight, 4);
+        }
+        if (columns[column].markerY >= 0) {
+            int top = std::max(columns[column].markerY - 1, 0);
+            display.fillRect(x, geometry.plotY + top, geometry.columnWidth, std::min(3, geometry.plotHeight - top), 0);
+        }
+    }
+    display.fillRect(geometry.plotX + (drawnHour % hours) * geometry.columnWidth, geometry.axisY + 5,
+                     geometry.columnWidth, STRIP_HEIGHT - 5, 0);
+}
+
+WidgetType ChartWidget::getWidgetType() const {
+    return WidgetTypeTraits<ChartWidget>::type();
+}
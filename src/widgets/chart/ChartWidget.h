@@ -0,0 +1,94 @@
+#ifndef CHART_WIDGET_H
+#define CHART_WIDGET_H
+
+#include "../../core/Widget.h"
+#include <cstdint>
+#include <vector>
+
+// Forward declaration
+class Compositor;
+
+/**
+ * Hourly temperature and rain chart from the forecast WeatherWidget fetches
+ * (HourlyForecast), for the next `hours` hours.
+ *
+ * Each hour has a fixed column, hour % hours, so the chart sweeps instead of
+ * scrolling: when the hour turns, the column that just went by is drawn again
+ * for the same hour a day (or `hours`) later and every other column keeps its
+ * hour. A small mark under the axis shows the current hour. The axes, ticks
+ * and scale are drawn by a full render only; updateOnCompositor() redraws
+ * just the columns whose bar or marker moved, so an hourly update is a
+ * partial refresh a few columns wide. A temperature outside the drawn scale
+ * needs a full render.
+ */
+class ChartWidget : public Widget {
+public:
+    // One column as drawn: marker row and bar height in pixels, -1 for none
+    struct Column {
+        int16_t markerY;
+        int16_t barHeight;
+
+        bool operator==(const Column& other) const {
+            return markerY == other.markerY && barHeight == other.barHeight;
+        }
+        bool operator!=(const Column& other) const { return !(*this == other); }
+    };
+
+    ChartWidget(Inkplate& display, int hours, unsigned long updateInterval);
+
+    // Widget interface implementation
+    void render(const LayoutRegion& region) override;
+    void renderToCompositor(Compositor& compositor, const LayoutRegion& region) override;
+    bool updateOnCompositor(Compositor& compositor, const LayoutRegion& region) override;
+    bool shouldUpdate() override;
+    void begin() override;
+    void forceUpdate() override;
+    bool revalidate() override;
+    WidgetType getWidgetType() const override;
+
+    // Made public for testing
+    int getColumnCount() const { return hours; }
+    int getLastChangedColumns() const { return lastChangedColumns; }
+
+private:
+    // Plot area within a region
+    struct Geometry {
+        int plotX;
+        int plotY;
+        int columnWidth;
+        int plotHeight;
+        int axisY;
+    };
+
+    int hours;
+    unsigned long updateInterval;
+    unsigned long lastChartUpdate;
+
+    // What the last compositor render drew
+    bool drawn;
+    Geometry drawnGeometry;
+    int drawnLow;
+    int drawnHigh;
+    uint32_t drawnHour;
+    uint32_t drawnRevision;
+    uint32_t reportedRevision;  // Last revision revalidate() returned true for
+    std::vector<Column> drawnColumns;
+    int lastChangedColumns;
+
+    static const int MARGIN = 10;
+    static const int LABEL_WIDTH = 24;  // Scale labels left of the axis
+    static const int STRIP_HEIGHT = 8;  // Ticks and the current hour mark
+    static const int TICK_HOURS = 6;
+    static const uint8_t BAR_COLOR = 0xaa;
+
+    bool layout(const LayoutRegion& region, Geometry& geometry) const;
+    uint32_t currentHour() const;
+    uint32_t hourOfColumn(uint32_t startHour, int column) const;
+    bool scaleFor(uint32_t startHour, int& low, int& high) const;
+    void columnsFor(uint32_t startHour, const Geometry& geometry, int low, int high,
+                    std::vector<Column>& columns) const;
+    void drawColumn(Compositor& compositor, const Geometry& geometry, int column, const Column& values);
+    void drawHourMark(Compositor& compositor, const Geometry& geometry, int column, bool on);
+};
+
+#endif
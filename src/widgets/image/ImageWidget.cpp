@@ -1,15 +1,73 @@
 #include "ImageWidget.h"
 #include "../../core/Logger.h"
 #include "../../core/Compositor.h"
+#include "../../core/MemoryTracker.h"
+#include "../../core/InputTrace.h"
+#include "../../core/Telemetry.h"
+#include "../../core/WakeMetrics.h"
 #include "../../managers/ConfigManager.h"
+#include <cstring>
+
+// Formats the panel can decode, and binary PGM for the host fixtures.
+// Anything else (a captive portal page, say) must not replace a good picture.
+static bool looksLikeImage(const String& image) {
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(image.c_str());
+    size_t size = image.length();
+    if (size >= 4 && memcmp(data, "\x89PNG", 4) == 0) return true;
+    if (size >= 2 && data[0] == 0xFF && data[1] == 0xD8) return true;  // JPEG
+    return size >= 2 && (memcmp(data, "BM", 2) == 0 || memcmp(data, "P5", 2) == 0);
+}
+
+// The decoder is picked from the first bytes; the bitmap one rejects non-BMP data itself
+static bool drawEncoded(Inkplate& display, uint8_t* data, int32_t size, int x, int y, bool dither) {
+    if (size >= 4 && memcmp(data, "\x89PNG", 4) == 0) {
+        return display.drawPngFromBuffer(data, size, x, y, dither, false);
+    }
+    if (size >= 2 && data[0] == 0xFF && data[1] == 0xD8) {
+        return display.drawJpegFromBuffer(data, size, x, y, dither, false);
+    }
+    return display.drawBitmapFromBuffer(data, x, y, dither, false);
+}
 
 ImageWidget::ImageWidget(Inkplate& display, const char* imageUrl)
-    : Widget(display), imageUrl(imageUrl), consecutiveFailures(0), lastImageUpdate(0) {}
+    : Widget(display), imageUrl(imageUrl), consecutiveFailures(0), lastImageUpdate(0),
+      cache((String("image:") + imageUrl).c_str(), IMAGE_FRESH_S, IMAGE_MAX_AGE_S), revalidatePending(false),
+      drawn(false), drawnHash(0) {}
 
 void ImageWidget::begin() {
     LOG_INFO("ImageWidget", "Initializing image widget...");
     consecutiveFailures = 0;
     lastImageUpdate = 0;
+    revalidatePending = false;
+    drawn = false;
+}
+
+void ImageWidget::forceUpdate() {
+    // Keep drawing the cached picture; ask the server after the next render
+    revalidatePending = true;
+    lastImageUpdate = 0;
+}
+
+bool ImageWidget::revalidate() {
+    if (!revalidatePending) {
+        return false;
+    }
+    revalidatePending = false;
+
+    String image;
+    if (!downloadImage(image)) {
+        // Offline: try again once connected. Otherwise the last good picture stays up.
+        revalidatePending = WiFi.status() != WL_CONNECTED;
+        return false;
+    }
+    if (drawn && hashImage(image) == drawnHash) {
+        LOG_INFO("ImageWidget", "Image unchanged (%u bytes)", static_cast<unsigned>(image.length()));
+        return false;
+    }
+
+    // The region is redrawn from the new copy
+    cache.store(image);
+    return true;
 }
 
 bool ImageWidget::shouldUpdate() {
@@ -23,19 +81,22 @@ void ImageWidget::render(const LayoutRegion& region) {
     LOG_DEBUG("ImageWidget", "Image URL: %s", imageUrl);
     LOG_DEBUG("ImageWidget", "WiFi Status: %s", WiFi.status() == WL_CONNECTED ? "Connected" : "Disconnected");
 
-    // Attempt to fetch and display image
-    if (fetchAndDisplay(region)) {
+    // Draw the local copy; only with nothing cached does this render wait for the server
+    if (loadAndDraw(region) || fetchAndDisplay(region)) {
         consecutiveFailures = 0;
         LOG_INFO("ImageWidget", "Image widget rendered successfully");
     } else {
         consecutiveFailures++;
+        WakeMetrics::count(WakeCounter::IMAGE_FAILURES);
         LOG_ERROR("ImageWidget", "Image widget render failed (attempt %d)", consecutiveFailures);
+        drawn = false;
 
         // Show error in the image region
         String errorDetails = "URL: ";
         errorDetails += imageUrl;
         if (WiFi.status() != WL_CONNECTED) {
             errorDetails = "WiFi disconnected";
+            revalidatePending = true;
         }
         showErrorInRegion(region, "IMAGE ERROR", "Failed to load image", errorDetails.c_str());
     }
@@ -60,12 +121,14 @@ void ImageWidget::renderToCompositor(Compositor& compositor, const LayoutRegion&
     } else {
         consecutiveFailures++;
         LOG_ERROR("ImageWidget", "Image widget render to compositor failed (attempt %d)", consecutiveFailures);
+        drawn = false;
 
         // Show error in the image region on compositor
         String errorDetails = "URL: ";
         errorDetails += imageUrl;
         if (WiFi.status() != WL_CONNECTED) {
             errorDetails = "WiFi disconnected";
+            revalidatePending = true;
         }
         showErrorInRegionToCompositor(compositor, region, "IMAGE ERROR", "Failed to load image", errorDetails.c_str());
     }
@@ -75,55 +138,108 @@ void ImageWidget::renderToCompositor(Compositor& compositor, const LayoutRegion&
 }
 
 bool ImageWidget::fetchAndDisplay(const LayoutRegion& region) {
-    if (WiFi.status() != WL_CONNECTED) {
-        LOG_WARN("ImageWidget", "WiFi not connected, cannot fetch image");
+    String image;
+    if (!downloadImage(image)) {
         return false;
     }
 
-    LOG_DEBUG("ImageWidget", "Fetching image from: %s", imageUrl);
-
-    // DON'T clear the entire display - only draw in our region!
-    // The LayoutManager already cleared our specific region before calling render()
-
-    // Try to draw the image only at the correct region position
-    bool success = display.drawImage(imageUrl, region.getX(), region.getY(), false, false);
+    // Drawn from the same bytes that go to the cache
+    cache.store(image);
+    revalidatePending = false;
+    return drawImageInRegion(image, region);
+}
 
-    if (success) {
-        LOG_INFO("ImageWidget", "Image downloaded and displayed successfully at correct position");
-        return true;
+bool ImageWidget::loadAndDraw(const LayoutRegion& region) {
+    String image;
+    if (!cache.load(image)) {
+        return false;
     }
+    LOG_DEBUG("ImageWidget", "Cached image from %lu (%u bytes)", static_cast<unsigned long>(cache.getFetchedAt()),
+              static_cast<unsigned>(image.length()));
+    return drawImageInRegion(image, region);
+}
 
-    // Try with dithering at the correct position
-    success = display.drawImage(imageUrl, region.getX(), region.getY(), true, false);
-    if (success) {
-        LOG_INFO("ImageWidget", "Image displayed with dithering at correct position");
-        return true;
+bool ImageWidget::downloadImage(String& image) {
+    if (WiFi.status() != WL_CONNECTED) {
+        LOG_WARN("ImageWidget", "WiFi not connected, cannot fetch image");
+        return false;
     }
 
-    // Only if all attempts fail, run diagnostics
-    LOG_ERROR("ImageWidget", "All image drawing attempts failed - running diagnostics");
-    LOG_DEBUG("ImageWidget", "WiFi IP: %s", WiFi.localIP().toString().c_str());
-    LOG_DEBUG("ImageWidget", "WiFi Signal: %d dBm", WiFi.RSSI());
+    LOG_DEBUG("ImageWidget", "Fetching image from: %s", imageUrl);
+    MemoryTracker::Scope memoryScope(MemorySubsystem::NETWORK);
+
+    // Recent wake metrics ride along as a query parameter (when enabled)
+    String requestUrl = Telemetry::appendToUrl(imageUrl);
 
-    // Test HTTP connection to see what the issue might be
     HTTPClient http;
-    http.begin(imageUrl);
+    http.begin(requestUrl);
     http.setTimeout(10000);
 
+    unsigned long requestStart = millis();
     int httpCode = http.GET();
-    LOG_DEBUG("ImageWidget", "HTTP Response Code: %d", httpCode);
+    InputTrace::recordHttpTiming(requestStart, imageUrl, httpCode);
 
-    if (httpCode == HTTP_CODE_OK) {
-        int contentLength = http.getSize();
-        String contentType = http.header("Content-Type");
-        LOG_DEBUG("ImageWidget", "Content-Length: %d bytes", contentLength);
-        LOG_DEBUG("ImageWidget", "Content-Type: %s", contentType.c_str());
-    } else {
+    if (httpCode != HTTP_CODE_OK) {
         LOG_ERROR("ImageWidget", "HTTP error: %d - %s", httpCode, http.errorToString(httpCode).c_str());
+        http.end();
+        WakeMetrics::count(WakeCounter::HTTP_FAILURES);
+        return false;
     }
 
+    int contentLength = http.getSize();
+    image = http.getString();
     http.end();
-    return false;
+    LOG_DEBUG("ImageWidget", "Content-Length: %d bytes, received %u", contentLength, static_cast<unsigned>(image.length()));
+
+    if (contentLength > 0 && image.length() != static_cast<size_t>(contentLength)) {
+        LOG_ERROR("ImageWidget", "Image cut short after %u of %d bytes", static_cast<unsigned>(image.length()),
+                  contentLength);
+        WakeMetrics::count(WakeCounter::HTTP_FAILURES);
+        image = String();
+        return false;
+    }
+    if (!looksLikeImage(image)) {
+        LOG_ERROR("ImageWidget", "Response is not an image (%u bytes)", static_cast<unsigned>(image.length()));
+        image = String();
+        return false;
+    }
+    return true;
+}
+
+bool ImageWidget::drawImageInRegion(const String& image, const LayoutRegion& region) {
+    // DON'T clear the entire display - only draw in our region!
+    // The LayoutManager already cleared our specific region before calling render()
+    MemoryTracker::Scope memoryScope(MemorySubsystem::IMAGE_DECODE);
+
+    // The decoders take a mutable buffer but only read it
+    uint8_t* data = reinterpret_cast<uint8_t*>(const_cast<char*>(image.c_str()));
+    int32_t size = static_cast<int32_t>(image.length());
+
+    bool success = drawEncoded(display, data, size, region.getX(), region.getY(), false);
+    if (!success) {
+        // Try with dithering at the correct position
+        success = drawEncoded(display, data, size, region.getX(), region.getY(), true);
+        if (success) {
+            LOG_INFO("ImageWidget", "Image displayed with dithering at correct position");
+        }
+    }
+    if (!success) {
+        LOG_ERROR("ImageWidget", "Could not decode the %d byte image", static_cast<int>(size));
+        return false;
+    }
+
+    drawn = true;
+    drawnHash = hashImage(image);
+    return true;
+}
+
+uint32_t ImageWidget::hashImage(const String& image) {
+    uint32_t hash = 2166136261u;
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(image.c_str());
+    for (size_t i = 0; i < image.length(); i++) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
 }
 
 void ImageWidget::showErrorInRegion(const LayoutRegion& region, const char* title, const char* message, const char* details) {
@@ -256,24 +372,21 @@ void ImageWidget::showDiagnosticsInRegion(const LayoutRegion& region, const char
 }
 
 bool ImageWidget::fetchAndDisplayToCompositor(Compositor& compositor, const LayoutRegion& region) {
-    if (WiFi.status() != WL_CONNECTED) {
-        LOG_WARN("ImageWidget", "WiFi not connected, cannot fetch image");
-        return false;
+    String image;
+    if (!cache.load(image)) {
+        // Nothing cached: this render has to wait for the server
+        if (!downloadImage(image)) {
+            return false;
+        }
+        cache.store(image);
+        revalidatePending = false;
     }
 
-    LOG_DEBUG("ImageWidget", "Fetching image from: %s for compositor", imageUrl);
-
-    // For compositor rendering, we need to simulate image display
-    // Since the Inkplate library's drawImage method works directly with the display,
-    // we need to create a placeholder representation for the compositor
-
-    // In a full implementation, you would:
-    // 1. Download the image data
-    // 2. Decode it to pixel data
-    // 3. Draw each pixel to the compositor using setPixel()
-
-    // For now, we'll create a placeholder that shows the image would be there
-    showImagePlaceholderToCompositor(compositor, region, "IMAGE", "Loading...");
+    // The compositor has no image decoders, so a placeholder marks where the
+    // picture is; the bytes it stands for decide whether revalidation redraws
+    showImagePlaceholderToCompositor(compositor, region, "IMAGE");
+    drawn = true;
+    drawnHash = hashImage(image);
 
     LOG_DEBUG("ImageWidget", "Image placeholder rendered to compositor");
     return true;
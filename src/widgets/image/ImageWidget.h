@@ -1,6 +1,7 @@
 #ifndef IMAGE_WIDGET_H
 #define IMAGE_WIDGET_H
 
+#include "../../core/SourceCache.h"
 #include "../../core/Widget.h"
 #include <WiFi.h>
 #include <HTTPClient.h>
@@ -8,6 +9,14 @@
 // Forward declaration
 class Compositor;
 
+/**
+ * A picture from the configured server. The last good download is kept in
+ * a SourceCache in the image cache, and render draws that local copy
+ * without touching the network. Every scheduled wake asks the server again
+ * after the panel is up (revalidate()) and redraws the region only if the
+ * bytes changed. A failed download keeps the last good picture; the error
+ * box is only drawn when there never was one.
+ */
 class ImageWidget : public Widget {
 public:
     ImageWidget(Inkplate& display, const char* imageUrl);
@@ -17,6 +26,8 @@ public:
     void renderToCompositor(Compositor& compositor, const LayoutRegion& region) override;
     bool shouldUpdate() override;
     void begin() override;
+    void forceUpdate() override;
+    bool revalidate() override;
     WidgetType getWidgetType() const override;
 
     // Image-specific methods
@@ -36,10 +47,19 @@ private:
     int consecutiveFailures;
     unsigned long lastImageUpdate;
 
+    SourceCache cache;
+    bool revalidatePending;  // Ask the server after the next render
+    bool drawn;              // drawnHash is what the region shows
+    uint32_t drawnHash;      // FNV-1a of the image bytes
+
     static const unsigned long IMAGE_UPDATE_INTERVAL = 86400000; // 24 hours
+    static const uint32_t IMAGE_FRESH_S = 0;                     // Every wake asks the server
+    static const uint32_t IMAGE_MAX_AGE_S = 0xFFFFFFFF;          // An old picture beats the error box
 
-    bool downloadImage(const LayoutRegion& region);
-    void drawImageInRegion(const LayoutRegion& region);
+    bool downloadImage(String& image);
+    bool drawImageInRegion(const String& image, const LayoutRegion& region);
+    bool loadAndDraw(const LayoutRegion& region);
+    static uint32_t hashImage(const String& image);
 };
 
 #endif
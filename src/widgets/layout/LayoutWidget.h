@@ -2,6 +2,7 @@
 
 #include "../../core/Widget.h"
 #include "../../core/LayoutRegion.h"
+#include <memory>
 #include <vector>
 
 // LayoutWidgetConfig is defined in ConfigManager.h
@@ -20,6 +21,8 @@ public:
     void begin() override;
     void render(const LayoutRegion& region) override;
     void renderToCompositor(Compositor& compositor, const LayoutRegion& region) override;
+    // Borders only; without includeStatic, those the static layer already holds are skipped
+    void renderBordersToCompositor(Compositor& compositor, bool includeStatic);
     bool shouldUpdate() override;
     WidgetType getWidgetType() const override;
 
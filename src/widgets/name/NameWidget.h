@@ -17,6 +17,7 @@ public:
     bool shouldUpdate() override;
     void begin() override;
     WidgetType getWidgetType() const override;
+    bool isStatic() const override { return true; }
 
     // Name-specific methods
     void setFamilyName(const String& name);
@@ -1,9 +1,14 @@
 #include "TimeWidget.h"
+#include "../../core/AssetPack.h"
 #include "../../core/Logger.h"
 #include "../../core/Compositor.h"
+#include "../../core/InputTrace.h"
+#include "../../core/WakeMetrics.h"
 #include "../../managers/ConfigManager.h"
 
 const char* TimeWidget::NTP_SERVER = "pool.ntp.org";
+const char* TimeWidget::TIME_FONT = "clock-28";
+const char* TimeWidget::SYNC_FAIL_ICON = "sync-fail";
 
 // Backup NTP servers
 const char* ntpServers[] = {
@@ -14,16 +19,19 @@ const char* ntpServers[] = {
 };
 
 TimeWidget::TimeWidget(Inkplate& display)
-    : Widget(display), lastTimeUpdate(0), timeInitialized(false), timeUpdateInterval(DEFAULT_TIME_UPDATE_INTERVAL) {}
+    : Widget(display), lastTimeUpdate(0), timeInitialized(false), syncPending(false), timeUpdateInterval(DEFAULT_TIME_UPDATE_INTERVAL),
+      drawnTimeX(0), drawnBaseline(0) {}
 
 TimeWidget::TimeWidget(Inkplate& display, unsigned long updateInterval)
-    : Widget(display), lastTimeUpdate(0), timeInitialized(false), timeUpdateInterval(updateInterval) {
+    : Widget(display), lastTimeUpdate(0), timeInitialized(false), syncPending(false), timeUpdateInterval(updateInterval),
+      drawnTimeX(0), drawnBaseline(0) {
     LOG_INFO("TimeWidget", "Created with update interval: %lu ms (%lu seconds)", updateInterval, updateInterval / 1000);
 }
 
 void TimeWidget::begin() {
     LOG_INFO("TimeWidget", "Initializing time widget...");
     timeInitialized = false;
+    syncPending = false;
     lastTimeUpdate = 0;
 }
 
@@ -76,19 +84,51 @@ void TimeWidget::renderToCompositor(Compositor& compositor, const LayoutRegion&
     LOG_DEBUG("TimeWidget", "renderToCompositor() completed - lastTimeUpdate set to %lu", lastTimeUpdate);
 }
 
+bool TimeWidget::updateOnCompositor(Compositor& compositor, const LayoutRegion& region) {
+    // Only the time line changes between ticks; the label, date and day
+    // are left as the last full render drew them. Needs the clock-28 pack
+    // font and a full render earlier in this boot (see drawnTime), so it
+    // only helps units that stay awake.
+    const AssetPack& assets = AssetPack::shared();
+    AssetInfo font;
+    if (!timeInitialized || drawnTime.length() == 0 || !assets.find(TIME_FONT, AssetType::FONT, font)) {
+        return false;
+    }
+    int labelX = region.getX() + 10;
+    int baseline = region.getY() + 10 + 50 + font.param;
+    if (labelX != drawnTimeX || baseline != drawnBaseline) {
+        return false; // The region moved
+    }
+
+    String timeStr = getFormattedTime();
+    int runs = assets.updateText(compositor, font, labelX, baseline, drawnTime.c_str(), timeStr.c_str(), 0, 255);
+    LOG_DEBUG("TimeWidget", "Updated time from %s to %s (%d changed runs)", drawnTime.c_str(), timeStr.c_str(), runs);
+    drawnTime = timeStr;
+
+    lastTimeUpdate = millis();
+    return true;
+}
+
 void TimeWidget::syncTimeWithNTP() {
     if (WiFi.status() != WL_CONNECTED) {
-        LOG_WARN("TimeWidget", "WiFi not connected, cannot sync time");
-        timeInitialized = false;
+        // The RTC keeps counting through deep sleep, so a clock set on an
+        // earlier wake is still good to draw until revalidate() can sync
+        timeInitialized = time(nullptr) > 1577836800;
+        syncPending = true;
+        LOG_WARN("TimeWidget", "WiFi not connected, cannot sync time (%s)",
+                 timeInitialized ? "showing RTC time" : "no time yet");
         return;
     }
 
+    syncPending = false;
+
     LOG_INFO("TimeWidget", "Syncing time with NTP server...");
 
     // Try multiple NTP servers
     for (int serverIndex = 0; serverIndex < 4; serverIndex++) {
         LOG_DEBUG("TimeWidget", "Trying NTP server: %s", ntpServers[serverIndex]);
 
+        unsigned long syncStart = millis();
         configTime(GMT_OFFSET_SEC, DAYLIGHT_OFFSET_SEC, ntpServers[serverIndex]);
 
         int attempts = 0;
@@ -98,6 +138,7 @@ void TimeWidget::syncTimeWithNTP() {
             now = time(nullptr);
 
             if (now > 1577836800) { // January 1, 2020 00:00:00 UTC
+                InputTrace::recordTimeSync(syncStart, now);
                 timeInitialized = true;
                 LOG_INFO("TimeWidget", "Time synchronized successfully!");
 
@@ -110,10 +151,12 @@ void TimeWidget::syncTimeWithNTP() {
             attempts++;
         }
 
+        InputTrace::recordTimeSync(syncStart, 0);
         LOG_WARN("TimeWidget", "Server %s failed, trying next...", ntpServers[serverIndex]);
     }
 
     LOG_ERROR("TimeWidget", "All NTP servers failed - time sync unsuccessful");
+    WakeMetrics::count(WakeCounter::TIME_SYNC_FAILURES);
     timeInitialized = false;
 }
 
@@ -216,6 +259,20 @@ void TimeWidget::forceTimeSync() {
     syncTimeWithNTP();
 }
 
+bool TimeWidget::revalidate() {
+    if (!syncPending) return false;
+
+    // Drift corrections don't redraw; only getting a clock for the first
+    // time does. A failed sync keeps showing the RTC time it already had.
+    bool wasInitialized = timeInitialized;
+    syncTimeWithNTP();
+    if (wasInitialized) {
+        timeInitialized = true;
+        return false;
+    }
+    return timeInitialized;
+}
+
 bool TimeWidget::isTimeInitialized() const {
     return timeInitialized;
 }
@@ -240,15 +297,32 @@ void TimeWidget::drawTimeDisplayToCompositor(Compositor& compositor, const Layou
     compositor.fillRect(labelX, labelY + 15, 120, 20, 0); // Black rectangle for label
     LOG_DEBUG("TimeWidget", "Drew DATE TIME label area to compositor");
 
+    // Real glyphs and icons when the asset pack has them
+    const AssetPack& assets = AssetPack::shared();
+    AssetInfo asset;
+    drawnTime = "";
+
     if (!timeInitialized) {
-        // Draw "SYNC FAIL" area
-        compositor.fillRect(labelX, labelY + 55, 100, 20, 0); // Black rectangle
+        if (assets.find(SYNC_FAIL_ICON, AssetType::ICON, asset)) {
+            assets.drawIcon(compositor, asset, labelX, labelY + 45);
+        } else {
+            // Draw "SYNC FAIL" area
+            compositor.fillRect(labelX, labelY + 55, 100, 20, 0); // Black rectangle
+        }
         LOG_WARN("TimeWidget", "Drew SYNC FAIL area to compositor");
         return;
     }
 
-    // Draw time area (larger rectangle)
-    compositor.fillRect(labelX, labelY + 50, 180, 30, 0); // Black rectangle for time
+    if (assets.find(TIME_FONT, AssetType::FONT, asset)) {
+        // Remembered so the next tick only redraws the digits that changed
+        drawnTime = getFormattedTime();
+        drawnTimeX = labelX;
+        drawnBaseline = labelY + 50 + asset.param;
+        assets.drawText(compositor, asset, drawnTimeX, drawnBaseline, drawnTime.c_str(), 0);
+    } else {
+        // Draw time area (larger rectangle)
+        compositor.fillRect(labelX, labelY + 50, 180, 30, 0); // Black rectangle for time
+    }
     LOG_DEBUG("TimeWidget", "Drew time area to compositor");
 
     // Draw date area
@@ -15,7 +15,9 @@ public:
     // Widget interface implementation
     void render(const LayoutRegion& region) override;
     void renderToCompositor(Compositor& compositor, const LayoutRegion& region) override;
+    bool updateOnCompositor(Compositor& compositor, const LayoutRegion& region) override;
     bool shouldUpdate() override;
+    bool revalidate() override;
     void begin() override;
     WidgetType getWidgetType() const override;
 
@@ -31,10 +33,21 @@ public:
 private:
     unsigned long lastTimeUpdate;
     bool timeInitialized;
+    bool syncPending;   // Sync skipped for lack of WiFi; retried by revalidate()
     unsigned long timeUpdateInterval;
 
+    // The time line as last drawn with the asset font; empty when it wasn't.
+    // Kept in RAM on purpose: after deep sleep the compositor surface is gone
+    // too, so only always-on units (and repeated ticks within one wake) get
+    // the in-place update; every wake from deep sleep redraws the region.
+    String drawnTime;
+    int drawnTimeX;
+    int drawnBaseline;
+
     static const unsigned long DEFAULT_TIME_UPDATE_INTERVAL = 900000; // 15 minutes
     static const char* NTP_SERVER;
+    static const char* TIME_FONT;       // Asset pack font for the time line
+    static const char* SYNC_FAIL_ICON;
     static const long GMT_OFFSET_SEC = -28800; // PST (UTC-8)
     static const int DAYLIGHT_OFFSET_SEC = 3600; // 1 hour
 
@@ -0,0 +1,57 @@
+#include "HourlyForecast.h"
+#include "../../core/Logger.h"
+#include <algorithm>
+#include <cmath>
+
+uint32_t HourlyForecast::firstEpoch = 0;
+int HourlyForecast::count = 0;
+uint32_t HourlyForecast::revision = 0;
+float HourlyForecast::temperatures[HourlyForecast::MAX_HOURS];
+int8_t HourlyForecast::precipitation[HourlyForecast::MAX_HOURS];
+
+bool HourlyForecast::publish(JsonObjectConst hourly) {
+    JsonArrayConst times = hourly["time"];
+    if (times.isNull() || times.size() == 0) {
+        return false;
+    }
+    JsonArrayConst temperatureValues = hourly["temperature_2m"];
+    JsonArrayConst precipitationValues = hourly["precipitation_probability"];
+
+    uint32_t previousFirst = firstEpoch;
+    int previousCount = count;
+    bool changed = false;
+    firstEpoch = times[0].as<uint32_t>() / 3600 * 3600;
+    count = 0;
+    for (size_t i = 0; i < times.size() && count < MAX_HOURS; i++) {
+        // Hours follow each other; anything else ends the series
+        if (times[i].as<uint32_t>() / 3600 * 3600 != getEpoch(count)) break;
+        JsonVariantConst temperature = temperatureValues[i];
+        JsonVariantConst rain = precipitationValues[i];
+        float degrees = temperature.isNull() ? NAN : temperature.as<float>();
+        int8_t percent = rain.isNull() ? -1 : static_cast<int8_t>(std::min(std::max(rain.as<int>(), 0), 100));
+        changed = changed || count >= previousCount || precipitation[count] != percent ||
+                  (std::isnan(degrees) ? !std::isnan(temperatures[count]) : temperatures[count] != degrees);
+        temperatures[count] = degrees;
+        precipitation[count] = percent;
+        count++;
+    }
+    if (!changed && firstEpoch == previousFirst && count == previousCount) {
+        // The same forecast again: readers have nothing to redraw
+        return true;
+    }
+    revision++;
+    LOG_DEBUG("HourlyForecast", "%d hours from %lu (revision %lu)", count, (unsigned long)firstEpoch,
+              (unsigned long)revision);
+    return true;
+}
+
+void HourlyForecast::clear() {
+    count = 0;
+    revision++;
+}
+
+int HourlyForecast::find(uint32_t epoch) {
+    if (count == 0 || epoch < firstEpoch || (epoch - firstEpoch) % 3600) return -1;
+    uint32_t index = (epoch - firstEpoch) / 3600;
+    return index < static_cast<uint32_t>(count) ? static_cast<int>(index) : -1;
+}
@@ -0,0 +1,40 @@
+#ifndef HOURLY_FORECAST_H
+#define HOURLY_FORECAST_H
+
+#include <ArduinoJson.h>
+#include <cstdint>
+
+/**
+ * The hourly part of the last Open-Meteo response, shared by the widgets
+ * that show it. WeatherWidget publishes it after each fetch and the chart
+ * reads it, so the forecast is requested once per wake. getRevision()
+ * changes when a publish changes the forecast, so a reader can tell there
+ * is something new without comparing values.
+ */
+class HourlyForecast {
+public:
+    static const int MAX_HOURS = 48;
+
+    // "hourly" object with unixtime "time", "temperature_2m" and
+    // "precipitation_probability"; false (and nothing kept) without times
+    static bool publish(JsonObjectConst hourly);
+    static void clear();
+
+    static int getCount() { return count; }
+    static uint32_t getRevision() { return revision; }
+    static uint32_t getEpoch(int index) { return firstEpoch + static_cast<uint32_t>(index) * 3600; }
+    // Index of the hour starting at epoch, -1 if it isn't in the forecast
+    static int find(uint32_t epoch);
+    // NAN and -1 when the response had no value for the hour
+    static float getTemperature(int index) { return temperatures[index]; }
+    static int getPrecipitation(int index) { return precipitation[index]; }
+
+private:
+    static uint32_t firstEpoch;
+    static int count;
+    static uint32_t revision;
+    static float temperatures[MAX_HOURS];
+    static int8_t precipitation[MAX_HOURS];
+};
+
+#endif
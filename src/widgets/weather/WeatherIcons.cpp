@@ -0,0 +1,150 @@
+#include "WeatherIcons.h"
+
+// Generated from vector outlines; rows are 6 bytes, most significant bit first
+
+static const uint8_t CLEAR_BITS[] = {
+    0xed, 0x00, 0x01, 0x01, 0xc0, 0xfd, 0x00, 0x01, 0x01, 0xc0, 0xfd, 0x00, 0x01, 0x01, 0xc0, 0xfd,
+    0x00, 0x01, 0x01, 0xc0, 0xfd, 0x00, 0x01, 0x01, 0xc0, 0xfd, 0x00, 0x01, 0x01, 0xc0, 0xfe, 0x00,
+    0x2d, 0x70, 0x01, 0xc0, 0x07, 0x00, 0x00, 0x78, 0x01, 0xc0, 0x0f, 0x00, 0x00, 0x7c, 0x01, 0xc0,
+    0x1f, 0x00, 0x00, 0x3e, 0x01, 0xc0, 0x3e, 0x00, 0x00, 0x1f, 0x01, 0xc0, 0x7c, 0x00, 0x00, 0x0f,
+    0x80, 0x00, 0xf8, 0x00, 0x00, 0x07, 0x80, 0x00, 0xf0, 0x00, 0x00, 0x03, 0x80, 0x00, 0xe0, 0xfe,
+    0x00, 0x01, 0x07, 0xf0, 0xfd, 0x00, 0x01, 0x1f, 0xfc, 0xfd, 0x00, 0x01, 0x3f, 0x7e, 0xfd, 0x00,
+    0x01, 0x38, 0x0e, 0xfd, 0x00, 0x01, 0x70, 0x07, 0xfd, 0x00, 0x19, 0x70, 0x07, 0x00, 0x00, 0x1f,
+    0xfc, 0x70, 0x07, 0x1f, 0xfc, 0x1f, 0xfc, 0x60, 0x03, 0x1f, 0xfc, 0x1f, 0xfc, 0x70, 0x07, 0x1f,
+    0xfc, 0x00, 0x00, 0x70, 0x07, 0xfd, 0x00, 0x01, 0x70, 0x07, 0xfd, 0x00, 0x01, 0x38, 0x0e, 0xfd,
+    0x00, 0x01, 0x3f, 0x7e, 0xfd, 0x00, 0x01, 0x1f, 0xfc, 0xfd, 0x00, 0x01, 0x07, 0xf0, 0xfe, 0x00,
+    0x2d, 0x03, 0x80, 0x00, 0xe0, 0x00, 0x00, 0x07, 0x80, 0x00, 0xf0, 0x00, 0x00, 0x0f, 0x80, 0x00,
+    0xf8, 0x00, 0x00, 0x1f, 0x01, 0xc0, 0x7c, 0x00, 0x00, 0x3e, 0x01, 0xc0, 0x3e, 0x00, 0x00, 0x7c,
+    0x01, 0xc0, 0x1f, 0x00, 0x00, 0x78, 0x01, 0xc0, 0x0f, 0x00, 0x00, 0x70, 0x01, 0xc0, 0x07, 0xfe,
+    0x00, 0x01, 0x01, 0xc0, 0xfd, 0x00, 0x01, 0x01, 0xc0, 0xfd, 0x00, 0x01, 0x01, 0xc0, 0xfd, 0x00,
+    0x01, 0x01, 0xc0, 0xfd, 0x00, 0x01, 0x01, 0xc0, 0xfd, 0x00, 0x01, 0x01, 0xc0, 0xf3, 0x00,
+};
+
+static const uint8_t PARTLY_CLOUDY_BITS[] = {
+    0x02, 0x00, 0x00, 0xe0, 0xfc, 0x00, 0x00, 0xe0, 0xfc, 0x00, 0x00, 0xe0, 0xfe, 0x00, 0x27, 0x0c,
+    0x00, 0xe0, 0x06, 0x00, 0x00, 0x1e, 0x00, 0xe0, 0x0f, 0x00, 0x00, 0x1f, 0x00, 0xe0, 0x1f, 0x00,
+    0x00, 0x0f, 0x80, 0xe0, 0x3e, 0x00, 0x00, 0x07, 0xc0, 0xe0, 0x7c, 0x00, 0x00, 0x03, 0xe0, 0x00,
+    0xf8, 0x00, 0x00, 0x01, 0xe0, 0x00, 0xf0, 0xfe, 0x00, 0x02, 0xe0, 0x00, 0xe0, 0xfe, 0x00, 0x01,
+    0x03, 0xf8, 0xfd, 0x00, 0x01, 0x07, 0xfc, 0xfd, 0x00, 0x01, 0x0f, 0xbe, 0xfd, 0x00, 0x01, 0x1e,
+    0x0f, 0xfd, 0x00, 0x01, 0x1c, 0x07, 0xfe, 0x00, 0x5b, 0xff, 0x1c, 0x07, 0x1f, 0xf8, 0x00, 0xff,
+    0x18, 0x03, 0x1d, 0xf8, 0x00, 0xff, 0x1c, 0x07, 0x3f, 0xf8, 0x00, 0x00, 0x1c, 0x07, 0xff, 0xf8,
+    0x00, 0x00, 0x1e, 0x0f, 0xfd, 0xfc, 0x00, 0x00, 0x0f, 0xbf, 0xc0, 0x1e, 0x00, 0x00, 0x07, 0xff,
+    0x80, 0x0f, 0x00, 0x00, 0x03, 0xff, 0x00, 0x07, 0x00, 0x00, 0xe0, 0x0e, 0x00, 0x03, 0x80, 0x01,
+    0xe0, 0x0e, 0x00, 0x03, 0x80, 0x03, 0xe0, 0x0e, 0x00, 0x03, 0x80, 0x07, 0xc0, 0xfc, 0x00, 0x03,
+    0x80, 0x0f, 0x81, 0xfc, 0x00, 0x01, 0xe0, 0x1f, 0x03, 0xf0, 0x00, 0x01, 0xf8, 0x1e, 0x03, 0x80,
+    0x00, 0x00, 0x7c, 0x0c, 0x07, 0xfe, 0x00, 0x02, 0x1c, 0x00, 0x07, 0xfe, 0x00, 0x02, 0x0e, 0x00,
+    0x07, 0xfe, 0x00, 0x02, 0x0e, 0x00, 0x06, 0xfe, 0x00, 0x02, 0x0e, 0x00, 0x07, 0xfe, 0x00, 0x02,
+    0x06, 0x00, 0x07, 0xfe, 0x00, 0x02, 0x0e, 0x00, 0x07, 0xfe, 0x00, 0x1e, 0x0e, 0x00, 0x03, 0x80,
+    0x00, 0x00, 0x0e, 0x00, 0x03, 0xf0, 0x00, 0x00, 0x1c, 0x00, 0x01, 0xff, 0xff, 0xfe, 0xfc, 0x00,
+    0x00, 0x7f, 0xff, 0xff, 0xf8, 0x00, 0x00, 0x0f, 0xff, 0xff, 0xe0, 0xe3, 0x00,
+};
+
+static const uint8_t CLOUDY_BITS[] = {
+    0xab, 0x00, 0x01, 0x03, 0xfe, 0xfd, 0x00, 0x02, 0x0f, 0xff, 0x80, 0xfe, 0x00, 0x02, 0x1f, 0xdf,
+    0xc0, 0xfe, 0x00, 0x02, 0x3c, 0x01, 0xe0, 0xfe, 0x00, 0x02, 0x78, 0x00, 0xf0, 0xfe, 0x00, 0x02,
+    0x70, 0x00, 0x70, 0xfe, 0x00, 0x02, 0xe0, 0x00, 0x38, 0xfe, 0x00, 0x02, 0xe0, 0x00, 0x38, 0xfe,
+    0x00, 0x23, 0xe0, 0x00, 0x38, 0x00, 0x00, 0x07, 0xc0, 0x00, 0x38, 0x00, 0x00, 0x1f, 0xc0, 0x00,
+    0x1e, 0x00, 0x00, 0x3f, 0x00, 0x00, 0x1f, 0x80, 0x00, 0x38, 0x00, 0x00, 0x07, 0xc0, 0x00, 0x70,
+    0x00, 0x00, 0x01, 0xc0, 0x00, 0x70, 0xfe, 0x00, 0x02, 0xe0, 0x00, 0x70, 0xfe, 0x00, 0x02, 0xe0,
+    0x00, 0x60, 0xfe, 0x00, 0x02, 0xe0, 0x00, 0x70, 0xfe, 0x00, 0x02, 0x60, 0x00, 0x70, 0xfe, 0x00,
+    0x02, 0xe0, 0x00, 0x70, 0xfe, 0x00, 0x02, 0xe0, 0x00, 0x38, 0xfe, 0x00, 0x0e, 0xe0, 0x00, 0x3f,
+    0x00, 0x00, 0x01, 0xc0, 0x00, 0x1f, 0xff, 0xff, 0xef, 0xc0, 0x00, 0x07, 0xfe, 0xff, 0x05, 0x80,
+    0x00, 0x00, 0xff, 0xff, 0xfe, 0xca, 0x00,
+};
+
+static const uint8_t FOG_BITS[] = {
+    0xbf, 0x00, 0x00, 0x01, 0xfd, 0xff, 0x01, 0xc0, 0x01, 0xfd, 0xff, 0x01, 0xc0, 0x01, 0xfd, 0xff,
+    0x00, 0xc0, 0xe3, 0x00, 0x00, 0x1f, 0xfe, 0xff, 0x02, 0xfc, 0x00, 0x1f, 0xfe, 0xff, 0x02, 0xfc,
+    0x00, 0x1f, 0xfe, 0xff, 0x00, 0xfc, 0xe1, 0x00, 0x00, 0x1f, 0xfe, 0xff, 0x02, 0xfc, 0x00, 0x1f,
+    0xfe, 0xff, 0x02, 0xfc, 0x00, 0x1f, 0xfe, 0xff, 0x00, 0xfc, 0xe3, 0x00, 0x00, 0x01, 0xfd, 0xff,
+    0x01, 0xc0, 0x01, 0xfd, 0xff, 0x01, 0xc0, 0x01, 0xfd, 0xff, 0x00, 0xc0, 0xc5, 0x00,
+};
+
+static const uint8_t RAIN_BITS[] = {
+    0xdb, 0x00, 0x01, 0x03, 0xfe, 0xfd, 0x00, 0x02, 0x0f, 0xff, 0x80, 0xfe, 0x00, 0x02, 0x1f, 0xdf,
+    0xc0, 0xfe, 0x00, 0x02, 0x3c, 0x01, 0xe0, 0xfe, 0x00, 0x02, 0x78, 0x00, 0xf0, 0xfe, 0x00, 0x02,
+    0x70, 0x00, 0x70, 0xfe, 0x00, 0x02, 0xe0, 0x00, 0x38, 0xfe, 0x00, 0x02, 0xe0, 0x00, 0x38, 0xfe,
+    0x00, 0x23, 0xe0, 0x00, 0x38, 0x00, 0x00, 0x07, 0xc0, 0x00, 0x38, 0x00, 0x00, 0x1f, 0xc0, 0x00,
+    0x1e, 0x00, 0x00, 0x3f, 0x00, 0x00, 0x1f, 0x80, 0x00, 0x38, 0x00, 0x00, 0x07, 0xc0, 0x00, 0x70,
+    0x00, 0x00, 0x01, 0xc0, 0x00, 0x70, 0xfe, 0x00, 0x02, 0xe0, 0x00, 0x70, 0xfe, 0x00, 0x02, 0xe0,
+    0x00, 0x60, 0xfe, 0x00, 0x02, 0xe0, 0x00, 0x70, 0xfe, 0x00, 0x02, 0x60, 0x00, 0x70, 0xfe, 0x00,
+    0x02, 0xe0, 0x00, 0x70, 0xfe, 0x00, 0x02, 0xe0, 0x00, 0x38, 0xfe, 0x00, 0x0e, 0xe0, 0x00, 0x3f,
+    0x00, 0x00, 0x01, 0xc0, 0x00, 0x1f, 0xff, 0xff, 0xef, 0xc0, 0x00, 0x07, 0xfe, 0xff, 0x05, 0x80,
+    0x00, 0x00, 0xff, 0xff, 0xfe, 0xec, 0x00, 0xfe, 0x70, 0xfe, 0x00, 0xfe, 0x70, 0xfe, 0x00, 0xfe,
+    0xf0, 0xfe, 0x00, 0xfe, 0xe0, 0xfe, 0x00, 0xfe, 0xe0, 0x1f, 0x00, 0x00, 0x01, 0xc1, 0xc1, 0xc0,
+    0x00, 0x00, 0x01, 0xc1, 0xc1, 0xc0, 0x00, 0x00, 0x03, 0x83, 0x83, 0x80, 0x00, 0x00, 0x03, 0x83,
+    0x83, 0x80, 0x00, 0x00, 0x07, 0x87, 0x87, 0x80, 0x00, 0x00, 0xfe, 0x07, 0xfe, 0x00, 0xfe, 0x07,
+    0xf3, 0x00,
+};
+
+static const uint8_t SNOW_BITS[] = {
+    0xdb, 0x00, 0x01, 0x03, 0xfe, 0xfd, 0x00, 0x02, 0x0f, 0xff, 0x80, 0xfe, 0x00, 0x02, 0x1f, 0xdf,
+    0xc0, 0xfe, 0x00, 0x02, 0x3c, 0x01, 0xe0, 0xfe, 0x00, 0x02, 0x78, 0x00, 0xf0, 0xfe, 0x00, 0x02,
+    0x70, 0x00, 0x70, 0xfe, 0x00, 0x02, 0xe0, 0x00, 0x38, 0xfe, 0x00, 0x02, 0xe0, 0x00, 0x38, 0xfe,
+    0x00, 0x23, 0xe0, 0x00, 0x38, 0x00, 0x00, 0x07, 0xc0, 0x00, 0x38, 0x00, 0x00, 0x1f, 0xc0, 0x00,
+    0x1e, 0x00, 0x00, 0x3f, 0x00, 0x00, 0x1f, 0x80, 0x00, 0x38, 0x00, 0x00, 0x07, 0xc0, 0x00, 0x70,
+    0x00, 0x00, 0x01, 0xc0, 0x00, 0x70, 0xfe, 0x00, 0x02, 0xe0, 0x00, 0x70, 0xfe, 0x00, 0x02, 0xe0,
+    0x00, 0x60, 0xfe, 0x00, 0x02, 0xe0, 0x00, 0x70, 0xfe, 0x00, 0x02, 0x60, 0x00, 0x70, 0xfe, 0x00,
+    0x02, 0xe0, 0x00, 0x70, 0xfe, 0x00, 0x02, 0xe0, 0x00, 0x38, 0xfe, 0x00, 0x0e, 0xe0, 0x00, 0x3f,
+    0x00, 0x00, 0x01, 0xc0, 0x00, 0x1f, 0xff, 0xff, 0xef, 0xc0, 0x00, 0x07, 0xfe, 0xff, 0x05, 0x80,
+    0x00, 0x00, 0xff, 0xff, 0xfe, 0xed, 0x00, 0x33, 0x01, 0x00, 0x00, 0x40, 0x00, 0x00, 0x07, 0xc0,
+    0x01, 0xf0, 0x00, 0x00, 0x0f, 0xe0, 0x03, 0xf8, 0x00, 0x00, 0x0f, 0xe0, 0x03, 0xf8, 0x00, 0x00,
+    0x1f, 0xf0, 0x07, 0xfc, 0x00, 0x00, 0x0f, 0xe0, 0x83, 0xf8, 0x00, 0x00, 0x0f, 0xe3, 0xe3, 0xf8,
+    0x00, 0x00, 0x07, 0xc7, 0xf1, 0xf0, 0x00, 0x00, 0x01, 0x07, 0xf0, 0x40, 0xfe, 0x00, 0x01, 0x0f,
+    0xf8, 0xfd, 0x00, 0x01, 0x07, 0xf0, 0xfd, 0x00, 0x01, 0x07, 0xf0, 0xfd, 0x00, 0x01, 0x03, 0xe0,
+    0xfc, 0x00, 0x02, 0x80, 0x00, 0x00,
+};
+
+static const uint8_t THUNDER_BITS[] = {
+    0xdb, 0x00, 0x01, 0x03, 0xfe, 0xfd, 0x00, 0x02, 0x0f, 0xff, 0x80, 0xfe, 0x00, 0x02, 0x1f, 0xdf,
+    0xc0, 0xfe, 0x00, 0x02, 0x3c, 0x01, 0xe0, 0xfe, 0x00, 0x02, 0x78, 0x00, 0xf0, 0xfe, 0x00, 0x02,
+    0x70, 0x00, 0x70, 0xfe, 0x00, 0x02, 0xe0, 0x00, 0x38, 0xfe, 0x00, 0x02, 0xe0, 0x00, 0x38, 0xfe,
+    0x00, 0x23, 0xe0, 0x00, 0x38, 0x00, 0x00, 0x07, 0xc0, 0x00, 0x38, 0x00, 0x00, 0x1f, 0xc0, 0x00,
+    0x1e, 0x00, 0x00, 0x3f, 0x00, 0x00, 0x1f, 0x80, 0x00, 0x38, 0x00, 0x00, 0x07, 0xc0, 0x00, 0x70,
+    0x00, 0x00, 0x01, 0xc0, 0x00, 0x70, 0xfe, 0x00, 0x02, 0xe0, 0x00, 0x70, 0xfe, 0x00, 0x02, 0xe0,
+    0x00, 0x60, 0xfe, 0x00, 0x02, 0xe0, 0x00, 0x70, 0xfe, 0x00, 0x02, 0x60, 0x00, 0x70, 0xfe, 0x00,
+    0x02, 0xe0, 0x00, 0x70, 0xfe, 0x00, 0x14, 0xe0, 0x00, 0x38, 0x00, 0x38, 0x00, 0xe0, 0x00, 0x3f,
+    0x00, 0x38, 0x01, 0xc0, 0x00, 0x1f, 0xff, 0xff, 0xef, 0xc0, 0x00, 0x07, 0xfe, 0xff, 0x05, 0x80,
+    0x00, 0x00, 0xff, 0xff, 0xfe, 0xfe, 0x00, 0x01, 0x01, 0xc0, 0xfd, 0x00, 0x01, 0x03, 0xc0, 0xfd,
+    0x00, 0x01, 0x07, 0x80, 0xfd, 0x00, 0x00, 0x07, 0xfc, 0x00, 0x00, 0x0f, 0xfc, 0x00, 0x00, 0x1e,
+    0xfc, 0x00, 0x01, 0x3f, 0xe0, 0xfd, 0x00, 0x01, 0x3f, 0xe0, 0xfd, 0x00, 0x01, 0x3f, 0xe0, 0xfd,
+    0x00, 0x01, 0x01, 0xc0, 0xfd, 0x00, 0x01, 0x01, 0xc0, 0xfd, 0x00, 0x01, 0x03, 0x80, 0xfd, 0x00,
+    0x01, 0x03, 0x80, 0xfd, 0x00, 0x00, 0x07, 0xfc, 0x00, 0x00, 0x07, 0xfc, 0x00, 0x00, 0x0f, 0xfc,
+    0x00, 0x00, 0x0e, 0xfe, 0x00,
+};
+
+// Clear pixels are transparent, ink is black
+static const uint8_t INK_PALETTE[2] = {255, 0};
+
+static Sprite icon(const uint8_t* bits, size_t length) {
+    Sprite sprite;
+    sprite.data = bits;
+    sprite.length = length;
+    sprite.width = WeatherIcons::SIZE;
+    sprite.height = WeatherIcons::SIZE;
+    sprite.bitsPerPixel = 1;
+    sprite.encoding = SpriteEncoding::PACKBITS;
+    sprite.key = 0;
+    sprite.palette = INK_PALETTE;
+    return sprite;
+}
+
+const Sprite* WeatherIcons::forCode(int weatherCode) {
+    static const Sprite clear = icon(CLEAR_BITS, sizeof(CLEAR_BITS));
+    static const Sprite partlyCloudy = icon(PARTLY_CLOUDY_BITS, sizeof(PARTLY_CLOUDY_BITS));
+    static const Sprite cloudy = icon(CLOUDY_BITS, sizeof(CLOUDY_BITS));
+    static const Sprite fog = icon(FOG_BITS, sizeof(FOG_BITS));
+    static const Sprite rain = icon(RAIN_BITS, sizeof(RAIN_BITS));
+    static const Sprite snow = icon(SNOW_BITS, sizeof(SNOW_BITS));
+    static const Sprite thunder = icon(THUNDER_BITS, sizeof(THUNDER_BITS));
+
+    // Groups follow getWeatherDescription() in WeatherWidget
+    if (weatherCode == 0) return &clear;
+    if (weatherCode == 1 || weatherCode == 2) return &partlyCloudy;
+    if (weatherCode == 3) return &cloudy;
+    if (weatherCode == 45 || weatherCode == 48) return &fog;
+    if ((weatherCode >= 51 && weatherCode <= 67) || (weatherCode >= 80 && weatherCode <= 82)) return &rain;
+    if ((weatherCode >= 71 && weatherCode <= 77) || weatherCode == 85 || weatherCode == 86) return &snow;
+    if (weatherCode >= 95 && weatherCode <= 99) return &thunder;
+    return nullptr;
+}
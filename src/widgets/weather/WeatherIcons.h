@@ -0,0 +1,20 @@
+#ifndef WEATHER_ICONS_H
+#define WEATHER_ICONS_H
+
+#include "../../core/Sprite.h"
+
+/**
+ * Condition icons for the weather widget: 48x48, one bit per pixel
+ * (1 = ink) and PackBits-compressed, about 1.4 KB of flash for the set.
+ * They are drawn with Compositor::blit(), ink in black over whatever is
+ * already there.
+ */
+class WeatherIcons {
+public:
+    static const int SIZE = 48;
+
+    // Icon for a WMO weather code, or nullptr if there is none
+    static const Sprite* forCode(int weatherCode);
+};
+
+#endif
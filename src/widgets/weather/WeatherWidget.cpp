@@ -1,14 +1,23 @@
 #include "WeatherWidget.h"
+#include "WeatherIcons.h"
+#include "HourlyForecast.h"
 #include "../../core/Logger.h"
 #include "../../core/Compositor.h"
+#include "../../core/MemoryTracker.h"
+#include "../../core/InputTrace.h"
+#include "../../core/WakeMetrics.h"
 #include "../../managers/ConfigManager.h"
+#include <ctime>
 
 const char* WeatherWidget::WEATHER_API_URL = "https://api.open-meteo.com/v1/forecast";
 
 WeatherWidget::WeatherWidget(Inkplate& display, const String& latitude, const String& longitude,
                            const String& city, const String& units)
     : Widget(display), lastWeatherUpdate(0), weatherLatitude(latitude),
-      weatherLongitude(longitude), weatherCity(city), weatherUnits(units) {
+      weatherLongitude(longitude), weatherCity(city), weatherUnits(units),
+      cache(("weather:" + latitude + "," + longitude + "," + units).c_str(), WEATHER_UPDATE_INTERVAL / 1000,
+            WEATHER_MAX_AGE_S),
+      revalidatePending(false) {
     currentWeather.isValid = false;
 }
 
@@ -16,6 +25,37 @@ void WeatherWidget::begin() {
     LOG_INFO("WeatherWidget", "Initializing weather widget...");
     currentWeather.isValid = false;
     lastWeatherUpdate = 0;
+    revalidatePending = false;
+
+    // Draw the last good forecast at once; a stale one is fetched again after the panel is up
+    String body;
+    if (cache.load(body) && parseWeatherResponse(body)) {
+        revalidatePending = cache.getFreshness() != Freshness::FRESH;
+        LOG_INFO("WeatherWidget", "Cached weather from %lu (%s)", static_cast<unsigned long>(cache.getFetchedAt()),
+                 revalidatePending ? "stale" : "fresh");
+    }
+}
+
+void WeatherWidget::forceUpdate() {
+    // Keep drawing the cached forecast; ask the server after the next render unless it is
+    // still fresh (every wake forces an update, and wakes can come more often than the interval)
+    revalidatePending = !cache.hasValue() || cache.getFreshness() != Freshness::FRESH;
+    lastWeatherUpdate = 0;
+}
+
+bool WeatherWidget::revalidate() {
+    if (!revalidatePending) {
+        return false;
+    }
+    revalidatePending = false;
+
+    WeatherData shown = currentWeather;
+    bool shownOld = isOld();
+    if (!fetchWeatherData()) {
+        revalidatePending = WiFi.status() != WL_CONNECTED;
+        return false;
+    }
+    return !sameShown(shown, currentWeather) || shownOld != isOld();
 }
 
 bool WeatherWidget::shouldUpdate() {
@@ -30,10 +70,11 @@ void WeatherWidget::render(const LayoutRegion& region) {
     // Clear the widget region
     clearRegion(region);
 
-    // Fetch weather data if not valid
+    // Nothing cached: this render has to wait for the server
     if (!currentWeather.isValid) {
         LOG_INFO("WeatherWidget", "Weather data not valid, attempting fetch...");
-        fetchWeatherData();
+        // Offline (the cached render runs before WiFi): try again once connected
+        revalidatePending = !fetchWeatherData() && WiFi.status() != WL_CONNECTED;
     }
 
     // Draw weather content within the region
@@ -49,10 +90,11 @@ void WeatherWidget::renderToCompositor(Compositor& compositor, const LayoutRegio
     // Clear the widget region on compositor
     clearRegionOnCompositor(compositor, region);
 
-    // Fetch weather data if not valid
+    // Nothing cached: this render has to wait for the server
     if (!currentWeather.isValid) {
         LOG_INFO("WeatherWidget", "Weather data not valid, attempting fetch...");
-        fetchWeatherData();
+        // Offline (the cached render runs before WiFi): try again once connected
+        revalidatePending = !fetchWeatherData() && WiFi.status() != WL_CONNECTED;
     }
 
     // Draw weather content to compositor within the region
@@ -61,15 +103,15 @@ void WeatherWidget::renderToCompositor(Compositor& compositor, const LayoutRegio
     lastWeatherUpdate = millis();
 }
 
-void WeatherWidget::fetchWeatherData() {
+bool WeatherWidget::fetchWeatherData() {
     if (WiFi.status() != WL_CONNECTED) {
         LOG_WARN("WeatherWidget", "WiFi not connected, cannot fetch weather");
-        currentWeather.isValid = false;
-        return;
+        return false;
     }
 
     LOG_INFO("WeatherWidget", "Fetching weather data...");
 
+    MemoryTracker::Scope memoryScope(MemorySubsystem::NETWORK);
     HTTPClient http;
     String url = buildWeatherURL();
     LOG_DEBUG("WeatherWidget", "Weather URL: %s", url.c_str());
@@ -77,18 +119,30 @@ void WeatherWidget::fetchWeatherData() {
     http.begin(url);
     http.setTimeout(5000); // 5 second timeout
     http.setReuse(false); // Don't keep connection alive
+    unsigned long requestStart = millis();
     int httpCode = http.GET();
+    bool ok = false;
 
     if (httpCode == HTTP_CODE_OK) {
         String response = http.getString();
+        memoryScope.checkpoint();
+        InputTrace::recordHttp(requestStart, url, httpCode, response);
         LOG_DEBUG("WeatherWidget", "Weather response: %s", response.c_str());
-        parseWeatherResponse(response);
+        ok = parseWeatherResponse(response);
+        if (ok) {
+            cache.store(response);
+        }
     } else {
+        InputTrace::recordHttp(requestStart, url, httpCode, String());
+        WakeMetrics::count(WakeCounter::HTTP_FAILURES);
         LOG_ERROR("WeatherWidget", "Weather API error: %d", httpCode);
-        currentWeather.isValid = false;
     }
 
     http.end();
+    if (!ok && currentWeather.isValid) {
+        LOG_WARN("WeatherWidget", "Keeping the weather from %lu", static_cast<unsigned long>(cache.getFetchedAt()));
+    }
+    return ok;
 }
 
 String WeatherWidget::buildWeatherURL() {
@@ -96,18 +150,21 @@ String WeatherWidget::buildWeatherURL() {
     url += "?latitude=" + weatherLatitude;
     url += "&longitude=" + weatherLongitude;
     url += "&current_weather=true&temperature_unit=" + weatherUnits;
-    url += "&hourly=precipitation_probability&forecast_days=1";
+    // Two days of hours, so a chart always has the next 24
+    url += "&hourly=temperature_2m,precipitation_probability&forecast_days=2&timeformat=unixtime";
     return url;
 }
 
-void WeatherWidget::parseWeatherResponse(String response) {
+bool WeatherWidget::parseWeatherResponse(String response) {
+    MemoryTracker::Scope memoryScope(MemorySubsystem::JSON);
     JsonDocument doc;
     DeserializationError error = deserializeJson(doc, response.c_str());
+    memoryScope.checkpoint();
 
+    // A bad response leaves the last good data in place
     if (error) {
         LOG_ERROR("WeatherWidget", "JSON parsing error: %s", error.c_str());
-        currentWeather.isValid = false;
-        return;
+        return false;
     }
 
     if (doc["current_weather"]["temperature"]) {
@@ -126,6 +183,14 @@ void WeatherWidget::parseWeatherResponse(String response) {
             }
         }
 
+        // The hours start at midnight: show the current one's rain when the clock is set
+        if (HourlyForecast::publish(doc["hourly"].as<JsonObjectConst>())) {
+            int hour = HourlyForecast::find(static_cast<uint32_t>(time(nullptr) / 3600 * 3600));
+            if (hour >= 0 && HourlyForecast::getPrecipitation(hour) >= 0) {
+                currentWeather.precipitationProbability = HourlyForecast::getPrecipitation(hour);
+            }
+        }
+
         currentWeather.isValid = true;
 
         LOG_INFO("WeatherWidget", "Weather: %.1f°F, %s, %d%% rain (code: %d)",
@@ -133,10 +198,23 @@ void WeatherWidget::parseWeatherResponse(String response) {
                  currentWeather.description.c_str(),
                  currentWeather.precipitationProbability,
                  weatherCode);
-    } else {
-        LOG_ERROR("WeatherWidget", "Failed to parse weather data");
-        currentWeather.isValid = false;
+        return true;
     }
+    LOG_ERROR("WeatherWidget", "Failed to parse weather data");
+    return false;
+}
+
+bool WeatherWidget::isOld() const {
+    if (!cache.hasValue() || cache.getFetchedAt() == 0) return false;
+    time_t now = time(nullptr);
+    return now >= static_cast<time_t>(cache.getFetchedAt()) + WEATHER_OLD_S;
+}
+
+bool WeatherWidget::sameShown(const WeatherData& a, const WeatherData& b) {
+    // What the panel shows: whole degrees, the condition and the rain chance
+    return a.isValid == b.isValid && static_cast<int>(a.temperature) == static_cast<int>(b.temperature) &&
+           a.icon == b.icon && a.description == b.description &&
+           a.precipitationProbability == b.precipitationProbability;
 }
 
 void WeatherWidget::drawWeatherDisplay(const LayoutRegion& region) {
@@ -195,6 +273,16 @@ void WeatherWidget::drawWeatherDisplay(const LayoutRegion& region) {
     display.print("Rain: ");
     display.print(currentWeather.precipitationProbability);
     display.print("%");
+
+    // Last good data from a while ago: say when it is from
+    if (isOld()) {
+        time_t fetchedAt = static_cast<time_t>(cache.getFetchedAt());
+        struct tm local;
+        localtime_r(&fetchedAt, &local);
+        display.setCursor(labelX, labelY + 160);
+        display.setTextSize(1);
+        display.printf("Updated %02d:%02d", local.tm_hour, local.tm_min);
+    }
 }
 
 const char* WeatherWidget::getWeatherDescription(int weatherCode) {
@@ -261,6 +349,12 @@ void WeatherWidget::drawWeatherDisplayToCompositor(Compositor& compositor, const
     int tempWidth = tempStr.length() * 24; // Approximate width for size 4
     compositor.fillRect(labelX, labelY + 55, tempWidth, 35, 0); // Black rectangle for temperature
 
+    // Condition icon beside the temperature
+    const Sprite* icon = WeatherIcons::forCode(currentWeather.icon.toInt());
+    if (icon) {
+        compositor.blit(labelX + tempWidth + 15, labelY + 50, *icon);
+    }
+
     // Draw weather description area
     int descWidth = currentWeather.description.length() * 12; // Approximate width for size 2
     compositor.fillRect(labelX, labelY + 105, descWidth, 20, 0); // Black rectangle for description
@@ -269,6 +363,11 @@ void WeatherWidget::drawWeatherDisplayToCompositor(Compositor& compositor, const
     String precipStr = "Rain: " + String(currentWeather.precipitationProbability) + "%";
     int precipWidth = precipStr.length() * 12; // Approximate width for size 2
     compositor.fillRect(labelX, labelY + 135, precipWidth, 20, 0); // Black rectangle for precipitation
+
+    // "Updated HH:MM" area for old data
+    if (isOld()) {
+        compositor.fillRect(labelX, labelY + 160, 80, 10, 0);
+    }
 }
 WidgetType WeatherWidget::getWidgetType() const {
     return WidgetTypeTraits<WeatherWidget>::type();
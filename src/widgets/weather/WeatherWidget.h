@@ -1,6 +1,7 @@
 #ifndef WEATHER_WIDGET_H
 #define WEATHER_WIDGET_H
 
+#include "../../core/SourceCache.h"
 #include "../../core/Widget.h"
 #include <WiFi.h>
 #include <HTTPClient.h>
@@ -18,6 +19,13 @@ struct WeatherData {
     bool isValid;
 };
 
+/**
+ * Current conditions from Open-Meteo. The last good response is kept in a
+ * SourceCache: a wake draws it straight away and only a stale one is asked
+ * for again, after the panel is up (revalidate()). A failed fetch keeps the
+ * last good data, for up to WEATHER_MAX_AGE_S; only a cold start with
+ * nothing cached waits for the server inside render.
+ */
 class WeatherWidget : public Widget {
 public:
     WeatherWidget(Inkplate& display, const String& latitude, const String& longitude,
@@ -28,11 +36,14 @@ public:
     void renderToCompositor(Compositor& compositor, const LayoutRegion& region) override;
     bool shouldUpdate() override;
     void begin() override;
+    void forceUpdate() override;
+    bool revalidate() override;
     WidgetType getWidgetType() const override;
 
     // Weather-specific methods
-    void fetchWeatherData();
+    bool fetchWeatherData();
     bool isWeatherDataValid() const;
+    bool parseWeatherResponse(String response); // Made public for benchmarking
 
 private:
     unsigned long lastWeatherUpdate;
@@ -44,13 +55,19 @@ private:
     String weatherCity;
     String weatherUnits;
 
+    SourceCache cache;
+    bool revalidatePending;  // Ask the server after the next render
+
     static const unsigned long WEATHER_UPDATE_INTERVAL = 1800000; // 30 minutes
+    static const uint32_t WEATHER_MAX_AGE_S = 86400;              // Shown for a day without a fetch
+    static const uint32_t WEATHER_OLD_S = 7200;                   // Drawn with its time from then on
     static const char* WEATHER_API_URL;
 
     void drawWeatherDisplay(const LayoutRegion& region);
     void drawWeatherDisplayToCompositor(Compositor& compositor, const LayoutRegion& region);
     String buildWeatherURL();
-    void parseWeatherResponse(String response);
+    bool isOld() const;
+    static bool sameShown(const WeatherData& a, const WeatherData& b);
     const char* getWeatherDescription(int weatherCode);
 };
 
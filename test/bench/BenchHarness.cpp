@@ -0,0 +1,91 @@
+#include "BenchHarness.h"
+#include "HostClock.h"
+#include "HostHeap.h"
+#include <chrono>
+
+namespace bench {
+
+uint64_t Registry::minTimeNs = 200ULL * 1000000ULL;
+
+std::vector<Registry::Entry>& Registry::entries() {
+    static std::vector<Entry> registered;
+    return registered;
+}
+
+void Registry::add(const std::string& name, Operation op) {
+    entries().push_back({name, op});
+}
+
+std::vector<Result> Registry::run(const std::string& filter, FILE* out) {
+    std::vector<Result> results;
+    for (const Entry& entry : entries()) {
+        if (!filter.empty() && entry.name.find(filter) == std::string::npos) {
+            continue;
+        }
+        Result result = measure(entry);
+        writeJson(result, out);
+        results.push_back(result);
+    }
+    return results;
+}
+
+Result Registry::measure(const Entry& entry) {
+    typedef std::chrono::steady_clock Clock;
+
+    // Warm-up: first-touch allocations and lazy statics should not be counted
+    entry.op();
+
+    uint64_t iterations = 1;
+    uint64_t elapsedNs = 0;
+    HostHeap::Counters before = {};
+    HostHeap::Counters after = {};
+    uint64_t simStartMicros = 0;
+    uint64_t simEndMicros = 0;
+
+    while (true) {
+        before = HostHeap::snapshot();
+        simStartMicros = HostClock::micros();
+        Clock::time_point start = Clock::now();
+        for (uint64_t i = 0; i < iterations; i++) {
+            entry.op();
+        }
+        Clock::time_point end = Clock::now();
+        simEndMicros = HostClock::micros();
+        after = HostHeap::snapshot();
+
+        elapsedNs = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+        if (elapsedNs >= minTimeNs || iterations >= (1ULL << 40)) {
+            break;
+        }
+
+        // Aim straight for the target once there is a usable estimate
+        if (elapsedNs > minTimeNs / 100) {
+            uint64_t projected = iterations * minTimeNs / elapsedNs;
+            iterations = projected + projected / 10 + 1;
+        } else {
+            iterations *= 10;
+        }
+    }
+
+    Result result;
+    result.name = entry.name;
+    result.iterations = iterations;
+    result.nsPerOp = static_cast<double>(elapsedNs) / iterations;
+    result.bytesPerOp = static_cast<double>(after.bytesAllocated - before.bytesAllocated) / iterations;
+    result.allocsPerOp = static_cast<double>(after.allocations - before.allocations) / iterations;
+    result.simMsPerOp = static_cast<double>(simEndMicros - simStartMicros) / 1000.0 / iterations;
+    return result;
+}
+
+void Registry::writeJson(const Result& result, FILE* out) {
+    fprintf(out,
+            "{\"name\":\"%s\",\"iterations\":%llu,\"ns_per_op\":%.1f,"
+            "\"bytes_per_op\":%.1f,\"allocs_per_op\":%.2f,\"sim_ms_per_op\":%.1f}\n",
+            result.name.c_str(),
+            static_cast<unsigned long long>(result.iterations),
+            result.nsPerOp, result.bytesPerOp, result.allocsPerOp, result.simMsPerOp);
+    fflush(out);
+}
+
+} // namespace bench
@@ -0,0 +1,78 @@
+#ifndef BENCH_HARNESS_H
+#define BENCH_HARNESS_H
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * Minimal microbenchmark runner for the native environment.
+ *
+ * Each benchmark is an operation closure; the runner warms it up, doubles the
+ * iteration count until a run takes at least the minimum time, then reports
+ * one JSON object per line with ns/op and heap traffic per op (from HostHeap).
+ * sim_ms_per_op is how far an op moved the virtual HostClock: waits that
+ * cost no CPU on the host, such as HTTP latency.
+ */
+namespace bench {
+
+typedef std::function<void()> Operation;
+
+struct Result {
+    std::string name;
+    uint64_t iterations;
+    double nsPerOp;
+    double bytesPerOp;
+    double allocsPerOp;
+    double simMsPerOp;
+};
+
+class Registry {
+public:
+    static void add(const std::string& name, Operation op);
+
+    // Runs every benchmark whose name contains filter (all when empty)
+    static std::vector<Result> run(const std::string& filter, FILE* out);
+
+    static void setMinTimeMs(uint64_t ms) { minTimeNs = ms * 1000000ULL; }
+
+private:
+    struct Entry {
+        std::string name;
+        Operation op;
+    };
+
+    static std::vector<Entry>& entries();
+    static Result measure(const Entry& entry);
+    static void writeJson(const Result& result, FILE* out);
+
+    static uint64_t minTimeNs;
+};
+
+// Keeps the optimizer from discarding results that are otherwise unused
+template <typename T>
+inline void doNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+} // namespace bench
+
+class Inkplate;
+class Compositor;
+
+// Panel and full-screen compositor shared by all suites. Each takes 1-2 MB
+// of the emulated 4 MB PSRAM, so one per suite does not fit.
+Inkplate& benchDisplay();
+Compositor& benchCompositor();  // Check isInitialized() before use
+
+// Registration hooks implemented by each bench_*.cpp file
+void registerCompositorBenchmarks();
+void registerCoalesceBenchmarks();
+void registerParsingBenchmarks();
+void registerWidgetBenchmarks();
+void registerLoggerBenchmarks();
+void registerNetworkBenchmarks();
+
+#endif
@@ -0,0 +1,39 @@
+#include "BenchHarness.h"
+#include "core/Compositor.h"
+#include <string>
+
+// Deterministic xorshift so every run coalesces the same layout
+static uint32_t nextRandom(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static std::vector<LayoutRegion> makeRegions(size_t count, uint32_t seed) {
+    std::vector<LayoutRegion> regions;
+    regions.reserve(count);
+    uint32_t state = seed;
+    for (size_t i = 0; i < count; i++) {
+        int w = 20 + static_cast<int>(nextRandom(state) % 200);
+        int h = 20 + static_cast<int>(nextRandom(state) % 150);
+        int x = static_cast<int>(nextRandom(state) % (1200 - w));
+        int y = static_cast<int>(nextRandom(state) % (825 - h));
+        regions.push_back(LayoutRegion(x, y, w, h));
+    }
+    return regions;
+}
+
+void registerCoalesceBenchmarks() {
+    // coalesceRegions does not touch the surface, so no initialize() needed
+    static Compositor compositor(1200, 825);
+    static const size_t counts[] = {2, 8, 32, 128};
+
+    for (size_t count : counts) {
+        std::vector<LayoutRegion> regions = makeRegions(count, 0x9E3779B9u);
+        bench::Registry::add("coalesce/" + std::to_string(count), [regions]() {
+            std::vector<LayoutRegion> merged = compositor.coalesceRegions(regions);
+            bench::doNotOptimize(merged.size());
+        });
+    }
+}
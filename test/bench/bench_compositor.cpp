@@ -0,0 +1,104 @@
+#include "BenchHarness.h"
+#include "core/Compositor.h"
+#include "core/PanelFrame.h"
+#include "widgets/weather/WeatherIcons.h"
+#include <vector>
+
+void registerCompositorBenchmarks() {
+    static Compositor& compositor = benchCompositor();
+    static Inkplate& display = benchDisplay();
+
+    if (!compositor.isInitialized()) {
+        fprintf(stderr, "Compositor failed to initialize; skipping compositor benchmarks\n");
+        return;
+    }
+
+    bench::Registry::add("compositor/clear", []() {
+        compositor.clear();
+    });
+
+    bench::Registry::add("compositor/clearRegion/400x275", []() {
+        compositor.clearRegion(LayoutRegion(400, 275, 400, 275));
+    });
+
+    bench::Registry::add("compositor/fillRect/full", []() {
+        compositor.fillRect(0, 0, 1200, 825, 0);
+    });
+
+    bench::Registry::add("compositor/fillRect/100x50", []() {
+        compositor.fillRect(300, 200, 100, 50, 128);
+    });
+
+    bench::Registry::add("compositor/drawRect/400x275", []() {
+        compositor.drawRect(10, 10, 400, 275, 0);
+    });
+
+    bench::Registry::add("compositor/setPixel/1000", []() {
+        for (int i = 0; i < 1000; i++) {
+            compositor.setPixel(i, i % 825, static_cast<uint8_t>(i));
+        }
+    });
+
+    // Sprites: an opaque 8-bit logo, the same with a transparency key and
+    // PackBits-compressed, and a 1-bit icon through a palette
+    static std::vector<uint8_t> logo;
+    static std::vector<uint8_t> packedLogo;
+    if (logo.empty()) {
+        for (int y = 0; y < 100; y++) {
+            for (int x = 0; x < 200; x++) {
+                logo.push_back((x / 25 + y / 25) % 2 ? 0 : static_cast<uint8_t>(x));
+            }
+        }
+        PanelFrame::packBits(logo.data(), logo.size(), packedLogo);
+    }
+
+    bench::Registry::add("compositor/blit/8bit-200x100", []() {
+        Sprite sprite;
+        sprite.data = logo.data();
+        sprite.length = logo.size();
+        sprite.width = 200;
+        sprite.height = 100;
+        compositor.blit(300, 200, sprite);
+    });
+
+    bench::Registry::add("compositor/blit/8bit-keyed-200x100", []() {
+        Sprite sprite;
+        sprite.data = logo.data();
+        sprite.length = logo.size();
+        sprite.width = 200;
+        sprite.height = 100;
+        sprite.key = 0;
+        compositor.blit(300, 200, sprite);
+    });
+
+    bench::Registry::add("compositor/blit/packbits-200x100", []() {
+        Sprite sprite;
+        sprite.data = packedLogo.data();
+        sprite.length = packedLogo.size();
+        sprite.width = 200;
+        sprite.height = 100;
+        sprite.encoding = SpriteEncoding::PACKBITS;
+        compositor.blit(300, 200, sprite);
+    });
+
+    bench::Registry::add("compositor/blit/weather-icon", []() {
+        compositor.blit(500, 300, *WeatherIcons::forCode(61));
+    });
+
+    bench::Registry::add("compositor/displayToInkplate", []() {
+        compositor.fillRect(0, 0, 600, 412, 0);
+        compositor.displayToInkplate(display);
+    });
+
+    bench::Registry::add("compositor/partialDisplayToInkplate/4regions", []() {
+        std::vector<LayoutRegion> regions;
+        regions.push_back(LayoutRegion(0, 0, 300, 200));
+        regions.push_back(LayoutRegion(600, 0, 300, 200));
+        regions.push_back(LayoutRegion(0, 400, 300, 200));
+        regions.push_back(LayoutRegion(600, 400, 300, 200));
+        for (const LayoutRegion& region : regions) {
+            compositor.fillRect(region.getX(), region.getY(), region.getWidth(), region.getHeight(), 64);
+        }
+        compositor.partialDisplayToInkplate(display, regions);
+    });
+}
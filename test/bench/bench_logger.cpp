@@ -0,0 +1,21 @@
+#include "BenchHarness.h"
+#include "core/Logger.h"
+
+void registerLoggerBenchmarks() {
+    // Calls below the current level should cost next to nothing
+    bench::Registry::add("logger/filtered", []() {
+        Logger::setLogLevel(LogLevel::WARN);
+        LOG_DEBUG("Bench", "Filtered message %d %s", 42, "value");
+    });
+
+    bench::Registry::add("logger/emitted/plain", []() {
+        Logger::setLogLevel(LogLevel::DEBUG);
+        LOG_INFO("Bench", "Plain message without arguments");
+    });
+
+    bench::Registry::add("logger/emitted/formatted", []() {
+        Logger::setLogLevel(LogLevel::DEBUG);
+        LOG_INFO("Bench", "Region %dx%d at (%d,%d), %.1f%% merged: %s",
+                 600, 625, 600, 100, 72.5f, "yes");
+    });
+}
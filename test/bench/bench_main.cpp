@@ -0,0 +1,58 @@
+#include "BenchHarness.h"
+#include <Arduino.h>
+#include <Inkplate.h>
+#include "HostClock.h"
+#include "core/Compositor.h"
+#include <cstdlib>
+#include <cstring>
+
+Inkplate& benchDisplay() {
+    static Inkplate display(INKPLATE_3BIT);
+    return display;
+}
+
+Compositor& benchCompositor() {
+    static Compositor compositor(1200, 825);
+    if (!compositor.isInitialized()) {
+        // The default threshold keeps the full surface off the device heap; lift it
+        compositor.setMemoryPressureThreshold(SIZE_MAX);
+        compositor.initialize();
+    }
+    return compositor;
+}
+
+/**
+ * Native benchmark entry point.
+ *
+ * Usage: bench [--filter <substring>] [--min-time-ms <ms>]
+ * Results go to stdout as JSON lines; firmware logging is discarded.
+ */
+int main(int argc, char** argv) {
+    std::string filter;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (strcmp(argv[i], "--min-time-ms") == 0 && i + 1 < argc) {
+            bench::Registry::setMinTimeMs(strtoull(argv[++i], nullptr, 10));
+        } else {
+            fprintf(stderr, "Usage: %s [--filter <substring>] [--min-time-ms <ms>]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    // Logging goes nowhere so benchmarks measure formatting, not the terminal
+    Serial.setOutput(nullptr);
+    // Only simulated waits move the clock, so sim_ms_per_op excludes CPU time
+    HostClock::setVirtual(true);
+
+    registerCompositorBenchmarks();
+    registerCoalesceBenchmarks();
+    registerParsingBenchmarks();
+    registerWidgetBenchmarks();
+    registerLoggerBenchmarks();
+    registerNetworkBenchmarks();
+
+    std::vector<bench::Result> results = bench::Registry::run(filter, stdout);
+    fprintf(stderr, "%zu benchmarks completed\n", results.size());
+    return results.empty() ? 1 : 0;
+}
@@ -0,0 +1,69 @@
+#include "BenchHarness.h"
+#include "HostTransport.h"
+#include "HTTPClient.h"
+#include "WiFi.h"
+#include "widgets/image/ImageWidget.h"
+#include "widgets/weather/WeatherWidget.h"
+#include <memory>
+
+// Fetches per op: enough that losses and resets show up at their rates
+static const int FETCHES_PER_OP = 100;
+
+/**
+ * Answers every request with a body the size of a typical dashboard PNG
+ */
+class ImageTransport : public HostTransport {
+public:
+    HostResponse handle(const HostRequest& request) override {
+        (void)request;
+        static const std::string body = std::string("\x89PNG\r\n\x1a\n", 8) + std::string(48 * 1024 - 8, 'x');
+        HostResponse response;
+        response.status = 200;
+        response.body = body;
+        response.headers = "Content-Type: image/png\n";
+        response.latencyMs = 40;
+        return response;
+    }
+};
+
+// Runs fetch FETCHES_PER_OP times over a link freshly seeded for every op,
+// so sim_ms_per_op is the same on every machine and every run
+static void fetchOver(HostTransport& server, const NetworkConditionTransport::Profile& profile,
+                      const std::function<void()>& fetch) {
+    NetworkConditionTransport link(server, profile, 0x5EED);
+    HTTPClient::setTransport(&link);
+    for (int i = 0; i < FETCHES_PER_OP; i++) {
+        fetch();
+    }
+    HTTPClient::setTransport(nullptr);
+}
+
+void registerNetworkBenchmarks() {
+    static Inkplate& display = benchDisplay();
+    static const LayoutRegion region(600, 100, 600, 625);
+    static const char* const presets[] = {"good", "fair", "weak", "poor"};
+
+    static FixtureTransport weatherServer;          // Synthetic forecast
+    weatherServer.setLatencyMs(60);
+    static ImageTransport imageServer;
+
+    static WeatherWidget weatherWidget(display, "47.6062", "-122.3321", "Seattle", "fahrenheit");
+    static ImageWidget imageWidget(display, "https://images.example.com/dashboard.png");
+    WiFi.begin("bench");
+
+    for (const char* name : presets) {
+        NetworkConditionTransport::Profile profile;
+        NetworkConditionTransport::preset(name, profile);
+
+        bench::Registry::add(std::string("fetch/weather/") + name + "/x100", [profile]() {
+            fetchOver(weatherServer, profile, []() {
+                weatherWidget.fetchWeatherData();
+            });
+        });
+        bench::Registry::add(std::string("fetch/image/") + name + "/x100", [profile]() {
+            fetchOver(imageServer, profile, []() {
+                bench::doNotOptimize(imageWidget.fetchAndDisplay(region));
+            });
+        });
+    }
+}
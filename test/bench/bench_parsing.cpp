@@ -0,0 +1,60 @@
+#include "BenchHarness.h"
+#include "managers/ConfigManager.h"
+#include "widgets/weather/WeatherWidget.h"
+#include <SPIFFS.h>
+
+// Representative config.json as written by scripts/setup-config.py
+static const char* SAMPLE_CONFIG = R"JSON({
+  "Wifi": { "SSID": "bench-network", "Password": "bench-password" },
+  "Server": { "Url": "http://example.com/image.jpg" },
+  "Layout": {
+    "header":  { "X": 0,   "Y": 0,   "Width": 1200, "Height": 100 },
+    "left":    { "X": 0,   "Y": 100, "Width": 600,  "Height": 625 },
+    "right":   { "X": 600, "Y": 100, "Width": 600,  "Height": 625 },
+    "footer":  { "X": 0,   "Y": 725, "Width": 1200, "Height": 100 }
+  },
+  "Widgets": [
+    { "type": "NameWidget", "region": "header", "familyName": "The Benchmarks" },
+    { "type": "TimeWidget", "region": "left", "timeUpdateMs": 60000 },
+    { "type": "WeatherWidget", "region": "right", "latitude": "47.6062",
+      "longitude": "-122.3321", "city": "Seattle", "units": "fahrenheit" },
+    { "type": "BatteryWidget", "region": "footer", "batteryUpdateMs": 900000 },
+    { "type": "LayoutWidget", "showRegionBorders": true, "showSeparators": true }
+  ],
+  "Display": { "Width": 1200, "Height": 825, "UsePartialUpdates": true },
+  "Hardware": { "WakeButtonPin": 36 },
+  "Power": { "EnableDeepSleep": true, "DeepSleepThresholdMs": 600000 },
+  "Debug": { "ShowOnScreen": false, "TrackMemory": false }
+})JSON";
+
+// Open-Meteo forecast response trimmed to the fields the widget requests
+static const char* SAMPLE_WEATHER = R"JSON({
+  "latitude": 47.6062, "longitude": -122.3321, "generationtime_ms": 0.21,
+  "utc_offset_seconds": 0, "timezone": "GMT", "elevation": 56.0,
+  "current_weather": { "temperature": 54.3, "windspeed": 7.2, "winddirection": 210,
+                       "weathercode": 61, "is_day": 1, "time": "2024-03-01T15:00" },
+  "hourly_units": { "time": "iso8601", "precipitation_probability": "%" },
+  "hourly": {
+    "time": ["2024-03-01T15:00", "2024-03-01T16:00", "2024-03-01T17:00", "2024-03-01T18:00",
+             "2024-03-01T19:00", "2024-03-01T20:00", "2024-03-01T21:00", "2024-03-01T22:00"],
+    "precipitation_probability": [65, 70, 72, 60, 45, 30, 25, 20]
+  }
+})JSON";
+
+void registerParsingBenchmarks() {
+    static ConfigManager configManager;
+    static Inkplate& display = benchDisplay();
+    static WeatherWidget weather(display, "47.6062", "-122.3321", "Seattle", "fahrenheit");
+
+    SPIFFS.begin(true);
+    SPIFFS.writeFile("/config.json", SAMPLE_CONFIG);
+
+    bench::Registry::add("parse/config", []() {
+        bool loaded = configManager.loadConfig();
+        bench::doNotOptimize(loaded);
+    });
+
+    bench::Registry::add("parse/weather", []() {
+        weather.parseWeatherResponse(String(SAMPLE_WEATHER));
+    });
+}
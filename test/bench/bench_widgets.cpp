@@ -0,0 +1,69 @@
+#include "BenchHarness.h"
+#include "core/Compositor.h"
+#include "widgets/battery/BatteryWidget.h"
+#include "widgets/layout/LayoutWidget.h"
+#include "widgets/name/NameWidget.h"
+#include "widgets/time/TimeWidget.h"
+#include "widgets/weather/WeatherWidget.h"
+#include <memory>
+
+void registerWidgetBenchmarks() {
+    static Inkplate& display = benchDisplay();
+    static Compositor& compositor = benchCompositor();
+    static const LayoutRegion region(600, 100, 600, 625);
+
+    if (!compositor.isInitialized()) {
+        fprintf(stderr, "Compositor failed to initialize; skipping widget benchmarks\n");
+        return;
+    }
+
+    static TimeWidget timeWidget(display, 60000);
+    static BatteryWidget batteryWidget(display, 900000);
+    static NameWidget nameWidget(display, "The Benchmarks");
+    static LayoutWidget layoutWidget(display, true, true);
+    static WeatherWidget weatherWidget(display, "47.6062", "-122.3321", "Seattle", "fahrenheit");
+
+    timeWidget.begin();
+    batteryWidget.begin();
+    nameWidget.begin();
+    layoutWidget.begin();
+
+    static std::vector<std::unique_ptr<LayoutRegion>> layoutRegions;
+    layoutRegions.emplace_back(new LayoutRegion(0, 0, 1200, 100));
+    layoutRegions.emplace_back(new LayoutRegion(0, 100, 600, 625));
+    layoutRegions.emplace_back(new LayoutRegion(600, 100, 600, 625));
+    layoutRegions.emplace_back(new LayoutRegion(0, 725, 1200, 100));
+    layoutWidget.setRegions(&layoutRegions);
+
+    // Valid cached data keeps renderToCompositor off the network path
+    weatherWidget.parseWeatherResponse(String(
+        "{\"current_weather\":{\"temperature\":54.3,\"weathercode\":61},"
+        "\"hourly\":{\"precipitation_probability\":[65,70]}}"));
+
+    bench::Registry::add("widget/time/renderToCompositor", []() {
+        timeWidget.renderToCompositor(compositor, region);
+    });
+    bench::Registry::add("widget/battery/renderToCompositor", []() {
+        batteryWidget.renderToCompositor(compositor, region);
+    });
+    bench::Registry::add("widget/name/renderToCompositor", []() {
+        nameWidget.renderToCompositor(compositor, region);
+    });
+    bench::Registry::add("widget/weather/renderToCompositor", []() {
+        weatherWidget.renderToCompositor(compositor, region);
+    });
+    bench::Registry::add("widget/layout/renderToCompositor", []() {
+        layoutWidget.renderToCompositor(compositor, region);
+    });
+
+    // Direct (fallback) rendering straight to the panel driver
+    bench::Registry::add("widget/time/render", []() {
+        timeWidget.render(region);
+    });
+    bench::Registry::add("widget/name/render", []() {
+        nameWidget.render(region);
+    });
+    bench::Registry::add("widget/weather/render", []() {
+        weatherWidget.render(region);
+    });
+}
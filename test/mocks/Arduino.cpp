@@ -0,0 +1,129 @@
+#include "Arduino.h"
+#include "HostClock.h"
+#include "HostHeap.h"
+#include "esp_heap_caps.h"
+#include "WiFi.h"
+#include <cstdlib>
+#include <ctime>
+
+HardwareSerial Serial;
+EspClass ESP;
+
+static uint8_t pinModes[64] = {0};
+static uint8_t pinLevels[64] = {0};
+static uint32_t cpuFrequencyMhz = 240;
+
+unsigned long millis() {
+    return static_cast<unsigned long>(HostClock::micros() / 1000ULL);
+}
+
+unsigned long micros() {
+    return static_cast<unsigned long>(HostClock::micros());
+}
+
+void delay(unsigned long ms) {
+    HostClock::advanceMillis(ms);
+}
+
+void delayMicroseconds(unsigned int us) {
+    HostClock::advanceMicros(us);
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    if (pin >= sizeof(pinModes)) return;
+    pinModes[pin] = mode;
+    if (mode == INPUT_PULLUP) {
+        pinLevels[pin] = HIGH;  // Released buttons read high
+    }
+}
+
+int digitalRead(uint8_t pin) {
+    return pin < sizeof(pinLevels) ? pinLevels[pin] : LOW;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    if (pin < sizeof(pinLevels)) {
+        pinLevels[pin] = value ? HIGH : LOW;
+    }
+}
+
+bool setCpuFrequencyMhz(uint32_t mhz) {
+    cpuFrequencyMhz = mhz;
+    return true;
+}
+
+uint32_t getCpuFrequencyMhz() {
+    return cpuFrequencyMhz;
+}
+
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char* server1,
+                const char* server2, const char* server3) {
+    (void)server1;
+    (void)server2;
+    (void)server3;
+
+    // Same POSIX TZ string the ESP32 core builds (note the inverted sign)
+    char tz[32];
+    long offset = -gmtOffsetSec;
+    snprintf(tz, sizeof(tz), "UTC%s%ld:%02ld%s", offset >= 0 ? "+" : "-",
+             labs(offset) / 3600, (labs(offset) % 3600) / 60, daylightOffsetSec ? "DST" : "");
+    setenv("TZ", tz, 1);
+    tzset();
+
+    // SNTP answers right away when the network is up, unless the host
+    // supplies the answer
+    if (WiFi.status() == WL_CONNECTED) {
+        HostClock::SntpHandler handler = HostClock::getSntpHandler();
+        uint32_t delayMs = 0;
+        uint64_t epochUs = 0;
+        if (!handler) {
+            HostClock::setWallClockSynced(true);
+        } else if (handler(delayMs, epochUs)) {
+            HostClock::scheduleWallClockSync(HostClock::micros() + delayMs * 1000ULL, epochUs);
+        }
+    }
+}
+
+// Linked with -Wl,--wrap=time: firmware calls to time() see the emulated RTC
+extern "C" time_t __wrap_time(time_t* result) {
+    uint64_t us = HostClock::isWallClockSynced() ? HostClock::epochMicros() : HostClock::micros();
+    time_t now = static_cast<time_t>(us / 1000000ULL);
+    if (result) *result = now;
+    return now;
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    if (!output) return 1;
+    fputc(c, output);
+    return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+    if (!output) return size;
+    return fwrite(buffer, 1, size, output);
+}
+
+void HardwareSerial::flush() {
+    if (output) fflush(output);
+}
+
+uint32_t EspClass::getFreeHeap() {
+    return static_cast<uint32_t>(heap_caps_get_free_size(MALLOC_CAP_INTERNAL));
+}
+
+uint32_t EspClass::getMinFreeHeap() {
+    return static_cast<uint32_t>(heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL));
+}
+
+uint32_t EspClass::getHeapSize() {
+    return static_cast<uint32_t>(HostHeap::internalCapacity());
+}
+
+uint32_t EspClass::getFreePsram() {
+    return static_cast<uint32_t>(heap_caps_get_free_size(MALLOC_CAP_SPIRAM));
+}
+
+void EspClass::restart() {
+    fflush(stdout);
+    exit(0);
+}
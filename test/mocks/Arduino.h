@@ -0,0 +1,167 @@
+#ifndef MOCK_ARDUINO_H
+#define MOCK_ARDUINO_H
+
+/**
+ * Host stand-in for the subset of the ESP32 Arduino core used by the firmware.
+ * Lets the core, managers and widgets build natively for benchmarks and tests.
+ */
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <ctime>
+#include <algorithm>
+#include "WString.h"
+
+using std::min;
+using std::max;
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT        0x01
+#define OUTPUT       0x03
+#define INPUT_PULLUP 0x05
+
+// RTC slow memory survives deep sleep; the host runner saves and restores
+// this section across simulated wake cycles (see HostSleep)
+#define RTC_DATA_ATTR __attribute__((section("rtc_data")))
+#define IRAM_ATTR
+#define PROGMEM
+
+// Timing (host clock, see HostClock.h)
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+// GPIO
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t value);
+// Only the Inkplate battery pin reads anything (see MockInkplate)
+uint32_t analogReadMilliVolts(uint8_t pin);
+
+// System
+bool setCpuFrequencyMhz(uint32_t mhz);
+uint32_t getCpuFrequencyMhz();
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char* server1,
+                const char* server2 = nullptr, const char* server3 = nullptr);
+
+class Print {
+public:
+    virtual ~Print() {}
+
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size) {
+        size_t n = 0;
+        while (size--) n += write(*buffer++);
+        return n;
+    }
+    size_t write(const char* str) { return str ? write(reinterpret_cast<const uint8_t*>(str), strlen(str)) : 0; }
+    size_t write(const char* buffer, size_t size) { return write(reinterpret_cast<const uint8_t*>(buffer), size); }
+
+    size_t print(const char* str) { return write(str); }
+    size_t print(const String& str) { return write(str.c_str(), str.length()); }
+    size_t print(char c) { return write(static_cast<uint8_t>(c)); }
+    size_t print(int value) { return printf("%d", value); }
+    size_t print(unsigned int value) { return printf("%u", value); }
+    size_t print(long value) { return printf("%ld", value); }
+    size_t print(unsigned long value) { return printf("%lu", value); }
+    size_t print(double value, int digits = 2) { return printf("%.*f", digits, value); }
+
+    size_t println() { return write("\r\n"); }
+    template<typename T>
+    size_t println(const T& value) { size_t n = print(value); return n + println(); }
+
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+        char stackBuffer[256];
+        va_list args;
+        va_start(args, format);
+        int len = vsnprintf(stackBuffer, sizeof(stackBuffer), format, args);
+        va_end(args);
+        if (len < 0) return 0;
+        if (static_cast<size_t>(len) < sizeof(stackBuffer)) {
+            return write(stackBuffer, len);
+        }
+
+        char* heapBuffer = static_cast<char*>(malloc(len + 1));
+        if (!heapBuffer) return 0;
+        va_start(args, format);
+        vsnprintf(heapBuffer, len + 1, format, args);
+        va_end(args);
+        size_t n = write(heapBuffer, len);
+        free(heapBuffer);
+        return n;
+    }
+
+    virtual void flush() {}
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    void setTimeout(unsigned long timeout) { streamTimeout = timeout; }
+
+    size_t readBytes(char* buffer, size_t length) {
+        size_t count = 0;
+        while (count < length) {
+            int c = read();
+            if (c < 0) break;
+            buffer[count++] = static_cast<char>(c);
+        }
+        return count;
+    }
+    size_t readBytes(uint8_t* buffer, size_t length) { return readBytes(reinterpret_cast<char*>(buffer), length); }
+
+protected:
+    unsigned long streamTimeout = 1000;
+};
+
+/**
+ * Serial port writes to stdout by default; benchmarks and tests can redirect
+ * or discard it to keep logging out of the measurement.
+ */
+class HardwareSerial : public Stream {
+public:
+    void begin(unsigned long baud) { (void)baud; }
+    void end() {}
+    void setOutput(FILE* stream) { output = stream; }
+    FILE* getOutput() const { return output; }
+
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+    void flush() override;
+
+    explicit operator bool() const { return true; }
+
+private:
+    FILE* output = stdout;
+};
+
+extern HardwareSerial Serial;
+
+class EspClass {
+public:
+    uint32_t getFreeHeap();
+    uint32_t getMinFreeHeap();
+    uint32_t getHeapSize();
+    uint32_t getFreePsram();
+    void restart();
+};
+
+extern EspClass ESP;
+
+#endif
@@ -0,0 +1,214 @@
+#include "FS.h"
+#include <cstdio>
+#include <dirent.h>
+#include <fstream>
+#include <sstream>
+#include <sys/stat.h>
+
+namespace fs {
+
+struct File::Impl {
+    FS* owner;
+    std::string path;
+    std::string data;
+    size_t position;
+    bool writable;
+    bool open;
+};
+
+size_t File::size() const {
+    return impl ? impl->data.size() : 0;
+}
+
+size_t File::position() const {
+    return impl ? impl->position : 0;
+}
+
+bool File::seek(size_t pos) {
+    if (!impl || pos > impl->data.size()) return false;
+    impl->position = pos;
+    return true;
+}
+
+void File::close() {
+    if (!impl || !impl->open) return;
+
+    if (impl->writable) {
+        impl->owner->commit(impl->path, impl->data);
+    }
+    impl->open = false;
+}
+
+const char* File::name() const {
+    return impl ? impl->path.c_str() : "";
+}
+
+int File::available() {
+    return impl ? static_cast<int>(impl->data.size() - impl->position) : 0;
+}
+
+int File::read() {
+    if (!impl || impl->position >= impl->data.size()) return -1;
+    return static_cast<uint8_t>(impl->data[impl->position++]);
+}
+
+int File::peek() {
+    if (!impl || impl->position >= impl->data.size()) return -1;
+    return static_cast<uint8_t>(impl->data[impl->position]);
+}
+
+size_t File::read(uint8_t* buffer, size_t length) {
+    if (!impl) return 0;
+    size_t count = std::min(length, impl->data.size() - impl->position);
+    memcpy(buffer, impl->data.data() + impl->position, count);
+    impl->position += count;
+    return count;
+}
+
+size_t File::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t File::write(const uint8_t* buffer, size_t size) {
+    if (!impl || !impl->writable) return 0;
+    impl->data.replace(impl->position, std::min(size, impl->data.size() - impl->position),
+                       reinterpret_cast<const char*>(buffer), size);
+    impl->position += size;
+    return size;
+}
+
+void File::flush() {
+    if (impl && impl->writable) {
+        impl->owner->commit(impl->path, impl->data);
+    }
+}
+
+File FS::open(const char* path, const char* mode) {
+    File file;
+    if (!path || !mode) return file;
+
+    bool writing = mode[0] == 'w' || mode[0] == 'a';
+    auto it = files.find(path);
+    if (!writing && it == files.end()) {
+        return file;
+    }
+
+    file.impl = std::make_shared<File::Impl>();
+    file.impl->owner = this;
+    file.impl->path = path;
+    file.impl->writable = writing;
+    file.impl->open = true;
+    file.impl->data = (mode[0] == 'w' || it == files.end()) ? std::string() : it->second;
+    file.impl->position = mode[0] == 'a' ? file.impl->data.size() : 0;
+    return file;
+}
+
+bool FS::exists(const char* path) const {
+    return path && files.find(path) != files.end();
+}
+
+bool FS::remove(const char* path) {
+    if (!path || files.erase(path) == 0) return false;
+    if (!hostDirectory.empty()) {
+        ::remove((hostDirectory + path).c_str());
+    }
+    return true;
+}
+
+bool FS::rename(const char* from, const char* to) {
+    auto it = files.find(from);
+    if (it == files.end()) return false;
+    files[to] = it->second;
+    files.erase(from);
+    if (!hostDirectory.empty()) {
+        mirrorWrite(to, files[to]);
+        ::remove((hostDirectory + from).c_str());
+    }
+    return true;
+}
+
+bool FS::readFile(const char* path, std::string& contents) const {
+    auto it = files.find(path);
+    if (it == files.end()) return false;
+    contents = it->second;
+    return true;
+}
+
+size_t FS::usedBytes() const {
+    size_t total = 0;
+    for (const auto& file : files) {
+        total += file.second.size();
+    }
+    return total;
+}
+
+void FS::commit(const std::string& path, const std::string& contents) {
+    files[path] = contents;
+    if (!hostDirectory.empty()) {
+        mirrorWrite(path, contents);
+    }
+}
+
+bool FS::mountDirectory(const char* directory) {
+    struct stat info;
+    if (!directory || stat(directory, &info) != 0 || !S_ISDIR(info.st_mode)) {
+        return false;
+    }
+
+    hostDirectory = directory;
+    while (hostDirectory.size() > 1 && hostDirectory.back() == '/') {
+        hostDirectory.pop_back();
+    }
+    loadDirectory(hostDirectory, "");
+    return true;
+}
+
+void FS::loadDirectory(const std::string& directory, const std::string& prefix) {
+    DIR* dir = opendir(directory.c_str());
+    if (!dir) return;
+
+    while (struct dirent* entry = readdir(dir)) {
+        std::string name = entry->d_name;
+        if (name == "." || name == "..") continue;
+
+        std::string hostPath = directory + "/" + name;
+        struct stat info;
+        if (stat(hostPath.c_str(), &info) != 0) continue;
+
+        if (S_ISDIR(info.st_mode)) {
+            loadDirectory(hostPath, prefix + "/" + name);
+        } else if (S_ISREG(info.st_mode)) {
+            std::ifstream file(hostPath, std::ios::binary);
+            std::ostringstream contents;
+            contents << file.rdbuf();
+            files[prefix + "/" + name] = contents.str();
+        }
+    }
+    closedir(dir);
+}
+
+bool FS::exportDirectory(const char* directory) const {
+    if (!directory) return false;
+    for (const auto& file : files) {
+        if (!writeHostFile(directory, file.first, file.second)) return false;
+    }
+    return true;
+}
+
+void FS::mirrorWrite(const std::string& path, const std::string& contents) const {
+    writeHostFile(hostDirectory, path, contents);
+}
+
+bool FS::writeHostFile(const std::string& directory, const std::string& path, const std::string& contents) {
+    // SPIFFS has no directories; create whatever the path implies on the host
+    std::string hostPath = directory + path;
+    for (size_t slash = directory.size() + 1; (slash = hostPath.find('/', slash)) != std::string::npos; slash++) {
+        ::mkdir(hostPath.substr(0, slash).c_str(), 0755);
+    }
+
+    std::ofstream file(hostPath, std::ios::binary | std::ios::trunc);
+    file.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+    return static_cast<bool>(file);
+}
+
+} // namespace fs
@@ -0,0 +1,87 @@
+#ifndef MOCK_FS_H
+#define MOCK_FS_H
+
+#include "Arduino.h"
+#include <map>
+#include <memory>
+#include <string>
+
+namespace fs {
+
+/**
+ * Open file handle. Reads work on a snapshot of the contents; writes are
+ * buffered and committed to the owning filesystem on close().
+ */
+class File : public Stream {
+public:
+    File() {}
+
+    explicit operator bool() const { return impl != nullptr; }
+
+    size_t size() const;
+    size_t position() const;
+    bool seek(size_t pos);
+    void close();
+    const char* name() const;
+
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t read(uint8_t* buffer, size_t length);
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+    void flush() override;
+
+private:
+    friend class FS;
+
+    struct Impl;
+    std::shared_ptr<Impl> impl;
+};
+
+/**
+ * Filesystem whose files live in memory, keyed by absolute path.
+ * mountDirectory() preloads a host directory and mirrors every later
+ * write, remove and rename back to it.
+ */
+class FS {
+public:
+    virtual ~FS() {}
+
+    File open(const char* path, const char* mode = "r");
+    File open(const String& path, const char* mode = "r") { return open(path.c_str(), mode); }
+    bool exists(const char* path) const;
+    bool exists(const String& path) const { return exists(path.c_str()); }
+    bool remove(const char* path);
+    bool remove(const String& path) { return remove(path.c_str()); }
+    bool rename(const char* from, const char* to);
+    // Directories are implied by paths here; the host mirror creates them on write
+    bool mkdir(const char* path) { (void)path; return true; }
+
+    // Host helpers
+    void writeFile(const char* path, const std::string& contents) { files[path] = contents; }
+    bool readFile(const char* path, std::string& contents) const;
+    void clearFiles() { files.clear(); }
+    size_t usedBytes() const;
+    bool mountDirectory(const char* directory);
+    void unmountDirectory() { hostDirectory.clear(); }
+    bool exportDirectory(const char* directory) const;
+
+protected:
+    friend class File;
+    std::map<std::string, std::string> files;
+    std::string hostDirectory;
+
+    virtual void commit(const std::string& path, const std::string& contents);
+    void loadDirectory(const std::string& directory, const std::string& prefix);
+    void mirrorWrite(const std::string& path, const std::string& contents) const;
+    static bool writeHostFile(const std::string& directory, const std::string& path, const std::string& contents);
+};
+
+} // namespace fs
+
+using fs::File;
+using fs::FS;
+
+#endif
@@ -0,0 +1,121 @@
+#include "FrameWriter.h"
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+bool FrameWriter::write(const char* path, const uint8_t* pixels, int width, int height, Format format) {
+    return format == Format::PNG ? writePng(path, pixels, width, height)
+                                 : writePgm(path, pixels, width, height);
+}
+
+bool FrameWriter::writePgm(const char* path, const uint8_t* pixels, int width, int height) {
+    FILE* file = fopen(path, "wb");
+    if (!file) return false;
+
+    fprintf(file, "P5\n%d %d\n255\n", width, height);
+    size_t count = static_cast<size_t>(width) * height;
+    bool ok = fwrite(pixels, 1, count, file) == count;
+    return fclose(file) == 0 && ok;
+}
+
+uint32_t FrameWriter::crc32(const uint8_t* data, size_t length, uint32_t crc) {
+    static uint32_t table[256];
+    static bool tableReady = false;
+    if (!tableReady) {
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            table[n] = c;
+        }
+        tableReady = true;
+    }
+
+    crc ^= 0xFFFFFFFFu;
+    for (size_t i = 0; i < length; i++) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+uint32_t FrameWriter::adler32(const uint8_t* data, size_t length, uint32_t adler) {
+    uint32_t a = adler & 0xFFFF;
+    uint32_t b = adler >> 16;
+    for (size_t i = 0; i < length; i++) {
+        a = (a + data[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    return (b << 16) | a;
+}
+
+static void appendU32(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back(static_cast<uint8_t>(value >> 24));
+    out.push_back(static_cast<uint8_t>(value >> 16));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+static void appendChunk(std::vector<uint8_t>& out, const char* type, const std::vector<uint8_t>& data) {
+    appendU32(out, static_cast<uint32_t>(data.size()));
+    size_t typeStart = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data.begin(), data.end());
+    appendU32(out, FrameWriter::crc32(&out[typeStart], out.size() - typeStart));
+}
+
+bool FrameWriter::writePng(const char* path, const uint8_t* pixels, int width, int height) {
+    std::vector<uint8_t> png;
+    encodePng(pixels, width, height, png);
+
+    FILE* file = fopen(path, "wb");
+    if (!file) return false;
+    bool ok = fwrite(png.data(), 1, png.size(), file) == png.size();
+    return fclose(file) == 0 && ok;
+}
+
+void FrameWriter::encodePng(const uint8_t* pixels, int width, int height, std::vector<uint8_t>& png) {
+    // Raw scanlines, each prefixed with filter type 0
+    std::vector<uint8_t> raw;
+    raw.reserve(static_cast<size_t>(width + 1) * height);
+    for (int y = 0; y < height; y++) {
+        raw.push_back(0);
+        const uint8_t* row = pixels + static_cast<size_t>(y) * width;
+        raw.insert(raw.end(), row, row + width);
+    }
+
+    // zlib stream made of stored deflate blocks (max 65535 bytes each)
+    std::vector<uint8_t> zlib;
+    zlib.reserve(raw.size() + raw.size() / 65535 * 5 + 16);
+    zlib.push_back(0x78);
+    zlib.push_back(0x01);
+    size_t offset = 0;
+    do {
+        size_t blockSize = std::min<size_t>(65535, raw.size() - offset);
+        bool last = offset + blockSize == raw.size();
+        zlib.push_back(last ? 1 : 0);
+        zlib.push_back(static_cast<uint8_t>(blockSize));
+        zlib.push_back(static_cast<uint8_t>(blockSize >> 8));
+        zlib.push_back(static_cast<uint8_t>(~blockSize));
+        zlib.push_back(static_cast<uint8_t>(~blockSize >> 8));
+        zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + blockSize);
+        offset += blockSize;
+    } while (offset < raw.size());
+    appendU32(zlib, adler32(raw.data(), raw.size()));
+
+    std::vector<uint8_t> header;
+    appendU32(header, static_cast<uint32_t>(width));
+    appendU32(header, static_cast<uint32_t>(height));
+    header.push_back(8);  // Bit depth
+    header.push_back(0);  // Grayscale
+    header.push_back(0);  // Deflate
+    header.push_back(0);  // Adaptive filtering
+    header.push_back(0);  // No interlace
+
+    static const uint8_t signature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    png.assign(signature, signature + sizeof(signature));
+    appendChunk(png, "IHDR", header);
+    appendChunk(png, "IDAT", zlib);
+    appendChunk(png, "IEND", std::vector<uint8_t>());
+}
@@ -0,0 +1,30 @@
+#ifndef FRAME_WRITER_H
+#define FRAME_WRITER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Writes 8-bit grayscale frames to disk for inspection.
+ *
+ * PGM is the simplest format to diff and script against; PNG is written with
+ * stored (uncompressed) deflate blocks so it needs no zlib dependency.
+ */
+class FrameWriter {
+public:
+    enum class Format {
+        PGM,
+        PNG
+    };
+
+    static bool write(const char* path, const uint8_t* pixels, int width, int height, Format format);
+    static bool writePgm(const char* path, const uint8_t* pixels, int width, int height);
+    static bool writePng(const char* path, const uint8_t* pixels, int width, int height);
+    static void encodePng(const uint8_t* pixels, int width, int height, std::vector<uint8_t>& png);
+
+    static uint32_t crc32(const uint8_t* data, size_t length, uint32_t crc = 0);
+    static uint32_t adler32(const uint8_t* data, size_t length, uint32_t adler = 1);
+};
+
+#endif
@@ -0,0 +1,122 @@
+#include "HTTPClient.h"
+#include "HostClock.h"
+#include <algorithm>
+
+HostTransport* HTTPClient::transport = nullptr;
+uint32_t HTTPClient::requestCount = 0;
+uint32_t HTTPClient::clientCount = 0;
+
+/**
+ * Read-only stream over an in-memory response body
+ */
+class ResponseStream : public Stream {
+public:
+    void reset(const String& body) { data = body; position = 0; }
+
+    int available() override { return static_cast<int>(data.length() - position); }
+    int read() override { return position < data.length() ? static_cast<uint8_t>(data[position++]) : -1; }
+    int peek() override { return position < data.length() ? static_cast<uint8_t>(data[position]) : -1; }
+    size_t write(uint8_t) override { return 0; }
+
+private:
+    String data;
+    unsigned int position = 0;
+};
+
+static ResponseStream responseStream;
+
+bool HTTPClient::begin(const String& url) {
+    requestUrl = url;
+    requestHeaders = "";
+    responseBody = "";
+    responseHeaders = "";
+    responseSize = -1;
+    return true;
+}
+
+void HTTPClient::end() {
+    responseBody = "";
+}
+
+void HTTPClient::addHeader(const String& name, const String& value) {
+    requestHeaders += name + ": " + value + "\n";
+}
+
+void HTTPClient::collectHeaders(const char* headerKeys[], size_t count) {
+    (void)headerKeys;
+    (void)count;
+}
+
+int HTTPClient::GET() {
+    if (WiFi.status() != WL_CONNECTED) {
+        return HTTPC_ERROR_NOT_CONNECTED;
+    }
+
+    HostRequest request;
+    if (!transport || !HostTransport::parseUrl(requestUrl.c_str(), request)) {
+        return HTTPC_ERROR_CONNECTION_REFUSED;
+    }
+    request.method = "GET";
+    request.headers = requestHeaders.c_str();
+    request.client = clientId;
+    request.keepAlive = reuseConnection;
+    requestCount++;
+
+    HostResponse response = transport->handle(request);
+    HostClock::advanceMillis(std::min<uint32_t>(response.latencyMs, timeout));
+    if (response.latencyMs > timeout) {
+        return HTTPC_ERROR_READ_TIMEOUT;
+    }
+
+    responseBody = String(response.body);
+    responseHeaders = String(response.headers);
+    responseSize = response.status > 0 && response.sendLength ? static_cast<int>(response.body.size()) : -1;
+    return response.status;
+}
+
+Stream& HTTPClient::getStream() {
+    responseStream.reset(responseBody);
+    return responseStream;
+}
+
+String HTTPClient::header(const char* name) const {
+    String key = String(name);
+    key.toLowerCase();
+
+    int start = 0;
+    while (start < static_cast<int>(responseHeaders.length())) {
+        int end = responseHeaders.indexOf('\n', start);
+        if (end < 0) end = responseHeaders.length();
+
+        String line = responseHeaders.substring(start, end);
+        int colon = line.indexOf(':');
+        if (colon > 0) {
+            String lineKey = line.substring(0, colon);
+            lineKey.toLowerCase();
+            if (lineKey == key) {
+                String value = line.substring(colon + 1);
+                value.trim();
+                return value;
+            }
+        }
+        start = end + 1;
+    }
+    return String();
+}
+
+String HTTPClient::errorToString(int error) {
+    switch (error) {
+        case HTTPC_ERROR_CONNECTION_REFUSED: return "connection refused";
+        case HTTPC_ERROR_SEND_HEADER_FAILED: return "send header failed";
+        case HTTPC_ERROR_SEND_PAYLOAD_FAILED: return "send payload failed";
+        case HTTPC_ERROR_NOT_CONNECTED: return "not connected";
+        case HTTPC_ERROR_CONNECTION_LOST: return "connection lost";
+        case HTTPC_ERROR_NO_STREAM: return "no stream";
+        case HTTPC_ERROR_NO_HTTP_SERVER: return "no HTTP server";
+        case HTTPC_ERROR_TOO_LESS_RAM: return "too less ram";
+        case HTTPC_ERROR_ENCODING: return "Transfer-Encoding not supported";
+        case HTTPC_ERROR_STREAM_WRITE: return "Stream write error";
+        case HTTPC_ERROR_READ_TIMEOUT: return "read Timeout";
+        default: return String();
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef MOCK_HTTPCLIENT_H
+#define MOCK_HTTPCLIENT_H
+
+#include "Arduino.h"
+#include "WiFi.h"
+#include "HostTransport.h"
+
+#define HTTPC_ERROR_CONNECTION_REFUSED  (-1)
+#define HTTPC_ERROR_SEND_HEADER_FAILED  (-2)
+#define HTTPC_ERROR_SEND_PAYLOAD_FAILED (-3)
+#define HTTPC_ERROR_NOT_CONNECTED       (-4)
+#define HTTPC_ERROR_CONNECTION_LOST     (-5)
+#define HTTPC_ERROR_NO_STREAM           (-6)
+#define HTTPC_ERROR_NO_HTTP_SERVER      (-7)
+#define HTTPC_ERROR_TOO_LESS_RAM        (-8)
+#define HTTPC_ERROR_ENCODING            (-9)
+#define HTTPC_ERROR_STREAM_WRITE        (-10)
+#define HTTPC_ERROR_READ_TIMEOUT        (-11)
+
+typedef enum {
+    HTTP_CODE_OK = 200,
+    HTTP_CODE_NOT_MODIFIED = 304,
+    HTTP_CODE_BAD_REQUEST = 400,
+    HTTP_CODE_NOT_FOUND = 404,
+    HTTP_CODE_INTERNAL_SERVER_ERROR = 500,
+    HTTP_CODE_SERVICE_UNAVAILABLE = 503
+} t_http_codes;
+
+/**
+ * Host HTTP client. Requests go to the installed HostTransport, whose
+ * latency is charged to HostClock. Without one every request fails with
+ * HTTPC_ERROR_CONNECTION_REFUSED, like a device with no route to the server.
+ */
+class HTTPClient {
+public:
+    HTTPClient() : clientId(++clientCount) {}
+    ~HTTPClient() { end(); }
+
+    bool begin(const String& url);
+    void end();
+
+    void setTimeout(uint16_t timeoutMs) { timeout = timeoutMs; }
+    void setReuse(bool reuse) { reuseConnection = reuse; }
+    // Host responses are never chunked (HostResponse::sendLength drops the length)
+    void useHTTP10(bool enabled) { (void)enabled; }
+    void addHeader(const String& name, const String& value);
+    void collectHeaders(const char* headerKeys[], size_t count);
+
+    int GET();
+    int getSize() const { return responseSize; }
+    String getString() { return responseBody; }
+    Stream& getStream();
+    String header(const char* name) const;
+
+    static String errorToString(int error);
+
+    // Host controls
+    static void setTransport(HostTransport* backend) { transport = backend; }
+    static HostTransport* getTransport() { return transport; }
+    static uint32_t getRequestCount() { return requestCount; }
+
+private:
+    String requestUrl;
+    String requestHeaders;
+    String responseBody;
+    String responseHeaders;
+    int responseSize = -1;
+    uint16_t timeout = 5000;
+    bool reuseConnection = true;
+    uint32_t clientId;
+
+    static HostTransport* transport;
+    static uint32_t requestCount;
+    static uint32_t clientCount;
+};
+
+#endif
@@ -0,0 +1,65 @@
+#include "HostClock.h"
+#include <chrono>
+
+bool HostClock::virtualMode = false;
+uint64_t HostClock::offsetMicros = 0;
+uint64_t HostClock::bootEpochMicros = 1704067200ULL * 1000000ULL;  // 2024-01-01 00:00 UTC
+bool HostClock::wallClockSynced = false;
+bool HostClock::syncPending = false;
+uint64_t HostClock::pendingSyncMicros = 0;
+uint64_t HostClock::pendingEpochMicros = 0;
+HostClock::SntpHandler HostClock::sntpHandler = nullptr;
+
+static uint64_t monotonicMicros() {
+    static const auto start = std::chrono::steady_clock::now();
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count());
+}
+
+uint64_t HostClock::micros() {
+    return virtualMode ? offsetMicros : monotonicMicros() + offsetMicros;
+}
+
+void HostClock::advanceMicros(uint64_t us) {
+    offsetMicros += us;
+}
+
+void HostClock::setVirtual(bool enabled) {
+    if (enabled == virtualMode) return;
+
+    // Keep time continuous across the switch
+    uint64_t now = micros();
+    virtualMode = enabled;
+    if (enabled) {
+        offsetMicros = now;
+    } else {
+        uint64_t mono = monotonicMicros();
+        offsetMicros = now > mono ? now - mono : 0;
+    }
+}
+
+void HostClock::setMicros(uint64_t us) {
+    if (virtualMode) {
+        offsetMicros = us;
+    }
+}
+
+void HostClock::setWallClockSynced(bool synced) {
+    wallClockSynced = synced;
+    syncPending = false;
+}
+
+bool HostClock::isWallClockSynced() {
+    if (syncPending && micros() >= pendingSyncMicros) {
+        bootEpochMicros = pendingEpochMicros - pendingSyncMicros;
+        wallClockSynced = true;
+        syncPending = false;
+    }
+    return wallClockSynced;
+}
+
+void HostClock::scheduleWallClockSync(uint64_t atMicros, uint64_t epochUs) {
+    syncPending = true;
+    pendingSyncMicros = atMicros;
+    pendingEpochMicros = epochUs;
+}
@@ -0,0 +1,55 @@
+#ifndef HOST_CLOCK_H
+#define HOST_CLOCK_H
+
+#include <cstdint>
+
+/**
+ * Time source behind millis()/micros()/delay() on the host.
+ *
+ * Real mode follows the monotonic clock, but delay() does not block: it moves
+ * the clock forward instead, so firmware code that waits for hardware runs at
+ * full speed. Virtual mode ignores wall time entirely and only advances when
+ * told to, which makes runs deterministic.
+ */
+class HostClock {
+public:
+    static uint64_t micros();
+    static void advanceMicros(uint64_t us);
+    static void advanceMillis(uint64_t ms) { advanceMicros(ms * 1000ULL); }
+
+    static void setVirtual(bool enabled);
+    static bool isVirtual() { return virtualMode; }
+
+    // Virtual mode only: jump to an absolute time since boot
+    static void setMicros(uint64_t us);
+
+    // Wall clock: Unix time at boot plus time since boot. time() reports it
+    // once SNTP has "synced" (configTime() with WiFi up); the RTC keeps it
+    // valid across deep sleep, as on the device.
+    static void setBootEpochMicros(uint64_t epochUs) { bootEpochMicros = epochUs; }
+    static uint64_t getBootEpochMicros() { return bootEpochMicros; }
+    static uint64_t epochMicros() { return bootEpochMicros + micros(); }
+    static void setWallClockSynced(bool synced);
+    static bool isWallClockSynced();
+
+    // SNTP answer for configTime(): false if no server answers, otherwise
+    // the delay before it arrives and the Unix time it carries. Without a
+    // handler the clock syncs at once to the boot epoch.
+    typedef bool (*SntpHandler)(uint32_t& delayMs, uint64_t& epochUs);
+    static void setSntpHandler(SntpHandler handler) { sntpHandler = handler; }
+    static SntpHandler getSntpHandler() { return sntpHandler; }
+    // Set the wall clock to epochUs once micros() reaches atMicros
+    static void scheduleWallClockSync(uint64_t atMicros, uint64_t epochUs);
+
+private:
+    static bool virtualMode;
+    static uint64_t offsetMicros;
+    static uint64_t bootEpochMicros;
+    static bool wallClockSynced;
+    static bool syncPending;
+    static uint64_t pendingSyncMicros;
+    static uint64_t pendingEpochMicros;
+    static SntpHandler sntpHandler;
+};
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef HOST_FLASH_H
+#define HOST_FLASH_H
+
+#include "esp_ota_ops.h"
+#include "esp_partition.h"
+
+/**
+ * Host side of the ESP32 partition APIs.
+ *
+ * A data partition attached here is backed by a file. esp_partition_mmap()
+ * maps that file read-only with mmap(), so firmware that reads assets in
+ * place from flash reads them in place from the page cache on the host,
+ * with the same zero-copy pointers and the same unmap discipline.
+ *
+ * The running app's description (esp_ota_get_app_description) has an ELF
+ * hash of all zeros until a test gives it another, as a new build would.
+ */
+class HostFlash {
+public:
+    // False if the file does not exist or the label is too long
+    static bool attach(const char* label, const char* path);
+    static void detachAll();
+    static void setAppElfSha256(const uint8_t sha256[32]);
+
+    // Mappings currently open (made public for testing)
+    static int getMappedCount();
+};
+
+#endif
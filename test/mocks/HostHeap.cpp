@@ -0,0 +1,328 @@
+#include "HostHeap.h"
+#include <malloc.h>
+#include <cstring>
+#include <sys/mman.h>
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void __libc_free(void* ptr);
+}
+
+static HostHeap::Counters counters = {0, 0, 0, 0, 0, 0};
+
+/**
+ * Device heap model. Its tables live in mmap'd memory so placing a block
+ * never calls back into malloc.
+ */
+namespace {
+
+const uint32_t ALIGNMENT = 4;
+const uint32_t BLOCK_OVERHEAD = 8;            // Block header in the device allocator
+const size_t ALWAYS_INTERNAL_LIMIT = 16384;   // CONFIG_SPIRAM_MALLOC_ALWAYSINTERNAL
+const size_t MAX_FREE_RANGES = 32768;
+const size_t BLOCK_TABLE_SIZE = 1 << 18;      // Live blocks tracked at once (power of two)
+
+struct FreeRange {
+    uint32_t offset;
+    uint32_t size;
+};
+
+struct ModelHeap {
+    uint32_t capacity;
+    FreeRange* ranges;                        // Sorted by offset, never adjacent
+    size_t rangeCount;
+    size_t freeBytes;
+    size_t minimumFree;
+};
+
+struct PlacedBlock {
+    void* ptr;                                // nullptr: empty slot
+    uint32_t offset;
+    uint32_t size : 31;
+    uint32_t psram : 1;
+};
+
+bool modelEnabled = false;
+ModelHeap internalModel = {0, nullptr, 0, 0, 0};
+ModelHeap psramModel = {0, nullptr, 0, 0, 0};
+PlacedBlock* blocks = nullptr;
+size_t placedBlocks = 0;
+uint64_t failures = 0;
+HostHeap::Region nextRegion = HostHeap::Region::DEFAULT;
+
+void* mapZeroed(size_t bytes) {
+    void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return memory == MAP_FAILED ? nullptr : memory;
+}
+
+void resetModelHeap(ModelHeap& heap, size_t capacity) {
+    heap.capacity = static_cast<uint32_t>(capacity);
+    heap.ranges[0].offset = 0;
+    heap.ranges[0].size = heap.capacity;
+    heap.rangeCount = 1;
+    heap.freeBytes = capacity;
+    heap.minimumFree = capacity;
+}
+
+// Best fit; returns false if no free range is large enough
+bool placeIn(ModelHeap& heap, uint32_t size, uint32_t& offset) {
+    size_t best = heap.rangeCount;
+    for (size_t i = 0; i < heap.rangeCount; i++) {
+        if (heap.ranges[i].size >= size && (best == heap.rangeCount || heap.ranges[i].size < heap.ranges[best].size)) {
+            best = i;
+            if (heap.ranges[i].size == size) break;
+        }
+    }
+    if (best == heap.rangeCount) return false;
+
+    FreeRange& range = heap.ranges[best];
+    offset = range.offset;
+    if (range.size == size) {
+        memmove(&heap.ranges[best], &heap.ranges[best + 1], (heap.rangeCount - best - 1) * sizeof(FreeRange));
+        heap.rangeCount--;
+    } else {
+        range.offset += size;
+        range.size -= size;
+    }
+
+    heap.freeBytes -= size;
+    if (heap.freeBytes < heap.minimumFree) heap.minimumFree = heap.freeBytes;
+    return true;
+}
+
+void releaseIn(ModelHeap& heap, uint32_t offset, uint32_t size) {
+    // First range after the released block
+    size_t low = 0;
+    size_t high = heap.rangeCount;
+    while (low < high) {
+        size_t middle = (low + high) / 2;
+        if (heap.ranges[middle].offset < offset) low = middle + 1;
+        else high = middle;
+    }
+
+    bool joinsPrevious = low > 0 && heap.ranges[low - 1].offset + heap.ranges[low - 1].size == offset;
+    bool joinsNext = low < heap.rangeCount && offset + size == heap.ranges[low].offset;
+
+    if (joinsPrevious && joinsNext) {
+        heap.ranges[low - 1].size += size + heap.ranges[low].size;
+        memmove(&heap.ranges[low], &heap.ranges[low + 1], (heap.rangeCount - low - 1) * sizeof(FreeRange));
+        heap.rangeCount--;
+    } else if (joinsPrevious) {
+        heap.ranges[low - 1].size += size;
+    } else if (joinsNext) {
+        heap.ranges[low].offset = offset;
+        heap.ranges[low].size += size;
+    } else if (heap.rangeCount < MAX_FREE_RANGES) {
+        memmove(&heap.ranges[low + 1], &heap.ranges[low], (heap.rangeCount - low) * sizeof(FreeRange));
+        heap.ranges[low].offset = offset;
+        heap.ranges[low].size = size;
+        heap.rangeCount++;
+    } else {
+        return;  // Range table full: the block stays lost, like a leak
+    }
+    heap.freeBytes += size;
+}
+
+size_t slotFor(const void* ptr) {
+    uint64_t hash = (reinterpret_cast<uintptr_t>(ptr) >> 4) * 0x9E3779B97F4A7C15ULL;
+    return static_cast<size_t>(hash >> 40) & (BLOCK_TABLE_SIZE - 1);
+}
+
+void modelAllocate(void* ptr, size_t requested, HostHeap::Region region) {
+    // Keep the table at most half full so probes stay short
+    if (requested >= (1u << 30) || placedBlocks >= BLOCK_TABLE_SIZE / 2) {
+        failures++;
+        return;
+    }
+
+    uint32_t size = static_cast<uint32_t>((requested + BLOCK_OVERHEAD + ALIGNMENT - 1) & ~(ALIGNMENT - 1));
+    uint32_t offset = 0;
+    bool psram = false;
+    switch (region) {
+        case HostHeap::Region::INTERNAL:
+            if (!placeIn(internalModel, size, offset)) {
+                failures++;
+                return;
+            }
+            break;
+        case HostHeap::Region::PSRAM:
+            if (!placeIn(psramModel, size, offset)) {
+                failures++;
+                return;
+            }
+            psram = true;
+            break;
+        case HostHeap::Region::DEFAULT:
+            if (requested <= ALWAYS_INTERNAL_LIMIT) {
+                if (!placeIn(internalModel, size, offset)) {
+                    psram = true;
+                    if (!placeIn(psramModel, size, offset)) {
+                        failures++;
+                        return;
+                    }
+                }
+            } else if (placeIn(psramModel, size, offset)) {
+                psram = true;
+            } else if (!placeIn(internalModel, size, offset)) {
+                failures++;
+                return;
+            }
+            break;
+    }
+
+    size_t slot = slotFor(ptr);
+    while (blocks[slot].ptr) slot = (slot + 1) & (BLOCK_TABLE_SIZE - 1);
+    blocks[slot].ptr = ptr;
+    blocks[slot].offset = offset;
+    blocks[slot].size = size;
+    blocks[slot].psram = psram ? 1 : 0;
+    placedBlocks++;
+}
+
+void modelFree(void* ptr) {
+    size_t slot = slotFor(ptr);
+    while (blocks[slot].ptr && blocks[slot].ptr != ptr) slot = (slot + 1) & (BLOCK_TABLE_SIZE - 1);
+    if (!blocks[slot].ptr) return;  // Allocated before the model was enabled
+
+    releaseIn(blocks[slot].psram ? psramModel : internalModel, blocks[slot].offset, blocks[slot].size);
+    placedBlocks--;
+
+    // Backward-shift deletion keeps probe chains intact without tombstones
+    size_t hole = slot;
+    size_t next = (hole + 1) & (BLOCK_TABLE_SIZE - 1);
+    while (blocks[next].ptr) {
+        size_t home = slotFor(blocks[next].ptr);
+        bool movable = hole <= next ? (home <= hole || home > next) : (home <= hole && home > next);
+        if (movable) {
+            blocks[hole] = blocks[next];
+            hole = next;
+        }
+        next = (next + 1) & (BLOCK_TABLE_SIZE - 1);
+    }
+    blocks[hole].ptr = nullptr;
+}
+
+}  // namespace
+
+static void recordAlloc(void* ptr, size_t requested) {
+    HostHeap::Region region = nextRegion;
+    nextRegion = HostHeap::Region::DEFAULT;
+    if (!ptr) return;
+    size_t usable = malloc_usable_size(ptr);
+    counters.allocations++;
+    counters.bytesAllocated += requested;
+    counters.liveBytes += usable;
+    counters.liveBlocks++;
+    if (counters.liveBytes > counters.peakLiveBytes) {
+        counters.peakLiveBytes = counters.liveBytes;
+    }
+    if (modelEnabled) {
+        modelAllocate(ptr, requested, region);
+    }
+}
+
+static void recordFree(void* ptr) {
+    if (!ptr) return;
+    size_t usable = malloc_usable_size(ptr);
+    counters.frees++;
+    counters.liveBytes -= usable < counters.liveBytes ? usable : counters.liveBytes;
+    if (counters.liveBlocks > 0) counters.liveBlocks--;
+    if (modelEnabled) {
+        modelFree(ptr);
+    }
+}
+
+extern "C" {
+
+void* malloc(size_t size) {
+    void* ptr = __libc_malloc(size);
+    recordAlloc(ptr, size);
+    return ptr;
+}
+
+void* calloc(size_t count, size_t size) {
+    void* ptr = __libc_calloc(count, size);
+    recordAlloc(ptr, count * size);
+    return ptr;
+}
+
+void* realloc(void* ptr, size_t size) {
+    size_t oldUsable = ptr ? malloc_usable_size(ptr) : 0;
+    if (ptr && modelEnabled) {
+        modelFree(ptr);  // Before the host allocator can reuse the address
+    }
+    void* result = __libc_realloc(ptr, size);
+    if (!result && size > 0) {
+        if (ptr && modelEnabled) modelAllocate(ptr, oldUsable, HostHeap::Region::DEFAULT);
+        return nullptr;  // Original block untouched
+    }
+
+    if (ptr) {
+        counters.frees++;
+        counters.liveBytes -= oldUsable < counters.liveBytes ? oldUsable : counters.liveBytes;
+        if (counters.liveBlocks > 0) counters.liveBlocks--;
+    }
+    recordAlloc(result, size);
+    return result;
+}
+
+void free(void* ptr) {
+    recordFree(ptr);
+    __libc_free(ptr);
+}
+
+}
+
+HostHeap::Counters HostHeap::snapshot() {
+    return counters;
+}
+
+void HostHeap::resetPeak() {
+    counters.peakLiveBytes = counters.liveBytes;
+}
+
+bool HostHeap::enableDeviceModel(bool enabled) {
+    if (enabled && !blocks) {
+        blocks = static_cast<PlacedBlock*>(mapZeroed(BLOCK_TABLE_SIZE * sizeof(PlacedBlock)));
+        internalModel.ranges = static_cast<FreeRange*>(mapZeroed(MAX_FREE_RANGES * sizeof(FreeRange)));
+        psramModel.ranges = static_cast<FreeRange*>(mapZeroed(MAX_FREE_RANGES * sizeof(FreeRange)));
+        if (!blocks || !internalModel.ranges || !psramModel.ranges) return false;
+    }
+
+    if (enabled) {
+        memset(blocks, 0, BLOCK_TABLE_SIZE * sizeof(PlacedBlock));
+        placedBlocks = 0;
+        failures = 0;
+        resetModelHeap(internalModel, internalCapacity());
+        resetModelHeap(psramModel, psramCapacity());
+    }
+    modelEnabled = enabled;
+    return true;
+}
+
+bool HostHeap::isDeviceModelEnabled() {
+    return modelEnabled;
+}
+
+HostHeap::DeviceHeap HostHeap::deviceHeap(Region region) {
+    const ModelHeap& heap = region == Region::PSRAM ? psramModel : internalModel;
+    DeviceHeap result = {heap.freeBytes, 0, heap.minimumFree, heap.rangeCount};
+    for (size_t i = 0; i < heap.rangeCount; i++) {
+        if (heap.ranges[i].size > result.largestFreeBlock) {
+            result.largestFreeBlock = heap.ranges[i].size;
+        }
+    }
+    // Usable payload of the largest block
+    result.largestFreeBlock = result.largestFreeBlock > BLOCK_OVERHEAD ? result.largestFreeBlock - BLOCK_OVERHEAD : 0;
+    return result;
+}
+
+uint64_t HostHeap::deviceAllocationFailures() {
+    return failures;
+}
+
+void HostHeap::placeNextAllocation(Region region) {
+    nextRegion = region;
+}
@@ -0,0 +1,66 @@
+#ifndef HOST_HEAP_H
+#define HOST_HEAP_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Heap accounting for host builds.
+ *
+ * HostHeap.cpp interposes malloc/calloc/realloc/free (glibc) so every
+ * allocation made by the firmware, ArduinoJson or the C++ runtime is counted.
+ * The esp_heap_caps mock reports these numbers, so MemoryTracker behaves on
+ * the host as it does on the device.
+ *
+ * The host allocator never fragments the way a 320KB device heap does, so an
+ * optional device model replays every allocation onto address-space models
+ * of internal RAM and PSRAM. It places blocks best-fit (close to the TLSF
+ * allocator in ESP-IDF) and routes them like heap_caps_malloc_default():
+ * requests up to 16KB prefer internal RAM, larger ones prefer PSRAM, and
+ * each falls back to the other heap. With the model enabled the largest free
+ * block reported to the firmware shrinks as the heap fragments, and requests
+ * neither heap could satisfy are counted as failures (the host still serves
+ * them). Blocks allocated before the model was enabled are not placed.
+ */
+class HostHeap {
+public:
+    struct Counters {
+        uint64_t allocations;     // Cumulative malloc/calloc/realloc calls
+        uint64_t frees;
+        uint64_t bytesAllocated;  // Cumulative bytes requested
+        size_t liveBytes;         // Currently allocated (usable size)
+        size_t liveBlocks;
+        size_t peakLiveBytes;
+    };
+
+    static Counters snapshot();
+    static void resetPeak();
+
+    // Emulated device heap sizes used by heap_caps_get_free_size() and friends
+    static size_t internalCapacity() { return 320 * 1024; }
+    static size_t psramCapacity() { return 4 * 1024 * 1024; }
+
+    enum class Region {
+        DEFAULT,    // malloc(): placed by size, falls back to the other heap
+        INTERNAL,
+        PSRAM
+    };
+
+    struct DeviceHeap {
+        size_t freeBytes;
+        size_t largestFreeBlock;
+        size_t minimumFreeBytes;  // Low-water mark since the model was enabled
+        size_t freeRanges;        // Separate free ranges (1 = unfragmented)
+    };
+
+    // Device model; enabling starts from empty heaps
+    static bool enableDeviceModel(bool enabled);
+    static bool isDeviceModelEnabled();
+    static DeviceHeap deviceHeap(Region region);
+    static uint64_t deviceAllocationFailures();
+
+    // Region for the next allocation (heap_caps_malloc); applies to one call
+    static void placeNextAllocation(Region region);
+};
+
+#endif
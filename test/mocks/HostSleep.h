@@ -0,0 +1,57 @@
+#ifndef HOST_SLEEP_H
+#define HOST_SLEEP_H
+
+#include "esp_sleep.h"
+#include <cstddef>
+
+/**
+ * Host side of the ESP32 sleep APIs.
+ *
+ * Records the wake sources and power-domain options the firmware sets up,
+ * lets the host choose the wake cause reported after "boot", and exposes the
+ * RTC_DATA_ATTR section so a runner can carry it across wake cycles.
+ * esp_deep_sleep_start() calls the installed handler, which must not return;
+ * the default one ends the process.
+ */
+class HostSleep {
+public:
+    typedef void (*DeepSleepHandler)();
+
+    static void setWakeupCause(esp_sleep_wakeup_cause_t cause) { wakeupCause = cause; }
+    static esp_sleep_wakeup_cause_t getWakeupCause() { return wakeupCause; }
+
+    static bool isTimerWakeupEnabled() { return timerWakeupEnabled; }
+    static uint64_t getTimerWakeupUs() { return timerWakeupUs; }
+    static bool isExt0WakeupEnabled() { return ext0Pin >= 0; }
+    static int getExt0Pin() { return ext0Pin; }
+    static int getExt0Level() { return ext0Level; }
+    static esp_sleep_pd_option_t getPowerDomainOption(esp_sleep_pd_domain_t domain);
+
+    // True when RTC_DATA_ATTR contents survive the coming deep sleep
+    static bool rtcMemoryRetained();
+
+    static void setDeepSleepHandler(DeepSleepHandler handler) { deepSleepHandler = handler; }
+
+    // RTC_DATA_ATTR section (empty when the firmware has no RTC variables)
+    static uint8_t* rtcMemory();
+    static size_t rtcMemorySize();
+
+    // Forget wake sources and power-domain options (fresh boot)
+    static void reset();
+
+private:
+    friend esp_err_t esp_sleep_enable_timer_wakeup(uint64_t timeInUs);
+    friend esp_err_t esp_sleep_enable_ext0_wakeup(gpio_num_t gpioNum, int level);
+    friend esp_err_t esp_sleep_pd_config(esp_sleep_pd_domain_t domain, esp_sleep_pd_option_t option);
+    friend void esp_deep_sleep_start();
+
+    static esp_sleep_wakeup_cause_t wakeupCause;
+    static bool timerWakeupEnabled;
+    static uint64_t timerWakeupUs;
+    static int ext0Pin;
+    static int ext0Level;
+    static esp_sleep_pd_option_t powerDomains[ESP_PD_DOMAIN_MAX];
+    static DeepSleepHandler deepSleepHandler;
+};
+
+#endif
@@ -0,0 +1,344 @@
+#include "HostTransport.h"
+#include "HostClock.h"
+#include "HTTPClient.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+bool HostTransport::parseUrl(const std::string& url, HostRequest& request) {
+    size_t schemeEnd = url.find("://");
+    if (schemeEnd == std::string::npos) return false;
+
+    size_t hostStart = schemeEnd + 3;
+    size_t pathStart = url.find('/', hostStart);
+    size_t queryStart = url.find('?', hostStart);
+    size_t hostEnd = std::min(pathStart, queryStart);
+    if (hostEnd == std::string::npos) hostEnd = url.size();
+
+    request.url = url;
+    request.host = url.substr(hostStart, hostEnd - hostStart);
+    size_t port = request.host.find(':');
+    if (port != std::string::npos) {
+        request.host.erase(port);
+    }
+    if (request.host.empty()) return false;
+
+    if (queryStart != std::string::npos) {
+        request.query = url.substr(queryStart + 1);
+    } else {
+        request.query.clear();
+        queryStart = url.size();
+    }
+    request.path = hostEnd < queryStart ? url.substr(hostEnd, queryStart - hostEnd) : "/";
+    return true;
+}
+
+std::string HostTransport::queryParam(const std::string& query, const char* name, const std::string& fallback) {
+    std::string key = std::string(name) + "=";
+    size_t start = 0;
+    while (start < query.size()) {
+        size_t end = query.find('&', start);
+        if (end == std::string::npos) end = query.size();
+        if (query.compare(start, key.size(), key) == 0) {
+            return query.substr(start + key.size(), end - start - key.size());
+        }
+        start = end + 1;
+    }
+    return fallback;
+}
+
+std::string HostTransport::removeQueryParam(const std::string& url, const char* name) {
+    size_t queryStart = url.find('?');
+    if (queryStart == std::string::npos) return url;
+
+    std::string key = std::string(name) + "=";
+    std::string kept;
+    size_t start = queryStart + 1;
+    while (start <= url.size()) {
+        size_t end = url.find('&', start);
+        if (end == std::string::npos) end = url.size();
+        if (url.compare(start, key.size(), key) != 0) {
+            if (!kept.empty()) kept += '&';
+            kept.append(url, start, end - start);
+        }
+        start = end + 1;
+    }
+    return kept.empty() ? url.substr(0, queryStart) : url.substr(0, queryStart + 1) + kept;
+}
+
+static const char* contentTypeFor(const std::string& path) {
+    size_t dot = path.rfind('.');
+    std::string ext = dot == std::string::npos ? std::string() : path.substr(dot + 1);
+    if (ext == "json") return "application/json";
+    if (ext == "png") return "image/png";
+    if (ext == "jpg" || ext == "jpeg") return "image/jpeg";
+    if (ext == "bmp") return "image/bmp";
+    if (ext == "pgm") return "image/x-portable-graymap";
+    if (ext == "ics") return "text/calendar";
+    return "application/octet-stream";
+}
+
+HostResponse FixtureTransport::handle(const HostRequest& request) {
+    requestCount++;
+
+    HostResponse response;
+    response.latencyMs = latencyMs;
+
+    if (!root.empty()) {
+        std::string path = request.path == "/" ? "/index.html" : request.path;
+        std::ifstream file(root + "/" + request.host + path, std::ios::binary);
+        if (file) {
+            std::ostringstream contents;
+            contents << file.rdbuf();
+            response.status = 200;
+            response.body = contents.str();
+            response.headers = std::string("Content-Type: ") + contentTypeFor(path) + "\n";
+            return response;
+        }
+    }
+
+    if (syntheticWeather && request.host == "api.open-meteo.com") {
+        uint64_t us = HostClock::isWallClockSynced() ? HostClock::epochMicros() : HostClock::getBootEpochMicros();
+        response.status = 200;
+        response.body = syntheticForecast(us / 1000000ULL);
+        response.headers = "Content-Type: application/json\n";
+        return response;
+    }
+
+    response.status = 404;
+    response.body = "Not Found";
+    return response;
+}
+
+std::string FixtureTransport::syntheticForecast(uint64_t epochSeconds) {
+    // Daily temperature swing peaking mid-afternoon plus a slow multi-day drift
+    const double pi = 3.14159265358979;
+    auto temperatureAt = [pi](uint64_t seconds) {
+        double day = static_cast<double>(seconds) / 86400.0;
+        return 60.0 + 12.0 * std::sin(2.0 * pi * (day - 0.375)) + 6.0 * std::sin(2.0 * pi * day / 9.0);
+    };
+
+    // Conditions change every three hours, deterministically
+    static const int codes[] = {0, 1, 2, 3, 45, 61, 63, 80};
+    auto hashAt = [](uint64_t seconds) { return static_cast<uint32_t>(seconds / 10800ULL) * 2654435761u; };
+    auto codeAt = [&](uint64_t seconds) { return codes[(hashAt(seconds) >> 16) % (sizeof(codes) / sizeof(codes[0]))]; };
+    auto rainAt = [&](uint64_t seconds) {
+        uint32_t hash = hashAt(seconds);
+        return codeAt(seconds) >= 61 ? 60 + static_cast<int>((hash >> 8) % 40) : static_cast<int>((hash >> 8) % 20);
+    };
+    uint32_t hash = hashAt(epochSeconds);
+
+    char json[160];
+    snprintf(json, sizeof(json), "{\"current_weather\":{\"temperature\":%.1f,\"weathercode\":%d,\"windspeed\":%.1f},",
+             temperatureAt(epochSeconds), codeAt(epochSeconds), 5.0 + (hash % 150) / 10.0);
+    std::string body = json;
+
+    // Two days of hours from midnight UTC, in unixtime, as the widget asks for
+    uint64_t midnight = epochSeconds / 86400ULL * 86400ULL;
+    std::string times, temperatures, rain;
+    for (int hour = 0; hour < 48; hour++) {
+        uint64_t at = midnight + hour * 3600ULL;
+        const char* separator = hour ? "," : "";
+        snprintf(json, sizeof(json), "%s%llu", separator, static_cast<unsigned long long>(at));
+        times += json;
+        snprintf(json, sizeof(json), "%s%.1f", separator, temperatureAt(at));
+        temperatures += json;
+        snprintf(json, sizeof(json), "%s%d", separator, rainAt(at));
+        rain += json;
+    }
+    body += "\"hourly\":{\"time\":[" + times + "],\"temperature_2m\":[" + temperatures +
+            "],\"precipitation_probability\":[" + rain + "]}}";
+    return body;
+}
+
+float FaultInjectingTransport::nextUnit() {
+    // xorshift64*
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return static_cast<float>((state * 2685821657736338717ULL) >> 40) / static_cast<float>(1 << 24);
+}
+
+HostResponse FaultInjectingTransport::handle(const HostRequest& request) {
+    counts.requests++;
+
+    // One draw per request keeps the fault sequence independent of payloads
+    float draw = nextUnit();
+    float detail = nextUnit();
+    if (draw < rates.error) {
+        counts.errors++;
+        HostResponse response;
+        response.status = detail < 0.5f ? HTTPC_ERROR_CONNECTION_REFUSED : HTTPC_ERROR_CONNECTION_LOST;
+        response.body.clear();
+        response.latencyMs = static_cast<uint32_t>(detail * 3000.0f);
+        return response;
+    }
+    draw -= rates.error;
+
+    HostResponse response = inner.handle(request);
+    if (draw < rates.slow) {
+        counts.slow++;
+        response.latencyMs = std::max(response.latencyMs, slowLatencyMs);
+    } else if (draw - rates.slow < rates.malformed && !response.body.empty()) {
+        counts.malformed++;
+        size_t cut = static_cast<size_t>(detail * response.body.size());
+        if (detail < 0.5f) {
+            response.body.resize(cut);
+        } else {
+            // Keep the length, scramble the tail
+            for (size_t i = cut; i < response.body.size(); i += 7) {
+                response.body[i] = response.body[i] == '#' ? '@' : '#';
+            }
+        }
+    }
+    return response;
+}
+
+bool NetworkConditionTransport::preset(const std::string& name, Profile& profile) {
+    Profile chosen;
+    if (name == "ideal") {
+        // No link costs at all: only the inner transport's latency
+    } else if (name == "good") {
+        // Strong home WiFi, server nearby
+        chosen.rttMs = 20;
+        chosen.bandwidthKbps = 20000;
+        chosen.dnsMs = 10;
+    } else if (name == "fair") {
+        // Through a wall or two, busy channel
+        chosen.rttMs = 60;
+        chosen.bandwidthKbps = 5000;
+        chosen.loss = 0.005f;
+        chosen.reset = 0.002f;
+        chosen.dnsMs = 30;
+    } else if (name == "weak") {
+        // Around -80 dBm: low PHY rates and frequent retries
+        chosen.rttMs = 150;
+        chosen.bandwidthKbps = 1000;
+        chosen.loss = 0.02f;
+        chosen.reset = 0.01f;
+        chosen.dnsMs = 80;
+    } else if (name == "poor") {
+        // Barely associated at the edge of range
+        chosen.rttMs = 300;
+        chosen.bandwidthKbps = 250;
+        chosen.loss = 0.05f;
+        chosen.reset = 0.03f;
+        chosen.dnsMs = 200;
+    } else {
+        return false;
+    }
+    profile = chosen;
+    return true;
+}
+
+float NetworkConditionTransport::nextUnit() {
+    // xorshift64*
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return static_cast<float>((state * 2685821657736338717ULL) >> 40) / static_cast<float>(1 << 24);
+}
+
+uint64_t NetworkConditionTransport::exchangeMs(uint32_t packets) {
+    uint64_t ms = profile.rttMs;
+    for (uint32_t i = 0; i < packets; i++) {
+        if (nextUnit() < profile.loss) {
+            counts.lostPackets++;
+            ms += profile.rtoMs;
+        }
+    }
+    return ms;
+}
+
+uint64_t NetworkConditionTransport::transferMs(size_t bytes) {
+    uint32_t remaining = static_cast<uint32_t>(std::max<size_t>((bytes + MSS - 1) / MSS, 1));
+    uint32_t window = INITIAL_WINDOW;
+    uint32_t threshold = UINT32_MAX;
+    double ms = 0.0;
+    bool first = true;
+
+    while (remaining > 0) {
+        uint32_t sent = std::min(window, remaining);
+        remaining -= sent;
+
+        // The first window follows the request's round trip directly
+        double serialMs = profile.bandwidthKbps > 0 ? sent * MSS * 8.0 / profile.bandwidthKbps : 0.0;
+        ms += first ? serialMs : std::max(static_cast<double>(profile.rttMs), serialMs);
+        first = false;
+
+        bool lost = false;
+        for (uint32_t i = 0; i < sent; i++) {
+            if (nextUnit() >= profile.loss) continue;
+            counts.lostPackets++;
+            lost = true;
+            // Three later segments produce the duplicate ACKs for a fast retransmit
+            uint32_t behind = sent - 1 - i + remaining;
+            ms += behind >= 3 ? profile.rttMs : profile.rtoMs;
+        }
+
+        if (lost) {
+            threshold = std::max<uint32_t>(window / 2, 2);
+            window = threshold;
+        } else if (window < threshold) {
+            window *= 2;
+        } else {
+            window++;
+        }
+    }
+    return static_cast<uint64_t>(std::ceil(ms));
+}
+
+HostResponse NetworkConditionTransport::handle(const HostRequest& request) {
+    counts.requests++;
+    uint64_t now = HostClock::micros();
+    uint64_t ms = 0;
+
+    auto cached = dnsExpiryMicros.find(request.host);
+    if (cached == dnsExpiryMicros.end() || now >= cached->second) {
+        counts.dnsLookups++;
+        // Query and answer, with dnsMs in place of the round trip
+        ms += exchangeMs(2) - profile.rttMs + profile.dnsMs;
+        dnsExpiryMicros[request.host] = now + (ms + dnsCacheMs) * 1000ULL;
+    }
+
+    auto open = connections.find(request.client);
+    bool reuse = open != connections.end() && open->second.host == request.host &&
+                 now - std::min(now, open->second.idleSinceMicros) <= idleTimeoutMs * 1000ULL;
+    if (!reuse) {
+        counts.handshakes++;
+        ms += exchangeMs(2);                            // SYN, SYN-ACK
+        if (request.url.compare(0, 8, "https://") == 0) {
+            ms += exchangeMs(4) + exchangeMs(2);        // TLS 1.2: hello and certificates, then key exchange
+        }
+    }
+    connections.erase(request.client);
+
+    // One draw per request keeps the sequence independent of outcomes
+    float resetDraw = nextUnit();
+    float resetPoint = nextUnit();
+
+    HostResponse response = inner.handle(request);
+    ms += exchangeMs(1);                                // Request out, first byte back
+    if (response.status < 0) {
+        response.latencyMs = static_cast<uint32_t>(std::min<uint64_t>(ms + response.latencyMs, UINT32_MAX));
+        return response;
+    }
+
+    uint64_t transfer = transferMs(response.body.size() + response.headers.size());
+    if (resetDraw < profile.reset) {
+        counts.resets++;
+        response.status = HTTPC_ERROR_CONNECTION_LOST;
+        response.body.clear();
+        response.headers.clear();
+        ms += static_cast<uint64_t>(resetPoint * transfer);
+    } else {
+        ms += transfer;
+        if (request.keepAlive) {
+            connections[request.client] = Connection{request.host, now + (ms + response.latencyMs) * 1000ULL};
+        }
+    }
+    response.latencyMs = static_cast<uint32_t>(std::min<uint64_t>(ms + response.latencyMs, UINT32_MAX));
+    return response;
+}
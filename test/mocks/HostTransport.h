@@ -0,0 +1,182 @@
+#ifndef HOST_TRANSPORT_H
+#define HOST_TRANSPORT_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+/**
+ * One HTTP exchange as seen by the host network stand-in
+ */
+struct HostRequest {
+    std::string method;
+    std::string url;
+    std::string host;
+    std::string path;       // Without the query string, always starts with '/'
+    std::string query;      // Without the leading '?'
+    std::string headers;    // "Name: value\n" lines
+    uint32_t client = 0;    // HTTPClient instance that sent it; connections belong to one client
+    bool keepAlive = false; // The client keeps the connection open for its next request
+};
+
+struct HostResponse {
+    int status = 404;       // HTTP status, or a negative HTTPC_ERROR_* code
+    std::string body;
+    std::string headers;    // "Name: value\n" lines
+    uint32_t latencyMs = 0; // Charged to HostClock by HTTPClient::GET()
+    bool sendLength = true; // false: no Content-Length, getSize() is -1
+};
+
+/**
+ * Backend that answers HTTPClient requests in host builds.
+ * Install one with HTTPClient::setTransport().
+ */
+class HostTransport {
+public:
+    virtual ~HostTransport() {}
+    virtual HostResponse handle(const HostRequest& request) = 0;
+
+    // Split an http(s) URL into host, path and query. Returns false if malformed.
+    static bool parseUrl(const std::string& url, HostRequest& request);
+    // Value of one query parameter, or fallback
+    static std::string queryParam(const std::string& query, const char* name,
+                                  const std::string& fallback = std::string());
+    // url without one query parameter (the '?' goes too if nothing is left)
+    static std::string removeQueryParam(const std::string& url, const char* name);
+};
+
+/**
+ * Serves files from <root>/<host>/<path> (query strings ignored), with a
+ * fixed latency per request. Requests to api.open-meteo.com without a
+ * fixture get a deterministic synthetic forecast derived from the emulated
+ * wall clock, so long simulations see the weather change.
+ */
+class FixtureTransport : public HostTransport {
+public:
+    explicit FixtureTransport(const std::string& root = std::string()) : root(root) {}
+
+    HostResponse handle(const HostRequest& request) override;
+
+    void setLatencyMs(uint32_t ms) { latencyMs = ms; }
+    void setSyntheticWeather(bool enabled) { syntheticWeather = enabled; }
+    uint32_t getRequestCount() const { return requestCount; }
+
+    static std::string syntheticForecast(uint64_t epochSeconds);
+
+private:
+    std::string root;
+    uint32_t latencyMs = 150;
+    bool syntheticWeather = true;
+    uint32_t requestCount = 0;
+};
+
+/**
+ * Wraps another transport and breaks a random share of its responses:
+ * connection errors, responses slower than any client timeout, and bodies
+ * cut short or overwritten so JSON and images fail to parse. Faults are
+ * drawn from a seeded generator, so a run can be reproduced exactly.
+ */
+class FaultInjectingTransport : public HostTransport {
+public:
+    struct Rates {
+        float error = 0.0f;         // Connection refused or lost
+        float slow = 0.0f;          // latencyMs raised to slowLatencyMs
+        float malformed = 0.0f;     // Truncated or corrupted body, status unchanged
+    };
+
+    struct Counts {
+        uint32_t requests = 0;
+        uint32_t errors = 0;
+        uint32_t slow = 0;
+        uint32_t malformed = 0;
+    };
+
+    FaultInjectingTransport(HostTransport& inner, const Rates& rates, uint32_t seed = 1)
+        : inner(inner), rates(rates), state(seed ? seed : 1) {}
+
+    HostResponse handle(const HostRequest& request) override;
+
+    void setSlowLatencyMs(uint32_t ms) { slowLatencyMs = ms; }
+    const Counts& getCounts() const { return counts; }
+
+private:
+    HostTransport& inner;
+    Rates rates;
+    uint32_t slowLatencyMs = 20000;
+    uint64_t state;
+    Counts counts;
+
+    // Uniform in [0, 1)
+    float nextUnit();
+};
+
+/**
+ * Wraps another transport and charges what the radio link adds to each
+ * exchange: DNS lookup, TCP and TLS handshakes, TCP slow start, a bandwidth
+ * cap and retransmission stalls for lost packets. A share of responses is
+ * cut off by a connection reset. The inner latency is taken as server time.
+ *
+ * DNS answers are cached and connections stay open between requests of one
+ * keep-alive client, as lwIP and the ESP32 HTTPClient do, so a fetch path
+ * that reuses them is charged less. Draws come from a seeded generator, so
+ * a run can be reproduced exactly.
+ */
+class NetworkConditionTransport : public HostTransport {
+public:
+    struct Profile {
+        uint32_t rttMs = 0;
+        uint32_t bandwidthKbps = 0;     // Downlink cap (0 = unlimited)
+        float loss = 0.0f;              // Per packet, either direction
+        float reset = 0.0f;             // Per request: connection reset partway through the response
+        uint32_t dnsMs = 0;             // Lookup on a cache miss
+        uint32_t rtoMs = 1000;          // Retransmission timeout when a loss cannot be fast-retransmitted
+    };
+
+    struct Counts {
+        uint32_t requests = 0;
+        uint32_t dnsLookups = 0;
+        uint32_t handshakes = 0;        // New connections (TCP, plus TLS for https)
+        uint32_t lostPackets = 0;
+        uint32_t resets = 0;
+    };
+
+    static const uint32_t MSS = 1460;
+    static const uint32_t INITIAL_WINDOW = 10;      // Segments in the first round trip
+
+    // Named link conditions: ideal, good, fair, weak, poor. False if unknown.
+    static bool preset(const std::string& name, Profile& profile);
+    static const char* presetNames() { return "ideal, good, fair, weak, poor"; }
+
+    NetworkConditionTransport(HostTransport& inner, const Profile& profile, uint32_t seed = 1)
+        : inner(inner), profile(profile), state(seed ? seed : 1) {}
+
+    HostResponse handle(const HostRequest& request) override;
+
+    void setDnsCacheMs(uint32_t ms) { dnsCacheMs = ms; }
+    void setIdleTimeoutMs(uint32_t ms) { idleTimeoutMs = ms; }
+    const Counts& getCounts() const { return counts; }
+
+private:
+    struct Connection {
+        std::string host;
+        uint64_t idleSinceMicros;
+    };
+
+    HostTransport& inner;
+    Profile profile;
+    uint32_t dnsCacheMs = 60000;
+    uint32_t idleTimeoutMs = 15000;     // Server side keep-alive timeout
+    uint64_t state;
+    Counts counts;
+    std::map<std::string, uint64_t> dnsExpiryMicros;
+    std::map<uint32_t, Connection> connections;     // By client
+
+    // Uniform in [0, 1)
+    float nextUnit();
+    // Time for packets sent back to back with nothing behind to trigger fast retransmit
+    uint64_t exchangeMs(uint32_t packets);
+    // Time to stream bytes through slow start and the bandwidth cap, losses included
+    uint64_t transferMs(size_t bytes);
+};
+
+#endif
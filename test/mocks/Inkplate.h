@@ -0,0 +1,7 @@
+#ifndef MOCK_INKPLATE_INCLUDE_H
+#define MOCK_INKPLATE_INCLUDE_H
+
+// Host builds resolve <Inkplate.h> to the panel mock
+#include "MockInkplate.h"
+
+#endif
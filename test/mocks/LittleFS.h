@@ -0,0 +1,28 @@
+#ifndef MOCK_LITTLEFS_H
+#define MOCK_LITTLEFS_H
+
+#include "FS.h"
+
+/**
+ * LittleFS on the internal flash partition. Same in-memory store as the
+ * SPIFFS mock; only the mount API differs.
+ */
+class LittleFSFS : public fs::FS {
+public:
+    bool begin(bool formatOnFail = false, const char* basePath = "/littlefs",
+               uint8_t maxOpenFiles = 10, const char* partitionLabel = "spiffs");
+    void end() { mounted = false; }
+    bool format() { clearFiles(); return true; }
+    size_t totalBytes() const { return 1441792; }  // Partition size from default.csv
+
+    // Host control: simulate an unformattable/corrupt partition
+    void setMountFailure(bool fail) { failMount = fail; }
+
+private:
+    bool mounted = false;
+    bool failMount = false;
+};
+
+extern LittleFSFS LittleFS;
+
+#endif
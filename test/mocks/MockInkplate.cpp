@@ -0,0 +1,451 @@
+#include "MockInkplate.h"
+#include "HostClock.h"
+#include "HTTPClient.h"
+#include "esp_heap_caps.h"
+#include <cstdint>
+#include <cstring>
+
+Inkplate* Inkplate::primaryInstance = nullptr;
+
+Inkplate::Inkplate(uint8_t mode)
+    : _partial(monoBuffer)
+    , DMemoryNew(shownBuffer)
+    , DMemory4Bit(grayBuffer)
+    , monoBuffer(nullptr)
+    , shownBuffer(nullptr)
+    , grayBuffer(nullptr)
+    , panelState(nullptr)
+    , panelWidth(E_INK_WIDTH)
+    , panelHeight(E_INK_HEIGHT)
+    , displayMode(mode & 1)
+    , blockPartial(true)
+    , cursorX(0)
+    , cursorY(0)
+    , textSize(1)
+    , textColor(0)
+    , textWrap(true)
+    , batteryVoltage(3.95)
+    , ioModes()
+    , ioLevels()
+    , dividerSwitches(0)
+    , chargeClock(true)
+    , captureFormat(FrameWriter::Format::PGM)
+    , frameCount(0) {
+    size_t pixels = static_cast<size_t>(panelWidth) * panelHeight;
+    monoBuffer = static_cast<uint8_t*>(heap_caps_malloc(pixels / 8, MALLOC_CAP_SPIRAM));
+    shownBuffer = static_cast<uint8_t*>(heap_caps_malloc(pixels / 8, MALLOC_CAP_SPIRAM));
+    grayBuffer = static_cast<uint8_t*>(heap_caps_malloc(pixels / 2, MALLOC_CAP_SPIRAM));
+    panelState = static_cast<uint8_t*>(heap_caps_malloc(pixels / 2, MALLOC_CAP_SPIRAM));
+    if (!monoBuffer || !shownBuffer || !grayBuffer || !panelState) {
+        fprintf(stderr, "MockInkplate: failed to allocate panel buffers\n");
+        abort();
+    }
+
+    resetBuffers();
+    // A fresh panel shows white
+    memset(panelState, 0x77, pixels / 2);
+    primaryInstance = this;
+}
+
+Inkplate::~Inkplate() {
+    if (primaryInstance == this) {
+        primaryInstance = nullptr;
+    }
+    heap_caps_free(monoBuffer);
+    heap_caps_free(shownBuffer);
+    heap_caps_free(grayBuffer);
+    heap_caps_free(panelState);
+}
+
+uint8_t Inkplate::getNibble(const uint8_t* buffer, size_t index) {
+    uint8_t byte = buffer[index / 2];
+    return (index & 1) ? (byte & 0x0F) : (byte >> 4);
+}
+
+void Inkplate::setNibble(uint8_t* buffer, size_t index, uint8_t value) {
+    uint8_t& byte = buffer[index / 2];
+    byte = (index & 1) ? static_cast<uint8_t>((byte & 0xF0) | value)
+                       : static_cast<uint8_t>((byte & 0x0F) | (value << 4));
+}
+
+bool Inkplate::getBit(const uint8_t* buffer, size_t index) {
+    return (buffer[index / 8] >> (index & 7)) & 1;
+}
+
+void Inkplate::setBit(uint8_t* buffer, size_t index, bool value) {
+    // Leftmost pixel in the low bit, as the driver's pixelMaskLUT
+    uint8_t mask = static_cast<uint8_t>(1 << (index & 7));
+    if (value) {
+        buffer[index / 8] |= mask;
+    } else {
+        buffer[index / 8] &= static_cast<uint8_t>(~mask);
+    }
+}
+
+void Inkplate::resetBuffers() {
+    size_t pixels = static_cast<size_t>(panelWidth) * panelHeight;
+    memset(monoBuffer, 0, pixels / 8);
+    memset(shownBuffer, 0, pixels / 8);
+    memset(grayBuffer, 0x77, pixels / 2);
+}
+
+bool Inkplate::begin() {
+    blockPartial = true;
+    return true;
+}
+
+void Inkplate::clearDisplay() {
+    size_t pixels = static_cast<size_t>(panelWidth) * panelHeight;
+    memset(monoBuffer, 0, pixels / 8);
+    memset(grayBuffer, 0x77, pixels / 2);
+}
+
+void Inkplate::display(bool leaveOn) {
+    (void)leaveOn;
+    size_t pixels = static_cast<size_t>(panelWidth) * panelHeight;
+
+    if (displayMode == INKPLATE_1BIT) {
+        for (size_t i = 0; i < pixels; i++) {
+            uint8_t shown = getBit(monoBuffer, i) ? 0 : 7;
+            if (getNibble(panelState, i) != shown) {
+                setNibble(panelState, i, shown);
+                stats.changedPixels++;
+            }
+        }
+        memcpy(shownBuffer, monoBuffer, pixels / 8);
+        blockPartial = false;
+        chargeRefresh(costModel.fullRefresh1BitMs);
+    } else {
+        for (size_t i = 0; i < pixels; i++) {
+            uint8_t shown = getNibble(grayBuffer, i);
+            if (getNibble(panelState, i) != shown) {
+                setNibble(panelState, i, shown);
+                stats.changedPixels++;
+            }
+        }
+        stats.fullRefreshes3Bit++;
+        chargeRefresh(costModel.fullRefresh3BitMs);
+    }
+
+    stats.fullRefreshes++;
+    presentFrame("full");
+}
+
+uint32_t Inkplate::partialUpdate(bool forced, bool leaveOn) {
+    // The library only supports partial updates in 1-bit mode
+    if (displayMode != INKPLATE_1BIT) {
+        stats.ignoredPartials++;
+        return 0;
+    }
+
+    // After begin() or a mode switch the panel state is unknown
+    if (blockPartial && !forced) {
+        stats.blockedPartials++;
+        display(leaveOn);
+        return 0;
+    }
+
+    size_t pixels = static_cast<size_t>(panelWidth) * panelHeight;
+    uint32_t changed = 0;
+    for (size_t i = 0; i < pixels; i++) {
+        bool black = getBit(monoBuffer, i);
+        if (black != getBit(shownBuffer, i)) {
+            setNibble(panelState, i, black ? 0 : 7);
+            changed++;
+        }
+    }
+    memcpy(shownBuffer, monoBuffer, pixels / 8);
+    blockPartial = false;
+
+    stats.partialRefreshes++;
+    stats.changedPixels += changed;
+    chargeRefresh(costModel.partialRefreshMs);
+    presentFrame("partial");
+    return changed;
+}
+
+void Inkplate::preloadScreen() {
+    size_t pixels = static_cast<size_t>(panelWidth) * panelHeight;
+    memcpy(shownBuffer, monoBuffer, pixels / 8);
+}
+
+void Inkplate::setDisplayMode(uint8_t mode) {
+    mode &= 1;
+    if (mode == displayMode) return;
+
+    // Inkplate::selectDisplayMode() wipes both images and blocks partial updates
+    displayMode = mode;
+    resetBuffers();
+    blockPartial = true;
+    stats.modeSwitches++;
+}
+
+double Inkplate::readBattery() {
+    // As the library does: divider on, settle, one ADC read, divider off
+    pinModeIO(BATTERY_MOSFET_PIN, OUTPUT);
+    digitalWriteIO(BATTERY_MOSFET_PIN, HIGH);
+    delay(5);
+    uint32_t millivolts = readBatteryPinMillivolts();
+    pinModeIO(BATTERY_MOSFET_PIN, INPUT);
+    return millivolts / 1000.0 * 2;
+}
+
+uint32_t Inkplate::readBatteryPinMillivolts() {
+    if (!dividerOn()) return 0;
+    if (!batteryReadings.empty()) {
+        batteryVoltage = batteryReadings.front();
+        batteryReadings.pop_front();
+    }
+    // Halved by the divider
+    return static_cast<uint32_t>(batteryVoltage * 500.0 + 0.5);
+}
+
+void Inkplate::pinModeIO(uint8_t pin, uint8_t mode, uint8_t ioID) {
+    if (ioID != IO_INT_ADDR || pin >= sizeof(ioModes)) return;
+    bool wasOn = dividerOn();
+    ioModes[pin] = mode;
+    if (!wasOn && dividerOn()) dividerSwitches++;
+}
+
+void Inkplate::digitalWriteIO(uint8_t pin, uint8_t state, uint8_t ioID) {
+    if (ioID != IO_INT_ADDR || pin >= sizeof(ioLevels)) return;
+    bool wasOn = dividerOn();
+    ioLevels[pin] = state ? HIGH : LOW;
+    if (!wasOn && dividerOn()) dividerSwitches++;
+}
+
+uint8_t Inkplate::digitalReadIO(uint8_t pin, uint8_t ioID) {
+    if (ioID != IO_INT_ADDR || pin >= sizeof(ioLevels)) return LOW;
+    // An NMOS switch: its gate idles low
+    return ioModes[pin] == OUTPUT ? ioLevels[pin] : LOW;
+}
+
+uint32_t analogReadMilliVolts(uint8_t pin) {
+    Inkplate* panel = Inkplate::primary();
+    if (!panel || pin != Inkplate::BATTERY_ADC_PIN) return 0;
+    return panel->readBatteryPinMillivolts();
+}
+
+bool Inkplate::drawImage(const char* path, int x, int y, bool dither, bool invert) {
+    (void)dither;
+    if (!path || strncmp(path, "http", 4) != 0) {
+        return false;  // No SD card on the host
+    }
+
+    HTTPClient http;
+    http.begin(path);
+    int status = http.GET();
+    if (status != HTTP_CODE_OK) {
+        http.end();
+        return false;
+    }
+    std::string body = http.getString().str();
+    http.end();
+    return drawEncoded(reinterpret_cast<const uint8_t*>(body.data()), body.size(), x, y, invert);
+}
+
+bool Inkplate::drawBitmapFromBuffer(uint8_t* buf, int x, int y, bool dither, bool invert) {
+    (void)dither;
+    return buf && drawEncoded(buf, SIZE_MAX, x, y, invert);
+}
+
+bool Inkplate::drawJpegFromBuffer(uint8_t* buf, int32_t size, int x, int y, bool dither, bool invert) {
+    (void)dither;
+    return buf && size > 0 && drawEncoded(buf, static_cast<size_t>(size), x, y, invert);
+}
+
+bool Inkplate::drawPngFromBuffer(uint8_t* buf, int32_t size, int x, int y, bool dither, bool invert) {
+    (void)dither;
+    return buf && size > 0 && drawEncoded(buf, static_cast<size_t>(size), x, y, invert);
+}
+
+bool Inkplate::drawEncoded(const uint8_t* data, size_t size, int x, int y, bool invert) {
+    // Binary PGM is the only format decoded on the host; anything else
+    // counts as drawn so layouts behave as with a real image
+    int width = 0;
+    int height = 0;
+    int maxValue = 0;
+    int headerLength = 0;
+    if (size < 2 || data[0] != 'P' || data[1] != '5' ||
+        sscanf(reinterpret_cast<const char*>(data), "P5 %d %d %d%n", &width, &height, &maxValue, &headerLength) != 3 ||
+        width <= 0 || height <= 0 || maxValue <= 0 || maxValue > 255) {
+        return true;
+    }
+
+    size_t dataStart = static_cast<size_t>(headerLength) + 1;  // Single whitespace after maxval
+    if (size < dataStart + static_cast<size_t>(width) * height) {
+        return false;
+    }
+
+    const uint8_t* pixels = data + dataStart;
+    for (int row = 0; row < height; row++) {
+        for (int col = 0; col < width; col++) {
+            int gray = pixels[static_cast<size_t>(row) * width + col] * 255 / maxValue;
+            if (invert) gray = 255 - gray;
+
+            uint16_t color = displayMode == INKPLATE_1BIT ? (gray < 128 ? BLACK : WHITE)
+                                                          : static_cast<uint16_t>(gray >> 5);
+            drawPixel(static_cast<int16_t>(x + col), static_cast<int16_t>(y + row), color);
+        }
+    }
+    return true;
+}
+
+void Inkplate::drawPixel(int16_t x, int16_t y, uint16_t color) {
+    if (x < 0 || y < 0 || x >= panelWidth || y >= panelHeight) return;
+
+    if (displayMode == INKPLATE_1BIT) {
+        setBit(monoBuffer, pixelIndex(x, y), color & 1);
+    } else {
+        setNibble(grayBuffer, pixelIndex(x, y), static_cast<uint8_t>(color & 0x07));
+    }
+}
+
+void Inkplate::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+    fillRect(x, y, w, 1, color);
+}
+
+void Inkplate::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+    fillRect(x, y, 1, h, color);
+}
+
+void Inkplate::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
+    // Bresenham, as in Adafruit_GFX::writeLine
+    int dx = abs(x1 - x0);
+    int dy = -abs(y1 - y0);
+    int sx = x0 < x1 ? 1 : -1;
+    int sy = y0 < y1 ? 1 : -1;
+    int err = dx + dy;
+
+    while (true) {
+        drawPixel(x0, y0, color);
+        if (x0 == x1 && y0 == y1) break;
+        int e2 = 2 * err;
+        if (e2 >= dy) { err += dy; x0 += sx; }
+        if (e2 <= dx) { err += dx; y0 += sy; }
+    }
+}
+
+void Inkplate::drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    if (w <= 0 || h <= 0) return;
+    drawFastHLine(x, y, w, color);
+    drawFastHLine(x, y + h - 1, w, color);
+    drawFastVLine(x, y, h, color);
+    drawFastVLine(x + w - 1, y, h, color);
+}
+
+void Inkplate::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    int startX = std::max<int>(0, x);
+    int startY = std::max<int>(0, y);
+    int endX = std::min<int>(panelWidth, x + w);
+    int endY = std::min<int>(panelHeight, y + h);
+
+    for (int py = startY; py < endY; py++) {
+        for (int px = startX; px < endX; px++) {
+            drawPixel(px, py, color);
+        }
+    }
+}
+
+void Inkplate::getTextBounds(const char* str, int16_t x, int16_t y,
+                             int16_t* x1, int16_t* y1, uint16_t* w, uint16_t* h) {
+    int lineWidth = 0;
+    int maxWidth = 0;
+    int lines = str && *str ? 1 : 0;
+
+    for (const char* c = str; c && *c; c++) {
+        if (*c == '\n') {
+            lines++;
+            lineWidth = 0;
+        } else if (*c != '\r') {
+            lineWidth += CHAR_WIDTH * textSize;
+            if (lineWidth > maxWidth) maxWidth = lineWidth;
+        }
+    }
+
+    if (x1) *x1 = x;
+    if (y1) *y1 = y;
+    if (w) *w = static_cast<uint16_t>(maxWidth);
+    if (h) *h = static_cast<uint16_t>(lines * CHAR_HEIGHT * textSize);
+}
+
+void Inkplate::drawGlyph(int16_t x, int16_t y) {
+    // 5x7 ink box inside the 6x8 cell
+    fillRect(x, y, (CHAR_WIDTH - 1) * textSize, (CHAR_HEIGHT - 1) * textSize, textColor);
+}
+
+size_t Inkplate::write(uint8_t c) {
+    if (c == '\n') {
+        cursorX = 0;
+        cursorY += CHAR_HEIGHT * textSize;
+        return 1;
+    }
+    if (c == '\r') return 1;
+
+    if (textWrap && cursorX + CHAR_WIDTH * textSize > panelWidth) {
+        cursorX = 0;
+        cursorY += CHAR_HEIGHT * textSize;
+    }
+
+    if (c != ' ') {
+        drawGlyph(cursorX, cursorY);
+    }
+    cursorX += CHAR_WIDTH * textSize;
+    return 1;
+}
+
+uint8_t Inkplate::getPixel(int16_t x, int16_t y) const {
+    if (x < 0 || y < 0 || x >= panelWidth || y >= panelHeight) {
+        return displayMode == INKPLATE_1BIT ? WHITE : 7;
+    }
+    if (displayMode == INKPLATE_1BIT) {
+        return getBit(monoBuffer, pixelIndex(x, y)) ? BLACK : WHITE;
+    }
+    return getNibble(grayBuffer, pixelIndex(x, y));
+}
+
+uint8_t Inkplate::getPanelPixel(int16_t x, int16_t y) const {
+    if (x < 0 || y < 0 || x >= panelWidth || y >= panelHeight) return 7;
+    return getNibble(panelState, pixelIndex(x, y));
+}
+
+std::vector<uint8_t> Inkplate::getPanelFrame() const {
+    size_t pixels = static_cast<size_t>(panelWidth) * panelHeight;
+    std::vector<uint8_t> frame(pixels);
+    for (size_t i = 0; i < pixels; i++) {
+        frame[i] = static_cast<uint8_t>(getNibble(panelState, i) * 255 / 7);
+    }
+    return frame;
+}
+
+void Inkplate::setFrameCapture(const char* directory, FrameWriter::Format format) {
+    captureDirectory = directory ? directory : "";
+    captureFormat = format;
+}
+
+void Inkplate::chargeRefresh(uint32_t durationMs) {
+    uint32_t totalMs = durationMs + costModel.powerUpMs;
+    stats.refreshMs += totalMs;
+    // mJ = V * mA * ms / 1000
+    stats.energyMj += costModel.supplyVoltage * costModel.refreshCurrentMa * totalMs / 1000.0;
+    if (chargeClock) {
+        HostClock::advanceMillis(totalMs);
+    }
+}
+
+void Inkplate::presentFrame(const char* kind) {
+    frameCount++;
+    if (captureDirectory.empty()) return;
+
+    char path[512];
+    snprintf(path, sizeof(path), "%s/frame_%05u_%s.%s",
+             captureDirectory.c_str(), frameCount, kind,
+             captureFormat == FrameWriter::Format::PNG ? "png" : "pgm");
+
+    std::vector<uint8_t> frame = getPanelFrame();
+    if (FrameWriter::write(path, frame.data(), panelWidth, panelHeight, captureFormat)) {
+        lastCapturePath = path;
+    } else {
+        fprintf(stderr, "MockInkplate: failed to write %s\n", path);
+    }
+}
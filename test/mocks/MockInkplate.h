@@ -0,0 +1,230 @@
+#ifndef MOCK_INKPLATE_H
+#define MOCK_INKPLATE_H
+
+#include "Arduino.h"
+#include "FrameWriter.h"
+#include <deque>
+#include <string>
+#include <vector>
+
+#define INKPLATE_1BIT 0
+#define INKPLATE_3BIT 1
+
+#define BLACK 1
+#define WHITE 0
+
+#define E_INK_WIDTH  1200
+#define E_INK_HEIGHT 825
+
+// I/O expanders: the internal one switches the battery divider
+#define IO_INT_ADDR 0x20
+#define IO_EXT_ADDR 0x22
+
+/**
+ * Time and energy charged for each panel operation.
+ *
+ * Defaults approximate the Inkplate 10 (ED097TC2) waveform timings;
+ * override them to model other panels or measured numbers.
+ */
+struct PanelCostModel {
+    uint32_t fullRefresh1BitMs = 1100;
+    uint32_t fullRefresh3BitMs = 1800;
+    uint32_t partialRefreshMs = 600;
+    uint32_t powerUpMs = 20;            // einkOn() before every refresh
+    float refreshCurrentMa = 80.0f;     // Panel supply current while driving
+    float supplyVoltage = 3.7f;
+};
+
+/**
+ * Refresh accounting since the last resetStats()
+ */
+struct PanelStats {
+    uint32_t fullRefreshes = 0;
+    uint32_t fullRefreshes3Bit = 0;
+    uint32_t partialRefreshes = 0;
+    uint32_t blockedPartials = 0;       // partialUpdate() promoted to a full refresh
+    uint32_t ignoredPartials = 0;       // partialUpdate() in 3-bit mode (no-op on the device)
+    uint32_t modeSwitches = 0;
+    uint64_t changedPixels = 0;         // Pixels that changed on the panel
+    uint64_t refreshMs = 0;
+    double energyMj = 0.0;
+};
+
+/**
+ * Host stand-in for the Inkplate 10 driver.
+ *
+ * Mirrors the library's buffers: a 1-bit image plus the previously shown
+ * 1-bit image for partial updates, and a 4-bit-per-pixel image for 3-bit
+ * mode. They are allocated from the emulated PSRAM like on the device.
+ * Mode switches clear the buffers and block the next partial update, as
+ * Inkplate::selectDisplayMode() does.
+ *
+ * The simulated panel keeps what is physically shown (0 = black, 7 = white).
+ * display() and partialUpdate() update it, count refreshes, charge the cost
+ * model to HostClock and optionally write each frame to disk.
+ *
+ * Text uses the classic 6x8 GFX cell metrics. Glyphs are drawn as solid 5x7
+ * boxes, which keeps layout and coverage visible in captured frames.
+ */
+class Inkplate : public Print {
+public:
+    explicit Inkplate(uint8_t mode = INKPLATE_3BIT);
+    virtual ~Inkplate();
+
+    Inkplate(const Inkplate&) = delete;
+    Inkplate& operator=(const Inkplate&) = delete;
+
+    // Panel control
+    bool begin();
+    void clearDisplay();
+    void display(bool leaveOn = false);
+    uint32_t partialUpdate(bool forced = false, bool leaveOn = false);
+    void setDisplayMode(uint8_t mode);
+    void selectDisplayMode(uint8_t mode) { setDisplayMode(mode); }
+    uint8_t getDisplayMode() const { return displayMode; }
+    int16_t width() const { return panelWidth; }
+    int16_t height() const { return panelHeight; }
+    double readBattery();
+
+    // I/O expander pins; the internal expander's pin 9 switches the battery
+    // divider onto the ADC pin, as on the Inkplate 10
+    void pinModeIO(uint8_t pin, uint8_t mode, uint8_t ioID = IO_INT_ADDR);
+    void digitalWriteIO(uint8_t pin, uint8_t state, uint8_t ioID = IO_INT_ADDR);
+    uint8_t digitalReadIO(uint8_t pin, uint8_t ioID = IO_INT_ADDR);
+    // http(s) URLs are fetched through HTTPClient; binary PGM bodies are drawn
+    bool drawImage(const char* path, int x, int y, bool dither = true, bool invert = false);
+    bool drawImage(const String& path, int x, int y, bool dither = true, bool invert = false) {
+        return drawImage(path.c_str(), x, y, dither, invert);
+    }
+    // Encoded images already in memory. BMP, JPEG and PNG are not decoded on
+    // the host: binary PGM is drawn, anything else counts as drawn. The bitmap
+    // call has no size, so the PGM header is trusted there.
+    bool drawBitmapFromBuffer(uint8_t* buf, int x, int y, bool dither = true, bool invert = false);
+    bool drawJpegFromBuffer(uint8_t* buf, int32_t size, int x, int y, bool dither = true, bool invert = false);
+    bool drawPngFromBuffer(uint8_t* buf, int32_t size, int x, int y, bool dither = true, bool invert = false);
+
+    // Drawing
+    void drawPixel(int16_t x, int16_t y, uint16_t color);
+    void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+    void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+    void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color);
+    void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    void fillScreen(uint16_t color) { fillRect(0, 0, panelWidth, panelHeight, color); }
+
+    // Text
+    void setCursor(int16_t x, int16_t y) { cursorX = x; cursorY = y; }
+    int16_t getCursorX() const { return cursorX; }
+    int16_t getCursorY() const { return cursorY; }
+    void setTextSize(uint8_t size) { textSize = size > 0 ? size : 1; }
+    void setTextColor(uint16_t color) { textColor = color; }
+    void setTextColor(uint16_t color, uint16_t background) { textColor = color; (void)background; }
+    void setTextWrap(bool wrap) { textWrap = wrap; }
+    void cp437(bool enable = true) { (void)enable; }
+    void getTextBounds(const char* str, int16_t x, int16_t y,
+                       int16_t* x1, int16_t* y1, uint16_t* w, uint16_t* h);
+    void getTextBounds(const String& str, int16_t x, int16_t y,
+                       int16_t* x1, int16_t* y1, uint16_t* w, uint16_t* h) {
+        getTextBounds(str.c_str(), x, y, x1, y1, w, h);
+    }
+
+    size_t write(uint8_t c) override;
+    using Print::write;
+
+    // Library buffers, public as in the Inkplate driver
+    uint8_t*& _partial;         // 1-bit image being drawn
+    uint8_t*& DMemoryNew;       // 1-bit image last sent to the panel
+    uint8_t*& DMemory4Bit;      // 3-bit image, 4 bits per pixel
+    // Take the current 1-bit image as what the panel shows (after deep sleep)
+    void preloadScreen();
+
+    // Host inspection: buffer contents in the current mode's color space
+    uint8_t getPixel(int16_t x, int16_t y) const;
+    // What the panel physically shows, 0 (black) to 7 (white)
+    uint8_t getPanelPixel(int16_t x, int16_t y) const;
+    // Panel contents scaled to 8-bit gray (0 = black, 255 = white)
+    std::vector<uint8_t> getPanelFrame() const;
+    void setBatteryVoltage(double volts) { batteryVoltage = volts; }
+    // Returned by the next readBattery() calls in order, then the last one sticks
+    void queueBatteryReading(double volts) { batteryReadings.push_back(volts); }
+    // Times the battery divider was switched on
+    uint32_t getDividerSwitches() const { return dividerSwitches; }
+    // Battery pin voltage after the divider; 0 while it is off
+    uint32_t readBatteryPinMillivolts();
+
+    static const uint8_t BATTERY_ADC_PIN = 35;
+    static const uint8_t BATTERY_MOSFET_PIN = 9;
+
+    // Cost model and statistics
+    void setCostModel(const PanelCostModel& model) { costModel = model; }
+    const PanelCostModel& getCostModel() const { return costModel; }
+    const PanelStats& getStats() const { return stats; }
+    void resetStats() { stats = PanelStats(); }
+    // Advance HostClock by each refresh's duration (default on)
+    void setChargeClock(bool enabled) { chargeClock = enabled; }
+
+    // Frame capture: every presented frame is written to directory
+    void setFrameCapture(const char* directory, FrameWriter::Format format = FrameWriter::Format::PGM);
+    void disableFrameCapture() { captureDirectory.clear(); }
+    uint32_t getFrameCount() const { return frameCount; }
+    const std::string& getLastCapturePath() const { return lastCapturePath; }
+
+    // Most recently constructed panel (the one LayoutManager owns in host builds)
+    static Inkplate* primary() { return primaryInstance; }
+
+    static const int CHAR_WIDTH = 6;   // Classic GFX font cell, including spacing
+    static const int CHAR_HEIGHT = 8;
+
+protected:
+    static Inkplate* primaryInstance;
+
+    // Library-equivalent buffers (PSRAM)
+    uint8_t* monoBuffer;        // 1 bit per pixel, 1 = black, LSB = leftmost (_partial)
+    uint8_t* shownBuffer;       // 1-bit image partialUpdate() compares against (DMemoryNew)
+    uint8_t* grayBuffer;        // 4 bits per pixel, 7 = white (DMemory4Bit)
+    uint8_t* panelState;        // Simulation only: 4 bits per pixel, shown image
+
+    int16_t panelWidth;
+    int16_t panelHeight;
+    uint8_t displayMode;
+    bool blockPartial;
+
+    int16_t cursorX;
+    int16_t cursorY;
+    uint8_t textSize;
+    uint16_t textColor;
+    bool textWrap;
+
+    double batteryVoltage;
+    std::deque<double> batteryReadings;
+    uint8_t ioModes[16];
+    uint8_t ioLevels[16];
+    uint32_t dividerSwitches;
+
+    bool dividerOn() const {
+        return ioModes[BATTERY_MOSFET_PIN] == OUTPUT && ioLevels[BATTERY_MOSFET_PIN] == HIGH;
+    }
+
+    PanelCostModel costModel;
+    PanelStats stats;
+    bool chargeClock;
+
+    std::string captureDirectory;
+    FrameWriter::Format captureFormat;
+    uint32_t frameCount;
+    std::string lastCapturePath;
+
+    size_t pixelIndex(int x, int y) const { return static_cast<size_t>(y) * panelWidth + x; }
+    static uint8_t getNibble(const uint8_t* buffer, size_t index);
+    static void setNibble(uint8_t* buffer, size_t index, uint8_t value);
+    static bool getBit(const uint8_t* buffer, size_t index);
+    static void setBit(uint8_t* buffer, size_t index, bool value);
+
+    void resetBuffers();
+    bool drawEncoded(const uint8_t* data, size_t size, int x, int y, bool invert);
+    void drawGlyph(int16_t x, int16_t y);
+    void chargeRefresh(uint32_t durationMs);
+    void presentFrame(const char* kind);
+};
+
+#endif
@@ -0,0 +1,17 @@
+#include "SD.h"
+
+SDFS SD;
+SPIClass SPI(VSPI);
+
+bool SDFS::begin(uint8_t ssPin, SPIClass& spi, uint32_t frequency, const char* mountpoint,
+                 uint8_t maxFiles, bool formatIfEmpty) {
+    (void)ssPin;
+    (void)spi;
+    (void)frequency;
+    (void)mountpoint;
+    (void)maxFiles;
+    (void)formatIfEmpty;
+
+    mounted = cardPresent;
+    return mounted;
+}
@@ -0,0 +1,42 @@
+#ifndef MOCK_SD_H
+#define MOCK_SD_H
+
+#include "FS.h"
+#include "SPI.h"
+
+typedef enum {
+    CARD_NONE,
+    CARD_MMC,
+    CARD_SD,
+    CARD_SDHC,
+    CARD_UNKNOWN
+} sdcard_type_t;
+
+/**
+ * microSD card over SPI. Files live in memory like the SPIFFS mock and
+ * can be mirrored to a host directory with mountDirectory(). A card is in
+ * the slot unless the host removes it.
+ */
+class SDFS : public fs::FS {
+public:
+    bool begin(uint8_t ssPin = 5, SPIClass& spi = SPI, uint32_t frequency = 4000000,
+               const char* mountpoint = "/sd", uint8_t maxFiles = 5, bool formatIfEmpty = false);
+    void end() { mounted = false; }
+    sdcard_type_t cardType() const { return mounted ? CARD_SDHC : CARD_NONE; }
+    uint64_t cardSize() const { return cardBytes; }
+    uint64_t totalBytes() const { return cardBytes; }
+
+    // Host controls
+    void setCardPresent(bool present) { cardPresent = present; }
+    void setCardSize(uint64_t bytes) { cardBytes = bytes; }
+    bool isMounted() const { return mounted; }
+
+private:
+    bool mounted = false;
+    bool cardPresent = true;
+    uint64_t cardBytes = 8ULL * 1024 * 1024 * 1024;
+};
+
+extern SDFS SD;
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef MOCK_SPI_H
+#define MOCK_SPI_H
+
+#include <cstdint>
+
+#define FSPI 0
+#define HSPI 1
+#define VSPI 2
+
+/**
+ * SPI bus; only pin assignment is modelled
+ */
+class SPIClass {
+public:
+    explicit SPIClass(uint8_t bus = HSPI) : bus(bus) {}
+
+    void begin(int8_t sck = -1, int8_t miso = -1, int8_t mosi = -1, int8_t ss = -1) {
+        sckPin = sck;
+        misoPin = miso;
+        mosiPin = mosi;
+        ssPin = ss;
+    }
+    void end() {}
+
+private:
+    uint8_t bus;
+    int8_t sckPin = -1;
+    int8_t misoPin = -1;
+    int8_t mosiPin = -1;
+    int8_t ssPin = -1;
+};
+
+extern SPIClass SPI;
+
+#endif
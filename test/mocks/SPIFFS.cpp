@@ -0,0 +1,13 @@
+#include "SPIFFS.h"
+
+SPIFFSFS SPIFFS;
+
+bool SPIFFSFS::begin(bool formatOnFail, const char* basePath, uint8_t maxOpenFiles, const char* partitionLabel) {
+    (void)formatOnFail;
+    (void)basePath;
+    (void)maxOpenFiles;
+    (void)partitionLabel;
+
+    mounted = !failMount;
+    return mounted;
+}
@@ -0,0 +1,24 @@
+#ifndef MOCK_SPIFFS_H
+#define MOCK_SPIFFS_H
+
+#include "FS.h"
+
+class SPIFFSFS : public fs::FS {
+public:
+    bool begin(bool formatOnFail = false, const char* basePath = "/spiffs",
+               uint8_t maxOpenFiles = 10, const char* partitionLabel = nullptr);
+    void end() { mounted = false; }
+    bool format() { clearFiles(); return true; }
+    size_t totalBytes() const { return 1441792; }  // Partition size from default.csv
+
+    // Host control: simulate an unformattable/corrupt partition
+    void setMountFailure(bool fail) { failMount = fail; }
+
+private:
+    bool mounted = false;
+    bool failMount = false;
+};
+
+extern SPIFFSFS SPIFFS;
+
+#endif
@@ -0,0 +1,120 @@
+#ifndef MOCK_WSTRING_H
+#define MOCK_WSTRING_H
+
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+
+/**
+ * Host stand-in for the Arduino String class, backed by std::string.
+ * Covers the subset of the API used by the firmware and by ArduinoJson's
+ * Arduino string adapter (c_str/length/concat).
+ */
+class String {
+public:
+    String() {}
+    String(const char* str) : value(str ? str : "") {}
+    String(const std::string& str) : value(str) {}
+    String(char c) : value(1, c) {}
+    String(int number) : value(std::to_string(number)) {}
+    String(unsigned int number) : value(std::to_string(number)) {}
+    String(long number) : value(std::to_string(number)) {}
+    String(unsigned long number) : value(std::to_string(number)) {}
+    String(float number, unsigned int decimals = 2) { formatFloat(number, decimals); }
+    String(double number, unsigned int decimals = 2) { formatFloat(number, decimals); }
+
+    const char* c_str() const { return value.c_str(); }
+    unsigned int length() const { return static_cast<unsigned int>(value.length()); }
+    bool isEmpty() const { return value.empty(); }
+    void reserve(unsigned int size) { value.reserve(size); }
+
+    char charAt(unsigned int index) const { return index < value.length() ? value[index] : 0; }
+    char operator[](unsigned int index) const { return charAt(index); }
+    char& operator[](unsigned int index) { return value[index]; }
+
+    String substring(unsigned int from) const {
+        return from < value.length() ? String(value.substr(from)) : String();
+    }
+    String substring(unsigned int from, unsigned int to) const {
+        if (from > to) std::swap(from, to);
+        if (from >= value.length()) return String();
+        return String(value.substr(from, to - from));
+    }
+
+    int indexOf(char c, unsigned int from = 0) const {
+        size_t pos = value.find(c, from);
+        return pos == std::string::npos ? -1 : static_cast<int>(pos);
+    }
+    int indexOf(const String& str, unsigned int from = 0) const {
+        size_t pos = value.find(str.value, from);
+        return pos == std::string::npos ? -1 : static_cast<int>(pos);
+    }
+    int lastIndexOf(char c) const {
+        size_t pos = value.rfind(c);
+        return pos == std::string::npos ? -1 : static_cast<int>(pos);
+    }
+    bool startsWith(const String& prefix) const { return value.compare(0, prefix.value.length(), prefix.value) == 0; }
+    bool endsWith(const String& suffix) const {
+        return value.length() >= suffix.value.length() &&
+               value.compare(value.length() - suffix.value.length(), suffix.value.length(), suffix.value) == 0;
+    }
+
+    void trim() {
+        size_t start = value.find_first_not_of(" \t\r\n");
+        size_t end = value.find_last_not_of(" \t\r\n");
+        value = start == std::string::npos ? std::string() : value.substr(start, end - start + 1);
+    }
+    void toLowerCase() { for (char& c : value) c = static_cast<char>(tolower(c)); }
+    void toUpperCase() { for (char& c : value) c = static_cast<char>(toupper(c)); }
+    void replace(const String& from, const String& to) {
+        if (from.value.empty()) return;
+        size_t pos = 0;
+        while ((pos = value.find(from.value, pos)) != std::string::npos) {
+            value.replace(pos, from.value.length(), to.value);
+            pos += to.value.length();
+        }
+    }
+    void remove(unsigned int index) { if (index < value.length()) value.erase(index); }
+    void remove(unsigned int index, unsigned int count) { if (index < value.length()) value.erase(index, count); }
+
+    long toInt() const { return std::strtol(value.c_str(), nullptr, 10); }
+    float toFloat() const { return std::strtof(value.c_str(), nullptr); }
+
+    bool concat(const char* str) { if (str) value += str; return true; }
+    bool concat(const char* str, unsigned int length) { if (str) value.append(str, length); return true; }
+    bool concat(const String& str) { value += str.value; return true; }
+    bool concat(char c) { value += c; return true; }
+
+    String& operator+=(const String& rhs) { value += rhs.value; return *this; }
+    String& operator+=(const char* rhs) { if (rhs) value += rhs; return *this; }
+    String& operator+=(char rhs) { value += rhs; return *this; }
+    String& operator+=(int rhs) { value += std::to_string(rhs); return *this; }
+    String& operator+=(unsigned long rhs) { value += std::to_string(rhs); return *this; }
+
+    bool equals(const String& other) const { return value == other.value; }
+    bool operator==(const String& rhs) const { return value == rhs.value; }
+    bool operator==(const char* rhs) const { return rhs && value == rhs; }
+    bool operator!=(const String& rhs) const { return value != rhs.value; }
+    bool operator!=(const char* rhs) const { return !(*this == rhs); }
+    bool operator<(const String& rhs) const { return value < rhs.value; }
+
+    const std::string& str() const { return value; }
+
+private:
+    std::string value;
+
+    void formatFloat(double number, unsigned int decimals) {
+        char buffer[64];
+        snprintf(buffer, sizeof(buffer), "%.*f", static_cast<int>(decimals), number);
+        value = buffer;
+    }
+};
+
+inline String operator+(const String& lhs, const String& rhs) { String result(lhs); result += rhs; return result; }
+inline String operator+(const String& lhs, const char* rhs) { String result(lhs); result += rhs; return result; }
+inline String operator+(const char* lhs, const String& rhs) { String result(lhs); result += rhs; return result; }
+inline String operator+(const String& lhs, char rhs) { String result(lhs); result += rhs; return result; }
+inline bool operator==(const char* lhs, const String& rhs) { return rhs == lhs; }
+
+#endif
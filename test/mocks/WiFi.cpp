@@ -0,0 +1,71 @@
+#include "WiFi.h"
+#include "HostClock.h"
+
+WiFiClass WiFi;
+
+wl_status_t WiFiClass::begin(const char* ssid, const char* password) {
+    (void)password;
+    currentMode = WIFI_STA;
+    connectedSsid = ssid ? ssid : "";
+    connectCount++;
+
+    if (!radioOn) {
+        radioOn = true;
+        radioOnSinceMicros = HostClock::micros();
+    }
+
+    if (!networkAvailable) {
+        connecting = false;
+        currentStatus = WL_NO_SSID_AVAIL;
+    } else if (connectDelayMs == 0) {
+        connecting = false;
+        currentStatus = WL_CONNECTED;
+    } else {
+        connecting = true;
+        connectStartedMicros = HostClock::micros();
+        currentStatus = WL_DISCONNECTED;
+    }
+    return currentStatus;
+}
+
+wl_status_t WiFiClass::status() {
+    if (connecting && HostClock::micros() - connectStartedMicros >= connectDelayMs * 1000ULL) {
+        connecting = false;
+        currentStatus = networkAvailable ? WL_CONNECTED : WL_NO_SSID_AVAIL;
+    }
+    return currentStatus;
+}
+
+bool WiFiClass::disconnect(bool wifiOff) {
+    connecting = false;
+    currentStatus = WL_DISCONNECTED;
+    radioOff();
+    if (wifiOff) {
+        currentMode = WIFI_OFF;
+    }
+    return true;
+}
+
+bool WiFiClass::mode(wifi_mode_t newMode) {
+    currentMode = newMode;
+    if (newMode == WIFI_OFF) {
+        connecting = false;
+        currentStatus = WL_DISCONNECTED;
+        radioOff();
+    }
+    return true;
+}
+
+IPAddress WiFiClass::localIP() {
+    return status() == WL_CONNECTED ? IPAddress(192, 168, 1, 50) : IPAddress();
+}
+
+uint64_t WiFiClass::getRadioOnMicros() const {
+    return radioOnTotalMicros + (radioOn ? HostClock::micros() - radioOnSinceMicros : 0);
+}
+
+void WiFiClass::radioOff() {
+    if (!radioOn) return;
+    radioOnTotalMicros += HostClock::micros() - radioOnSinceMicros;
+    radioOn = false;
+}
@@ -0,0 +1,84 @@
+#ifndef MOCK_WIFI_H
+#define MOCK_WIFI_H
+
+#include "Arduino.h"
+
+typedef enum {
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_SCAN_COMPLETED = 2,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_CONNECTION_LOST = 5,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum {
+    WIFI_OFF = 0,
+    WIFI_STA = 1,
+    WIFI_AP = 2,
+    WIFI_AP_STA = 3
+} wifi_mode_t;
+
+class IPAddress {
+public:
+    IPAddress(uint8_t a = 0, uint8_t b = 0, uint8_t c = 0, uint8_t d = 0) : octets{a, b, c, d} {}
+
+    String toString() const {
+        char buffer[16];
+        snprintf(buffer, sizeof(buffer), "%u.%u.%u.%u", octets[0], octets[1], octets[2], octets[3]);
+        return String(buffer);
+    }
+
+private:
+    uint8_t octets[4];
+};
+
+/**
+ * Simulated station interface. After begin() the station reports
+ * WL_CONNECTED once the connect delay has elapsed on HostClock (immediately
+ * by default), unless the host has marked the network unavailable.
+ * Radio-on time is accumulated from begin() until disconnect or WIFI_OFF.
+ */
+class WiFiClass {
+public:
+    wl_status_t begin(const char* ssid, const char* password = nullptr);
+    bool disconnect(bool wifiOff = false);
+    bool mode(wifi_mode_t newMode);
+    wifi_mode_t getMode() const { return currentMode; }
+    wl_status_t status();
+    IPAddress localIP();
+    int8_t RSSI() { return status() == WL_CONNECTED ? rssi : 0; }
+    String SSID() const { return connectedSsid; }
+
+    // Host controls
+    void setNetworkAvailable(bool available) { networkAvailable = available; }
+    bool isNetworkAvailable() const { return networkAvailable; }
+    void setRSSI(int8_t value) { rssi = value; }
+    void setStatus(wl_status_t status) { currentStatus = status; }
+    unsigned long getConnectCount() const { return connectCount; }
+    // Association + DHCP time charged after begin() (virtual clock friendly)
+    void setConnectDelayMs(uint32_t ms) { connectDelayMs = ms; }
+    uint64_t getRadioOnMicros() const;
+
+
+private:
+    wl_status_t currentStatus = WL_DISCONNECTED;
+    wifi_mode_t currentMode = WIFI_OFF;
+    bool networkAvailable = true;
+    int8_t rssi = -58;
+    String connectedSsid;
+    unsigned long connectCount = 0;
+    uint32_t connectDelayMs = 0;
+    uint64_t connectStartedMicros = 0;
+    bool connecting = false;
+    bool radioOn = false;
+    uint64_t radioOnSinceMicros = 0;
+    uint64_t radioOnTotalMicros = 0;
+
+    void radioOff();
+};
+
+extern WiFiClass WiFi;
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef MOCK_DRIVER_GPIO_H
+#define MOCK_DRIVER_GPIO_H
+
+typedef int gpio_num_t;
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef MOCK_DRIVER_RTC_IO_H
+#define MOCK_DRIVER_RTC_IO_H
+
+#include "gpio.h"
+
+typedef int esp_err_t;
+
+esp_err_t rtc_gpio_pullup_en(gpio_num_t gpioNum);
+esp_err_t rtc_gpio_pulldown_dis(gpio_num_t gpioNum);
+
+#endif
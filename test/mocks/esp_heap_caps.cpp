@@ -0,0 +1,101 @@
+#include "esp_heap_caps.h"
+#include "HostHeap.h"
+#include <cstdlib>
+#include <cstring>
+#include <unordered_map>
+
+// PSRAM-tagged blocks, so internal and external usage can be reported apart
+static std::unordered_map<void*, size_t>& psramBlocks() {
+    static std::unordered_map<void*, size_t> blocks;
+    return blocks;
+}
+static size_t psramLiveBytes = 0;
+static size_t minimumFreeInternal = SIZE_MAX;
+
+static HostHeap::Region regionFor(uint32_t caps) {
+    return (caps & MALLOC_CAP_SPIRAM) ? HostHeap::Region::PSRAM : HostHeap::Region::INTERNAL;
+}
+
+void* heap_caps_malloc(size_t size, uint32_t caps) {
+    if ((caps & MALLOC_CAP_SPIRAM) && psramLiveBytes + size > HostHeap::psramCapacity()) {
+        return nullptr;
+    }
+
+    if (caps & MALLOC_CAP_SPIRAM) {
+        HostHeap::placeNextAllocation(HostHeap::Region::PSRAM);
+    } else if (caps & MALLOC_CAP_INTERNAL) {
+        HostHeap::placeNextAllocation(HostHeap::Region::INTERNAL);
+    }
+    void* ptr = malloc(size);
+    if (ptr && (caps & MALLOC_CAP_SPIRAM)) {
+        psramBlocks()[ptr] = size;
+        psramLiveBytes += size;
+    }
+    heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL);
+    return ptr;
+}
+
+void* heap_caps_calloc(size_t count, size_t size, uint32_t caps) {
+    void* ptr = heap_caps_malloc(count * size, caps);
+    if (ptr) memset(ptr, 0, count * size);
+    return ptr;
+}
+
+void heap_caps_free(void* ptr) {
+    if (!ptr) return;
+
+    auto it = psramBlocks().find(ptr);
+    if (it != psramBlocks().end()) {
+        psramLiveBytes -= it->second;
+        psramBlocks().erase(it);
+    }
+    free(ptr);
+}
+
+size_t heap_caps_get_free_size(uint32_t caps) {
+    if (HostHeap::isDeviceModelEnabled()) {
+        return HostHeap::deviceHeap(regionFor(caps)).freeBytes;
+    }
+    if (caps & MALLOC_CAP_SPIRAM) {
+        return HostHeap::psramCapacity() - psramLiveBytes;
+    }
+
+    size_t live = HostHeap::snapshot().liveBytes;
+    size_t internalLive = live > psramLiveBytes ? live - psramLiveBytes : 0;
+    return internalLive < HostHeap::internalCapacity() ? HostHeap::internalCapacity() - internalLive : 0;
+}
+
+size_t heap_caps_get_largest_free_block(uint32_t caps) {
+    if (HostHeap::isDeviceModelEnabled()) {
+        return HostHeap::deviceHeap(regionFor(caps)).largestFreeBlock;
+    }
+    // The host heap does not fragment in a way that maps onto the device
+    return heap_caps_get_free_size(caps);
+}
+
+size_t heap_caps_get_minimum_free_size(uint32_t caps) {
+    if (caps & MALLOC_CAP_SPIRAM) {
+        return heap_caps_get_free_size(caps);
+    }
+
+    size_t current = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    if (current < minimumFreeInternal) {
+        minimumFreeInternal = current;
+    }
+    return minimumFreeInternal;
+}
+
+void heap_caps_get_info(multi_heap_info_t* info, uint32_t caps) {
+    if (!info) return;
+
+    HostHeap::Counters counters = HostHeap::snapshot();
+    size_t freeBytes = heap_caps_get_free_size(caps);
+
+    info->total_free_bytes = freeBytes;
+    info->total_allocated_bytes = counters.liveBytes;
+    info->largest_free_block = heap_caps_get_largest_free_block(caps);
+    info->minimum_free_bytes = heap_caps_get_minimum_free_size(caps);
+    info->allocated_blocks = counters.liveBlocks;
+    info->free_blocks = HostHeap::isDeviceModelEnabled() ? HostHeap::deviceHeap(regionFor(caps)).freeRanges : 1;
+    info->total_blocks = counters.liveBlocks + info->free_blocks;
+}
@@ -0,0 +1,9 @@
+#ifndef MOCK_ESP_IDF_VERSION_H
+#define MOCK_ESP_IDF_VERSION_H
+
+// The IDF that Arduino-ESP32 2.x builds on
+#define ESP_IDF_VERSION_MAJOR 4
+#define ESP_IDF_VERSION_MINOR 4
+#define ESP_IDF_VERSION_PATCH 0
+
+#endif
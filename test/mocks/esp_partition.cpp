@@ -0,0 +1,123 @@
+#include "esp_partition.h"
+#include "HostFlash.h"
+#include <cstring>
+#include <fcntl.h>
+#include <map>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+struct HostPartition {
+    esp_partition_t partition;
+    std::string path;
+};
+
+struct HostMapping {
+    void* base;
+    size_t length;
+};
+
+std::vector<HostPartition*> partitions;
+std::map<spi_flash_mmap_handle_t, HostMapping> mappings;
+spi_flash_mmap_handle_t nextHandle = 1;
+esp_app_desc_t appDescription = {0xABCD5432, 0, {0, 0}, "host", "inkplate-dashboard", "00:00:00", "Jan  1 2024",
+                                 "v4.4", {0}, {0}};
+
+}
+
+bool HostFlash::attach(const char* label, const char* path) {
+    struct stat info;
+    if (strlen(label) >= sizeof(esp_partition_t::label) || stat(path, &info) != 0 || !S_ISREG(info.st_mode)) {
+        return false;
+    }
+
+    HostPartition* entry = new HostPartition();
+    entry->partition.type = ESP_PARTITION_TYPE_DATA;
+    entry->partition.subtype = static_cast<esp_partition_subtype_t>(0x40);
+    entry->partition.address = 0;
+    entry->partition.size = static_cast<uint32_t>(info.st_size);
+    strcpy(entry->partition.label, label);
+    entry->partition.encrypted = false;
+    entry->path = path;
+    partitions.push_back(entry);
+    return true;
+}
+
+void HostFlash::detachAll() {
+    for (auto& mapping : mappings) {
+        munmap(mapping.second.base, mapping.second.length);
+    }
+    mappings.clear();
+    for (HostPartition* entry : partitions) {
+        delete entry;
+    }
+    partitions.clear();
+}
+
+void HostFlash::setAppElfSha256(const uint8_t sha256[32]) {
+    memcpy(appDescription.app_elf_sha256, sha256, sizeof(appDescription.app_elf_sha256));
+}
+
+const esp_app_desc_t* esp_ota_get_app_description(void) {
+    return &appDescription;
+}
+
+int HostFlash::getMappedCount() {
+    return static_cast<int>(mappings.size());
+}
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char* label) {
+    for (HostPartition* entry : partitions) {
+        const esp_partition_t& partition = entry->partition;
+        if ((type == ESP_PARTITION_TYPE_ANY || type == partition.type) &&
+            (subtype == ESP_PARTITION_SUBTYPE_ANY || subtype == partition.subtype) &&
+            (!label || strcmp(label, partition.label) == 0)) {
+            return &partition;
+        }
+    }
+    return nullptr;
+}
+
+esp_err_t esp_partition_mmap(const esp_partition_t* partition, size_t offset, size_t size,
+                             esp_partition_mmap_memory_t memory, const void** outPtr,
+                             spi_flash_mmap_handle_t* outHandle) {
+    (void)memory;
+    if (!partition || size == 0 || offset > partition->size || size > partition->size - offset) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const HostPartition* owner = nullptr;
+    for (const HostPartition* entry : partitions) {
+        if (&entry->partition == partition) owner = entry;
+    }
+    if (!owner) return ESP_ERR_NOT_FOUND;
+
+    // The flash cache maps whole pages; mmap() wants page-aligned offsets too
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t start = offset / page * page;
+    size_t length = offset - start + size;
+
+    int fd = open(owner->path.c_str(), O_RDONLY);
+    if (fd < 0) return ESP_ERR_NOT_FOUND;
+    void* base = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, static_cast<off_t>(start));
+    close(fd);
+    if (base == MAP_FAILED) return ESP_ERR_NO_MEM;
+
+    spi_flash_mmap_handle_t handle = nextHandle++;
+    mappings[handle] = HostMapping{base, length};
+    *outPtr = static_cast<const uint8_t*>(base) + (offset - start);
+    *outHandle = handle;
+    return ESP_OK;
+}
+
+void spi_flash_munmap(spi_flash_mmap_handle_t handle) {
+    auto mapping = mappings.find(handle);
+    if (mapping == mappings.end()) return;
+    munmap(mapping->second.base, mapping->second.length);
+    mappings.erase(mapping);
+}
@@ -0,0 +1,92 @@
+#include "esp_sleep.h"
+#include "HostSleep.h"
+#include "driver/rtc_io.h"
+#include <cstdio>
+#include <cstdlib>
+
+// Bounds of the RTC_DATA_ATTR section, provided by the linker when it exists
+extern "C" uint8_t __start_rtc_data[] __attribute__((weak));
+extern "C" uint8_t __stop_rtc_data[] __attribute__((weak));
+
+esp_sleep_wakeup_cause_t HostSleep::wakeupCause = ESP_SLEEP_WAKEUP_UNDEFINED;
+bool HostSleep::timerWakeupEnabled = false;
+uint64_t HostSleep::timerWakeupUs = 0;
+int HostSleep::ext0Pin = -1;
+int HostSleep::ext0Level = 0;
+esp_sleep_pd_option_t HostSleep::powerDomains[ESP_PD_DOMAIN_MAX] = {
+    ESP_PD_OPTION_AUTO, ESP_PD_OPTION_AUTO, ESP_PD_OPTION_AUTO, ESP_PD_OPTION_AUTO
+};
+HostSleep::DeepSleepHandler HostSleep::deepSleepHandler = nullptr;
+
+esp_sleep_pd_option_t HostSleep::getPowerDomainOption(esp_sleep_pd_domain_t domain) {
+    return domain < ESP_PD_DOMAIN_MAX ? powerDomains[domain] : ESP_PD_OPTION_AUTO;
+}
+
+bool HostSleep::rtcMemoryRetained() {
+    // AUTO keeps slow memory powered whenever RTC_DATA_ATTR data exists
+    return powerDomains[ESP_PD_DOMAIN_RTC_SLOW_MEM] != ESP_PD_OPTION_OFF;
+}
+
+uint8_t* HostSleep::rtcMemory() {
+    return __start_rtc_data;
+}
+
+size_t HostSleep::rtcMemorySize() {
+    if (!__start_rtc_data || !__stop_rtc_data) return 0;
+    return static_cast<size_t>(__stop_rtc_data - __start_rtc_data);
+}
+
+void HostSleep::reset() {
+    timerWakeupEnabled = false;
+    timerWakeupUs = 0;
+    ext0Pin = -1;
+    ext0Level = 0;
+    for (int i = 0; i < ESP_PD_DOMAIN_MAX; i++) {
+        powerDomains[i] = ESP_PD_OPTION_AUTO;
+    }
+}
+
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause() {
+    return HostSleep::getWakeupCause();
+}
+
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t timeInUs) {
+    HostSleep::timerWakeupEnabled = true;
+    HostSleep::timerWakeupUs = timeInUs;
+    return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_ext0_wakeup(gpio_num_t gpioNum, int level) {
+    HostSleep::ext0Pin = gpioNum;
+    HostSleep::ext0Level = level;
+    return ESP_OK;
+}
+
+esp_err_t esp_sleep_pd_config(esp_sleep_pd_domain_t domain, esp_sleep_pd_option_t option) {
+    if (domain < ESP_PD_DOMAIN_MAX) {
+        HostSleep::powerDomains[domain] = option;
+    }
+    return ESP_OK;
+}
+
+void esp_deep_sleep_start() {
+    fflush(stdout);
+    if (HostSleep::deepSleepHandler) {
+        HostSleep::deepSleepHandler();
+    }
+
+    // Nothing resumes a host process after deep sleep; end it like a power-off
+    fprintf(stderr, "esp_deep_sleep_start: sleeping for %llu ms\n",
+            static_cast<unsigned long long>(HostSleep::timerWakeupUs / 1000ULL));
+    exit(0);
+}
+
+esp_err_t rtc_gpio_pullup_en(gpio_num_t gpioNum) {
+    (void)gpioNum;
+    return ESP_OK;
+}
+
+esp_err_t rtc_gpio_pulldown_dis(gpio_num_t gpioNum) {
+    (void)gpioNum;
+    return ESP_OK;
+}
@@ -0,0 +1,330 @@
+#include <unity.h>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+#include "AssetPackBuilder.h"
+#include "HostClock.h"
+#include "HostFlash.h"
+#include "MockInkplate.h"
+#include "core/AssetPack.h"
+#include "core/Compositor.h"
+#include "managers/LayoutManager.h"
+#include "widgets/time/TimeWidget.h"
+
+// Two characters of a 3x3 font: 'I' and 'L', plus space
+static const char* TINY_BDF =
+    "STARTFONT 2.1\n"
+    "FONTBOUNDINGBOX 3 3 0 0\n"
+    "STARTPROPERTIES 2\n"
+    "FONT_ASCENT 3\n"
+    "FONT_DESCENT 1\n"
+    "ENDPROPERTIES\n"
+    "CHARS 3\n"
+    "STARTCHAR space\nENCODING 32\nDWIDTH 4 0\nBBX 0 0 0 0\nBITMAP\nENDCHAR\n"
+    "STARTCHAR I\nENCODING 73\nDWIDTH 4 0\nBBX 1 3 1 0\nBITMAP\n80\n80\n80\nENDCHAR\n"
+    "STARTCHAR L\nENCODING 76\nDWIDTH 4 0\nBBX 3 3 0 0\nBITMAP\n80\n80\nE0\nENDCHAR\n"
+    "ENDFONT\n";
+
+static std::vector<uint8_t> packBytes;
+static AssetPack pack;
+
+static void buildPack() {
+    AssetPackBuilder builder;
+    TEST_ASSERT_TRUE(builder.addFont("tiny", TINY_BDF));
+    TEST_ASSERT_TRUE(builder.addFont("tiny-x2", TINY_BDF, 2));
+    // 4x2 icon: a black frame with a transparent middle
+    TEST_ASSERT_TRUE(builder.addIcon("box", 4, 2, {0, 255, 255, 0, 0, 0, 0, 0}, 255));
+    std::vector<uint8_t> gradient;
+    for (int i = 0; i < 12; i++) gradient.push_back(static_cast<uint8_t>(i * 10));
+    TEST_ASSERT_TRUE(builder.addBackground("ramp", 4, 3, gradient));
+    TEST_ASSERT_TRUE(builder.build(packBytes));
+    TEST_ASSERT_TRUE(pack.parse(packBytes.data(), packBytes.size()));
+}
+
+void setUp(void) {
+    buildPack();
+}
+
+void tearDown(void) {
+    pack.unmap();
+    AssetPack::shared().unmap();
+    HostFlash::detachAll();
+}
+
+void test_entries_are_found_by_name_and_type(void) {
+    TEST_ASSERT_EQUAL(4, pack.getCount());
+    TEST_ASSERT_EQUAL(packBytes.size(), pack.getSize());
+
+    AssetInfo info;
+    TEST_ASSERT_TRUE(pack.find("box", AssetType::ICON, info));
+    TEST_ASSERT_EQUAL(4, info.width);
+    TEST_ASSERT_EQUAL(2, info.height);
+    TEST_ASSERT_EQUAL(255, info.param);
+    // Read in place: the asset points into the pack
+    TEST_ASSERT_TRUE(info.data > packBytes.data() && info.data < packBytes.data() + packBytes.size());
+
+    TEST_ASSERT_TRUE(pack.find("tiny-x2", AssetType::FONT, info));
+    TEST_ASSERT_EQUAL(8, info.height);
+    TEST_ASSERT_EQUAL(6, info.param);
+    TEST_ASSERT_EQUAL(8, info.width);
+
+    TEST_ASSERT_FALSE(pack.find("box", AssetType::FONT, info));
+    TEST_ASSERT_FALSE(pack.find("boxes", AssetType::ICON, info));
+    TEST_ASSERT_FALSE(pack.find("", AssetType::ICON, info));
+}
+
+void test_corrupt_packs_are_rejected(void) {
+    std::vector<uint8_t> bad = packBytes;
+    bad[0] = 'X';
+    TEST_ASSERT_FALSE(pack.parse(bad.data(), bad.size()));
+    TEST_ASSERT_FALSE(pack.isLoaded());
+
+    // Truncated: the header says more than there is
+    TEST_ASSERT_FALSE(pack.parse(packBytes.data(), packBytes.size() - 1));
+
+    // Entries out of order would break the bisection
+    bad = packBytes;
+    bad[AssetPack::HEADER_SIZE] = 'z';
+    TEST_ASSERT_FALSE(pack.parse(bad.data(), bad.size()));
+
+    // Names must fit the entry
+    AssetPackBuilder builder;
+    TEST_ASSERT_FALSE(builder.addFont("a-very-long-font-name", TINY_BDF));
+    TEST_ASSERT_TRUE(builder.addFont("tiny", TINY_BDF));
+    TEST_ASSERT_FALSE(builder.addFont("tiny", TINY_BDF));
+}
+
+void test_fonts_are_scaled_per_size(void) {
+    AssetInfo font;
+    AssetGlyph glyph;
+    TEST_ASSERT_TRUE(pack.find("tiny", AssetType::FONT, font));
+    TEST_ASSERT_TRUE(pack.getGlyph(font, 'L', glyph));
+    TEST_ASSERT_EQUAL(3, glyph.width);
+    TEST_ASSERT_EQUAL(-3, glyph.yOffset);
+    TEST_ASSERT_EQUAL(4, glyph.advance);
+    // Inside the range but not in the font
+    TEST_ASSERT_FALSE(pack.getGlyph(font, 'J', glyph));
+    TEST_ASSERT_FALSE(pack.getGlyph(font, '~', glyph));
+    TEST_ASSERT_EQUAL(12, pack.getTextWidth(font, "IJL"));
+
+    TEST_ASSERT_TRUE(pack.find("tiny-x2", AssetType::FONT, font));
+    TEST_ASSERT_TRUE(pack.getGlyph(font, 'I', glyph));
+    TEST_ASSERT_EQUAL(2, glyph.width);
+    TEST_ASSERT_EQUAL(6, glyph.height);
+    TEST_ASSERT_EQUAL(2, glyph.xOffset);
+    TEST_ASSERT_EQUAL(-6, glyph.yOffset);
+    TEST_ASSERT_EQUAL(8, glyph.advance);
+}
+
+void test_text_is_drawn_on_the_baseline(void) {
+    Compositor compositor(32, 16);
+    TEST_ASSERT_TRUE(compositor.initialize());
+    compositor.clear();
+    compositor.resetChangeTracking();
+
+    AssetInfo font;
+    TEST_ASSERT_TRUE(pack.find("tiny", AssetType::FONT, font));
+    TEST_ASSERT_EQUAL(10, pack.drawText(compositor, font, 2, 5, "IL", 0));
+
+    // 'I' is a column at x=3, rows 2..4; 'L' starts at x=6 with its foot on row 4
+    TEST_ASSERT_EQUAL(0, compositor.getPixel(3, 2));
+    TEST_ASSERT_EQUAL(0, compositor.getPixel(3, 4));
+    TEST_ASSERT_EQUAL(255, compositor.getPixel(3, 5));
+    TEST_ASSERT_EQUAL(255, compositor.getPixel(2, 3));
+    TEST_ASSERT_EQUAL(0, compositor.getPixel(6, 2));
+    TEST_ASSERT_EQUAL(255, compositor.getPixel(7, 3));
+    TEST_ASSERT_EQUAL(0, compositor.getPixel(8, 4));
+
+    // The line box, from the ascent to the descent
+    std::vector<LayoutRegion> changed = compositor.getChangedRegions();
+    TEST_ASSERT_EQUAL(1, changed.size());
+    TEST_ASSERT_EQUAL(2, changed[0].getX());
+    TEST_ASSERT_EQUAL(2, changed[0].getY());
+    TEST_ASSERT_EQUAL(8, changed[0].getWidth());
+    TEST_ASSERT_EQUAL(4, changed[0].getHeight());
+}
+
+void test_text_updates_redraw_only_changed_cells(void) {
+    Compositor compositor(32, 16);
+    TEST_ASSERT_TRUE(compositor.initialize());
+    compositor.clear();
+
+    AssetInfo font;
+    TEST_ASSERT_TRUE(pack.find("tiny", AssetType::FONT, font));
+    pack.drawText(compositor, font, 2, 5, "ILI", 0);
+    compositor.resetChangeTracking();
+
+    // Only the last cell changes: the 'I' at x=11 becomes an 'L' from x=10
+    TEST_ASSERT_EQUAL(1, pack.updateText(compositor, font, 2, 5, "ILI", "ILL", 0, 255));
+    TEST_ASSERT_EQUAL(255, compositor.getPixel(11, 2));
+    TEST_ASSERT_EQUAL(0, compositor.getPixel(10, 2));
+    TEST_ASSERT_EQUAL(0, compositor.getPixel(12, 4));
+    TEST_ASSERT_EQUAL(0, compositor.getPixel(3, 2));
+    TEST_ASSERT_EQUAL(0, compositor.getPixel(6, 4));
+
+    std::vector<LayoutRegion> changed = compositor.getChangedRegions();
+    TEST_ASSERT_EQUAL(1, changed.size());
+    TEST_ASSERT_EQUAL(10, changed[0].getX());
+    TEST_ASSERT_EQUAL(2, changed[0].getY());
+    TEST_ASSERT_EQUAL(4, changed[0].getWidth());
+    TEST_ASSERT_EQUAL(4, changed[0].getHeight());
+
+    // A shorter line erases the cells it no longer covers
+    compositor.resetChangeTracking();
+    TEST_ASSERT_EQUAL(1, pack.updateText(compositor, font, 2, 5, "ILL", "IL", 0, 255));
+    TEST_ASSERT_EQUAL(255, compositor.getPixel(10, 2));
+    TEST_ASSERT_EQUAL(255, compositor.getPixel(12, 4));
+    TEST_ASSERT_EQUAL(0, compositor.getPixel(8, 4));
+
+    // Nothing changed, nothing drawn
+    compositor.resetChangeTracking();
+    TEST_ASSERT_EQUAL(0, pack.updateText(compositor, font, 2, 5, "IL", "IL", 0, 255));
+    TEST_ASSERT_FALSE(compositor.hasChangedRegions());
+}
+
+void test_icons_keep_transparent_pixels_and_backgrounds_clip(void) {
+    Compositor compositor(8, 4);
+    TEST_ASSERT_TRUE(compositor.initialize());
+    compositor.fillRect(0, 0, 8, 4, 128);
+
+    AssetInfo icon;
+    TEST_ASSERT_TRUE(pack.find("box", AssetType::ICON, icon));
+    TEST_ASSERT_TRUE(pack.drawIcon(compositor, icon, 1, 1));
+    TEST_ASSERT_EQUAL(0, compositor.getPixel(1, 1));
+    TEST_ASSERT_EQUAL(128, compositor.getPixel(2, 1));
+    TEST_ASSERT_EQUAL(128, compositor.getPixel(3, 1));
+    TEST_ASSERT_EQUAL(0, compositor.getPixel(4, 1));
+    TEST_ASSERT_EQUAL(0, compositor.getPixel(2, 2));
+
+    AssetInfo background;
+    TEST_ASSERT_TRUE(pack.find("ramp", AssetType::BACKGROUND, background));
+    TEST_ASSERT_TRUE(pack.drawBackground(compositor, background, 6, -1));
+    // Only columns 0..1 of rows 1..2 land on the surface
+    TEST_ASSERT_EQUAL(40, compositor.getPixel(6, 0));
+    TEST_ASSERT_EQUAL(50, compositor.getPixel(7, 0));
+    TEST_ASSERT_EQUAL(80, compositor.getPixel(6, 1));
+    TEST_ASSERT_EQUAL(128, compositor.getPixel(5, 0));
+    TEST_ASSERT_EQUAL(128, compositor.getPixel(6, 2));
+}
+
+void test_partition_is_mapped_in_place(void) {
+    char path[] = "/tmp/assetpackXXXXXX";
+    int fd = mkstemp(path);
+    TEST_ASSERT_TRUE(fd >= 0);
+    // The partition is larger than the pack, and erased flash reads 0xff
+    std::vector<uint8_t> partition = packBytes;
+    partition.resize(64 * 1024, 0xff);
+    TEST_ASSERT_EQUAL(partition.size(), write(fd, partition.data(), partition.size()));
+    close(fd);
+
+    AssetPack mapped;
+    TEST_ASSERT_FALSE(mapped.map());
+    TEST_ASSERT_TRUE(HostFlash::attach(AssetPack::PARTITION_LABEL, path));
+    TEST_ASSERT_TRUE(mapped.map());
+    TEST_ASSERT_EQUAL(1, HostFlash::getMappedCount());
+    TEST_ASSERT_EQUAL(packBytes.size(), mapped.getSize());
+
+    AssetInfo font;
+    TEST_ASSERT_TRUE(mapped.find("tiny", AssetType::FONT, font));
+    TEST_ASSERT_EQUAL(12, mapped.getTextWidth(font, "ILL"));
+
+    mapped.unmap();
+    TEST_ASSERT_EQUAL(0, HostFlash::getMappedCount());
+    TEST_ASSERT_FALSE(mapped.isLoaded());
+
+    // An erased partition has no pack and is not left mapped
+    HostFlash::detachAll();
+    partition.assign(partition.size(), 0xff);
+    FILE* file = fopen(path, "wb");
+    fwrite(partition.data(), 1, partition.size(), file);
+    fclose(file);
+    TEST_ASSERT_TRUE(HostFlash::attach(AssetPack::PARTITION_LABEL, path));
+    TEST_ASSERT_FALSE(mapped.map());
+    TEST_ASSERT_EQUAL(0, HostFlash::getMappedCount());
+    unlink(path);
+}
+
+void test_sample_manifest_builds(void) {
+    AssetPackBuilder builder;
+    TEST_ASSERT_TRUE(builder.addManifest("host/sample/assets/assets.json"));
+    std::vector<uint8_t> bytes;
+    TEST_ASSERT_TRUE(builder.build(bytes));
+    TEST_ASSERT_TRUE(pack.parse(bytes.data(), bytes.size()));
+
+    AssetInfo font;
+    TEST_ASSERT_TRUE(pack.find("clock-28", AssetType::FONT, font));
+    TEST_ASSERT_EQUAL(28, font.param);
+    TEST_ASSERT_EQUAL(24 * 8, pack.getTextWidth(font, "12:45 PM"));
+    AssetInfo icon;
+    TEST_ASSERT_TRUE(pack.find("sync-fail", AssetType::ICON, icon));
+    TEST_ASSERT_EQUAL(32, icon.width);
+}
+
+void test_time_ticks_redraw_one_digit_in_place(void) {
+    AssetPackBuilder builder;
+    TEST_ASSERT_TRUE(builder.addManifest("host/sample/assets/assets.json"));
+    std::vector<uint8_t> bytes;
+    TEST_ASSERT_TRUE(builder.build(bytes));
+    TEST_ASSERT_TRUE(AssetPack::shared().parse(bytes.data(), bytes.size()));
+    AssetInfo font;
+    TEST_ASSERT_TRUE(AssetPack::shared().find("clock-28", AssetType::FONT, font));
+
+    // 2024-03-01 15:00 UTC, on the hour so only the last digit changes a minute later
+    HostClock::setVirtual(true);
+    HostClock::setMicros(0);
+    HostClock::setBootEpochMicros(1709305200ULL * 1000000ULL);
+    HostClock::setWallClockSynced(false);
+    WiFi.setConnectDelayMs(0);
+    WiFi.begin("pack-network", "password");
+
+    Inkplate display(INKPLATE_3BIT);
+    Compositor compositor(400, 300);
+    TEST_ASSERT_TRUE(compositor.initialize());
+    compositor.clear();
+    LayoutRegion region(0, 0, 400, 300);
+    TimeWidget* widget = new TimeWidget(display, 60000);
+    region.addWidget(widget); // The region owns it
+    widget->begin();
+    widget->forceTimeSync();
+    TEST_ASSERT_TRUE(widget->isTimeInitialized());
+    widget->renderToCompositor(compositor, region);
+    String before = widget->getFormattedTime();
+
+    HostClock::advanceMillis(60000);
+    TEST_ASSERT_FALSE(before == widget->getFormattedTime());
+    compositor.resetChangeTracking();
+    region.markDirty();
+    TEST_ASSERT_TRUE(LayoutManager::renderChangedRegion(compositor, region));
+    TEST_ASSERT_FALSE(region.needsUpdate());
+
+    // One digit cell on the time line, not the whole region
+    std::vector<LayoutRegion> changed = compositor.getChangedRegions();
+    TEST_ASSERT_EQUAL(1, changed.size());
+    TEST_ASSERT_TRUE(changed[0].getWidth() <= static_cast<int>(font.width));
+    TEST_ASSERT_TRUE(changed[0].getHeight() <= static_cast<int>(font.height));
+    TEST_ASSERT_EQUAL(10 + 4 * static_cast<int>(font.width), changed[0].getX());
+
+    // The label and date drawn by the full render are still there
+    TEST_ASSERT_EQUAL(0, compositor.getPixel(20, 30));
+    TEST_ASSERT_EQUAL(0, compositor.getPixel(20, 115));
+
+    WiFi.disconnect(true);
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+
+    UNITY_BEGIN();
+    RUN_TEST(test_entries_are_found_by_name_and_type);
+    RUN_TEST(test_corrupt_packs_are_rejected);
+    RUN_TEST(test_fonts_are_scaled_per_size);
+    RUN_TEST(test_text_is_drawn_on_the_baseline);
+    RUN_TEST(test_text_updates_redraw_only_changed_cells);
+    RUN_TEST(test_icons_keep_transparent_pixels_and_backgrounds_clip);
+    RUN_TEST(test_partition_is_mapped_in_place);
+    RUN_TEST(test_sample_manifest_builds);
+    RUN_TEST(test_time_ticks_redraw_one_digit_in_place);
+    return UNITY_END();
+}
@@ -0,0 +1,139 @@
+#include <unity.h>
+#include "HostClock.h"
+#include "core/BackgroundWork.h"
+
+// 2024-01-15 08:00 UTC
+static const uint32_t NOW = 1705305600;
+static const uint32_t HOUR = 3600;
+
+static int lightRuns = 0;
+static int heavyRuns = 0;
+static int otherHeavyRuns = 0;
+
+static bool light(void*) { lightRuns++; return true; }
+static bool heavy(void*) { heavyRuns++; return true; }
+static bool otherHeavy(void*) { otherHeavyRuns++; return true; }
+
+static void setClock(uint32_t epoch) {
+    HostClock::setWallClockSynced(true);
+    HostClock::setBootEpochMicros(static_cast<uint64_t>(epoch) * 1000000ULL - HostClock::micros());
+}
+
+void setUp(void) {
+    HostClock::setVirtual(true);
+    HostClock::setMicros(1000000);
+    setClock(NOW);
+    BackgroundWork::reset();
+    lightRuns = heavyRuns = otherHeavyRuns = 0;
+}
+
+void tearDown(void) {}
+
+void test_budget_follows_the_voltage_trend(void) {
+    // No reading: as if nothing were known
+    TEST_ASSERT_EQUAL(static_cast<int>(PowerBudget::NORMAL), static_cast<int>(BackgroundWork::classify(0, 3900, false)));
+    // By level
+    TEST_ASSERT_EQUAL(static_cast<int>(PowerBudget::AMPLE), static_cast<int>(BackgroundWork::classify(4000, 0, false)));
+    TEST_ASSERT_EQUAL(static_cast<int>(PowerBudget::NORMAL), static_cast<int>(BackgroundWork::classify(3850, 3851, false)));
+    TEST_ASSERT_EQUAL(static_cast<int>(PowerBudget::LOW_BATTERY),
+                      static_cast<int>(BackgroundWork::classify(3760, 3765, false)));
+    // A rise means a charger, even on a nearly empty battery
+    TEST_ASSERT_EQUAL(static_cast<int>(PowerBudget::CHARGING),
+                      static_cast<int>(BackgroundWork::classify(3700, 3650, false)));
+    // Full and held there: still charging; sagging: unplugged
+    TEST_ASSERT_EQUAL(static_cast<int>(PowerBudget::CHARGING),
+                      static_cast<int>(BackgroundWork::classify(4195, 4200, true)));
+    TEST_ASSERT_EQUAL(static_cast<int>(PowerBudget::AMPLE), static_cast<int>(BackgroundWork::classify(4150, 4200, true)));
+}
+
+void test_one_off_rise_does_not_latch_charging(void) {
+    // Slowly discharging with a single 20 mV jump (a load step, ADC noise)
+    const float volts[] = {3.950f, 3.948f, 3.946f, 3.966f, 3.964f, 3.962f, 3.960f};
+    PowerBudget budgets[7];
+    for (int i = 0; i < 7; i++) {
+        BackgroundWork::run(volts[i]);
+        budgets[i] = BackgroundWork::getBudget();
+    }
+
+    TEST_ASSERT_EQUAL(static_cast<int>(PowerBudget::CHARGING), static_cast<int>(budgets[3]));
+    for (int i = 4; i < 7; i++) {
+        TEST_ASSERT_NOT_EQUAL(static_cast<int>(PowerBudget::CHARGING), static_cast<int>(budgets[i]));
+    }
+
+    // A real charge keeps climbing, then holds at full
+    const float charging[] = {3.990f, 4.020f, 4.060f, 4.100f, 4.180f, 4.185f, 4.182f};
+    for (float v : charging) {
+        BackgroundWork::run(v);
+        TEST_ASSERT_EQUAL(static_cast<int>(PowerBudget::CHARGING), static_cast<int>(BackgroundWork::getBudget()));
+    }
+}
+
+void test_heavy_work_waits_longer_on_battery(void) {
+    const uint32_t interval = 24 * HOUR;
+    TEST_ASSERT_TRUE(BackgroundWork::isDue(WorkCost::HEAVY, PowerBudget::CHARGING, 6 * HOUR, interval));
+    TEST_ASSERT_FALSE(BackgroundWork::isDue(WorkCost::HEAVY, PowerBudget::AMPLE, 6 * HOUR, interval));
+    TEST_ASSERT_TRUE(BackgroundWork::isDue(WorkCost::HEAVY, PowerBudget::AMPLE, interval, interval));
+    TEST_ASSERT_TRUE(BackgroundWork::isDue(WorkCost::LIGHT, PowerBudget::NORMAL, interval, interval));
+    TEST_ASSERT_FALSE(BackgroundWork::isDue(WorkCost::HEAVY, PowerBudget::NORMAL, 3 * interval, interval));
+    TEST_ASSERT_TRUE(BackgroundWork::isDue(WorkCost::HEAVY, PowerBudget::NORMAL, 4 * interval, interval));
+    TEST_ASSERT_FALSE(BackgroundWork::isDue(WorkCost::LIGHT, PowerBudget::LOW_BATTERY, UINT32_MAX, interval));
+}
+
+void test_runs_due_tasks_by_budget(void) {
+    BackgroundWork::add("light", WorkCost::LIGHT, 12 * HOUR, light);
+    BackgroundWork::add("heavy", WorkCost::HEAVY, 24 * HOUR, heavy);
+    BackgroundWork::add("other", WorkCost::HEAVY, 24 * HOUR, otherHeavy);
+
+    // On battery, never run: the light task and one heavy task
+    TEST_ASSERT_EQUAL(2, BackgroundWork::run(3.90f));
+    TEST_ASSERT_EQUAL(1, lightRuns);
+    TEST_ASSERT_EQUAL(1, heavyRuns);
+    TEST_ASSERT_EQUAL(0, otherHeavyRuns);
+
+    // Next wake: the other heavy task, nothing else is due
+    setClock(NOW + HOUR);
+    TEST_ASSERT_EQUAL(1, BackgroundWork::run(3.90f));
+    TEST_ASSERT_EQUAL(1, otherHeavyRuns);
+
+    // Plugged in seven hours later: everything past a quarter of its interval
+    setClock(NOW + 7 * HOUR);
+    TEST_ASSERT_EQUAL(3, BackgroundWork::run(3.95f));
+    TEST_ASSERT_EQUAL(static_cast<int>(PowerBudget::CHARGING), static_cast<int>(BackgroundWork::getBudget()));
+
+    // Low: nothing runs, however overdue
+    setClock(NOW + 30 * 24 * HOUR);
+    TEST_ASSERT_EQUAL(0, BackgroundWork::run(3.70f));
+    TEST_ASSERT_EQUAL(static_cast<int>(PowerBudget::LOW_BATTERY), static_cast<int>(BackgroundWork::getBudget()));
+
+    // Without a clock the intervals mean nothing
+    HostClock::setWallClockSynced(false);
+    TEST_ASSERT_EQUAL(0, BackgroundWork::run(4.10f));
+}
+
+void test_registering_again_replaces_the_task(void) {
+    BackgroundWork::add("task", WorkCost::LIGHT, HOUR, light);
+    BackgroundWork::add("task", WorkCost::LIGHT, HOUR, heavy);
+    TEST_ASSERT_EQUAL(1, BackgroundWork::run(3.90f));
+    TEST_ASSERT_EQUAL(0, lightRuns);
+    TEST_ASSERT_EQUAL(1, heavyRuns);
+
+    for (size_t i = 1; i < BackgroundWork::MAX_TASKS; i++) {
+        static char names[BackgroundWork::MAX_TASKS][8];
+        snprintf(names[i], sizeof(names[i]), "t%u", static_cast<unsigned>(i));
+        TEST_ASSERT_TRUE(BackgroundWork::add(names[i], WorkCost::LIGHT, HOUR, light));
+    }
+    TEST_ASSERT_FALSE(BackgroundWork::add("one more", WorkCost::LIGHT, HOUR, light));
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+
+    UNITY_BEGIN();
+    RUN_TEST(test_budget_follows_the_voltage_trend);
+    RUN_TEST(test_one_off_rise_does_not_latch_charging);
+    RUN_TEST(test_heavy_work_waits_longer_on_battery);
+    RUN_TEST(test_runs_due_tasks_by_budget);
+    RUN_TEST(test_registering_again_replaces_the_task);
+    return UNITY_END();
+}
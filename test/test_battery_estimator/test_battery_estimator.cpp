@@ -0,0 +1,81 @@
+#include <unity.h>
+#include "BatteryEstimator.h"
+
+static WakeReport makeWake(uint64_t awakeSeconds, uint64_t sleepSeconds, uint64_t radioSeconds,
+                           uint32_t refreshMs) {
+    WakeReport report;
+    report.awakeMicros = awakeSeconds * 1000000ULL;
+    report.sleepMicros = sleepSeconds * 1000000ULL;
+    report.radioOnMicros = radioSeconds * 1000000ULL;
+    report.slept = true;
+    report.httpRequests = 2;
+    report.panel.fullRefreshes = 1;
+    report.panel.fullRefreshes3Bit = 1;
+    report.panel.refreshMs = refreshMs;
+    return report;
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_hourly_wakes_scale_to_per_day_figures(void) {
+    // 24 wakes of 36 s awake + 3564 s asleep = exactly one day
+    std::vector<WakeReport> reports(24, makeWake(36, 3564, 30, 1800));
+    PowerProfile profile;
+
+    BatteryEstimate estimate = BatteryEstimator::estimate(reports, profile);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-9, 1.0, estimate.days);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-9, 24.0, estimate.wakesPerDay);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-9, 24.0, estimate.fullRefreshesPerDay);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-9, 48.0, estimate.httpRequestsPerDay);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-9, 720.0, estimate.radioSecondsPerDay);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-9, 43.2, estimate.panelSecondsPerDay);
+}
+
+void test_average_current_is_charge_weighted_by_phase(void) {
+    std::vector<WakeReport> reports(24, makeWake(36, 3564, 30, 1800));
+    PowerProfile profile;
+    profile.sleepUa = 20.0f;
+    profile.activeMa = 50.0f;
+    profile.radioMa = 100.0f;
+    profile.panelMa = 80.0f;
+    profile.batteryMah = 2400.0f;
+    profile.usableFraction = 1.0f;
+
+    BatteryEstimate estimate = BatteryEstimator::estimate(reports, profile);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-6, 0.020 * 3564.0 / 3600.0, estimate.sleepMa);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-6, 50.0 * 36.0 / 3600.0, estimate.activeMa);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-6, 100.0 * 30.0 / 3600.0, estimate.radioMa);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-6, 80.0 * 1.8 / 3600.0, estimate.panelMa);
+
+    double average = estimate.sleepMa + estimate.activeMa + estimate.radioMa + estimate.panelMa;
+    TEST_ASSERT_DOUBLE_WITHIN(1e-9, average, estimate.averageMa);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-6, 2400.0 / average / 24.0, estimate.lifeDays);
+}
+
+void test_shorter_interval_shortens_life(void) {
+    PowerProfile profile;
+    std::vector<WakeReport> hourly(24, makeWake(36, 3564, 30, 1800));
+    std::vector<WakeReport> quarterly(96, makeWake(36, 864, 30, 1800));
+
+    TEST_ASSERT_TRUE(BatteryEstimator::estimate(quarterly, profile).lifeDays <
+                     BatteryEstimator::estimate(hourly, profile).lifeDays);
+}
+
+void test_empty_run_estimates_nothing(void) {
+    BatteryEstimate estimate = BatteryEstimator::estimate(std::vector<WakeReport>(), PowerProfile());
+    TEST_ASSERT_DOUBLE_WITHIN(1e-9, 0.0, estimate.days);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-9, 0.0, estimate.lifeDays);
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+
+    UNITY_BEGIN();
+    RUN_TEST(test_hourly_wakes_scale_to_per_day_figures);
+    RUN_TEST(test_average_current_is_charge_weighted_by_phase);
+    RUN_TEST(test_shorter_interval_shortens_life);
+    RUN_TEST(test_empty_run_estimates_nothing);
+    return UNITY_END();
+}
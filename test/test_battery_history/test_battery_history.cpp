@@ -0,0 +1,142 @@
+#include <unity.h>
+#include <vector>
+#include "core/BatteryHistory.h"
+#include "core/Storage.h"
+#include "managers/BatteryManager.h"
+#include "SPIFFS.h"
+
+static const uint32_t START = 1704067200;  // 2024-01-01
+
+void setUp(void) {
+    Storage::reset();
+    SPIFFS.clearFiles();
+    TEST_ASSERT_TRUE(Storage::begin());
+    BatteryHistory::reset();
+}
+
+void tearDown(void) {}
+
+void test_samples_round_trip_through_the_deltas(void) {
+    // Before the clock is set nothing is sampled, but the charge is kept
+    TEST_ASSERT_FALSE(BatteryHistory::record(1000, 4100, 300));
+    TEST_ASSERT_TRUE(BatteryHistory::record(START, 4100, 300));
+    // Too soon after the last sample: charge accumulates
+    TEST_ASSERT_FALSE(BatteryHistory::record(START + 3600, 4095, 400));
+    TEST_ASSERT_TRUE(BatteryHistory::record(START + 7230, 4090, 400));
+    TEST_ASSERT_TRUE(BatteryHistory::record(START + 14430, 4112, 250));
+
+    std::vector<BatterySample> samples;
+    BatteryHistory::getSamples(samples);
+    TEST_ASSERT_EQUAL(3, samples.size());
+    TEST_ASSERT_EQUAL(START, samples[0].epoch);
+    TEST_ASSERT_EQUAL(4100, samples[0].millivolts);
+    // Whole minutes
+    TEST_ASSERT_EQUAL(START + 7200, samples[1].epoch);
+    TEST_ASSERT_EQUAL(4090, samples[1].millivolts);
+    TEST_ASSERT_EQUAL(800, samples[1].wakeMicroAh);
+    TEST_ASSERT_EQUAL(START + 14400, samples[2].epoch);
+    TEST_ASSERT_EQUAL(4112, samples[2].millivolts);
+    TEST_ASSERT_EQUAL(250, samples[2].wakeMicroAh);
+    // Small deltas take a few bytes each
+    TEST_ASSERT_TRUE(BatteryHistory::getUsedBytes() <= 8);
+}
+
+void test_weeks_fit_and_the_oldest_samples_go_first(void) {
+    // Three weeks of two-hourly samples, slowly discharging
+    uint32_t epoch = START;
+    int samples = 21 * 12;
+    for (int i = 0; i < samples; i++) {
+        BatteryHistory::record(epoch, static_cast<uint16_t>(4150 - i * 2), 750);
+        epoch += BatteryHistory::SAMPLE_INTERVAL_S;
+    }
+
+    std::vector<BatterySample> kept;
+    BatteryHistory::getSamples(kept);
+    TEST_ASSERT_TRUE(BatteryHistory::getUsedBytes() <= BatteryHistory::CAPACITY);
+    // At least two weeks
+    TEST_ASSERT_TRUE(kept.back().epoch - kept.front().epoch >= 14 * 86400);
+    TEST_ASSERT_EQUAL(epoch - BatteryHistory::SAMPLE_INTERVAL_S, kept.back().epoch);
+    TEST_ASSERT_EQUAL(4150 - (samples - 1) * 2, kept.back().millivolts);
+    // The base moved forward with the dropped samples
+    int dropped = samples - static_cast<int>(kept.size());
+    TEST_ASSERT_TRUE(dropped > 0);
+    TEST_ASSERT_EQUAL(START + dropped * BatteryHistory::SAMPLE_INTERVAL_S, kept.front().epoch);
+    TEST_ASSERT_EQUAL(4150 - dropped * 2, kept.front().millivolts);
+}
+
+void test_forecast_uses_the_discharge_since_the_last_charge(void) {
+    // Discharging, then charged, then discharging again at 0.2 V/day from 4.0 V
+    uint32_t epoch = START;
+    for (int i = 0; i < 12; i++, epoch += 7200) BatteryHistory::record(epoch, 3800, 750);
+    BatteryForecast early = BatteryHistory::getForecast();
+    TEST_ASSERT_FALSE(early.valid);
+
+    for (int i = 0; i < 12; i++, epoch += 7200) {
+        BatteryHistory::record(epoch, static_cast<uint16_t>(4000 - i * 17), 750);
+    }
+    BatteryForecast outlook = BatteryHistory::getForecast();
+    TEST_ASSERT_TRUE(outlook.valid);
+    TEST_ASSERT_EQUAL(BatteryManager::percentageForVoltage(4.0f - 11 * 0.017f), outlook.percent);
+    TEST_ASSERT_TRUE(outlook.percentPerDay > 10 && outlook.percentPerDay < 200);
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, outlook.percent / outlook.percentPerDay * 24, outlook.hoursLeft);
+    // 750 uAh every two hours
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 9.0f, outlook.wakeMahPerDay);
+}
+
+void test_history_survives_power_loss_through_flash(void) {
+    uint32_t epoch = START;
+    for (int i = 0; i < BatteryHistory::SPILL_EVERY + 1; i++, epoch += 7200) {
+        BatteryHistory::record(epoch, static_cast<uint16_t>(4100 - i), 500);
+    }
+    TEST_ASSERT_TRUE(Storage::exists(StorageUse::LOGS, BatteryHistory::FILE_NAME));
+
+    // RTC memory lost: the next record reads the spilled copy back
+    BatteryHistory::reset();
+    BatteryHistory::record(epoch, 4000, 500);
+    std::vector<BatterySample> samples;
+    BatteryHistory::getSamples(samples);
+    TEST_ASSERT_EQUAL(BatteryHistory::SPILL_EVERY + 2, samples.size());
+    TEST_ASSERT_EQUAL(START, samples[0].epoch);
+    TEST_ASSERT_EQUAL(4000, samples.back().millivolts);
+
+    // A damaged copy is ignored
+    fs::File file = Storage::open(StorageUse::LOGS, BatteryHistory::FILE_NAME, "w");
+    file.write(reinterpret_cast<const uint8_t*>("junk"), 4);
+    file.close();
+    BatteryHistory::reset();
+    TEST_ASSERT_FALSE(BatteryHistory::restore());
+    BatteryHistory::getSamples(samples);
+    TEST_ASSERT_EQUAL(0, samples.size());
+}
+
+void test_log_quota_never_evicts_the_history(void) {
+    TEST_ASSERT_TRUE(Storage::configure(StorageUse::LOGS, StorageBackend::INTERNAL, 1024));
+    TEST_ASSERT_TRUE(BatteryHistory::record(START, 4100, 500));
+    TEST_ASSERT_TRUE(BatteryHistory::spill());
+    TEST_ASSERT_EQUAL(0, Storage::getUsedBytes(StorageUse::LOGS));
+
+    // Traces filling the quota make room among themselves
+    TEST_ASSERT_TRUE(Storage::reserve(StorageUse::LOGS, 1024));
+    fs::File file = Storage::open(StorageUse::LOGS, "/trace.bin", "w");
+    file.write(reinterpret_cast<const uint8_t*>("trace"), 5);
+    file.close();
+    Storage::recordWrite(StorageUse::LOGS, "/trace.bin", 1024);
+    TEST_ASSERT_EQUAL(1, Storage::trim(StorageUse::LOGS, 0));
+    TEST_ASSERT_TRUE(Storage::exists(StorageUse::LOGS, BatteryHistory::FILE_NAME));
+
+    BatteryHistory::reset();
+    TEST_ASSERT_TRUE(BatteryHistory::restore());
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+
+    UNITY_BEGIN();
+    RUN_TEST(test_samples_round_trip_through_the_deltas);
+    RUN_TEST(test_weeks_fit_and_the_oldest_samples_go_first);
+    RUN_TEST(test_forecast_uses_the_discharge_since_the_last_charge);
+    RUN_TEST(test_history_survives_power_loss_through_flash);
+    RUN_TEST(test_log_quota_never_evicts_the_history);
+    return UNITY_END();
+}
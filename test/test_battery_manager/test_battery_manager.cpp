@@ -0,0 +1,118 @@
+#include <unity.h>
+#include "HostClock.h"
+#include "core/WakeMetrics.h"
+#include "managers/BatteryManager.h"
+#include "widgets/battery/BatteryWidget.h"
+
+static Inkplate* panel = nullptr;
+
+void setUp(void) {
+    HostClock::setVirtual(true);
+    HostClock::setMicros(1000000);
+    panel = new Inkplate(INKPLATE_3BIT);
+    panel->begin();
+    BatteryManager::invalidate();
+}
+
+void tearDown(void) {
+    delete panel;
+    panel = nullptr;
+}
+
+void test_discharge_curve_is_not_linear(void) {
+    TEST_ASSERT_EQUAL(0, BatteryManager::percentageForVoltage(3.0f));
+    TEST_ASSERT_EQUAL(0, BatteryManager::percentageForVoltage(3.2f));
+    TEST_ASSERT_EQUAL(50, BatteryManager::percentageForVoltage(3.87f));
+    TEST_ASSERT_EQUAL(100, BatteryManager::percentageForVoltage(4.2f));
+    TEST_ASSERT_EQUAL(100, BatteryManager::percentageForVoltage(4.3f));
+    // Halfway between two points
+    int halfway = BatteryManager::percentageForVoltage(3.895f);
+    TEST_ASSERT_TRUE(halfway == 54 || halfway == 55);
+    // The steep knee at the bottom: 0.25 V covers only 5 %
+    TEST_ASSERT_EQUAL(5, BatteryManager::percentageForVoltage(3.45f));
+
+    int previous = 0;
+    for (float v = 3.0f; v <= 4.3f; v += 0.01f) {
+        int percent = BatteryManager::percentageForVoltage(v);
+        TEST_ASSERT_TRUE(percent >= previous);
+        previous = percent;
+    }
+}
+
+void test_median_drops_outliers(void) {
+    float samples[] = {3.85f, 3.20f, 3.86f, 3.84f, 4.10f};
+    TEST_ASSERT_EQUAL_FLOAT(3.85f, BatteryManager::median(samples, 5));
+    float pair[] = {3.9f, 3.7f};
+    TEST_ASSERT_EQUAL_FLOAT(3.8f, BatteryManager::median(pair, 2));
+}
+
+void test_hysteresis_holds_small_moves(void) {
+    TEST_ASSERT_EQUAL(50, BatteryManager::applyHysteresis(50, 52));
+    TEST_ASSERT_EQUAL(50, BatteryManager::applyHysteresis(50, 48));
+    TEST_ASSERT_EQUAL(53, BatteryManager::applyHysteresis(50, 53));
+    TEST_ASSERT_EQUAL(47, BatteryManager::applyHysteresis(50, 47));
+    // Empty and full are never held back
+    TEST_ASSERT_EQUAL(100, BatteryManager::applyHysteresis(98, 100));
+    TEST_ASSERT_EQUAL(0, BatteryManager::applyHysteresis(2, 0));
+}
+
+void test_one_filtered_reading_is_shared(void) {
+    // One reading spikes low, as if taken during a WiFi burst
+    panel->queueBatteryReading(3.87);
+    panel->queueBatteryReading(3.40);
+    panel->queueBatteryReading(3.87);
+    panel->queueBatteryReading(3.88);
+    panel->queueBatteryReading(3.86);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 3.87f, BatteryManager::getVoltage(*panel));
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 3.87f, WakeMetrics::getBatteryVolts());
+    // All samples with the divider switched on once, and off again after
+    TEST_ASSERT_EQUAL(1, panel->getDividerSwitches());
+    TEST_ASSERT_EQUAL(0, analogReadMilliVolts(35));
+
+    // Cached: later readings are not taken until the reading ages out
+    panel->setBatteryVoltage(4.2);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 3.87f, BatteryManager::getVoltage(*panel));
+    HostClock::advanceMillis(BatteryManager::MAX_AGE_MS);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 4.2f, BatteryManager::getVoltage(*panel));
+    TEST_ASSERT_EQUAL(100, BatteryManager::getPercentage(*panel));
+
+    // A small drop keeps the shown level; a larger one moves it
+    BatteryManager::invalidate();
+    panel->setBatteryVoltage(4.19);
+    TEST_ASSERT_EQUAL(100, BatteryManager::getPercentage(*panel));
+    BatteryManager::invalidate();
+    panel->setBatteryVoltage(4.12);
+    TEST_ASSERT_EQUAL(91, BatteryManager::getPercentage(*panel));
+}
+
+void test_widget_skips_renders_that_would_not_change(void) {
+    panel->setBatteryVoltage(3.87);
+    BatteryWidget widget(*panel, 60000);
+    widget.begin();
+    LayoutRegion region(0, 0, 200, 200);
+    TEST_ASSERT_TRUE(widget.shouldUpdate());
+    widget.render(region);
+
+    // Due, same reading: nothing to draw
+    HostClock::setMicros(HostClock::micros() + 61000000ULL);
+    BatteryManager::invalidate();
+    TEST_ASSERT_FALSE(widget.shouldUpdate());
+
+    HostClock::setMicros(HostClock::micros() + 61000000ULL);
+    BatteryManager::invalidate();
+    panel->setBatteryVoltage(3.70);
+    TEST_ASSERT_TRUE(widget.shouldUpdate());
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+
+    UNITY_BEGIN();
+    RUN_TEST(test_discharge_curve_is_not_linear);
+    RUN_TEST(test_median_drops_outliers);
+    RUN_TEST(test_hysteresis_holds_small_moves);
+    RUN_TEST(test_one_filtered_reading_is_shared);
+    RUN_TEST(test_widget_skips_renders_that_would_not_change);
+    return UNITY_END();
+}
@@ -0,0 +1,459 @@
+#include <unity.h>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include "HostClock.h"
+#include "HostTransport.h"
+#include "HTTPClient.h"
+#include "SPIFFS.h"
+#include "WiFi.h"
+#include "core/Storage.h"
+#include "widgets/calendar/CalendarWidget.h"
+#include "widgets/calendar/IcsParser.h"
+
+// 2024-01-15 08:00 UTC, a Monday
+static const uint32_t NOW = 1705305600;
+static const uint32_t DAY = 86400;
+
+static Inkplate* panel = nullptr;
+
+static const char* FEED =
+    "BEGIN:VCALENDAR\r\n"
+    "VERSION:2.0\r\n"
+    "BEGIN:VEVENT\r\n"
+    "DTSTART:20240116T090000Z\r\n"
+    "DTEND:20240116T100000Z\r\n"
+    "SUMMARY:Design review\\, room 4\r\n"
+    "BEGIN:VALARM\r\n"
+    "TRIGGER:-PT15M\r\n"
+    "SUMMARY:Alarm text\r\n"
+    "END:VALARM\r\n"
+    "END:VEVENT\r\n"
+    "BEGIN:VEVENT\r\n"
+    "DTSTART;VALUE=DATE:20240117\r\n"
+    "DTEND;VALUE=DATE:20240118\r\n"
+    "SUMMARY:A summary folded over\r\n"
+    "  two lines\r\n"
+    "END:VEVENT\r\n"
+    "BEGIN:VEVENT\r\n"
+    "DTSTART:20240115T070000Z\r\n"
+    "DURATION:PT2H\r\n"
+    "SUMMARY:Already running\r\n"
+    "END:VEVENT\r\n"
+    "BEGIN:VEVENT\r\n"
+    "DTSTART:20240115T120000Z\r\n"
+    "DTEND:20240115T130000Z\r\n"
+    "STATUS:CANCELLED\r\n"
+    "SUMMARY:Cancelled lunch\r\n"
+    "END:VEVENT\r\n"
+    "BEGIN:VEVENT\r\n"
+    "DTSTART:20240114T090000Z\r\n"
+    "DTEND:20240114T100000Z\r\n"
+    "SUMMARY:Yesterday\r\n"
+    "END:VEVENT\r\n"
+    "BEGIN:VEVENT\r\n"
+    "DTSTART:20240301T090000Z\r\n"
+    "DTEND:20240301T100000Z\r\n"
+    "SUMMARY:Far away\r\n"
+    "END:VEVENT\r\n"
+    "END:VCALENDAR\r\n";
+
+static void parse(IcsParser& parser, const char* text, size_t step) {
+    size_t length = strlen(text);
+    for (size_t at = 0; at < length; at += step) {
+        parser.feed(text + at, std::min(step, length - at));
+    }
+    parser.finish();
+}
+
+/**
+ * Calendar server: answers with FEED and an ETag, or 304 when the request
+ * carries that ETag back.
+ */
+class IcsServer : public HostTransport {
+public:
+    std::string body = FEED;
+    std::string etag = "\"v1\"";
+    std::string lastHeaders;
+    int requests = 0;
+
+    HostResponse handle(const HostRequest& request) override {
+        requests++;
+        lastHeaders = request.headers;
+        HostResponse response;
+        response.latencyMs = 50;
+        if (request.headers.find("If-None-Match: " + etag) != std::string::npos) {
+            response.status = 304;
+            return response;
+        }
+        response.status = 200;
+        response.body = body;
+        response.headers = "ETag: " + etag + "\nLast-Modified: Mon, 15 Jan 2024 07:00:00 GMT\n";
+        return response;
+    }
+};
+
+static void setClock(uint32_t epoch) {
+    HostClock::setWallClockSynced(true);
+    HostClock::setBootEpochMicros(static_cast<uint64_t>(epoch) * 1000000ULL - HostClock::micros());
+}
+
+void setUp(void) {
+    HostClock::setVirtual(true);
+    HostClock::setMicros(1000000);
+    setenv("TZ", "UTC0", 1);
+    tzset();
+    setClock(NOW);
+    Storage::reset();
+    SPIFFS.clearFiles();
+    TEST_ASSERT_TRUE(Storage::begin());
+    WiFi.setConnectDelayMs(0);
+    WiFi.setNetworkAvailable(true);
+    WiFi.begin("host-network", "password");
+    panel = new Inkplate(INKPLATE_3BIT);
+    panel->begin();
+}
+
+void tearDown(void) {
+    WiFi.disconnect(true);
+    HTTPClient::setTransport(nullptr);
+    delete panel;
+    panel = nullptr;
+}
+
+void test_times_and_durations(void) {
+    uint32_t epoch = 0;
+    bool allDay = true;
+    TEST_ASSERT_TRUE(IcsParser::parseTime("20240115T080000Z", false, epoch, allDay));
+    TEST_ASSERT_EQUAL_UINT32(NOW, epoch);
+    TEST_ASSERT_FALSE(allDay);
+    TEST_ASSERT_TRUE(IcsParser::parseTime("20240115", false, epoch, allDay));
+    TEST_ASSERT_EQUAL_UINT32(NOW - 8 * 3600, epoch);
+    TEST_ASSERT_TRUE(allDay);
+    TEST_ASSERT_FALSE(IcsParser::parseTime("2024-01-15", false, epoch, allDay));
+
+    TEST_ASSERT_EQUAL_UINT32(5400, IcsParser::parseDuration("PT1H30M"));
+    TEST_ASSERT_EQUAL_UINT32(DAY + 7200, IcsParser::parseDuration("P1DT2H"));
+    TEST_ASSERT_EQUAL_UINT32(2 * 7 * DAY, IcsParser::parseDuration("P2W"));
+    TEST_ASSERT_EQUAL_UINT32(0, IcsParser::parseDuration("garbage"));
+}
+
+void test_keeps_upcoming_events_in_order(void) {
+    IcsParser parser(NOW, NOW + 7 * DAY, 5);
+    parse(parser, FEED, strlen(FEED));
+
+    TEST_ASSERT_EQUAL(6, parser.getEventsRead());
+    TEST_ASSERT_EQUAL(3, parser.getCount());
+    // Started an hour ago, still running
+    TEST_ASSERT_EQUAL_STRING("Already running", parser.getEvent(0).summary);
+    TEST_ASSERT_EQUAL_UINT32(NOW + 3600, parser.getEvent(0).end);
+    // The alarm's summary does not replace the event's; escapes are undone
+    TEST_ASSERT_EQUAL_STRING("Design review, room 4", parser.getEvent(1).summary);
+    TEST_ASSERT_EQUAL_UINT32(NOW + DAY + 3600, parser.getEvent(1).start);
+    TEST_ASSERT_EQUAL_STRING("A summary folded over two lines", parser.getEvent(2).summary);
+    TEST_ASSERT_TRUE(parser.getEvent(2).allDay);
+    TEST_ASSERT_EQUAL_UINT32(DAY, parser.getEvent(2).end - parser.getEvent(2).start);
+
+    // Only room for two: the soonest stay
+    IcsParser small(NOW, NOW + 7 * DAY, 2);
+    parse(small, FEED, strlen(FEED));
+    TEST_ASSERT_EQUAL(2, small.getCount());
+    TEST_ASSERT_EQUAL_STRING("Already running", small.getEvent(0).summary);
+    TEST_ASSERT_EQUAL_STRING("Design review, room 4", small.getEvent(1).summary);
+}
+
+void test_chunk_size_does_not_matter(void) {
+    IcsParser whole(NOW, NOW + 7 * DAY, 5);
+    parse(whole, FEED, strlen(FEED));
+    IcsParser bytes(NOW, NOW + 7 * DAY, 5);
+    parse(bytes, FEED, 1);
+    // Line feeds only, no final line break
+    std::string bare = FEED;
+    for (size_t at; (at = bare.find('\r')) != std::string::npos;) bare.erase(at, 1);
+    bare.pop_back();
+    IcsParser stripped(NOW, NOW + 7 * DAY, 5);
+    parse(stripped, bare.c_str(), 7);
+
+    TEST_ASSERT_EQUAL(whole.getCount(), bytes.getCount());
+    TEST_ASSERT_EQUAL(whole.getCount(), stripped.getCount());
+    for (size_t i = 0; i < whole.getCount(); i++) {
+        TEST_ASSERT_EQUAL_MEMORY(&whole.getEvent(i), &bytes.getEvent(i), sizeof(CalendarEvent));
+        TEST_ASSERT_EQUAL_MEMORY(&whole.getEvent(i), &stripped.getEvent(i), sizeof(CalendarEvent));
+    }
+}
+
+void test_weekly_rule_expands_into_window(void) {
+    const char* feed =
+        "BEGIN:VEVENT\n"
+        "DTSTART:20231204T170000Z\n"
+        "DTEND:20231204T180000Z\n"
+        "RRULE:FREQ=WEEKLY;INTERVAL=2;COUNT=5\n"
+        "SUMMARY:Fortnightly\n"
+        "END:VEVENT\n"
+        "BEGIN:VEVENT\n"
+        "DTSTART:20240101T120000Z\n"
+        "DURATION:PT30M\n"
+        "RRULE:FREQ=DAILY;UNTIL=20240117T235959Z\n"
+        "SUMMARY:Daily\n"
+        "END:VEVENT\n";
+    IcsParser parser(NOW, NOW + 28 * DAY, 16);
+    parse(parser, feed, strlen(feed));
+
+    // Fortnightly from Dec 4: Jan 15 and Jan 29 are left of its five
+    // Daily until the 17th: the 15th, 16th and 17th at noon
+    TEST_ASSERT_EQUAL(5, parser.getCount());
+    TEST_ASSERT_EQUAL_STRING("Daily", parser.getEvent(0).summary);
+    TEST_ASSERT_EQUAL_UINT32(NOW + 4 * 3600, parser.getEvent(0).start);
+    TEST_ASSERT_EQUAL_STRING("Fortnightly", parser.getEvent(1).summary);
+    TEST_ASSERT_EQUAL_UINT32(NOW + 9 * 3600, parser.getEvent(1).start);
+    TEST_ASSERT_EQUAL_UINT32(NOW + 2 * DAY + 4 * 3600, parser.getEvent(3).start);
+    TEST_ASSERT_EQUAL_UINT32(NOW + 14 * DAY + 9 * 3600, parser.getEvent(4).start);
+}
+
+void test_google_feed_with_exceptions(void) {
+    // As exported by Google Calendar: a VTIMEZONE, BYDAY on weekly rules,
+    // an EXDATE and overrides before and after their series
+    const char* feed =
+        "BEGIN:VCALENDAR\r\n"
+        "PRODID:-//Google Inc//Google Calendar 70.9054//EN\r\n"
+        "VERSION:2.0\r\n"
+        "X-WR-TIMEZONE:Europe/London\r\n"
+        "BEGIN:VTIMEZONE\r\n"
+        "TZID:Europe/London\r\n"
+        "BEGIN:DAYLIGHT\r\n"
+        "TZOFFSETFROM:+0000\r\n"
+        "TZOFFSETTO:+0100\r\n"
+        "DTSTART:19700329T010000\r\n"
+        "RRULE:FREQ=YEARLY;BYMONTH=3;BYDAY=-1SU\r\n"
+        "END:DAYLIGHT\r\n"
+        "END:VTIMEZONE\r\n"
+        "BEGIN:VEVENT\r\n"
+        "DTSTART;TZID=Europe/London:20240108T093000\r\n"
+        "DTEND;TZID=Europe/London:20240108T094500\r\n"
+        "RRULE:FREQ=WEEKLY;BYDAY=MO\r\n"
+        "EXDATE;TZID=Europe/London:20240122T093000\r\n"
+        "UID:standup@google.com\r\n"
+        "SUMMARY:Standup\r\n"
+        "END:VEVENT\r\n"
+        "BEGIN:VEVENT\r\n"
+        "DTSTART;TZID=Europe/London:20240117T140000\r\n"
+        "DTEND;TZID=Europe/London:20240117T150000\r\n"
+        "UID:sync@google.com\r\n"
+        "RECURRENCE-ID;TZID=Europe/London:20240116T100000\r\n"
+        "SEQUENCE:1\r\n"
+        "SUMMARY:Sync (moved)\r\n"
+        "END:VEVENT\r\n"
+        "BEGIN:VEVENT\r\n"
+        "DTSTART;TZID=Europe/London:20240102T100000\r\n"
+        "DTEND;TZID=Europe/London:20240102T110000\r\n"
+        "RRULE:FREQ=WEEKLY;WKST=MO;BYDAY=TU,TH\r\n"
+        "UID:sync@google.com\r\n"
+        "SUMMARY:Sync\r\n"
+        "END:VEVENT\r\n"
+        "BEGIN:VEVENT\r\n"
+        "DTSTART;TZID=Europe/London:20240123T100000\r\n"
+        "DTEND;TZID=Europe/London:20240123T110000\r\n"
+        "UID:sync@google.com\r\n"
+        "RECURRENCE-ID;TZID=Europe/London:20240123T100000\r\n"
+        "STATUS:CANCELLED\r\n"
+        "SUMMARY:Sync\r\n"
+        "END:VEVENT\r\n"
+        "BEGIN:VEVENT\r\n"
+        "DTSTART:20240115T120000Z\r\n"
+        "DURATION:PT1H\r\n"
+        "RRULE:FREQ=DAILY;UNTIL=20240117T235959Z;BYDAY=MO,WE\r\n"
+        "UID:lunch@google.com\r\n"
+        "SUMMARY:Lunch\r\n"
+        "END:VEVENT\r\n"
+        "END:VCALENDAR\r\n";
+    IcsParser parser(NOW, NOW + 14 * DAY, 16);
+    parse(parser, feed, 7);
+
+    // Standup: the 22nd is excluded and the 29th starts after the window.
+    // Sync: the 16th moved to the 17th and the 23rd was cancelled.
+    TEST_ASSERT_EQUAL(6, parser.getCount());
+    TEST_ASSERT_EQUAL_STRING("Standup", parser.getEvent(0).summary);
+    TEST_ASSERT_EQUAL_UINT32(NOW + 5400, parser.getEvent(0).start);
+    TEST_ASSERT_EQUAL_STRING("Lunch", parser.getEvent(1).summary);
+    TEST_ASSERT_EQUAL_UINT32(NOW + 4 * 3600, parser.getEvent(1).start);
+    TEST_ASSERT_EQUAL_STRING("Lunch", parser.getEvent(2).summary);
+    TEST_ASSERT_EQUAL_UINT32(NOW + 2 * DAY + 4 * 3600, parser.getEvent(2).start);
+    TEST_ASSERT_EQUAL_STRING("Sync (moved)", parser.getEvent(3).summary);
+    TEST_ASSERT_EQUAL_UINT32(NOW + 2 * DAY + 6 * 3600, parser.getEvent(3).start);
+    TEST_ASSERT_EQUAL_STRING("Sync", parser.getEvent(4).summary);
+    TEST_ASSERT_EQUAL_UINT32(NOW + 3 * DAY + 2 * 3600, parser.getEvent(4).start);
+    TEST_ASSERT_EQUAL_STRING("Sync", parser.getEvent(5).summary);
+    TEST_ASSERT_EQUAL_UINT32(NOW + 10 * DAY + 2 * 3600, parser.getEvent(5).start);
+}
+
+void test_weekday_rules_count_from_dtstart(void) {
+    // COUNT includes the weeks before the window; an ordinal BYDAY is monthly
+    const char* feed =
+        "BEGIN:VEVENT\n"
+        "DTSTART:20240103T170000Z\n"
+        "DURATION:PT1H\n"
+        "RRULE:FREQ=WEEKLY;BYDAY=MO,WE,FR;COUNT=7\n"
+        "SUMMARY:Gym\n"
+        "END:VEVENT\n"
+        "BEGIN:VEVENT\n"
+        "DTSTART:20231201T090000Z\n"
+        "DURATION:PT1H\n"
+        "RRULE:FREQ=MONTHLY;BYDAY=1FR\n"
+        "SUMMARY:Monthly\n"
+        "END:VEVENT\n";
+    IcsParser parser(NOW, NOW + 14 * DAY, 16);
+    parse(parser, feed, strlen(feed));
+
+    // Jan 3, 5, 8, 10, 12 are before the window; 15 and 17 are the last two
+    TEST_ASSERT_EQUAL(2, parser.getCount());
+    TEST_ASSERT_EQUAL_UINT32(NOW + 9 * 3600, parser.getEvent(0).start);
+    TEST_ASSERT_EQUAL_UINT32(NOW + 2 * DAY + 9 * 3600, parser.getEvent(1).start);
+}
+
+void test_widget_revalidates_with_etag(void) {
+    IcsServer server;
+    HTTPClient::setTransport(&server);
+
+    CalendarWidget first(*panel, "https://calendar.example.com/feed.ics", 2, 7, 1800000);
+    first.begin();
+    TEST_ASSERT_TRUE(first.refresh());
+    TEST_ASSERT_FALSE(first.wasNotModified());
+    TEST_ASSERT_EQUAL(2, first.getEventCount());
+    TEST_ASSERT_EQUAL_STRING("Already running", first.getEvent(0).summary);
+    TEST_ASSERT_TRUE(server.lastHeaders.find("If-None-Match") == std::string::npos);
+
+    // Next wake: a new widget finds the cache and asks only whether it changed
+    HostClock::advanceMillis(2 * 3600 * 1000ULL);
+    CalendarWidget second(*panel, "https://calendar.example.com/feed.ics", 2, 7, 1800000);
+    second.begin();
+    TEST_ASSERT_TRUE(second.refresh());
+    TEST_ASSERT_TRUE(second.wasNotModified());
+    TEST_ASSERT_TRUE(server.lastHeaders.find("If-None-Match: \"v1\"") != std::string::npos);
+    TEST_ASSERT_TRUE(server.lastHeaders.find("If-Modified-Since: Mon, 15 Jan 2024") != std::string::npos);
+    // The running event ended meanwhile
+    TEST_ASSERT_EQUAL(2, second.getEventCount());
+    TEST_ASSERT_EQUAL_STRING("Design review, room 4", second.getEvent(0).summary);
+
+    // The feed changed: a full response replaces the cache
+    server.etag = "\"v2\"";
+    server.body = "BEGIN:VEVENT\r\nDTSTART:20240115T160000Z\r\nSUMMARY:New\r\nEND:VEVENT\r\n";
+    second.forceUpdate();
+    TEST_ASSERT_TRUE(second.refresh());
+    TEST_ASSERT_FALSE(second.wasNotModified());
+    TEST_ASSERT_EQUAL(1, second.getEventCount());
+    TEST_ASSERT_EQUAL_STRING("New", second.getEvent(0).summary);
+
+    // Offline: the cache is shown
+    server.etag = "\"v3\"";
+    WiFi.disconnect(true);
+    CalendarWidget offline(*panel, "https://calendar.example.com/feed.ics", 2, 7, 1800000);
+    TEST_ASSERT_FALSE(offline.refresh());
+    TEST_ASSERT_EQUAL(1, offline.getEventCount());
+    TEST_ASSERT_EQUAL(3, server.requests);
+}
+
+void test_widget_draws_cache_before_asking(void) {
+    IcsServer server;
+    HTTPClient::setTransport(&server);
+    LayoutRegion region(0, 0, 300, 300);
+
+    CalendarWidget first(*panel, "https://calendar.example.com/feed.ics", 3, 7, 1800000);
+    first.begin();
+    first.render(region);
+    TEST_ASSERT_EQUAL(1, server.requests);
+    TEST_ASSERT_FALSE(first.revalidate());
+
+    // Next wake: the cache covers the window, so the render does not wait for the server
+    HostClock::advanceMillis(2 * 3600 * 1000ULL);
+    CalendarWidget second(*panel, "https://calendar.example.com/feed.ics", 3, 7, 1800000);
+    second.begin();
+    second.render(region);
+    TEST_ASSERT_EQUAL(1, server.requests);
+    TEST_ASSERT_EQUAL(2, second.getEventCount());
+    // Not modified: nothing to redraw
+    TEST_ASSERT_FALSE(second.revalidate());
+    TEST_ASSERT_EQUAL(2, server.requests);
+    TEST_ASSERT_TRUE(second.wasNotModified());
+
+    server.etag = "\"v2\"";
+    server.body = "BEGIN:VEVENT\r\nDTSTART:20240115T160000Z\r\nSUMMARY:New\r\nEND:VEVENT\r\n";
+    CalendarWidget third(*panel, "https://calendar.example.com/feed.ics", 3, 7, 1800000);
+    third.begin();
+    third.render(region);
+    TEST_ASSERT_TRUE(third.revalidate());
+    TEST_ASSERT_EQUAL(3, server.requests);
+    TEST_ASSERT_EQUAL_STRING("New", third.getEvent(0).summary);
+}
+
+void test_widget_waits_for_clock(void) {
+    HostClock::setWallClockSynced(false);
+    CalendarWidget widget(*panel, "https://calendar.example.com/feed.ics", 5, 7, 14400000);
+    widget.begin();
+    LayoutRegion region(0, 0, 300, 300);
+    TEST_ASSERT_TRUE(widget.shouldUpdate());
+    widget.render(region);
+    TEST_ASSERT_EQUAL(0, widget.getEventCount());
+    TEST_ASSERT_FALSE(widget.shouldUpdate());
+
+    IcsServer server;
+    HTTPClient::setTransport(&server);
+    setClock(NOW);
+    TEST_ASSERT_TRUE(widget.shouldUpdate());
+    widget.render(region);
+    TEST_ASSERT_EQUAL(3, widget.getEventCount());
+    TEST_ASSERT_FALSE(widget.shouldUpdate());
+
+    // The running event ends: the list moves up without a fetch
+    HostClock::advanceMillis(3600 * 1000ULL);
+    TEST_ASSERT_TRUE(widget.shouldUpdate());
+    widget.render(region);
+    TEST_ASSERT_EQUAL(2, widget.getEventCount());
+    TEST_ASSERT_EQUAL(1, server.requests);
+}
+
+void test_widget_fetches_once_connected(void) {
+    IcsServer server;
+    HTTPClient::setTransport(&server);
+    LayoutRegion region(0, 0, 300, 300);
+
+    // Drawn before WiFi is up, with no clock yet either
+    HostClock::setWallClockSynced(false);
+    WiFi.disconnect(true);
+    CalendarWidget widget(*panel, "https://calendar.example.com/feed.ics", 5, 7, 14400000);
+    widget.begin();
+    widget.render(region);
+    TEST_ASSERT_EQUAL(0, widget.getEventCount());
+    TEST_ASSERT_FALSE(widget.revalidate());
+
+    // Clock set, still offline
+    setClock(NOW);
+    TEST_ASSERT_TRUE(widget.revalidate());
+    TEST_ASSERT_EQUAL(0, server.requests);
+
+    // Connected: the same wake's revalidation fetches
+    WiFi.begin("host-network", "password");
+    TEST_ASSERT_TRUE(widget.revalidate());
+    TEST_ASSERT_EQUAL(1, server.requests);
+    TEST_ASSERT_EQUAL(3, widget.getEventCount());
+    TEST_ASSERT_FALSE(widget.revalidate());
+    TEST_ASSERT_EQUAL(1, server.requests);
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+
+    UNITY_BEGIN();
+    RUN_TEST(test_times_and_durations);
+    RUN_TEST(test_keeps_upcoming_events_in_order);
+    RUN_TEST(test_chunk_size_does_not_matter);
+    RUN_TEST(test_weekly_rule_expands_into_window);
+    RUN_TEST(test_google_feed_with_exceptions);
+    RUN_TEST(test_weekday_rules_count_from_dtstart);
+    RUN_TEST(test_widget_revalidates_with_etag);
+    RUN_TEST(test_widget_draws_cache_before_asking);
+    RUN_TEST(test_widget_waits_for_clock);
+    RUN_TEST(test_widget_fetches_once_connected);
+    return UNITY_END();
+}
@@ -0,0 +1,155 @@
+#include <unity.h>
+#include <cmath>
+#include "HostClock.h"
+#include "core/Compositor.h"
+#include "widgets/chart/ChartWidget.h"
+#include "widgets/weather/HourlyForecast.h"
+
+// 2024-01-01 00:00 UTC, on an hour
+static const uint32_t START = 1704067200;
+
+static Inkplate* panel = nullptr;
+
+// 48 hours from START, temperatures 50..70, optionally one hour changed
+static void publishForecast(uint32_t first, int changedHour = -1, int changedRain = 0) {
+    JsonDocument doc;
+    JsonObject hourly = doc["hourly"].to<JsonObject>();
+    JsonArray times = hourly["time"].to<JsonArray>();
+    JsonArray temperatures = hourly["temperature_2m"].to<JsonArray>();
+    JsonArray rain = hourly["precipitation_probability"].to<JsonArray>();
+    for (int hour = 0; hour < 48; hour++) {
+        times.add(first + hour * 3600);
+        temperatures.add(60.0f + 9.0f * std::sin(hour * 0.26f));
+        rain.add(hour == changedHour ? changedRain : (hour * 7) % 50);
+    }
+    TEST_ASSERT_TRUE(HourlyForecast::publish(hourly));
+}
+
+static void setHour(uint32_t epoch) {
+    HostClock::setWallClockSynced(true);
+    HostClock::setBootEpochMicros(static_cast<uint64_t>(epoch) * 1000000ULL - HostClock::micros());
+}
+
+void setUp(void) {
+    HostClock::setVirtual(true);
+    HostClock::setMicros(1000000);
+    panel = new Inkplate(INKPLATE_3BIT);
+    panel->begin();
+    HourlyForecast::clear();
+    setHour(START);
+}
+
+void tearDown(void) {
+    delete panel;
+    panel = nullptr;
+}
+
+void test_forecast_keeps_consecutive_hours(void) {
+    JsonDocument doc;
+    deserializeJson(doc, "{\"hourly\":{\"time\":[1704067200,1704070800,1704074400,1704081600],"
+                         "\"temperature_2m\":[50.5,null,52,53],\"precipitation_probability\":[10,20,130,40]}}");
+    uint32_t revision = HourlyForecast::getRevision();
+    TEST_ASSERT_TRUE(HourlyForecast::publish(doc["hourly"].as<JsonObjectConst>()));
+    TEST_ASSERT_TRUE(HourlyForecast::getRevision() != revision);
+
+    // The gap after the third hour ends the series
+    TEST_ASSERT_EQUAL(3, HourlyForecast::getCount());
+    TEST_ASSERT_EQUAL(1, HourlyForecast::find(START + 3600));
+    TEST_ASSERT_EQUAL(-1, HourlyForecast::find(START + 4 * 3600));
+    TEST_ASSERT_EQUAL(-1, HourlyForecast::find(START + 60));
+    TEST_ASSERT_EQUAL_FLOAT(50.5f, HourlyForecast::getTemperature(0));
+    TEST_ASSERT_TRUE(std::isnan(HourlyForecast::getTemperature(1)));
+    TEST_ASSERT_EQUAL(100, HourlyForecast::getPrecipitation(2));
+
+    // Without times (the old request) nothing is kept
+    deserializeJson(doc, "{\"hourly\":{\"precipitation_probability\":[10,20]}}");
+    TEST_ASSERT_FALSE(HourlyForecast::publish(doc["hourly"].as<JsonObjectConst>()));
+    TEST_ASSERT_EQUAL(3, HourlyForecast::getCount());
+}
+
+void test_revised_hour_redraws_one_column(void) {
+    Compositor compositor(400, 200);
+    TEST_ASSERT_TRUE(compositor.initialize());
+    LayoutRegion region(0, 0, 400, 200);
+    ChartWidget chart(*panel, 24, 3600000);
+    publishForecast(START);
+    chart.renderToCompositor(compositor, region);
+    TEST_ASSERT_FALSE(chart.shouldUpdate());
+
+    // Rain for the fifth hour is revised
+    publishForecast(START, 4, 90);
+    TEST_ASSERT_TRUE(chart.shouldUpdate());
+    compositor.resetChangeTracking();
+    TEST_ASSERT_TRUE(chart.updateOnCompositor(compositor, region));
+    TEST_ASSERT_EQUAL(1, chart.getLastChangedColumns());
+    TEST_ASSERT_FALSE(chart.shouldUpdate());
+
+    // One column wide: (400 - 20 - 24) / 24 = 14 pixels
+    std::vector<LayoutRegion> changed = compositor.getChangedRegions();
+    TEST_ASSERT_EQUAL(1, changed.size());
+    TEST_ASSERT_EQUAL(10 + 24 + 4 * 14, changed[0].getX());
+    TEST_ASSERT_EQUAL(14, changed[0].getWidth());
+
+    // The same forecast again draws nothing
+    publishForecast(START, 4, 90);
+    compositor.resetChangeTracking();
+    TEST_ASSERT_TRUE(chart.updateOnCompositor(compositor, region));
+    TEST_ASSERT_EQUAL(0, chart.getLastChangedColumns());
+    TEST_ASSERT_FALSE(compositor.hasChangedRegions());
+}
+
+void test_next_hour_sweeps_instead_of_scrolling(void) {
+    Compositor compositor(400, 200);
+    TEST_ASSERT_TRUE(compositor.initialize());
+    LayoutRegion region(0, 0, 400, 200);
+    ChartWidget chart(*panel, 24, 3600000);
+    publishForecast(START);
+    chart.renderToCompositor(compositor, region);
+
+    // An hour later the column that went by shows the same hour tomorrow
+    setHour(START + 3600);
+    TEST_ASSERT_TRUE(chart.shouldUpdate());
+    compositor.resetChangeTracking();
+    TEST_ASSERT_TRUE(chart.updateOnCompositor(compositor, region));
+    TEST_ASSERT_TRUE(chart.getLastChangedColumns() <= 1);
+
+    // Column 0 and the hour mark moving from column 0 to 1
+    std::vector<LayoutRegion> changed = compositor.getChangedRegions();
+    TEST_ASSERT_TRUE(changed.size() >= 1);
+    for (const LayoutRegion& area : changed) {
+        TEST_ASSERT_TRUE(area.getX() >= 10 + 24);
+        TEST_ASSERT_TRUE(area.getX() + area.getWidth() <= 10 + 24 + 2 * 14);
+    }
+}
+
+void test_forecast_outside_the_scale_needs_a_full_render(void) {
+    Compositor compositor(400, 200);
+    TEST_ASSERT_TRUE(compositor.initialize());
+    LayoutRegion region(0, 0, 400, 200);
+    ChartWidget chart(*panel, 24, 3600000);
+    TEST_ASSERT_FALSE(chart.updateOnCompositor(compositor, region));
+    publishForecast(START);
+    chart.renderToCompositor(compositor, region);
+
+    JsonDocument doc;
+    deserializeJson(doc, "{\"hourly\":{\"time\":[1704067200],\"temperature_2m\":[95],"
+                         "\"precipitation_probability\":[0]}}");
+    HourlyForecast::publish(doc["hourly"].as<JsonObjectConst>());
+    TEST_ASSERT_FALSE(chart.updateOnCompositor(compositor, region));
+
+    // Nor can a region that moved be updated in place
+    chart.renderToCompositor(compositor, region);
+    TEST_ASSERT_FALSE(chart.updateOnCompositor(compositor, LayoutRegion(0, 10, 400, 190)));
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+
+    UNITY_BEGIN();
+    RUN_TEST(test_forecast_keeps_consecutive_hours);
+    RUN_TEST(test_revised_hour_redraws_one_column);
+    RUN_TEST(test_next_hour_sweeps_instead_of_scrolling);
+    RUN_TEST(test_forecast_outside_the_scale_needs_a_full_render);
+    return UNITY_END();
+}
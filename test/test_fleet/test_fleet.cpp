@@ -0,0 +1,112 @@
+#include <unity.h>
+#include <vector>
+#include "FleetServer.h"
+
+static const uint64_t START_MS = 1704067200000ULL;
+static const uint64_t SPAN_MS = 3600000ULL;
+
+static std::vector<uint8_t> memory;
+
+static FleetServer makeServer(const FleetServerModel& model) {
+    memory.assign(FleetServer::memorySize(SPAN_MS), 0xAA);
+    return FleetServer(memory.data(), START_MS, SPAN_MS, model);
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_idle_server_costs_round_trip_service_and_transfer(void) {
+    FleetServerModel model;
+    model.rttMs = 20;
+    model.serviceMs = 40;
+    model.bandwidthKbps = 20000;
+    FleetServer server = makeServer(model);
+
+    // 25 kB at 20 Mbit/s is 10 ms
+    TEST_ASSERT_EQUAL(70, server.request(START_MS + 1000, 25000));
+    TEST_ASSERT_EQUAL(60, server.request(START_MS + 60000, 0));
+    // Far apart requests never queue
+    TEST_ASSERT_EQUAL(70, server.request(START_MS + 120000, 25000));
+    TEST_ASSERT_EQUAL(3, server.getRequests());
+    TEST_ASSERT_EQUAL(50000, server.getResponseBytes());
+}
+
+void test_simultaneous_requests_queue_for_workers(void) {
+    FleetServerModel model;
+    model.workers = 1;
+    model.serviceMs = 100;
+    model.rttMs = 0;
+    model.bandwidthKbps = 0;
+    FleetServer server = makeServer(model);
+
+    std::vector<uint32_t> latencies;
+    for (int i = 0; i < 20; i++) {
+        latencies.push_back(server.request(START_MS + 5000, 0));
+    }
+    TEST_ASSERT_EQUAL(100, latencies[0]);
+    for (size_t i = 1; i < latencies.size(); i++) {
+        TEST_ASSERT_TRUE(latencies[i] >= latencies[i - 1]);
+    }
+    TEST_ASSERT_EQUAL(2000, latencies.back());
+
+    // A request booked later but arriving earlier is not stuck behind the burst
+    TEST_ASSERT_EQUAL(100, server.request(START_MS + 4000, 0));
+
+    // Twice the workers, half the wait
+    model.workers = 2;
+    FleetServer wider = makeServer(model);
+    uint32_t last = 0;
+    for (int i = 0; i < 20; i++) last = wider.request(START_MS + 5000, 0);
+    TEST_ASSERT_EQUAL(1000, last);
+}
+
+void test_shared_bandwidth_serialises_large_bodies(void) {
+    FleetServerModel model;
+    model.workers = 8;
+    model.serviceMs = 10;
+    model.rttMs = 0;
+    model.bandwidthKbps = 8000;     // 1 MB/s
+    FleetServer server = makeServer(model);
+
+    uint32_t first = server.request(START_MS + 10000, 1000000);
+    uint32_t second = server.request(START_MS + 10000, 1000000);
+    TEST_ASSERT_UINT32_WITHIN(20, 1010, first);
+    TEST_ASSERT_UINT32_WITHIN(20, 2010, second);
+}
+
+void test_request_rates_and_latency_percentiles(void) {
+    FleetServerModel model;
+    model.workers = 4;
+    model.serviceMs = 50;
+    model.rttMs = 10;
+    model.bandwidthKbps = 0;
+    FleetServer server = makeServer(model);
+
+    // Ten requests inside one second, then one a minute for an hour
+    for (int i = 0; i < 10; i++) server.request(START_MS + 30000 + i * 50, 0);
+    for (int minute = 1; minute < 60; minute++) server.request(START_MS + minute * 60000ULL, 0);
+    // Outside the span: counted, but no queueing and no rate sample
+    TEST_ASSERT_EQUAL(60, server.request(START_MS + SPAN_MS + 1000, 0));
+
+    TEST_ASSERT_EQUAL(70, server.getRequests());
+    TEST_ASSERT_EQUAL(10, server.getPeakRequestsPerSecond());
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 69.0 / 3600.0, server.getMeanRequestsPerSecond());
+    TEST_ASSERT_EQUAL(60, server.latencyPercentile(50));
+    TEST_ASSERT_TRUE(server.latencyPercentile(100) >= server.latencyPercentile(99));
+
+    std::vector<double> values = {5.0, 1.0, 4.0, 2.0, 3.0};
+    TEST_ASSERT_EQUAL_FLOAT(3.0, FleetServer::percentile(values, 50));
+    TEST_ASSERT_EQUAL_FLOAT(5.0, FleetServer::percentile(values, 99));
+    TEST_ASSERT_EQUAL_FLOAT(1.0, FleetServer::percentile(values, 0));
+    TEST_ASSERT_EQUAL_FLOAT(0.0, FleetServer::percentile(std::vector<double>(), 50));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_idle_server_costs_round_trip_service_and_transfer);
+    RUN_TEST(test_simultaneous_requests_queue_for_workers);
+    RUN_TEST(test_shared_bandwidth_serialises_large_bodies);
+    RUN_TEST(test_request_rates_and_latency_percentiles);
+    return UNITY_END();
+}
@@ -0,0 +1,124 @@
+#include "GoldenFrame.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+namespace golden {
+
+static const char* MAGIC = "IPRLE1";
+
+std::string encodeRle(const Frame& frame) {
+    char header[64];
+    snprintf(header, sizeof(header), "%s\n%d %d\n", MAGIC, frame.width, frame.height);
+    std::string out(header);
+
+    size_t i = 0;
+    while (i < frame.pixels.size()) {
+        uint8_t value = frame.pixels[i];
+        size_t run = 1;
+        while (i + run < frame.pixels.size() && frame.pixels[i + run] == value) {
+            run++;
+        }
+
+        out.push_back(static_cast<char>(value));
+        size_t remaining = run;
+        do {
+            uint8_t byte = remaining & 0x7F;
+            remaining >>= 7;
+            out.push_back(static_cast<char>(remaining ? byte | 0x80 : byte));
+        } while (remaining);
+
+        i += run;
+    }
+    return out;
+}
+
+bool decodeRle(const std::string& data, Frame& frame) {
+    int width = 0;
+    int height = 0;
+    int headerLength = 0;
+    if (data.compare(0, 7, std::string(MAGIC) + "\n") != 0 ||
+        sscanf(data.c_str() + 7, "%d %d\n%n", &width, &height, &headerLength) != 2 ||
+        width <= 0 || height <= 0) {
+        return false;
+    }
+
+    size_t total = static_cast<size_t>(width) * height;
+    std::vector<uint8_t> pixels;
+    pixels.reserve(total);
+
+    size_t pos = 7 + static_cast<size_t>(headerLength);
+    while (pos < data.size()) {
+        uint8_t value = static_cast<uint8_t>(data[pos++]);
+        size_t run = 0;
+        int shift = 0;
+        uint8_t byte = 0x80;
+        while ((byte & 0x80) && pos < data.size() && shift < 42) {
+            byte = static_cast<uint8_t>(data[pos++]);
+            run |= static_cast<size_t>(byte & 0x7F) << shift;
+            shift += 7;
+        }
+        if ((byte & 0x80) || pixels.size() + run > total) return false;
+        pixels.insert(pixels.end(), run, value);
+    }
+    if (pixels.size() != total) return false;
+
+    frame.width = width;
+    frame.height = height;
+    frame.pixels.swap(pixels);
+    return true;
+}
+
+bool writeFrame(const std::string& path, const Frame& frame) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    std::string data = encodeRle(frame);
+    file.write(data.data(), static_cast<std::streamsize>(data.size()));
+    return static_cast<bool>(file);
+}
+
+bool readFrame(const std::string& path, Frame& frame) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    return decodeRle(contents.str(), frame);
+}
+
+FrameDiff compare(const Frame& expected, const Frame& actual, uint8_t valueTolerance) {
+    FrameDiff diff;
+    if (expected.width != actual.width || expected.height != actual.height ||
+        expected.pixels.size() != actual.pixels.size()) {
+        diff.sizeMismatch = true;
+        return diff;
+    }
+
+    for (size_t i = 0; i < expected.pixels.size(); i++) {
+        uint8_t delta = static_cast<uint8_t>(std::abs(expected.pixels[i] - actual.pixels[i]));
+        diff.maxDelta = std::max(diff.maxDelta, delta);
+        if (delta > valueTolerance) {
+            diff.differingPixels++;
+        }
+    }
+    return diff;
+}
+
+Frame diffImage(const Frame& expected, const Frame& actual, uint8_t valueTolerance) {
+    Frame out;
+    out.width = actual.width;
+    out.height = actual.height;
+    out.pixels.assign(actual.pixels.size(), 255);
+    if (compare(expected, actual).sizeMismatch) return out;
+
+    for (size_t i = 0; i < actual.pixels.size(); i++) {
+        if (std::abs(expected.pixels[i] - actual.pixels[i]) > valueTolerance) {
+            out.pixels[i] = 0;
+        } else if (actual.pixels[i] < 128) {
+            out.pixels[i] = 200;  // Faint context
+        }
+    }
+    return out;
+}
+
+} // namespace golden
@@ -0,0 +1,45 @@
+#ifndef GOLDEN_FRAME_H
+#define GOLDEN_FRAME_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Reference frames for rendering regression tests.
+ *
+ * Frames are 8-bit grayscale panel images (see Inkplate::getPanelFrame()).
+ * They are stored run-length encoded: the magic line "IPRLE1", a
+ * "<width> <height>" line, then (value byte, LEB128 run length) pairs.
+ * E-paper layouts are mostly long runs, so a full 1200x825 frame takes a
+ * few kilobytes instead of ~1 MB.
+ */
+namespace golden {
+
+struct Frame {
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> pixels;
+};
+
+struct FrameDiff {
+    size_t differingPixels = 0;     // Pixels whose values differ by more than the tolerance
+    uint8_t maxDelta = 0;
+    bool sizeMismatch = false;
+};
+
+std::string encodeRle(const Frame& frame);
+bool decodeRle(const std::string& data, Frame& frame);
+
+bool writeFrame(const std::string& path, const Frame& frame);
+bool readFrame(const std::string& path, Frame& frame);
+
+// Per-pixel comparison; deltas up to valueTolerance are not counted
+FrameDiff compare(const Frame& expected, const Frame& actual, uint8_t valueTolerance = 0);
+
+// Grayscale image that is black where frames differ (for reviewing failures)
+Frame diffImage(const Frame& expected, const Frame& actual, uint8_t valueTolerance = 0);
+
+} // namespace golden
+
+#endif
@@ -0,0 +1,320 @@
+#include <unity.h>
+#include <ArduinoJson.h>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <sys/stat.h>
+#include "GoldenFrame.h"
+#include "HostClock.h"
+#include "HostHeap.h"
+#include "MockInkplate.h"
+#include "core/Compositor.h"
+#include "widgets/battery/BatteryWidget.h"
+#include "widgets/layout/LayoutWidget.h"
+#include "widgets/name/NameWidget.h"
+#include "widgets/time/TimeWidget.h"
+#include "widgets/weather/WeatherWidget.h"
+
+/**
+ * Golden-frame regression tests.
+ *
+ * Each reference layout is rendered through the compositor path with fixed
+ * time, weather and battery data, presented to the panel simulator and
+ * compared with test/golden/<layout>.rle. Alongside every golden,
+ * <layout>.json records the per-stage budgets (wall time, allocations,
+ * bytes) the run must stay within.
+ *
+ * Set GOLDEN_UPDATE=1 to rewrite goldens and budgets after an intended
+ * change; review the resulting frames (GOLDEN_UPDATE also writes .png
+ * copies under test/golden/out) before committing them. Mismatches write
+ * <layout>.actual.png and <layout>.diff.png there as well.
+ */
+
+#ifndef GOLDEN_DIR
+#define GOLDEN_DIR "test/golden"
+#endif
+
+// Frames may differ by this many gray levels per pixel without failing
+static const uint8_t VALUE_TOLERANCE = 8;
+// and by this many pixels beyond that
+static const size_t MAX_DIFFERING_PIXELS = 50;
+
+// Recorded time budgets leave room for slower and noisier machines
+static const double TIME_BUDGET_FACTOR = 5.0;
+static const double TIME_BUDGET_FLOOR_MS = 25.0;
+static const int MEASURE_RUNS = 3;
+
+// 2024-03-01 15:00 UTC, a Friday
+static const uint64_t SCENE_EPOCH_SECONDS = 1709305200ULL;
+
+static const char* SCENE_WEATHER = "{\"current_weather\":{\"temperature\":54.3,\"weathercode\":61},"
+                                   "\"hourly\":{\"precipitation_probability\":[65,70,72]}}";
+
+struct StageCost {
+    double ms = 0.0;
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+};
+
+/**
+ * Widgets and regions for one reference layout
+ */
+struct Scene {
+    std::vector<std::unique_ptr<LayoutRegion>> regions;
+    std::vector<std::unique_ptr<Widget>> widgets;
+    std::vector<std::pair<Widget*, LayoutRegion*>> placements;
+
+    LayoutRegion* addRegion(int x, int y, int width, int height) {
+        regions.emplace_back(new LayoutRegion(x, y, width, height));
+        return regions.back().get();
+    }
+
+    void place(Widget* widget, LayoutRegion* region) {
+        widgets.emplace_back(widget);
+        widget->begin();
+        placements.push_back(std::make_pair(widget, region));
+    }
+};
+
+struct LayoutCase {
+    const char* name;
+    std::function<void(Scene&, Inkplate&)> build;
+};
+
+static Inkplate* panel = nullptr;
+static Compositor* compositor = nullptr;
+static LayoutRegion fullScreen(0, 0, E_INK_WIDTH, E_INK_HEIGHT);
+
+static WeatherWidget* makeWeatherWidget(Inkplate& display) {
+    WeatherWidget* widget = new WeatherWidget(display, "47.6062", "-122.3321", "Seattle", "fahrenheit");
+    widget->parseWeatherResponse(String(SCENE_WEATHER));
+    return widget;
+}
+
+static LayoutWidget* makeLayoutWidget(Inkplate& display, Scene& scene, bool borders, bool separators) {
+    LayoutWidget* widget = new LayoutWidget(display, borders, separators);
+    widget->setRegions(&scene.regions);
+    return widget;
+}
+
+static const LayoutCase LAYOUTS[] = {
+    {"quadrants", [](Scene& scene, Inkplate& display) {
+        LayoutRegion* header = scene.addRegion(0, 0, 1200, 100);
+        LayoutRegion* left = scene.addRegion(0, 100, 600, 625);
+        LayoutRegion* right = scene.addRegion(600, 100, 600, 625);
+        LayoutRegion* footer = scene.addRegion(0, 725, 1200, 100);
+        scene.place(new NameWidget(display, "The Goldens"), header);
+        scene.place(new TimeWidget(display, 3600000), left);
+        scene.place(makeWeatherWidget(display), right);
+        scene.place(new BatteryWidget(display, 900000), footer);
+        scene.place(makeLayoutWidget(display, scene, true, true), &fullScreen);
+    }},
+    {"weather_full", [](Scene& scene, Inkplate& display) {
+        LayoutRegion* all = scene.addRegion(0, 0, 1200, 825);
+        scene.place(makeWeatherWidget(display), all);
+    }},
+    {"sidebar", [](Scene& scene, Inkplate& display) {
+        LayoutRegion* side = scene.addRegion(0, 0, 300, 825);
+        LayoutRegion* top = scene.addRegion(300, 0, 900, 500);
+        LayoutRegion* bottomLeft = scene.addRegion(300, 500, 450, 325);
+        LayoutRegion* bottomRight = scene.addRegion(750, 500, 450, 325);
+        scene.place(new NameWidget(display, "Sidebar Family"), side);
+        scene.place(makeWeatherWidget(display), top);
+        scene.place(new TimeWidget(display, 3600000), bottomLeft);
+        scene.place(new BatteryWidget(display, 900000), bottomRight);
+        scene.place(makeLayoutWidget(display, scene, true, false), &fullScreen);
+    }},
+};
+
+template <typename Fn>
+static StageCost measure(Fn stage) {
+    StageCost best;
+    for (int run = 0; run < MEASURE_RUNS; run++) {
+        HostHeap::Counters before = HostHeap::snapshot();
+        auto start = std::chrono::steady_clock::now();
+        stage();
+        auto end = std::chrono::steady_clock::now();
+        HostHeap::Counters after = HostHeap::snapshot();
+
+        StageCost cost;
+        cost.ms = std::chrono::duration<double, std::milli>(end - start).count();
+        cost.allocations = after.allocations - before.allocations;
+        cost.bytes = after.bytesAllocated - before.bytesAllocated;
+        if (run == 0 || cost.ms < best.ms) best.ms = cost.ms;
+        if (run == 0 || cost.allocations < best.allocations) best.allocations = cost.allocations;
+        if (run == 0 || cost.bytes < best.bytes) best.bytes = cost.bytes;
+    }
+    return best;
+}
+
+static bool updating() {
+    const char* value = getenv("GOLDEN_UPDATE");
+    return value && value[0] && value[0] != '0';
+}
+
+static std::string goldenPath(const char* name, const char* suffix) {
+    return std::string(GOLDEN_DIR) + "/" + name + suffix;
+}
+
+static std::string outputPath(const char* name, const char* suffix) {
+    std::string directory = std::string(GOLDEN_DIR) + "/out";
+    mkdir(directory.c_str(), 0755);
+    return directory + "/" + name + suffix;
+}
+
+static void writeBudgets(const char* name, const StageCost& render, const StageCost& present) {
+    JsonDocument doc;
+    const StageCost* costs[] = {&render, &present};
+    const char* stages[] = {"render", "present"};
+    for (int i = 0; i < 2; i++) {
+        JsonObject stage = doc[stages[i]].to<JsonObject>();
+        double budgetMs = costs[i]->ms * TIME_BUDGET_FACTOR;
+        stage["Ms"] = static_cast<int>(budgetMs < TIME_BUDGET_FLOOR_MS ? TIME_BUDGET_FLOOR_MS : budgetMs + 0.5);
+        stage["Allocs"] = costs[i]->allocations;
+        stage["Bytes"] = costs[i]->bytes;
+    }
+
+    std::string json;
+    serializeJsonPretty(doc, json);
+    std::ofstream(goldenPath(name, ".json")) << json << "\n";
+}
+
+static void checkBudget(const char* name, JsonObjectConst budgets, const char* stage, const StageCost& cost) {
+    char message[160];
+    JsonObjectConst budget = budgets[stage];
+    snprintf(message, sizeof(message), "%s/%s: no budget recorded (run with GOLDEN_UPDATE=1)", name, stage);
+    TEST_ASSERT_FALSE_MESSAGE(budget.isNull(), message);
+
+    double ms = budget["Ms"] | 0.0;
+    uint64_t allocations = budget["Allocs"] | 0ULL;
+    uint64_t bytes = budget["Bytes"] | 0ULL;
+
+    snprintf(message, sizeof(message), "%s/%s took %.2f ms (budget %.0f ms)", name, stage, cost.ms, ms);
+    TEST_ASSERT_TRUE_MESSAGE(cost.ms <= ms, message);
+    snprintf(message, sizeof(message), "%s/%s made %llu allocations (budget %llu)", name, stage,
+             static_cast<unsigned long long>(cost.allocations), static_cast<unsigned long long>(allocations));
+    TEST_ASSERT_TRUE_MESSAGE(cost.allocations <= allocations, message);
+    snprintf(message, sizeof(message), "%s/%s allocated %llu bytes (budget %llu)", name, stage,
+             static_cast<unsigned long long>(cost.bytes), static_cast<unsigned long long>(bytes));
+    TEST_ASSERT_TRUE_MESSAGE(cost.bytes <= bytes, message);
+}
+
+static void runLayout(const LayoutCase& layout) {
+    Scene scene;
+    layout.build(scene, *panel);
+
+    // Time widgets sync against the fixed wall clock
+    for (auto& widget : scene.widgets) {
+        if (TimeWidget* time = dynamic_cast<TimeWidget*>(widget.get())) {
+            time->forceTimeSync();
+        }
+    }
+
+    StageCost render = measure([&]() {
+        compositor->clear();
+        for (const auto& placement : scene.placements) {
+            placement.first->renderToCompositor(*compositor, *placement.second);
+        }
+    });
+    StageCost present = measure([&]() {
+        compositor->displayToInkplate(*panel);
+    });
+
+    golden::Frame actual;
+    actual.width = panel->width();
+    actual.height = panel->height();
+    actual.pixels = panel->getPanelFrame();
+
+    if (updating()) {
+        TEST_ASSERT_TRUE(golden::writeFrame(goldenPath(layout.name, ".rle"), actual));
+        FrameWriter::writePng(outputPath(layout.name, ".png").c_str(), actual.pixels.data(), actual.width, actual.height);
+        writeBudgets(layout.name, render, present);
+        return;
+    }
+
+    char message[200];
+    golden::Frame expected;
+    snprintf(message, sizeof(message), "missing golden %s (run with GOLDEN_UPDATE=1)",
+             goldenPath(layout.name, ".rle").c_str());
+    TEST_ASSERT_TRUE_MESSAGE(golden::readFrame(goldenPath(layout.name, ".rle"), expected), message);
+
+    golden::FrameDiff diff = golden::compare(expected, actual, VALUE_TOLERANCE);
+    if (diff.sizeMismatch || diff.differingPixels > MAX_DIFFERING_PIXELS) {
+        golden::Frame delta = golden::diffImage(expected, actual, VALUE_TOLERANCE);
+        FrameWriter::writePng(outputPath(layout.name, ".actual.png").c_str(), actual.pixels.data(), actual.width, actual.height);
+        FrameWriter::writePng(outputPath(layout.name, ".diff.png").c_str(), delta.pixels.data(), delta.width, delta.height);
+    }
+    snprintf(message, sizeof(message), "%s: %zu pixels differ (max delta %u); see %s", layout.name,
+             diff.differingPixels, diff.maxDelta, outputPath(layout.name, ".diff.png").c_str());
+    TEST_ASSERT_FALSE_MESSAGE(diff.sizeMismatch, "frame size changed");
+    TEST_ASSERT_TRUE_MESSAGE(diff.differingPixels <= MAX_DIFFERING_PIXELS, message);
+
+    std::ifstream budgetFile(goldenPath(layout.name, ".json"));
+    std::ostringstream contents;
+    contents << budgetFile.rdbuf();
+    JsonDocument budgets;
+    TEST_ASSERT_FALSE_MESSAGE(deserializeJson(budgets, contents.str().c_str()), "unreadable budget file");
+    checkBudget(layout.name, budgets.as<JsonObjectConst>(), "render", render);
+    checkBudget(layout.name, budgets.as<JsonObjectConst>(), "present", present);
+}
+
+void setUp(void) {
+    HostClock::setVirtual(true);
+    HostClock::setMicros(0);
+    HostClock::setBootEpochMicros(SCENE_EPOCH_SECONDS * 1000000ULL);
+    HostClock::setWallClockSynced(false);
+    WiFi.setConnectDelayMs(0);
+    WiFi.begin("golden-network", "password");
+
+    panel = new Inkplate(INKPLATE_3BIT);
+    panel->begin();
+    panel->setBatteryVoltage(3.87);
+
+    compositor = new Compositor(E_INK_WIDTH, E_INK_HEIGHT);
+    compositor->setMemoryPressureThreshold(SIZE_MAX);
+    TEST_ASSERT_TRUE(compositor->initialize());
+}
+
+void tearDown(void) {
+    delete compositor;
+    compositor = nullptr;
+    delete panel;
+    panel = nullptr;
+    WiFi.disconnect(true);
+}
+
+void test_golden_quadrants(void) { runLayout(LAYOUTS[0]); }
+void test_golden_weather_full(void) { runLayout(LAYOUTS[1]); }
+void test_golden_sidebar(void) { runLayout(LAYOUTS[2]); }
+
+void test_rle_round_trip(void) {
+    golden::Frame frame;
+    frame.width = 300;
+    frame.height = 2;
+    for (int i = 0; i < 600; i++) {
+        frame.pixels.push_back(i < 200 ? 255 : static_cast<uint8_t>(i % 7));
+    }
+
+    golden::Frame decoded;
+    TEST_ASSERT_TRUE(golden::decodeRle(golden::encodeRle(frame), decoded));
+    TEST_ASSERT_EQUAL_INT(300, decoded.width);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(frame.pixels.data(), decoded.pixels.data(), frame.pixels.size());
+    TEST_ASSERT_FALSE(golden::decodeRle("IPRLE1\n2 2\n\xff\x05", decoded));  // Run overflows the frame
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    Serial.setOutput(nullptr);
+    setenv("TZ", "UTC0", 1);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_rle_round_trip);
+    RUN_TEST(test_golden_quadrants);
+    RUN_TEST(test_golden_weather_full);
+    RUN_TEST(test_golden_sidebar);
+    return UNITY_END();
+}
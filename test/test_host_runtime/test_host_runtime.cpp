@@ -0,0 +1,216 @@
+#include <unity.h>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "HostClock.h"
+#include "HostSleep.h"
+#include "HostTransport.h"
+#include "HTTPClient.h"
+#include "MockInkplate.h"
+#include "SPIFFS.h"
+#include "WiFi.h"
+
+/**
+ * Answers every request with a fixed body and latency
+ */
+class StaticTransport : public HostTransport {
+public:
+    HostResponse handle(const HostRequest& request) override {
+        lastRequest = request;
+        HostResponse response;
+        response.status = status;
+        response.body = body;
+        response.headers = "Content-Type: text/plain\n";
+        response.latencyMs = latencyMs;
+        return response;
+    }
+
+    HostRequest lastRequest;
+    int status = 200;
+    std::string body = "hello";
+    uint32_t latencyMs = 250;
+};
+
+void setUp(void) {
+    HostClock::setVirtual(true);
+    HostClock::setMicros(0);
+    HostClock::setWallClockSynced(false);
+    HostSleep::reset();
+    WiFi.setConnectDelayMs(0);
+    WiFi.setNetworkAvailable(true);
+    WiFi.begin("host-network", "password");
+    HTTPClient::setTransport(nullptr);
+}
+
+void tearDown(void) {
+    WiFi.disconnect(true);
+    HTTPClient::setTransport(nullptr);
+}
+
+void test_wifi_connects_after_virtual_delay(void) {
+    WiFi.disconnect(true);
+    WiFi.setConnectDelayMs(1500);
+    uint64_t radioBefore = WiFi.getRadioOnMicros();
+
+    WiFi.begin("host-network", "password");
+    TEST_ASSERT_EQUAL(WL_DISCONNECTED, WiFi.status());
+    delay(1000);
+    TEST_ASSERT_EQUAL(WL_DISCONNECTED, WiFi.status());
+    delay(500);
+    TEST_ASSERT_EQUAL(WL_CONNECTED, WiFi.status());
+
+    WiFi.mode(WIFI_OFF);
+    delay(10000);
+    TEST_ASSERT_EQUAL_UINT64(1500000, WiFi.getRadioOnMicros() - radioBefore);
+}
+
+void test_http_get_uses_transport_and_charges_latency(void) {
+    StaticTransport transport;
+    HTTPClient::setTransport(&transport);
+
+    HTTPClient http;
+    http.begin("http://example.org:8080/path/file.txt?a=1&b=two");
+    unsigned long before = millis();
+    TEST_ASSERT_EQUAL(200, http.GET());
+    TEST_ASSERT_EQUAL_UINT32(250, millis() - before);
+    TEST_ASSERT_EQUAL_STRING("hello", http.getString().c_str());
+    TEST_ASSERT_EQUAL_STRING("text/plain", http.header("Content-Type").c_str());
+
+    TEST_ASSERT_EQUAL_STRING("example.org", transport.lastRequest.host.c_str());
+    TEST_ASSERT_EQUAL_STRING("/path/file.txt", transport.lastRequest.path.c_str());
+    TEST_ASSERT_EQUAL_STRING("two", HostTransport::queryParam(transport.lastRequest.query, "b").c_str());
+
+    // Slower than the client timeout
+    transport.latencyMs = 8000;
+    http.setTimeout(5000);
+    TEST_ASSERT_EQUAL(HTTPC_ERROR_READ_TIMEOUT, http.GET());
+
+    WiFi.disconnect();
+    TEST_ASSERT_EQUAL(HTTPC_ERROR_NOT_CONNECTED, http.GET());
+}
+
+void test_fixture_transport_serves_files_and_synthetic_weather(void) {
+    char root[] = "/tmp/host_fixtures_XXXXXX";
+    TEST_ASSERT_NOT_NULL(mkdtemp(root));
+    std::string hostDir = std::string(root) + "/images.local";
+    TEST_ASSERT_EQUAL(0, mkdir(hostDir.c_str(), 0755));
+    std::ofstream(hostDir + "/a.json") << "{\"ok\":true}";
+
+    FixtureTransport transport(root);
+    HostRequest request;
+    TEST_ASSERT_TRUE(HostTransport::parseUrl("http://images.local/a.json?v=3", request));
+    HostResponse response = transport.handle(request);
+    TEST_ASSERT_EQUAL(200, response.status);
+    TEST_ASSERT_EQUAL_STRING("{\"ok\":true}", response.body.c_str());
+
+    TEST_ASSERT_TRUE(HostTransport::parseUrl("http://images.local/missing.png", request));
+    TEST_ASSERT_EQUAL(404, transport.handle(request).status);
+
+    // Same instant, same forecast; different instant, different forecast
+    TEST_ASSERT_TRUE(HostTransport::parseUrl("https://api.open-meteo.com/v1/forecast?latitude=1", request));
+    response = transport.handle(request);
+    TEST_ASSERT_EQUAL(200, response.status);
+    TEST_ASSERT_TRUE(response.body.find("current_weather") != std::string::npos);
+    TEST_ASSERT_EQUAL_STRING(FixtureTransport::syntheticForecast(1704067200).c_str(),
+                             FixtureTransport::syntheticForecast(1704067200).c_str());
+    TEST_ASSERT_TRUE(FixtureTransport::syntheticForecast(1704067200) !=
+                     FixtureTransport::syntheticForecast(1704067200 + 6 * 3600));
+    TEST_ASSERT_EQUAL_UINT32(3, transport.getRequestCount());
+
+    remove((hostDir + "/a.json").c_str());
+    rmdir(hostDir.c_str());
+    rmdir(root);
+}
+
+void test_spiffs_mount_mirrors_writes_to_directory(void) {
+    char root[] = "/tmp/host_spiffs_XXXXXX";
+    TEST_ASSERT_NOT_NULL(mkdtemp(root));
+    std::ofstream(std::string(root) + "/config.json") << "{}";
+
+    SPIFFS.clearFiles();
+    TEST_ASSERT_TRUE(SPIFFS.mountDirectory(root));
+    TEST_ASSERT_TRUE(SPIFFS.exists("/config.json"));
+
+    File file = SPIFFS.open("/cache/state.bin", "w");
+    file.print("abc");
+    file.close();
+    std::ifstream mirrored(std::string(root) + "/cache/state.bin");
+    std::string contents;
+    mirrored >> contents;
+    TEST_ASSERT_EQUAL_STRING("abc", contents.c_str());
+
+    TEST_ASSERT_TRUE(SPIFFS.remove("/cache/state.bin"));
+    TEST_ASSERT_FALSE(std::ifstream(std::string(root) + "/cache/state.bin").good());
+
+    SPIFFS.unmountDirectory();
+    SPIFFS.clearFiles();
+    remove((std::string(root) + "/config.json").c_str());
+    rmdir((std::string(root) + "/cache").c_str());
+    rmdir(root);
+}
+
+void test_time_follows_emulated_wall_clock_once_synced(void) {
+    HostClock::setBootEpochMicros(1704067200ULL * 1000000ULL);
+    HostClock::setMicros(5000000);
+    TEST_ASSERT_EQUAL(5, time(nullptr));  // Unsynced RTC counts from zero
+
+    configTime(-28800, 3600, "pool.ntp.org");
+    TEST_ASSERT_TRUE(HostClock::isWallClockSynced());
+    TEST_ASSERT_EQUAL(1704067205, time(nullptr));
+
+    // Pacific standard time in January
+    time_t now = time(nullptr);
+    struct tm local;
+    localtime_r(&now, &local);
+    TEST_ASSERT_EQUAL(16, local.tm_hour);
+    TEST_ASSERT_EQUAL(31, local.tm_mday);
+}
+
+void test_sleep_configuration_is_recorded(void) {
+    esp_sleep_enable_timer_wakeup(3600ULL * 1000000ULL);
+    esp_sleep_enable_ext0_wakeup(static_cast<gpio_num_t>(36), 0);
+    TEST_ASSERT_TRUE(HostSleep::rtcMemoryRetained());
+
+    esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_SLOW_MEM, ESP_PD_OPTION_OFF);
+    TEST_ASSERT_FALSE(HostSleep::rtcMemoryRetained());
+    TEST_ASSERT_EQUAL_UINT64(3600ULL * 1000000ULL, HostSleep::getTimerWakeupUs());
+    TEST_ASSERT_EQUAL(36, HostSleep::getExt0Pin());
+
+    HostSleep::setWakeupCause(ESP_SLEEP_WAKEUP_TIMER);
+    TEST_ASSERT_EQUAL(ESP_SLEEP_WAKEUP_TIMER, esp_sleep_get_wakeup_cause());
+    HostSleep::setWakeupCause(ESP_SLEEP_WAKEUP_UNDEFINED);
+}
+
+void test_draw_image_blits_pgm_from_transport(void) {
+    StaticTransport transport;
+    transport.body = std::string("P5\n2 1\n255\n", 11) + std::string("\x00\xff", 2);
+    HTTPClient::setTransport(&transport);
+
+    Inkplate panel(INKPLATE_3BIT);
+    TEST_ASSERT_TRUE(panel.drawImage("http://images.local/tiny.pgm", 10, 20));
+    TEST_ASSERT_EQUAL_UINT8(0, panel.getPixel(10, 20));
+    TEST_ASSERT_EQUAL_UINT8(7, panel.getPixel(11, 20));
+
+    transport.status = 404;
+    TEST_ASSERT_FALSE(panel.drawImage("http://images.local/tiny.pgm", 0, 0));
+    TEST_ASSERT_FALSE(panel.drawImage("/sd/image.bmp", 0, 0));
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    Serial.setOutput(nullptr);
+    setenv("TZ", "UTC0", 1);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_wifi_connects_after_virtual_delay);
+    RUN_TEST(test_http_get_uses_transport_and_charges_latency);
+    RUN_TEST(test_fixture_transport_serves_files_and_synthetic_weather);
+    RUN_TEST(test_spiffs_mount_mirrors_writes_to_directory);
+    RUN_TEST(test_time_follows_emulated_wall_clock_once_synced);
+    RUN_TEST(test_sleep_configuration_is_recorded);
+    RUN_TEST(test_draw_image_blits_pgm_from_transport);
+    return UNITY_END();
+}
@@ -0,0 +1,233 @@
+#include <unity.h>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "HostHeap.h"
+#include "HostTransport.h"
+#include "HTTPClient.h"
+#include "SoakAnalyzer.h"
+#include "esp_heap_caps.h"
+
+/**
+ * Answers every request with the same JSON body
+ */
+class JsonTransport : public HostTransport {
+public:
+    HostResponse handle(const HostRequest& request) override {
+        (void)request;
+        HostResponse response;
+        response.status = 200;
+        response.body = "{\"current_weather\":{\"temperature\":54.3,\"weathercode\":61}}";
+        response.latencyMs = 100;
+        return response;
+    }
+};
+
+// Cycles with deterministic noise around a base value plus a per-cycle step
+static std::vector<SoakCycle> makeCycles(size_t count, double retainedStep, double largestFreeStep) {
+    std::vector<SoakCycle> cycles;
+    uint32_t noise = 12345;
+    for (size_t i = 0; i < count; i++) {
+        noise = noise * 1103515245u + 12345u;
+        int jitter = static_cast<int>((noise >> 16) % 513) - 256;
+
+        SoakCycle cycle;
+        cycle.index = static_cast<uint32_t>(i);
+        cycle.retainedBytes = static_cast<size_t>(40000 + jitter + retainedStep * i);
+        cycle.highWaterBytes = cycle.retainedBytes + 12000;
+        cycle.allocations = 130 + (noise >> 20) % 20;
+        cycle.largestFreeInternal = static_cast<size_t>(280000 + jitter - largestFreeStep * i);
+        cycles.push_back(cycle);
+    }
+    return cycles;
+}
+
+// Volatile so the compiler cannot drop malloc/free pairs the model must see
+static void* volatile held[256];
+
+static const SoakTrend* findTrend(const std::vector<SoakTrend>& trends, const char* metric) {
+    for (const SoakTrend& trend : trends) {
+        if (strcmp(trend.metric, metric) == 0) return &trend;
+    }
+    return nullptr;
+}
+
+void setUp(void) {}
+
+void tearDown(void) {
+    HostHeap::enableDeviceModel(false);
+}
+
+void test_flat_noisy_run_passes(void) {
+    std::vector<SoakCycle> cycles = makeCycles(200, 0.0, 0.0);
+    std::vector<SoakTrend> trends = SoakAnalyzer::analyze(cycles, SoakLimits());
+
+    TEST_ASSERT_EQUAL(4, trends.size());
+    TEST_ASSERT_TRUE(SoakAnalyzer::passed(cycles, trends));
+}
+
+void test_small_leak_fails_retained_and_high_water(void) {
+    // 32 bytes per cycle is lost in the noise of any single cycle
+    std::vector<SoakCycle> cycles = makeCycles(200, 32.0, 0.0);
+    std::vector<SoakTrend> trends = SoakAnalyzer::analyze(cycles, SoakLimits());
+
+    TEST_ASSERT_TRUE(findTrend(trends, "retained bytes")->failed);
+    TEST_ASSERT_TRUE(findTrend(trends, "high-water bytes")->failed);
+    TEST_ASSERT_FALSE(findTrend(trends, "largest free block")->failed);
+    TEST_ASSERT_FALSE(SoakAnalyzer::passed(cycles, trends));
+}
+
+void test_shrinking_largest_block_fails(void) {
+    std::vector<SoakCycle> cycles = makeCycles(200, 0.0, 64.0);
+    std::vector<SoakTrend> trends = SoakAnalyzer::analyze(cycles, SoakLimits());
+
+    TEST_ASSERT_FALSE(findTrend(trends, "retained bytes")->failed);
+    TEST_ASSERT_TRUE(findTrend(trends, "largest free block")->failed);
+}
+
+void test_failed_device_allocation_fails_run(void) {
+    std::vector<SoakCycle> cycles = makeCycles(50, 0.0, 0.0);
+    cycles[2].failedAllocations = 1;  // Even inside the warm-up
+    TEST_ASSERT_FALSE(SoakAnalyzer::passed(cycles, SoakAnalyzer::analyze(cycles, SoakLimits())));
+}
+
+void test_too_few_cycles_cannot_pass(void) {
+    std::vector<SoakCycle> cycles = makeCycles(8, 0.0, 0.0);
+    std::vector<SoakTrend> trends = SoakAnalyzer::analyze(cycles, SoakLimits());
+    TEST_ASSERT_EQUAL(0, trends.size());
+    TEST_ASSERT_FALSE(SoakAnalyzer::passed(cycles, trends));
+}
+
+void test_device_model_reports_fragmentation(void) {
+    TEST_ASSERT_TRUE(HostHeap::enableDeviceModel(true));
+    HostHeap::DeviceHeap empty = HostHeap::deviceHeap(HostHeap::Region::INTERNAL);
+    TEST_ASSERT_EQUAL(1, empty.freeRanges);
+
+    // Fill most of internal RAM with 1KB blocks, then free every other one
+    for (int i = 0; i < 256; i++) {
+        held[i] = malloc(1024);
+    }
+    for (int i = 0; i < 256; i += 2) {
+        free(held[i]);
+        held[i] = nullptr;
+    }
+
+    HostHeap::DeviceHeap fragmented = HostHeap::deviceHeap(HostHeap::Region::INTERNAL);
+    TEST_ASSERT_GREATER_THAN(128 * 1024, fragmented.freeBytes);
+    TEST_ASSERT_LESS_THAN(empty.largestFreeBlock - 200 * 1024, fragmented.largestFreeBlock);
+    TEST_ASSERT_GREATER_THAN(100, fragmented.freeRanges);
+    TEST_ASSERT_EQUAL(fragmented.largestFreeBlock, heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL));
+
+    for (int i = 1; i < 256; i += 2) {
+        free(held[i]);
+    }
+    HostHeap::DeviceHeap restored = HostHeap::deviceHeap(HostHeap::Region::INTERNAL);
+    TEST_ASSERT_EQUAL(empty.freeBytes, restored.freeBytes);
+    TEST_ASSERT_EQUAL(1, restored.freeRanges);
+}
+
+void test_device_model_routes_large_requests_to_psram(void) {
+    // The mock's PSRAM tag table keeps its buckets once created
+    held[0] = heap_caps_malloc(16, MALLOC_CAP_SPIRAM);
+    heap_caps_free(held[0]);
+
+    TEST_ASSERT_TRUE(HostHeap::enableDeviceModel(true));
+    size_t internalBefore = HostHeap::deviceHeap(HostHeap::Region::INTERNAL).freeBytes;
+    size_t psramBefore = HostHeap::deviceHeap(HostHeap::Region::PSRAM).freeBytes;
+
+    // Payload plus block header, internal for small requests and PSRAM above 16KB
+    held[0] = malloc(512);
+    held[1] = malloc(64 * 1024);
+    TEST_ASSERT_EQUAL(internalBefore - 520, HostHeap::deviceHeap(HostHeap::Region::INTERNAL).freeBytes);
+    TEST_ASSERT_EQUAL(psramBefore - 65544, HostHeap::deviceHeap(HostHeap::Region::PSRAM).freeBytes);
+
+    held[2] = heap_caps_malloc(1024, MALLOC_CAP_SPIRAM);
+    TEST_ASSERT_EQUAL(psramBefore - 65544 - 1032, HostHeap::deviceHeap(HostHeap::Region::PSRAM).freeBytes);
+
+    // Larger than both heaps: served on the host, counted as a device failure
+    held[3] = malloc(8 * 1024 * 1024);
+    TEST_ASSERT_NOT_NULL(held[3]);
+    TEST_ASSERT_EQUAL_UINT64(1, HostHeap::deviceAllocationFailures());
+
+    free(held[3]);
+    heap_caps_free(held[2]);
+    free(held[1]);
+    free(held[0]);
+    TEST_ASSERT_EQUAL(internalBefore, HostHeap::deviceHeap(HostHeap::Region::INTERNAL).freeBytes);
+    TEST_ASSERT_EQUAL(psramBefore, HostHeap::deviceHeap(HostHeap::Region::PSRAM).freeBytes);
+}
+
+void test_fault_injection_is_reproducible(void) {
+    JsonTransport inner;
+    FaultInjectingTransport::Rates rates;
+    rates.error = 0.2f;
+    rates.slow = 0.2f;
+    rates.malformed = 0.2f;
+    FaultInjectingTransport first(inner, rates, 42);
+    FaultInjectingTransport second(inner, rates, 42);
+
+    HostRequest request;
+    HostTransport::parseUrl("https://api.open-meteo.com/v1/forecast", request);
+    for (int i = 0; i < 1000; i++) {
+        HostResponse fromFirst = first.handle(request);
+        HostResponse fromSecond = second.handle(request);
+        TEST_ASSERT_EQUAL(fromFirst.status, fromSecond.status);
+        TEST_ASSERT_EQUAL_STRING(fromFirst.body.c_str(), fromSecond.body.c_str());
+        TEST_ASSERT_EQUAL_UINT32(fromFirst.latencyMs, fromSecond.latencyMs);
+    }
+
+    // Each kind lands near its rate
+    const FaultInjectingTransport::Counts& counts = first.getCounts();
+    TEST_ASSERT_EQUAL_UINT32(1000, counts.requests);
+    TEST_ASSERT_UINT32_WITHIN(60, 200, counts.errors);
+    TEST_ASSERT_UINT32_WITHIN(60, 200, counts.slow);
+    TEST_ASSERT_UINT32_WITHIN(60, 200, counts.malformed);
+}
+
+void test_fault_kinds_break_responses(void) {
+    JsonTransport inner;
+    HostRequest request;
+    HostTransport::parseUrl("https://api.open-meteo.com/v1/forecast", request);
+    std::string intact = inner.handle(request).body;
+
+    FaultInjectingTransport::Rates errors;
+    errors.error = 1.0f;
+    HostResponse refused = FaultInjectingTransport(inner, errors).handle(request);
+    TEST_ASSERT_TRUE(refused.status == HTTPC_ERROR_CONNECTION_REFUSED ||
+                     refused.status == HTTPC_ERROR_CONNECTION_LOST);
+    TEST_ASSERT_TRUE(refused.body.empty());
+
+    FaultInjectingTransport::Rates slow;
+    slow.slow = 1.0f;
+    FaultInjectingTransport slowTransport(inner, slow);
+    slowTransport.setSlowLatencyMs(9000);
+    HostResponse late = slowTransport.handle(request);
+    TEST_ASSERT_EQUAL(200, late.status);
+    TEST_ASSERT_EQUAL_UINT32(9000, late.latencyMs);
+
+    FaultInjectingTransport::Rates malformed;
+    malformed.malformed = 1.0f;
+    FaultInjectingTransport corrupting(inner, malformed);
+    for (int i = 0; i < 20; i++) {
+        HostResponse broken = corrupting.handle(request);
+        TEST_ASSERT_EQUAL(200, broken.status);
+        TEST_ASSERT_TRUE(broken.body != intact);
+    }
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+
+    UNITY_BEGIN();
+    RUN_TEST(test_flat_noisy_run_passes);
+    RUN_TEST(test_small_leak_fails_retained_and_high_water);
+    RUN_TEST(test_shrinking_largest_block_fails);
+    RUN_TEST(test_failed_device_allocation_fails_run);
+    RUN_TEST(test_too_few_cycles_cannot_pass);
+    RUN_TEST(test_device_model_reports_fragmentation);
+    RUN_TEST(test_device_model_routes_large_requests_to_psram);
+    RUN_TEST(test_fault_injection_is_reproducible);
+    RUN_TEST(test_fault_kinds_break_responses);
+    return UNITY_END();
+}
@@ -0,0 +1,318 @@
+#include <unity.h>
+#include <algorithm>
+#include <ctime>
+#include <string>
+#include <vector>
+#include "HostClock.h"
+#include "HostSleep.h"
+#include "HostTransport.h"
+#include "HTTPClient.h"
+#include "MockInkplate.h"
+#include "SPIFFS.h"
+#include "TraceReplay.h"
+#include "WiFi.h"
+#include "core/InputTrace.h"
+
+/**
+ * Answers every request with a fixed body and latency
+ */
+class StaticTransport : public HostTransport {
+public:
+    HostResponse handle(const HostRequest& request) override {
+        (void)request;
+        HostResponse response;
+        response.status = 200;
+        response.body = "fixture";
+        response.latencyMs = 50;
+        return response;
+    }
+};
+
+static Inkplate panel;
+
+static std::vector<TraceEvent> parseRecorded(TraceHeader& header) {
+    std::vector<TraceEvent> events;
+    TEST_ASSERT_TRUE(InputTrace::parse(InputTrace::data(), InputTrace::size(), header, events));
+    return events;
+}
+
+static HostRequest requestFor(const char* url) {
+    HostRequest request;
+    HostTransport::parseUrl(url, request);
+    return request;
+}
+
+void setUp(void) {
+    HostClock::setVirtual(true);
+    HostClock::setMicros(0);
+    HostClock::setBootEpochMicros(1704067200ULL * 1000000ULL);
+    HostClock::setWallClockSynced(false);
+    HostClock::setSntpHandler(nullptr);
+    HostSleep::reset();
+    SPIFFS.clearFiles();
+    InputTrace::reset();
+    WiFi.setConnectDelayMs(0);
+    WiFi.setNetworkAvailable(true);
+}
+
+void tearDown(void) {
+    InputTrace::reset();
+    HostClock::setSntpHandler(nullptr);
+    WiFi.disconnect(true);
+}
+
+void test_events_round_trip(void) {
+    HostClock::setWallClockSynced(true);
+    HostClock::advanceMillis(1000);
+    InputTrace::beginWake(ESP_SLEEP_WAKEUP_TIMER);
+    TEST_ASSERT_TRUE(InputTrace::start(4096));
+
+    unsigned long started = millis();
+    HostClock::advanceMillis(1800);
+    InputTrace::recordWiFi(started, true);
+    started = millis();
+    HostClock::advanceMillis(1000);
+    InputTrace::recordTimeSync(started, 1704070000);
+    started = millis();
+    HostClock::advanceMillis(420);
+    InputTrace::recordHttp(started, "https://api.open-meteo.com/v1/forecast?x=1", 200, "{\"t\":1}");
+    InputTrace::recordHttpTiming(millis(), "http://images.local/photo.pgm", HTTPC_ERROR_CONNECTION_LOST);
+    InputTrace::recordBattery(3.87f);
+    InputTrace::recordButton(36, LOW);
+    TEST_ASSERT_TRUE(InputTrace::finish(3600000));
+
+    TraceHeader header;
+    std::vector<TraceEvent> events = parseRecorded(header);
+    TEST_ASSERT_EQUAL(ESP_SLEEP_WAKEUP_TIMER, header.wakeCause);
+    TEST_ASSERT_TRUE(header.clockValid);
+    TEST_ASSERT_FALSE(header.truncated);
+    TEST_ASSERT_EQUAL_UINT64(1704067201ULL, header.bootEpochSeconds);
+    TEST_ASSERT_EQUAL_UINT32(1000, header.bootMs);
+    TEST_ASSERT_EQUAL(7, events.size());
+
+    TEST_ASSERT_EQUAL(TraceEventType::WIFI, events[0].type);
+    TEST_ASSERT_EQUAL_UINT32(1000, events[0].atMs);
+    TEST_ASSERT_EQUAL_UINT32(1800, events[0].durationMs);
+    TEST_ASSERT_EQUAL(1, events[0].value);
+    TEST_ASSERT_EQUAL_UINT64(1704070000ULL, events[1].epochSeconds);
+    TEST_ASSERT_EQUAL_UINT32(1000, events[1].durationMs);
+    TEST_ASSERT_EQUAL(200, events[2].value);
+    TEST_ASSERT_EQUAL_UINT32(420, events[2].durationMs);
+    TEST_ASSERT_EQUAL_STRING("{\"t\":1}", events[2].body.c_str());
+    TEST_ASSERT_EQUAL_STRING("https://api.open-meteo.com/v1/forecast?x=1", events[2].url.c_str());
+    TEST_ASSERT_EQUAL(HTTPC_ERROR_CONNECTION_LOST, events[3].value);
+    TEST_ASSERT_TRUE(events[3].bodyOmitted);
+    TEST_ASSERT_EQUAL_FLOAT(3.87f, events[4].volts);
+    TEST_ASSERT_EQUAL(36, events[5].pin);
+    TEST_ASSERT_EQUAL(LOW, events[5].value);
+    TEST_ASSERT_EQUAL(TraceEventType::SLEEP, events[6].type);
+    TEST_ASSERT_EQUAL_UINT32(3600000, events[6].durationMs);
+
+    // Saved as one file, byte for byte
+    std::string saved;
+    TEST_ASSERT_TRUE(SPIFFS.readFile(InputTrace::TRACE_FILE, saved));
+    TEST_ASSERT_EQUAL(InputTrace::size(), saved.size());
+}
+
+void test_recording_is_off_until_started(void) {
+    InputTrace::beginWake(ESP_SLEEP_WAKEUP_UNDEFINED);
+    InputTrace::recordBattery(3.9f);
+    TEST_ASSERT_FALSE(InputTrace::isRecording());
+    TEST_ASSERT_FALSE(InputTrace::finish(1000));
+    TEST_ASSERT_FALSE(SPIFFS.exists(InputTrace::TRACE_FILE));
+}
+
+void test_budget_drops_bodies_then_truncates(void) {
+    InputTrace::beginWake(ESP_SLEEP_WAKEUP_TIMER);
+    TEST_ASSERT_TRUE(InputTrace::start(200));
+
+    // Too big for the budget: the timing survives without the body
+    InputTrace::recordHttp(millis(), "http://a/", 200, String(std::string(500, 'x')));
+    TEST_ASSERT_TRUE(InputTrace::isRecording());
+    for (int i = 0; i < 50 && InputTrace::isRecording(); i++) {
+        InputTrace::recordBattery(3.9f);
+    }
+    TEST_ASSERT_FALSE(InputTrace::isRecording());
+
+    // Saved as soon as it filled up, for units that never sleep
+    std::string saved;
+    TEST_ASSERT_TRUE(SPIFFS.readFile(InputTrace::TRACE_FILE, saved));
+    TraceHeader header;
+    std::vector<TraceEvent> events;
+    TEST_ASSERT_TRUE(InputTrace::parse(reinterpret_cast<const uint8_t*>(saved.data()), saved.size(), header, events));
+    TEST_ASSERT_TRUE(header.truncated);
+    TEST_ASSERT_TRUE(events[0].bodyOmitted);
+    TEST_ASSERT_TRUE(saved.size() <= 200);
+}
+
+void test_streamed_bodies_and_headers_are_kept(void) {
+    InputTrace::beginWake(ESP_SLEEP_WAKEUP_TIMER);
+    TEST_ASSERT_TRUE(InputTrace::start(400));
+
+    // Read in chunks, with the validators the widget keeps
+    unsigned long started = millis();
+    HostClock::advanceMillis(300);
+    InputTrace::recordHttpStart(started, "http://cal/feed.ics", 200, "ETag: \"v7\"\n");
+    std::string feed = std::string("BEGIN:VCALENDAR\r\n") + std::string(150, 'x');
+    for (size_t at = 0; at < feed.size(); at += 64) {
+        InputTrace::recordHttpBody(feed.data() + at, std::min<size_t>(64, feed.size() - at));
+    }
+    // Over budget part way through: timing and headers stay
+    InputTrace::recordHttpStart(millis(), "http://frames/panel", 200, String());
+    std::string frame(300, 'f');
+    InputTrace::recordHttpBody(frame.data(), 100);
+    InputTrace::recordHttpBody(frame.data() + 100, 200);
+    InputTrace::recordBattery(3.9f);
+
+    TraceHeader header;
+    std::vector<TraceEvent> events = parseRecorded(header);
+    TEST_ASSERT_EQUAL(3, events.size());
+    TEST_ASSERT_EQUAL_UINT32(300, events[0].durationMs);
+    TEST_ASSERT_FALSE(events[0].bodyOmitted);
+    TEST_ASSERT_TRUE(events[0].body == feed);
+    TEST_ASSERT_EQUAL_STRING("ETag: \"v7\"\n", events[0].headers.c_str());
+    TEST_ASSERT_TRUE(events[1].bodyOmitted);
+    TEST_ASSERT_TRUE(events[1].body.empty());
+    TEST_ASSERT_EQUAL_FLOAT(3.9f, events[2].volts);
+
+    // Replayed with the recorded headers
+    StaticTransport fixtures;
+    TraceTransport transport(events, &fixtures);
+    HostResponse response = transport.handle(requestFor("http://cal/feed.ics"));
+    TEST_ASSERT_TRUE(response.body == feed);
+    TEST_ASSERT_EQUAL_STRING("ETag: \"v7\"\n", response.headers.c_str());
+}
+
+void test_previous_trace_is_kept(void) {
+    SPIFFS.writeFile(InputTrace::TRACE_FILE, "older");
+    InputTrace::beginWake(ESP_SLEEP_WAKEUP_TIMER);
+    TEST_ASSERT_TRUE(InputTrace::start(1024));
+    TEST_ASSERT_TRUE(InputTrace::finish(1000));
+
+    std::string previous;
+    TEST_ASSERT_TRUE(SPIFFS.readFile(InputTrace::PREVIOUS_TRACE_FILE, previous));
+    TEST_ASSERT_EQUAL_STRING("older", previous.c_str());
+}
+
+void test_parse_rejects_damaged_traces(void) {
+    InputTrace::beginWake(ESP_SLEEP_WAKEUP_TIMER);
+    TEST_ASSERT_TRUE(InputTrace::start(1024));
+    InputTrace::recordHttp(millis(), "http://a/", 200, "body");
+    std::vector<uint8_t> data(InputTrace::data(), InputTrace::data() + InputTrace::size());
+
+    TraceHeader header;
+    std::vector<TraceEvent> events;
+    TEST_ASSERT_FALSE(InputTrace::parse(data.data(), data.size() - 2, header, events));
+    data[0] = 'X';
+    TEST_ASSERT_FALSE(InputTrace::parse(data.data(), data.size(), header, events));
+}
+
+void test_transport_serves_recorded_responses_in_order(void) {
+    std::vector<TraceEvent> events(3);
+    events[0].url = "http://api/weather";
+    events[0].value = 200;
+    events[0].durationMs = 900;
+    events[0].body = "first";
+    events[1].url = "http://api/weather";
+    events[1].value = HTTPC_ERROR_READ_TIMEOUT;
+    events[1].durationMs = 5000;
+    events[2].url = "http://images.local/photo.pgm";
+    events[2].value = 200;
+    events[2].durationMs = 7300;
+    events[2].bodyOmitted = true;
+
+    StaticTransport fixtures;
+    TraceTransport transport(events, &fixtures);
+
+    HostResponse first = transport.handle(requestFor("http://api/weather"));
+    TEST_ASSERT_EQUAL(200, first.status);
+    TEST_ASSERT_EQUAL_STRING("first", first.body.c_str());
+    TEST_ASSERT_EQUAL_UINT32(900, first.latencyMs);
+
+    HostResponse second = transport.handle(requestFor("http://api/weather"));
+    TEST_ASSERT_EQUAL(HTTPC_ERROR_READ_TIMEOUT, second.status);
+    TEST_ASSERT_EQUAL_UINT32(5000, second.latencyMs);
+
+    // Timing only: fixture body at the recorded latency
+    HostResponse image = transport.handle(requestFor("http://images.local/photo.pgm"));
+    TEST_ASSERT_EQUAL_STRING("fixture", image.body.c_str());
+    TEST_ASSERT_EQUAL_UINT32(7300, image.latencyMs);
+
+    // Off the recorded path
+    HostResponse extra = transport.handle(requestFor("http://api/weather"));
+    TEST_ASSERT_EQUAL_UINT32(50, extra.latencyMs);
+    TEST_ASSERT_EQUAL_UINT32(3, transport.getReplayed());
+    TEST_ASSERT_EQUAL_UINT32(1, transport.getUnmatched());
+    TEST_ASSERT_EQUAL_UINT32(0, transport.getUnused());
+}
+
+void test_replay_feeds_clock_wifi_battery_and_buttons(void) {
+    // Record a wake with a failed SNTP server, a slow association and a button press
+    InputTrace::beginWake(ESP_SLEEP_WAKEUP_EXT0);
+    TEST_ASSERT_TRUE(InputTrace::start(1024));
+    InputTrace::recordBattery(3.71f);
+    HostClock::advanceMillis(4500);
+    InputTrace::recordWiFi(0, true);
+    unsigned long started = millis();
+    HostClock::advanceMillis(10000);
+    InputTrace::recordTimeSync(started, 0);
+    started = millis();
+    HostClock::advanceMillis(2000);
+    InputTrace::recordTimeSync(started, 1717243200);
+    HostClock::advanceMillis(500);
+    InputTrace::recordButton(34, LOW);
+    TEST_ASSERT_TRUE(InputTrace::finish(900000));
+
+    TraceReplay replay;
+    TEST_ASSERT_TRUE(replay.load(InputTrace::data(), InputTrace::size()));
+    TEST_ASSERT_EQUAL_UINT32(17000, replay.recordedAwakeMs());
+
+    HostClock::setMicros(0);
+    replay.install(nullptr, 1704067200ULL * 1000000ULL);
+    TEST_ASSERT_EQUAL(ESP_SLEEP_WAKEUP_EXT0, esp_sleep_get_wakeup_cause());
+    TEST_ASSERT_FALSE(HostClock::isWallClockSynced());
+    TEST_ASSERT_EQUAL_FLOAT(3.71f, static_cast<float>(panel.readBattery()));
+
+    WiFi.disconnect(true);
+    WiFi.begin("host-network", "password");
+    delay(4000);
+    TEST_ASSERT_EQUAL(WL_DISCONNECTED, WiFi.status());
+    delay(500);
+    TEST_ASSERT_EQUAL(WL_CONNECTED, WiFi.status());
+
+    // First server never answers, the second after two seconds
+    configTime(0, 0, "pool.ntp.org");
+    delay(10000);
+    TEST_ASSERT_FALSE(HostClock::isWallClockSynced());
+    configTime(0, 0, "time.nist.gov");
+    delay(1000);
+    TEST_ASSERT_FALSE(HostClock::isWallClockSynced());
+    delay(1000);
+    TEST_ASSERT_EQUAL(1717243200, time(nullptr));
+
+    pinMode(34, INPUT_PULLUP);
+    replay.poll();
+    TEST_ASSERT_EQUAL(HIGH, digitalRead(34));
+    delay(500);
+    replay.poll();
+    TEST_ASSERT_EQUAL(LOW, digitalRead(34));
+
+    TEST_ASSERT_EQUAL_UINT32(0, replay.getDivergences());
+    replay.uninstall();
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+
+    UNITY_BEGIN();
+    RUN_TEST(test_events_round_trip);
+    RUN_TEST(test_recording_is_off_until_started);
+    RUN_TEST(test_budget_drops_bodies_then_truncates);
+    RUN_TEST(test_streamed_bodies_and_headers_are_kept);
+    RUN_TEST(test_previous_trace_is_kept);
+    RUN_TEST(test_parse_rejects_damaged_traces);
+    RUN_TEST(test_transport_serves_recorded_responses_in_order);
+    RUN_TEST(test_replay_feeds_clock_wifi_battery_and_buttons);
+    return UNITY_END();
+}
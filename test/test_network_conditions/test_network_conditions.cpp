@@ -0,0 +1,180 @@
+#include <unity.h>
+#include <string>
+#include "HostTransport.h"
+#include "HTTPClient.h"
+#include "WiFi.h"
+
+/**
+ * Answers every request with a body of a fixed size after a fixed server time
+ */
+class SizedTransport : public HostTransport {
+public:
+    SizedTransport(size_t size, uint32_t serverMs) : body(size, 'x'), serverMs(serverMs) {}
+
+    HostResponse handle(const HostRequest& request) override {
+        (void)request;
+        HostResponse response;
+        response.status = 200;
+        response.body = body;
+        response.latencyMs = serverMs;
+        return response;
+    }
+
+private:
+    std::string body;
+    uint32_t serverMs;
+};
+
+static HostRequest makeRequest(const char* url, uint32_t client, bool keepAlive) {
+    HostRequest request;
+    HostTransport::parseUrl(url, request);
+    request.method = "GET";
+    request.client = client;
+    request.keepAlive = keepAlive;
+    return request;
+}
+
+void setUp(void) {}
+
+void tearDown(void) {
+    HTTPClient::setTransport(nullptr);
+}
+
+void test_ideal_link_passes_responses_through(void) {
+    SizedTransport server(5000, 100);
+    NetworkConditionTransport::Profile ideal;
+    TEST_ASSERT_TRUE(NetworkConditionTransport::preset("ideal", ideal));
+    NetworkConditionTransport link(server, ideal);
+
+    HostResponse response = link.handle(makeRequest("https://example.com/a", 1, false));
+    TEST_ASSERT_EQUAL(200, response.status);
+    TEST_ASSERT_EQUAL(5000, response.body.size());
+    TEST_ASSERT_EQUAL_UINT32(100, response.latencyMs);
+}
+
+void test_handshakes_and_dns_are_charged_until_reused(void) {
+    SizedTransport server(100, 100);
+    NetworkConditionTransport::Profile good;
+    TEST_ASSERT_TRUE(NetworkConditionTransport::preset("good", good));
+    NetworkConditionTransport link(server, good);
+
+    // DNS 10 + TCP 20 + TLS 40 + request 20 + server 100 + one segment at 20 Mbit/s
+    TEST_ASSERT_EQUAL_UINT32(191, link.handle(makeRequest("https://example.com/a", 1, true)).latencyMs);
+    // Same keep-alive client: the connection is still open
+    TEST_ASSERT_EQUAL_UINT32(121, link.handle(makeRequest("https://example.com/b", 1, true)).latencyMs);
+    // Another client connects again, but the name is cached
+    TEST_ASSERT_EQUAL_UINT32(181, link.handle(makeRequest("https://example.com/c", 2, false)).latencyMs);
+    // Plain HTTP skips TLS; a new host needs a lookup
+    TEST_ASSERT_EQUAL_UINT32(151, link.handle(makeRequest("http://other.example.com/", 2, false)).latencyMs);
+
+    const NetworkConditionTransport::Counts& counts = link.getCounts();
+    TEST_ASSERT_EQUAL_UINT32(4, counts.requests);
+    TEST_ASSERT_EQUAL_UINT32(2, counts.dnsLookups);
+    TEST_ASSERT_EQUAL_UINT32(3, counts.handshakes);
+}
+
+void test_slow_start_and_bandwidth_shape_large_bodies(void) {
+    SizedTransport server(1000000, 0);
+    NetworkConditionTransport::Profile profile;
+    profile.rttMs = 100;
+    profile.bandwidthKbps = 8000;
+    NetworkConditionTransport link(server, profile);
+
+    // 685 segments in windows of 10, 20, 40, 80, 160, 320, 55: the first
+    // four are bound by the round trip, the rest by 1.46 ms per segment.
+    // TCP and the request add 200 ms.
+    HostResponse response = link.handle(makeRequest("http://example.com/big", 1, false));
+    TEST_ASSERT_UINT32_WITHIN(2, 1333, response.latencyMs);
+
+    // Unlimited bandwidth leaves only the round trips of slow start
+    profile.bandwidthKbps = 0;
+    NetworkConditionTransport unlimited(server, profile);
+    TEST_ASSERT_EQUAL_UINT32(800, unlimited.handle(makeRequest("http://example.com/big", 1, false)).latencyMs);
+}
+
+void test_loss_and_resets_are_reproducible(void) {
+    SizedTransport server(20000, 50);
+    NetworkConditionTransport::Profile weak;
+    TEST_ASSERT_TRUE(NetworkConditionTransport::preset("weak", weak));
+    NetworkConditionTransport first(server, weak, 42);
+    NetworkConditionTransport second(server, weak, 42);
+
+    uint32_t lost = 0;
+    for (uint32_t i = 0; i < 1000; i++) {
+        HostRequest request = makeRequest("https://example.com/image.png", i, false);
+        HostResponse fromFirst = first.handle(request);
+        HostResponse fromSecond = second.handle(request);
+        TEST_ASSERT_EQUAL(fromFirst.status, fromSecond.status);
+        TEST_ASSERT_EQUAL_UINT32(fromFirst.latencyMs, fromSecond.latencyMs);
+        if (fromFirst.status == HTTPC_ERROR_CONNECTION_LOST) {
+            TEST_ASSERT_TRUE(fromFirst.body.empty());
+            lost++;
+        }
+    }
+
+    const NetworkConditionTransport::Counts& counts = first.getCounts();
+    TEST_ASSERT_EQUAL_UINT32(lost, counts.resets);
+    TEST_ASSERT_UINT32_WITHIN(8, 10, counts.resets);
+    // 22 packets per request at 2% loss
+    TEST_ASSERT_UINT32_WITHIN(120, 440, counts.lostPackets);
+}
+
+void test_presets_get_slower_as_the_signal_drops(void) {
+    SizedTransport server(48 * 1024, 40);
+    const char* names[] = {"good", "fair", "weak", "poor"};
+    uint64_t previous = 0;
+    for (const char* name : names) {
+        NetworkConditionTransport::Profile profile;
+        TEST_ASSERT_TRUE(NetworkConditionTransport::preset(name, profile));
+        NetworkConditionTransport link(server, profile, 7);
+        uint64_t total = 0;
+        for (uint32_t i = 0; i < 200; i++) {
+            total += link.handle(makeRequest("https://example.com/image.png", i, false)).latencyMs;
+        }
+        TEST_ASSERT_TRUE(total > previous);
+        previous = total;
+    }
+
+    NetworkConditionTransport::Profile unchanged;
+    unchanged.rttMs = 5;
+    TEST_ASSERT_FALSE(NetworkConditionTransport::preset("lte", unchanged));
+    TEST_ASSERT_EQUAL_UINT32(5, unchanged.rttMs);
+}
+
+void test_http_client_reuses_its_connection(void) {
+    SizedTransport server(100, 0);
+    NetworkConditionTransport::Profile profile;
+    profile.rttMs = 50;
+    NetworkConditionTransport link(server, profile);
+    HTTPClient::setTransport(&link);
+    WiFi.begin("test");
+
+    HTTPClient reusing;
+    reusing.begin("https://example.com/a");
+    TEST_ASSERT_EQUAL(200, reusing.GET());
+    reusing.begin("https://example.com/b");
+    TEST_ASSERT_EQUAL(200, reusing.GET());
+    TEST_ASSERT_EQUAL_UINT32(1, link.getCounts().handshakes);
+
+    HTTPClient closing;
+    closing.setReuse(false);
+    closing.begin("https://example.com/a");
+    TEST_ASSERT_EQUAL(200, closing.GET());
+    closing.begin("https://example.com/b");
+    TEST_ASSERT_EQUAL(200, closing.GET());
+    TEST_ASSERT_EQUAL_UINT32(3, link.getCounts().handshakes);
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+
+    UNITY_BEGIN();
+    RUN_TEST(test_ideal_link_passes_responses_through);
+    RUN_TEST(test_handshakes_and_dns_are_charged_until_reused);
+    RUN_TEST(test_slow_start_and_bandwidth_shape_large_bodies);
+    RUN_TEST(test_loss_and_resets_are_reproducible);
+    RUN_TEST(test_presets_get_slower_as_the_signal_drops);
+    RUN_TEST(test_http_client_reuses_its_connection);
+    return UNITY_END();
+}
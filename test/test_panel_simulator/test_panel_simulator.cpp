@@ -0,0 +1,191 @@
+#include <unity.h>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+#include "MockInkplate.h"
+#include "HostClock.h"
+#include "core/Compositor.h"
+
+static Inkplate* panel = nullptr;
+
+void setUp(void) {
+    HostClock::setVirtual(true);
+    HostClock::setMicros(0);
+    panel = new Inkplate(INKPLATE_3BIT);
+    panel->begin();
+}
+
+void tearDown(void) {
+    delete panel;
+    panel = nullptr;
+}
+
+void test_full_refresh_in_3bit_mode_shows_gray_levels(void) {
+    panel->fillRect(10, 10, 20, 20, 3);
+    panel->display();
+
+    TEST_ASSERT_EQUAL_UINT8(3, panel->getPanelPixel(15, 15));
+    TEST_ASSERT_EQUAL_UINT8(7, panel->getPanelPixel(0, 0));
+    TEST_ASSERT_EQUAL_UINT32(1, panel->getStats().fullRefreshes);
+    TEST_ASSERT_EQUAL_UINT32(1, panel->getStats().fullRefreshes3Bit);
+    TEST_ASSERT_EQUAL_UINT64(400, panel->getStats().changedPixels);
+}
+
+void test_partial_update_is_ignored_in_3bit_mode(void) {
+    panel->fillRect(0, 0, 10, 10, 0);
+    TEST_ASSERT_EQUAL_UINT32(0, panel->partialUpdate());
+
+    TEST_ASSERT_EQUAL_UINT32(1, panel->getStats().ignoredPartials);
+    TEST_ASSERT_EQUAL_UINT32(0, panel->getStats().partialRefreshes);
+    TEST_ASSERT_EQUAL_UINT8(7, panel->getPanelPixel(5, 5));
+}
+
+void test_mode_switch_clears_buffers_and_blocks_partial(void) {
+    panel->fillRect(0, 0, 10, 10, 0);
+    panel->setDisplayMode(INKPLATE_1BIT);
+
+    TEST_ASSERT_EQUAL_UINT32(1, panel->getStats().modeSwitches);
+    TEST_ASSERT_EQUAL_UINT8(WHITE, panel->getPixel(5, 5));
+
+    // First partial after the switch becomes a full 1-bit refresh
+    panel->fillRect(0, 0, 4, 4, BLACK);
+    TEST_ASSERT_EQUAL_UINT32(0, panel->partialUpdate());
+    TEST_ASSERT_EQUAL_UINT32(1, panel->getStats().blockedPartials);
+    TEST_ASSERT_EQUAL_UINT32(1, panel->getStats().fullRefreshes);
+    TEST_ASSERT_EQUAL_UINT8(0, panel->getPanelPixel(1, 1));
+}
+
+void test_partial_update_counts_changed_pixels(void) {
+    panel->setDisplayMode(INKPLATE_1BIT);
+    panel->display();
+
+    panel->fillRect(100, 100, 10, 5, BLACK);
+    TEST_ASSERT_EQUAL_UINT32(50, panel->partialUpdate());
+    TEST_ASSERT_EQUAL_UINT32(1, panel->getStats().partialRefreshes);
+    TEST_ASSERT_EQUAL_UINT8(0, panel->getPanelPixel(105, 102));
+
+    // Nothing changed since the last update
+    TEST_ASSERT_EQUAL_UINT32(0, panel->partialUpdate());
+}
+
+void test_1bit_buffers_follow_library_roles(void) {
+    panel->setDisplayMode(INKPLATE_1BIT);
+    panel->display();
+    size_t stride = E_INK_WIDTH / 8;
+
+    // Drawing lands in _partial, leftmost pixel in the low bit
+    panel->drawPixel(1, 2, BLACK);
+    TEST_ASSERT_EQUAL_HEX8(0x02, panel->_partial[2 * stride]);
+    TEST_ASSERT_EQUAL_HEX8(0x00, panel->DMemoryNew[2 * stride]);
+
+    // partialUpdate() compares against DMemoryNew, then takes _partial
+    TEST_ASSERT_EQUAL_UINT32(1, panel->partialUpdate());
+    TEST_ASSERT_EQUAL_HEX8(0x02, panel->DMemoryNew[2 * stride]);
+    TEST_ASSERT_EQUAL_UINT8(0, panel->getPanelPixel(1, 2));
+
+    // preloadScreen() takes _partial as what is shown, without drawing it
+    panel->_partial[0] = 0x01;
+    panel->preloadScreen();
+    TEST_ASSERT_EQUAL_HEX8(0x01, panel->DMemoryNew[0]);
+    TEST_ASSERT_EQUAL_UINT8(7, panel->getPanelPixel(0, 0));
+    TEST_ASSERT_EQUAL_UINT32(0, panel->partialUpdate());
+}
+
+void test_cost_model_advances_clock_and_energy(void) {
+    PanelCostModel model;
+    model.fullRefresh3BitMs = 2000;
+    model.powerUpMs = 0;
+    model.refreshCurrentMa = 100.0f;
+    model.supplyVoltage = 4.0f;
+    panel->setCostModel(model);
+
+    unsigned long before = millis();
+    panel->display();
+
+    TEST_ASSERT_EQUAL_UINT32(2000, millis() - before);
+    TEST_ASSERT_EQUAL_UINT64(2000, panel->getStats().refreshMs);
+    // 4 V * 100 mA * 2 s = 800 mJ
+    TEST_ASSERT_DOUBLE_WITHIN(0.01, 800.0, panel->getStats().energyMj);
+}
+
+void test_text_draws_glyph_boxes_with_gfx_metrics(void) {
+    panel->setTextSize(2);
+    panel->setTextColor(0);
+    panel->setCursor(50, 60);
+    panel->print("Hi");
+
+    TEST_ASSERT_EQUAL_INT(50 + 2 * 12, panel->getCursorX());
+    TEST_ASSERT_EQUAL_UINT8(0, panel->getPixel(51, 61));
+    TEST_ASSERT_EQUAL_UINT8(7, panel->getPixel(50 + 11, 61));  // Inter-character gap
+
+    int16_t x1, y1;
+    uint16_t w, h;
+    panel->getTextBounds("Hello", 0, 0, &x1, &y1, &w, &h);
+    TEST_ASSERT_EQUAL_UINT16(60, w);
+    TEST_ASSERT_EQUAL_UINT16(16, h);
+}
+
+void test_frame_capture_writes_pgm_and_png(void) {
+    char directory[] = "/tmp/panel_capture_XXXXXX";
+    TEST_ASSERT_NOT_NULL(mkdtemp(directory));
+
+    panel->setFrameCapture(directory, FrameWriter::Format::PGM);
+    panel->display();
+    std::string pgmPath = panel->getLastCapturePath();
+    TEST_ASSERT_TRUE(pgmPath.find("frame_00001_full.pgm") != std::string::npos);
+
+    FILE* file = fopen(pgmPath.c_str(), "rb");
+    TEST_ASSERT_NOT_NULL(file);
+    char header[32] = {0};
+    TEST_ASSERT_TRUE(fgets(header, sizeof(header), file) != nullptr);
+    fclose(file);
+    TEST_ASSERT_EQUAL_STRING("P5\n", header);
+
+    panel->setFrameCapture(directory, FrameWriter::Format::PNG);
+    panel->display();
+    std::string pngPath = panel->getLastCapturePath();
+    file = fopen(pngPath.c_str(), "rb");
+    TEST_ASSERT_NOT_NULL(file);
+    unsigned char signature[8] = {0};
+    TEST_ASSERT_EQUAL(8, fread(signature, 1, sizeof(signature), file));
+    fclose(file);
+    TEST_ASSERT_EQUAL_HEX8(0x89, signature[0]);
+    TEST_ASSERT_EQUAL_HEX8('P', signature[1]);
+
+    remove(pgmPath.c_str());
+    remove(pngPath.c_str());
+    rmdir(directory);
+}
+
+void test_compositor_output_reaches_panel(void) {
+    Compositor compositor(1200, 825);
+    compositor.setMemoryPressureThreshold(SIZE_MAX);
+    TEST_ASSERT_TRUE(compositor.initialize());
+
+    compositor.fillRect(200, 100, 50, 50, 0);
+    compositor.fillRect(300, 100, 50, 50, 128);
+    TEST_ASSERT_TRUE(compositor.displayToInkplate(*panel));
+
+    TEST_ASSERT_EQUAL_UINT8(0, panel->getPanelPixel(225, 125));
+    TEST_ASSERT_EQUAL_UINT8(4, panel->getPanelPixel(325, 125));
+    TEST_ASSERT_EQUAL_UINT8(7, panel->getPanelPixel(10, 10));
+    TEST_ASSERT_EQUAL_UINT32(1, panel->getStats().fullRefreshes);
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    Serial.setOutput(nullptr);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_full_refresh_in_3bit_mode_shows_gray_levels);
+    RUN_TEST(test_partial_update_is_ignored_in_3bit_mode);
+    RUN_TEST(test_mode_switch_clears_buffers_and_blocks_partial);
+    RUN_TEST(test_partial_update_counts_changed_pixels);
+    RUN_TEST(test_1bit_buffers_follow_library_roles);
+    RUN_TEST(test_cost_model_advances_clock_and_energy);
+    RUN_TEST(test_text_draws_glyph_boxes_with_gfx_metrics);
+    RUN_TEST(test_frame_capture_writes_pgm_and_png);
+    RUN_TEST(test_compositor_output_reaches_panel);
+    return UNITY_END();
+}
@@ -0,0 +1,237 @@
+#include <unity.h>
+#include <string>
+#include <vector>
+#include "FrameCache.h"
+#include "HostClock.h"
+#include "HostTransport.h"
+#include "HTTPClient.h"
+#include "MockInkplate.h"
+#include "WiFi.h"
+#include "core/WakeMetrics.h"
+#include "managers/FrameClient.h"
+
+static const int WIDTH = E_INK_WIDTH;
+static const int HEIGHT = E_INK_HEIGHT;
+static const uint64_t CONFIG = 0x1234;
+
+// Screen with two side-by-side regions, everything white
+static std::vector<uint8_t> whiteScreen() {
+    return std::vector<uint8_t>(static_cast<size_t>(WIDTH) * HEIGHT, 7);
+}
+
+static std::vector<FrameRegion> twoRegions() {
+    return {FrameRegion{0, 0, WIDTH / 2, HEIGHT}, FrameRegion{WIDTH / 2, 0, WIDTH / 2, HEIGHT}};
+}
+
+static void fillLevels(std::vector<uint8_t>& levels, int x, int y, int w, int h, uint8_t level) {
+    for (int row = y; row < y + h; row++) {
+        for (int col = x; col < x + w; col++) {
+            levels[static_cast<size_t>(row) * WIDTH + col] = level;
+        }
+    }
+}
+
+/**
+ * The server's frame endpoint over one config, without the render child
+ */
+class CacheTransport : public HostTransport {
+public:
+    explicit CacheTransport(FrameCache& cache) : cache(cache) {}
+
+    HostResponse handle(const HostRequest& request) override {
+        requests++;
+        HostResponse response;
+        response.latencyMs = 100;
+        uint32_t since = static_cast<uint32_t>(atol(queryParam(request.query, "since", "0").c_str()));
+        std::vector<uint8_t> body;
+        response.status = cache.answer(CONFIG, *cache.latest(CONFIG), since, INKPLATE_3BIT, body);
+        response.body.assign(body.begin(), body.end());
+        return response;
+    }
+
+    FrameCache& cache;
+    uint32_t requests = 0;
+};
+
+static void wake(Inkplate& display) {
+    display.begin();
+    display.setDisplayMode(INKPLATE_3BIT);
+    display.clearDisplay();
+}
+
+static void assertPanelShows(Inkplate& display, const std::vector<uint8_t>& levels) {
+    for (int y = 0; y < HEIGHT; y += 3) {
+        for (int x = 0; x < WIDTH; x += 3) {
+            if (display.getPanelPixel(x, y) != levels[static_cast<size_t>(y) * WIDTH + x]) {
+                char message[64];
+                snprintf(message, sizeof(message), "pixel (%d,%d)", x, y);
+                TEST_FAIL_MESSAGE(message);
+            }
+        }
+    }
+}
+
+void setUp(void) {
+    HostClock::setVirtual(true);
+    HostClock::setMicros(0);
+    WakeMetrics::beginWake();
+    FrameClient::forgetShownFrame();
+    WiFi.setConnectDelayMs(0);
+    WiFi.setNetworkAvailable(true);
+    WiFi.begin("host-network", "password");
+}
+
+void tearDown(void) {
+    WiFi.disconnect(true);
+    HTTPClient::setTransport(nullptr);
+}
+
+void test_unchanged_render_keeps_frame_id(void) {
+    FrameCache cache(500);
+    std::vector<uint8_t> levels = whiteScreen();
+    fillLevels(levels, 16, 16, 200, 40, 0);
+
+    const RenderedFrame& first = cache.store(CONFIG, 1, WIDTH, HEIGHT, levels, twoRegions());
+    TEST_ASSERT_EQUAL(500, first.id);
+    TEST_ASSERT_TRUE(&first == cache.find(CONFIG, 1));
+    TEST_ASSERT_NULL(cache.find(CONFIG, 2));
+    TEST_ASSERT_NULL(cache.find(CONFIG + 1, 1));
+
+    // New data version, same picture: devices showing it are up to date
+    const RenderedFrame& second = cache.store(CONFIG, 2, WIDTH, HEIGHT, levels, twoRegions());
+    TEST_ASSERT_EQUAL(500, second.id);
+    TEST_ASSERT_TRUE(&second == cache.find(CONFIG, 1));
+    TEST_ASSERT_TRUE(&second == cache.find(CONFIG, 2));
+    TEST_ASSERT_EQUAL(2, cache.getRenders());
+    TEST_ASSERT_EQUAL(1, cache.getReused());
+
+    std::vector<uint8_t> body;
+    TEST_ASSERT_EQUAL(304, cache.answer(CONFIG, second, 500, INKPLATE_3BIT, body));
+    TEST_ASSERT_EQUAL(0, body.size());
+
+    // Full frame covers just what is drawn
+    TEST_ASSERT_EQUAL(200, cache.answer(CONFIG, second, 0, INKPLATE_3BIT, body));
+    PanelFrame frame;
+    TEST_ASSERT_TRUE(frame.parse(body.data(), body.size()));
+    TEST_ASSERT_FALSE(frame.isDelta());
+    TEST_ASSERT_EQUAL(INKPLATE_3BIT, frame.getHeader().mode);
+    TEST_ASSERT_EQUAL(1, frame.getRectCount());
+    TEST_ASSERT_EQUAL(16, frame.getRect(0).x);
+    TEST_ASSERT_EQUAL(16, frame.getRect(0).y);
+    TEST_ASSERT_EQUAL(200, frame.getRect(0).width);
+    TEST_ASSERT_EQUAL(40, frame.getRect(0).height);
+}
+
+void test_delta_covers_only_changed_regions(void) {
+    FrameCache cache(10);
+    std::vector<uint8_t> before = whiteScreen();
+    fillLevels(before, 40, 40, 300, 60, 0);
+    fillLevels(before, 700, 40, 300, 60, 0);
+    fillLevels(before, 40, 400, 200, 200, 3);
+    std::vector<uint8_t> after = before;
+    fillLevels(after, 650, 300, 37, 20, 0);
+    fillLevels(after, 900, 500, 10, 10, 0);
+    fillLevels(after, 700, 40, 100, 60, 7);
+
+    const RenderedFrame& base = cache.store(CONFIG, 1, WIDTH, HEIGHT, before, twoRegions());
+    const RenderedFrame& next = cache.store(CONFIG, 2, WIDTH, HEIGHT, after, twoRegions());
+    TEST_ASSERT_NOT_EQUAL(base.id, next.id);
+
+    // All changes are in the right region: one box, widened to whole bytes
+    std::vector<PanelFrameRect> rects = FrameCache::changedRects(next, base);
+    TEST_ASSERT_EQUAL(1, rects.size());
+    TEST_ASSERT_EQUAL(648, rects[0].x);
+    TEST_ASSERT_EQUAL(40, rects[0].y);
+    TEST_ASSERT_EQUAL(264, rects[0].width);
+    TEST_ASSERT_EQUAL(470, rects[0].height);
+
+    // Presented on a thin client: full 3-bit frame, then a partial after deep sleep
+    cache.store(CONFIG, 1, WIDTH, HEIGHT, before, twoRegions());
+    CacheTransport server(cache);
+    HTTPClient::setTransport(&server);
+    Inkplate display(INKPLATE_3BIT);
+    display.setChargeClock(false);
+    wake(display);
+    FrameClient client(display, "http://frames.local/frame/default", 3600000UL);
+    TEST_ASSERT_TRUE(client.update());
+    TEST_ASSERT_EQUAL(base.id, FrameClient::getShownFrameId());
+    TEST_ASSERT_EQUAL(1, display.getStats().fullRefreshes);
+    assertPanelShows(display, before);
+
+    cache.store(CONFIG, 2, WIDTH, HEIGHT, after, twoRegions());
+    wake(display);
+    TEST_ASSERT_TRUE(client.update());
+    TEST_ASSERT_EQUAL(next.id, FrameClient::getShownFrameId());
+    TEST_ASSERT_EQUAL(1, display.getStats().fullRefreshes);
+    TEST_ASSERT_EQUAL(1, display.getStats().partialRefreshes);
+    TEST_ASSERT_EQUAL(1, client.getLastRectCount());
+    TEST_ASSERT_TRUE(client.getLastFrameBytes() < 2048);
+    assertPanelShows(display, after);
+}
+
+void test_gray_or_large_changes_send_full_frames(void) {
+    FrameCache cache(10);
+    std::vector<uint8_t> before = whiteScreen();
+    fillLevels(before, 40, 40, 200, 200, 4);
+    std::vector<uint8_t> gray = before;
+    fillLevels(gray, 40, 40, 200, 200, 2);
+    std::vector<uint8_t> large = whiteScreen();
+    fillLevels(large, 0, 0, WIDTH, HEIGHT * 2 / 3, 0);
+
+    const RenderedFrame& base = cache.store(CONFIG, 1, WIDTH, HEIGHT, before, twoRegions());
+    std::vector<uint8_t> body;
+    PanelFrame frame;
+
+    // A 1-bit partial cannot change one gray into another
+    const RenderedFrame& grayer = cache.store(CONFIG, 2, WIDTH, HEIGHT, gray, twoRegions());
+    TEST_ASSERT_FALSE(FrameCache::encodeDelta(grayer, base, body));
+    TEST_ASSERT_EQUAL(200, cache.answer(CONFIG, grayer, base.id, INKPLATE_3BIT, body));
+    TEST_ASSERT_TRUE(frame.parse(body.data(), body.size()));
+    TEST_ASSERT_FALSE(frame.isDelta());
+
+    // Redrawing most of the panel is cheaper as a full refresh
+    const RenderedFrame& white = cache.store(CONFIG, 3, WIDTH, HEIGHT, whiteScreen(), twoRegions());
+    const RenderedFrame& dark = cache.store(CONFIG, 4, WIDTH, HEIGHT, large, twoRegions());
+    TEST_ASSERT_EQUAL(200, cache.answer(CONFIG, dark, white.id, INKPLATE_1BIT, body));
+    TEST_ASSERT_TRUE(frame.parse(body.data(), body.size()));
+    TEST_ASSERT_FALSE(frame.isDelta());
+    TEST_ASSERT_EQUAL(INKPLATE_1BIT, frame.getHeader().mode);
+}
+
+void test_history_is_bounded_per_config(void) {
+    FrameCache cache(10, 2);
+    std::vector<uint8_t> levels = whiteScreen();
+    uint32_t ids[3];
+    for (int i = 0; i < 3; i++) {
+        fillLevels(levels, 80 * i, 0, 8, 8, 0);
+        ids[i] = cache.store(CONFIG, static_cast<uint64_t>(i + 1), WIDTH, HEIGHT, levels, twoRegions()).id;
+    }
+    cache.store(CONFIG + 1, 1, WIDTH, HEIGHT, whiteScreen(), twoRegions());
+
+    TEST_ASSERT_EQUAL(2, cache.getConfigCount());
+    TEST_ASSERT_NULL(cache.findById(CONFIG, ids[0]));
+    TEST_ASSERT_NULL(cache.find(CONFIG, 1));
+    TEST_ASSERT_NOT_NULL(cache.findById(CONFIG, ids[1]));
+    TEST_ASSERT_EQUAL(ids[2], cache.latest(CONFIG)->id);
+    TEST_ASSERT_NULL(cache.findById(CONFIG + 1, ids[2]));
+
+    // A device on a forgotten frame gets the whole screen; one on a kept frame a delta
+    std::vector<uint8_t> body;
+    PanelFrame frame;
+    cache.answer(CONFIG, *cache.latest(CONFIG), ids[0], INKPLATE_3BIT, body);
+    TEST_ASSERT_TRUE(frame.parse(body.data(), body.size()));
+    TEST_ASSERT_FALSE(frame.isDelta());
+    cache.answer(CONFIG, *cache.latest(CONFIG), ids[1], INKPLATE_3BIT, body);
+    TEST_ASSERT_TRUE(frame.parse(body.data(), body.size()));
+    TEST_ASSERT_TRUE(frame.isDelta());
+    TEST_ASSERT_EQUAL(ids[1], frame.getHeader().baseId);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_unchanged_render_keeps_frame_id);
+    RUN_TEST(test_delta_covers_only_changed_regions);
+    RUN_TEST(test_gray_or_large_changes_send_full_frames);
+    RUN_TEST(test_history_is_bounded_per_config);
+    return UNITY_END();
+}
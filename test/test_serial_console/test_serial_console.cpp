@@ -0,0 +1,204 @@
+#include <unity.h>
+#include <cstring>
+#include <string>
+#include "HostClock.h"
+#include "core/Logger.h"
+#include "core/SerialConsole.h"
+#include "core/WakeMetrics.h"
+
+/**
+ * Serial port stand-in: input is queued by the test, output is collected
+ */
+class ScriptedStream : public Stream {
+public:
+    void type(const char* text) { input += text; }
+
+    int available() override { return static_cast<int>(input.size() - position); }
+    int read() override { return position < input.size() ? static_cast<unsigned char>(input[position++]) : -1; }
+    int peek() override { return position < input.size() ? static_cast<unsigned char>(input[position]) : -1; }
+
+    size_t write(uint8_t c) override {
+        output += static_cast<char>(c);
+        return 1;
+    }
+    size_t write(const uint8_t* buffer, size_t size) override {
+        output.append(reinterpret_cast<const char*>(buffer), size);
+        return size;
+    }
+    using Print::write;
+
+    bool printed(const char* text) const { return output.find(text) != std::string::npos; }
+
+    std::string output;
+
+private:
+    std::string input;
+    size_t position = 0;
+};
+
+void setUp(void) {
+    HostClock::setVirtual(true);
+    HostClock::setMicros(0);
+    Logger::setLogLevel(LogLevel::INFO);
+    Logger::clearTagLevels();
+    WakeMetrics::beginWake();
+}
+
+void tearDown(void) {
+    Logger::setLogLevel(LogLevel::INFO);
+    Logger::clearTagLevels();
+}
+
+void test_tag_level_overrides_global_level(void) {
+    TEST_ASSERT_FALSE(Logger::isEnabled(LogLevel::DEBUG, "WiFiManager"));
+
+    TEST_ASSERT_TRUE(Logger::setTagLevel("WiFiManager", LogLevel::DEBUG));
+    TEST_ASSERT_TRUE(Logger::isEnabled(LogLevel::DEBUG, "WiFiManager"));
+    TEST_ASSERT_FALSE(Logger::isEnabled(LogLevel::DEBUG, "LayoutManager"));
+
+    // Quieter than the global level works too
+    TEST_ASSERT_TRUE(Logger::setTagLevel("Compositor", LogLevel::ERROR));
+    TEST_ASSERT_FALSE(Logger::isEnabled(LogLevel::WARN, "Compositor"));
+    TEST_ASSERT_TRUE(Logger::isEnabled(LogLevel::WARN, "LayoutManager"));
+
+    Logger::clearTagLevel("WiFiManager");
+    TEST_ASSERT_FALSE(Logger::isEnabled(LogLevel::DEBUG, "WiFiManager"));
+    TEST_ASSERT_EQUAL(1, Logger::getTagLevelCount());
+
+    // The table is bounded
+    char tag[16];
+    for (size_t i = 0; i < Logger::MAX_TAG_LEVELS - 1; i++) {
+        snprintf(tag, sizeof(tag), "Tag%u", static_cast<unsigned>(i));
+        TEST_ASSERT_TRUE(Logger::setTagLevel(tag, LogLevel::DEBUG));
+    }
+    TEST_ASSERT_FALSE(Logger::setTagLevel("OneTooMany", LogLevel::DEBUG));
+    TEST_ASSERT_FALSE(Logger::setTagLevel("ThisTagNameIsFarTooLongToKeep", LogLevel::DEBUG));
+}
+
+void test_console_runs_lines_split_across_polls(void) {
+    ScriptedStream stream;
+    SerialConsole console(stream);
+    int calls = 0;
+    std::string lastArgument;
+    console.addCommand("echo", "<word>", "Echo a word", [&](int argc, char* argv[], Print& out) {
+        calls++;
+        lastArgument = argc > 1 ? argv[1] : "";
+        out.printf("echo %s\n", lastArgument.c_str());
+    });
+
+    stream.type("ec");
+    console.poll();
+    TEST_ASSERT_EQUAL(0, calls);
+
+    stream.type("ho  first\r\n\nECHO second\n");
+    console.poll();
+    TEST_ASSERT_EQUAL(2, calls);
+    TEST_ASSERT_EQUAL_STRING("second", lastArgument.c_str());
+    TEST_ASSERT_TRUE(stream.printed("echo first\n"));
+
+    // Nothing buffered: poll returns without waiting
+    uint64_t before = HostClock::micros();
+    console.poll();
+    TEST_ASSERT_EQUAL(before, HostClock::micros());
+
+    stream.type("bogus\n");
+    console.poll();
+    TEST_ASSERT_TRUE(stream.printed("unknown command 'bogus'"));
+
+    std::string longLine(SerialConsole::MAX_LINE + 10, 'x');
+    stream.type((longLine + "\n").c_str());
+    console.poll();
+    TEST_ASSERT_TRUE(stream.printed("line longer than"));
+    TEST_ASSERT_EQUAL(2, calls);
+
+    stream.type("help\n");
+    console.poll();
+    TEST_ASSERT_TRUE(stream.printed("echo <word>"));
+    TEST_ASSERT_TRUE(stream.printed("metrics"));
+}
+
+void test_log_command_sets_global_and_tag_levels(void) {
+    ScriptedStream stream;
+    SerialConsole console(stream);
+
+    stream.type("log warn\nlog WiFiManager debug\n");
+    console.poll();
+    TEST_ASSERT_EQUAL(LogLevel::WARN, Logger::getLogLevel());
+    TEST_ASSERT_EQUAL(LogLevel::DEBUG, Logger::getEffectiveLevel("WiFiManager"));
+    TEST_ASSERT_TRUE(stream.printed("WiFiManager"));
+
+    stream.type("log WiFiManager default\nlog chatty\n");
+    console.poll();
+    TEST_ASSERT_EQUAL(LogLevel::WARN, Logger::getEffectiveLevel("WiFiManager"));
+    TEST_ASSERT_EQUAL(0, Logger::getTagLevelCount());
+    TEST_ASSERT_TRUE(stream.printed("unknown level 'chatty'"));
+}
+
+void test_metrics_accumulate_repeated_phases(void) {
+    delay(100);
+    {
+        WakeMetrics::Phase phase("wifi");
+        delay(1500);
+    }
+    for (int i = 0; i < 3; i++) {
+        WakeMetrics::Phase phase("render.partial");
+        delay(200 + 100 * i);
+    }
+
+    const PhaseTiming* wifi = WakeMetrics::findPhase("wifi");
+    TEST_ASSERT_NOT_NULL(wifi);
+    TEST_ASSERT_EQUAL(1, wifi->count);
+    TEST_ASSERT_EQUAL(100, wifi->firstStartMs);
+    TEST_ASSERT_EQUAL(1500000, wifi->totalMicros);
+
+    const PhaseTiming* render = WakeMetrics::findPhase("render.partial");
+    TEST_ASSERT_NOT_NULL(render);
+    TEST_ASSERT_EQUAL(3, render->count);
+    TEST_ASSERT_EQUAL(900000, render->totalMicros);
+    TEST_ASSERT_EQUAL(400000, render->maxMicros);
+    TEST_ASSERT_EQUAL(400000, render->lastMicros);
+
+    ScriptedStream stream;
+    SerialConsole console(stream);
+    stream.type("metrics\n");
+    console.poll();
+    TEST_ASSERT_TRUE(stream.printed("awake 2500 ms, 2 phases"));
+    TEST_ASSERT_TRUE(stream.printed("render.partial"));
+
+    // A new wake starts empty; overflow is counted, not stored
+    WakeMetrics::beginWake();
+    TEST_ASSERT_EQUAL(0, WakeMetrics::getPhaseCount());
+    static const char* names[] = {"p0", "p1", "p2", "p3", "p4", "p5", "p6", "p7", "p8",
+                                  "p9", "p10", "p11", "p12", "p13", "p14", "p15", "p16"};
+    for (const char* name : names) {
+        WakeMetrics::record(name, 0, 1000);
+    }
+    TEST_ASSERT_EQUAL(WakeMetrics::MAX_PHASES, WakeMetrics::getPhaseCount());
+    TEST_ASSERT_EQUAL(1, WakeMetrics::getDroppedPhases());
+}
+
+void test_console_activity_keeps_unit_awake(void) {
+    ScriptedStream stream;
+    SerialConsole console(stream);
+    TEST_ASSERT_TRUE(console.isIdle(30000));
+
+    delay(5000);
+    stream.type("mem\n");
+    console.poll();
+    TEST_ASSERT_TRUE(stream.printed("internal free"));
+    TEST_ASSERT_EQUAL(5000, console.getLastCommandMs());
+    TEST_ASSERT_FALSE(console.isIdle(30000));
+
+    delay(30000);
+    TEST_ASSERT_TRUE(console.isIdle(30000));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_tag_level_overrides_global_level);
+    RUN_TEST(test_console_runs_lines_split_across_polls);
+    RUN_TEST(test_log_command_sets_global_and_tag_levels);
+    RUN_TEST(test_metrics_accumulate_repeated_phases);
+    RUN_TEST(test_console_activity_keeps_unit_awake);
+    return UNITY_END();
+}
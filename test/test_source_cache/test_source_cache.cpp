@@ -0,0 +1,366 @@
+#include <unity.h>
+#include <string>
+#include "HostClock.h"
+#include "HostTransport.h"
+#include "HTTPClient.h"
+#include "SPIFFS.h"
+#include "WiFi.h"
+#include "core/SourceCache.h"
+#include "core/Storage.h"
+#include "widgets/chart/ChartWidget.h"
+#include "widgets/image/ImageWidget.h"
+#include "widgets/weather/HourlyForecast.h"
+#include "widgets/weather/WeatherWidget.h"
+
+// 2024-01-15 08:00 UTC
+static const uint32_t NOW = 1705305600;
+static const uint32_t HOUR = 3600;
+
+static Inkplate* panel = nullptr;
+
+/**
+ * Weather server: current conditions and the first forecast hour with a
+ * settable temperature, or a failure status.
+ */
+class WeatherServer : public HostTransport {
+public:
+    int temperature = 61;
+    int status = 200;
+    int requests = 0;
+
+    HostResponse handle(const HostRequest& request) override {
+        (void)request;
+        requests++;
+        HostResponse response;
+        response.latencyMs = 800;
+        response.status = status;
+        if (status == 200) {
+            response.body = "{\"current_weather\":{\"temperature\":" + std::to_string(temperature) +
+                            ",\"weathercode\":2},\"hourly\":{\"time\":[1705305600,1705309200],"
+                            "\"temperature_2m\":[" + std::to_string(temperature) + ",62],\"precipitation_probability\":[10,20]}}";
+        }
+        return response;
+    }
+};
+
+/**
+ * Image server: a 2x1 binary PGM whose first pixel is settable, or any
+ * other body, or a failure status.
+ */
+class ImageServer : public HostTransport {
+public:
+    std::string body = pgm(0x00);
+    int status = 200;
+    int requests = 0;
+
+    static std::string pgm(uint8_t firstPixel) {
+        return std::string("P5\n2 1\n255\n") + static_cast<char>(firstPixel) + '\xff';
+    }
+
+    HostResponse handle(const HostRequest& request) override {
+        (void)request;
+        requests++;
+        HostResponse response;
+        response.latencyMs = 800;
+        response.status = status;
+        if (status == 200) {
+            response.body = body;
+        }
+        return response;
+    }
+};
+
+static const char* IMAGE_URL = "http://images.local/photo.pgm";
+
+static void setClock(uint32_t epoch) {
+    HostClock::setWallClockSynced(true);
+    HostClock::setBootEpochMicros(static_cast<uint64_t>(epoch) * 1000000ULL - HostClock::micros());
+}
+
+void setUp(void) {
+    HostClock::setVirtual(true);
+    HostClock::setMicros(1000000);
+    setClock(NOW);
+    Storage::reset();
+    SPIFFS.clearFiles();
+    TEST_ASSERT_TRUE(Storage::begin());
+    WiFi.setConnectDelayMs(0);
+    WiFi.setNetworkAvailable(true);
+    WiFi.begin("host-network", "password");
+    panel = new Inkplate(INKPLATE_3BIT);
+    panel->begin();
+}
+
+void tearDown(void) {
+    WiFi.disconnect(true);
+    HTTPClient::setTransport(nullptr);
+    delete panel;
+    panel = nullptr;
+}
+
+void test_freshness_policy(void) {
+    TEST_ASSERT_EQUAL(static_cast<int>(Freshness::FRESH),
+                      static_cast<int>(SourceCache::classify(NOW, NOW + 60, HOUR, 24 * HOUR)));
+    TEST_ASSERT_EQUAL(static_cast<int>(Freshness::STALE),
+                      static_cast<int>(SourceCache::classify(NOW, NOW + HOUR, HOUR, 24 * HOUR)));
+    TEST_ASSERT_EQUAL(static_cast<int>(Freshness::EXPIRED),
+                      static_cast<int>(SourceCache::classify(NOW, NOW + 24 * HOUR, HOUR, 24 * HOUR)));
+    // Age unknown: shown, but asked again
+    TEST_ASSERT_EQUAL(static_cast<int>(Freshness::STALE),
+                      static_cast<int>(SourceCache::classify(0, NOW, HOUR, 24 * HOUR)));
+    TEST_ASSERT_EQUAL(static_cast<int>(Freshness::STALE),
+                      static_cast<int>(SourceCache::classify(NOW, 1000, HOUR, 24 * HOUR)));
+    TEST_ASSERT_EQUAL(static_cast<int>(Freshness::STALE),
+                      static_cast<int>(SourceCache::classify(NOW, NOW - 60, HOUR, 24 * HOUR)));
+}
+
+void test_value_survives_until_it_expires(void) {
+    SourceCache cache("weather:1,2", HOUR, 24 * HOUR);
+    String body;
+    TEST_ASSERT_FALSE(cache.load(body));
+    TEST_ASSERT_TRUE(cache.store(String("{\"a\":1}")));
+
+    SourceCache again("weather:1,2", HOUR, 24 * HOUR);
+    TEST_ASSERT_TRUE(again.load(body));
+    TEST_ASSERT_EQUAL_STRING("{\"a\":1}", body.c_str());
+    TEST_ASSERT_EQUAL_UINT32(NOW, again.getFetchedAt());
+    TEST_ASSERT_EQUAL(static_cast<int>(Freshness::FRESH), static_cast<int>(again.getFreshness()));
+
+    // Another key never reads it
+    SourceCache other("weather:3,4", HOUR, 24 * HOUR);
+    TEST_ASSERT_FALSE(other.load(body));
+
+    setClock(NOW + 2 * HOUR);
+    TEST_ASSERT_EQUAL(static_cast<int>(Freshness::STALE), static_cast<int>(again.getFreshness()));
+    setClock(NOW + 25 * HOUR);
+    TEST_ASSERT_FALSE(again.load(body));
+    TEST_ASSERT_FALSE(again.hasValue());
+}
+
+void test_weather_draws_from_cache_and_revalidates(void) {
+    WeatherServer server;
+    HTTPClient::setTransport(&server);
+    LayoutRegion region(0, 0, 300, 200);
+
+    // Nothing cached: the first render has to wait for the server
+    {
+        WeatherWidget widget(*panel, "47.6", "-122.3", "Seattle", "fahrenheit");
+        widget.begin();
+        TEST_ASSERT_FALSE(widget.isWeatherDataValid());
+        widget.render(region);
+        TEST_ASSERT_EQUAL(1, server.requests);
+        TEST_ASSERT_TRUE(widget.isWeatherDataValid());
+        TEST_ASSERT_FALSE(widget.revalidate());
+        TEST_ASSERT_EQUAL(1, server.requests);
+    }
+
+    // Next wake, still fresh: drawn without asking
+    setClock(NOW + 600);
+    {
+        WeatherWidget widget(*panel, "47.6", "-122.3", "Seattle", "fahrenheit");
+        widget.begin();
+        TEST_ASSERT_TRUE(widget.isWeatherDataValid());
+        widget.render(region);
+        TEST_ASSERT_FALSE(widget.revalidate());
+        TEST_ASSERT_EQUAL(1, server.requests);
+    }
+
+    // Stale: drawn at once, then asked; the same answer changes nothing on the panel
+    setClock(NOW + HOUR);
+    {
+        WeatherWidget widget(*panel, "47.6", "-122.3", "Seattle", "fahrenheit");
+        widget.begin();
+        unsigned long start = millis();
+        widget.render(region);
+        TEST_ASSERT_TRUE(millis() - start < 800);
+        TEST_ASSERT_EQUAL(1, server.requests);
+        TEST_ASSERT_FALSE(widget.revalidate());
+        TEST_ASSERT_EQUAL(2, server.requests);
+        // Once per wake
+        TEST_ASSERT_FALSE(widget.revalidate());
+        TEST_ASSERT_EQUAL(2, server.requests);
+    }
+
+    // Stale again, and the weather changed
+    setClock(NOW + 2 * HOUR);
+    server.temperature = 55;
+    {
+        WeatherWidget widget(*panel, "47.6", "-122.3", "Seattle", "fahrenheit");
+        ChartWidget chart(*panel, 12, 3600000);
+        widget.begin();
+        chart.begin();
+        widget.render(region);
+        chart.render(region);
+        TEST_ASSERT_TRUE(widget.revalidate());
+        TEST_ASSERT_EQUAL(3, server.requests);
+        // The chart shows the new forecast once, not on every revalidation pass
+        TEST_ASSERT_TRUE(chart.revalidate());
+        TEST_ASSERT_FALSE(chart.revalidate());
+    }
+}
+
+void test_failed_fetch_keeps_last_good_data(void) {
+    WeatherServer server;
+    HTTPClient::setTransport(&server);
+    LayoutRegion region(0, 0, 300, 200);
+    WeatherWidget widget(*panel, "47.6", "-122.3", "Seattle", "fahrenheit");
+    widget.begin();
+    widget.render(region);
+    TEST_ASSERT_TRUE(widget.isWeatherDataValid());
+
+    // Still fresh: an update does not ask again
+    widget.forceUpdate();
+    TEST_ASSERT_FALSE(widget.revalidate());
+    TEST_ASSERT_EQUAL(1, server.requests);
+
+    // Stale: it does, and a failure does not wipe the forecast
+    setClock(NOW + HOUR);
+    server.status = 500;
+    widget.forceUpdate();
+    TEST_ASSERT_TRUE(widget.isWeatherDataValid());
+    TEST_ASSERT_FALSE(widget.revalidate());
+    TEST_ASSERT_EQUAL(2, server.requests);
+    TEST_ASSERT_TRUE(widget.isWeatherDataValid());
+
+    // Too old to show after a day
+    setClock(NOW + 25 * HOUR);
+    WeatherWidget later(*panel, "47.6", "-122.3", "Seattle", "fahrenheit");
+    later.begin();
+    TEST_ASSERT_FALSE(later.isWeatherDataValid());
+}
+
+void test_render_before_wifi_fetches_on_revalidate(void) {
+    WeatherServer server;
+    HTTPClient::setTransport(&server);
+    LayoutRegion region(0, 0, 300, 200);
+
+    // The cached render runs before WiFi is up; with nothing cached it draws the error
+    WiFi.disconnect(true);
+    WeatherWidget widget(*panel, "47.6", "-122.3", "Seattle", "fahrenheit");
+    widget.begin();
+    widget.forceUpdate();
+    widget.render(region);
+    TEST_ASSERT_FALSE(widget.isWeatherDataValid());
+    TEST_ASSERT_EQUAL(0, server.requests);
+    TEST_ASSERT_FALSE(widget.revalidate());
+
+    // Connected: the revalidation pass fetches and the region changes
+    WiFi.begin("host-network", "password");
+    TEST_ASSERT_TRUE(widget.revalidate());
+    TEST_ASSERT_EQUAL(1, server.requests);
+    TEST_ASSERT_TRUE(widget.isWeatherDataValid());
+    TEST_ASSERT_FALSE(widget.revalidate());
+    TEST_ASSERT_EQUAL(1, server.requests);
+}
+
+void test_image_draws_cached_copy_and_revalidates(void) {
+    ImageServer server;
+    HTTPClient::setTransport(&server);
+    LayoutRegion region(0, 0, 300, 200);
+
+    // Nothing cached: the first render has to wait for the server
+    {
+        ImageWidget widget(*panel, IMAGE_URL);
+        widget.begin();
+        widget.forceUpdate();
+        widget.render(region);
+        TEST_ASSERT_EQUAL(1, server.requests);
+        TEST_ASSERT_EQUAL_UINT8(0, panel->getPixel(0, 0));
+        TEST_ASSERT_FALSE(widget.revalidate());
+        TEST_ASSERT_EQUAL(1, server.requests);
+    }
+
+    // Next wake: drawn from the local copy, then asked; the same bytes change nothing
+    {
+        ImageWidget widget(*panel, IMAGE_URL);
+        widget.begin();
+        widget.forceUpdate();
+        unsigned long start = millis();
+        widget.render(region);
+        TEST_ASSERT_TRUE(millis() - start < 800);
+        TEST_ASSERT_EQUAL(1, server.requests);
+        TEST_ASSERT_FALSE(widget.revalidate());
+        TEST_ASSERT_EQUAL(2, server.requests);
+        // Once per wake
+        TEST_ASSERT_FALSE(widget.revalidate());
+        TEST_ASSERT_EQUAL(2, server.requests);
+    }
+
+    // The picture changed: the region is redrawn from the new copy
+    server.body = ImageServer::pgm(0xff);
+    {
+        ImageWidget widget(*panel, IMAGE_URL);
+        widget.begin();
+        widget.forceUpdate();
+        widget.render(region);
+        TEST_ASSERT_EQUAL_UINT8(0, panel->getPixel(0, 0));
+        TEST_ASSERT_TRUE(widget.revalidate());
+        TEST_ASSERT_EQUAL(3, server.requests);
+        widget.render(region);
+        TEST_ASSERT_EQUAL_UINT8(7, panel->getPixel(0, 0));
+    }
+
+    // Drawn before WiFi is up, asked once connected
+    WiFi.disconnect(true);
+    {
+        ImageWidget widget(*panel, IMAGE_URL);
+        widget.begin();
+        widget.forceUpdate();
+        widget.render(region);
+        TEST_ASSERT_EQUAL_UINT8(7, panel->getPixel(0, 0));
+        TEST_ASSERT_FALSE(widget.revalidate());
+        TEST_ASSERT_EQUAL(3, server.requests);
+        WiFi.begin("host-network", "password");
+        TEST_ASSERT_FALSE(widget.revalidate());
+        TEST_ASSERT_EQUAL(4, server.requests);
+    }
+}
+
+void test_image_failure_keeps_last_good_copy(void) {
+    ImageServer server;
+    HTTPClient::setTransport(&server);
+    LayoutRegion region(0, 0, 300, 200);
+    ImageWidget first(*panel, IMAGE_URL);
+    first.begin();
+    first.render(region);
+    TEST_ASSERT_EQUAL_UINT8(0, panel->getPixel(0, 0));
+
+    // A failed request and a page that is not an image both keep the picture
+    server.status = 500;
+    first.forceUpdate();
+    TEST_ASSERT_FALSE(first.revalidate());
+    server.status = 200;
+    server.body = "<html>Sign in to the hotel network</html>";
+    first.forceUpdate();
+    TEST_ASSERT_FALSE(first.revalidate());
+    TEST_ASSERT_EQUAL(3, server.requests);
+
+    ImageWidget later(*panel, IMAGE_URL);
+    later.begin();
+    panel->clearDisplay();
+    later.render(region);
+    TEST_ASSERT_EQUAL_UINT8(0, panel->getPixel(0, 0));
+    TEST_ASSERT_EQUAL(0, later.getConsecutiveFailures());
+
+    // Never a good copy: the error box
+    ImageWidget other(*panel, "http://images.local/other.pgm");
+    other.begin();
+    other.render(region);
+    TEST_ASSERT_EQUAL(1, other.getConsecutiveFailures());
+    TEST_ASSERT_EQUAL_UINT8(6, panel->getPixel(5, 100));
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+
+    UNITY_BEGIN();
+    RUN_TEST(test_freshness_policy);
+    RUN_TEST(test_value_survives_until_it_expires);
+    RUN_TEST(test_weather_draws_from_cache_and_revalidates);
+    RUN_TEST(test_failed_fetch_keeps_last_good_data);
+    RUN_TEST(test_render_before_wifi_fetches_on_revalidate);
+    RUN_TEST(test_image_draws_cached_copy_and_revalidates);
+    RUN_TEST(test_image_failure_keeps_last_good_copy);
+    return UNITY_END();
+}
@@ -0,0 +1,204 @@
+#include <unity.h>
+#include <vector>
+#include "core/Compositor.h"
+#include "core/PanelFrame.h"
+#include "widgets/weather/WeatherIcons.h"
+
+static Compositor* compositor = nullptr;
+
+void setUp(void) {
+    compositor = new Compositor(8, 6);
+    TEST_ASSERT_TRUE(compositor->initialize());
+    compositor->fillRect(0, 0, 8, 6, 128);
+    compositor->resetChangeTracking();
+}
+
+void tearDown(void) {
+    delete compositor;
+    compositor = nullptr;
+}
+
+static Sprite makeSprite(const uint8_t* data, size_t length, int width, int height, int bitsPerPixel) {
+    Sprite sprite;
+    sprite.data = data;
+    sprite.length = length;
+    sprite.width = static_cast<uint16_t>(width);
+    sprite.height = static_cast<uint16_t>(height);
+    sprite.bitsPerPixel = static_cast<uint8_t>(bitsPerPixel);
+    return sprite;
+}
+
+void test_opaque_sprites_are_clipped_to_the_surface(void) {
+    // 4x3 ramp: value = 10 * index
+    uint8_t pixels[12];
+    for (int i = 0; i < 12; i++) pixels[i] = static_cast<uint8_t>(i * 10);
+    Sprite sprite = makeSprite(pixels, sizeof(pixels), 4, 3, 8);
+
+    TEST_ASSERT_TRUE(compositor->blit(-1, -1, sprite));
+    // Rows 1..2 and columns 1..3 of the sprite land on the surface
+    TEST_ASSERT_EQUAL(50, compositor->getPixel(0, 0));
+    TEST_ASSERT_EQUAL(70, compositor->getPixel(2, 0));
+    TEST_ASSERT_EQUAL(110, compositor->getPixel(2, 1));
+    TEST_ASSERT_EQUAL(128, compositor->getPixel(3, 0));
+    TEST_ASSERT_EQUAL(128, compositor->getPixel(0, 2));
+
+    // One changed region: the clipped rectangle
+    std::vector<LayoutRegion> changed = compositor->getChangedRegions();
+    TEST_ASSERT_EQUAL(1, changed.size());
+    TEST_ASSERT_EQUAL(0, changed[0].getX());
+    TEST_ASSERT_EQUAL(0, changed[0].getY());
+    TEST_ASSERT_EQUAL(3, changed[0].getWidth());
+    TEST_ASSERT_EQUAL(2, changed[0].getHeight());
+
+    // Entirely off the surface is not an error and changes nothing
+    compositor->resetChangeTracking();
+    TEST_ASSERT_TRUE(compositor->blit(8, 0, sprite));
+    TEST_ASSERT_TRUE(compositor->blit(0, -3, sprite));
+    TEST_ASSERT_FALSE(compositor->hasChangedRegions());
+}
+
+void test_packed_pixels_spread_over_the_gray_range(void) {
+    // 2 bits: 0, 1, 2, 3 in one byte
+    const uint8_t twoBit[] = {0x1b};
+    TEST_ASSERT_TRUE(compositor->blit(0, 0, makeSprite(twoBit, sizeof(twoBit), 4, 1, 2)));
+    TEST_ASSERT_EQUAL(0, compositor->getPixel(0, 0));
+    TEST_ASSERT_EQUAL(85, compositor->getPixel(1, 0));
+    TEST_ASSERT_EQUAL(170, compositor->getPixel(2, 0));
+    TEST_ASSERT_EQUAL(255, compositor->getPixel(3, 0));
+
+    // 4 bits, clipped on the left so unpacking starts mid-byte
+    const uint8_t fourBit[] = {0x0f, 0x50};
+    TEST_ASSERT_TRUE(compositor->blit(-1, 1, makeSprite(fourBit, sizeof(fourBit), 3, 1, 4)));
+    TEST_ASSERT_EQUAL(255, compositor->getPixel(0, 1));
+    TEST_ASSERT_EQUAL(85, compositor->getPixel(1, 1));
+    TEST_ASSERT_EQUAL(128, compositor->getPixel(2, 1));
+
+    // 1 bit through a palette, rows starting on a byte
+    const uint8_t oneBit[] = {0xa0, 0x40};
+    const uint8_t palette[2] = {200, 20};
+    Sprite mono = makeSprite(oneBit, sizeof(oneBit), 3, 2, 1);
+    mono.palette = palette;
+    TEST_ASSERT_TRUE(compositor->blit(4, 2, mono));
+    TEST_ASSERT_EQUAL(20, compositor->getPixel(4, 2));
+    TEST_ASSERT_EQUAL(200, compositor->getPixel(5, 2));
+    TEST_ASSERT_EQUAL(20, compositor->getPixel(6, 2));
+    TEST_ASSERT_EQUAL(20, compositor->getPixel(5, 3));
+    TEST_ASSERT_EQUAL(200, compositor->getPixel(6, 3));
+}
+
+void test_key_and_mask_leave_the_surface_alone(void) {
+    const uint8_t pixels[] = {0, 9, 9, 0, 9, 0};
+    Sprite keyed = makeSprite(pixels, sizeof(pixels), 3, 2, 8);
+    keyed.key = 9;
+    TEST_ASSERT_TRUE(compositor->blit(0, 0, keyed));
+    TEST_ASSERT_EQUAL(0, compositor->getPixel(0, 0));
+    TEST_ASSERT_EQUAL(128, compositor->getPixel(1, 0));
+    TEST_ASSERT_EQUAL(128, compositor->getPixel(2, 0));
+    TEST_ASSERT_EQUAL(0, compositor->getPixel(0, 1));
+    TEST_ASSERT_EQUAL(128, compositor->getPixel(1, 1));
+    TEST_ASSERT_EQUAL(0, compositor->getPixel(2, 1));
+
+    // The mask picks pixels whatever their value
+    const uint8_t white[] = {255, 255, 255, 255, 255, 255};
+    const uint8_t mask[] = {0x40, 0xa0};
+    Sprite masked = makeSprite(white, sizeof(white), 3, 2, 8);
+    masked.mask = mask;
+    TEST_ASSERT_TRUE(compositor->blit(4, 3, masked));
+    TEST_ASSERT_EQUAL(128, compositor->getPixel(4, 3));
+    TEST_ASSERT_EQUAL(255, compositor->getPixel(5, 3));
+    TEST_ASSERT_EQUAL(128, compositor->getPixel(6, 3));
+    TEST_ASSERT_EQUAL(255, compositor->getPixel(4, 4));
+    TEST_ASSERT_EQUAL(128, compositor->getPixel(5, 4));
+    TEST_ASSERT_EQUAL(255, compositor->getPixel(6, 4));
+}
+
+void test_packbits_sources_decode_across_rows(void) {
+    // 5x4 with runs that cross row ends
+    std::vector<uint8_t> pixels = {
+        10, 10, 10, 10, 10,
+        10, 10, 20, 30, 40,
+        50, 50, 50, 50, 50,
+        50, 60, 60, 60, 60,
+    };
+    std::vector<uint8_t> packed;
+    PanelFrame::packBits(pixels.data(), pixels.size(), packed);
+    TEST_ASSERT_TRUE(packed.size() < pixels.size());
+
+    Sprite sprite = makeSprite(packed.data(), packed.size(), 5, 4, 8);
+    sprite.encoding = SpriteEncoding::PACKBITS;
+    // The first row falls off the top and is skipped undecoded
+    TEST_ASSERT_TRUE(compositor->blit(4, -1, sprite));
+    TEST_ASSERT_EQUAL(10, compositor->getPixel(4, 0));
+    TEST_ASSERT_EQUAL(20, compositor->getPixel(6, 0));
+    TEST_ASSERT_EQUAL(30, compositor->getPixel(7, 0));
+    TEST_ASSERT_EQUAL(50, compositor->getPixel(7, 1));
+    TEST_ASSERT_EQUAL(60, compositor->getPixel(5, 2));
+    TEST_ASSERT_EQUAL(128, compositor->getPixel(4, 3));
+
+    // Runs that end early draw what they have and report it
+    sprite.length = packed.size() - 2;
+    TEST_ASSERT_FALSE(compositor->blit(0, 0, sprite));
+    TEST_ASSERT_EQUAL(10, compositor->getPixel(0, 0));
+}
+
+void test_mono_bits_are_drawn_in_one_color(void) {
+    const uint8_t bits[] = {0x80, 0x40};
+    TEST_ASSERT_TRUE(compositor->blitMono(6, 4, bits, 2, 2, 0));
+    TEST_ASSERT_EQUAL(0, compositor->getPixel(6, 4));
+    TEST_ASSERT_EQUAL(128, compositor->getPixel(7, 4));
+    TEST_ASSERT_EQUAL(0, compositor->getPixel(7, 5));
+
+    TEST_ASSERT_FALSE(compositor->blitMono(0, 0, bits, 0, 2, 0));
+
+    // Malformed sprites are refused
+    Sprite odd = makeSprite(bits, sizeof(bits), 2, 2, 3);
+    TEST_ASSERT_FALSE(compositor->blit(0, 0, odd));
+    Sprite shortRaw = makeSprite(bits, sizeof(bits), 2, 3, 8);
+    TEST_ASSERT_FALSE(compositor->blit(0, 0, shortRaw));
+
+    Compositor uninitialized(8, 6);
+    TEST_ASSERT_FALSE(uninitialized.blitMono(0, 0, bits, 2, 2, 0));
+    TEST_ASSERT_TRUE(uninitialized.getLastError() == CompositorError::SurfaceNotInitialized);
+}
+
+void test_weather_icons_cover_the_condition_groups(void) {
+    Compositor surface(WeatherIcons::SIZE, WeatherIcons::SIZE);
+    TEST_ASSERT_TRUE(surface.initialize());
+
+    const int codes[] = {0, 2, 3, 45, 61, 81, 73, 86, 95};
+    for (int code : codes) {
+        const Sprite* icon = WeatherIcons::forCode(code);
+        TEST_ASSERT_NOT_NULL(icon);
+        surface.clear();
+        TEST_ASSERT_TRUE(surface.blit(0, 0, *icon));
+
+        // Ink in black on a white background, and nothing else
+        size_t ink = 0;
+        for (int y = 0; y < WeatherIcons::SIZE; y++) {
+            for (int x = 0; x < WeatherIcons::SIZE; x++) {
+                uint8_t value = surface.getPixel(x, y);
+                TEST_ASSERT_TRUE(value == 0 || value == 255);
+                if (value == 0) ink++;
+            }
+        }
+        TEST_ASSERT_TRUE(ink > 100);
+    }
+
+    TEST_ASSERT_TRUE(WeatherIcons::forCode(61) == WeatherIcons::forCode(80));
+    TEST_ASSERT_NULL(WeatherIcons::forCode(4));
+    TEST_ASSERT_NULL(WeatherIcons::forCode(-1));
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+
+    UNITY_BEGIN();
+    RUN_TEST(test_opaque_sprites_are_clipped_to_the_surface);
+    RUN_TEST(test_packed_pixels_spread_over_the_gray_range);
+    RUN_TEST(test_key_and_mask_leave_the_surface_alone);
+    RUN_TEST(test_packbits_sources_decode_across_rows);
+    RUN_TEST(test_mono_bits_are_drawn_in_one_color);
+    RUN_TEST(test_weather_icons_cover_the_condition_groups);
+    return UNITY_END();
+}
@@ -0,0 +1,173 @@
+#include <unity.h>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include "core/Compositor.h"
+#include "core/StaticLayer.h"
+#include "core/Storage.h"
+#include "managers/ConfigManager.h"
+#include "widgets/layout/LayoutWidget.h"
+#include "widgets/name/NameWidget.h"
+#include "HostFlash.h"
+#include "SPIFFS.h"
+
+static Compositor* compositor = nullptr;
+
+void setUp(void) {
+    Storage::reset();
+    SPIFFS.clearFiles();
+    TEST_ASSERT_TRUE(Storage::begin());
+    compositor = new Compositor(40, 30);
+    TEST_ASSERT_TRUE(compositor->initialize());
+}
+
+void tearDown(void) {
+    delete compositor;
+    compositor = nullptr;
+}
+
+static void drawPattern(Compositor& target) {
+    target.clear();
+    target.fillRect(2, 3, 10, 4, 0);
+    target.fillRect(20, 10, 15, 12, 128);
+    target.setPixel(39, 29, 64);
+}
+
+void test_layer_round_trips_through_flash(void) {
+    drawPattern(*compositor);
+    StaticLayer layer(0x1234);
+    TEST_ASSERT_TRUE(layer.save(*compositor));
+    TEST_ASSERT_TRUE(Storage::exists(StorageUse::IMAGE_CACHE, StaticLayer::FILE_NAME));
+
+    // Restoring replaces whatever is on the surface
+    Compositor restored(40, 30);
+    TEST_ASSERT_TRUE(restored.initialize());
+    restored.fillRect(0, 0, 40, 30, 200);
+    TEST_ASSERT_TRUE(layer.restore(restored));
+    for (int y = 0; y < 30; y++) {
+        for (int x = 0; x < 40; x++) {
+            TEST_ASSERT_EQUAL(compositor->getPixel(x, y), restored.getPixel(x, y));
+        }
+    }
+
+    layer.invalidate();
+    TEST_ASSERT_FALSE(layer.restore(restored));
+}
+
+void test_layer_for_another_config_or_size_is_ignored(void) {
+    drawPattern(*compositor);
+    TEST_ASSERT_TRUE(StaticLayer(1).save(*compositor));
+
+    // A different config hash gives a different key
+    StaticLayer other(2);
+    TEST_ASSERT_TRUE(other.getKey() != StaticLayer(1).getKey());
+    compositor->clear();
+    TEST_ASSERT_FALSE(other.restore(*compositor));
+    TEST_ASSERT_EQUAL(255, compositor->getPixel(2, 3));
+
+    Compositor wider(41, 30);
+    TEST_ASSERT_TRUE(wider.initialize());
+    TEST_ASSERT_FALSE(StaticLayer(1).restore(wider));
+    TEST_ASSERT_TRUE(StaticLayer(1).restore(*compositor));
+    TEST_ASSERT_EQUAL(0, compositor->getPixel(2, 3));
+
+    // Another firmware image draws the static widgets again
+    uint8_t sha256[32] = {0x5a};
+    HostFlash::setAppElfSha256(sha256);
+    TEST_ASSERT_FALSE(StaticLayer(1).restore(*compositor));
+    memset(sha256, 0, sizeof(sha256));
+    HostFlash::setAppElfSha256(sha256);
+    TEST_ASSERT_TRUE(StaticLayer(1).restore(*compositor));
+}
+
+void test_damaged_layer_is_rejected(void) {
+    drawPattern(*compositor);
+    StaticLayer layer(7);
+    std::vector<uint8_t> encoded;
+    TEST_ASSERT_TRUE(StaticLayer::encode(*compositor, layer.getKey(), encoded));
+    TEST_ASSERT_TRUE(StaticLayer::check(encoded.data(), encoded.size(), *compositor, layer.getKey()));
+    TEST_ASSERT_FALSE(StaticLayer::check(encoded.data(), StaticLayer::HEADER_SIZE, *compositor, layer.getKey()));
+
+    // Runs cut short
+    fs::File file = Storage::open(StorageUse::IMAGE_CACHE, StaticLayer::FILE_NAME, "w");
+    file.write(encoded.data(), encoded.size() - 3);
+    file.close();
+    TEST_ASSERT_FALSE(layer.restore(*compositor));
+
+    // Wrong magic
+    encoded[0] = 'X';
+    file = Storage::open(StorageUse::IMAGE_CACHE, StaticLayer::FILE_NAME, "w");
+    file.write(encoded.data(), encoded.size());
+    file.close();
+    TEST_ASSERT_FALSE(layer.restore(*compositor));
+}
+
+void test_config_hash_follows_the_config(void) {
+    SPIFFS.writeFile("/config.json",
+                     "{\"Wifi\":{\"SSID\":\"home\",\"Password\":\"secret\"},"
+                     "\"Layout\":{\"header\":{\"X\":0,\"Y\":0,\"Width\":1200,\"Height\":100,\"Static\":true},"
+                     "\"main\":{\"X\":0,\"Y\":100,\"Width\":1200,\"Height\":725}}}");
+    ConfigManager manager;
+    TEST_ASSERT_TRUE(manager.begin());
+    uint32_t firstHash = manager.getConfig().configHash;
+    TEST_ASSERT_TRUE(firstHash != 0);
+    TEST_ASSERT_TRUE(manager.getRegionConfig("header").isStatic);
+    TEST_ASSERT_FALSE(manager.getRegionConfig("main").isStatic);
+
+    // Same config, same hash
+    TEST_ASSERT_TRUE(manager.loadConfig());
+    TEST_ASSERT_EQUAL(firstHash, manager.getConfig().configHash);
+
+    SPIFFS.writeFile("/config.json",
+                     "{\"Wifi\":{\"SSID\":\"home\",\"Password\":\"secret\"},"
+                     "\"Layout\":{\"header\":{\"X\":0,\"Y\":0,\"Width\":1200,\"Height\":120,\"Static\":true},"
+                     "\"main\":{\"X\":0,\"Y\":120,\"Width\":1200,\"Height\":705}}}");
+    TEST_ASSERT_TRUE(manager.loadConfig());
+    TEST_ASSERT_TRUE(manager.getConfig().configHash != firstHash);
+}
+
+void test_dynamic_borders_skip_static_regions(void) {
+    Inkplate display(INKPLATE_3BIT);
+    std::vector<std::unique_ptr<LayoutRegion>> regions;
+    regions.emplace_back(new LayoutRegion(0, 0, 40, 10));
+    regions.emplace_back(new LayoutRegion(0, 10, 20, 20));
+    regions.emplace_back(new LayoutRegion(20, 10, 20, 20));
+    regions[0]->setStatic(true);
+
+    NameWidget name(display, "Smith");
+    TEST_ASSERT_TRUE(name.isStatic());
+    TEST_ASSERT_TRUE(LayoutRegion(*regions[0]).isStatic());
+
+    LayoutWidget layout(display, true, false, 0, 0, 1, 1);
+    layout.setRegions(&regions);
+
+    layout.renderBordersToCompositor(*compositor, false);
+    // Only the dynamic regions' borders are drawn
+    TEST_ASSERT_EQUAL(255, compositor->getPixel(5, 0));
+    TEST_ASSERT_EQUAL(0, compositor->getPixel(5, 10));
+    TEST_ASSERT_EQUAL(0, compositor->getPixel(25, 29));
+
+    layout.renderBordersToCompositor(*compositor, true);
+    TEST_ASSERT_EQUAL(0, compositor->getPixel(5, 0));
+    TEST_ASSERT_EQUAL(0, compositor->getPixel(5, 9));
+
+    // A thick static border reaching into a dynamic region is drawn again
+    compositor->clear();
+    layout.setBorderThickness(2);
+    layout.renderBordersToCompositor(*compositor, false);
+    TEST_ASSERT_EQUAL(0, compositor->getPixel(5, 10));
+    TEST_ASSERT_EQUAL(0, compositor->getPixel(5, 9));
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+
+    UNITY_BEGIN();
+    RUN_TEST(test_layer_round_trips_through_flash);
+    RUN_TEST(test_layer_for_another_config_or_size_is_ignored);
+    RUN_TEST(test_damaged_layer_is_rejected);
+    RUN_TEST(test_config_hash_follows_the_config);
+    RUN_TEST(test_dynamic_borders_skip_static_regions);
+    return UNITY_END();
+}
@@ -0,0 +1,175 @@
+#include <unity.h>
+#include <string>
+#include "core/InputTrace.h"
+#include "core/Storage.h"
+#include "managers/ConfigManager.h"
+#include "SD.h"
+#include "SPIFFS.h"
+
+static void writeFile(StorageUse use, const char* name, size_t bytes) {
+    TEST_ASSERT_TRUE(Storage::reserve(use, bytes));
+    fs::File file = Storage::open(use, name, "w");
+    TEST_ASSERT_TRUE(static_cast<bool>(file));
+    std::string contents(bytes, 'x');
+    file.write(reinterpret_cast<const uint8_t*>(contents.data()), contents.size());
+    file.close();
+    Storage::recordWrite(use, name, bytes);
+}
+
+void setUp(void) {
+    Storage::reset();
+    SPIFFS.clearFiles();
+    SD.clearFiles();
+    SD.setCardPresent(true);
+    SD.end();
+    TEST_ASSERT_TRUE(Storage::begin());
+}
+
+void tearDown(void) {}
+
+void test_uses_default_to_internal_flash(void) {
+    TEST_ASSERT_EQUAL(static_cast<int>(StorageBackend::INTERNAL),
+                      static_cast<int>(Storage::getBackend(StorageUse::IMAGE_CACHE)));
+    TEST_ASSERT_EQUAL_STRING("/cache/photo.png", Storage::path(StorageUse::IMAGE_CACHE, "/photo.png").c_str());
+    TEST_ASSERT_EQUAL_STRING("/trace.bin", Storage::path(StorageUse::LOGS, "/trace.bin").c_str());
+
+    writeFile(StorageUse::IMAGE_CACHE, "/photo.png", 100);
+    TEST_ASSERT_TRUE(SPIFFS.exists("/cache/photo.png"));
+    TEST_ASSERT_TRUE(Storage::exists(StorageUse::IMAGE_CACHE, "/photo.png"));
+    // No quota: nothing is indexed
+    TEST_ASSERT_EQUAL(0, Storage::getUsedBytes(StorageUse::IMAGE_CACHE));
+}
+
+void test_routes_to_the_card_and_falls_back_without_one(void) {
+    TEST_ASSERT_TRUE(Storage::configure(StorageUse::IMAGE_CACHE, StorageBackend::SD_CARD, 0));
+    writeFile(StorageUse::IMAGE_CACHE, "/photo.png", 100);
+    TEST_ASSERT_TRUE(SD.exists("/cache/photo.png"));
+    TEST_ASSERT_FALSE(SPIFFS.exists("/cache/photo.png"));
+
+    // The config says where everything else goes, so it stays put
+    TEST_ASSERT_FALSE(Storage::configure(StorageUse::CONFIG, StorageBackend::SD_CARD, 0));
+    TEST_ASSERT_EQUAL(static_cast<int>(StorageBackend::INTERNAL),
+                      static_cast<int>(Storage::getBackend(StorageUse::CONFIG)));
+
+    Storage::reset();
+    SD.end();
+    SD.setCardPresent(false);
+    TEST_ASSERT_FALSE(Storage::configure(StorageUse::LOGS, StorageBackend::SD_CARD, 0));
+    TEST_ASSERT_EQUAL(static_cast<int>(StorageBackend::INTERNAL),
+                      static_cast<int>(Storage::getBackend(StorageUse::LOGS)));
+    TEST_ASSERT_EQUAL(static_cast<int>(StorageBackend::SD_CARD), static_cast<int>(Storage::parseBackend("sd")));
+    TEST_ASSERT_EQUAL(static_cast<int>(StorageBackend::INTERNAL), static_cast<int>(Storage::parseBackend("flash")));
+}
+
+void test_quota_evicts_least_recently_used(void) {
+    Storage::configure(StorageUse::IMAGE_CACHE, StorageBackend::INTERNAL, 1000);
+    writeFile(StorageUse::IMAGE_CACHE, "/a.png", 400);
+    writeFile(StorageUse::IMAGE_CACHE, "/b.png", 400);
+    Storage::touch(StorageUse::IMAGE_CACHE, "/a.png");
+    TEST_ASSERT_EQUAL(800, Storage::getUsedBytes(StorageUse::IMAGE_CACHE));
+
+    writeFile(StorageUse::IMAGE_CACHE, "/c.png", 400);
+    TEST_ASSERT_TRUE(SPIFFS.exists("/cache/a.png"));
+    TEST_ASSERT_FALSE(SPIFFS.exists("/cache/b.png"));
+    TEST_ASSERT_TRUE(SPIFFS.exists("/cache/c.png"));
+    TEST_ASSERT_EQUAL(800, Storage::getUsedBytes(StorageUse::IMAGE_CACHE));
+
+    // Rewriting a file replaces its entry
+    writeFile(StorageUse::IMAGE_CACHE, "/c.png", 100);
+    TEST_ASSERT_EQUAL(500, Storage::getUsedBytes(StorageUse::IMAGE_CACHE));
+    TEST_ASSERT_EQUAL(2, Storage::getEntries(StorageUse::IMAGE_CACHE).size());
+
+    // Too big for the quota: nothing is evicted for it
+    TEST_ASSERT_FALSE(Storage::reserve(StorageUse::IMAGE_CACHE, 1001));
+    TEST_ASSERT_EQUAL(2, Storage::getEntries(StorageUse::IMAGE_CACHE).size());
+
+    Storage::remove(StorageUse::IMAGE_CACHE, "/a.png");
+    TEST_ASSERT_EQUAL(100, Storage::getUsedBytes(StorageUse::IMAGE_CACHE));
+    TEST_ASSERT_FALSE(SPIFFS.exists("/cache/a.png"));
+}
+
+void test_trim_drops_least_recently_used(void) {
+    Storage::configure(StorageUse::IMAGE_CACHE, StorageBackend::INTERNAL, 1000);
+    writeFile(StorageUse::IMAGE_CACHE, "/a.png", 200);
+    writeFile(StorageUse::IMAGE_CACHE, "/b.png", 200);
+    writeFile(StorageUse::IMAGE_CACHE, "/c.png", 200);
+    writeFile(StorageUse::IMAGE_CACHE, "/d.png", 200);
+    Storage::touch(StorageUse::IMAGE_CACHE, "/a.png");
+
+    TEST_ASSERT_EQUAL(2, Storage::trim(StorageUse::IMAGE_CACHE, 500));
+    TEST_ASSERT_EQUAL(400, Storage::getUsedBytes(StorageUse::IMAGE_CACHE));
+    TEST_ASSERT_TRUE(SPIFFS.exists("/cache/a.png"));
+    TEST_ASSERT_FALSE(SPIFFS.exists("/cache/b.png"));
+    TEST_ASSERT_FALSE(SPIFFS.exists("/cache/c.png"));
+    TEST_ASSERT_TRUE(SPIFFS.exists("/cache/d.png"));
+    TEST_ASSERT_EQUAL(0, Storage::trim(StorageUse::IMAGE_CACHE, 500));
+}
+
+void test_index_survives_a_restart(void) {
+    Storage::configure(StorageUse::IMAGE_CACHE, StorageBackend::SD_CARD, 1000);
+    writeFile(StorageUse::IMAGE_CACHE, "/a.png", 300);
+    writeFile(StorageUse::IMAGE_CACHE, "/b.png", 300);
+    writeFile(StorageUse::IMAGE_CACHE, "/c.png", 300);
+    Storage::touch(StorageUse::IMAGE_CACHE, "/a.png");
+    TEST_ASSERT_TRUE(Storage::flush());
+    TEST_ASSERT_TRUE(SD.exists("/cache/index.lru"));
+
+    // Next wake: statics are gone, the card is not
+    Storage::reset();
+    SD.end();
+    Storage::configure(StorageUse::IMAGE_CACHE, StorageBackend::SD_CARD, 1000);
+    TEST_ASSERT_EQUAL(900, Storage::getUsedBytes(StorageUse::IMAGE_CACHE));
+
+    writeFile(StorageUse::IMAGE_CACHE, "/d.png", 300);
+    TEST_ASSERT_TRUE(SD.exists("/cache/a.png"));
+    TEST_ASSERT_FALSE(SD.exists("/cache/b.png"));
+    TEST_ASSERT_TRUE(SD.exists("/cache/c.png"));
+    TEST_ASSERT_TRUE(SD.exists("/cache/d.png"));
+}
+
+void test_config_selects_backends_and_quotas(void) {
+    SPIFFS.writeFile("/config.json",
+                     "{\"Wifi\":{\"SSID\":\"home\",\"Password\":\"secret\"},"
+                     "\"Storage\":{\"ImageCache\":\"sd\",\"ImageCacheKB\":2048,\"Logs\":\"sd\",\"LogsKB\":128}}");
+    ConfigManager manager;
+    TEST_ASSERT_TRUE(manager.begin());
+    const AppConfig& config = manager.getConfig();
+    TEST_ASSERT_EQUAL_STRING("sd", config.imageCacheStorage.c_str());
+    TEST_ASSERT_EQUAL(2048, config.imageCacheKB);
+    TEST_ASSERT_EQUAL_STRING("sd", config.logStorage.c_str());
+    TEST_ASSERT_EQUAL(128, config.logKB);
+
+    SPIFFS.writeFile("/config.json", "{\"Wifi\":{\"SSID\":\"home\",\"Password\":\"secret\"}}");
+    TEST_ASSERT_TRUE(manager.loadConfig());
+    TEST_ASSERT_EQUAL_STRING("internal", manager.getConfig().imageCacheStorage.c_str());
+    TEST_ASSERT_EQUAL(512, manager.getConfig().imageCacheKB);
+    TEST_ASSERT_EQUAL(0, manager.getConfig().logKB);
+}
+
+void test_traces_go_to_log_storage(void) {
+    Storage::configure(StorageUse::LOGS, StorageBackend::SD_CARD, 64 * 1024);
+    InputTrace::beginWake(0);
+    TEST_ASSERT_TRUE(InputTrace::start(4096));
+    InputTrace::recordBattery(4.1f);
+    TEST_ASSERT_TRUE(InputTrace::finish(60000));
+    InputTrace::reset();
+
+    TEST_ASSERT_TRUE(SD.exists("/trace.bin"));
+    TEST_ASSERT_FALSE(SPIFFS.exists("/trace.bin"));
+    TEST_ASSERT_EQUAL(1, Storage::getEntries(StorageUse::LOGS).size());
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+
+    UNITY_BEGIN();
+    RUN_TEST(test_uses_default_to_internal_flash);
+    RUN_TEST(test_routes_to_the_card_and_falls_back_without_one);
+    RUN_TEST(test_quota_evicts_least_recently_used);
+    RUN_TEST(test_trim_drops_least_recently_used);
+    RUN_TEST(test_index_survives_a_restart);
+    RUN_TEST(test_config_selects_backends_and_quotas);
+    RUN_TEST(test_traces_go_to_log_storage);
+    return UNITY_END();
+}
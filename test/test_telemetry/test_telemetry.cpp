@@ -0,0 +1,181 @@
+#include <unity.h>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "HostClock.h"
+#include "HostTransport.h"
+#include "HTTPClient.h"
+#include "TelemetrySink.h"
+#include "WiFi.h"
+#include "core/Telemetry.h"
+#include "core/WakeMetrics.h"
+#include "esp_sleep.h"
+
+/**
+ * Records the last request and answers 200
+ */
+class RecordingTransport : public HostTransport {
+public:
+    HostResponse handle(const HostRequest& request) override {
+        lastRequest = request;
+        HostResponse response;
+        response.status = 200;
+        response.body = "image";
+        return response;
+    }
+
+    HostRequest lastRequest;
+};
+
+// One wake with recognisable numbers
+static void simulateWake(uint32_t awakeMs, uint32_t wifiMs, float volts, int wifiFailures) {
+    HostClock::setMicros(0);
+    WakeMetrics::beginWake();
+    Telemetry::beginWake(ESP_SLEEP_WAKEUP_TIMER);
+    WakeMetrics::record("wifi", 10, wifiMs * 1000);
+    WakeMetrics::record("panel.full", 20, 1820000);
+    WakeMetrics::record("panel.partial", 30, 300000);
+    WakeMetrics::record("panel.partial", 40, 300000);
+    WakeMetrics::recordBattery(volts);
+    for (int i = 0; i < wifiFailures; i++) {
+        WakeMetrics::count(WakeCounter::WIFI_FAILURES);
+    }
+    delay(awakeMs);
+    Telemetry::endWake();
+}
+
+void setUp(void) {
+    HostClock::setVirtual(true);
+    HostClock::setMicros(0);
+    Telemetry::reset();
+    HTTPClient::setTransport(nullptr);
+    WiFi.setConnectDelayMs(0);
+    WiFi.setNetworkAvailable(true);
+    WiFi.begin("host-network", "password");
+}
+
+void tearDown(void) {
+    WiFi.disconnect(true);
+    Telemetry::reset();
+    HTTPClient::setTransport(nullptr);
+}
+
+void test_records_round_trip_through_parameter(void) {
+    simulateWake(30000, 1800, 3.912f, 0);
+    simulateWake(42000, 6100, 3.905f, 2);
+
+    uint8_t payload[256];
+    size_t length = Telemetry::encode(payload, sizeof(payload));
+    TEST_ASSERT_TRUE(length > 0);
+
+    std::string parameter = Telemetry::toParameter(payload, length);
+    TEST_ASSERT_EQUAL((length * 4 + 2) / 3, parameter.size());
+    TEST_ASSERT_EQUAL(std::string::npos, parameter.find_first_of("+/="));
+
+    std::vector<uint8_t> decoded;
+    TEST_ASSERT_TRUE(Telemetry::fromParameter(parameter, decoded));
+    std::vector<TelemetryRecord> records;
+    TEST_ASSERT_TRUE(Telemetry::decode(decoded.data(), decoded.size(), records));
+    TEST_ASSERT_EQUAL(2, records.size());
+
+    // Newest first
+    const TelemetryRecord& newest = records[0];
+    TEST_ASSERT_EQUAL(2, newest.wake);
+    TEST_ASSERT_EQUAL(ESP_SLEEP_WAKEUP_TIMER, newest.wakeCause);
+    TEST_ASSERT_EQUAL(42000, newest.awakeMs);
+    TEST_ASSERT_EQUAL(6100, newest.phaseMs[static_cast<int>(TelemetryPhase::WIFI)]);
+    TEST_ASSERT_EQUAL(1820, newest.phaseMs[static_cast<int>(TelemetryPhase::PANEL_FULL)]);
+    TEST_ASSERT_EQUAL(600, newest.phaseMs[static_cast<int>(TelemetryPhase::PANEL_PARTIAL)]);
+    TEST_ASSERT_EQUAL(1, newest.fullRefreshes);
+    TEST_ASSERT_EQUAL(2, newest.partialRefreshes);
+    TEST_ASSERT_EQUAL(3905, newest.batteryMv);
+    TEST_ASSERT_EQUAL(2, newest.failures[static_cast<int>(WakeCounter::WIFI_FAILURES)]);
+    TEST_ASSERT_TRUE(newest.minFreeInternal > 0);
+    TEST_ASSERT_EQUAL(1, records[1].wake);
+    TEST_ASSERT_EQUAL(1800, records[1].phaseMs[static_cast<int>(TelemetryPhase::WIFI)]);
+
+    // Damaged payloads are rejected, not misread
+    TEST_ASSERT_FALSE(Telemetry::decode(decoded.data(), decoded.size() - 1, records));
+    decoded[0] = 9;
+    TEST_ASSERT_FALSE(Telemetry::decode(decoded.data(), decoded.size(), records));
+    TEST_ASSERT_FALSE(Telemetry::fromParameter("abc*def", decoded));
+}
+
+void test_history_keeps_last_wakes_and_cap_drops_oldest(void) {
+    for (uint32_t i = 0; i < Telemetry::HISTORY + 2; i++) {
+        simulateWake(30000 + i, 1800, 3.9f, 0);
+    }
+    TEST_ASSERT_EQUAL(Telemetry::HISTORY, Telemetry::getHistoryCount());
+
+    uint8_t payload[256];
+    std::vector<TelemetryRecord> records;
+    size_t length = Telemetry::encode(payload, sizeof(payload));
+    TEST_ASSERT_TRUE(Telemetry::decode(payload, length, records));
+    TEST_ASSERT_EQUAL(Telemetry::HISTORY, records.size());
+    TEST_ASSERT_EQUAL(Telemetry::HISTORY + 2, records[0].wake);
+    TEST_ASSERT_EQUAL(3, records.back().wake);
+
+    // A tighter cap keeps the newest records only
+    size_t oneRecord = Telemetry::encode(payload, length / 2);
+    TEST_ASSERT_TRUE(oneRecord > 0 && oneRecord <= length / 2);
+    TEST_ASSERT_TRUE(Telemetry::decode(payload, oneRecord, records));
+    TEST_ASSERT_TRUE(records.size() < Telemetry::HISTORY);
+    TEST_ASSERT_EQUAL(Telemetry::HISTORY + 2, records[0].wake);
+
+    TEST_ASSERT_EQUAL(0, Telemetry::encode(payload, 4));
+}
+
+void test_url_gets_parameter_only_when_enabled(void) {
+    simulateWake(30000, 1800, 3.9f, 0);
+
+    String url = Telemetry::appendToUrl("http://images.local/photo.pgm");
+    TEST_ASSERT_EQUAL_STRING("http://images.local/photo.pgm", url.c_str());
+
+    Telemetry::configure(true, 64);
+    url = Telemetry::appendToUrl("http://images.local/photo.pgm");
+    TEST_ASSERT_EQUAL(0, strncmp(url.c_str(), "http://images.local/photo.pgm?tm=", 33));
+    TEST_ASSERT_TRUE(url.length() - 33 <= 64);
+
+    url = Telemetry::appendToUrl("http://images.local/photo.pgm?size=large");
+    TEST_ASSERT_TRUE(strstr(url.c_str(), "?size=large&tm=") != nullptr);
+    TEST_ASSERT_EQUAL_STRING("http://images.local/photo.pgm?size=large",
+                             HostTransport::removeQueryParam(url.c_str(), Telemetry::QUERY_PARAMETER).c_str());
+
+    // Too small a cap for even one record sends nothing extra
+    Telemetry::configure(true, 8);
+    url = Telemetry::appendToUrl("http://images.local/photo.pgm");
+    TEST_ASSERT_EQUAL_STRING("http://images.local/photo.pgm", url.c_str());
+}
+
+void test_sink_decodes_what_the_device_sends(void) {
+    simulateWake(36120, 1800, 3.87f, 1);
+    Telemetry::configure(true, 120);
+
+    RecordingTransport server;
+    TelemetrySink sink(server);
+    HTTPClient::setTransport(&sink);
+
+    HTTPClient http;
+    http.begin(Telemetry::appendToUrl("http://images.local/photo.pgm"));
+    TEST_ASSERT_EQUAL(200, http.GET());
+    http.end();
+
+    // One request, no extra round trip
+    TEST_ASSERT_EQUAL(1, HTTPClient::getRequestCount());
+    TEST_ASSERT_EQUAL_STRING("/photo.pgm", server.lastRequest.path.c_str());
+    TEST_ASSERT_EQUAL(1, sink.getReports());
+    TEST_ASSERT_EQUAL(0, sink.getMalformed());
+    TEST_ASSERT_TRUE(sink.getLargestParameter() <= 120);
+    TEST_ASSERT_EQUAL(1, sink.getLastRecords().size());
+    TEST_ASSERT_EQUAL(36120, sink.getLastRecords()[0].awakeMs);
+    TEST_ASSERT_EQUAL(3870, sink.getLastRecords()[0].batteryMv);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_records_round_trip_through_parameter);
+    RUN_TEST(test_history_keeps_last_wakes_and_cap_drops_oldest);
+    RUN_TEST(test_url_gets_parameter_only_when_enabled);
+    RUN_TEST(test_sink_decodes_what_the_device_sends);
+    return UNITY_END();
+}
@@ -0,0 +1,395 @@
+#include <unity.h>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+#include "HostClock.h"
+#include "HostTransport.h"
+#include "HTTPClient.h"
+#include "MockInkplate.h"
+#include "WiFi.h"
+#include "core/MemoryTracker.h"
+#include "core/PanelFrame.h"
+#include "core/WakeMetrics.h"
+#include "managers/FrameClient.h"
+
+static const int WIDTH = E_INK_WIDTH;
+static const int HEIGHT = E_INK_HEIGHT;
+static const size_t MONO_BYTES = static_cast<size_t>(WIDTH) * HEIGHT / 8;
+
+// 1-bit panel image, 1 = black, leftmost pixel in the low bit
+static void fillMono(std::vector<uint8_t>& image, int x, int y, int w, int h, bool black) {
+    for (int row = y; row < y + h; row++) {
+        for (int col = x; col < x + w; col++) {
+            size_t index = static_cast<size_t>(row) * WIDTH + col;
+            uint8_t mask = static_cast<uint8_t>(1 << (index & 7));
+            image[index / 8] = black ? (image[index / 8] | mask) : (image[index / 8] & ~mask);
+        }
+    }
+}
+
+/**
+ * Frame server: keeps every 1-bit image it has published and answers
+ * "since" with a delta (bounding box of the changed bytes) when it knows
+ * the base, otherwise with a full frame.
+ */
+class FrameServer : public HostTransport {
+public:
+    HostResponse handle(const HostRequest& request) override {
+        lastRequest = request;
+        requests++;
+
+        HostResponse response;
+        response.latencyMs = 100;
+        if (status != 200) {
+            response.status = status;
+            return response;
+        }
+
+        uint32_t since = static_cast<uint32_t>(atol(queryParam(request.query, "since", "0").c_str()));
+        PanelFrameHeader header = {};
+        header.mode = INKPLATE_1BIT;
+        header.width = WIDTH;
+        header.height = HEIGHT;
+        header.frameId = currentId;
+        header.sleepSeconds = sleepSeconds;
+
+        std::vector<uint8_t> body;
+        const std::vector<uint8_t>& image = published[currentId];
+        auto base = published.find(staleBase ? staleBase : since);
+        if (base != published.end()) {
+            header.baseId = base->first;
+            std::vector<PanelFrameRect> rects;
+            PanelFrameRect changed = {};
+            if (changedBounds(base->second, image, changed)) {
+                rects.push_back(changed);
+            }
+            PanelFrame::encode(header, rects, image.data(), base->second.data(), body);
+            lastWasDelta = true;
+        } else {
+            std::vector<PanelFrameRect> rects(1);
+            rects[0].width = WIDTH;
+            rects[0].height = HEIGHT;
+            PanelFrame::encode(header, rects, image.data(), nullptr, body);
+            lastWasDelta = false;
+        }
+
+        response.status = 200;
+        response.body.assign(body.begin(), body.end());
+        response.sendLength = sendLength;
+        return response;
+    }
+
+    void publish(const std::vector<uint8_t>& image) {
+        published[++currentId] = image;
+    }
+
+    static bool changedBounds(const std::vector<uint8_t>& a, const std::vector<uint8_t>& b, PanelFrameRect& rect) {
+        int stride = WIDTH / 8;
+        int minX = stride, minY = HEIGHT, maxX = -1, maxY = -1;
+        for (size_t i = 0; i < a.size(); i++) {
+            if (a[i] == b[i]) continue;
+            int x = static_cast<int>(i % stride);
+            int y = static_cast<int>(i / stride);
+            minX = std::min(minX, x);
+            maxX = std::max(maxX, x);
+            minY = std::min(minY, y);
+            maxY = std::max(maxY, y);
+        }
+        if (maxX < 0) return false;
+        rect.x = static_cast<uint16_t>(minX * 8);
+        rect.y = static_cast<uint16_t>(minY);
+        rect.width = static_cast<uint16_t>((maxX - minX + 1) * 8);
+        rect.height = static_cast<uint16_t>(maxY - minY + 1);
+        return true;
+    }
+
+    std::map<uint32_t, std::vector<uint8_t>> published;
+    uint32_t currentId = 100;
+    uint32_t sleepSeconds = 900;
+    uint32_t staleBase = 0;         // Answer with a delta against this frame regardless of "since"
+    int status = 200;
+    bool sendLength = true;         // false: no Content-Length, as with a streamed response
+    bool lastWasDelta = false;
+    uint32_t requests = 0;
+    HostRequest lastRequest;
+};
+
+/**
+ * Answers 200 with something that is not a frame
+ */
+class StaticBody : public HostTransport {
+public:
+    HostResponse handle(const HostRequest& request) override {
+        (void)request;
+        HostResponse response;
+        response.status = 200;
+        response.body = "<html>captive portal</html>";
+        return response;
+    }
+};
+
+// What deep sleep leaves: the panel keeps its image, the driver's buffers do not
+static void wake(Inkplate& display) {
+    display.begin();
+    display.setDisplayMode(INKPLATE_3BIT);
+    display.clearDisplay();
+}
+
+static void assertPanelShows(Inkplate& display, const std::vector<uint8_t>& image) {
+    for (int y = 0; y < HEIGHT; y += 3) {
+        for (int x = 0; x < WIDTH; x += 3) {
+            size_t index = static_cast<size_t>(y) * WIDTH + x;
+            bool black = (image[index / 8] >> (index & 7)) & 1;
+            if (display.getPanelPixel(x, y) != (black ? 0 : 7)) {
+                char message[64];
+                snprintf(message, sizeof(message), "pixel (%d,%d)", x, y);
+                TEST_FAIL_MESSAGE(message);
+            }
+        }
+    }
+}
+
+void setUp(void) {
+    HostClock::setVirtual(true);
+    HostClock::setMicros(0);
+    WakeMetrics::beginWake();
+    FrameClient::forgetShownFrame();
+    WiFi.setConnectDelayMs(0);
+    WiFi.setNetworkAvailable(true);
+    WiFi.begin("host-network", "password");
+}
+
+void tearDown(void) {
+    WiFi.disconnect(true);
+    HTTPClient::setTransport(nullptr);
+}
+
+void test_frame_format_round_trip_and_rejects_damage(void) {
+    // PackBits: runs, literals and the 128-byte limits
+    std::vector<uint8_t> raw(1000, 0);
+    for (size_t i = 300; i < 700; i++) raw[i] = static_cast<uint8_t>(i * 37);
+    std::vector<uint8_t> packed;
+    PanelFrame::packBits(raw.data(), raw.size(), packed);
+    TEST_ASSERT_TRUE(packed.size() < raw.size());
+
+    std::vector<uint8_t> image(MONO_BYTES, 0);
+    fillMono(image, 40, 30, 200, 100, true);
+    PanelFrameHeader header = {};
+    header.mode = INKPLATE_1BIT;
+    header.width = WIDTH;
+    header.height = HEIGHT;
+    header.frameId = 7;
+    std::vector<PanelFrameRect> rects(1);
+    rects[0].x = 32;
+    rects[0].y = 20;
+    rects[0].width = 240;
+    rects[0].height = 120;
+
+    std::vector<uint8_t> frameData;
+    TEST_ASSERT_TRUE(PanelFrame::encode(header, rects, image.data(), nullptr, frameData));
+    PanelFrame frame;
+    TEST_ASSERT_TRUE(frame.parse(frameData.data(), frameData.size()));
+    TEST_ASSERT_EQUAL(7, frame.getHeader().frameId);
+    TEST_ASSERT_FALSE(frame.isDelta());
+    TEST_ASSERT_EQUAL(1, frame.getRectCount());
+
+    std::vector<uint8_t> decoded(MONO_BYTES, 0);
+    TEST_ASSERT_TRUE(frame.unpack(0, false, decoded.data()));
+    TEST_ASSERT_TRUE(decoded == image);
+    TEST_ASSERT_FALSE(frame.unpack(0, true, decoded.data()));
+
+    // Truncated, wrong magic, unaligned rect, 3-bit delta
+    TEST_ASSERT_FALSE(frame.parse(frameData.data(), frameData.size() - 1));
+    frameData[0] = 'X';
+    TEST_ASSERT_FALSE(frame.parse(frameData.data(), frameData.size()));
+    rects[0].x = 33;
+    TEST_ASSERT_FALSE(PanelFrame::encode(header, rects, image.data(), nullptr, frameData));
+    rects[0].x = 32;
+    header.mode = INKPLATE_3BIT;
+    TEST_ASSERT_FALSE(PanelFrame::encode(header, rects, image.data(), image.data(), frameData));
+}
+
+void test_full_frame_is_presented_without_widgets(void) {
+    Inkplate display(INKPLATE_3BIT);
+    display.setChargeClock(false);
+    FrameServer server;
+    std::vector<uint8_t> image(MONO_BYTES, 0);
+    fillMono(image, 0, 0, WIDTH, 60, true);
+    fillMono(image, 100, 200, 400, 300, true);
+    server.publish(image);
+    HTTPClient::setTransport(&server);
+
+    FrameClient client(display, "http://frames.local/panel?unit=4", 3600000UL);
+    TEST_ASSERT_TRUE(client.update());
+
+    TEST_ASSERT_EQUAL_STRING("/panel", server.lastRequest.path.c_str());
+    TEST_ASSERT_EQUAL_STRING("4", HostTransport::queryParam(server.lastRequest.query, "unit").c_str());
+    TEST_ASSERT_EQUAL_STRING("0", HostTransport::queryParam(server.lastRequest.query, "since").c_str());
+    TEST_ASSERT_EQUAL(1, display.getStats().fullRefreshes);
+    TEST_ASSERT_EQUAL(0, display.getStats().partialRefreshes);
+    TEST_ASSERT_EQUAL(101, FrameClient::getShownFrameId());
+    TEST_ASSERT_EQUAL(900000UL, client.getSleepMs());
+    TEST_ASSERT_TRUE(client.getLastFrameBytes() < 8 * 1024);
+    assertPanelShows(display, image);
+
+    // Same frame again: nothing to draw
+    TEST_ASSERT_TRUE(client.update());
+    TEST_ASSERT_EQUAL(1, display.getStats().fullRefreshes);
+    TEST_ASSERT_EQUAL(0, display.getStats().partialRefreshes);
+}
+
+void test_frame_without_length_is_read_to_end(void) {
+    Inkplate display(INKPLATE_3BIT);
+    display.setChargeClock(false);
+    FrameServer server;
+    server.sendLength = false;
+    std::vector<uint8_t> image(MONO_BYTES, 0);
+    fillMono(image, 1, 0, 3, 10, true);
+    fillMono(image, 200, 300, 120, 40, true);
+    server.publish(image);
+    HTTPClient::setTransport(&server);
+
+    FrameClient client(display, "http://frames.local/panel", 3600000UL);
+    TEST_ASSERT_TRUE(client.update());
+    TEST_ASSERT_EQUAL(1, display.getStats().fullRefreshes);
+    TEST_ASSERT_EQUAL(7, display.getPanelPixel(0, 5));
+    TEST_ASSERT_EQUAL(0, display.getPanelPixel(1, 5));
+    TEST_ASSERT_EQUAL(7, display.getPanelPixel(4, 5));
+    assertPanelShows(display, image);
+    TEST_ASSERT_EQUAL(0, MemoryTracker::getStats(MemorySubsystem::NETWORK).currentBytes);
+}
+
+void test_grayscale_frame_goes_to_3bit_buffer(void) {
+    Inkplate display(INKPLATE_1BIT);
+    display.setChargeClock(false);
+
+    // 4 bits per pixel, high nibble first, 7 = white
+    std::vector<uint8_t> image(static_cast<size_t>(WIDTH) * HEIGHT / 2, 0x77);
+    for (int y = 300; y < 340; y++) {
+        memset(image.data() + static_cast<size_t>(y) * WIDTH / 2 + 50, 0x30, 20);
+    }
+    PanelFrameHeader header = {};
+    header.mode = INKPLATE_3BIT;
+    header.width = WIDTH;
+    header.height = HEIGHT;
+    header.frameId = 5;
+    std::vector<PanelFrameRect> rects(1);
+    rects[0].x = 96;
+    rects[0].y = 296;
+    rects[0].width = 48;
+    rects[0].height = 48;
+    std::vector<uint8_t> frameData;
+    TEST_ASSERT_TRUE(PanelFrame::encode(header, rects, image.data(), nullptr, frameData));
+
+    PanelFrame frame;
+    TEST_ASSERT_TRUE(frame.parse(frameData.data(), frameData.size()));
+    display.setDisplayMode(INKPLATE_3BIT);
+    TEST_ASSERT_TRUE(frame.unpack(0, false, display.DMemory4Bit));
+    display.display();
+
+    TEST_ASSERT_EQUAL(3, display.getPanelPixel(100, 310));
+    TEST_ASSERT_EQUAL(0, display.getPanelPixel(101, 310));
+    TEST_ASSERT_EQUAL(7, display.getPanelPixel(100, 295));
+    TEST_ASSERT_EQUAL(7, display.getPanelPixel(140, 310));
+}
+
+void test_delta_after_deep_sleep_uses_partial_update(void) {
+    Inkplate display(INKPLATE_3BIT);
+    display.setChargeClock(false);
+    FrameServer server;
+    std::vector<uint8_t> image(MONO_BYTES, 0);
+    fillMono(image, 100, 200, 400, 300, true);
+    fillMono(image, 1000, 20, 160, 40, true);
+    server.publish(image);
+    HTTPClient::setTransport(&server);
+
+    FrameClient client(display, "http://frames.local/panel", 3600000UL);
+    TEST_ASSERT_TRUE(client.update());
+
+    // Clock digits change; the rest of the panel stays
+    fillMono(image, 1000, 20, 160, 40, false);
+    fillMono(image, 1016, 24, 64, 32, true);
+    server.publish(image);
+    wake(display);
+    display.resetStats();
+
+    TEST_ASSERT_TRUE(client.update());
+    TEST_ASSERT_TRUE(server.lastWasDelta);
+    TEST_ASSERT_EQUAL_STRING("101", HostTransport::queryParam(server.lastRequest.query, "since").c_str());
+    TEST_ASSERT_EQUAL(0, display.getStats().fullRefreshes);
+    TEST_ASSERT_EQUAL(1, display.getStats().partialRefreshes);
+    TEST_ASSERT_EQUAL(160 * 40 - 64 * 32, display.getStats().changedPixels);
+    TEST_ASSERT_EQUAL(1, client.getLastRectCount());
+    TEST_ASSERT_TRUE(client.getLastFrameBytes() < 1024);
+    TEST_ASSERT_EQUAL(102, FrameClient::getShownFrameId());
+    assertPanelShows(display, image);
+
+    const PhaseTiming* panel = WakeMetrics::findPhase("panel.partial");
+    TEST_ASSERT_NOT_NULL(panel);
+    TEST_ASSERT_EQUAL(1, panel->count);
+}
+
+void test_delta_for_another_frame_falls_back_to_full(void) {
+    Inkplate display(INKPLATE_3BIT);
+    display.setChargeClock(false);
+    FrameServer server;
+    std::vector<uint8_t> first(MONO_BYTES, 0);
+    fillMono(first, 0, 0, 80, 80, true);
+    server.publish(first);
+    std::vector<uint8_t> second = first;
+    fillMono(second, 400, 400, 80, 80, true);
+    server.publish(second);
+    HTTPClient::setTransport(&server);
+
+    // The server wrongly answers relative to frame 101 although nothing is shown
+    server.staleBase = 101;
+    FrameClient client(display, "http://frames.local/panel", 3600000UL);
+    TEST_ASSERT_FALSE(client.update());
+    TEST_ASSERT_EQUAL(2, server.requests);
+    TEST_ASSERT_EQUAL(0, display.getStats().fullRefreshes + display.getStats().partialRefreshes);
+    TEST_ASSERT_EQUAL(0, FrameClient::getShownFrameId());
+
+    server.staleBase = 0;
+    TEST_ASSERT_TRUE(client.update());
+    TEST_ASSERT_FALSE(server.lastWasDelta);
+    TEST_ASSERT_EQUAL(1, display.getStats().fullRefreshes);
+    assertPanelShows(display, second);
+}
+
+void test_failures_leave_panel_untouched(void) {
+    Inkplate display(INKPLATE_3BIT);
+    display.setChargeClock(false);
+    FrameServer server;
+    server.publish(std::vector<uint8_t>(MONO_BYTES, 0));
+    HTTPClient::setTransport(&server);
+    FrameClient client(display, "http://frames.local/panel", 1800000UL);
+
+    server.status = 503;
+    TEST_ASSERT_FALSE(client.update());
+    TEST_ASSERT_EQUAL(1, WakeMetrics::getCount(WakeCounter::HTTP_FAILURES));
+
+    server.status = 304;
+    TEST_ASSERT_TRUE(client.update());
+
+    // Not a frame at all
+    StaticBody garbage;
+    HTTPClient::setTransport(&garbage);
+    TEST_ASSERT_FALSE(client.update());
+    TEST_ASSERT_EQUAL(1, WakeMetrics::getCount(WakeCounter::IMAGE_FAILURES));
+
+    TEST_ASSERT_EQUAL(0, display.getStats().fullRefreshes + display.getStats().partialRefreshes);
+    TEST_ASSERT_EQUAL(1800000UL, client.getSleepMs());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_frame_format_round_trip_and_rejects_damage);
+    RUN_TEST(test_full_frame_is_presented_without_widgets);
+    RUN_TEST(test_frame_without_length_is_read_to_end);
+    RUN_TEST(test_grayscale_frame_goes_to_3bit_buffer);
+    RUN_TEST(test_delta_after_deep_sleep_uses_partial_update);
+    RUN_TEST(test_delta_for_another_frame_falls_back_to_full);
+    RUN_TEST(test_failures_leave_panel_untouched);
+    return UNITY_END();
+}